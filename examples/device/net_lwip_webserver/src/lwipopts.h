@@ -73,6 +73,10 @@
 #define LWIP_HTTPD_SSI                  0
 #define LWIP_HTTPD_SSI_INCLUDE_TAG      0
 
+#if CFG_TUD_NCM && CFG_TUD_NCM_RECV_LEND
+  #define LWIP_SUPPORT_CUSTOM_PBUF      1
+#endif
+
 #define LWIP_SINGLE_NETIF               1
 #define LWIP_NETIF_LINK_CALLBACK        1
 
@@ -185,6 +185,37 @@ static void init_lwip(void) {
 #endif
 }
 
+#if CFG_TUD_NCM && CFG_TUD_NCM_RECV_LEND
+#include "class/net/ncm.h"
+
+/* zero-copy reception: pbuf referencing a datagram lent by the NCM driver, returned when lwIP frees the pbuf.
+ * The driver keeps its NTB out of reception until then, also across a USB bus reset. */
+typedef struct {
+  struct pbuf_custom pc; /* must be first */
+  const uint8_t *buffer;
+} lent_pbuf_t;
+
+static lent_pbuf_t lent_pbuf[CFG_TUD_NCM_OUT_NTB_N * CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB];
+
+static void lent_pbuf_free(struct pbuf *p) {
+  lent_pbuf_t *lp = (lent_pbuf_t *) p;
+  tud_network_recv_release(lp->buffer);
+  lp->buffer = NULL;
+}
+
+static struct pbuf *lent_pbuf_alloc(const uint8_t *src, uint16_t size) {
+  for (size_t i = 0; i < TU_ARRAY_SIZE(lent_pbuf); i++) {
+    lent_pbuf_t *lp = &lent_pbuf[i];
+    if (lp->buffer == NULL) {
+      lp->buffer = src;
+      lp->pc.custom_free_function = lent_pbuf_free;
+      return pbuf_alloced_custom(PBUF_RAW, size, PBUF_REF, &lp->pc, (void *) (uintptr_t) src, size);
+    }
+  }
+  return NULL;
+}
+#endif
+
 /* handle any DNS requests from dns-server */
 static bool dns_query_proc(const char *name, ip4_addr_t *addr) {
   if (0 == strcmp(name, "tiny.usb")) {
@@ -198,15 +229,21 @@ bool tud_network_recv_cb(const uint8_t *src, uint16_t size) {
   struct netif *netif = &netif_data;
 
   if (size) {
+#if CFG_TUD_NCM && CFG_TUD_NCM_RECV_LEND
+    struct pbuf *p = lent_pbuf_alloc(src, size);
+#else
     struct pbuf *p = pbuf_alloc(PBUF_RAW, size, PBUF_POOL);
+#endif
 
     if (p == NULL) {
       printf("ERROR: Failed to allocate pbuf of size %d\n", size);
       return false;
     }
 
+#if !(CFG_TUD_NCM && CFG_TUD_NCM_RECV_LEND)
     /* Copy buf to pbuf */
     pbuf_take(p, src, size);
+#endif
 
     // Surrender ownership of our pbuf unless there was an error
     // Only call pbuf_free if not Ok else it will panic with "pbuf_free: p->ref > 0"
@@ -138,6 +138,12 @@ extern "C" {
   #define CFG_TUD_NCM_IN_NTB_N 1
 #endif
 
+// Pass received datagrams to lwIP as custom pbufs referencing the NTB instead of copying them. lwIP may hold pbufs
+// for a while (e.g. out-of-order TCP segments), so use it with CFG_TUD_NCM_OUT_NTB_N >= 2
+#ifndef CFG_TUD_NCM_RECV_LEND
+  #define CFG_TUD_NCM_RECV_LEND 0
+#endif
+
 //--------------------------------------------------------------------
 // DEVICE CONFIGURATION
 //--------------------------------------------------------------------
@@ -102,6 +102,9 @@
 // Size of buffer to hold descriptors and other data used for enumeration
 #define CFG_TUH_ENUMERATION_BUFSIZE 256
 
+// Number of devices behind hub that can be enumerated at the same time, each has its own enumeration buffer
+#define CFG_TUH_ENUMERATION_MAX     2
+
 // Increase task event queue to handle rapid bulk transfer completions
 #define CFG_TUH_TASK_QUEUE_SZ       64
 
@@ -0,0 +1,496 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if (CFG_TUD_ENABLED && CFG_TUD_AUDIO)
+
+#include "device/usbd.h"
+#include "device/usbd_pvt.h"
+
+#include "audio_device.h"
+
+#if CFG_TUD_AUDIO_ENABLE_CONVERT
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF
+//--------------------------------------------------------------------+
+
+// Helium (M-profile vector extension, integer) e.g Cortex-M55/M85
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+  #include <arm_mve.h>
+  #define AUDIO_CONVERT_MVE 1
+#else
+  #define AUDIO_CONVERT_MVE 0
+#endif
+
+// DSP extension (saturating arithmetic) e.g Cortex-M4/M7/M33
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+  #include <arm_acle.h>
+  #define AUDIO_CONVERT_DSP 1
+#else
+  #define AUDIO_CONVERT_DSP 0
+#endif
+
+// Samples per intermediate Q31 block, two blocks live on stack
+#define AUDIO_CONVERT_BLOCK 32
+
+//--------------------------------------------------------------------+
+// Q31 helpers
+//--------------------------------------------------------------------+
+TU_ATTR_ALWAYS_INLINE static inline int32_t q31_sat(int64_t v) {
+  if (v > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (v < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t) v;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline int32_t q31_add(int32_t a, int32_t b) {
+#if AUDIO_CONVERT_DSP
+  return __qadd(a, b);
+#else
+  return q31_sat((int64_t) a + b);
+#endif
+}
+
+TU_ATTR_ALWAYS_INLINE static inline int32_t q31_gain(int32_t v, uint16_t gain) {
+  return q31_sat(((int64_t) v * gain) >> 15);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline int32_t f32_to_q31(float f) {
+  if (f > -1.0f && f < 1.0f) {
+    return (int32_t) (f * 2147483648.0f);
+  }
+  return (f >= 1.0f) ? INT32_MAX : (f <= -1.0f) ? INT32_MIN : 0; // NaN is silence
+}
+
+TU_ATTR_ALWAYS_INLINE static inline float q31_to_f32(int32_t v) {
+  return (float) v * (1.0f / 2147483648.0f);
+}
+
+//--------------------------------------------------------------------+
+// Kernels: load n samples spaced by step bytes into Q31, store Q31 into n samples spaced by step bytes.
+// Contiguous runs (step is sample size) are processed a word or a vector at a time, the remaining or strided samples
+// by the scalar loop.
+//--------------------------------------------------------------------+
+static void load_q31(int32_t* out, uint8_t const* src, uint8_t format, uint16_t step, uint32_t n) {
+  uint32_t i = 0;
+
+  switch (format) {
+    case AUDIO_SAMPLE_FORMAT_S16:
+      if (step == 2) {
+        #if AUDIO_CONVERT_MVE
+        if (((uintptr_t) src & 1u) == 0) {
+          for (; i < n; i += 4) {
+            mve_pred16_t const p = vctp32q(n - i);
+            int32x4_t const v = vldrhq_z_s32((int16_t const*) (void const*) (src + 2 * i), p);
+            vstrwq_p_s32(out + i, vshlq_n_s32(v, 16), p);
+          }
+        }
+        #endif
+        for (; i + 2 <= n; i += 2) {
+          uint32_t const w = tu_unaligned_read32(src + 2 * i);
+          out[i]     = (int32_t) (w << 16);
+          out[i + 1] = (int32_t) (w & 0xFFFF0000u);
+        }
+      }
+      for (; i < n; i++) {
+        out[i] = (int32_t) ((uint32_t) tu_unaligned_read16(src + i * step) << 16);
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S24:
+      if (step == 3) {
+        // 4 samples from 3 words
+        for (; i + 4 <= n; i += 4) {
+          uint8_t const* p = src + 3 * i;
+          uint32_t const w0 = tu_unaligned_read32(p);
+          uint32_t const w1 = tu_unaligned_read32(p + 4);
+          uint32_t const w2 = tu_unaligned_read32(p + 8);
+          out[i]     = (int32_t) (w0 << 8);
+          out[i + 1] = (int32_t) (((w0 >> 16) & 0x0000FF00u) | (w1 << 16));
+          out[i + 2] = (int32_t) (((w1 >> 8) & 0x00FFFF00u) | (w2 << 24));
+          out[i + 3] = (int32_t) (w2 & 0xFFFFFF00u);
+        }
+      }
+      for (; i < n; i++) {
+        uint8_t const* p = src + i * step;
+        out[i] = (int32_t) (((uint32_t) p[0] << 8) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 24));
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S24_32:
+      #if AUDIO_CONVERT_MVE
+      if (step == 4 && ((uintptr_t) src & 3u) == 0) {
+        for (; i < n; i += 4) {
+          mve_pred16_t const p = vctp32q(n - i);
+          int32x4_t const v = vldrwq_z_s32((int32_t const*) (void const*) (src + 4 * i), p);
+          vstrwq_p_s32(out + i, vshlq_n_s32(v, 8), p);
+        }
+      }
+      #endif
+      for (; i < n; i++) {
+        out[i] = (int32_t) (tu_unaligned_read32(src + i * step) << 8);
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S32:
+      if (step == 4) {
+        memcpy(out, src, 4 * n);
+        break;
+      }
+      for (; i < n; i++) {
+        out[i] = (int32_t) tu_unaligned_read32(src + i * step);
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_F32:
+      for (; i < n; i++) {
+        float f;
+        memcpy(&f, src + i * step, 4);
+        out[i] = f32_to_q31(f);
+      }
+      break;
+
+    default: break;
+  }
+}
+
+static void store_q31(uint8_t* dst, uint8_t format, uint16_t step, int32_t const* in, uint32_t n) {
+  uint32_t i = 0;
+
+  switch (format) {
+    case AUDIO_SAMPLE_FORMAT_S16:
+      if (step == 2) {
+        #if AUDIO_CONVERT_MVE
+        if (((uintptr_t) dst & 1u) == 0) {
+          for (; i < n; i += 4) {
+            mve_pred16_t const p = vctp32q(n - i);
+            int32x4_t const v = vldrwq_z_s32(in + i, p);
+            vstrhq_p_s32((int16_t*) (void*) (dst + 2 * i), vshrq_n_s32(v, 16), p);
+          }
+        }
+        #endif
+        for (; i + 2 <= n; i += 2) {
+          uint32_t const w = ((uint32_t) in[i] >> 16) | ((uint32_t) in[i + 1] & 0xFFFF0000u);
+          tu_unaligned_write32(dst + 2 * i, w);
+        }
+      }
+      for (; i < n; i++) {
+        tu_unaligned_write16(dst + i * step, (uint16_t) ((uint32_t) in[i] >> 16));
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S24:
+      if (step == 3) {
+        // 4 samples into 3 words
+        for (; i + 4 <= n; i += 4) {
+          uint8_t* p = dst + 3 * i;
+          uint32_t const q0 = (uint32_t) in[i];
+          uint32_t const q1 = (uint32_t) in[i + 1];
+          uint32_t const q2 = (uint32_t) in[i + 2];
+          uint32_t const q3 = (uint32_t) in[i + 3];
+          tu_unaligned_write32(p, (q0 >> 8) | ((q1 & 0x0000FF00u) << 16));
+          tu_unaligned_write32(p + 4, (q1 >> 16) | ((q2 & 0x00FFFF00u) << 8));
+          tu_unaligned_write32(p + 8, (q2 >> 24) | (q3 & 0xFFFFFF00u));
+        }
+      }
+      for (; i < n; i++) {
+        uint8_t* p = dst + i * step;
+        uint32_t const q = (uint32_t) in[i];
+        p[0] = (uint8_t) (q >> 8);
+        p[1] = (uint8_t) (q >> 16);
+        p[2] = (uint8_t) (q >> 24);
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S24_32:
+      #if AUDIO_CONVERT_MVE
+      if (step == 4 && ((uintptr_t) dst & 3u) == 0) {
+        for (; i < n; i += 4) {
+          mve_pred16_t const p = vctp32q(n - i);
+          int32x4_t const v = vldrwq_z_s32(in + i, p);
+          vstrwq_p_s32((int32_t*) (void*) (dst + 4 * i), vshrq_n_s32(v, 8), p);
+        }
+      }
+      #endif
+      for (; i < n; i++) {
+        tu_unaligned_write32(dst + i * step, (uint32_t) (in[i] >> 8)); // arithmetic shift keeps sign extension
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_S32:
+      if (step == 4) {
+        memcpy(dst, in, 4 * n);
+        break;
+      }
+      for (; i < n; i++) {
+        tu_unaligned_write32(dst + i * step, (uint32_t) in[i]);
+      }
+      break;
+
+    case AUDIO_SAMPLE_FORMAT_F32:
+      for (; i < n; i++) {
+        float const f = q31_to_f32(in[i]);
+        memcpy(dst + i * step, &f, 4);
+      }
+      break;
+
+    default: break;
+  }
+}
+
+// acc = acc + in * gain, saturated. With Helium the gain is rounded, result may differ from scalar in the LSB
+static void mix_q31(int32_t* acc, int32_t const* in, uint16_t gain, uint32_t n) {
+  #if AUDIO_CONVERT_MVE
+  int32_t const g = (int32_t) ((uint32_t) gain << 15);
+  for (uint32_t i = 0; i < n; i += 4) {
+    mve_pred16_t const p = vctp32q(n - i);
+    int32x4_t v = vldrwq_z_s32(in + i, p);
+    if (gain != AUDIO_GAIN_UNITY) {
+      v = vqshlq_n_s32(vqrdmulhq_n_s32(v, g), 1);
+    }
+    vstrwq_p_s32(acc + i, vqaddq_s32(vldrwq_z_s32(acc + i, p), v), p);
+  }
+  #else
+  if (gain == AUDIO_GAIN_UNITY) {
+    for (uint32_t i = 0; i < n; i++) {
+      acc[i] = q31_add(acc[i], in[i]);
+    }
+  } else {
+    for (uint32_t i = 0; i < n; i++) {
+      acc[i] = q31_add(acc[i], q31_gain(in[i], gain));
+    }
+  }
+  #endif
+}
+
+//--------------------------------------------------------------------+
+// Lane: samples of one channel (or all samples of interleaved buffers) spaced by a fixed step
+//--------------------------------------------------------------------+
+typedef struct {
+  uint8_t  format;
+  uint8_t  buf;   // index into buffer array
+  uint16_t step;  // bytes between consecutive samples
+  uint32_t pos;   // byte position of first sample
+} audio_lane_t;
+
+// Mix n samples of a lane of n_src streams into a lane of dst
+static void lane_mix(uint8_t* dst, uint8_t dst_format, uint16_t dst_step, void const* const* const* src,
+                     audio_lane_t const* src_lane, uint16_t const* gain, uint8_t n_src, uint32_t n) {
+  uint16_t const g0 = gain ? gain[0] : AUDIO_GAIN_UNITY;
+
+  // single stream of the same format: plain copy
+  if (n_src == 1 && g0 == AUDIO_GAIN_UNITY && dst_format == src_lane->format) {
+    uint8_t const* p = (uint8_t const*) src[0][src_lane->buf] + src_lane->pos;
+    uint8_t const sz = audio_sample_size(dst_format);
+    if (dst_step == sz && src_lane->step == sz) {
+      memcpy(dst, p, n * sz);
+    } else {
+      for (uint32_t i = 0; i < n; i++) {
+        memcpy(dst + i * dst_step, p + i * src_lane->step, sz);
+      }
+    }
+    return;
+  }
+
+  int32_t acc[AUDIO_CONVERT_BLOCK];
+  int32_t tmp[AUDIO_CONVERT_BLOCK];
+
+  for (uint32_t done = 0; done < n;) {
+    uint32_t const count = tu_min32(n - done, AUDIO_CONVERT_BLOCK);
+    uint32_t const pos = src_lane->pos + done * src_lane->step;
+
+    load_q31(acc, (uint8_t const*) src[0][src_lane->buf] + pos, src_lane->format, src_lane->step, count);
+    if (g0 != AUDIO_GAIN_UNITY) {
+      for (uint32_t i = 0; i < count; i++) {
+        acc[i] = q31_gain(acc[i], g0);
+      }
+    }
+
+    for (uint8_t s = 1; s < n_src; s++) {
+      load_q31(tmp, (uint8_t const*) src[s][src_lane->buf] + pos, src_lane->format, src_lane->step, count);
+      mix_q31(acc, tmp, gain ? gain[s] : AUDIO_GAIN_UNITY, count);
+    }
+
+    store_q31(dst + done * dst_step, dst_format, dst_step, acc, count);
+    done += count;
+  }
+}
+
+TU_ATTR_ALWAYS_INLINE static inline audio_lane_t layout_lane(audio_layout_t const* layout, uint8_t ch, uint32_t frame) {
+  uint8_t const sz = audio_sample_size(layout->format);
+  audio_lane_t lane = {
+    .format = layout->format,
+    .buf    = layout->planar ? ch : 0,
+    .step   = (uint16_t) (layout->planar ? sz : sz * layout->channels),
+    .pos    = layout->planar ? frame * sz : (frame * layout->channels + ch) * sz
+  };
+  return lane;
+}
+
+static void layout_mix(audio_layout_t const* dst_layout, void* const* dst, uint32_t dst_ofs,
+                       audio_layout_t const* src_layout, void const* const* const* src, uint16_t const* gain,
+                       uint8_t n_src, uint32_t src_ofs, uint32_t n_frames) {
+  if (n_src == 0 || n_frames == 0 || dst_layout->channels != src_layout->channels ||
+      audio_sample_size(dst_layout->format) == 0 || audio_sample_size(src_layout->format) == 0) {
+    return;
+  }
+
+  // both interleaved: a single contiguous lane of all samples
+  if (!dst_layout->planar && !src_layout->planar) {
+    audio_lane_t const d = layout_lane(dst_layout, 0, dst_ofs);
+    audio_lane_t s = layout_lane(src_layout, 0, src_ofs);
+    s.step = audio_sample_size(src_layout->format);
+    lane_mix((uint8_t*) dst[0] + d.pos, d.format, audio_sample_size(d.format), src, &s, gain, n_src,
+             n_frames * dst_layout->channels);
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < dst_layout->channels; ch++) {
+    audio_lane_t const d = layout_lane(dst_layout, ch, dst_ofs);
+    audio_lane_t const s = layout_lane(src_layout, ch, src_ofs);
+    lane_mix((uint8_t*) dst[d.buf] + d.pos, d.format, d.step, src, &s, gain, n_src, n_frames);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Public API
+//--------------------------------------------------------------------+
+uint8_t audio_sample_size(uint8_t format) {
+  static const uint8_t sample_size[AUDIO_SAMPLE_FORMAT_COUNT] = {2, 3, 4, 4, 4};
+  return (format < AUDIO_SAMPLE_FORMAT_COUNT) ? sample_size[format] : 0;
+}
+
+void audio_convert(audio_layout_t const* dst_layout, void* const* dst, uint32_t dst_ofs,
+                   audio_layout_t const* src_layout, void const* const* src, uint32_t src_ofs, uint32_t n_frames) {
+  layout_mix(dst_layout, dst, dst_ofs, src_layout, &src, NULL, 1, src_ofs, n_frames);
+}
+
+void audio_mix(audio_layout_t const* dst_layout, void* const* dst, uint32_t dst_ofs,
+               audio_layout_t const* src_layout, void const* const* const* src, uint16_t const* gain, uint8_t n_src,
+               uint32_t src_ofs, uint32_t n_frames) {
+  layout_mix(dst_layout, dst, dst_ofs, src_layout, src, gain, n_src, src_ofs, n_frames);
+}
+
+//--------------------------------------------------------------------+
+// FIFO
+// Frames are converted in place from/to the reserved FIFO spans. The frame split by the wrap is handled sample by
+// sample, the sample split itself (if any) is bounced through a word.
+//--------------------------------------------------------------------+
+uint16_t audio_fifo_read_convert(tu_fifo_t* ff, audio_layout_t const* ff_layout, audio_layout_t const* layout,
+                                 void* const* dst, uint16_t n_frames) {
+  uint16_t const frame_sz = audio_frame_size(ff_layout);
+  uint8_t const sz = audio_sample_size(ff_layout->format);
+  TU_VERIFY(frame_sz > 0 && !ff_layout->planar && ff_layout->channels == layout->channels &&
+            audio_sample_size(layout->format) > 0, 0);
+
+  tu_fifo_buffer_info_t info;
+  n_frames = tu_min16(n_frames, ff->depth / frame_sz);
+  n_frames = tu_fifo_read_reserve(ff, &info, (uint16_t) (n_frames * frame_sz)) / frame_sz;
+  uint16_t const n_bytes = (uint16_t) (n_frames * frame_sz);
+
+  void const* buf[1] = {info.linear.ptr};
+  uint16_t done = tu_min16(info.linear.len, n_bytes) / frame_sz;
+  audio_convert(layout, dst, 0, ff_layout, buf, 0, done);
+
+  if (done < n_frames) {
+    uint16_t const part = (uint16_t) (info.linear.len - done * frame_sz);
+    uint8_t const* wrapped = info.wrapped.ptr;
+
+    if (part > 0) {
+      uint8_t const* lin = info.linear.ptr + done * frame_sz;
+      for (uint8_t ch = 0; ch < layout->channels; ch++) {
+        uint16_t const ofs = (uint16_t) (ch * sz);
+        uint8_t bounce[4];
+        void const* p;
+        if (ofs + sz <= part) {
+          p = lin + ofs;
+        } else if (ofs >= part) {
+          p = wrapped + (ofs - part);
+        } else {
+          memcpy(bounce, lin + ofs, part - ofs);
+          memcpy(bounce + (part - ofs), wrapped, (size_t) (sz - (part - ofs)));
+          p = bounce;
+        }
+
+        void const* const* sample = &p;
+        audio_lane_t const s = {.format = ff_layout->format, .buf = 0, .step = sz, .pos = 0};
+        audio_lane_t const d = layout_lane(layout, ch, done);
+        lane_mix((uint8_t*) dst[d.buf] + d.pos, d.format, d.step, &sample, &s, NULL, 1, 1);
+      }
+      wrapped += frame_sz - part;
+      done++;
+    }
+
+    buf[0] = wrapped;
+    audio_convert(layout, dst, done, ff_layout, buf, 0, (uint32_t) (n_frames - done));
+  }
+
+  tu_fifo_read_commit(ff, n_bytes);
+  return n_frames;
+}
+
+uint16_t audio_fifo_write_mix(tu_fifo_t* ff, audio_layout_t const* ff_layout, audio_layout_t const* layout,
+                              void const* const* const* src, uint16_t const* gain, uint8_t n_src, uint16_t n_frames) {
+  uint16_t const frame_sz = audio_frame_size(ff_layout);
+  uint8_t const sz = audio_sample_size(ff_layout->format);
+  TU_VERIFY(frame_sz > 0 && !ff_layout->planar && ff_layout->channels == layout->channels &&
+            audio_sample_size(layout->format) > 0 && n_src > 0, 0);
+
+  tu_fifo_buffer_info_t info;
+  n_frames = tu_min16(n_frames, ff->depth / frame_sz);
+  n_frames = tu_fifo_write_reserve(ff, &info, (uint16_t) (n_frames * frame_sz)) / frame_sz;
+  uint16_t const n_bytes = (uint16_t) (n_frames * frame_sz);
+
+  void* buf[1] = {info.linear.ptr};
+  uint16_t done = tu_min16(info.linear.len, n_bytes) / frame_sz;
+  layout_mix(ff_layout, buf, 0, layout, src, gain, n_src, 0, done);
+
+  if (done < n_frames) {
+    uint16_t const part = (uint16_t) (info.linear.len - done * frame_sz);
+    uint8_t* wrapped = info.wrapped.ptr;
+
+    if (part > 0) {
+      uint8_t* lin = info.linear.ptr + done * frame_sz;
+      for (uint8_t ch = 0; ch < layout->channels; ch++) {
+        uint16_t const ofs = (uint16_t) (ch * sz);
+        uint8_t bounce[4];
+        uint8_t* p;
+        if (ofs + sz <= part) {
+          p = lin + ofs;
+        } else if (ofs >= part) {
+          p = wrapped + (ofs - part);
+        } else {
+          p = bounce;
+        }
+
+        audio_lane_t const s = layout_lane(layout, ch, done);
+        lane_mix(p, ff_layout->format, sz, src, &s, gain, n_src, 1);
+
+        if (p == bounce) {
+          memcpy(lin + ofs, bounce, part - ofs);
+          memcpy(wrapped, bounce + (part - ofs), (size_t) (sz - (part - ofs)));
+        }
+      }
+      wrapped += frame_sz - part;
+      done++;
+    }
+
+    buf[0] = wrapped;
+    layout_mix(ff_layout, buf, 0, layout, src, gain, n_src, done, (uint32_t) (n_frames - done));
+  }
+
+  tu_fifo_write_commit(ff, n_bytes);
+  return n_frames;
+}
+
+#endif
+#endif
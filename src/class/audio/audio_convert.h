@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_AUDIO_CONVERT_H_
+#define TUSB_AUDIO_CONVERT_H_
+
+#include "common/tusb_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Sample conversion stage between endpoint FIFO and application buffers
+//
+// Samples are converted through a 32-bit intermediate (Q31): integer formats are MSB justified, so narrowing
+// truncates the LSBs and widening pads them with zero. Float is full scale -1.0 to 1.0 and clipped when converted to
+// integer. Mixing applies a Q1.15 gain per stream and saturates.
+//
+// Contiguous runs use word-at-a-time kernels, or Helium (MVE) / DSP extension when the compiler targets them. Strided
+// runs (planar <-> interleaved) use the scalar kernels which are also the reference for unit tests.
+//--------------------------------------------------------------------+
+
+// Sample formats, little endian. A USB subslot holds its sample MSB justified (UAC2 Frmts 2.3.1.1): 24-bit in a
+// 4-byte subslot is AUDIO_SAMPLE_FORMAT_S32, 24-bit in a 3-byte subslot is AUDIO_SAMPLE_FORMAT_S24.
+typedef enum {
+  AUDIO_SAMPLE_FORMAT_S16 = 0, // 16-bit signed
+  AUDIO_SAMPLE_FORMAT_S24,     // 24-bit signed packed in 3 bytes
+  AUDIO_SAMPLE_FORMAT_S24_32,  // 24-bit signed LSB justified in 4 bytes (sign extended), as used by most I2S/SAI DMA
+  AUDIO_SAMPLE_FORMAT_S32,     // 32-bit signed
+  AUDIO_SAMPLE_FORMAT_F32,     // 32-bit float
+  AUDIO_SAMPLE_FORMAT_COUNT
+} audio_sample_format_t;
+
+// Buffer layout: buffers are passed as an array of channel buffers if planar, otherwise as an array of one buffer of
+// interleaved frames
+typedef struct {
+  uint8_t format;   // audio_sample_format_t
+  uint8_t channels; // channels per frame
+  bool    planar;   // one buffer per channel
+} audio_layout_t;
+
+// Mix gain of 1.0 in Q1.15, max gain is 0xFFFF (~2.0)
+#define AUDIO_GAIN_UNITY 0x8000u
+
+// Bytes per sample of a format, 0 if invalid
+uint8_t audio_sample_size(uint8_t format);
+
+// Bytes per frame of an interleaved layout
+TU_ATTR_ALWAYS_INLINE static inline uint16_t audio_frame_size(audio_layout_t const* layout) {
+  return (uint16_t) (audio_sample_size(layout->format) * layout->channels);
+}
+
+// Convert n_frames from src starting at frame src_ofs into dst starting at frame dst_ofs. Layouts must have the same
+// number of channels, buffers must not overlap.
+void audio_convert(audio_layout_t const* dst_layout, void* const* dst, uint32_t dst_ofs,
+                   audio_layout_t const* src_layout, void const* const* src, uint32_t src_ofs, uint32_t n_frames);
+
+// Mix n_src streams of the same src_layout into dst: dst = sum(src[i] * gain[i]), gain NULL for unity
+void audio_mix(audio_layout_t const* dst_layout, void* const* dst, uint32_t dst_ofs,
+               audio_layout_t const* src_layout, void const* const* const* src, uint16_t const* gain, uint8_t n_src,
+               uint32_t src_ofs, uint32_t n_frames);
+
+// Read up to n_frames whole frames of interleaved ff_layout from FIFO, converted into dst. Return frames read
+uint16_t audio_fifo_read_convert(tu_fifo_t* ff, audio_layout_t const* ff_layout,
+                                 audio_layout_t const* layout, void* const* dst, uint16_t n_frames);
+
+// Mix n_src streams (see audio_mix()) into FIFO as interleaved ff_layout, only whole frames that fit are written.
+// Return frames written
+uint16_t audio_fifo_write_mix(tu_fifo_t* ff, audio_layout_t const* ff_layout, audio_layout_t const* layout,
+                              void const* const* const* src, uint16_t const* gain, uint8_t n_src, uint16_t n_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
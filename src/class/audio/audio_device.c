@@ -168,6 +168,9 @@ typedef struct
   uint8_t ep_in_as_intf_num;// Corresponding Standard AS Interface Descriptor (4.9.1) belonging to output terminal to which this EP belongs - 0 is invalid (this fits to UAC2 specification since AS interfaces can not have interface number equal to zero)
   uint8_t ep_in_alt;        // Current alternate setting of TX EP
   uint16_t ep_in_fifo_threshold;// Target size for the EP IN FIFO.
+  #if CFG_TUD_AUDIO_ENABLE_CONVERT
+  audio_layout_t ep_in_layout;  // Sample format of EP IN stream for the conversion stage
+  #endif
   #endif
 
 #if CFG_TUD_AUDIO_ENABLE_EP_OUT
@@ -175,6 +178,9 @@ typedef struct
   uint16_t ep_out_sz;        // Current size of RX EP
   uint8_t ep_out_as_intf_num;// Corresponding Standard AS Interface Descriptor (4.9.1) belonging to input terminal to which this EP belongs - 0 is invalid (this fits to UAC2 specification since AS interfaces can not have interface number equal to zero)
   uint8_t ep_out_alt;        // Current alternate setting of RX EP
+  #if CFG_TUD_AUDIO_ENABLE_CONVERT
+  audio_layout_t ep_out_layout;// Sample format of EP OUT stream for the conversion stage
+  #endif
   #if CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
   uint8_t ep_fb;// Feedback EP.
   #endif
@@ -210,6 +216,12 @@ typedef struct
         uint16_t fifo_lvl_thr; // fifo level threshold
         uint16_t rate_const[2];// pre-computed feedback/fifo_depth rate
       } fifo_count;
+
+      struct {
+        audio_feedback_pi_t ctrl;
+        uint32_t sample_freq;// for MCLK measurement, mclk_freq = 0 if not used
+        uint32_t mclk_freq;
+      } fifo_pi;
     } compute;
 
   } feedback;
@@ -445,6 +457,24 @@ tu_fifo_t *tud_audio_n_get_ep_out_ff(uint8_t func_id) {
   return NULL;
 }
 
+#if CFG_TUD_AUDIO_ENABLE_CONVERT
+bool tud_audio_n_set_ep_out_format(uint8_t func_id, uint8_t format, uint8_t channels) {
+  TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
+  TU_VERIFY(audio_sample_size(format) > 0 && channels > 0);
+  audio_layout_t* ff_layout = &_audiod_fct[func_id].ep_out_layout;
+  ff_layout->format   = format;
+  ff_layout->channels = channels;
+  ff_layout->planar   = false;
+  return true;
+}
+
+uint16_t tud_audio_n_read_convert(uint8_t func_id, audio_layout_t const* layout, void* const* buffer, uint16_t n_frames) {
+  TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
+  audiod_function_t* audio = &_audiod_fct[func_id];
+  return audio_fifo_read_convert(&audio->ep_out_ff, &audio->ep_out_layout, layout, buffer, n_frames);
+}
+#endif
+
 static bool audiod_rx_xfer_isr(uint8_t rhport, audiod_function_t* audio, uint16_t n_bytes_received) {
   uint8_t idx_audio_fct = audiod_get_audio_fct_idx(audio);
 
@@ -462,6 +492,8 @@ static bool audiod_rx_xfer_isr(uint8_t rhport, audiod_function_t* audio, uint16_
   #if CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
   if (audio->feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_COUNT) {
     audiod_fb_fifo_count_update(audio, tu_fifo_count(&audio->ep_out_ff));
+  } else if (audio->feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_PI) {
+    audio->feedback.value = audio_feedback_pi_level_update(&audio->feedback.compute.fifo_pi.ctrl, tu_fifo_count(&audio->ep_out_ff));
   }
   #endif
 
@@ -508,6 +540,29 @@ void tud_audio_n_set_ep_in_fifo_threshold(uint8_t func_id, uint16_t threshold) {
   }
 }
 
+#if CFG_TUD_AUDIO_ENABLE_CONVERT
+bool tud_audio_n_set_ep_in_format(uint8_t func_id, uint8_t format, uint8_t channels) {
+  TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
+  TU_VERIFY(audio_sample_size(format) > 0 && channels > 0);
+  audio_layout_t* ff_layout = &_audiod_fct[func_id].ep_in_layout;
+  ff_layout->format   = format;
+  ff_layout->channels = channels;
+  ff_layout->planar   = false;
+  return true;
+}
+
+uint16_t tud_audio_n_write_convert(uint8_t func_id, audio_layout_t const* layout, void const* const* buffer, uint16_t n_frames) {
+  return tud_audio_n_write_mix(func_id, layout, &buffer, NULL, 1, n_frames);
+}
+
+uint16_t tud_audio_n_write_mix(uint8_t func_id, audio_layout_t const* layout, void const* const* const* src,
+                               uint16_t const* gain, uint8_t n_src, uint16_t n_frames) {
+  TU_VERIFY(func_id < CFG_TUD_AUDIO && _audiod_fct[func_id].p_desc != NULL);
+  audiod_function_t* audio = &_audiod_fct[func_id];
+  return audio_fifo_write_mix(&audio->ep_in_ff, &audio->ep_in_layout, layout, src, gain, n_src, n_frames);
+}
+#endif
+
 static bool audiod_tx_xfer_isr(uint8_t rhport, audiod_function_t * audio, uint16_t n_bytes_sent) {
   uint8_t idx_audio_fct = audiod_get_audio_fct_idx(audio);
 
@@ -610,6 +665,13 @@ uint32_t tud_audio_feedback_update(uint8_t func_id, uint32_t cycles) {
       feedback = (uint32_t) (fb64 / audio->feedback.compute.fixed.mclk_freq);
     } break;
 
+    case AUDIO_FEEDBACK_METHOD_FIFO_PI: {
+      TU_VERIFY(audio->feedback.compute.fifo_pi.mclk_freq, 0);
+      uint64_t fb64 = (((uint64_t) cycles) * audio->feedback.compute.fifo_pi.sample_freq) << (16 - (audio->feedback.frame_shift - 1));
+      // Measurement is filtered and combined with FIFO correction, already within min/max
+      feedback = audio_feedback_pi_rate_update(&audio->feedback.compute.fifo_pi.ctrl, (uint32_t) (fb64 / audio->feedback.compute.fifo_pi.mclk_freq));
+    } break;
+
     default:
       return 0;
   }
@@ -637,6 +699,16 @@ bool tud_audio_n_fb_set(uint8_t func_id, uint32_t feedback) {
 
   return true;
 }
+
+bool tud_audio_n_feedback_pi_get(uint8_t func_id, audio_feedback_pi_t* state) {
+  TU_VERIFY(func_id < CFG_TUD_AUDIO && state != NULL);
+  audiod_function_t const *audio = &_audiod_fct[func_id];
+  TU_VERIFY(audio->ep_fb != 0 && audio->feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_PI);
+
+  *state = audio->feedback.compute.fifo_pi.ctrl;
+
+  return true;
+}
 #endif
 
 uint8_t tud_audio_n_version(uint8_t func_id) {
@@ -1249,7 +1321,9 @@ static bool audiod_set_interface(uint8_t rhport, tusb_control_request_t const *p
     if (_audiod_fct[i].ep_fb != 0 &&
         (_audiod_fct[i].feedback.compute_method == AUDIO_FEEDBACK_METHOD_FREQUENCY_FIXED ||
          _audiod_fct[i].feedback.compute_method == AUDIO_FEEDBACK_METHOD_FREQUENCY_FLOAT ||
-         _audiod_fct[i].feedback.compute_method == AUDIO_FEEDBACK_METHOD_FREQUENCY_POWER_OF_2)) {
+         _audiod_fct[i].feedback.compute_method == AUDIO_FEEDBACK_METHOD_FREQUENCY_POWER_OF_2 ||
+         (_audiod_fct[i].feedback.compute_method == AUDIO_FEEDBACK_METHOD_FIFO_PI &&
+          _audiod_fct[i].feedback.compute.fifo_pi.mclk_freq != 0))) {
       enable_sof = true;
       break;
     }
@@ -1583,6 +1657,19 @@ static bool audiod_fb_params_prepare(uint8_t func_id, uint8_t alt) {
         }
       } break;
 
+      case AUDIO_FEEDBACK_METHOD_FIFO_PI: {
+        uint16_t fifo_threshold = fb_param.fifo_pi.fifo_threshold ? fb_param.fifo_pi.fifo_threshold : tu_fifo_depth(&audio->ep_out_ff) / 2;
+        TU_ASSERT(fifo_threshold < tu_fifo_depth(&audio->ep_out_ff));
+        // Avoid 64bit division
+        uint32_t nominal = ((fb_param.sample_freq / 100) << 16) / (frame_div / 100);
+        audio_feedback_pi_init(&audio->feedback.compute.fifo_pi.ctrl, nominal, audio->feedback.min_value,
+                               audio->feedback.max_value, fifo_threshold, tud_speed_get() == TUSB_SPEED_HIGH);
+        audio->feedback.value = nominal;
+
+        audio->feedback.compute.fifo_pi.sample_freq = fb_param.sample_freq;
+        audio->feedback.compute.fifo_pi.mclk_freq = fb_param.fifo_pi.mclk_freq;
+      } break;
+
       // nothing to do
       default:
         break;
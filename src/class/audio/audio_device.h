@@ -11,6 +11,8 @@
 #define TUSB_AUDIO_DEVICE_H_
 
 #include "audio.h"
+#include "audio_convert.h"
+#include "audio_feedback.h"
 
 //--------------------------------------------------------------------+
 // Class Driver Configuration
@@ -142,6 +144,12 @@
 // Audio control interrupt EP - 6 Bytes according to UAC 2 specification (p. 74)
 #define CFG_TUD_AUDIO_INTERRUPT_EP_SZ                       6
 
+// Enable/disable sample conversion stage: read/write EP FIFOs in another sample format and buffer layout (planar or
+// interleaved), and mix several streams into EP IN FIFO. See audio_convert.h
+#ifndef CFG_TUD_AUDIO_ENABLE_CONVERT
+#define CFG_TUD_AUDIO_ENABLE_CONVERT                        0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -177,6 +185,30 @@ void       tud_audio_n_set_ep_in_fifo_threshold(uint8_t func_id, uint16_t thresh
 bool    tud_audio_int_n_write                     (uint8_t func_id, const audio_interrupt_data_t * data);
 #endif
 
+#if CFG_TUD_AUDIO_ENABLE_CONVERT
+// Sample format (audio_sample_format_t) and channel count of the EP streams, as of the current alternate setting.
+// Typically set in tud_audio_set_itf_cb(), cleared on bus reset.
+#if CFG_TUD_AUDIO_ENABLE_EP_OUT
+bool       tud_audio_n_set_ep_out_format(uint8_t func_id, uint8_t format, uint8_t channels);
+
+// Read up to n_frames whole frames converted into buffers of layout (array of channel buffers if planar).
+// Return number of frames read
+uint16_t   tud_audio_n_read_convert     (uint8_t func_id, audio_layout_t const* layout, void* const* buffer, uint16_t n_frames);
+#endif
+
+#if CFG_TUD_AUDIO_ENABLE_EP_IN
+bool       tud_audio_n_set_ep_in_format (uint8_t func_id, uint8_t format, uint8_t channels);
+
+// Write up to n_frames whole frames converted from buffers of layout. Return number of frames written
+uint16_t   tud_audio_n_write_convert    (uint8_t func_id, audio_layout_t const* layout, void const* const* buffer, uint16_t n_frames);
+
+// Mix n_src streams of the same layout with Q1.15 gain each (NULL for AUDIO_GAIN_UNITY) and write up to n_frames
+// whole frames. Return number of frames written
+uint16_t   tud_audio_n_write_mix        (uint8_t func_id, audio_layout_t const* layout, void const* const* const* src,
+                                         uint16_t const* gain, uint8_t n_src, uint16_t n_frames);
+#endif
+#endif
+
 //--------------------------------------------------------------------+
 // Application API (Interface0)
 //--------------------------------------------------------------------+
@@ -202,6 +234,14 @@ static inline tu_fifo_t* tud_audio_get_ep_in_ff   (void);
 static inline bool tud_audio_int_write                      (const audio_interrupt_data_t * data);
 #endif
 
+#if CFG_TUD_AUDIO_ENABLE_CONVERT && CFG_TUD_AUDIO_ENABLE_EP_OUT
+static inline uint16_t tud_audio_read_convert (audio_layout_t const* layout, void* const* buffer, uint16_t n_frames);
+#endif
+
+#if CFG_TUD_AUDIO_ENABLE_CONVERT && CFG_TUD_AUDIO_ENABLE_EP_IN
+static inline uint16_t tud_audio_write_convert(audio_layout_t const* layout, void const* const* buffer, uint16_t n_frames);
+#endif
+
 // Buffer control EP data and schedule a transmit
 // This function is intended to be used if you do not have a persistent buffer or memory location available
 // (e.g. non-local variables) and need to answer onto a get request. This function buffers your answer request
@@ -256,7 +296,17 @@ bool tud_audio_rx_done_isr(uint8_t rhport, uint16_t n_bytes_received, uint8_t fu
 // hence, the ISR must has a high priority such that no software dependent "random" delay i.e. jitter is
 // introduced). Long-term drift will cause the FIFO under/overflow, you still needs to correct it somehow.
 //
-// Option 3 - manual
+// Option 3 - AUDIO_FEEDBACK_METHOD_FIFO_PI
+// Feedback value is calculated within the audio driver by a PI controller regulating the FIFO level to a latency
+// set-point, see audio_feedback.h. Filtering and gains adapt from startup (fast acquire) to steady state (lock).
+// Optionally MCLK cycles passed to tud_audio_feedback_update() feed forward the measured rate, jitter filtered, so
+// the FIFO loop only corrects the remaining drift (SOF interrupt is then enabled).
+// Advantage: No oscillation around the set-point and no long-term drift, hence the FIFO can be sized close to the
+// set-point plus packet jitter (e.g. 2-3 frames) for a lower delay than option 1.
+// Disadvantage: Slightly more computation per received packet, settling takes a few hundred ms after stream start.
+// Controller state can be read with tud_audio_n_feedback_pi_get() for telemetry.
+//
+// Option 4 - manual
 // Determined by the user itself and set by use of tud_audio_n_fb_set(). The feedback value may be determined
 // e.g. from some fill status of some FIFO buffer.
 // Advantage: No ISR interrupt is enabled, hence the CPU need not to handle an ISR every 1ms or 125us and thus
@@ -299,12 +349,17 @@ bool tud_audio_n_fb_set(uint8_t func_id, uint32_t feedback);
 //   In 4 SOF MCLK counted 49152 cycles
 uint32_t tud_audio_feedback_update(uint8_t func_id, uint32_t cycles);
 
+// Get a snapshot of the FIFO PI controller state (AUDIO_FEEDBACK_METHOD_FIFO_PI only) e.g. for telemetry.
+// Copied with the feedback computation possibly running in ISR, fields may be one update apart
+bool tud_audio_n_feedback_pi_get(uint8_t func_id, audio_feedback_pi_t* state);
+
 enum {
   AUDIO_FEEDBACK_METHOD_DISABLED,
   AUDIO_FEEDBACK_METHOD_FREQUENCY_FIXED,
   AUDIO_FEEDBACK_METHOD_FREQUENCY_FLOAT,
   AUDIO_FEEDBACK_METHOD_FREQUENCY_POWER_OF_2, // For driver internal use only
-  AUDIO_FEEDBACK_METHOD_FIFO_COUNT
+  AUDIO_FEEDBACK_METHOD_FIFO_COUNT,
+  AUDIO_FEEDBACK_METHOD_FIFO_PI
 };
 
 typedef struct {
@@ -318,6 +373,10 @@ typedef struct {
     struct {
       uint16_t fifo_threshold;  // Target FIFO threshold level, default to half FIFO if not set
     } fifo_count;
+    struct {
+      uint16_t fifo_threshold;  // Target FIFO level i.e. latency set-point in bytes, default to half FIFO if not set
+      uint32_t mclk_freq;       // Main clock frequency in Hz if MCLK cycles are passed to tud_audio_feedback_update(), else 0
+    } fifo_pi;
   };
 } audio_feedback_params_t;
 
@@ -427,10 +486,26 @@ TU_ATTR_ALWAYS_INLINE static inline bool tud_audio_int_write(const audio_interru
 }
 #endif
 
+#if CFG_TUD_AUDIO_ENABLE_CONVERT && CFG_TUD_AUDIO_ENABLE_EP_OUT
+TU_ATTR_ALWAYS_INLINE static inline uint16_t tud_audio_read_convert(audio_layout_t const* layout, void* const* buffer, uint16_t n_frames) {
+  return tud_audio_n_read_convert(0, layout, buffer, n_frames);
+}
+#endif
+
+#if CFG_TUD_AUDIO_ENABLE_CONVERT && CFG_TUD_AUDIO_ENABLE_EP_IN
+TU_ATTR_ALWAYS_INLINE static inline uint16_t tud_audio_write_convert(audio_layout_t const* layout, void const* const* buffer, uint16_t n_frames) {
+  return tud_audio_n_write_convert(0, layout, buffer, n_frames);
+}
+#endif
+
 #if CFG_TUD_AUDIO_ENABLE_EP_OUT && CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
 TU_ATTR_ALWAYS_INLINE static inline bool tud_audio_fb_set(uint32_t feedback) {
   return tud_audio_n_fb_set(0, feedback);
 }
+
+TU_ATTR_ALWAYS_INLINE static inline bool tud_audio_feedback_pi_get(audio_feedback_pi_t* state) {
+  return tud_audio_n_feedback_pi_get(0, state);
+}
 #endif
 
 //--------------------------------------------------------------------+
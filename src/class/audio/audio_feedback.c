@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if (CFG_TUD_ENABLED && CFG_TUD_AUDIO)
+
+#include "device/usbd.h"
+#include "device/usbd_pvt.h"
+
+#include "audio_device.h"
+
+#if CFG_TUD_AUDIO_ENABLE_EP_OUT && CFG_TUD_AUDIO_ENABLE_FEEDBACK_EP
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF
+//--------------------------------------------------------------------+
+
+// Gains and filters are shifts per update (one packet per frame at full speed), high speed adds hs_shift to filter
+// and integral so that time constants stay the same in ms. With Kp = 1 a set-point of N frames settles in about
+// N * samples per frame updates, integral time is kept well above that for a damped response.
+#define FB_PI_LPF_SHIFT_ACQUIRE   3
+#define FB_PI_LPF_SHIFT_LOCK      5
+#define FB_PI_KP_SHIFT_ACQUIRE    0
+#define FB_PI_KP_SHIFT_LOCK       1
+#define FB_PI_KI_SHIFT_ACQUIRE    9
+#define FB_PI_KI_SHIFT_LOCK       12
+
+// Lock once level stays within set-point/8 for this many frames, unlock when off by more than set-point/2
+#define FB_PI_LOCK_FRAMES         256u
+
+// Low-pass of measured rate (per feedback interval)
+#define FB_PI_RATE_SHIFT          3
+
+//--------------------------------------------------------------------+
+//
+//--------------------------------------------------------------------+
+TU_ATTR_ALWAYS_INLINE static inline int64_t fb_clamp(audio_feedback_pi_t const* pi, int64_t value) {
+  if (value > (int64_t) pi->max_value) {
+    return pi->max_value;
+  }
+  if (value < (int64_t) pi->min_value) {
+    return pi->min_value;
+  }
+  return value;
+}
+
+void audio_feedback_pi_init(audio_feedback_pi_t* pi, uint32_t nominal, uint32_t min_value, uint32_t max_value,
+                            uint16_t setpoint, bool high_speed) {
+  tu_memclr(pi, sizeof(audio_feedback_pi_t));
+  if (setpoint == 0) {
+    setpoint = 1;
+  }
+
+  pi->min_value = min_value;
+  pi->max_value = max_value;
+  pi->setpoint  = setpoint;
+  pi->hs_shift  = high_speed ? 3 : 0;
+  pi->base      = nominal;
+  pi->value     = nominal;
+  pi->lvl_avg   = ((uint32_t) setpoint) << 16;
+
+  // One set-point worth of level error is one sample per (micro)frame i.e half of min/max range
+  pi->rate = (uint32_t) ((((uint64_t) (max_value - min_value)) << 7) / setpoint);
+}
+
+uint32_t audio_feedback_pi_level_update(audio_feedback_pi_t* pi, uint16_t level) {
+  uint8_t const lpf_shift = (uint8_t) ((pi->locked ? FB_PI_LPF_SHIFT_LOCK : FB_PI_LPF_SHIFT_ACQUIRE) + pi->hs_shift);
+
+  // Low-pass (averaging) filter
+  int64_t const lvl = (int64_t) pi->lvl_avg + ((((int64_t) level << 16) - (int64_t) pi->lvl_avg) >> lpf_shift);
+  pi->lvl_avg = (uint32_t) lvl;
+
+  // Positive error (FIFO below set-point) asks for more samples
+  int64_t const err_lvl = ((int64_t) pi->setpoint << 16) - lvl;
+  int64_t const range = (int64_t) (pi->max_value - pi->min_value);
+  int64_t err64 = (err_lvl * (int64_t) pi->rate) >> 24;
+  if (err64 > range) {
+    err64 = range;
+  } else if (err64 < -range) {
+    err64 = -range;
+  }
+  int32_t const err = (int32_t) err64;
+
+  // Gain schedule
+  uint32_t const err_bytes = (uint32_t) ((err_lvl < 0 ? -err_lvl : err_lvl) >> 16);
+  if (pi->locked) {
+    if (err_bytes > (pi->setpoint >> 1)) {
+      pi->locked = false;
+    }
+  } else if (err_bytes <= (pi->setpoint >> 3)) {
+    pi->lock_count++;
+    if (pi->lock_count >= (FB_PI_LOCK_FRAMES << pi->hs_shift)) {
+      pi->locked = true;
+      pi->lock_count = 0;
+    }
+  } else {
+    pi->lock_count = 0;
+  }
+
+  uint8_t const kp_shift = pi->locked ? FB_PI_KP_SHIFT_LOCK : FB_PI_KP_SHIFT_ACQUIRE;
+  uint8_t const ki_shift = (uint8_t) ((pi->locked ? FB_PI_KI_SHIFT_LOCK : FB_PI_KI_SHIFT_ACQUIRE) + pi->hs_shift);
+
+  // Integral keeps 8 extra fraction bits, small errors would otherwise be truncated away
+  int32_t integral = pi->integral + ((int32_t) (err * 256) >> ki_shift);
+  int64_t value = (int64_t) pi->base + (err >> kp_shift) + (integral >> 8);
+
+  // Stop integrating while saturated in the direction of error (anti wind-up)
+  int64_t const clamped = fb_clamp(pi, value);
+  if ((clamped < value && err > 0) || (clamped > value && err < 0)) {
+    integral = pi->integral;
+  }
+  value = clamped;
+
+  pi->integral   = integral;
+  pi->correction = (int32_t) (value - (int64_t) pi->base);
+  pi->value      = (uint32_t) value;
+
+  return pi->value;
+}
+
+uint32_t audio_feedback_pi_rate_update(audio_feedback_pi_t* pi, uint32_t measured) {
+  if (measured < pi->min_value || measured > pi->max_value) {
+    return pi->value;
+  }
+
+  if (pi->measured) {
+    pi->base = (uint32_t) ((int64_t) pi->base + (((int64_t) measured - (int64_t) pi->base) >> FB_PI_RATE_SHIFT));
+  } else {
+    // First measurement replaces nominal, integral had only learned the nominal offset
+    pi->base = measured;
+    pi->integral   = 0;
+    pi->correction = 0;
+    pi->measured   = true;
+  }
+
+  pi->value = (uint32_t) fb_clamp(pi, (int64_t) pi->base + pi->correction);
+  return pi->value;
+}
+
+#endif
+#endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_AUDIO_FEEDBACK_H_
+#define TUSB_AUDIO_FEEDBACK_H_
+
+#include "common/tusb_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Feedback PI controller for asynchronous sink (AUDIO_FEEDBACK_METHOD_FIFO_PI)
+//
+// Regulates the receive FIFO level to a set-point (the latency target). The level is low-passed to remove packet
+// jitter, the error is normalized so that one set-point worth of bytes asks for one sample per (micro)frame, then
+// feedback = base + Kp * error + Ki * sum(error), clamped to min/max without integrator wind-up.
+// Base is the nominal rate, or the low-passed measured rate if MCLK cycles are provided: the controller then acts
+// as a PLL where the measurement tracks frequency and the FIFO loop only trims phase (level).
+//
+// It starts in acquire state with light filtering and high gains, and switches to lock state with heavier
+// filtering and lower gains once the level stays near the set-point. A large error (e.g. host paused the stream)
+// returns to acquire. All math is fixed point, suitable for ISR context.
+//--------------------------------------------------------------------+
+
+// Controller state, all feedback values are in 16.16 format
+typedef struct {
+  uint32_t value;      // current feedback value
+  uint32_t base;       // feed-forward: nominal or low-passed measured rate
+  uint32_t min_value;  // clamp limits
+  uint32_t max_value;
+  uint32_t lvl_avg;    // low-passed FIFO level in bytes, 16.16
+  int32_t  integral;   // integral term, 8 extra fraction bits i.e. 16.24
+  int32_t  correction; // last P + I output, i.e value - base
+  uint32_t rate;       // feedback per byte of level error, 24.8
+
+  uint16_t setpoint;   // target FIFO level in bytes
+  uint16_t lock_count; // consecutive updates near set-point while acquiring
+  uint8_t  hs_shift;   // log2 of updates per frame: 3 for high speed
+  bool     locked;     // steady state gains in use
+  bool     measured;   // base is from measured rate
+} audio_feedback_pi_t;
+
+// Reset controller to nominal with level at set-point (bytes, must not be 0)
+void audio_feedback_pi_init(audio_feedback_pi_t* pi, uint32_t nominal, uint32_t min_value, uint32_t max_value,
+                            uint16_t setpoint, bool high_speed);
+
+// Update with FIFO level in bytes, called for every received packet. Return new feedback value
+uint32_t audio_feedback_pi_level_update(audio_feedback_pi_t* pi, uint16_t level);
+
+// Update feed-forward with measured rate in 16.16 e.g computed from MCLK cycles, called every feedback interval.
+// Measurements out of min/max (e.g missed SOF) are dropped. Return new feedback value
+uint32_t audio_feedback_pi_rate_update(audio_feedback_pi_t* pi, uint32_t measured);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
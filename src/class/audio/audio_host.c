@@ -0,0 +1,798 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if (CFG_TUH_ENABLED && CFG_TUH_AUDIO)
+
+#if CFG_TUH_ISO_EP_MAX == 0
+  #error "Audio host requires isochronous transfer, set CFG_TUH_ISO_EP_MAX e.g 3 for IN, OUT and feedback endpoints"
+#endif
+
+#include "host/usbh.h"
+#include "host/usbh_pvt.h"
+#include "audio_host.h"
+
+#define TU_LOG_DRV(...)   TU_LOG(CFG_TUH_AUDIO_LOG_LEVEL, __VA_ARGS__)
+
+// Max clock entities and terminals parsed from Audio Control interface
+#define AUDIOH_ENTITY_MAX  16
+
+//--------------------------------------------------------------------+
+// Weak stubs for application callbacks
+//--------------------------------------------------------------------+
+
+TU_ATTR_WEAK void tuh_audio_mount_cb(uint8_t idx) {
+  (void) idx;
+}
+
+TU_ATTR_WEAK void tuh_audio_umount_cb(uint8_t idx) {
+  (void) idx;
+}
+
+TU_ATTR_WEAK void tuh_audio_stream_start_cb(uint8_t idx, uint8_t dir, bool success) {
+  (void) idx; (void) dir; (void) success;
+}
+
+TU_ATTR_WEAK void tuh_audio_rx_cb(uint8_t idx, uint32_t xferred_bytes) {
+  (void) idx; (void) xferred_bytes;
+}
+
+TU_ATTR_WEAK void tuh_audio_tx_cb(uint8_t idx, uint32_t xferred_bytes) {
+  (void) idx; (void) xferred_bytes;
+}
+
+//--------------------------------------------------------------------+
+// Internal structure and state
+//--------------------------------------------------------------------+
+
+typedef struct {
+  tuh_audio_alt_info_t info;
+  bool clock_programmable;
+  tusb_desc_endpoint_t ep;    // data endpoint
+  tusb_desc_endpoint_t ep_fb; // feedback endpoint, bLength = 0 if not available
+} audioh_alt_t;
+
+enum {
+  AUDIOH_STREAM_IDLE = 0,
+  AUDIOH_STREAM_SET_RATE,
+  AUDIOH_STREAM_SET_ITF,
+  AUDIOH_STREAM_STREAMING,
+  AUDIOH_STREAM_STOPPING,
+};
+
+typedef struct {
+  uint8_t  state;
+  uint8_t  alt_idx;
+  uint8_t  ep_addr;
+  uint8_t  ep_fb;
+  uint8_t  frame_bytes;  // bytes of one sample of all channels
+  uint8_t  ufr_per_pkt;  // (micro)frames per service interval
+  uint16_t ep_size;
+  uint32_t sample_rate;
+
+  // OUT pacing: samples per (micro)frame in 16.16, accumulated to spread the fraction over packets
+  uint32_t fb_nominal;
+  uint32_t fb_value;
+  uint32_t fb_acc;
+
+  tu_fifo_t ff;
+
+  tuh_iso_xfer_t  xfer[2];
+  tu_iso_packet_t packets[2][CFG_TUH_AUDIO_ISO_PACKETS];
+  tuh_iso_xfer_t  xfer_fb;
+  tu_iso_packet_t packet_fb;
+} audioh_stream_t;
+
+typedef struct {
+  uint8_t daddr;
+  uint8_t itf_ac;   // Audio Control interface
+  uint8_t itf_last; // last Audio Streaming interface of the function
+  bool    mounted;
+
+  uint8_t alt_count;
+  audioh_alt_t alt[CFG_TUH_AUDIO_ALT_MAX];
+
+  audioh_stream_t stream[2]; // indexed by direction
+
+  uint8_t rx_ff_buf[CFG_TUH_AUDIO_RX_BUFSIZE];
+  uint8_t tx_ff_buf[CFG_TUH_AUDIO_TX_BUFSIZE];
+} audioh_interface_t;
+
+static audioh_interface_t _audioh_itf[CFG_TUH_AUDIO];
+
+typedef struct {
+  struct {
+    TUH_EPBUF_DEF(buf, CFG_TUH_AUDIO_ISO_PACKETS * CFG_TUH_AUDIO_EP_SZ);
+  } data[2][2]; // [dir][transfer]
+  TUH_EPBUF_DEF(fb, 4);
+  TUH_EPBUF_DEF(ctrl, 4);
+} audioh_epbuf_t;
+
+CFG_TUH_MEM_SECTION static audioh_epbuf_t _audioh_epbuf[CFG_TUH_AUDIO];
+
+// Clock entity or terminal of Audio Control interface
+typedef struct {
+  uint8_t id;
+  uint8_t subtype;
+  uint8_t clock;    // connected clock entity (first pin of a selector), unused for clock source
+  uint8_t controls; // bmControls of clock source
+} audioh_entity_t;
+
+//--------------------------------------------------------------------+
+// Helper functions
+//--------------------------------------------------------------------+
+
+static inline uint8_t find_new_index(void) {
+  for (uint8_t idx = 0; idx < CFG_TUH_AUDIO; idx++) {
+    if (_audioh_itf[idx].daddr == 0) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+static inline audioh_interface_t* get_itf(uint8_t idx) {
+  TU_VERIFY(idx < CFG_TUH_AUDIO && _audioh_itf[idx].mounted, NULL);
+  return &_audioh_itf[idx];
+}
+
+// user_data of transfers: instance index and stream direction
+TU_ATTR_ALWAYS_INLINE static inline uintptr_t stream_user_data(uint8_t idx, uint8_t dir) {
+  return (uintptr_t) ((idx << 1) | dir);
+}
+
+static const audioh_entity_t* entity_find(const audioh_entity_t* entities, uint8_t count, uint8_t id) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (entities[i].id == id) {
+      return &entities[i];
+    }
+  }
+  return NULL;
+}
+
+// Follow terminal -> clock selector/multiplier -> clock source. Selectors are assumed to use their first input pin
+static const audioh_entity_t* clock_source_find(const audioh_entity_t* entities, uint8_t count, uint8_t terminal_id) {
+  const audioh_entity_t* entity = entity_find(entities, count, terminal_id);
+  for (uint8_t hop = 0; entity != NULL && hop < AUDIOH_ENTITY_MAX; hop++) {
+    if (entity->subtype == AUDIO20_CS_AC_INTERFACE_CLOCK_SOURCE) {
+      return entity;
+    }
+    entity = entity_find(entities, count, entity->clock);
+  }
+  return NULL;
+}
+
+// Max bytes per service interval including additional transactions per microframe
+static uint16_t edpt_iso_size(const tusb_desc_endpoint_t* desc_ep) {
+  uint16_t const mult = (uint16_t) (((tu_le16toh(desc_ep->wMaxPacketSize) >> 11) & 0x3u) + 1u);
+  return (uint16_t) (tu_edpt_packet_size(desc_ep) * mult);
+}
+
+//--------------------------------------------------------------------+
+// Streaming
+//--------------------------------------------------------------------+
+
+static void rx_complete(tuh_iso_xfer_t* xfer);
+static void tx_complete(tuh_iso_xfer_t* xfer);
+static void fb_complete(tuh_iso_xfer_t* xfer);
+
+static bool rx_submit(tuh_iso_xfer_t* xfer, uint16_t ep_size) {
+  for (uint16_t i = 0; i < CFG_TUH_AUDIO_ISO_PACKETS; i++) {
+    xfer->packets[i].length = ep_size;
+  }
+  xfer->packet_count = CFG_TUH_AUDIO_ISO_PACKETS;
+  return tuh_iso_xfer(xfer);
+}
+
+// Bytes to send in the next packet: nominal or feedback rate, without feedback endpoint nudged by one sample to keep
+// the FIFO half full (adaptive or synchronous sink)
+static uint16_t tx_packet_bytes(audioh_stream_t* s) {
+  s->fb_acc += s->fb_value * s->ufr_per_pkt;
+  uint32_t samples = s->fb_acc >> 16;
+  s->fb_acc &= 0xFFFFu;
+
+  if (s->ep_fb == 0) {
+    uint16_t const depth = tu_fifo_depth(&s->ff);
+    uint16_t const count = tu_fifo_count(&s->ff);
+    if (count > depth - depth / 4) {
+      samples++;
+    } else if (count < depth / 4 && samples > 1) {
+      samples--;
+    }
+  }
+
+  return (uint16_t) tu_min32(samples * s->frame_bytes, (uint32_t) (s->ep_size - s->ep_size % s->frame_bytes));
+}
+
+// Fill packets of an OUT transfer from FIFO, pad with silence on underrun. Return bytes taken from FIFO
+static uint32_t tx_fill(audioh_stream_t* s, tuh_iso_xfer_t* xfer) {
+  uint32_t consumed = 0;
+  uint32_t offset = 0;
+  for (uint16_t i = 0; i < CFG_TUH_AUDIO_ISO_PACKETS; i++) {
+    uint16_t const bytes = tx_packet_bytes(s);
+    uint16_t const count = tu_fifo_read_n(&s->ff, xfer->buffer + offset, bytes);
+    if (count < bytes) {
+      tu_memclr(xfer->buffer + offset + count, bytes - count);
+    }
+    xfer->packets[i].length = bytes;
+    offset   += bytes;
+    consumed += count;
+  }
+  xfer->packet_count = CFG_TUH_AUDIO_ISO_PACKETS;
+  return consumed;
+}
+
+static void rx_complete(tuh_iso_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) (xfer->user_data >> 1);
+  audioh_stream_t* s = &_audioh_itf[idx].stream[TUSB_DIR_IN];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING,);
+
+  // packets are at offset of requested length, take whole audio frames only
+  uint32_t received = 0;
+  uint32_t offset = 0;
+  for (uint16_t i = 0; i < xfer->packet_count; i++) {
+    tu_iso_packet_t const* pkt = &xfer->packets[i];
+    if (pkt->result == XFER_RESULT_SUCCESS && pkt->actual_len > 0) {
+      uint16_t const len = (uint16_t) (pkt->actual_len - pkt->actual_len % s->frame_bytes);
+      uint16_t const room = (uint16_t) (tu_fifo_remaining(&s->ff) - tu_fifo_remaining(&s->ff) % s->frame_bytes);
+      if (len > room) {
+        TU_LOG_DRV("  Audio RX overrun, %u bytes dropped\r\n", len - room);
+      }
+      received += tu_fifo_write_n(&s->ff, xfer->buffer + offset, tu_min16(len, room));
+    }
+    offset += pkt->length;
+  }
+
+  TU_ASSERT(rx_submit(xfer, s->ep_size),);
+
+  if (received > 0) {
+    tuh_audio_rx_cb(idx, received);
+  }
+}
+
+static void tx_complete(tuh_iso_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) (xfer->user_data >> 1);
+  audioh_stream_t* s = &_audioh_itf[idx].stream[TUSB_DIR_OUT];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING,);
+
+  uint32_t const consumed = tx_fill(s, xfer);
+  TU_ASSERT(tuh_iso_xfer(xfer),);
+
+  tuh_audio_tx_cb(idx, consumed);
+}
+
+// Feedback is 10.14 in 3 bytes (fullspeed) or 16.16 in 4 bytes (highspeed). Some fullspeed devices send 10.14 in 4
+// bytes, detected by being far below nominal. Values off by more than 25% are ignored.
+static void fb_complete(tuh_iso_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) (xfer->user_data >> 1);
+  audioh_stream_t* s = &_audioh_itf[idx].stream[TUSB_DIR_OUT];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING,);
+
+  tu_iso_packet_t const* pkt = &xfer->packets[0];
+  if (pkt->result == XFER_RESULT_SUCCESS && pkt->actual_len >= 3) {
+    uint32_t value = tu_unaligned_read32(xfer->buffer);
+    value = tu_le32toh(value);
+    if (pkt->actual_len == 3) {
+      value = (value & 0xFFFFFFu) << 2;
+    } else if (value < s->fb_nominal / 2) {
+      value <<= 2;
+    }
+
+    if (value > s->fb_nominal - s->fb_nominal / 4 && value < s->fb_nominal + s->fb_nominal / 4) {
+      s->fb_value = value;
+    } else {
+      TU_LOG_DRV("  Audio feedback %08lX ignored\r\n", (unsigned long) value);
+    }
+  }
+
+  xfer->packets[0].length = (uint16_t) tu_min16(4, tu_edpt_packet_size(&_audioh_itf[idx].alt[s->alt_idx].ep_fb));
+  xfer->packet_count = 1;
+  TU_ASSERT(tuh_iso_xfer(xfer),);
+}
+
+// Open endpoints of the selected alternate and start isochronous transfers
+static bool stream_open(uint8_t idx, uint8_t dir) {
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+  audioh_stream_t* s = &p_audio->stream[dir];
+  audioh_alt_t* alt = &p_audio->alt[s->alt_idx];
+  audioh_epbuf_t* epbuf = &_audioh_epbuf[idx];
+
+  bool const is_hs = (tuh_speed_get(p_audio->daddr) == TUSB_SPEED_HIGH);
+  s->ufr_per_pkt = (uint8_t) (1u << (alt->ep.bInterval - 1));
+  s->ep_size     = alt->info.ep_size;
+  s->frame_bytes = (uint8_t) (alt->info.channels * alt->info.subslot_size);
+  s->fb_nominal  = (uint32_t) (((uint64_t) s->sample_rate << 16) / (is_hs ? 8000u : 1000u));
+  s->fb_value    = s->fb_nominal;
+  s->fb_acc      = 0;
+
+  uint8_t* ff_buf = (dir == TUSB_DIR_IN) ? p_audio->rx_ff_buf : p_audio->tx_ff_buf;
+  uint16_t depth = (uint16_t) tu_min32((dir == TUSB_DIR_IN) ? CFG_TUH_AUDIO_RX_BUFSIZE : CFG_TUH_AUDIO_TX_BUFSIZE,
+                                       0x8000u);
+  depth = (uint16_t) (depth - depth % s->frame_bytes);
+  TU_ASSERT(tu_fifo_config(&s->ff, ff_buf, depth, false));
+
+  TU_ASSERT(tuh_edpt_open(p_audio->daddr, &alt->ep));
+  s->ep_addr = alt->ep.bEndpointAddress;
+
+  for (uint8_t i = 0; i < 2; i++) {
+    tuh_iso_xfer_t* xfer = &s->xfer[i];
+    xfer->daddr       = p_audio->daddr;
+    xfer->ep_addr     = s->ep_addr;
+    xfer->buffer      = epbuf->data[dir][i].buf;
+    xfer->packets     = s->packets[i];
+    xfer->complete_cb = (dir == TUSB_DIR_IN) ? rx_complete : tx_complete;
+    xfer->user_data   = stream_user_data(idx, dir);
+  }
+
+  if (dir == TUSB_DIR_OUT && alt->ep_fb.bLength != 0) {
+    TU_ASSERT(tuh_edpt_open(p_audio->daddr, &alt->ep_fb));
+    s->ep_fb = alt->ep_fb.bEndpointAddress;
+
+    tuh_iso_xfer_t* xfer = &s->xfer_fb;
+    xfer->daddr       = p_audio->daddr;
+    xfer->ep_addr     = s->ep_fb;
+    xfer->buffer      = epbuf->fb;
+    xfer->packets     = &s->packet_fb;
+    xfer->packet_count = 1;
+    xfer->complete_cb = fb_complete;
+    xfer->user_data   = stream_user_data(idx, dir);
+    s->packet_fb.length = (uint16_t) tu_min16(4, tu_edpt_packet_size(&alt->ep_fb));
+  }
+
+  // state is set before submitting since completion can be reported right away
+  s->state = AUDIOH_STREAM_STREAMING;
+
+  for (uint8_t i = 0; i < 2; i++) {
+    if (dir == TUSB_DIR_IN) {
+      TU_ASSERT(rx_submit(&s->xfer[i], s->ep_size));
+    } else {
+      (void) tx_fill(s, &s->xfer[i]);
+      TU_ASSERT(tuh_iso_xfer(&s->xfer[i]));
+    }
+  }
+
+  if (s->ep_fb != 0) {
+    TU_ASSERT(tuh_iso_xfer(&s->xfer_fb));
+  }
+
+  return true;
+}
+
+static void stream_close(audioh_interface_t* p_audio, audioh_stream_t* s) {
+  if (s->ep_addr != 0) {
+    tuh_edpt_close(p_audio->daddr, s->ep_addr);
+    s->ep_addr = 0;
+  }
+  if (s->ep_fb != 0) {
+    tuh_edpt_close(p_audio->daddr, s->ep_fb);
+    s->ep_fb = 0;
+  }
+}
+
+static void stream_start_complete(uint8_t idx, uint8_t dir, bool success) {
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+  audioh_stream_t* s = &p_audio->stream[dir];
+
+  if (success) {
+    success = stream_open(idx, dir);
+  }
+
+  if (!success) {
+    stream_close(p_audio, s);
+    s->state = AUDIOH_STREAM_IDLE;
+  }
+
+  tuh_audio_stream_start_cb(idx, dir, success);
+}
+
+static void set_interface_complete(tuh_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) (xfer->user_data >> 1);
+  uint8_t const dir = (uint8_t) (xfer->user_data & 1u);
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+  audioh_stream_t* s = &p_audio->stream[dir];
+
+  if (s->state == AUDIOH_STREAM_STOPPING) {
+    s->state = AUDIOH_STREAM_IDLE;
+  } else if (s->state == AUDIOH_STREAM_SET_ITF) {
+    stream_start_complete(idx, dir, xfer->result == XFER_RESULT_SUCCESS);
+  }
+}
+
+static void set_rate_complete(tuh_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) (xfer->user_data >> 1);
+  uint8_t const dir = (uint8_t) (xfer->user_data & 1u);
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+  audioh_stream_t* s = &p_audio->stream[dir];
+  TU_VERIFY(s->state == AUDIOH_STREAM_SET_RATE,);
+
+  bool success = (xfer->result == XFER_RESULT_SUCCESS);
+  const audioh_alt_t* alt = &p_audio->alt[s->alt_idx];
+  if (success && !alt->clock_programmable) {
+    // fixed clock: current rate must match
+    uint32_t const rate = tu_le32toh(tu_unaligned_read32(_audioh_epbuf[idx].ctrl));
+    if (rate != s->sample_rate) {
+      TU_LOG_DRV("  Audio clock runs at %lu Hz, not %lu Hz\r\n", (unsigned long) rate, (unsigned long) s->sample_rate);
+      success = false;
+    }
+  }
+
+  s->state = AUDIOH_STREAM_SET_ITF;
+  if (!success || !tuh_interface_set(p_audio->daddr, alt->info.itf_num, alt->info.alt, set_interface_complete,
+                                     xfer->user_data)) {
+    stream_start_complete(idx, dir, false);
+  }
+}
+
+// Set (programmable) or get (fixed) sampling frequency of the clock source
+static bool clock_rate_xfer(uint8_t idx, uint8_t dir) {
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+  audioh_stream_t* s = &p_audio->stream[dir];
+  const audioh_alt_t* alt = &p_audio->alt[s->alt_idx];
+  uint8_t* buf = _audioh_epbuf[idx].ctrl;
+
+  if (alt->clock_programmable) {
+    uint32_t const rate = tu_htole32(s->sample_rate);
+    memcpy(buf, &rate, 4);
+  }
+
+  tusb_control_request_t const request = {
+      .bmRequestType_bit = {
+          .recipient = TUSB_REQ_RCPT_INTERFACE,
+          .type      = TUSB_REQ_TYPE_CLASS,
+          .direction = alt->clock_programmable ? TUSB_DIR_OUT : TUSB_DIR_IN
+      },
+      .bRequest = AUDIO20_CS_REQ_CUR,
+      .wValue   = tu_htole16((uint16_t) (AUDIO20_CS_CTRL_SAM_FREQ << 8)),
+      .wIndex   = tu_htole16(tu_u16(alt->info.clock_id, p_audio->itf_ac)),
+      .wLength  = tu_htole16(4)
+  };
+
+  tuh_xfer_t xfer = {
+      .daddr       = p_audio->daddr,
+      .ep_addr     = 0,
+      .setup       = &request,
+      .buffer      = buf,
+      .complete_cb = set_rate_complete,
+      .user_data   = stream_user_data(idx, dir)
+  };
+
+  return tuh_control_xfer(&xfer);
+}
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+
+bool tuh_audio_mounted(uint8_t idx) {
+  return get_itf(idx) != NULL;
+}
+
+uint8_t tuh_audio_alt_count(uint8_t idx) {
+  const audioh_interface_t* p_audio = get_itf(idx);
+  return (p_audio != NULL) ? p_audio->alt_count : 0;
+}
+
+bool tuh_audio_alt_info(uint8_t idx, uint8_t alt_idx, tuh_audio_alt_info_t* info) {
+  const audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL && alt_idx < p_audio->alt_count && info != NULL);
+  *info = p_audio->alt[alt_idx].info;
+  return true;
+}
+
+uint8_t tuh_audio_alt_find(uint8_t idx, uint8_t dir, uint8_t channels, uint8_t bit_resolution) {
+  const audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, TUSB_INDEX_INVALID_8);
+
+  for (uint8_t i = 0; i < p_audio->alt_count; i++) {
+    const tuh_audio_alt_info_t* info = &p_audio->alt[i].info;
+    if (info->dir == dir && info->format_type == AUDIO20_FORMAT_TYPE_I &&
+        (info->formats & AUDIO20_DATA_FORMAT_TYPE_I_PCM) &&
+        (channels == 0 || info->channels == channels) &&
+        (bit_resolution == 0 || info->bit_resolution == bit_resolution)) {
+      return i;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+bool tuh_audio_stream_start(uint8_t idx, uint8_t alt_idx, uint32_t sample_rate) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL && alt_idx < p_audio->alt_count && sample_rate > 0);
+
+  const audioh_alt_t* alt = &p_audio->alt[alt_idx];
+  const tuh_audio_alt_info_t* info = &alt->info;
+  TU_VERIFY(info->format_type == AUDIO20_FORMAT_TYPE_I && info->channels > 0 && info->subslot_size > 0);
+  TU_VERIFY(info->channels * info->subslot_size <= UINT8_MAX && info->ep_size <= CFG_TUH_AUDIO_EP_SZ);
+  TU_VERIFY(alt->ep.bInterval >= 1 && alt->ep.bInterval <= 4);
+
+  audioh_stream_t* s = &p_audio->stream[info->dir];
+  TU_VERIFY(s->state == AUDIOH_STREAM_IDLE);
+
+  s->alt_idx     = alt_idx;
+  s->sample_rate = sample_rate;
+
+  TU_LOG_DRV("[%u] Audio start Interface %u Alt %u at %lu Hz\r\n", p_audio->daddr, info->itf_num, info->alt,
+             (unsigned long) sample_rate);
+
+  if (info->clock_id != 0) {
+    s->state = AUDIOH_STREAM_SET_RATE;
+    if (!clock_rate_xfer(idx, info->dir)) {
+      s->state = AUDIOH_STREAM_IDLE;
+      return false;
+    }
+  } else {
+    s->state = AUDIOH_STREAM_SET_ITF;
+    if (!tuh_interface_set(p_audio->daddr, info->itf_num, info->alt, set_interface_complete,
+                           stream_user_data(idx, info->dir))) {
+      s->state = AUDIOH_STREAM_IDLE;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool tuh_audio_stream_stop(uint8_t idx, uint8_t dir) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL && dir <= TUSB_DIR_IN);
+
+  audioh_stream_t* s = &p_audio->stream[dir];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING);
+
+  stream_close(p_audio, s);
+  s->state = AUDIOH_STREAM_STOPPING;
+  if (!tuh_interface_set(p_audio->daddr, p_audio->alt[s->alt_idx].info.itf_num, 0, set_interface_complete,
+                         stream_user_data(idx, dir))) {
+    s->state = AUDIOH_STREAM_IDLE;
+  }
+
+  return true;
+}
+
+bool tuh_audio_streaming(uint8_t idx, uint8_t dir) {
+  const audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL && dir <= TUSB_DIR_IN);
+  return p_audio->stream[dir].state == AUDIOH_STREAM_STREAMING;
+}
+
+uint32_t tuh_audio_read(uint8_t idx, void* buffer, uint32_t bufsize) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, 0);
+  audioh_stream_t* s = &p_audio->stream[TUSB_DIR_IN];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING, 0);
+
+  uint16_t count = (uint16_t) tu_min32(bufsize, tu_fifo_count(&s->ff));
+  count = (uint16_t) (count - count % s->frame_bytes);
+  return tu_fifo_read_n(&s->ff, buffer, count);
+}
+
+uint32_t tuh_audio_available(uint8_t idx) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, 0);
+  audioh_stream_t* s = &p_audio->stream[TUSB_DIR_IN];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING, 0);
+  return tu_fifo_count(&s->ff);
+}
+
+uint32_t tuh_audio_write(uint8_t idx, const void* buffer, uint32_t bufsize) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, 0);
+  audioh_stream_t* s = &p_audio->stream[TUSB_DIR_OUT];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING, 0);
+
+  uint16_t count = (uint16_t) tu_min32(bufsize, tu_fifo_remaining(&s->ff));
+  count = (uint16_t) (count - count % s->frame_bytes);
+  return tu_fifo_write_n(&s->ff, buffer, count);
+}
+
+uint32_t tuh_audio_write_available(uint8_t idx) {
+  audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, 0);
+  audioh_stream_t* s = &p_audio->stream[TUSB_DIR_OUT];
+  TU_VERIFY(s->state == AUDIOH_STREAM_STREAMING, 0);
+  uint16_t const remaining = tu_fifo_remaining(&s->ff);
+  return (uint32_t) (remaining - remaining % s->frame_bytes);
+}
+
+uint32_t tuh_audio_feedback_get(uint8_t idx) {
+  const audioh_interface_t* p_audio = get_itf(idx);
+  TU_VERIFY(p_audio != NULL, 0);
+  return p_audio->stream[TUSB_DIR_OUT].fb_value;
+}
+
+//--------------------------------------------------------------------+
+// Class Driver API
+//--------------------------------------------------------------------+
+
+bool audioh_init(void) {
+  tu_memclr(_audioh_itf, sizeof(_audioh_itf));
+  return true;
+}
+
+bool audioh_deinit(void) {
+  return true;
+}
+
+// Parse an Audio Function: AC interface with clock entities and terminals followed by AS interfaces. Stop at the next
+// function (IAD), a non-streaming interface (e.g MIDI Streaming is left to MIDI driver) or the end of configuration.
+uint16_t audioh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len) {
+  (void) rhport;
+  TU_VERIFY(TUSB_CLASS_AUDIO == desc_itf->bInterfaceClass &&
+            AUDIO_SUBCLASS_CONTROL == desc_itf->bInterfaceSubClass &&
+            AUDIO_INT_PROTOCOL_CODE_V2 == desc_itf->bInterfaceProtocol, 0);
+
+  const uint8_t idx = find_new_index();
+  TU_VERIFY(idx < CFG_TUH_AUDIO, 0);
+  audioh_interface_t* p_audio = &_audioh_itf[idx];
+
+  TU_LOG_DRV("[%u] Audio opening Interface %u\r\n", dev_addr, desc_itf->bInterfaceNumber);
+
+  audioh_entity_t entities[AUDIOH_ENTITY_MAX];
+  uint8_t entity_count = 0;
+
+  const uint8_t* p_desc = tu_desc_next(desc_itf);
+  const uint8_t* desc_end = ((const uint8_t*) desc_itf) + max_len;
+  bool in_ac = true;
+  audioh_alt_t* alt = NULL;
+
+  p_audio->itf_ac = desc_itf->bInterfaceNumber;
+  p_audio->itf_last = desc_itf->bInterfaceNumber;
+  p_audio->alt_count = 0;
+
+  while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_len(p_desc) > 0) {
+    uint8_t const desc_type = tu_desc_type(p_desc);
+    if (desc_type == TUSB_DESC_INTERFACE_ASSOCIATION) {
+      break;
+    }
+
+    if (desc_type == TUSB_DESC_INTERFACE) {
+      const tusb_desc_interface_t* itf = (const tusb_desc_interface_t*) p_desc;
+      if (itf->bInterfaceClass != TUSB_CLASS_AUDIO || itf->bInterfaceSubClass != AUDIO_SUBCLASS_STREAMING) {
+        break;
+      }
+      in_ac = false;
+      alt = NULL;
+      p_audio->itf_last = itf->bInterfaceNumber;
+      if (itf->bAlternateSetting != 0 && itf->bNumEndpoints > 0) {
+        if (p_audio->alt_count < CFG_TUH_AUDIO_ALT_MAX) {
+          alt = &p_audio->alt[p_audio->alt_count++];
+          tu_memclr(alt, sizeof(audioh_alt_t));
+          alt->info.itf_num = itf->bInterfaceNumber;
+          alt->info.alt     = itf->bAlternateSetting;
+        } else {
+          TU_LOG_DRV("  Audio Interface %u Alt %u skipped, increase CFG_TUH_AUDIO_ALT_MAX\r\n",
+                     itf->bInterfaceNumber, itf->bAlternateSetting);
+        }
+      }
+    } else if (desc_type == TUSB_DESC_CS_INTERFACE && in_ac) {
+      uint8_t const subtype = tu_desc_subtype(p_desc);
+      audioh_entity_t entity = { .id = p_desc[3], .subtype = subtype, .clock = 0, .controls = 0 };
+      bool is_entity = true;
+      switch (subtype) {
+        case AUDIO20_CS_AC_INTERFACE_CLOCK_SOURCE:
+          entity.controls = ((const audio20_desc_clock_source_t*) p_desc)->bmControls;
+          break;
+
+        case AUDIO20_CS_AC_INTERFACE_CLOCK_SELECTOR:
+          entity.clock = ((const audio20_desc_clock_selector_t*) p_desc)->baCSourceID;
+          break;
+
+        case AUDIO20_CS_AC_INTERFACE_CLOCK_MULTIPLIER:
+          entity.clock = ((const audio20_desc_clock_multiplier_t*) p_desc)->bCSourceID;
+          break;
+
+        case AUDIO20_CS_AC_INTERFACE_INPUT_TERMINAL:
+          entity.clock = ((const audio20_desc_input_terminal_t*) p_desc)->bCSourceID;
+          break;
+
+        case AUDIO20_CS_AC_INTERFACE_OUTPUT_TERMINAL:
+          entity.clock = ((const audio20_desc_output_terminal_t*) p_desc)->bCSourceID;
+          break;
+
+        default:
+          is_entity = false;
+          break;
+      }
+      if (is_entity && entity_count < AUDIOH_ENTITY_MAX) {
+        entities[entity_count++] = entity;
+      }
+    } else if (desc_type == TUSB_DESC_CS_INTERFACE && alt != NULL) {
+      if (tu_desc_subtype(p_desc) == AUDIO20_CS_AS_INTERFACE_AS_GENERAL) {
+        const audio20_desc_cs_as_interface_t* desc_as = (const audio20_desc_cs_as_interface_t*) p_desc;
+        alt->info.terminal_link = desc_as->bTerminalLink;
+        alt->info.format_type   = desc_as->bFormatType;
+        alt->info.formats       = tu_le32toh(desc_as->bmFormats);
+        alt->info.channels      = desc_as->bNrChannels;
+      } else if (tu_desc_subtype(p_desc) == AUDIO20_CS_AS_INTERFACE_FORMAT_TYPE &&
+                 ((const audio20_desc_type_I_format_t*) p_desc)->bFormatType == AUDIO20_FORMAT_TYPE_I) {
+        const audio20_desc_type_I_format_t* desc_fmt = (const audio20_desc_type_I_format_t*) p_desc;
+        alt->info.subslot_size   = desc_fmt->bSubslotSize;
+        alt->info.bit_resolution = desc_fmt->bBitResolution;
+      }
+    } else if (desc_type == TUSB_DESC_ENDPOINT && alt != NULL) {
+      const tusb_desc_endpoint_t* desc_ep = (const tusb_desc_endpoint_t*) p_desc;
+      if (desc_ep->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+        if (desc_ep->bmAttributes.usage == 1) {
+          alt->ep_fb = *desc_ep;
+        } else {
+          alt->ep = *desc_ep;
+        }
+      }
+    }
+
+    p_desc = tu_desc_next(p_desc);
+  }
+
+  // resolve direction, packet size and clock, drop alternates without data endpoint
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < p_audio->alt_count; i++) {
+    audioh_alt_t* a = &p_audio->alt[i];
+    if (a->ep.bLength == 0) {
+      continue;
+    }
+    a->info.dir          = (uint8_t) tu_edpt_dir(a->ep.bEndpointAddress);
+    a->info.ep_size      = edpt_iso_size(&a->ep);
+    a->info.has_feedback = (a->info.dir == TUSB_DIR_OUT && a->ep_fb.bLength != 0);
+
+    const audioh_entity_t* clock = clock_source_find(entities, entity_count, a->info.terminal_link);
+    if (clock != NULL) {
+      a->info.clock_id = clock->id;
+      a->clock_programmable =
+        (((clock->controls >> AUDIO20_CLOCK_SOURCE_CTRL_CLK_FRQ_POS) & 0x3u) == AUDIO20_CTRL_RW);
+    }
+
+    TU_LOG_DRV("  Alt %u.%u: %s %u ch %u bit, packet %u, clock %u\r\n", a->info.itf_num, a->info.alt,
+               a->info.dir ? "IN" : "OUT", a->info.channels, a->info.bit_resolution, a->info.ep_size,
+               a->info.clock_id);
+
+    if (count != i) {
+      p_audio->alt[count] = *a;
+    }
+    count++;
+  }
+  p_audio->alt_count = count;
+  p_audio->daddr = dev_addr;
+
+  return (uint16_t) (p_desc - (const uint8_t*) desc_itf);
+}
+
+bool audioh_set_config(uint8_t dev_addr, uint8_t itf_num) {
+  for (uint8_t idx = 0; idx < CFG_TUH_AUDIO; idx++) {
+    audioh_interface_t* p_audio = &_audioh_itf[idx];
+    if (p_audio->daddr == dev_addr && p_audio->itf_ac == itf_num) {
+      p_audio->mounted = true;
+      tuh_audio_mount_cb(idx);
+      // all AS interfaces of the function are bound to this driver
+      usbh_driver_set_config_complete(dev_addr, p_audio->itf_last);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool audioh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  // streaming endpoints complete with tuh_iso_xfer() callbacks, AC interrupt endpoint is not used
+  (void) dev_addr; (void) ep_addr; (void) result; (void) xferred_bytes;
+  return true;
+}
+
+void audioh_close(uint8_t dev_addr) {
+  for (uint8_t idx = 0; idx < CFG_TUH_AUDIO; idx++) {
+    audioh_interface_t* p_audio = &_audioh_itf[idx];
+    if (p_audio->daddr == dev_addr) {
+      TU_LOG_DRV("  Audio close addr = %u index = %u\r\n", dev_addr, idx);
+      if (p_audio->mounted) {
+        tuh_audio_umount_cb(idx);
+      }
+      // endpoints and isochronous streams are released by usbh with the device
+      tu_memclr(p_audio, offsetof(audioh_interface_t, rx_ff_buf));
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_AUDIO_HOST_H_
+#define TUSB_AUDIO_HOST_H_
+
+#include "audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Class Driver Configuration
+//--------------------------------------------------------------------+
+
+// Max bytes of an isochronous packet (per service interval) of a streaming alternate setting. Alternates with a larger
+// packet are reported but cannot be started. Default fits 48 kHz stereo 16-bit at fullspeed.
+#ifndef CFG_TUH_AUDIO_EP_SZ
+  #define CFG_TUH_AUDIO_EP_SZ 196
+#endif
+
+// Number of packets (service intervals) per isochronous transfer. Each stream has 2 transfers in flight, total latency
+// is about 2 * CFG_TUH_AUDIO_ISO_PACKETS service intervals.
+#ifndef CFG_TUH_AUDIO_ISO_PACKETS
+  #define CFG_TUH_AUDIO_ISO_PACKETS 4
+#endif
+
+// Size of the sample FIFO between application and each stream, rounded down to whole audio frames
+#ifndef CFG_TUH_AUDIO_RX_BUFSIZE
+  #define CFG_TUH_AUDIO_RX_BUFSIZE (4 * CFG_TUH_AUDIO_ISO_PACKETS * CFG_TUH_AUDIO_EP_SZ)
+#endif
+
+#ifndef CFG_TUH_AUDIO_TX_BUFSIZE
+  #define CFG_TUH_AUDIO_TX_BUFSIZE (4 * CFG_TUH_AUDIO_ISO_PACKETS * CFG_TUH_AUDIO_EP_SZ)
+#endif
+
+// Max number of streaming alternate settings (all AS interfaces) recorded per audio function
+#ifndef CFG_TUH_AUDIO_ALT_MAX
+  #define CFG_TUH_AUDIO_ALT_MAX 8
+#endif
+
+#ifndef CFG_TUH_AUDIO_LOG_LEVEL
+  #define CFG_TUH_AUDIO_LOG_LEVEL CFG_TUH_LOG_LEVEL
+#endif
+
+//--------------------------------------------------------------------+
+// Type Definitions
+//--------------------------------------------------------------------+
+
+// Streaming alternate setting of an Audio Streaming interface
+typedef struct {
+  uint8_t  itf_num;
+  uint8_t  alt;
+  uint8_t  dir;            // TUSB_DIR_IN: device to host (e.g microphone), TUSB_DIR_OUT: host to device (e.g speaker)
+  uint8_t  format_type;    // audio20_format_type_t
+  uint32_t formats;        // bmFormats, see audio20_data_format_type_I_t
+  uint8_t  channels;
+  uint8_t  subslot_size;   // bytes per sample of one channel
+  uint8_t  bit_resolution;
+  uint8_t  terminal_link;
+  uint8_t  clock_id;       // clock source of the linked terminal, 0 if not found
+  uint16_t ep_size;        // max bytes per service interval
+  bool     has_feedback;   // asynchronous OUT with explicit feedback endpoint
+} tuh_audio_alt_info_t;
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+
+// Check if audio function is mounted
+bool tuh_audio_mounted(uint8_t idx);
+
+// Get number of streaming alternate settings
+uint8_t tuh_audio_alt_count(uint8_t idx);
+
+// Get info of an alternate setting, alt_idx < tuh_audio_alt_count()
+bool tuh_audio_alt_info(uint8_t idx, uint8_t alt_idx, tuh_audio_alt_info_t* info);
+
+// Find first Type I PCM alternate setting of a direction with matching number of channels and bit resolution.
+// 0 matches any. Return alt_idx or TUSB_INDEX_INVALID_8 if not found
+uint8_t tuh_audio_alt_find(uint8_t idx, uint8_t dir, uint8_t channels, uint8_t bit_resolution);
+
+// Start streaming of an alternate setting at sample_rate (Hz). Programmable clock is set to sample_rate, a fixed clock
+// must already run at sample_rate. Then the alternate is selected and isochronous transfers are started.
+// Asynchronous: tuh_audio_stream_start_cb() is invoked when complete. Only one stream per direction.
+bool tuh_audio_stream_start(uint8_t idx, uint8_t alt_idx, uint32_t sample_rate);
+
+// Stop streaming of a direction and select alternate 0 (zero bandwidth)
+bool tuh_audio_stream_stop(uint8_t idx, uint8_t dir);
+
+// Check if a direction is streaming
+bool tuh_audio_streaming(uint8_t idx, uint8_t dir);
+
+// Read received samples, only whole audio frames (one sample of every channel) are read. Return number of bytes read
+uint32_t tuh_audio_read(uint8_t idx, void* buffer, uint32_t bufsize);
+
+// Number of received bytes available to read
+uint32_t tuh_audio_available(uint8_t idx);
+
+// Write samples to be sent, only whole audio frames are written. Return number of bytes written
+uint32_t tuh_audio_write(uint8_t idx, const void* buffer, uint32_t bufsize);
+
+// Number of bytes that can be written
+uint32_t tuh_audio_write_available(uint8_t idx);
+
+// Samples per (micro)frame of the OUT stream in 16.16 fixed point: from feedback endpoint if available, nominal rate
+// otherwise
+uint32_t tuh_audio_feedback_get(uint8_t idx);
+
+//--------------------------------------------------------------------+
+// Application Callback API (weak, optional)
+//--------------------------------------------------------------------+
+
+// Invoked when audio function is mounted, alternate settings can be queried
+void tuh_audio_mount_cb(uint8_t idx);
+
+// Invoked when audio function is unmounted
+void tuh_audio_umount_cb(uint8_t idx);
+
+// Invoked when tuh_audio_stream_start() is complete
+void tuh_audio_stream_start_cb(uint8_t idx, uint8_t dir, bool success);
+
+// Invoked when samples are received, xferred_bytes is the number of bytes added to the FIFO
+void tuh_audio_rx_cb(uint8_t idx, uint32_t xferred_bytes);
+
+// Invoked when an OUT transfer is refilled, xferred_bytes is the number of bytes taken from the FIFO
+void tuh_audio_tx_cb(uint8_t idx, uint32_t xferred_bytes);
+
+//--------------------------------------------------------------------+
+// Internal Class Driver API
+//--------------------------------------------------------------------+
+bool     audioh_init(void);
+bool     audioh_deinit(void);
+uint16_t audioh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len);
+bool     audioh_set_config(uint8_t dev_addr, uint8_t itf_num);
+bool     audioh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     audioh_close(uint8_t dev_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,8 +37,10 @@ typedef struct {
   tu_edpt_stream_t tx_stream;
   tu_edpt_stream_t rx_stream;
 
+#if !CFG_TUD_EDPT_STREAM_ZERO_COPY
   uint8_t tx_ff_buf[CFG_TUD_CDC_TX_BUFSIZE];
   uint8_t rx_ff_buf[CFG_TUD_CDC_RX_BUFSIZE];
+#endif
 } cdcd_interface_t;
 
 #define ITF_MEM_RESET_SIZE offsetof(cdcd_interface_t, line_coding)
@@ -49,6 +51,12 @@ typedef struct {
   TUD_EPBUF_DEF(epout, CFG_TUD_CDC_RX_EPSIZE);
   TUD_EPBUF_DEF(epin, CFG_TUD_CDC_TX_EPSIZE);
 
+  #if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  // stream fifos are also accessed by controller
+  TUD_EPBUF_DEF(tx_ff, CFG_TUD_CDC_TX_BUFSIZE);
+  TUD_EPBUF_DEF(rx_ff, CFG_TUD_CDC_RX_BUFSIZE);
+  #endif
+
   #if CFG_TUD_CDC_NOTIFY
   TUD_EPBUF_TYPE_DEF(cdc_notify_msg_t, epnotify);
   #endif
@@ -190,6 +198,16 @@ void tud_cdc_n_read_flush(uint8_t itf) {
   tu_edpt_stream_read_xfer(&p_cdc->rx_stream);
 }
 
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  return tu_edpt_stream_read_reserve(&_cdcd_itf[itf].rx_stream, info, bufsize);
+}
+
+void tud_cdc_n_read_commit(uint8_t itf, uint32_t count) {
+  TU_VERIFY(itf < CFG_TUD_CDC, );
+  tu_edpt_stream_read_commit(&_cdcd_itf[itf].rx_stream, count);
+}
+
 //--------------------------------------------------------------------+
 // WRITE API
 //--------------------------------------------------------------------+
@@ -199,6 +217,16 @@ uint32_t tud_cdc_n_write(uint8_t itf, const void* buffer, uint32_t bufsize) {
   return tu_edpt_stream_write(&p_cdc->tx_stream, buffer, bufsize);
 }
 
+uint32_t tud_cdc_n_write_reserve(uint8_t itf, tu_fifo_buffer_info_t *info, uint32_t bufsize) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  return tu_edpt_stream_write_reserve(&_cdcd_itf[itf].tx_stream, info, bufsize);
+}
+
+uint32_t tud_cdc_n_write_commit(uint8_t itf, uint32_t count) {
+  TU_VERIFY(itf < CFG_TUD_CDC, 0);
+  return tu_edpt_stream_write_commit(&_cdcd_itf[itf].tx_stream, count);
+}
+
 uint32_t tud_cdc_n_write_flush(uint8_t itf) {
   TU_VERIFY(itf < CFG_TUD_CDC, 0);
   cdcd_interface_t *p_cdc = &_cdcd_itf[itf];
@@ -241,12 +269,20 @@ void cdcd_init(void) {
     uint8_t *epin_buf  = _cdcd_epbuf[i].epin;
   #endif
 
-    tu_edpt_stream_init(&p_cdc->rx_stream, false, false, false, p_cdc->rx_ff_buf, CFG_TUD_CDC_RX_BUFSIZE, epout_buf);
+  #if CFG_TUD_EDPT_STREAM_ZERO_COPY
+    uint8_t *rx_ff_buf = _cdcd_epbuf[i].rx_ff;
+    uint8_t *tx_ff_buf = _cdcd_epbuf[i].tx_ff;
+  #else
+    uint8_t *rx_ff_buf = p_cdc->rx_ff_buf;
+    uint8_t *tx_ff_buf = p_cdc->tx_ff_buf;
+  #endif
+
+    tu_edpt_stream_init(&p_cdc->rx_stream, false, false, false, rx_ff_buf, CFG_TUD_CDC_RX_BUFSIZE, epout_buf);
 
     // TX fifo can be configured to change to overwritable if not connected (DTR bit not set). Without DTR we do not
     // know if data is actually polled by terminal. This way the most current data is prioritized.
     // Default: is overwritable
-    tu_edpt_stream_init(&p_cdc->tx_stream, false, true, CFG_TUD_CDC_TX_OVERWRITABLE_IF_NOT_CONNECTED, p_cdc->tx_ff_buf,
+    tu_edpt_stream_init(&p_cdc->tx_stream, false, true, CFG_TUD_CDC_TX_OVERWRITABLE_IF_NOT_CONNECTED, tx_ff_buf,
                         CFG_TUD_CDC_TX_BUFSIZE, epin_buf);
   }
 }
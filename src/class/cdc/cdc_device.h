@@ -115,6 +115,11 @@ void tud_cdc_n_read_flush(uint8_t itf);
 // Get a byte from FIFO without removing it
 bool tud_cdc_n_peek(uint8_t itf, uint8_t* ui8);
 
+// Zero-copy read: borrow up to bufsize received bytes as (up to) two linear spans of RX FIFO.
+// Must be followed by tud_cdc_n_read_commit() with the number of consumed bytes (can be 0)
+uint32_t tud_cdc_n_read_reserve(uint8_t itf, tu_fifo_buffer_info_t* info, uint32_t bufsize);
+void tud_cdc_n_read_commit(uint8_t itf, uint32_t count);
+
 // Write bytes to TX FIFO, data may remain in the FIFO for a while
 uint32_t tud_cdc_n_write(uint8_t itf, void const* buffer, uint32_t bufsize);
 
@@ -128,6 +133,11 @@ TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_n_write_str(uint8_t itf, ch
   return tud_cdc_n_write(itf, str, strlen(str));
 }
 
+// Zero-copy write: borrow up to bufsize bytes of TX FIFO space as (up to) two linear spans to write in place.
+// Must be followed by tud_cdc_n_write_commit() with the number of written bytes (can be 0)
+uint32_t tud_cdc_n_write_reserve(uint8_t itf, tu_fifo_buffer_info_t* info, uint32_t bufsize);
+uint32_t tud_cdc_n_write_commit(uint8_t itf, uint32_t count);
+
 // Force sending data if possible, return number of forced bytes
 uint32_t tud_cdc_n_write_flush(uint8_t itf);
 
@@ -223,6 +233,14 @@ TU_ATTR_ALWAYS_INLINE static inline bool tud_cdc_peek(uint8_t* ui8) {
   return tud_cdc_n_peek(0, ui8);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_read_reserve(tu_fifo_buffer_info_t* info, uint32_t bufsize) {
+  return tud_cdc_n_read_reserve(0, info, bufsize);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void tud_cdc_read_commit(uint32_t count) {
+  tud_cdc_n_read_commit(0, count);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_char(char ch) {
   return tud_cdc_n_write_char(0, ch);
 }
@@ -235,6 +253,14 @@ TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_str(char const* str)
   return tud_cdc_n_write_str(0, str);
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_reserve(tu_fifo_buffer_info_t* info, uint32_t bufsize) {
+  return tud_cdc_n_write_reserve(0, info, bufsize);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_commit(uint32_t count) {
+  return tud_cdc_n_write_commit(0, count);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline uint32_t tud_cdc_write_flush(void) {
   return tud_cdc_n_write_flush(0);
 }
@@ -115,6 +115,7 @@ static void     ftdi_internal_control_complete(cdch_interface_t *p_cdc, tuh_xfer
 static bool     ftdi_set_baudrate(cdch_interface_t *p_cdc, tuh_xfer_cb_t complete_cb, uintptr_t user_data);
 static bool     ftdi_set_data_format(cdch_interface_t *p_cdc, tuh_xfer_cb_t complete_cb, uintptr_t user_data);
 static bool     ftdi_set_modem_ctrl(cdch_interface_t *p_cdc, tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+static uint32_t ftdi_rx_xfer_complete(tu_edpt_stream_t *s, uint32_t xferred_bytes);
   #endif
 
   //------------- CP210X prototypes -------------//
@@ -686,11 +687,8 @@ bool cdch_xfer_cb(uint8_t daddr, uint8_t ep_addr, xfer_result_t event, uint32_t
   } else if (ep_addr == p_cdc->stream.rx.ep_addr) {
     #if CFG_TUH_CDC_FTDI
     if (p_cdc->serial_drid == SERIAL_DRIVER_FTDI) {
-      // FTDI reserve 2 bytes for status
-      // uint8_t status[2] = {p_cdc->stream.rx.ep_buf[0], p_cdc->stream.rx.ep_buf[1]};
-      if (xferred_bytes > 2) {
-        tu_edpt_stream_read_xfer_complete_with_buf(&p_cdc->stream.rx, p_cdc->stream.rx.ep_buf + 2, xferred_bytes - 2);
-
+      // FTDI reserve 2 bytes for status in every packet
+      if (ftdi_rx_xfer_complete(&p_cdc->stream.rx, xferred_bytes) > 0) {
         tuh_cdc_rx_cb(idx); // invoke receive callback
       }
     } else
@@ -720,7 +718,14 @@ static bool open_ep_stream_pair(cdch_interface_t *p_cdc, tusb_desc_endpoint_t co
     TU_ASSERT(tuh_edpt_open(p_cdc->daddr, desc_ep));
     const uint8_t     ep_dir = tu_edpt_dir(desc_ep->bEndpointAddress);
     tu_edpt_stream_t *stream = (ep_dir == TUSB_DIR_IN) ? &p_cdc->stream.rx : &p_cdc->stream.tx;
-    tu_edpt_stream_open(stream, p_cdc->daddr, desc_ep, tu_edpt_packet_size(desc_ep));
+
+    // RX transfer can span multiple packets up to the endpoint buffer
+    const uint16_t mps = tu_edpt_packet_size(desc_ep);
+    uint16_t xfer_len = mps;
+    if (ep_dir == TUSB_DIR_IN && CFG_TUH_CDC_RX_EPSIZE > mps) {
+      xfer_len = (uint16_t) (CFG_TUH_CDC_RX_EPSIZE - (CFG_TUH_CDC_RX_EPSIZE % mps));
+    }
+    tu_edpt_stream_open(stream, p_cdc->daddr, desc_ep, xfer_len);
     tu_edpt_stream_clear(stream);
 
     desc_ep = (const tusb_desc_endpoint_t *)tu_desc_next(desc_ep);
@@ -1106,6 +1111,41 @@ static bool ftdi_set_request(cdch_interface_t *p_cdc, uint8_t request, uint8_t r
   return tuh_control_xfer(&xfer);
 }
 
+//------------- Receive -------------//
+
+// Strip the status bytes of every packet while copying payload straight into rx fifo spans. A transfer can span
+// multiple packets, only the last one can be short. Return number of payload bytes written to fifo.
+static uint32_t ftdi_rx_xfer_complete(tu_edpt_stream_t *s, uint32_t xferred_bytes) {
+  tu_fifo_buffer_info_t info;
+  const uint16_t reserved = tu_fifo_write_reserve(&s->ff, &info, (uint16_t) xferred_bytes);
+  uint16_t count = 0;
+
+  for (uint32_t offset = 0; offset < xferred_bytes && count < reserved; offset += s->mps) {
+    const uint32_t packet_len = tu_min32(xferred_bytes - offset, s->mps);
+    if (packet_len <= FTDI_SIO_RX_STATUS_LEN) {
+      continue; // status only
+    }
+
+    const uint8_t *src = s->ep_buf + offset + FTDI_SIO_RX_STATUS_LEN;
+    uint16_t len = (uint16_t) tu_min32(packet_len - FTDI_SIO_RX_STATUS_LEN, reserved - count);
+
+    if (count < info.linear.len) {
+      const uint16_t lin_len = tu_min16(len, info.linear.len - count);
+      memcpy(info.linear.ptr + count, src, lin_len);
+      src += lin_len;
+      len -= lin_len;
+      count += lin_len;
+    }
+    if (len > 0) {
+      memcpy(info.wrapped.ptr + (count - info.linear.len), src, len);
+      count += len;
+    }
+  }
+
+  tu_fifo_write_commit(&s->ff, count);
+  return count;
+}
+
 #ifdef CFG_TUH_CDC_FTDI_LATENCY
 static int8_t ftdi_write_latency_timer(cdch_interface_t * p_cdc, uint16_t latency,
                                        tuh_xfer_cb_t complete_cb, uintptr_t user_data) {
@@ -112,6 +112,9 @@ enum ftdi_sio_baudrate {
 #define FTDI_SIO_RI_MASK                          0x40
 #define FTDI_SIO_RLSD_MASK                        0x80
 
+// Every bulk IN packet starts with 2 status bytes (modem status, line status) followed by data
+#define FTDI_SIO_RX_STATUS_LEN                    2
+
 // FTDI_SIO_SET_BITMODE
 #define FTDI_SIO_SET_BITMODE_REQUEST_TYPE         0x40
 #define FTDI_SIO_SET_BITMODE_REQUEST              FTDI_SIO_SET_BITMODE
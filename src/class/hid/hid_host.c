@@ -618,13 +618,13 @@ static void process_set_config(tuh_xfer_t* xfer) {
         config_driver_mount_complete(daddr, idx, NULL, 0);
       } else {
         tuh_descriptor_get_hid_report(daddr, itf_num, p_hid->report_desc_type, 0,
-                                      usbh_get_enum_buf(), p_hid->report_desc_len,
+                                      usbh_get_enum_buf(daddr), p_hid->report_desc_len,
                                       process_set_config, CONFIG_COMPLETE);
       }
       break;
 
     case CONFIG_COMPLETE: {
-      const uint8_t *desc_report = usbh_get_enum_buf();
+      const uint8_t *desc_report = usbh_get_enum_buf(daddr);
       const uint16_t desc_len    = tu_le16toh(xfer->setup->wLength);
 
       config_driver_mount_complete(daddr, idx, desc_report, desc_len);
@@ -39,7 +39,8 @@ typedef enum
 {
   MSC_PROTOCOL_CBI              = 0 ,  ///< Control/Bulk/Interrupt protocol (with command completion interrupt)
   MSC_PROTOCOL_CBI_NO_INTERRUPT = 1 ,  ///< Control/Bulk/Interrupt protocol (without command completion interrupt)
-  MSC_PROTOCOL_BOT              = 0x50 ///< Bulk-Only Transport
+  MSC_PROTOCOL_BOT              = 0x50, ///< Bulk-Only Transport
+  MSC_PROTOCOL_UAS              = 0x62  ///< USB Attached SCSI
 }msc_protocol_type_t;
 
 /// MassStorage Class-Specific Control Request
@@ -84,6 +85,118 @@ typedef struct TU_ATTR_PACKED
 
 TU_VERIFY_STATIC(sizeof(msc_csw_t) == 13, "size is not correct");
 
+//--------------------------------------------------------------------+
+// USB Attached SCSI (UAS)
+//--------------------------------------------------------------------+
+
+/// UAS class-specific Pipe Usage descriptor type
+#define MSC_UAS_DESC_PIPE_USAGE 0x24
+
+/// UAS Pipe ID in Pipe Usage descriptor
+typedef enum {
+  MSC_UAS_PIPE_COMMAND  = 1,
+  MSC_UAS_PIPE_STATUS   = 2,
+  MSC_UAS_PIPE_DATA_IN  = 3,
+  MSC_UAS_PIPE_DATA_OUT = 4
+} msc_uas_pipe_id_t;
+
+/// UAS Information Unit ID
+typedef enum {
+  MSC_UAS_IU_COMMAND     = 0x01,
+  MSC_UAS_IU_SENSE       = 0x03,
+  MSC_UAS_IU_RESPONSE    = 0x04,
+  MSC_UAS_IU_TASK_MGMT   = 0x05,
+  MSC_UAS_IU_READ_READY  = 0x06,
+  MSC_UAS_IU_WRITE_READY = 0x07
+} msc_uas_iu_id_t;
+
+/// UAS Task Management Function
+typedef enum {
+  MSC_UAS_TMF_ABORT_TASK        = 0x01,
+  MSC_UAS_TMF_ABORT_TASK_SET    = 0x02,
+  MSC_UAS_TMF_CLEAR_TASK_SET    = 0x04,
+  MSC_UAS_TMF_LOGICAL_UNIT_RESET = 0x08,
+  MSC_UAS_TMF_IT_NEXUS_RESET    = 0x10,
+  MSC_UAS_TMF_QUERY_TASK        = 0x80
+} msc_uas_tmf_t;
+
+/// UAS Response Code of RESPONSE IU
+typedef enum {
+  MSC_UAS_RESP_TMF_COMPLETE      = 0x00,
+  MSC_UAS_RESP_INVALID_IU        = 0x02,
+  MSC_UAS_RESP_TMF_NOT_SUPPORTED = 0x04,
+  MSC_UAS_RESP_TMF_FAILED        = 0x05,
+  MSC_UAS_RESP_TMF_SUCCEEDED     = 0x08,
+  MSC_UAS_RESP_OVERLAPPED_TAG    = 0x0A
+} msc_uas_resp_code_t;
+
+/// SCSI Status in UAS SENSE IU
+typedef enum {
+  SCSI_STATUS_GOOD            = 0x00,
+  SCSI_STATUS_CHECK_CONDITION = 0x02,
+  SCSI_STATUS_TASK_SET_FULL   = 0x28
+} scsi_status_t;
+
+/// UAS Command IU, multi-byte fields are big endian
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;       ///< MSC_UAS_IU_COMMAND
+  uint8_t  reserved1;
+  uint16_t tag;         ///< Tag of this command, echoed back in READY and SENSE IU
+  uint8_t  prio_attr;   ///< Command priority and task attribute
+  uint8_t  reserved5;
+  uint8_t  add_cdb_len; ///< Additional CDB length in 4-byte unit, not supported
+  uint8_t  reserved7;
+  uint8_t  lun[8];
+  uint8_t  cdb[16];
+} msc_uas_cmd_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_cmd_iu_t) == 32, "size is not correct");
+
+/// UAS Task Management IU
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;     ///< MSC_UAS_IU_TASK_MGMT
+  uint8_t  reserved1;
+  uint16_t tag;
+  uint8_t  function;  ///< \ref msc_uas_tmf_t
+  uint8_t  reserved5;
+  uint16_t task_tag;  ///< Tag of the task to be managed
+  uint8_t  lun[8];
+} msc_uas_task_mgmt_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_task_mgmt_iu_t) == 16, "size is not correct");
+
+/// UAS READ READY / WRITE READY IU
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;
+  uint8_t  reserved1;
+  uint16_t tag;
+} msc_uas_ready_iu_t;
+
+/// UAS SENSE IU with fixed format sense data
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;            ///< MSC_UAS_IU_SENSE
+  uint8_t  reserved1;
+  uint16_t tag;
+  uint16_t status_qualifier;
+  uint8_t  status;           ///< \ref scsi_status_t
+  uint8_t  reserved7[7];
+  uint16_t sense_len;        ///< Length of sense data
+  uint8_t  sense[18];
+} msc_uas_sense_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_sense_iu_t) == 34, "size is not correct");
+
+/// UAS RESPONSE IU
+typedef struct TU_ATTR_PACKED {
+  uint8_t  iu_id;          ///< MSC_UAS_IU_RESPONSE
+  uint8_t  reserved1;
+  uint16_t tag;
+  uint8_t  add_resp_info[3];
+  uint8_t  resp_code;      ///< \ref msc_uas_resp_code_t
+} msc_uas_response_iu_t;
+
+TU_VERIFY_STATIC(sizeof(msc_uas_response_iu_t) == 8, "size is not correct");
+
 //--------------------------------------------------------------------+
 // SCSI Constant
 //--------------------------------------------------------------------+
@@ -101,8 +214,16 @@ typedef enum {
   SCSI_CMD_READ_FORMAT_CAPACITY         = 0x23, ///< The command allows the Host to request a list of the possible format capacities for an installed writable media. This command also has the capability to report the writable capacity for a media when it is installed
   SCSI_CMD_READ_10                      = 0x28, ///< The READ (10) command requests that the device server read the specified logical block(s) and transfer them to the data-in buffer.
   SCSI_CMD_WRITE_10                     = 0x2A, ///< The WRITE (10) command requests that the device server transfer the specified logical block(s) from the data-out buffer and write them.
+  SCSI_CMD_READ_16                      = 0x88, ///< The READ (16) command is the READ (10) command with 64-bit LBA and 32-bit transfer length, required for devices larger than 2 TiB.
+  SCSI_CMD_WRITE_16                     = 0x8A, ///< The WRITE (16) command is the WRITE (10) command with 64-bit LBA and 32-bit transfer length.
+  SCSI_CMD_SERVICE_ACTION_IN_16         = 0x9E, ///< SERVICE ACTION IN (16), used with \ref SCSI_SERVICE_ACTION_READ_CAPACITY_16 to read 64-bit capacity.
 }scsi_cmd_type_t;
 
+/// SCSI Service Action for \ref SCSI_CMD_SERVICE_ACTION_IN_16
+enum {
+  SCSI_SERVICE_ACTION_READ_CAPACITY_16 = 0x10,
+};
+
 /// SCSI Sense Key
 typedef enum {
   SCSI_SENSE_NONE            = 0x00, ///< no specific Sense Key. This would be the case for a successful command
@@ -375,6 +496,46 @@ typedef struct TU_ATTR_PACKED
 TU_VERIFY_STATIC(sizeof(scsi_read10_t) == 10, "size is not correct");
 TU_VERIFY_STATIC(sizeof(scsi_write10_t) == 10, "size is not correct");
 
+/// SCSI Read Capacity 16 Command: Service Action In (16) with Read Capacity service action
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t  cmd_code       ; ///< SCSI OpCode for \ref SCSI_CMD_SERVICE_ACTION_IN_16
+  uint8_t  service_action ; ///< \ref SCSI_SERVICE_ACTION_READ_CAPACITY_16
+  uint64_t lba            ; ///< Obsolete, shall be zero
+  uint32_t alloc_length   ; ///< Maximum number of bytes of response
+  uint8_t  reserved       ;
+  uint8_t  control        ;
+} scsi_read_capacity16_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read_capacity16_t) == 16, "size is not correct");
+
+/// SCSI Read Capacity 16 Response Data
+typedef struct TU_ATTR_PACKED
+{
+  uint64_t last_lba           ; ///< The last Logical Block Address of the device
+  uint32_t block_size         ; ///< Block size in bytes
+  uint8_t  protection         ;
+  uint8_t  lbppb_exponent     ; ///< Logical blocks per physical block exponent
+  uint16_t lowest_aligned_lba ;
+  uint8_t  reserved[16]       ;
+} scsi_read_capacity16_resp_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read_capacity16_resp_t) == 32, "size is not correct");
+
+/// SCSI Read 16 Command
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t  cmd_code    ; ///< SCSI OpCode
+  uint8_t  flags       ;
+  uint64_t lba         ; ///< The first Logical Block Address (LBA) accessed by this command
+  uint32_t block_count ; ///< Number of Blocks used by this command
+  uint8_t  group       ;
+  uint8_t  control     ;
+} scsi_read16_t, scsi_write16_t;
+
+TU_VERIFY_STATIC(sizeof(scsi_read16_t) == 16, "size is not correct");
+TU_VERIFY_STATIC(sizeof(scsi_write16_t) == 16, "size is not correct");
+
 #ifdef __cplusplus
  }
 #endif
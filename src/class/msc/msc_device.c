@@ -9,7 +9,6 @@
 
 #if (CFG_TUD_ENABLED && CFG_TUD_MSC)
 
-#include "device/dcd.h"         // for faking dcd_event_xfer_complete
 #include "device/usbd.h"
 #include "device/usbd_pvt.h"
 
@@ -65,44 +64,103 @@ typedef struct {
   uint8_t add_sense_qualifier;
 
   bool pending_io; // pending async IO
+  bool io_failed;  // READ10 storage error, reported once in-flight data is sent
+
+  // READ10/WRITE10 data stage buffer ring: filled buffers start at buf_rd
+  // - READ10: filled by storage, sent to host. io_len is number of bytes read from storage
+  // - WRITE10: filled by host, written to storage. io_len is number of bytes received from host
+  uint8_t  buf_rd;
+  uint8_t  buf_count;
+  uint16_t buf_len[CFG_TUD_MSC_EP_BUFCOUNT];
+  uint32_t io_len;
+
+#if CFG_TUD_MSC_UAS
+  // USB Attached SCSI: when alternate 1 is selected, ep_in/ep_out are the UAS data pipes
+  bool    uas;
+  uint8_t ep_bot_in;
+  uint8_t ep_bot_out;
+  uint8_t ep_uas_cmd;
+  uint8_t ep_uas_status;
+  tusb_desc_endpoint_t const* uas_desc_ep[4]; // indexed by pipe id - 1
+
+  uint8_t  uas_status_pending; // UAS_STATUS_* IUs waiting for status pipe
+  uint8_t  uas_status_sent;    // UAS_STATUS_* IU being sent on status pipe
+  uint8_t  uas_resp_code;
+  uint16_t uas_resp_tag;
+
+  // command IU queue, executed one at a time in order
+  uint8_t uas_q_rd;
+  uint8_t uas_q_count;
+#endif
 }mscd_interface_t;
 
 static mscd_interface_t _mscd_itf;
 
+// buffer 0 is also used for CBW, CSW and other SCSI commands
 CFG_TUD_MEM_SECTION static struct {
   TUD_EPBUF_DEF(buf, CFG_TUD_MSC_EP_BUFSIZE);
-} _mscd_epbuf;
+} _mscd_epbuf[CFG_TUD_MSC_EP_BUFCOUNT];
 
 TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE >= 64, "CFG_TUD_MSC_EP_BUFSIZE must be at least 64");
 
+#if CFG_TUD_MSC_UAS
+enum {
+  UAS_STATUS_RESPONSE    = TU_BIT(0),
+  UAS_STATUS_READ_READY  = TU_BIT(1),
+  UAS_STATUS_WRITE_READY = TU_BIT(2),
+  UAS_STATUS_SENSE       = TU_BIT(3),
+};
+
+CFG_TUD_MEM_SECTION static struct {
+  TUD_EPBUF_DEF(cmd, 64); // command or task management IU
+  TUD_EPBUF_DEF(status, sizeof(msc_uas_sense_iu_t));
+} _mscd_uas_epbuf;
+
+static msc_uas_cmd_iu_t _mscd_uas_queue[CFG_TUD_MSC_UAS_QUEUE_DEPTH];
+
+TU_VERIFY_STATIC(CFG_TUD_MSC_UAS_QUEUE_DEPTH > 0 && CFG_TUD_MSC_UAS_QUEUE_DEPTH < 256, "invalid UAS queue depth");
+#endif
+
 //--------------------------------------------------------------------+
 // INTERNAL OBJECT & FUNCTION DECLARATION
 //--------------------------------------------------------------------+
 static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_t* buffer, uint32_t bufsize);
 static void proc_read10_cmd(mscd_interface_t* p_msc);
-static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes);
+static void proc_read10_pump(mscd_interface_t* p_msc);
+static void proc_read10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes);
+static bool proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes);
 static void proc_write10_cmd(mscd_interface_t* p_msc);
+static void proc_write10_pump(mscd_interface_t* p_msc);
 static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes);
-static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes, int32_t nbytes);
+static bool proc_write_io_data(mscd_interface_t* p_msc, int32_t nbytes);
 static bool proc_stage_status(mscd_interface_t* p_msc);
 
+#if CFG_TUD_MSC_UAS
+static void uas_status_kick(mscd_interface_t* p_msc);
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline bool is_data_in(uint8_t dir) {
   return tu_bit_test(dir, 7);
 }
 
+// index of the n-th buffer from the oldest filled one
+TU_ATTR_ALWAYS_INLINE static inline uint8_t rdwr10_buf_idx(mscd_interface_t const* p_msc, uint8_t n) {
+  return (uint8_t) ((p_msc->buf_rd + n) % CFG_TUD_MSC_EP_BUFCOUNT);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool send_csw(mscd_interface_t* p_msc) {
   // Data residue is always = host expect - actual transferred
   uint8_t rhport = p_msc->rhport;
   p_msc->csw.data_residue = p_msc->cbw.total_bytes - p_msc->xferred_len;
   p_msc->stage = MSC_STAGE_STATUS_SENT;
-  memcpy(_mscd_epbuf.buf, &p_msc->csw, sizeof(msc_csw_t)); //-V1086
-  return usbd_edpt_xfer(rhport, p_msc->ep_in , _mscd_epbuf.buf, sizeof(msc_csw_t), false);
+  memcpy(_mscd_epbuf[0].buf, &p_msc->csw, sizeof(msc_csw_t)); //-V1086
+  return usbd_edpt_xfer(rhport, p_msc->ep_in , _mscd_epbuf[0].buf, sizeof(msc_csw_t), false);
 }
 
 TU_ATTR_ALWAYS_INLINE static inline bool prepare_cbw(mscd_interface_t* p_msc) {
   uint8_t rhport = p_msc->rhport;
   p_msc->stage = MSC_STAGE_CMD;
-  return usbd_edpt_xfer(rhport, p_msc->ep_out,  _mscd_epbuf.buf, sizeof(msc_cbw_t), false);
+  return usbd_edpt_xfer(rhport, p_msc->ep_out,  _mscd_epbuf[0].buf, sizeof(msc_cbw_t), false);
 }
 
 static void fail_scsi_op(mscd_interface_t* p_msc, uint8_t status) {
@@ -119,6 +177,13 @@ static void fail_scsi_op(mscd_interface_t* p_msc, uint8_t status) {
     (void) tud_msc_set_sense(p_cbw->lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
   }
 
+  #if CFG_TUD_MSC_UAS
+  // UAS reports failure with sense IU only, data pipes are never stalled
+  if (p_msc->uas) {
+    return;
+  }
+  #endif
+
   // If there is data stage and not yet complete, stall it
   if (p_cbw->total_bytes && p_csw->data_residue) {
     if (is_data_in(p_cbw->dir)) {
@@ -185,6 +250,15 @@ static bool proc_stage_status(mscd_interface_t *p_msc) {
   uint8_t rhport = p_msc->rhport;
   msc_cbw_t const *p_cbw = &p_msc->cbw;
 
+  #if CFG_TUD_MSC_UAS
+  if (p_msc->uas) {
+    p_msc->stage = MSC_STAGE_STATUS_SENT;
+    p_msc->uas_status_pending |= UAS_STATUS_SENSE;
+    uas_status_kick(p_msc);
+    return true;
+  }
+  #endif
+
   // skip status if epin is currently stalled, will do it when received Clear Stall request
   if (!usbd_edpt_stalled(rhport, p_msc->ep_in)) {
     if ((p_cbw->total_bytes > p_msc->xferred_len) && is_data_in(p_cbw->dir)) {
@@ -297,6 +371,33 @@ TU_ATTR_ALWAYS_INLINE static inline void set_sense_medium_not_present(uint8_t lu
   (void) tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);
 }
 
+static void invoke_complete_cb(msc_cbw_t const* p_cbw) {
+  switch (p_cbw->command[0]) {
+    case SCSI_CMD_READ_10:
+      tud_msc_read10_complete_cb(p_cbw->lun);
+      break;
+
+    case SCSI_CMD_WRITE_10:
+      tud_msc_write10_complete_cb(p_cbw->lun);
+      break;
+
+    default:
+      tud_msc_scsi_complete_cb(p_cbw->lun, p_cbw->command);
+      break;
+  }
+}
+
+// fixed format sense data of current sense key
+static void fill_sense_fixed(mscd_interface_t const* p_msc, scsi_sense_fixed_resp_t* sense_rsp) {
+  tu_memclr(sense_rsp, sizeof(scsi_sense_fixed_resp_t));
+  sense_rsp->response_code = 0x70; // current, fixed format
+  sense_rsp->valid = 1;
+  sense_rsp->add_sense_len = sizeof(scsi_sense_fixed_resp_t) - 8;
+  sense_rsp->sense_key = (uint8_t)(p_msc->sense_key & 0x0F);
+  sense_rsp->add_sense_code = p_msc->add_sense_code;
+  sense_rsp->add_sense_qualifier = p_msc->add_sense_qualifier;
+}
+
 static void proc_async_io_done(void *bytes_io) {
   mscd_interface_t *p_msc = &_mscd_itf;
   TU_VERIFY(p_msc->pending_io, );
@@ -306,11 +407,15 @@ static void proc_async_io_done(void *bytes_io) {
   p_msc->pending_io = false;
   switch (cmd) {
     case SCSI_CMD_READ_10:
-      proc_read_io_data(p_msc, nbytes);
+      if (proc_read_io_data(p_msc, nbytes)) {
+        proc_read10_pump(p_msc);
+      }
       break;
 
     case SCSI_CMD_WRITE_10:
-      proc_write_io_data(p_msc, (uint32_t) nbytes, nbytes);
+      if (proc_write_io_data(p_msc, nbytes)) {
+        proc_write10_pump(p_msc);
+      }
       break;
 
     default: break; // nothing to do
@@ -322,6 +427,29 @@ static void proc_async_io_done(void *bytes_io) {
   }
 }
 
+// Retry READ10/WRITE10 I/O after callback returned TUD_MSC_RET_BUSY and no transfer is in progress
+static void proc_rdwr10_retry(void *param) {
+  (void) param;
+  mscd_interface_t *p_msc = &_mscd_itf;
+  TU_VERIFY(p_msc->stage == MSC_STAGE_DATA, );
+
+  switch (p_msc->cbw.command[0]) {
+    case SCSI_CMD_READ_10:
+      proc_read10_pump(p_msc);
+      break;
+
+    case SCSI_CMD_WRITE_10:
+      proc_write10_pump(p_msc);
+      break;
+
+    default: break; // nothing to do
+  }
+
+  if (p_msc->stage == MSC_STAGE_STATUS) {
+    proc_stage_status(p_msc);
+  }
+}
+
 bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr) {
   // Precheck to avoid queueing multiple RW done callback
   TU_VERIFY(_mscd_itf.pending_io);
@@ -332,6 +460,404 @@ bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr) {
   return true;
 }
 
+//--------------------------------------------------------------------+
+// USB Attached SCSI
+// Command IUs are queued and executed one at a time in order. Each command reuses the BOT data stage state machine
+// with a CBW synthesized from its IU, status pipe then sends READ/WRITE READY and SENSE IUs instead of CSW.
+//--------------------------------------------------------------------+
+#if CFG_TUD_MSC_UAS
+
+TU_ATTR_ALWAYS_INLINE static inline bool uas_response_outstanding(mscd_interface_t const* p_msc) {
+  return ((p_msc->uas_status_pending | p_msc->uas_status_sent) & UAS_STATUS_RESPONSE) != 0;
+}
+
+// queue a response IU for task management or an invalid IU
+static void uas_respond(mscd_interface_t* p_msc, uint16_t tag, uint8_t resp_code) {
+  p_msc->uas_resp_tag = tag;
+  p_msc->uas_resp_code = resp_code;
+  p_msc->uas_status_pending |= UAS_STATUS_RESPONSE;
+}
+
+// receive next IU if there is room in queue. Pipe is held while a response is outstanding since there is only one
+// response slot
+static void uas_cmd_arm(mscd_interface_t* p_msc) {
+  const uint8_t rhport = p_msc->rhport;
+  if (p_msc->uas_q_count < CFG_TUD_MSC_UAS_QUEUE_DEPTH && !uas_response_outstanding(p_msc) &&
+      usbd_edpt_ready(rhport, p_msc->ep_uas_cmd)) {
+    TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_uas_cmd, _mscd_uas_epbuf.cmd, sizeof(_mscd_uas_epbuf.cmd), false),);
+  }
+}
+
+// return queue position of command with tag, -1 if not found
+static int uas_queue_find(mscd_interface_t const* p_msc, uint16_t tag) {
+  for (uint8_t i = 0; i < p_msc->uas_q_count; i++) {
+    msc_uas_cmd_iu_t const* iu = &_mscd_uas_queue[(p_msc->uas_q_rd + i) % CFG_TUD_MSC_UAS_QUEUE_DEPTH];
+    if (tu_ntohs(iu->tag) == tag) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool uas_tag_in_use(mscd_interface_t const* p_msc, uint16_t tag) {
+  const bool active = (p_msc->stage != MSC_STAGE_CMD) && (p_msc->cbw.tag == tag);
+  return active || (uas_queue_find(p_msc, tag) >= 0);
+}
+
+// remove queued command at position pos, later commands are moved forward to keep order
+static void uas_queue_remove(mscd_interface_t* p_msc, uint8_t pos) {
+  for (uint8_t i = pos; i + 1u < p_msc->uas_q_count; i++) {
+    _mscd_uas_queue[(p_msc->uas_q_rd + i) % CFG_TUD_MSC_UAS_QUEUE_DEPTH] =
+      _mscd_uas_queue[(p_msc->uas_q_rd + i + 1) % CFG_TUD_MSC_UAS_QUEUE_DEPTH];
+  }
+  p_msc->uas_q_count--;
+}
+
+static void uas_task_mgmt(mscd_interface_t* p_msc, msc_uas_task_mgmt_iu_t const* iu) {
+  const uint16_t task_tag = tu_ntohs(iu->task_tag);
+  uint8_t resp_code;
+
+  switch (iu->function) {
+    case MSC_UAS_TMF_ABORT_TASK: {
+      const int pos = uas_queue_find(p_msc, task_tag);
+      if (pos >= 0) {
+        uas_queue_remove(p_msc, (uint8_t) pos);
+        resp_code = MSC_UAS_RESP_TMF_COMPLETE;
+      } else if (p_msc->stage != MSC_STAGE_CMD && p_msc->cbw.tag == task_tag) {
+        // command being executed cannot be aborted, it completes with its sense IU
+        resp_code = MSC_UAS_RESP_TMF_FAILED;
+      } else {
+        resp_code = MSC_UAS_RESP_TMF_COMPLETE; // already completed
+      }
+      break;
+    }
+
+    case MSC_UAS_TMF_ABORT_TASK_SET:
+    case MSC_UAS_TMF_CLEAR_TASK_SET:
+    case MSC_UAS_TMF_LOGICAL_UNIT_RESET:
+    case MSC_UAS_TMF_IT_NEXUS_RESET:
+      // drop queued commands, the one being executed runs to completion
+      p_msc->uas_q_count = 0;
+      resp_code = MSC_UAS_RESP_TMF_COMPLETE;
+      break;
+
+    case MSC_UAS_TMF_QUERY_TASK:
+      resp_code = uas_tag_in_use(p_msc, task_tag) ? MSC_UAS_RESP_TMF_SUCCEEDED : MSC_UAS_RESP_TMF_COMPLETE;
+      break;
+
+    default:
+      resp_code = MSC_UAS_RESP_TMF_NOT_SUPPORTED;
+      break;
+  }
+
+  TU_LOG_DRV("  UAS Task Management %u [tag %u] = %u\r\n", iu->function, task_tag, resp_code);
+  uas_respond(p_msc, tu_ntohs(iu->tag), resp_code);
+}
+
+// Allocation length of non READ10/WRITE10 command. Command IU has neither direction nor transfer length unlike CBW,
+// only commands known to have no data or data-in stage are accepted. Return false for data-out or unknown opcode
+static bool uas_data_in_len(uint8_t const cdb[16], uint32_t* len) {
+  switch (cdb[0]) {
+    case SCSI_CMD_TEST_UNIT_READY:
+    case SCSI_CMD_START_STOP_UNIT:
+    case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+      *len = 0;
+      return true;
+
+    case SCSI_CMD_REQUEST_SENSE:
+    case SCSI_CMD_MODE_SENSE_6:
+      *len = cdb[4];
+      return true;
+
+    case SCSI_CMD_INQUIRY:
+      *len = tu_ntohs(tu_unaligned_read16(cdb + 3));
+      return true;
+
+    case SCSI_CMD_READ_FORMAT_CAPACITY:
+      *len = tu_ntohs(tu_unaligned_read16(cdb + 7));
+      return true;
+
+    case SCSI_CMD_READ_CAPACITY_10:
+      *len = sizeof(scsi_read_capacity10_resp_t);
+      return true;
+
+    case SCSI_CMD_SERVICE_ACTION_IN_16:
+      *len = tu_ntohl(tu_unaligned_read32(cdb + 10));
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// start next queued command if none is being executed
+static void uas_dispatch(mscd_interface_t* p_msc) {
+  if (p_msc->stage != MSC_STAGE_CMD || p_msc->uas_q_count == 0) {
+    return;
+  }
+
+  const uint8_t rhport = p_msc->rhport;
+  msc_cbw_t* p_cbw = &p_msc->cbw;
+  msc_uas_cmd_iu_t const* iu = &_mscd_uas_queue[p_msc->uas_q_rd];
+
+  tu_memclr(p_cbw, sizeof(msc_cbw_t));
+  p_cbw->tag = tu_ntohs(iu->tag);
+  p_cbw->lun = iu->lun[1]; // single level LUN
+  p_cbw->cmd_len = sizeof(iu->cdb);
+  memcpy(p_cbw->command, iu->cdb, sizeof(iu->cdb));
+
+  p_msc->uas_q_rd = (uint8_t) ((p_msc->uas_q_rd + 1) % CFG_TUD_MSC_UAS_QUEUE_DEPTH);
+  p_msc->uas_q_count--;
+  uas_cmd_arm(p_msc);
+
+  TU_LOG_DRV("  UAS Command [Lun%u tag %u]: %s\r\n", p_cbw->lun, p_cbw->tag, tu_lookup_find(&_msc_scsi_cmd_table, p_cbw->command[0]));
+
+  p_msc->csw.status = MSC_CSW_STATUS_PASSED;
+  p_msc->stage = MSC_STAGE_DATA;
+  p_msc->xferred_len = 0;
+
+  const uint8_t cmd = p_cbw->command[0];
+  uint32_t alloc_len = 0;
+  if ((SCSI_CMD_READ_10 == cmd) || (SCSI_CMD_WRITE_10 == cmd)) {
+    uint32_t block_count;
+    uint16_t block_size;
+    tud_msc_capacity_cb(p_cbw->lun, &block_count, &block_size);
+
+    p_cbw->dir = (SCSI_CMD_READ_10 == cmd) ? TUSB_DIR_IN_MASK : 0;
+    p_cbw->total_bytes = (uint32_t) rdwr10_get_blockcount(p_cbw) * block_size;
+    p_msc->total_len = p_cbw->total_bytes;
+
+    if (p_cbw->total_bytes == 0) {
+      p_msc->stage = MSC_STAGE_STATUS; // zero transfer length is not an error
+    } else if (SCSI_CMD_READ_10 == cmd) {
+      p_msc->uas_status_pending |= UAS_STATUS_READ_READY;
+      proc_read10_cmd(p_msc);
+    } else {
+      p_msc->uas_status_pending |= UAS_STATUS_WRITE_READY;
+      proc_write10_cmd(p_msc);
+    }
+  } else if (!uas_data_in_len(p_cbw->command, &alloc_len)) {
+    // data-out is only supported for WRITE10, host would wait forever on Data-Out pipe otherwise
+    TU_LOG_DRV("  UAS reject data-out or unknown command\r\n");
+    fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+  } else {
+    p_cbw->dir = TUSB_DIR_IN_MASK;
+
+    int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_epbuf[0].buf, CFG_TUD_MSC_EP_BUFSIZE);
+    if ((resplen < 0) && (p_msc->sense_key == 0)) {
+      resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf[0].buf,
+                                (uint16_t) tu_min32(alloc_len, CFG_TUD_MSC_EP_BUFSIZE));
+    }
+
+    if (resplen < 0) {
+      TU_LOG_DRV("  SCSI unsupported or failed command\r\n");
+      fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+    } else {
+      // cannot return more than host expect
+      p_msc->total_len = tu_min32((uint32_t) resplen, alloc_len);
+      p_cbw->total_bytes = p_msc->total_len;
+      if (p_msc->total_len == 0) {
+        p_msc->stage = MSC_STAGE_STATUS;
+      } else {
+        p_msc->uas_status_pending |= UAS_STATUS_READ_READY;
+        TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf[0].buf, (uint16_t) p_msc->total_len, false),);
+      }
+    }
+  }
+
+  if (p_msc->stage == MSC_STAGE_STATUS) {
+    proc_stage_status(p_msc);
+  }
+}
+
+// send next IU on status pipe if idle: response first, then READY of current command before its SENSE
+static void uas_status_kick(mscd_interface_t* p_msc) {
+  const uint8_t rhport = p_msc->rhport;
+  const uint8_t pending = p_msc->uas_status_pending;
+  if (p_msc->uas_status_sent != 0 || pending == 0 || usbd_edpt_busy(rhport, p_msc->ep_uas_status)) {
+    return;
+  }
+
+  uint8_t* buf = _mscd_uas_epbuf.status;
+  uint16_t len;
+  uint8_t item;
+
+  if (pending & UAS_STATUS_RESPONSE) {
+    msc_uas_response_iu_t* resp = (msc_uas_response_iu_t*) buf;
+    tu_memclr(resp, sizeof(msc_uas_response_iu_t));
+    resp->iu_id = MSC_UAS_IU_RESPONSE;
+    resp->tag = tu_htons(p_msc->uas_resp_tag);
+    resp->resp_code = p_msc->uas_resp_code;
+    item = UAS_STATUS_RESPONSE;
+    len = sizeof(msc_uas_response_iu_t);
+  } else if (pending & (UAS_STATUS_READ_READY | UAS_STATUS_WRITE_READY)) {
+    msc_uas_ready_iu_t* ready = (msc_uas_ready_iu_t*) buf;
+    item = pending & (UAS_STATUS_READ_READY | UAS_STATUS_WRITE_READY);
+    ready->iu_id = (item == UAS_STATUS_READ_READY) ? MSC_UAS_IU_READ_READY : MSC_UAS_IU_WRITE_READY;
+    ready->reserved1 = 0;
+    ready->tag = tu_htons((uint16_t) p_msc->cbw.tag);
+    len = sizeof(msc_uas_ready_iu_t);
+  } else {
+    msc_uas_sense_iu_t* sense = (msc_uas_sense_iu_t*) buf;
+    tu_memclr(sense, sizeof(msc_uas_sense_iu_t));
+    sense->iu_id = MSC_UAS_IU_SENSE;
+    sense->tag = tu_htons((uint16_t) p_msc->cbw.tag);
+    item = UAS_STATUS_SENSE;
+
+    if (p_msc->csw.status == MSC_CSW_STATUS_PASSED) {
+      sense->status = SCSI_STATUS_GOOD;
+      len = offsetof(msc_uas_sense_iu_t, sense);
+    } else {
+      scsi_sense_fixed_resp_t sense_rsp;
+      fill_sense_fixed(p_msc, &sense_rsp);
+      sense->status = SCSI_STATUS_CHECK_CONDITION;
+      sense->sense_len = tu_htons(sizeof(scsi_sense_fixed_resp_t));
+      memcpy(sense->sense, &sense_rsp, sizeof(scsi_sense_fixed_resp_t));
+      len = sizeof(msc_uas_sense_iu_t);
+
+      // sense data is delivered with status, no REQUEST SENSE follows
+      (void) tud_msc_set_sense(p_msc->cbw.lun, 0, 0, 0);
+    }
+  }
+
+  p_msc->uas_status_pending &= (uint8_t) ~item;
+  p_msc->uas_status_sent = item;
+  TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_uas_status, buf, len, false),);
+}
+
+static void uas_cmd_xfer_done(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  uint8_t const* iu = _mscd_uas_epbuf.cmd;
+  const uint16_t tag = (xferred_bytes >= 4) ? tu_ntohs(tu_unaligned_read16(iu + 2)) : 0;
+
+  if (xferred_bytes >= sizeof(msc_uas_cmd_iu_t) && iu[0] == MSC_UAS_IU_COMMAND) {
+    if (uas_tag_in_use(p_msc, tag)) {
+      TU_LOG_DRV("  UAS overlapped tag %u\r\n", tag);
+      uas_respond(p_msc, tag, MSC_UAS_RESP_OVERLAPPED_TAG);
+    } else {
+      const uint8_t wr = (uint8_t) ((p_msc->uas_q_rd + p_msc->uas_q_count) % CFG_TUD_MSC_UAS_QUEUE_DEPTH);
+      memcpy(&_mscd_uas_queue[wr], iu, sizeof(msc_uas_cmd_iu_t));
+      p_msc->uas_q_count++;
+    }
+  } else if (xferred_bytes >= sizeof(msc_uas_task_mgmt_iu_t) && iu[0] == MSC_UAS_IU_TASK_MGMT) {
+    uas_task_mgmt(p_msc, (msc_uas_task_mgmt_iu_t const*) iu);
+  } else {
+    TU_LOG_DRV("  UAS invalid IU\r\n");
+    uas_respond(p_msc, tag, MSC_UAS_RESP_INVALID_IU);
+  }
+
+  uas_cmd_arm(p_msc);
+  uas_dispatch(p_msc);
+  uas_status_kick(p_msc);
+}
+
+static void uas_status_xfer_done(mscd_interface_t* p_msc) {
+  const uint8_t item = p_msc->uas_status_sent;
+  p_msc->uas_status_sent = 0;
+
+  if (item == UAS_STATUS_SENSE) {
+    TU_LOG_DRV("  UAS Sense [Lun%u tag %u] = %u\r\n", p_msc->cbw.lun, p_msc->cbw.tag, p_msc->csw.status);
+    invoke_complete_cb(&p_msc->cbw);
+    p_msc->stage = MSC_STAGE_CMD;
+  }
+
+  uas_cmd_arm(p_msc); // response slot may be free now
+  uas_dispatch(p_msc);
+  uas_status_kick(p_msc);
+}
+
+// switch between BOT (alternate 0) and UAS (alternate 1), any command in progress is dropped
+static bool uas_set_alt(mscd_interface_t* p_msc, uint8_t alt) {
+  const uint8_t rhport = p_msc->rhport;
+  TU_VERIFY(alt == 0 || p_msc->ep_uas_cmd != 0);
+
+  // Endpoints of both alternates are opened in mscd_open(). Abort transfers in flight on pipes of current protocol
+  // so that their completion is not fed to the state machine of the other one
+  if (p_msc->uas) {
+    for (uint8_t i = 0; i < 4; i++) {
+      usbd_edpt_abort(rhport, p_msc->uas_desc_ep[i]->bEndpointAddress);
+    }
+  } else {
+    usbd_edpt_abort(rhport, p_msc->ep_bot_in);
+    usbd_edpt_abort(rhport, p_msc->ep_bot_out);
+  }
+
+  // Set Interface resets data toggle of endpoints in selected alternate to DATA0
+  if (alt == 1) {
+    for (uint8_t i = 0; i < 4; i++) {
+      usbd_edpt_clear_stall(rhport, p_msc->uas_desc_ep[i]->bEndpointAddress);
+    }
+    p_msc->ep_in  = p_msc->uas_desc_ep[MSC_UAS_PIPE_DATA_IN - 1]->bEndpointAddress;
+    p_msc->ep_out = p_msc->uas_desc_ep[MSC_UAS_PIPE_DATA_OUT - 1]->bEndpointAddress;
+  } else {
+    usbd_edpt_clear_stall(rhport, p_msc->ep_bot_in);
+    usbd_edpt_clear_stall(rhport, p_msc->ep_bot_out);
+    p_msc->ep_in  = p_msc->ep_bot_in;
+    p_msc->ep_out = p_msc->ep_bot_out;
+  }
+
+  p_msc->uas = (alt == 1);
+  p_msc->stage = MSC_STAGE_CMD;
+  p_msc->total_len = 0;
+  p_msc->xferred_len = 0;
+  p_msc->buf_count = 0;
+  p_msc->pending_io = false;
+  p_msc->uas_status_pending = 0;
+  p_msc->uas_status_sent = 0;
+  p_msc->uas_q_count = 0;
+
+  if (p_msc->uas) {
+    uas_cmd_arm(p_msc);
+  } else {
+    TU_ASSERT(prepare_cbw(p_msc));
+  }
+  return true;
+}
+
+// parse UAS alternate setting following BOT one, return its length or 0 if there is none
+static uint16_t uas_open(mscd_interface_t* p_msc, uint8_t const* p_desc, uint8_t const* desc_end) {
+  TU_VERIFY(p_desc < desc_end && tu_desc_type(p_desc) == TUSB_DESC_INTERFACE, 0);
+  tusb_desc_interface_t const* alt_desc = (tusb_desc_interface_t const*) p_desc;
+  TU_VERIFY(alt_desc->bInterfaceNumber == p_msc->itf_num && alt_desc->bAlternateSetting == 1 &&
+            alt_desc->bInterfaceProtocol == MSC_PROTOCOL_UAS && alt_desc->bNumEndpoints == 4, 0);
+
+  uint8_t const* p_start = p_desc;
+  tusb_desc_endpoint_t const* desc_ep = NULL;
+  uint8_t found = 0;
+
+  p_desc = tu_desc_next(p_desc);
+  while (p_desc < desc_end && tu_desc_type(p_desc) != TUSB_DESC_INTERFACE &&
+         tu_desc_type(p_desc) != TUSB_DESC_INTERFACE_ASSOCIATION) {
+    if (tu_desc_type(p_desc) == TUSB_DESC_ENDPOINT) {
+      desc_ep = (tusb_desc_endpoint_t const*) p_desc;
+    } else if (tu_desc_type(p_desc) == MSC_UAS_DESC_PIPE_USAGE && desc_ep != NULL) {
+      const uint8_t pipe_id = p_desc[2];
+      TU_ASSERT(pipe_id >= MSC_UAS_PIPE_COMMAND && pipe_id <= MSC_UAS_PIPE_DATA_OUT, 0);
+      TU_ASSERT(desc_ep->bmAttributes.xfer == TUSB_XFER_BULK, 0);
+      p_msc->uas_desc_ep[pipe_id - 1] = desc_ep;
+      found++;
+    } else {
+      // skip unknown descriptor
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+  TU_ASSERT(found == 4, 0);
+
+  // open endpoints once for both alternates, UAS data pipes may share address with BOT ones
+  for (uint8_t i = 0; i < 4; i++) {
+    const uint8_t ep_addr = p_msc->uas_desc_ep[i]->bEndpointAddress;
+    if (ep_addr != p_msc->ep_bot_in && ep_addr != p_msc->ep_bot_out) {
+      TU_ASSERT(usbd_edpt_open(p_msc->rhport, p_msc->uas_desc_ep[i]), 0);
+    }
+  }
+
+  p_msc->ep_uas_cmd    = p_msc->uas_desc_ep[MSC_UAS_PIPE_COMMAND - 1]->bEndpointAddress;
+  p_msc->ep_uas_status = p_msc->uas_desc_ep[MSC_UAS_PIPE_STATUS - 1]->bEndpointAddress;
+
+  return (uint16_t) (p_desc - p_start);
+}
+
+#endif
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
@@ -354,7 +880,7 @@ uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
   TU_VERIFY(TUSB_CLASS_MSC    == itf_desc->bInterfaceClass &&
             MSC_SUBCLASS_SCSI == itf_desc->bInterfaceSubClass &&
             MSC_PROTOCOL_BOT  == itf_desc->bInterfaceProtocol, 0);
-  uint16_t const drv_len = sizeof(tusb_desc_interface_t) + 2*sizeof(tusb_desc_endpoint_t);
+  uint16_t drv_len = sizeof(tusb_desc_interface_t) + 2*sizeof(tusb_desc_endpoint_t);
   TU_ASSERT(max_len >= drv_len, 0); // Max length must be at least 1 interface + 2 endpoints
 
   mscd_interface_t * p_msc = &_mscd_itf;
@@ -364,6 +890,14 @@ uint16_t mscd_open(uint8_t rhport, tusb_desc_interface_t const * itf_desc, uint1
   // Open endpoint pair
   TU_ASSERT(usbd_open_edpt_pair(rhport, tu_desc_next(itf_desc), 2, TUSB_XFER_BULK, &p_msc->ep_out, &p_msc->ep_in), 0);
 
+  #if CFG_TUD_MSC_UAS
+  // UAS alternate setting if present
+  p_msc->ep_bot_in  = p_msc->ep_in;
+  p_msc->ep_bot_out = p_msc->ep_out;
+  uint8_t const* p_desc = (uint8_t const*) itf_desc;
+  drv_len += uas_open(p_msc, p_desc + drv_len, p_desc + max_len);
+  #endif
+
   // Prepare for Command Block Wrapper
   TU_ASSERT(prepare_cbw(p_msc), drv_len);
 
@@ -374,6 +908,7 @@ static void proc_bot_reset(mscd_interface_t* p_msc) {
   p_msc->stage       = MSC_STAGE_CMD;
   p_msc->total_len   = 0;
   p_msc->xferred_len = 0;
+  p_msc->buf_count   = 0;
   p_msc->sense_key           = 0;
   p_msc->add_sense_code      = 0;
   p_msc->add_sense_qualifier = 0;
@@ -396,6 +931,12 @@ bool mscd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t
        TUSB_REQ_FEATURE_EDPT_HALT == request->wValue ) {
     uint8_t const ep_addr = tu_u16_low(request->wIndex);
 
+    #if CFG_TUD_MSC_UAS
+    if (p_msc->uas) {
+      return true; // UAS never stalls its pipes, nothing to recover
+    }
+    #endif
+
     if (p_msc->stage == MSC_STAGE_NEED_RESET) {
       // reset recovery is required to recover from this stage
       // Clear Stall request cannot resolve this -> continue to stall endpoint
@@ -422,6 +963,30 @@ bool mscd_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t
     return true;
   }
 
+  #if CFG_TUD_MSC_UAS
+  if (TUSB_REQ_TYPE_STANDARD  == request->bmRequestType_bit.type &&
+      TUSB_REQ_RCPT_INTERFACE == request->bmRequestType_bit.recipient) {
+    switch (request->bRequest) {
+      case TUSB_REQ_GET_INTERFACE: {
+        uint8_t alt = p_msc->uas ? 1 : 0;
+        tud_control_xfer(rhport, request, &alt, 1);
+        break;
+      }
+
+      case TUSB_REQ_SET_INTERFACE: {
+        uint8_t const alt = tu_u16_low(request->wValue);
+        TU_LOG_DRV("  MSC Set Interface alt %u\r\n", alt);
+        TU_VERIFY(alt <= 1 && uas_set_alt(p_msc, alt));
+        tud_control_status(rhport, request);
+        break;
+      }
+
+      default: return false; // stall unsupported request
+    }
+    return true;
+  }
+  #endif
+
   // From this point only handle class request only
   TU_VERIFY(request->bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS);
 
@@ -457,6 +1022,23 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
   msc_cbw_t * p_cbw = &p_msc->cbw;
   msc_csw_t * p_csw = &p_msc->csw;
 
+  #if CFG_TUD_MSC_UAS
+  if (p_msc->uas) {
+    if (ep_addr == p_msc->ep_uas_cmd) {
+      uas_cmd_xfer_done(p_msc, xferred_bytes);
+      return true;
+    } else if (ep_addr == p_msc->ep_uas_status) {
+      uas_status_xfer_done(p_msc);
+      return true;
+    } else {
+      TU_VERIFY(p_msc->stage == MSC_STAGE_DATA); // data pipes are only used in data stage
+    }
+  }
+
+  // completion queued before alternate switch aborted its endpoint
+  TU_VERIFY(ep_addr == p_msc->ep_in || ep_addr == p_msc->ep_out);
+  #endif
+
   switch (p_msc->stage) {
     case MSC_STAGE_CMD: {
       //------------- new CBW received -------------//
@@ -465,7 +1047,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         return true;
       }
 
-      const uint32_t signature = tu_le32toh(tu_unaligned_read32(_mscd_epbuf.buf));
+      const uint32_t signature = tu_le32toh(tu_unaligned_read32(_mscd_epbuf[0].buf));
 
       if (!(xferred_bytes == sizeof(msc_cbw_t) && signature == MSC_CBW_SIGNATURE)) {
         // BOT 6.6.1 If CBW is not valid stall both endpoints until reset recovery
@@ -476,7 +1058,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         return false;
       }
 
-      memcpy(p_cbw, _mscd_epbuf.buf, sizeof(msc_cbw_t));
+      memcpy(p_cbw, _mscd_epbuf[0].buf, sizeof(msc_cbw_t));
 
       TU_LOG_DRV("  SCSI Command [Lun%u]: %s\r\n", p_cbw->lun, tu_lookup_find(&_msc_scsi_cmd_table, p_cbw->command[0]));
       // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, p_cbw, xferred_bytes, 2);
@@ -518,15 +1100,15 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
           } else {
             // Didn't check for case 9 (Ho > Dn), which requires examining scsi command first
             // but it is OK to just receive data then responded with failed status
-            TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_epbuf.buf, (uint16_t) p_msc->total_len, false));
+            TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_epbuf[0].buf, (uint16_t) p_msc->total_len, false));
           }
         } else {
           // First process if it is a built-in commands
-          int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf, CFG_TUD_MSC_EP_BUFSIZE);
+          int32_t resplen = proc_builtin_scsi(p_cbw->lun, p_cbw->command, _mscd_epbuf[0].buf, CFG_TUD_MSC_EP_BUFSIZE);
 
           // Invoke user callback if not built-in
           if ((resplen < 0) && (p_msc->sense_key == 0)) {
-            resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf,
+            resplen = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf[0].buf,
                                       (uint16_t) tu_min32(p_msc->total_len, CFG_TUD_MSC_EP_BUFSIZE));
           }
 
@@ -551,7 +1133,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
             } else {
               // cannot return more than host expect
               p_msc->total_len = tu_min32((uint32_t)resplen, p_cbw->total_bytes);
-              TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf.buf, (uint16_t) p_msc->total_len, false));
+              TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf[0].buf, (uint16_t) p_msc->total_len, false));
             }
           }
         }
@@ -562,17 +1144,10 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
     case MSC_STAGE_DATA:
       TU_LOG_DRV("  SCSI Data [Lun%u]\r\n", p_cbw->lun);
       TU_ASSERT(xferred_bytes <= CFG_TUD_MSC_EP_BUFSIZE); // sanity check to avoid buffer overflow
-      // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, _mscd_epbuf.buf, xferred_bytes, 2);
+      // TU_LOG_MEM(CFG_TUD_MSC_LOG_LEVEL, _mscd_epbuf[0].buf, xferred_bytes, 2);
 
       if (SCSI_CMD_READ_10 == p_cbw->command[0]) {
-        p_msc->xferred_len += xferred_bytes;
-
-        if ( p_msc->xferred_len >= p_msc->total_len ) {
-          // Data Stage is complete
-          p_msc->stage = MSC_STAGE_STATUS;
-        }else {
-          proc_read10_cmd(p_msc);
-        }
+        proc_read10_host_data(p_msc, xferred_bytes);
       } else if (SCSI_CMD_WRITE_10 == p_cbw->command[0]) {
         proc_write10_host_data(p_msc, xferred_bytes);
       } else {
@@ -580,7 +1155,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
 
         // OUT transfer, invoke callback if needed
         if ( !is_data_in(p_cbw->dir) ) {
-          int32_t cb_result = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf.buf, (uint16_t) p_msc->total_len);
+          int32_t cb_result = tud_msc_scsi_cb(p_cbw->lun, p_cbw->command, _mscd_epbuf[0].buf, (uint16_t) p_msc->total_len);
 
           if ( cb_result < 0 ) {
             // unsupported command
@@ -614,19 +1189,7 @@ bool mscd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t event, uint32_t
         // Invoke complete callback if defined
         // Note: There is racing issue with samd51 + qspi flash testing with arduino
         // if complete_cb() is invoked after queuing the status.
-        switch (p_cbw->command[0]) {
-          case SCSI_CMD_READ_10:
-            tud_msc_read10_complete_cb(p_cbw->lun);
-            break;
-
-          case SCSI_CMD_WRITE_10:
-            tud_msc_write10_complete_cb(p_cbw->lun);
-            break;
-
-          default:
-            tud_msc_scsi_complete_cb(p_cbw->lun, p_cbw->command);
-            break;
-        }
+        invoke_complete_cb(p_cbw);
 
         if (!usbd_edpt_stalled(rhport, p_msc->ep_out)) {
           TU_ASSERT(prepare_cbw(p_msc));
@@ -802,15 +1365,8 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
     }
 
     case SCSI_CMD_REQUEST_SENSE: {
-      scsi_sense_fixed_resp_t sense_rsp = {
-        .response_code = 0x70, // current, fixed format
-        .valid = 1
-      };
-
-      sense_rsp.add_sense_len = sizeof(scsi_sense_fixed_resp_t) - 8;
-      sense_rsp.sense_key = (uint8_t)(p_msc->sense_key & 0x0F);
-      sense_rsp.add_sense_code = p_msc->add_sense_code;
-      sense_rsp.add_sense_qualifier = p_msc->add_sense_qualifier;
+      scsi_sense_fixed_resp_t sense_rsp;
+      fill_sense_fixed(p_msc, &sense_rsp);
 
       resplen = sizeof(sense_rsp);
       TU_VERIFY(0 == tu_memcpy_s(buffer, bufsize, &sense_rsp, (size_t) resplen));
@@ -830,49 +1386,119 @@ static int32_t proc_builtin_scsi(uint8_t lun, uint8_t const scsi_cmd[16], uint8_
   return resplen;
 }
 
+TU_ATTR_ALWAYS_INLINE static inline void rdwr10_start(mscd_interface_t* p_msc) {
+  p_msc->buf_rd    = 0;
+  p_msc->buf_count = 0;
+  p_msc->io_len    = 0;
+  p_msc->io_failed = false;
+}
+
+//------------- READ10 -------------//
+// Storage reads ahead into free buffers while filled ones are sent to host, one callback and one transfer at a time
+
 static void proc_read10_cmd(mscd_interface_t* p_msc) {
+  rdwr10_start(p_msc);
+  proc_read10_pump(p_msc);
+}
+
+// send the oldest filled buffer if endpoint is idle
+static void read10_xmit(mscd_interface_t* p_msc) {
+  const uint8_t rhport = p_msc->rhport;
+  if (p_msc->buf_count > 0 && !usbd_edpt_busy(rhport, p_msc->ep_in)) {
+    const uint8_t idx = p_msc->buf_rd;
+    TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf[idx].buf, p_msc->buf_len[idx], false),);
+  }
+}
+
+static void proc_read10_pump(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw); // already verified non-zero
   TU_VERIFY(block_sz != 0, );
-  // Adjust lba & offset with transferred bytes
-  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
-  uint32_t const offset = p_msc->xferred_len % block_sz;
 
-  // remaining bytes capped at class buffer
-  int32_t nbytes = (int32_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->xferred_len);
+  read10_xmit(p_msc);
 
-  p_msc->pending_io = true;
-  nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, _mscd_epbuf.buf, (uint32_t)nbytes);
-  if (nbytes != TUD_MSC_RET_ASYNC) {
+  while (!p_msc->pending_io && !p_msc->io_failed && p_msc->stage == MSC_STAGE_DATA &&
+         p_msc->buf_count < CFG_TUD_MSC_EP_BUFCOUNT && p_msc->io_len < p_cbw->total_bytes) {
+    // Adjust lba & offset with bytes read so far
+    uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->io_len / block_sz);
+    uint32_t const offset = p_msc->io_len % block_sz;
+    uint8_t const idx = rdwr10_buf_idx(p_msc, p_msc->buf_count);
+
+    // remaining bytes capped at class buffer
+    int32_t nbytes = (int32_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->io_len);
+
+    p_msc->pending_io = true;
+    nbytes = tud_msc_read10_cb(p_cbw->lun, lba, offset, _mscd_epbuf[idx].buf, (uint32_t)nbytes);
+    if (nbytes == TUD_MSC_RET_ASYNC) {
+      break;
+    }
     p_msc->pending_io = false;
-    proc_read_io_data(p_msc, nbytes);
+
+    if (!proc_read_io_data(p_msc, nbytes)) {
+      break;
+    }
   }
 }
 
-static void proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
+// process result of storage read into the next free buffer, return false if no data is read
+static bool proc_read_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
   const uint8_t rhport = p_msc->rhport;
   if (nbytes > 0) {
-    TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_in, _mscd_epbuf.buf, (uint16_t) nbytes, false),);
-  } else {
-    // nbytes is status
-    switch (nbytes) {
-      case TUD_MSC_RET_ERROR:
-        // error -> endpoint is stalled & status in CSW set to failed
-        TU_LOG_DRV("  IO read() failed\r\n");
-        set_sense_medium_not_present(p_msc->cbw.lun);
+    const uint8_t idx = rdwr10_buf_idx(p_msc, p_msc->buf_count);
+    p_msc->buf_len[idx] = (uint16_t) nbytes;
+    p_msc->buf_count++;
+    p_msc->io_len += (uint32_t) nbytes;
+    read10_xmit(p_msc);
+    return true;
+  }
+
+  // nbytes is status
+  switch (nbytes) {
+    case TUD_MSC_RET_ERROR:
+      // error -> endpoint is stalled & status in CSW set to failed
+      TU_LOG_DRV("  IO read() failed\r\n");
+      set_sense_medium_not_present(p_msc->cbw.lun);
+      if (usbd_edpt_busy(rhport, p_msc->ep_in)) {
+        p_msc->io_failed = true; // fail after in-flight data is sent
+      } else {
         fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
-        break;
+      }
+      break;
 
-      case TUD_MSC_RET_BUSY:
-        // not ready yet -> fake a transfer complete so that this driver callback will fire again
-        dcd_event_xfer_complete(rhport, p_msc->ep_in, 0, XFER_RESULT_SUCCESS, false);
-        break;
+    case TUD_MSC_RET_BUSY:
+      // not ready yet -> retry later, or when in-flight transfer is complete
+      if (!usbd_edpt_busy(rhport, p_msc->ep_in)) {
+        usbd_defer_func(proc_rdwr10_retry, NULL, false);
+      }
+      break;
 
-      default: break; // nothing to do
-    }
+    default: break; // nothing to do
+  }
+
+  return false;
+}
+
+// oldest filled buffer is sent to host
+static void proc_read10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  TU_VERIFY(p_msc->buf_count > 0, );
+  p_msc->xferred_len += xferred_bytes;
+  p_msc->buf_rd = rdwr10_buf_idx(p_msc, 1);
+  p_msc->buf_count--;
+
+  if (p_msc->io_failed) {
+    fail_scsi_op(p_msc, MSC_CSW_STATUS_FAILED);
+  } else if (p_msc->xferred_len >= p_msc->total_len) {
+    // Data Stage is complete
+    p_msc->stage = MSC_STAGE_STATUS;
+  } else {
+    proc_read10_pump(p_msc);
   }
 }
 
+//------------- WRITE10 -------------//
+// Host data is received into free buffers while filled ones are written to storage, one callback and one transfer
+// at a time. xferred_len is number of bytes written to storage.
+
 static void proc_write10_cmd(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
   const bool writable = tud_msc_is_writable_cb(p_cbw->lun);
@@ -885,31 +1511,61 @@ static void proc_write10_cmd(mscd_interface_t* p_msc) {
     return;
   }
 
-  // remaining bytes capped at class buffer
-  uint16_t nbytes = (uint16_t)tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_cbw->total_bytes - p_msc->xferred_len);
-  // Write10 callback will be called later when usb transfer complete
-  TU_ASSERT(usbd_edpt_xfer(p_msc->rhport, p_msc->ep_out, _mscd_epbuf.buf, nbytes, false),);
+  rdwr10_start(p_msc);
+  proc_write10_pump(p_msc);
 }
 
-// process new data arrived from WRITE10
-static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+// receive host data into the next free buffer if endpoint is idle
+static void write10_recv(mscd_interface_t* p_msc) {
+  const uint8_t rhport = p_msc->rhport;
+  if (p_msc->buf_count < CFG_TUD_MSC_EP_BUFCOUNT && p_msc->io_len < p_msc->cbw.total_bytes &&
+      !usbd_edpt_busy(rhport, p_msc->ep_out)) {
+    const uint8_t idx = rdwr10_buf_idx(p_msc, p_msc->buf_count);
+    // remaining bytes capped at class buffer
+    const uint16_t nbytes = (uint16_t) tu_min32(CFG_TUD_MSC_EP_BUFSIZE, p_msc->cbw.total_bytes - p_msc->io_len);
+    TU_ASSERT(usbd_edpt_xfer(rhport, p_msc->ep_out, _mscd_epbuf[idx].buf, nbytes, false),);
+  }
+}
+
+static void proc_write10_pump(mscd_interface_t* p_msc) {
   msc_cbw_t const* p_cbw = &p_msc->cbw;
   uint16_t const block_sz = rdwr10_get_blocksize(p_cbw); // already verified non-zero
   TU_VERIFY(block_sz != 0, );
 
-  // Adjust lba & offset with transferred bytes
-  uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
-  uint32_t const offset = p_msc->xferred_len % block_sz;
+  write10_recv(p_msc);
+
+  while (!p_msc->pending_io && p_msc->stage == MSC_STAGE_DATA && p_msc->buf_count > 0) {
+    // Adjust lba & offset with bytes written so far
+    uint32_t const lba = rdwr10_get_lba(p_cbw->command) + (p_msc->xferred_len / block_sz);
+    uint32_t const offset = p_msc->xferred_len % block_sz;
+    uint8_t const idx = p_msc->buf_rd;
 
-  p_msc->pending_io = true;
-  int32_t nbytes =  tud_msc_write10_cb(p_cbw->lun, lba, offset, _mscd_epbuf.buf, xferred_bytes);
-  if (nbytes != TUD_MSC_RET_ASYNC) {
+    p_msc->pending_io = true;
+    int32_t nbytes = tud_msc_write10_cb(p_cbw->lun, lba, offset, _mscd_epbuf[idx].buf, p_msc->buf_len[idx]);
+    if (nbytes == TUD_MSC_RET_ASYNC) {
+      break;
+    }
     p_msc->pending_io = false;
-    proc_write_io_data(p_msc, xferred_bytes, nbytes);
+
+    if (!proc_write_io_data(p_msc, nbytes)) {
+      break;
+    }
   }
 }
 
-static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes, int32_t nbytes) {
+// process new data arrived from WRITE10
+static void proc_write10_host_data(mscd_interface_t* p_msc, uint32_t xferred_bytes) {
+  TU_VERIFY(p_msc->buf_count < CFG_TUD_MSC_EP_BUFCOUNT, );
+  const uint8_t idx = rdwr10_buf_idx(p_msc, p_msc->buf_count);
+  p_msc->buf_len[idx] = (uint16_t) xferred_bytes;
+  p_msc->buf_count++;
+  p_msc->io_len += xferred_bytes;
+
+  proc_write10_pump(p_msc);
+}
+
+// process result of storage write of the oldest filled buffer, return false if nothing is written
+static bool proc_write_io_data(mscd_interface_t* p_msc, int32_t nbytes) {
   if (nbytes < 0) {
     // nbytes is status
     switch (nbytes) {
@@ -922,29 +1578,43 @@ static void proc_write_io_data(mscd_interface_t* p_msc, uint32_t xferred_bytes,
 
       default: break; // nothing to do
     }
-  } else {
-    if ((uint32_t)nbytes < xferred_bytes) {
-      // Application consume less than what we got including TUD_MSC_RET_BUSY (0)
-      const uint32_t left_over = xferred_bytes - (uint32_t)nbytes;
-      if (nbytes > 0) {
-        memmove(_mscd_epbuf.buf, _mscd_epbuf.buf + nbytes, left_over);
-      }
+    return false;
+  }
 
-      // fake a transfer complete with adjusted parameters --> callback will be invoked with adjusted parameters
-      dcd_event_xfer_complete(p_msc->rhport, p_msc->ep_out, left_over, XFER_RESULT_SUCCESS, false);
-    } else {
-      // Application consume all bytes in our buffer
-      p_msc->xferred_len += xferred_bytes;
+  const uint8_t idx = p_msc->buf_rd;
+  const uint16_t len = p_msc->buf_len[idx];
 
-      if (p_msc->xferred_len >= p_msc->total_len) {
-        // Data Stage is complete
-        p_msc->stage = MSC_STAGE_STATUS;
-      } else {
-        // prepare to receive more data from host
-        proc_write10_cmd(p_msc);
+  if ((uint32_t) nbytes < len) {
+    // Application consume less than what we got including TUD_MSC_RET_BUSY (0)
+    if (nbytes == 0) {
+      // retry later, or when in-flight transfer is complete
+      if (!usbd_edpt_busy(p_msc->rhport, p_msc->ep_out)) {
+        usbd_defer_func(proc_rdwr10_retry, NULL, false);
       }
+      return false;
     }
+
+    // keep left over at buffer start, callback will be invoked again with adjusted parameters
+    const uint16_t left_over = (uint16_t) (len - (uint32_t) nbytes);
+    memmove(_mscd_epbuf[idx].buf, _mscd_epbuf[idx].buf + nbytes, left_over);
+    p_msc->buf_len[idx] = left_over;
+    p_msc->xferred_len += (uint32_t) nbytes;
+    return true;
+  }
+
+  // Application consume all bytes in this buffer
+  p_msc->xferred_len += len;
+  p_msc->buf_rd = rdwr10_buf_idx(p_msc, 1);
+  p_msc->buf_count--;
+
+  if (p_msc->xferred_len >= p_msc->total_len) {
+    // Data Stage is complete
+    p_msc->stage = MSC_STAGE_STATUS;
+  } else {
+    // prepare to receive more data from host
+    write10_recv(p_msc);
   }
+  return true;
 }
 
 #endif
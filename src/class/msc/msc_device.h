@@ -29,6 +29,23 @@
   #error CFG_TUD_MSC_EP_BUFSIZE must be defined, value of a block size should work well, the more the better
 #endif
 
+// Number of CFG_TUD_MSC_EP_BUFSIZE buffers used by READ10/WRITE10 data stage. With 2 or more, storage I/O
+// (read10/write10 callbacks) of the next chunk overlaps with USB transfer of the current one.
+#ifndef CFG_TUD_MSC_EP_BUFCOUNT
+  #define CFG_TUD_MSC_EP_BUFCOUNT 1
+#endif
+
+// Support USB Attached SCSI as alternate setting 1 of the MSC interface (see TUD_MSC_UAS_DESCRIPTOR), BOT remains
+// on alternate 0 as fallback. UAS streams require SuperSpeed and are not supported.
+#ifndef CFG_TUD_MSC_UAS
+  #define CFG_TUD_MSC_UAS 0
+#endif
+
+// Number of tagged UAS commands host can queue in addition to the one being executed
+#ifndef CFG_TUD_MSC_UAS_QUEUE_DEPTH
+  #define CFG_TUD_MSC_UAS_QUEUE_DEPTH 4
+#endif
+
 // Return value of callback functions
 enum {
   TUD_MSC_RET_BUSY = 0,   // Busy, e.g disk I/O is not ready
@@ -37,6 +54,7 @@ enum {
 };
 
 TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFSIZE < UINT16_MAX, "Size is not correct");
+TU_VERIFY_STATIC(CFG_TUD_MSC_EP_BUFCOUNT >= 1 && CFG_TUD_MSC_EP_BUFCOUNT <= 8, "Buffer count is not correct");
 
 //--------------------------------------------------------------------+
 // Application API
@@ -67,6 +85,8 @@ bool tud_msc_async_io_done(int32_t bytes_io, bool in_isr);
     - TUD_MSC_RET_ASYNC
         Data I/O will be done asynchronously in a background task. Application should return immediately.
         tud_msc_async_io_done() must be called once IO/ is done to signal completion.
+  - With CFG_TUD_MSC_EP_BUFCOUNT > 1, read10 is invoked for the next chunk while previous ones are still being sent
+    to host, and write10 is invoked while next chunks are being received. Only one callback is pending at a time.
 */
 int32_t tud_msc_read10_cb (uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize);
 int32_t tud_msc_write10_cb (uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize);
@@ -29,8 +29,23 @@ enum {
   MSC_STAGE_CMD,
   MSC_STAGE_DATA,
   MSC_STAGE_STATUS,
+  MSC_STAGE_CACHE, // read is served from readahead cache, completed in deferred function
 };
 
+// Max length of a single data stage transfer, multiple of all bulk packet sizes
+#define MSCH_DATA_XFER_MAX  0x8000u
+
+// Queued read/write request
+typedef struct {
+  uint8_t* buffer;
+  uint64_t lba;
+  uint32_t block_count;
+  tuh_msc_complete_cb_t complete_cb;
+  uintptr_t complete_arg;
+  uint8_t lun;
+  uint8_t cmd_code; // SCSI_CMD_READ_10/16 or SCSI_CMD_WRITE_10/16
+} msch_request_t;
+
 typedef struct {
   uint8_t itf_num;
   uint8_t ep_in;
@@ -42,24 +57,53 @@ typedef struct {
 
   // SCSI command data
   uint8_t stage;
-  void* buffer;
+  void* buffer;  // NULL for merged read/write, data stage then walks the queued requests
   tuh_msc_complete_cb_t complete_cb;
   uintptr_t complete_arg;
+  uint32_t data_offset; // bytes transferred in data stage
+  uint16_t data_len;    // length of data stage transfer in progress
+
+  // Read/Write request queue, the first q_active requests are merged into the command in progress
+  msch_request_t queue[CFG_TUH_MSC_QUEUE_DEPTH];
+  uint8_t q_rd;
+  uint8_t q_count;
+  uint8_t q_active;
+
+#if CFG_TUH_MSC_READAHEAD_SIZE
+  struct {
+    uint64_t lba;      // first cached block
+    uint64_t next_lba; // block following the last read, to detect sequential access
+    uint32_t count;    // number of cached blocks, 0 if empty
+    uint8_t lun;
+    bool filling;      // command in progress reads into cache
+  } ra;
+#endif
 
   struct {
     uint32_t block_size;
-    uint32_t block_count;
+    uint64_t block_count;
   } capacity[CFG_TUH_MSC_MAXLUN];
 } msch_interface_t;
 
 typedef struct {
   TUH_EPBUF_TYPE_DEF(msc_cbw_t, cbw);
   TUH_EPBUF_TYPE_DEF(msc_csw_t, csw);
+#if CFG_TUH_MSC_READAHEAD_SIZE
+  TUH_EPBUF_DEF(cache, CFG_TUH_MSC_READAHEAD_SIZE);
+#endif
 } msch_epbuf_t;
 
 static msch_interface_t _msch_itf[CFG_TUH_DEVICE_MAX];
 CFG_TUH_MEM_SECTION static msch_epbuf_t _msch_epbuf[CFG_TUH_DEVICE_MAX];
 
+// Mutex for request queue and command stage, read/write can be submitted from other task
+#if OSAL_MUTEX_REQUIRED
+static osal_mutex_def_t _msch_mutexdef;
+static osal_mutex_t _msch_mutex;
+#else
+#define _msch_mutex   NULL
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline msch_interface_t* get_itf(uint8_t daddr) {
   return &_msch_itf[daddr - 1];
 }
@@ -68,6 +112,41 @@ TU_ATTR_ALWAYS_INLINE static inline msch_epbuf_t* get_epbuf(uint8_t daddr) {
   return &_msch_epbuf[daddr - 1];
 }
 
+TU_ATTR_ALWAYS_INLINE static inline uint8_t get_daddr(const msch_interface_t* p_msc) {
+  return (uint8_t) (p_msc - _msch_itf + 1);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline msch_request_t* queue_at(msch_interface_t* p_msc, uint8_t idx) {
+  return &p_msc->queue[(p_msc->q_rd + idx) % CFG_TUH_MSC_QUEUE_DEPTH];
+}
+
+// Remove n requests from queue head
+TU_ATTR_ALWAYS_INLINE static inline void queue_pop(msch_interface_t* p_msc, uint8_t n) {
+  p_msc->q_rd = (uint8_t) ((p_msc->q_rd + n) % CFG_TUH_MSC_QUEUE_DEPTH);
+  p_msc->q_count = (uint8_t) (p_msc->q_count - n);
+  p_msc->q_active = 0;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool cmd_is_read(uint8_t cmd_code) {
+  return cmd_code == SCSI_CMD_READ_10 || cmd_code == SCSI_CMD_READ_16;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline bool cmd_is_16(uint8_t cmd_code) {
+  return cmd_code == SCSI_CMD_READ_16 || cmd_code == SCSI_CMD_WRITE_16;
+}
+
+// Convert 64-bit between host and big-endian (symmetric)
+TU_ATTR_ALWAYS_INLINE static inline uint64_t scsi_htonll(uint64_t u64) {
+#if TU_BYTE_ORDER == TU_LITTLE_ENDIAN
+  return ((uint64_t) tu_htonl((uint32_t) u64) << 32) | tu_htonl((uint32_t) (u64 >> 32));
+#else
+  return u64;
+#endif
+}
+
+static void queue_dispatch(uint8_t daddr);
+static void queue_complete(uint8_t daddr);
+
 //--------------------------------------------------------------------+
 // Weak stubs: invoked if no strong implementation is available
 //--------------------------------------------------------------------+
@@ -88,6 +167,12 @@ uint8_t tuh_msc_get_maxlun(uint8_t dev_addr) {
 }
 
 uint32_t tuh_msc_get_block_count(uint8_t dev_addr, uint8_t lun) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  const uint64_t block_count = p_msc->capacity[lun].block_count;
+  return (block_count > UINT32_MAX) ? UINT32_MAX : (uint32_t) block_count;
+}
+
+uint64_t tuh_msc_get_block_count64(uint8_t dev_addr, uint8_t lun) {
   msch_interface_t* p_msc = get_itf(dev_addr);
   return p_msc->capacity[lun].block_count;
 }
@@ -107,7 +192,7 @@ bool tuh_msc_ready(uint8_t dev_addr) {
   TU_VERIFY(p_msc->mounted);
   const bool epin_busy = usbh_edpt_busy(dev_addr, p_msc->ep_in);
   const bool epout_busy = usbh_edpt_busy(dev_addr, p_msc->ep_out);
-  return !epin_busy && !epout_busy;
+  return !epin_busy && !epout_busy && p_msc->stage == MSC_STAGE_IDLE && p_msc->q_count == 0;
 }
 
 //--------------------------------------------------------------------+
@@ -120,23 +205,59 @@ static inline void cbw_init(msc_cbw_t* cbw, uint8_t lun) {
   cbw->lun       = lun;
 }
 
+// Build READ/WRITE 10/16 command
+static void cbw_rw_init(msc_cbw_t* cbw, uint8_t lun, uint8_t cmd_code, uint64_t lba, uint32_t block_count,
+                        uint32_t block_size) {
+  cbw_init(cbw, lun);
+
+  cbw->total_bytes = block_count * block_size;
+  cbw->dir         = cmd_is_read(cmd_code) ? TUSB_DIR_IN_MASK : TUSB_DIR_OUT;
+
+  if (cmd_is_16(cmd_code)) {
+    cbw->cmd_len = sizeof(scsi_read16_t);
+    scsi_read16_t const cmd_rw16 = {
+        .cmd_code    = cmd_code,
+        .lba         = scsi_htonll(lba),
+        .block_count = tu_htonl(block_count)
+    };
+    memcpy(cbw->command, &cmd_rw16, cbw->cmd_len); //-V1086
+  } else {
+    cbw->cmd_len = sizeof(scsi_read10_t);
+    scsi_read10_t const cmd_rw10 = {
+        .cmd_code    = cmd_code,
+        .lba         = tu_htonl((uint32_t) lba),
+        .block_count = tu_htons((uint16_t) block_count)
+    };
+    memcpy(cbw->command, &cmd_rw10, cbw->cmd_len); //-V1086
+  }
+}
+
 bool tuh_msc_scsi_command(uint8_t daddr, msc_cbw_t const* cbw, void* data,
                           tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
   msch_interface_t* p_msc = get_itf(daddr);
   TU_VERIFY(p_msc->configured);
-
-  // claim endpoint
-  TU_VERIFY(usbh_edpt_claim(daddr, p_msc->ep_out));
   msch_epbuf_t* epbuf = get_epbuf(daddr);
 
-  epbuf->cbw = *cbw;
-  p_msc->buffer = data;
-  p_msc->complete_cb = complete_cb;
-  p_msc->complete_arg = arg;
-  p_msc->stage = MSC_STAGE_CMD;
+  // claim endpoint, only one command can be in progress: queued read/write is dispatched once it is complete
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  const bool claimed = (p_msc->stage == MSC_STAGE_IDLE) && usbh_edpt_claim(daddr, p_msc->ep_out);
+  if (claimed) {
+    epbuf->cbw = *cbw;
+    p_msc->buffer = data;
+    p_msc->complete_cb = complete_cb;
+    p_msc->complete_arg = arg;
+    p_msc->stage = MSC_STAGE_CMD;
+    #if CFG_TUH_MSC_READAHEAD_SIZE
+    p_msc->ra.count = 0; // command may change medium content
+    #endif
+  }
+  (void) osal_mutex_unlock(_msch_mutex);
+  TU_VERIFY(claimed);
 
   if (!usbh_edpt_xfer(daddr, p_msc->ep_out, (uint8_t*) &epbuf->cbw, sizeof(msc_cbw_t))) {
     (void) usbh_edpt_release(daddr, p_msc->ep_out);
+    p_msc->stage = MSC_STAGE_IDLE;
+    queue_dispatch(daddr); // read/write queued while endpoint was claimed
     return false;
   }
 
@@ -214,48 +335,272 @@ bool tuh_msc_request_sense(uint8_t dev_addr, uint8_t lun, void* response,
   return tuh_msc_scsi_command(dev_addr, &cbw, response, complete_cb, arg);
 }
 
+// Add a read/write request to queue and start it if device is idle
+static bool rw_submit(uint8_t daddr, uint8_t lun, uint8_t cmd_code, void* buffer, uint64_t lba, uint32_t block_count,
+                      tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  TU_VERIFY(p_msc->mounted && lun < CFG_TUH_MSC_MAXLUN);
+
+  // data length must fit CBW transfer length
+  const uint32_t block_size = p_msc->capacity[lun].block_size;
+  TU_VERIFY(block_size > 0 && (uint64_t) block_count * block_size <= UINT32_MAX);
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  const bool queued = p_msc->q_count < CFG_TUH_MSC_QUEUE_DEPTH;
+  if (queued) {
+    msch_request_t* req = queue_at(p_msc, p_msc->q_count);
+    req->buffer       = (uint8_t*) buffer;
+    req->lba          = lba;
+    req->block_count  = block_count;
+    req->complete_cb  = complete_cb;
+    req->complete_arg = arg;
+    req->lun          = lun;
+    req->cmd_code     = cmd_code;
+    p_msc->q_count++;
+  }
+  (void) osal_mutex_unlock(_msch_mutex);
+  TU_VERIFY(queued);
+
+  queue_dispatch(daddr);
+  return true;
+}
+
 bool tuh_msc_read10(uint8_t dev_addr, uint8_t lun, void* buffer, uint32_t lba, uint16_t block_count,
                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
-  msch_interface_t* p_msc = get_itf(dev_addr);
-  TU_VERIFY(p_msc->mounted);
+  return rw_submit(dev_addr, lun, SCSI_CMD_READ_10, buffer, lba, block_count, complete_cb, arg);
+}
+
+bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, void const* buffer, uint32_t lba, uint16_t block_count,
+                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  return rw_submit(dev_addr, lun, SCSI_CMD_WRITE_10, (void*) (uintptr_t) buffer, lba, block_count, complete_cb, arg);
+}
 
+bool tuh_msc_read16(uint8_t dev_addr, uint8_t lun, void* buffer, uint64_t lba, uint32_t block_count,
+                    tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  return rw_submit(dev_addr, lun, SCSI_CMD_READ_16, buffer, lba, block_count, complete_cb, arg);
+}
+
+bool tuh_msc_write16(uint8_t dev_addr, uint8_t lun, void const* buffer, uint64_t lba, uint32_t block_count,
+                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
+  return rw_submit(dev_addr, lun, SCSI_CMD_WRITE_16, (void*) (uintptr_t) buffer, lba, block_count, complete_cb, arg);
+}
+
+static bool read_capacity16(uint8_t dev_addr, uint8_t lun, scsi_read_capacity16_resp_t* response,
+                            tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
   msc_cbw_t cbw;
   cbw_init(&cbw, lun);
 
-  cbw.total_bytes = block_count * p_msc->capacity[lun].block_size;
-  cbw.dir = TUSB_DIR_IN_MASK;
-  cbw.cmd_len = sizeof(scsi_read10_t);
+  cbw.total_bytes = sizeof(scsi_read_capacity16_resp_t);
+  cbw.dir         = TUSB_DIR_IN_MASK;
+  cbw.cmd_len     = sizeof(scsi_read_capacity16_t);
 
-  scsi_read10_t const cmd_read10 = {
-      .cmd_code    = SCSI_CMD_READ_10,
-      .lba         = tu_htonl(lba),
-      .block_count = tu_htons(block_count)
+  scsi_read_capacity16_t const cmd_read_capacity16 = {
+      .cmd_code       = SCSI_CMD_SERVICE_ACTION_IN_16,
+      .service_action = SCSI_SERVICE_ACTION_READ_CAPACITY_16,
+      .alloc_length   = tu_htonl(sizeof(scsi_read_capacity16_resp_t))
   };
-  memcpy(cbw.command, &cmd_read10, cbw.cmd_len); //-V1086
+  memcpy(cbw.command, &cmd_read_capacity16, cbw.cmd_len); //-V1086
 
-  return tuh_msc_scsi_command(dev_addr, &cbw, buffer, complete_cb, arg);
+  return tuh_msc_scsi_command(dev_addr, &cbw, response, complete_cb, arg);
 }
 
-bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, void const* buffer, uint32_t lba, uint16_t block_count,
-                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg) {
-  msch_interface_t* p_msc = get_itf(dev_addr);
-  TU_VERIFY(p_msc->mounted);
+//--------------------------------------------------------------------+
+// Read/Write Queue
+//--------------------------------------------------------------------+
+
+// Invoke complete callback of a request with its own command and status
+static void request_complete(uint8_t daddr, const msch_request_t* req, uint32_t block_size, uint8_t status,
+                             uint32_t xferred_bytes) {
+  if (req->complete_cb == NULL) {
+    return;
+  }
 
   msc_cbw_t cbw;
-  cbw_init(&cbw, lun);
+  cbw_rw_init(&cbw, req->lun, req->cmd_code, req->lba, req->block_count, block_size);
 
-  cbw.total_bytes = block_count * p_msc->capacity[lun].block_size;
-  cbw.dir         = TUSB_DIR_OUT;
-  cbw.cmd_len     = sizeof(scsi_write10_t);
+  const msc_csw_t csw = {
+      .signature    = MSC_CSW_SIGNATURE,
+      .tag          = cbw.tag,
+      .data_residue = cbw.total_bytes - xferred_bytes,
+      .status       = status
+  };
 
-  scsi_write10_t const cmd_write10 = {
-      .cmd_code    = SCSI_CMD_WRITE_10,
-      .lba         = tu_htonl(lba),
-      .block_count = tu_htons(block_count)
+  const tuh_msc_complete_data_t cb_data = {
+      .cbw = &cbw,
+      .csw = &csw,
+      .scsi_data = req->buffer,
+      .user_arg = req->complete_arg
   };
-  memcpy(cbw.command, &cmd_write10, cbw.cmd_len); //-V1086
+  (void) req->complete_cb(daddr, &cb_data);
+}
 
-  return tuh_msc_scsi_command(dev_addr, &cbw, (void*) (uintptr_t) buffer, complete_cb, arg);
+#if CFG_TUH_MSC_READAHEAD_SIZE
+TU_ATTR_ALWAYS_INLINE static inline bool cache_hit(const msch_interface_t* p_msc, const msch_request_t* req) {
+  return p_msc->ra.count > 0 && req->lun == p_msc->ra.lun && req->lba >= p_msc->ra.lba &&
+         req->lba + req->block_count <= p_msc->ra.lba + p_msc->ra.count;
+}
+
+// Complete a read served from readahead cache, deferred to usbh task since callback must not run in caller context
+static void cache_read_complete(void* param) {
+  msch_interface_t* p_msc = (msch_interface_t*) param;
+  const uint8_t daddr = get_daddr(p_msc);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  if (p_msc->stage != MSC_STAGE_CACHE) {
+    // device is closed
+    (void) osal_mutex_unlock(_msch_mutex);
+    return;
+  }
+
+  const msch_request_t req = *queue_at(p_msc, 0);
+  const uint32_t block_size = p_msc->capacity[req.lun].block_size;
+  const uint32_t xferred_bytes = req.block_count * block_size;
+  memcpy(req.buffer, epbuf->cache + (uint32_t) (req.lba - p_msc->ra.lba) * block_size, xferred_bytes);
+
+  p_msc->ra.next_lba = req.lba + req.block_count;
+  queue_pop(p_msc, 1);
+  p_msc->stage = MSC_STAGE_IDLE;
+  (void) osal_mutex_unlock(_msch_mutex);
+
+  request_complete(daddr, &req, block_size, MSC_CSW_STATUS_PASSED, xferred_bytes);
+  queue_dispatch(daddr);
+}
+#endif
+
+// Start queued requests if no command is in progress. Requests following the head with the same
+// command to adjacent LBA are merged into one SCSI command, their buffers are transferred back-to-back
+// in the data stage.
+static void queue_dispatch(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  if (!p_msc->mounted || p_msc->stage != MSC_STAGE_IDLE || p_msc->q_count == 0) {
+    (void) osal_mutex_unlock(_msch_mutex);
+    return;
+  }
+
+  const msch_request_t* head = queue_at(p_msc, 0);
+  const uint32_t block_size = p_msc->capacity[head->lun].block_size;
+
+  #if CFG_TUH_MSC_READAHEAD_SIZE
+  if (cmd_is_read(head->cmd_code) && cache_hit(p_msc, head)) {
+    p_msc->stage = MSC_STAGE_CACHE;
+    p_msc->q_active = 1;
+    (void) osal_mutex_unlock(_msch_mutex);
+    usbh_defer_func(cache_read_complete, p_msc, false);
+    return;
+  }
+  #endif
+
+  if (!usbh_edpt_claim(daddr, p_msc->ep_out)) {
+    (void) osal_mutex_unlock(_msch_mutex);
+    return;
+  }
+
+  const uint32_t max_blocks = cmd_is_16(head->cmd_code) ? (UINT32_MAX / block_size) : UINT16_MAX;
+  uint32_t block_count = head->block_count;
+  uint8_t count = 1;
+  while (count < p_msc->q_count) {
+    const msch_request_t* req = queue_at(p_msc, count);
+    if (req->lun != head->lun || req->cmd_code != head->cmd_code || req->lba != head->lba + block_count ||
+        req->block_count > max_blocks - block_count) {
+      break;
+    }
+    block_count += req->block_count;
+    count++;
+  }
+
+  p_msc->buffer = NULL;
+
+  #if CFG_TUH_MSC_READAHEAD_SIZE
+  const uint64_t end_lba = head->lba + block_count;
+  p_msc->ra.filling = false;
+  if (cmd_is_read(head->cmd_code)) {
+    // sequential read smaller than cache: read a full cache instead
+    if (count == 1 && head->lun == p_msc->ra.lun && head->lba == p_msc->ra.next_lba) {
+      uint64_t fill_count = tu_min32(CFG_TUH_MSC_READAHEAD_SIZE / block_size, max_blocks);
+      const uint64_t remaining = p_msc->capacity[head->lun].block_count - head->lba;
+      if (fill_count > remaining) {
+        fill_count = remaining;
+      }
+      if (fill_count > block_count) {
+        block_count = (uint32_t) fill_count;
+        p_msc->buffer = epbuf->cache;
+        p_msc->ra.filling = true;
+        p_msc->ra.count = 0;
+      }
+    }
+    p_msc->ra.lun = head->lun;
+    p_msc->ra.next_lba = end_lba;
+  } else if (head->lun == p_msc->ra.lun && head->lba < p_msc->ra.lba + p_msc->ra.count && p_msc->ra.lba < end_lba) {
+    p_msc->ra.count = 0; // written blocks are cached
+  }
+  #endif
+
+  cbw_rw_init(&epbuf->cbw, head->lun, head->cmd_code, head->lba, block_count, block_size);
+  p_msc->complete_cb = NULL;
+  p_msc->q_active = count;
+  p_msc->stage = MSC_STAGE_CMD;
+  (void) osal_mutex_unlock(_msch_mutex);
+
+  if (!usbh_edpt_xfer(daddr, p_msc->ep_out, (uint8_t*) &epbuf->cbw, sizeof(msc_cbw_t))) {
+    // fail merged requests
+    epbuf->csw.status = MSC_CSW_STATUS_FAILED;
+    epbuf->csw.data_residue = epbuf->cbw.total_bytes;
+    p_msc->data_offset = 0;
+    queue_complete(daddr);
+  }
+}
+
+// Merged command is complete, invoke callback of each request with its share of transferred data
+static void queue_complete(uint8_t daddr) {
+  msch_interface_t* p_msc = get_itf(daddr);
+  msch_epbuf_t* epbuf = get_epbuf(daddr);
+  const uint8_t status = epbuf->csw.status;
+  msch_request_t done[CFG_TUH_MSC_QUEUE_DEPTH];
+
+  // data actually transferred by device
+  const uint32_t total_bytes = epbuf->cbw.total_bytes;
+  uint32_t xferred_bytes = total_bytes - tu_min32(epbuf->csw.data_residue, total_bytes);
+  xferred_bytes = tu_min32(xferred_bytes, p_msc->data_offset);
+
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  const uint8_t count = p_msc->q_active;
+  for (uint8_t i = 0; i < count; i++) {
+    done[i] = *queue_at(p_msc, i);
+  }
+
+  #if CFG_TUH_MSC_READAHEAD_SIZE
+  if (p_msc->ra.filling) {
+    const uint32_t block_size = p_msc->capacity[done[0].lun].block_size;
+    p_msc->ra.filling = false;
+    if (status == MSC_CSW_STATUS_PASSED && xferred_bytes == total_bytes) {
+      p_msc->ra.lba = done[0].lba;
+      p_msc->ra.count = total_bytes / block_size;
+    }
+    xferred_bytes = tu_min32(xferred_bytes, done[0].block_count * block_size);
+    memcpy(done[0].buffer, epbuf->cache, xferred_bytes);
+  }
+  #endif
+
+  queue_pop(p_msc, count);
+  p_msc->stage = MSC_STAGE_IDLE;
+  (void) osal_mutex_unlock(_msch_mutex);
+
+  uint32_t offset = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    const msch_request_t* req = &done[i];
+    const uint32_t block_size = p_msc->capacity[req->lun].block_size;
+    const uint32_t req_bytes = req->block_count * block_size;
+    const uint32_t req_xferred = (xferred_bytes > offset) ? tu_min32(xferred_bytes - offset, req_bytes) : 0;
+    offset += req_bytes;
+
+    request_complete(daddr, req, block_size, status, req_xferred);
+  }
+
+  queue_dispatch(daddr);
 }
 
 #if 0
@@ -283,10 +628,21 @@ bool msch_init(void) {
   TU_LOG_DRV("sizeof(msch_interface_t) = %u\r\n", sizeof(msch_interface_t));
   TU_LOG_DRV("sizeof(msch_epbuf_t) = %u\r\n", sizeof(msch_epbuf_t));
   tu_memclr(_msch_itf, sizeof(_msch_itf));
+
+  #if OSAL_MUTEX_REQUIRED
+  _msch_mutex = osal_mutex_create(&_msch_mutexdef);
+  TU_ASSERT(_msch_mutex);
+  #endif
+
   return true;
 }
 
 bool msch_deinit(void) {
+  #if OSAL_MUTEX_REQUIRED
+  osal_mutex_delete(_msch_mutex);
+  _msch_mutex = NULL;
+  #endif
+
   return true;
 }
 
@@ -297,14 +653,50 @@ void msch_close(uint8_t dev_addr) {
 
   TU_LOG_DRV("  MSCh close addr = %d\r\n", dev_addr);
 
+  (void) osal_mutex_lock(_msch_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
+  const bool mounted = p_msc->mounted;
+  p_msc->mounted = false;
+  (void) osal_mutex_unlock(_msch_mutex);
+
+  // fail pending read/write requests, no more can be queued since device is not mounted
+  for (uint8_t i = 0; i < p_msc->q_count; i++) {
+    const msch_request_t* req = queue_at(p_msc, i);
+    request_complete(dev_addr, req, p_msc->capacity[req->lun].block_size, MSC_CSW_STATUS_FAILED, 0);
+  }
+
   // invoke Application Callback
-  if (p_msc->mounted) {
+  if (mounted) {
     tuh_msc_umount_cb(dev_addr);
   }
 
   tu_memclr(p_msc, sizeof(msch_interface_t));
 }
 
+// Submit next data stage transfer at current offset, limited to a single request buffer
+static bool data_stage_xfer(uint8_t daddr, msch_interface_t* p_msc, const msc_cbw_t* cbw) {
+  uint32_t offset = p_msc->data_offset;
+  uint32_t len = cbw->total_bytes - offset;
+  uint8_t* buf = (uint8_t*) p_msc->buffer + offset;
+
+  if (p_msc->buffer == NULL) {
+    // merged requests: locate the one containing offset
+    for (uint8_t i = 0; i < p_msc->q_active; i++) {
+      const msch_request_t* req = queue_at(p_msc, i);
+      const uint32_t req_bytes = req->block_count * p_msc->capacity[req->lun].block_size;
+      if (offset < req_bytes) {
+        buf = req->buffer + offset;
+        len = req_bytes - offset;
+        break;
+      }
+      offset -= req_bytes;
+    }
+  }
+
+  p_msc->data_len = (uint16_t) tu_min32(len, MSCH_DATA_XFER_MAX);
+  uint8_t const ep_data = (cbw->dir & TUSB_DIR_IN_MASK) ? p_msc->ep_in : p_msc->ep_out;
+  return usbh_edpt_xfer(daddr, ep_data, buf, p_msc->data_len);
+}
+
 bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32_t xferred_bytes) {
   msch_interface_t* p_msc = get_itf(dev_addr);
   msch_epbuf_t* epbuf = get_epbuf(dev_addr);
@@ -315,16 +707,26 @@ bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32
     case MSC_STAGE_CMD:
       // Must be Command Block
       TU_ASSERT(ep_addr == p_msc->ep_out && event == XFER_RESULT_SUCCESS && xferred_bytes == sizeof(msc_cbw_t));
-      if (cbw->total_bytes && p_msc->buffer) {
+      p_msc->data_offset = 0;
+      if (cbw->total_bytes && (p_msc->buffer != NULL || p_msc->q_active > 0)) {
         // Data stage if any
         p_msc->stage = MSC_STAGE_DATA;
-        uint8_t const ep_data = (cbw->dir & TUSB_DIR_IN_MASK) ? p_msc->ep_in : p_msc->ep_out;
-        TU_ASSERT(usbh_edpt_xfer(dev_addr, ep_data, p_msc->buffer, (uint16_t) cbw->total_bytes));
+        TU_ASSERT(data_stage_xfer(dev_addr, p_msc, cbw));
         break;
       }
       TU_ATTR_FALLTHROUGH; // fallthrough to data stage
 
     case MSC_STAGE_DATA:
+      if (p_msc->stage == MSC_STAGE_DATA) {
+        p_msc->data_offset += xferred_bytes;
+        // continue unless device ends data stage early with short packet or error
+        if (event == XFER_RESULT_SUCCESS && xferred_bytes == p_msc->data_len &&
+            p_msc->data_offset < cbw->total_bytes) {
+          TU_ASSERT(data_stage_xfer(dev_addr, p_msc, cbw));
+          break;
+        }
+      }
+
       // Status stage
       p_msc->stage = MSC_STAGE_STATUS;
       TU_ASSERT(usbh_edpt_xfer(dev_addr, p_msc->ep_in, (uint8_t*) csw, (uint16_t) sizeof(msc_csw_t)));
@@ -332,6 +734,11 @@ bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32
 
     case MSC_STAGE_STATUS:
       // SCSI op is complete
+      if (p_msc->q_active > 0) {
+        queue_complete(dev_addr);
+        break;
+      }
+
       p_msc->stage = MSC_STAGE_IDLE;
       if (p_msc->complete_cb != NULL) {
         tuh_msc_complete_data_t const cb_data = {
@@ -342,6 +749,9 @@ bool msch_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t event, uint32
         };
         (void) p_msc->complete_cb(dev_addr, &cb_data);
       }
+
+      // read/write queued while this command is in progress
+      queue_dispatch(dev_addr);
       break;
 
     default:
@@ -359,6 +769,8 @@ static void config_get_maxlun_complete(tuh_xfer_t* xfer);
 static bool config_test_unit_ready_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
 static bool config_request_sense_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
 static bool config_read_capacity_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
+static bool config_read_capacity16_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data);
+static void config_mount(uint8_t dev_addr);
 
 uint16_t msch_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len) {
   (void) rhport;
@@ -409,7 +821,7 @@ bool msch_set_config(uint8_t daddr, uint8_t itf_num) {
       .wLength  = 1
   };
 
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  uint8_t* enum_buf = usbh_get_enum_buf(daddr);
   tuh_xfer_t xfer = {
       .daddr       = daddr,
       .ep_addr     = 0,
@@ -429,7 +841,7 @@ static void config_get_maxlun_complete(tuh_xfer_t* xfer) {
 
   // MAXLUN's response is minus 1 by specs, STALL means 1
   if (XFER_RESULT_SUCCESS == xfer->result) {
-    uint8_t* enum_buf = usbh_get_enum_buf();
+    uint8_t* enum_buf = usbh_get_enum_buf(daddr);
     p_msc->max_lun = enum_buf[0] + 1;
   } else {
     p_msc->max_lun = 1;
@@ -446,7 +858,7 @@ static void config_get_maxlun_complete(tuh_xfer_t* xfer) {
 static bool config_test_unit_ready_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
   msc_cbw_t const* cbw = cb_data->cbw;
   msc_csw_t const* csw = cb_data->csw;
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
 
   if (csw->status == 0) {
     // Unit is ready, read its capacity
@@ -478,21 +890,51 @@ static bool config_read_capacity_complete(uint8_t dev_addr, tuh_msc_complete_dat
   msc_csw_t const* csw = cb_data->csw;
   TU_ASSERT(csw->status == 0);
   msch_interface_t* p_msc = get_itf(dev_addr);
-  uint8_t* enum_buf = usbh_get_enum_buf();
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
 
   // Capacity response field: Block size and Last LBA are both Big-Endian
   scsi_read_capacity10_resp_t* resp = (scsi_read_capacity10_resp_t*) (uintptr_t) enum_buf;
-  p_msc->capacity[cbw->lun].block_count = (uint32_t) (tu_ntohl(resp->last_lba) + 1u);
+  const uint32_t last_lba = tu_ntohl(resp->last_lba);
+
+  if (last_lba == UINT32_MAX) {
+    // Device is too large for Read Capacity 10
+    TU_LOG_DRV("SCSI Read Capacity 16\r\n");
+    TU_ASSERT(read_capacity16(dev_addr, cbw->lun, (scsi_read_capacity16_resp_t*) (uintptr_t) enum_buf,
+                              config_read_capacity16_complete, 0));
+    return true;
+  }
+
+  p_msc->capacity[cbw->lun].block_count = (uint64_t) last_lba + 1u;
   p_msc->capacity[cbw->lun].block_size  = tu_ntohl(resp->block_size);
 
+  config_mount(dev_addr);
+  return true;
+}
+
+static bool config_read_capacity16_complete(uint8_t dev_addr, tuh_msc_complete_data_t const* cb_data) {
+  msc_cbw_t const* cbw = cb_data->cbw;
+  msc_csw_t const* csw = cb_data->csw;
+  TU_ASSERT(csw->status == 0);
+  msch_interface_t* p_msc = get_itf(dev_addr);
+  uint8_t* enum_buf = usbh_get_enum_buf(dev_addr);
+
+  scsi_read_capacity16_resp_t* resp = (scsi_read_capacity16_resp_t*) (uintptr_t) enum_buf;
+  p_msc->capacity[cbw->lun].block_count = scsi_htonll(resp->last_lba) + 1u;
+  p_msc->capacity[cbw->lun].block_size  = tu_ntohl(resp->block_size);
+
+  config_mount(dev_addr);
+  return true;
+}
+
+static void config_mount(uint8_t dev_addr) {
+  msch_interface_t* p_msc = get_itf(dev_addr);
+
   // Mark enumeration is complete
   p_msc->mounted = true;
   tuh_msc_mount_cb(dev_addr);
 
   // notify usbh that driver enumeration is complete
   usbh_driver_set_config_complete(dev_addr, p_msc->itf_num);
-
-  return true;
 }
 
 #endif
@@ -22,6 +22,18 @@ extern "C" {
   #define CFG_TUH_MSC_MAXLUN 4
 #endif
 
+// Number of read/write requests that can be queued per device. Requests submitted while a command is
+// in progress are queued, consecutive requests to adjacent LBAs are merged into a single SCSI command.
+#ifndef CFG_TUH_MSC_QUEUE_DEPTH
+  #define CFG_TUH_MSC_QUEUE_DEPTH 4
+#endif
+
+// Size in bytes of the per-device readahead cache, 0 to disable. A sequential read smaller than the cache
+// fetches a full cache worth of blocks, following reads within the cached range complete without USB traffic.
+#ifndef CFG_TUH_MSC_READAHEAD_SIZE
+  #define CFG_TUH_MSC_READAHEAD_SIZE 0
+#endif
+
 typedef struct {
   const msc_cbw_t *cbw;       // SCSI command
   const msc_csw_t *csw;       // SCSI status
@@ -39,15 +51,18 @@ typedef bool (*tuh_msc_complete_cb_t)(uint8_t dev_addr, const tuh_msc_complete_d
 // This function true after tuh_msc_mounted_cb() and false after tuh_msc_unmounted_cb()
 bool tuh_msc_mounted(uint8_t dev_addr);
 
-// Check if the interface is currently ready or busy transferring data
+// Check if the interface is currently ready or busy transferring data (including queued read/write)
 bool tuh_msc_ready(uint8_t dev_addr);
 
 // Get Max Lun
 uint8_t tuh_msc_get_maxlun(uint8_t dev_addr);
 
-// Get number of block
+// Get number of block, saturated to UINT32_MAX for device larger than 2 TiB (with 512-byte block)
 uint32_t tuh_msc_get_block_count(uint8_t dev_addr, uint8_t lun);
 
+// Get number of block as 64-bit, read with Read Capacity 16 if device does not fit Read Capacity 10
+uint64_t tuh_msc_get_block_count64(uint8_t dev_addr, uint8_t lun);
+
 // Get block size in bytes
 uint32_t tuh_msc_get_block_size(uint8_t dev_addr, uint8_t lun);
 
@@ -75,17 +90,28 @@ bool tuh_msc_request_sense(uint8_t dev_addr, uint8_t lun, void *response, tuh_ms
                            uintptr_t arg);
 
 // Perform SCSI Read 10 command. Read n blocks starting from LBA to buffer
-// Complete callback is invoked when SCSI op is complete.
+// Request is queued if device is busy, adjacent requests may be merged into one SCSI command.
+// Complete callback is invoked once per request when its data is complete.
+// return false if not mounted or queue is full.
 // NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
 bool tuh_msc_read10(uint8_t dev_addr, uint8_t lun, void *buffer, uint32_t lba, uint16_t block_count,
                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
 
 // Perform SCSI Write 10 command. Write n blocks starting from LBA to device
-// Complete callback is invoked when SCSI op is complete.
+// Request is queued if device is busy, adjacent requests may be merged into one SCSI command.
+// Complete callback is invoked once per request when its data is complete.
 // NOTE: buffer must be accessible by USB/DMA controller, aligned correctly and multiple of cache line if enabled
 bool tuh_msc_write10(uint8_t dev_addr, uint8_t lun, const void *buffer, uint32_t lba, uint16_t block_count,
                      tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
 
+// Perform SCSI Read 16 command, same as tuh_msc_read10() with 64-bit LBA for device larger than 2 TiB
+bool tuh_msc_read16(uint8_t dev_addr, uint8_t lun, void *buffer, uint64_t lba, uint32_t block_count,
+                    tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
+// Perform SCSI Write 16 command, same as tuh_msc_write10() with 64-bit LBA for device larger than 2 TiB
+bool tuh_msc_write16(uint8_t dev_addr, uint8_t lun, const void *buffer, uint64_t lba, uint32_t block_count,
+                     tuh_msc_complete_cb_t complete_cb, uintptr_t arg);
+
 // Perform SCSI Read Capacity 10 command
 // Complete callback is invoked when SCSI op is complete.
 // Note: during enumeration, host stack already carried out this request. Application can retrieve capacity by
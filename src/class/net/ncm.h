@@ -59,6 +59,19 @@
   #define CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB 6
 #endif
 
+// Pass all datagrams of a received NTB to tud_network_recv_batch_cb() in one call instead of one datagram per
+// tud_network_recv_cb() / tud_network_recv_renew() round trip
+#ifndef CFG_TUD_NCM_RECV_BATCH
+  #define CFG_TUD_NCM_RECV_BATCH 0
+#endif
+
+// Lend received datagrams to the glue logic instead of requiring a copy: buffers passed to tud_network_recv_cb() or
+// tud_network_recv_batch_cb() stay valid until returned with tud_network_recv_release(). An NTB is reused once all
+// its datagrams are returned, reception pauses while all CFG_TUD_NCM_OUT_NTB_N NTBs are lent.
+#ifndef CFG_TUD_NCM_RECV_LEND
+  #define CFG_TUD_NCM_RECV_LEND 0
+#endif
+
 // Table 6.2 Class-Specific Request Codes for Network Control Model subclass
 typedef enum
 {
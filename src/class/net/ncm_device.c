@@ -77,6 +77,9 @@ typedef struct {
   recv_ntb_t *recv_tinyusb_ntb;                         // buffer for the running transfer TinyUSB -> driver
   recv_ntb_t *recv_glue_ntb;                            // buffer for the running transfer driver -> glue logic
   uint16_t recv_glue_ntb_datagram_ndx;                  // index into \a recv_glue_ntb_datagram
+  #if CFG_TUD_NCM_RECV_LEND
+  uint16_t recv_ntb_ref[RECV_NTB_N];                    // datagrams lent to glue logic (+1 while NTB is the glue NTB)
+  #endif
 
   // xmit handling
   xmit_ntb_t *xmit_free_ntb[XMIT_NTB_N];                // free list of xmit NTBs
@@ -399,8 +402,16 @@ static void xmit_start_if_possible(uint8_t rhport) {
     TU_LOG_DRV(">> %d %d\n", ncm_interface.xmit_tinyusb_ntb->nth.wBlockLength, ncm_interface.xmit_glue_ntb_datagram_ndx);
   }
 
+  // Pad an NTB ending on a packet boundary by one byte so that the host sees a short packet: this saves the
+  // ZLP round trip before the next NTB can be started. Not possible if the NTB already has the maximum size.
+  xmit_ntb_t *ntb = ncm_interface.xmit_tinyusb_ntb;
+  if ((ntb->nth.wBlockLength & (ncm_interface.ep_size - 1)) == 0 && ntb->nth.wBlockLength < ncm_interface.xmit_max_ntb_size) {
+    ntb->data[ntb->nth.wBlockLength] = 0;
+    ntb->nth.wBlockLength++;
+  }
+
   // Kick off an endpoint transfer
-  usbd_edpt_xfer(0, ncm_interface.ep_in, ncm_interface.xmit_tinyusb_ntb->data, ncm_interface.xmit_tinyusb_ntb->nth.wBlockLength, false);
+  usbd_edpt_xfer(0, ncm_interface.ep_in, ntb->data, ntb->nth.wBlockLength, false);
 } // xmit_start_if_possible
 
 /**
@@ -569,6 +580,77 @@ static void recv_try_to_start_new_reception(uint8_t rhport) {
   }
 } // recv_try_to_start_new_reception
 
+/**
+ * NTB becomes the buffer for the running transfer driver -> glue logic
+ */
+static void recv_glue_ntb_acquire(recv_ntb_t *ntb) {
+  ncm_interface.recv_glue_ntb = ntb;
+  ncm_interface.recv_glue_ntb_datagram_ndx = 0;
+  TU_LOG_DRV("  new buffer for glue logic: %p\n", ntb);
+
+  #if CFG_TUD_NCM_RECV_LEND
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    if (ntb == &ncm_epbuf.recv[i].ntb) {
+      ncm_interface.recv_ntb_ref[i] = 1;
+    }
+  }
+  #endif
+} // recv_glue_ntb_acquire
+
+#if CFG_TUD_NCM_RECV_LEND
+/**
+ * Drop a reference of NTB \a ndx, return it to the free list (and restart reception) with the last one.
+ */
+static void recv_ntb_unref(int ndx) {
+  if (ncm_interface.recv_ntb_ref[ndx] == 0) {
+    TU_LOG_DRV("(EE) recv_ntb_unref - NTB %d not referenced\n", ndx);
+    return;
+  }
+  if (--ncm_interface.recv_ntb_ref[ndx] == 0) {
+    recv_put_ntb_into_free_list(&ncm_epbuf.recv[ndx].ntb);
+    recv_try_to_start_new_reception(ncm_interface.rhport);
+  }
+} // recv_ntb_unref
+#endif
+
+/**
+ * Lend (\a lend true) \a count datagrams of the glue NTB before passing them to the glue logic, which may return
+ * them right away. Take back the ones not accepted afterwards (\a lend false).
+ */
+static void recv_glue_ntb_lend(uint16_t count, bool lend) {
+  #if CFG_TUD_NCM_RECV_LEND
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    if (ncm_interface.recv_glue_ntb == &ncm_epbuf.recv[i].ntb) {
+      // reference of the glue NTB itself keeps the count above zero
+      ncm_interface.recv_ntb_ref[i] = lend ? (uint16_t) (ncm_interface.recv_ntb_ref[i] + count)
+                                           : (uint16_t) (ncm_interface.recv_ntb_ref[i] - count);
+    }
+  }
+  #else
+  (void) count;
+  (void) lend;
+  #endif
+} // recv_glue_ntb_lend
+
+/**
+ * All datagrams of the glue NTB are passed to the glue logic. Without lending the NTB is free now, otherwise after
+ * the last lent datagram is returned.
+ */
+static void recv_glue_ntb_done(void) {
+  recv_ntb_t *ntb = ncm_interface.recv_glue_ntb;
+  ncm_interface.recv_glue_ntb = NULL;
+
+  #if CFG_TUD_NCM_RECV_LEND
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    if (ntb == &ncm_epbuf.recv[i].ntb) {
+      recv_ntb_unref(i);
+    }
+  }
+  #else
+  recv_put_ntb_into_free_list(ntb);
+  #endif
+} // recv_glue_ntb_done
+
 /**
  * Validate incoming datagram.
  * \return true if valid
@@ -662,6 +744,52 @@ static bool recv_validate_datagram(const recv_ntb_t *ntb, uint32_t len) {
   return true;
 } // recv_validate_datagram
 
+#if CFG_TUD_NCM_RECV_BATCH
+/**
+ * Transfer all pending datagrams to the glue logic in one call per NTB and return receive buffers which are empty.
+ * Stop if the glue logic does not accept all of them, the rest is passed with the next tud_network_recv_renew().
+ */
+static void recv_transfer_datagram_to_glue_logic(void) {
+  TU_LOG_DRV("recv_transfer_datagram_to_glue_logic()\n");
+
+  for (;;) {
+    if (ncm_interface.recv_glue_ntb == NULL) {
+      recv_ntb_t *ready_ntb = recv_get_next_ready_ntb();
+      if (ready_ntb == NULL) {
+        return;
+      }
+      recv_glue_ntb_acquire(ready_ntb);
+    }
+
+    recv_ntb_t *ntb = ncm_interface.recv_glue_ntb;
+
+    const ndp16_datagram_t *ndp16_datagram = (const ndp16_datagram_t *) (ntb->data + ntb->nth.wNdpIndex + sizeof(ndp16_t))
+                                             + ncm_interface.recv_glue_ntb_datagram_ndx;
+    ncm_datagram_t datagrams[CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB];
+    uint16_t count = 0;
+    while (count < CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB && ndp16_datagram[count].wDatagramIndex != 0 &&
+           ndp16_datagram[count].wDatagramLength != 0) {
+      datagrams[count].buffer = ntb->data + ndp16_datagram[count].wDatagramIndex;
+      datagrams[count].len = ndp16_datagram[count].wDatagramLength;
+      ++count;
+    }
+
+    recv_glue_ntb_lend(count, true);
+    uint16_t const accepted = (count > 0) ? tu_min16(tud_network_recv_batch_cb(datagrams, count), count) : 0;
+    recv_glue_ntb_lend(count - accepted, false);
+    TU_LOG_DRV("  recv[%d] - %d of %d\n", ncm_interface.recv_glue_ntb_datagram_ndx, accepted, count);
+    ncm_interface.recv_glue_ntb_datagram_ndx += accepted;
+    if (accepted < count) {
+      return;
+    }
+
+    if (ndp16_datagram[accepted].wDatagramIndex == 0 || ndp16_datagram[accepted].wDatagramLength == 0) {
+      // end of datagrams reached
+      recv_glue_ntb_done();
+    }
+  }
+} // recv_transfer_datagram_to_glue_logic
+#else
 /**
  * Transfer the next (pending) datagram to the glue logic and return receive buffer if empty.
  */
@@ -669,9 +797,10 @@ static void recv_transfer_datagram_to_glue_logic(void) {
   TU_LOG_DRV("recv_transfer_datagram_to_glue_logic()\n");
 
   if (ncm_interface.recv_glue_ntb == NULL) {
-    ncm_interface.recv_glue_ntb = recv_get_next_ready_ntb();
-    TU_LOG_DRV("  new buffer for glue logic: %p\n", ncm_interface.recv_glue_ntb);
-    ncm_interface.recv_glue_ntb_datagram_ndx = 0;
+    recv_ntb_t *ready_ntb = recv_get_next_ready_ntb();
+    if (ready_ntb != NULL) {
+      recv_glue_ntb_acquire(ready_ntb);
+    }
   }
 
   if (ncm_interface.recv_glue_ntb != NULL) {
@@ -686,6 +815,7 @@ static void recv_transfer_datagram_to_glue_logic(void) {
       uint16_t datagramLength = ndp16_datagram[ncm_interface.recv_glue_ntb_datagram_ndx].wDatagramLength;
 
       TU_LOG_DRV("  recv[%d] - %d %d\n", ncm_interface.recv_glue_ntb_datagram_ndx, datagramIndex, datagramLength);
+      recv_glue_ntb_lend(1, true);
       if (tud_network_recv_cb(ncm_interface.recv_glue_ntb->data + datagramIndex, datagramLength)) {
         // send datagram successfully to glue logic
         TU_LOG_DRV("    OK\n");
@@ -697,13 +827,15 @@ static void recv_transfer_datagram_to_glue_logic(void) {
           ++ncm_interface.recv_glue_ntb_datagram_ndx;
         } else {
           // end of datagrams reached
-          recv_put_ntb_into_free_list(ncm_interface.recv_glue_ntb);
-          ncm_interface.recv_glue_ntb = NULL;
+          recv_glue_ntb_done();
         }
+      } else {
+        recv_glue_ntb_lend(1, false);
       }
     }
   }
 } // recv_transfer_datagram_to_glue_logic
+#endif
 
 //-----------------------------------------------------------------------------
 //
@@ -789,6 +921,24 @@ void tud_network_recv_renew(void) {
   recv_try_to_start_new_reception(ncm_interface.rhport);
 } // tud_network_recv_renew
 
+#if CFG_TUD_NCM_RECV_LEND
+/**
+ * Return a datagram lent to the glue logic, its NTB is reused after all of its datagrams are returned.
+ */
+void tud_network_recv_release(const uint8_t *buffer) {
+  TU_LOG_DRV("tud_network_recv_release(%p)\n", buffer);
+
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    const uint8_t *data = ncm_epbuf.recv[i].ntb.data;
+    if (buffer >= data && buffer < data + CFG_TUD_NCM_OUT_NTB_MAX_SIZE) {
+      recv_ntb_unref(i);
+      return;
+    }
+  }
+  TU_LOG_DRV("(EE) tud_network_recv_release - unknown buffer\n");
+} // tud_network_recv_release
+#endif
+
 /**
  * Same as tud_network_recv_renew() but knows \a rhport
  */
@@ -836,6 +986,17 @@ void tud_network_link_state(uint8_t rhport, bool is_up) {
 void netd_init(void) {
   TU_LOG_DRV("netd_init()\n");
 
+  #if CFG_TUD_NCM_RECV_LEND
+  // datagrams still lent to the glue logic survive a reset, their NTBs are reused only after all of them are returned
+  uint16_t lent[RECV_NTB_N];
+  for (int i = 0; i < RECV_NTB_N; ++i) {
+    lent[i] = ncm_interface.recv_ntb_ref[i];
+    if (lent[i] != 0 && ncm_interface.recv_glue_ntb == &ncm_epbuf.recv[i].ntb) {
+      --lent[i];// reference of the glue NTB itself
+    }
+  }
+  #endif
+
   memset(&ncm_interface, 0, sizeof(ncm_interface));
 
   ncm_interface.xmit_max_ntb_size = CFG_TUD_NCM_IN_NTB_MAX_SIZE;
@@ -845,6 +1006,12 @@ void netd_init(void) {
     ncm_interface.xmit_free_ntb[i] = &ncm_epbuf.xmit[i].ntb;
   }
   for (int i = 0; i < RECV_NTB_N; ++i) {
+    #if CFG_TUD_NCM_RECV_LEND
+    ncm_interface.recv_ntb_ref[i] = lent[i];
+    if (lent[i] != 0) {
+      continue;
+    }
+    #endif
     ncm_interface.recv_free_ntb[i] = &ncm_epbuf.recv[i].ntb;
   }
   ncm_interface.link_is_up = tud_network_default_link_state_cb();
@@ -932,8 +1099,8 @@ bool netd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
   if (ep_addr == ncm_interface.ep_out) {
     // new NTB received
     // - make the NTB valid
+    // - if there is a free receive buffer, initiate reception before the glue logic gets busy
     // - if ready transfer datagrams to the glue logic for further processing
-    // - if there is a free receive buffer, initiate reception
     if (!recv_validate_datagram(ncm_interface.recv_tinyusb_ntb, xferred_bytes)) {
       // verification failed: ignore NTB and return it to free
       TU_LOG_DRV("Invalid datatagram. Ignoring NTB\n");
@@ -943,6 +1110,7 @@ bool netd_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_
       recv_put_ntb_into_ready_list(ncm_interface.recv_tinyusb_ntb);
     }
     ncm_interface.recv_tinyusb_ntb = NULL;
+    recv_try_to_start_new_reception(rhport);
     tud_network_recv_renew_r(rhport);
   } else if (ep_addr == ncm_interface.ep_in) {
     // transmission of an NTB finished
@@ -84,6 +84,17 @@ extern uint8_t tud_network_mac_address[6];
 
 //------------- NCM -------------//
 
+// Datagram of a received NTB, see tud_network_recv_batch_cb()
+typedef struct {
+  const uint8_t *buffer;
+  uint16_t len;
+} ncm_datagram_t;
+
+// client must provide this if CFG_TUD_NCM_RECV_BATCH is enabled (instead of tud_network_recv_cb): pending datagrams
+// of a received NTB are passed at once. Return number of datagrams accepted from the start of the list, the others are
+// passed again on next tud_network_recv_renew(). Buffers are only valid during the callback unless lent.
+uint16_t tud_network_recv_batch_cb(const ncm_datagram_t datagrams[], uint16_t count);
+
 // Optional callback: informs the application about host requested packet filter bits
 void tud_network_set_packet_filter_cb(uint16_t packet_filter);
 
@@ -94,6 +105,11 @@ bool tud_network_default_link_state_cb(void);
 // Set the network link state (up/down) and notify the host
 void tud_network_link_state(uint8_t rhport, bool is_up);
 
+// Return a datagram lent by tud_network_recv_cb() / tud_network_recv_batch_cb() if CFG_TUD_NCM_RECV_LEND is enabled.
+// Must be called from the same context as tud_network_recv_renew(). Lent buffers stay valid across a bus reset, their
+// NTB is reused only after all of its datagrams are returned.
+void tud_network_recv_release(const uint8_t *buffer);
+
 //--------------------------------------------------------------------+
 // INTERNAL USBD-CLASS DRIVER API
 //--------------------------------------------------------------------+
@@ -12,6 +12,8 @@
 #include "common/tusb_common.h"
 
 enum {
+  VIDEO_BCD_1_00 = 0x0100,
+  VIDEO_BCD_1_10 = 0x0110,
   VIDEO_BCD_1_50 = 0x0150,
 };
 
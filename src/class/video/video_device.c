@@ -99,6 +99,9 @@ typedef struct TU_ATTR_PACKED {
   uint8_t *buffer;   /* frame buffer. assume linear buffer. no support for stride access */
   uint32_t bufsize;  /* frame buffer size */
   uint32_t offset;   /* offset for the next payload transfer */
+  tud_video_slice_t const *slices; /* frame slices for zero-copy transfer, NULL if buffer or callback */
+  uint16_t slice_idx;/* slice of the next payload */
+  uint32_t slice_ofs;/* offset within the slice for the next payload */
   uint32_t max_payload_transfer_size;
   uint8_t  error_code;/* error code */
   uint8_t  state;    /* 0:probing 1:committed 2:streaming */
@@ -127,6 +130,7 @@ static videod_interface_t _videod_itf[CFG_TUD_VIDEO];
 
 static videod_streaming_interface_t _videod_streaming_itf[CFG_TUD_VIDEO_STREAMING];
 CFG_TUD_MEM_SECTION static videod_streaming_epbuf_t _videod_streaming_epbuf[CFG_TUD_VIDEO_STREAMING];
+static tu_edpt_seg_t _videod_streaming_segs[CFG_TUD_VIDEO_STREAMING][2]; /* segments of the ongoing payload */
 
 static uint8_t const _cap_get     = 0x1u; /* support for GET */
 static uint8_t const _cap_get_set = 0x3u; /* support for GET and SET */
@@ -208,6 +212,13 @@ TU_ATTR_WEAK void tud_video_prepare_payload_cb(uint_fast8_t ctl_idx, uint_fast8_
   (void) request;
 }
 
+TU_ATTR_WEAK uint32_t tud_video_source_clock_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, uint16_t* sof_count) {
+  (void) ctl_idx;
+  (void) stm_idx;
+  *sof_count = 0;
+  return 0;
+}
+
 //--------------------------------------------------------------------+
 //
 //--------------------------------------------------------------------+
@@ -470,7 +481,7 @@ static bool _update_streaming_parameters(videod_streaming_interface_t const *stm
   param->wPFrameRate      = 0;
   param->wCompWindowSize  = 1; /* GOP size? */
   param->wDelay           = 0; /* milliseconds */
-  param->dwClockFrequency = 27000000; /* same as MPEG-2 system time clock  */
+  param->dwClockFrequency = CFG_TUD_VIDEO_CLOCK_FREQUENCY; /* default same as MPEG-2 system time clock  */
   param->bmFramingInfo    = 0x3; /* enables FrameID and EndOfFrame */
   param->bPreferedVersion = 1;
   param->bMinVersion      = 1;
@@ -541,7 +552,7 @@ static bool _update_streaming_parameters(videod_streaming_interface_t const *stm
   }
   uint_fast32_t interval_ms = interval / 10000;
   TU_ASSERT(interval_ms != 0);
-  uint_fast32_t payload_size = (frame_size + interval_ms - 1) / interval_ms + 2;
+  uint_fast32_t payload_size = (frame_size + interval_ms - 1) / interval_ms + TUD_VIDEO_PAYLOAD_HEADER_LEN;
   if (CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE < payload_size) {
     payload_size = CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE;
   }
@@ -578,7 +589,7 @@ static bool _negotiate_streaming_parameters(videod_streaming_interface_t const *
     param->wCompQuality     = 1; /* 1 to 10000 */
     param->wCompWindowSize  = 1; /* GOP size? */
     param->wDelay           = 0; /* milliseconds */
-    param->dwClockFrequency = 27000000; /* same as MPEG-2 system time clock  */
+    param->dwClockFrequency = CFG_TUD_VIDEO_CLOCK_FREQUENCY; /* default same as MPEG-2 system time clock  */
     param->bmFramingInfo    = 0x3; /* enables FrameID and EndOfFrame */
     param->bPreferedVersion = 1;
     param->bMinVersion      = 1;
@@ -785,6 +796,16 @@ static bool _open_vc_itf(uint8_t rhport, videod_interface_t *self, uint_fast8_t
   return true;
 }
 
+/** Clear transfer management information */
+static void _clear_xfer(videod_streaming_interface_t *stm) {
+  stm->buffer    = NULL;
+  stm->bufsize   = 0;
+  stm->offset    = 0;
+  stm->slices    = NULL;
+  stm->slice_idx = 0;
+  stm->slice_ofs = 0;
+}
+
 static bool _init_vs_configuration(videod_streaming_interface_t *stm) {
   /* initialize streaming settings */
   stm->state = VS_STATE_PROBING;
@@ -820,9 +841,7 @@ static bool _open_vs_itf(uint8_t rhport, videod_streaming_interface_t *stm, uint
 #endif
 
   /* clear transfer management information */
-  stm->buffer  = NULL;
-  stm->bufsize = 0;
-  stm->offset  = 0;
+  _clear_xfer(stm);
 
   /* Find a alternate interface */
   uint8_t const *beg = desc + stm->desc.beg;
@@ -864,33 +883,88 @@ static bool _open_vs_itf(uint8_t rhport, videod_streaming_interface_t *stm, uint
   return true;
 }
 
-/** Prepare the next packet payload. */
-static uint_fast16_t _prepare_in_payload(videod_streaming_interface_t *stm, uint8_t* ep_buf) {
-  uint_fast16_t remaining = stm->bufsize - stm->offset;
-  uint_fast16_t hdr_len   = ep_buf[0];
-  uint_fast16_t pkt_len   = stm->max_payload_transfer_size;
-  if (hdr_len + remaining < pkt_len) {
-    pkt_len = hdr_len + remaining;
-  }
-  TU_ASSERT(pkt_len >= hdr_len);
-  uint_fast16_t data_len = pkt_len - hdr_len;
-  if (stm->buffer) {
-    memcpy(&ep_buf[hdr_len], stm->buffer + stm->offset, data_len);
+/** Prepare the next packet payload.
+ *
+ * The payload is built in the endpoint buffer. For a frame given as slices with CFG_TUD_EDPT_XFER_SG, only the
+ * header and data of the first packet are, the rest of the payload is sent straight from the slice as a second
+ * segment of the transfer.
+ *
+ * @param[out] segs   Transfer segments, segs[1].len is 0 if the payload is entirely in the endpoint buffer
+ * @return payload length */
+static uint_fast16_t _prepare_in_payload(videod_streaming_interface_t *stm, uint8_t* ep_buf, tu_edpt_seg_t* segs) {
+  uint32_t remaining = stm->bufsize - stm->offset;
+  uint8_t  hdr_len   = ep_buf[0];
+  uint32_t pkt_len   = stm->max_payload_transfer_size;
+  TU_ASSERT(pkt_len > hdr_len, 0);
+  uint32_t data_len  = pkt_len - hdr_len;
+  uint32_t head_len; /* data in endpoint buffer */
+
+  if (stm->slices) {
+    /* A payload never spans two slices */
+    tud_video_slice_t const *slice = &stm->slices[stm->slice_idx];
+    while (stm->slice_ofs == slice->len) {
+      stm->slice_idx++;
+      stm->slice_ofs = 0;
+      slice++;
+    }
+    data_len = tu_min32(data_len, slice->len - stm->slice_ofs);
+    uint8_t *data = (uint8_t*) slice->buf + stm->slice_ofs;
+    stm->slice_ofs += data_len;
+#if CFG_TUD_EDPT_XFER_SG
+    /* Segments other than the last must be a multiple of packet size */
+    tusb_desc_endpoint_t const *ep = (tusb_desc_endpoint_t const *) (_videod_itf[stm->index_vc].beg + stm->desc.ep[0]);
+    head_len = tu_min32(data_len, tu_edpt_packet_size(ep) - hdr_len);
+#else
+    head_len = data_len;
+#endif
+    memcpy(&ep_buf[hdr_len], data, head_len);
+    segs[1].buf = data + head_len;
   } else {
-    tud_video_payload_request_t rqst = {
-      .buf = &ep_buf[hdr_len],
-      .length = data_len,
-      .offset = stm->offset
-    };
-    tud_video_prepare_payload_cb(stm->index_vc, stm->index_vs, &rqst);
+    data_len = tu_min32(data_len, remaining);
+    head_len = data_len;
+    if (stm->buffer) {
+      memcpy(&ep_buf[hdr_len], stm->buffer + stm->offset, data_len);
+    } else {
+      tud_video_payload_request_t rqst = {
+        .buf = &ep_buf[hdr_len],
+        .length = data_len,
+        .offset = stm->offset
+      };
+      tud_video_prepare_payload_cb(stm->index_vc, stm->index_vs, &rqst);
+    }
   }
+  segs[0].buf = ep_buf;
+  segs[0].len = (uint16_t) (hdr_len + head_len);
+  segs[1].len = (uint16_t) (data_len - head_len);
+
   stm->offset += data_len;
   remaining -= data_len;
   if (!remaining) {
     tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*) ep_buf;
     hdr->EndOfFrame = 1;
   }
-  return hdr_len + data_len;
+#if CFG_TUD_VIDEO_PAYLOAD_PTS_SCR
+  /* scrSourceClock: source time clock and 11-bit SOF counter */
+  uint16_t sof_count = 0;
+  uint32_t const stc = tud_video_source_clock_cb(stm->index_vc, stm->index_vs, &sof_count);
+  tu_unaligned_write32(ep_buf + 6, tu_htole32(stc));
+  tu_unaligned_write16(ep_buf + 10, tu_htole16(sof_count & 0x7FFu));
+#endif
+  return (uint_fast16_t) (hdr_len + data_len);
+}
+
+/** Prepare and submit the next payload of the frame */
+static bool _send_payload(uint8_t rhport, uint8_t ep_addr, videod_streaming_interface_t *stm) {
+  uint_fast8_t const idx = (uint_fast8_t) (stm - _videod_streaming_itf);
+  tu_edpt_seg_t *segs = _videod_streaming_segs[idx];
+  uint_fast16_t const pkt_len = _prepare_in_payload(stm, _videod_streaming_epbuf[idx].buf, segs);
+  TU_VERIFY(pkt_len);
+#if CFG_TUD_EDPT_XFER_SG
+  if (segs[1].len) {
+    return usbd_edpt_xfer_sg(rhport, ep_addr, segs, 2, false);
+  }
+#endif
+  return usbd_edpt_xfer(rhport, ep_addr, segs[0].buf, (uint16_t) pkt_len, false);
 }
 
 /** Handle a standard request to the video control interface. */
@@ -1148,13 +1222,15 @@ static int handle_video_stm_cs_req(uint8_t rhport, uint8_t stage,
             int ret = tud_video_commit_cb(stm->index_vc, stm->index_vs, param);
             if (VIDEO_ERROR_NONE == ret) {
               stm->state   = VS_STATE_COMMITTED;
-              stm->buffer  = NULL;
-              stm->bufsize = 0;
-              stm->offset  = 0;
+              _clear_xfer(stm);
               /* initialize payload header */
               tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*)stm_epbuf->buf;
-              hdr->bHeaderLength = sizeof(*hdr);
+              hdr->bHeaderLength = TUD_VIDEO_PAYLOAD_HEADER_LEN;
               hdr->bmHeaderInfo  = 0;
+#if CFG_TUD_VIDEO_PAYLOAD_PTS_SCR
+              hdr->PresentationTime     = 1;
+              hdr->SourceClockReference = 1;
+#endif
             }
           } else {
             // nothing to do
@@ -1260,52 +1336,89 @@ bool tud_video_n_streaming(uint_fast8_t ctl_idx, uint_fast8_t stm_idx)
   return true;
 }
 
-bool tud_video_n_frame_xfer(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, void *buffer, size_t bufsize) {
-  TU_ASSERT(ctl_idx < CFG_TUD_VIDEO);
-  TU_ASSERT(stm_idx < CFG_TUD_VIDEO_STREAMING);
-
-  if (0 == bufsize) {
-    return false;
-  }
+/** Get the streaming instance ready for a new frame transfer
+ *
+ * @return instance, NULL if not streaming or a frame transfer is ongoing */
+static videod_streaming_interface_t* _frame_xfer_instance(uint_fast8_t ctl_idx, uint_fast8_t stm_idx) {
+  TU_ASSERT(ctl_idx < CFG_TUD_VIDEO, NULL);
+  TU_ASSERT(stm_idx < CFG_TUD_VIDEO_STREAMING, NULL);
 
   videod_streaming_interface_t *stm = _get_instance_streaming(ctl_idx, stm_idx);
-  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[ctl_idx];
-
   if (NULL == stm || 0 == stm->desc.ep[0] || stm->bufsize) {
-    return false;
+    return NULL;
   }
   if (stm->state == VS_STATE_PROBING) {
-    return false;
+    return NULL;
   }
+  return stm;
+}
 
-  /* Find EP address */
+/** Send the first payload of the frame set up in the streaming instance */
+static bool _frame_xfer_start(videod_streaming_interface_t *stm, uint32_t pts) {
   uint8_t const *desc = _videod_itf[stm->index_vc].beg;
-  uint8_t ep_addr = 0;
-  for (uint_fast8_t i = 0; i < CFG_TUD_VIDEO_STREAMING; ++i) {
-    uint_fast16_t ofs_ep = stm->desc.ep[i];
-    if (0 == ofs_ep) {
-      continue;
-    }
-    ep_addr = _desc_ep_addr(desc + ofs_ep);
-    break;
-  }
-  if (0 == ep_addr) {
+  uint8_t const ep_addr = _desc_ep_addr(desc + stm->desc.ep[0]);
+  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[stm - _videod_streaming_itf];
+
+  if (!usbd_edpt_claim(0, ep_addr)) {
+    _clear_xfer(stm);
     return false;
   }
-
-  TU_VERIFY(usbd_edpt_claim(0, ep_addr));
   /* update the packet header */
   tusb_video_payload_header_t *hdr = (tusb_video_payload_header_t*)stm_epbuf->buf;
   hdr->FrameID   ^= 1;
   hdr->EndOfFrame = 0;
+#if CFG_TUD_VIDEO_PAYLOAD_PTS_SCR
+  tu_unaligned_write32(stm_epbuf->buf + 2, tu_htole32(pts));
+#else
+  (void) pts;
+#endif
   /* update the packet data */
-  stm->buffer     = (uint8_t*)buffer;
-  stm->bufsize    = bufsize;
-  uint_fast16_t pkt_len = _prepare_in_payload(stm, stm_epbuf->buf);
-  TU_ASSERT( usbd_edpt_xfer(0, ep_addr, stm_epbuf->buf, (uint16_t) pkt_len, false), 0);
+  TU_ASSERT(_send_payload(0, ep_addr, stm));
   return true;
 }
 
+bool tud_video_n_frame_xfer(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, void *buffer, size_t bufsize) {
+  if (0 == bufsize) {
+    return false;
+  }
+  videod_streaming_interface_t *stm = _frame_xfer_instance(ctl_idx, stm_idx);
+  if (NULL == stm) {
+    return false;
+  }
+
+  stm->buffer  = (uint8_t*)buffer;
+  stm->bufsize = (uint32_t) bufsize;
+
+  uint32_t pts = 0;
+#if CFG_TUD_VIDEO_PAYLOAD_PTS_SCR
+  /* Frame is complete when submitted */
+  uint16_t sof_count;
+  pts = tud_video_source_clock_cb(ctl_idx, stm_idx, &sof_count);
+#endif
+  return _frame_xfer_start(stm, pts);
+}
+
+bool tud_video_n_frame_xfer_slices(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_slice_t const *slices,
+                                   uint_fast16_t count, uint32_t pts) {
+  TU_VERIFY(slices && count && count <= UINT16_MAX);
+
+  uint32_t total = 0;
+  for (uint_fast16_t i = 0; i < count; ++i) {
+    total += slices[i].len;
+  }
+  if (0 == total) {
+    return false;
+  }
+  videod_streaming_interface_t *stm = _frame_xfer_instance(ctl_idx, stm_idx);
+  if (NULL == stm) {
+    return false;
+  }
+
+  stm->slices  = slices;
+  stm->bufsize = total;
+  return _frame_xfer_start(stm, pts);
+}
+
 //--------------------------------------------------------------------+
 // USBD Driver API
 //--------------------------------------------------------------------+
@@ -1489,17 +1602,13 @@ bool videod_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint3
     }
   }
   TU_ASSERT(itf < CFG_TUD_VIDEO_STREAMING);
-  videod_streaming_epbuf_t *stm_epbuf = &_videod_streaming_epbuf[itf];
 
   if (stm->offset < stm->bufsize) {
     /* Claim the endpoint */
     TU_VERIFY(usbd_edpt_claim(rhport, ep_addr), 0);
-    uint_fast16_t pkt_len = _prepare_in_payload(stm, stm_epbuf->buf);
-    TU_ASSERT(usbd_edpt_xfer(rhport, ep_addr, stm_epbuf->buf, (uint16_t) pkt_len, false), 0);
+    TU_ASSERT(_send_payload(rhport, ep_addr, stm), 0);
   } else {
-    stm->buffer  = NULL;
-    stm->bufsize = 0;
-    stm->offset  = 0;
+    _clear_xfer(stm);
     tud_video_frame_xfer_complete_cb(stm->index_vc, stm->index_vs);
   }
   return true;
@@ -16,6 +16,23 @@
 extern "C" {
 #endif
 
+//--------------------------------------------------------------------+
+// Class Driver Configuration
+//--------------------------------------------------------------------+
+
+// Add PTS and SCR to every payload header, the source clock is read with tud_video_source_clock_cb()
+#ifndef CFG_TUD_VIDEO_PAYLOAD_PTS_SCR
+  #define CFG_TUD_VIDEO_PAYLOAD_PTS_SCR   0
+#endif
+
+// Source clock frequency (dwClockFrequency) in Hz, unit of PTS and SCR
+#ifndef CFG_TUD_VIDEO_CLOCK_FREQUENCY
+  #define CFG_TUD_VIDEO_CLOCK_FREQUENCY   27000000
+#endif
+
+// Payload header length: bHeaderLength, bmHeaderInfo [, dwPresentationTime, scrSourceClock]
+#define TUD_VIDEO_PAYLOAD_HEADER_LEN      (CFG_TUD_VIDEO_PAYLOAD_PTS_SCR ? 12 : 2)
+
 
 //--------------------------------------------------------------------+
 // Payload request
@@ -26,6 +43,14 @@ typedef struct TU_ATTR_PACKED {
     size_t offset;  /* Offset within the frame (in bytes) */
 } tud_video_payload_request_t;
 
+//--------------------------------------------------------------------+
+// Frame slice (zero-copy frame transfer)
+//--------------------------------------------------------------------+
+typedef struct {
+    void* buf;      /* Slice data */
+    uint32_t len;   /* Length of the slice in bytes */
+} tud_video_slice_t;
+
 //--------------------------------------------------------------------+
 // Application API (Multiple Ports)
 // CFG_TUD_VIDEO > 1
@@ -47,6 +72,21 @@ bool tud_video_n_streaming(uint_fast8_t ctl_idx, uint_fast8_t stm_idx);
  * @param[in] bufsize    Byte size of the frame buffer */
 bool tud_video_n_frame_xfer(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, void *buffer, size_t bufsize);
 
+/** Transfer a frame given as a list of slices (e.g. lines or encoder output chunks) without copying
+ *
+ * With CFG_TUD_EDPT_XFER_SG, each payload is sent as two segments: the payload header with the data of the first
+ * packet from the endpoint buffer, then the rest straight from the slice. Otherwise slice data is copied to the
+ * endpoint buffer. A payload never spans two slices. If the DCD requires aligned buffers, slice data past the first
+ * packet of each payload (wMaxPacketSize - TUD_VIDEO_PAYLOAD_HEADER_LEN) must be aligned.
+ *
+ * @param[in] ctl_idx    Destination control interface index
+ * @param[in] stm_idx    Destination streaming interface index
+ * @param[in] slices     Array of slices. The caller must not use the array and slices until the operation is completed.
+ * @param[in] count      Number of slices
+ * @param[in] pts        Presentation time stamp in CFG_TUD_VIDEO_CLOCK_FREQUENCY units (CFG_TUD_VIDEO_PAYLOAD_PTS_SCR) */
+bool tud_video_n_frame_xfer_slices(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_slice_t const *slices,
+                                   uint_fast16_t count, uint32_t pts);
+
 /*------------- Optional callbacks -------------*/
 /** Invoked when compeletion of a frame transfer
  *
@@ -83,6 +123,15 @@ int tud_video_commit_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx,
  * @param[in]   offset        Current byte offset relative to given bufsize from tud_video_n_frame_xfer (framesize)  */
 void tud_video_prepare_payload_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, tud_video_payload_request_t* request);
 
+/** Invoked for every payload to sample the source clock for SCR (CFG_TUD_VIDEO_PAYLOAD_PTS_SCR), and for PTS of
+ * frames submitted by tud_video_n_frame_xfer()
+ *
+ * @param[in]   ctl_idx       Destination control interface index
+ * @param[in]   stm_idx       Destination streaming interface index
+ * @param[out]  sof_count     USB (micro)frame number (11 bits) at which the clock was sampled
+ * @return source clock in CFG_TUD_VIDEO_CLOCK_FREQUENCY units */
+uint32_t tud_video_source_clock_cb(uint_fast8_t ctl_idx, uint_fast8_t stm_idx, uint16_t* sof_count);
+
 //--------------------------------------------------------------------+
 // INTERNAL USBD-CLASS DRIVER API
 //--------------------------------------------------------------------+
@@ -0,0 +1,964 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb_option.h"
+
+#if (CFG_TUH_ENABLED && CFG_TUH_VIDEO)
+
+#include "host/usbh.h"
+#include "host/usbh_pvt.h"
+#include "video_host.h"
+
+#define TU_LOG_DRV(...)   TU_LOG(CFG_TUH_VIDEO_LOG_LEVEL, __VA_ARGS__)
+
+// Bulk payloads are received in place: the header lands on the tail of frame data received so far, which is saved
+// before and restored after the payload data is in place. With DCache, invalidating the partial cache lines of such
+// transfers would drop data written by CPU, payloads are then received into the staging buffer and copied.
+#define VIDEOH_BULK_IN_PLACE  (CFG_TUH_MEM_DCACHE_ENABLE == 0)
+
+// Bytes saved under the header of an in place bulk payload, covers header with PTS and SCR
+#define VIDEOH_HEADER_MAX     12
+
+// Staging buffer for bulk payloads without room in a frame buffer (dropped or overflowing frames)
+#define VIDEOH_BULK_STAGE_SZ  (4 * TUH_EPSIZE_BULK_MAX)
+
+// Frame ID before any payload or after End of Frame: next payload starts a new frame
+#define VIDEOH_FID_NONE       0xFFu
+
+//--------------------------------------------------------------------+
+// Weak stubs for application callbacks
+//--------------------------------------------------------------------+
+
+TU_ATTR_WEAK void tuh_video_mount_cb(uint8_t idx) {
+  (void) idx;
+}
+
+TU_ATTR_WEAK void tuh_video_umount_cb(uint8_t idx) {
+  (void) idx;
+}
+
+TU_ATTR_WEAK void tuh_video_stream_start_cb(uint8_t idx, bool success) {
+  (void) idx; (void) success;
+}
+
+TU_ATTR_WEAK void tuh_video_frame_cb(uint8_t idx) {
+  (void) idx;
+}
+
+//--------------------------------------------------------------------+
+// Internal structure and state
+//--------------------------------------------------------------------+
+
+// Isochronous alternate setting of the streaming interface
+typedef struct {
+  uint8_t  alt;
+  uint16_t ep_size; // max bytes per service interval
+  tusb_desc_endpoint_t ep;
+} videoh_alt_t;
+
+enum {
+  VIDEOH_BUF_FREE = 0, // owned by application
+  VIDEOH_BUF_QUEUED,   // waiting to be filled or being filled
+  VIDEOH_BUF_DONE,     // frame received, waiting for tuh_video_frame_get()
+};
+
+typedef struct {
+  tuh_video_frame_t frame;
+  volatile uint8_t state;
+} videoh_buf_t;
+
+enum {
+  VIDEOH_STREAM_IDLE = 0,
+  VIDEOH_STREAM_PROBE_SET,
+  VIDEOH_STREAM_PROBE_GET,
+  VIDEOH_STREAM_COMMIT,
+  VIDEOH_STREAM_SET_ITF,
+  VIDEOH_STREAM_STREAMING,
+  VIDEOH_STREAM_STOPPING,
+};
+
+typedef struct {
+  uint8_t  daddr;
+  uint8_t  itf_vc;   // Video Control interface
+  uint8_t  itf_vs;   // first Video Streaming interface, others are bound but not used
+  uint8_t  itf_last; // last Video Streaming interface of the function
+  bool     mounted;
+  uint16_t bcd_uvc;
+
+  uint8_t info_count;
+  tuh_video_frame_info_t info[CFG_TUH_VIDEO_FRAME_INFO_MAX];
+
+  tusb_desc_endpoint_t ep_bulk; // bulk endpoint of alternate 0, bLength = 0 for isochronous streaming
+  uint8_t alt_count;
+  videoh_alt_t alt[CFG_TUH_VIDEO_ALT_MAX];
+
+  // streaming
+  uint8_t  state;
+  uint8_t  info_idx;
+  uint8_t  alt_idx;
+  uint8_t  ep_addr;
+  uint16_t ep_size;     // bulk max packet size or isochronous bytes per service interval
+  uint32_t max_payload; // dwMaxPayloadTransferSize
+  video_probe_and_commit_control_t commit;
+
+  // frame reassembly into buf[buf_fill]
+  uint8_t  fid;    // Frame ID of frame being received
+  bool     active; // frame being received has a buffer, otherwise payloads are dropped until next frame
+  bool     notify; // frame published, invoke tuh_video_frame_cb()
+  uint32_t start;  // offset of frame data in buffer
+  uint32_t wr;     // write offset in buffer
+
+  // bulk payload spans transfers until a short packet or dwMaxPayloadTransferSize
+  uint32_t payload_left; // 0 if next transfer starts a payload
+  bool     payload_eof;
+  uint8_t  hdr_len;      // header length of last payload
+  uint8_t  saved_len;
+  uint8_t  saved[VIDEOH_HEADER_MAX];
+  uint8_t* rx_buf;
+  uint32_t rx_len;
+
+  // buffer ring, slots are queued, filled and got in order
+  uint8_t buf_queue;
+  uint8_t buf_fill;
+  uint8_t buf_get;
+  videoh_buf_t buf[CFG_TUH_VIDEO_FRAME_BUF_COUNT];
+
+#if CFG_TUH_ISO_EP_MAX
+  tuh_iso_xfer_t  xfer[2];
+  tu_iso_packet_t packets[2][CFG_TUH_VIDEO_ISO_PACKETS];
+#endif
+} videoh_interface_t;
+
+static videoh_interface_t _videoh_itf[CFG_TUH_VIDEO];
+
+typedef struct {
+  union {
+  #if CFG_TUH_ISO_EP_MAX
+    struct {
+      TUH_EPBUF_DEF(buf, CFG_TUH_VIDEO_ISO_PACKETS * CFG_TUH_VIDEO_EP_SZ);
+    } iso[2];
+  #endif
+    TUH_EPBUF_DEF(bulk, VIDEOH_BULK_STAGE_SZ);
+  };
+  TUH_EPBUF_TYPE_DEF(video_probe_and_commit_control_t, ctrl);
+} videoh_epbuf_t;
+
+CFG_TUH_MEM_SECTION static videoh_epbuf_t _videoh_epbuf[CFG_TUH_VIDEO];
+
+//--------------------------------------------------------------------+
+// Helper functions
+//--------------------------------------------------------------------+
+
+static inline uint8_t find_new_index(void) {
+  for (uint8_t idx = 0; idx < CFG_TUH_VIDEO; idx++) {
+    if (_videoh_itf[idx].daddr == 0) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+static inline videoh_interface_t* get_itf(uint8_t idx) {
+  TU_VERIFY(idx < CFG_TUH_VIDEO && _videoh_itf[idx].mounted, NULL);
+  return &_videoh_itf[idx];
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t buf_next(uint8_t i) {
+  return (uint8_t) ((i + 1u) % CFG_TUH_VIDEO_FRAME_BUF_COUNT);
+}
+
+// Probe and commit control is 26 bytes in UVC 1.0, 34 in 1.1 and 48 in 1.5
+static uint16_t probe_len(const videoh_interface_t* p_video) {
+  if (p_video->bcd_uvc >= VIDEO_BCD_1_50) {
+    return 48;
+  }
+  return (p_video->bcd_uvc >= VIDEO_BCD_1_10) ? 34 : 26;
+}
+
+//--------------------------------------------------------------------+
+// Frame reassembly
+//--------------------------------------------------------------------+
+
+// Start a frame into the next queued buffer, frame is dropped if there is none
+static void frame_start(videoh_interface_t* p_video) {
+  videoh_buf_t* buf = &p_video->buf[p_video->buf_fill];
+  p_video->active = (buf->state == VIDEOH_BUF_QUEUED);
+  if (p_video->active) {
+    tuh_video_frame_t* frame = &buf->frame;
+    frame->data    = frame->buffer;
+    frame->length  = 0;
+    frame->pts     = 0;
+    frame->has_pts = false;
+    frame->eof     = false;
+    frame->status  = 0;
+    p_video->start = 0;
+    p_video->wr    = 0;
+  }
+}
+
+// Stop filling the current frame. Return its buffer to be published, NULL if frame is empty (buffer is reused)
+static videoh_buf_t* frame_detach(videoh_interface_t* p_video) {
+  TU_VERIFY(p_video->active, NULL);
+  p_video->active = false;
+  TU_VERIFY(p_video->wr > p_video->start, NULL);
+
+  videoh_buf_t* buf = &p_video->buf[p_video->buf_fill];
+  buf->frame.data   = buf->frame.buffer + p_video->start;
+  buf->frame.length = p_video->wr - p_video->start;
+  p_video->buf_fill = buf_next(p_video->buf_fill);
+  return buf;
+}
+
+static void frame_publish(videoh_interface_t* p_video, videoh_buf_t* buf) {
+  TU_LOG_DRV("  Video frame %lu bytes, status %02X\r\n", (unsigned long) buf->frame.length, buf->frame.status);
+  buf->state = VIDEOH_BUF_DONE;
+  p_video->notify = true;
+}
+
+static void frame_error(videoh_interface_t* p_video, uint8_t status) {
+  if (p_video->active) {
+    p_video->buf[p_video->buf_fill].frame.status |= status;
+  }
+}
+
+// Append payload data to the current frame. Data already at the write position is not copied, data received in
+// place into an empty frame makes the frame start there.
+static void frame_append(videoh_interface_t* p_video, const uint8_t* data, uint32_t len) {
+  tuh_video_frame_t* frame = &p_video->buf[p_video->buf_fill].frame;
+  if (p_video->wr == p_video->start && data >= frame->buffer && data < frame->buffer + frame->size) {
+    p_video->start = (uint32_t) (data - frame->buffer);
+    p_video->wr    = p_video->start;
+  }
+
+  uint32_t const room = frame->size - p_video->wr;
+  if (len > room) {
+    frame->status |= TUH_VIDEO_FRAME_ERROR_OVERFLOW;
+    len = room;
+  }
+
+  uint8_t* dst = frame->buffer + p_video->wr;
+  if (dst != data && len > 0) {
+    memmove(dst, data, len);
+  }
+  p_video->wr += len;
+}
+
+// Put back frame data under the header of an in place bulk payload
+static void saved_restore(videoh_interface_t* p_video) {
+  if (p_video->saved_len > 0) {
+    memcpy(p_video->rx_buf, p_video->saved, p_video->saved_len);
+    p_video->saved_len = 0;
+  }
+}
+
+// Process a payload: a Frame ID toggle ends the current frame and starts a new one, then data is appended. The ended
+// frame is published only after its saved bytes are restored. Return End of Frame bit of the header
+static bool payload_process(videoh_interface_t* p_video, const uint8_t* payload, uint32_t len) {
+  if (len == 0) {
+    saved_restore(p_video);
+    return false;
+  }
+
+  uint8_t const hdr_len = payload[0];
+  if (len < 2 || hdr_len < 2 || hdr_len > len) {
+    saved_restore(p_video);
+    frame_error(p_video, TUH_VIDEO_FRAME_ERROR_HEADER);
+    return false;
+  }
+
+  // header may be overwritten when data is moved in place
+  tusb_video_payload_header_t const hdr = *(const tusb_video_payload_header_t*) payload;
+  bool const has_pts = hdr.PresentationTime && hdr_len >= 6;
+  uint32_t const pts = has_pts ? tu_le32toh(tu_unaligned_read32(payload + 2)) : 0;
+  p_video->hdr_len = hdr_len;
+
+  videoh_buf_t* ended = NULL;
+  if (hdr.FrameID != p_video->fid) {
+    ended = frame_detach(p_video);
+    p_video->fid = hdr.FrameID;
+    frame_start(p_video);
+  }
+
+  if (p_video->active) {
+    tuh_video_frame_t* frame = &p_video->buf[p_video->buf_fill].frame;
+    if (hdr.Error) {
+      frame->status |= TUH_VIDEO_FRAME_ERROR_PAYLOAD;
+    }
+    if (has_pts && !frame->has_pts) {
+      frame->pts     = pts;
+      frame->has_pts = true;
+    }
+    frame_append(p_video, payload + hdr_len, len - hdr_len);
+  }
+
+  saved_restore(p_video);
+  if (ended != NULL) {
+    frame_publish(p_video, ended);
+  }
+
+  return hdr.EndOfFrame;
+}
+
+// End of a payload: frame is complete with End of Frame bit, or when an uncompressed frame reaches its size which lets
+// the next frame start in a fresh buffer instead of waiting for the Frame ID toggle
+static void payload_end(videoh_interface_t* p_video, bool eof) {
+  bool full = false;
+  if (p_video->active && p_video->info[p_video->info_idx].format == VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED) {
+    uint32_t const frame_size = tu_le32toh(p_video->commit.dwMaxVideoFrameSize);
+    full = (frame_size > 0) && (p_video->wr - p_video->start >= frame_size);
+  }
+
+  if (eof || full) {
+    videoh_buf_t* buf = frame_detach(p_video);
+    if (buf != NULL) {
+      buf->frame.eof = eof;
+      frame_publish(p_video, buf);
+    }
+  }
+
+  // after End of Frame any Frame ID starts a new frame, a full frame keeps dropping until Frame ID toggles
+  if (eof) {
+    p_video->fid = VIDEOH_FID_NONE;
+  }
+}
+
+static void frame_notify(uint8_t idx) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+  if (p_video->notify) {
+    p_video->notify = false;
+    tuh_video_frame_cb(idx);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Streaming
+//--------------------------------------------------------------------+
+
+// Receive next bulk transfer, in place into the frame buffer if possible
+static bool bulk_submit(uint8_t idx) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+  uint32_t const max_len = (p_video->payload_left != 0) ? p_video->payload_left : p_video->max_payload;
+  uint8_t* rx_buf = NULL;
+  uint32_t space = 0;
+
+#if VIDEOH_BULK_IN_PLACE
+  tuh_video_frame_t* frame = &p_video->buf[p_video->buf_fill].frame;
+  if (p_video->active) {
+    uint32_t offset = p_video->wr;
+    if (p_video->payload_left == 0) {
+      uint8_t const back = (uint8_t) tu_min32(tu_min32(p_video->hdr_len, VIDEOH_HEADER_MAX), p_video->wr);
+      offset -= back;
+      memcpy(p_video->saved, frame->buffer + offset, back);
+      p_video->saved_len = back;
+    }
+    rx_buf = frame->buffer + offset;
+    space  = frame->size - offset;
+  } else if (p_video->payload_left == 0 && p_video->buf[p_video->buf_fill].state == VIDEOH_BUF_QUEUED) {
+    // payload may start the next frame
+    rx_buf = frame->buffer;
+    space  = frame->size;
+  }
+#endif
+
+  // a payload cut short of its end must end on a packet boundary
+  uint32_t len = tu_min32(tu_min32(max_len, space), UINT16_MAX);
+  if (len < max_len) {
+    len -= len % p_video->ep_size;
+  }
+
+  if (len == 0) {
+    saved_restore(p_video);
+    rx_buf = _videoh_epbuf[idx].bulk;
+    len = tu_min32(max_len, VIDEOH_BULK_STAGE_SZ);
+    if (len < max_len) {
+      len -= len % p_video->ep_size;
+    }
+  }
+
+  p_video->rx_buf = rx_buf;
+  p_video->rx_len = len;
+  return usbh_edpt_xfer(p_video->daddr, p_video->ep_addr, rx_buf, (uint16_t) len);
+}
+
+static void bulk_complete(uint8_t idx, xfer_result_t result, uint32_t xferred_bytes) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+
+  if (result != XFER_RESULT_SUCCESS) {
+    saved_restore(p_video);
+    frame_error(p_video, TUH_VIDEO_FRAME_ERROR_XFER);
+    p_video->payload_left = 0;
+  } else {
+    bool const payload_start = (p_video->payload_left == 0);
+    uint32_t const max_len = payload_start ? p_video->max_payload : p_video->payload_left;
+
+    if (payload_start) {
+      p_video->payload_eof = payload_process(p_video, p_video->rx_buf, xferred_bytes);
+    } else if (p_video->active) {
+      frame_append(p_video, p_video->rx_buf, xferred_bytes);
+    }
+
+    bool const payload_done = (xferred_bytes < p_video->rx_len) || (xferred_bytes >= max_len);
+    p_video->payload_left = payload_done ? 0 : max_len - xferred_bytes;
+    if (payload_done) {
+      payload_end(p_video, p_video->payload_eof);
+    }
+  }
+
+  if (result == XFER_RESULT_STALLED) {
+    TU_LOG_DRV("  Video streaming endpoint stalled\r\n");
+  } else {
+    TU_ASSERT(bulk_submit(idx),);
+  }
+
+  frame_notify(idx);
+}
+
+#if CFG_TUH_ISO_EP_MAX
+static bool iso_submit(tuh_iso_xfer_t* xfer, uint16_t ep_size) {
+  for (uint16_t i = 0; i < CFG_TUH_VIDEO_ISO_PACKETS; i++) {
+    xfer->packets[i].length = ep_size;
+  }
+  xfer->packet_count = CFG_TUH_VIDEO_ISO_PACKETS;
+  return tuh_iso_xfer(xfer);
+}
+
+// Each packet is a payload with its own header, packets are at offset of requested length
+static void iso_complete(tuh_iso_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) xfer->user_data;
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+  TU_VERIFY(p_video->state == VIDEOH_STREAM_STREAMING,);
+
+  uint32_t offset = 0;
+  for (uint16_t i = 0; i < xfer->packet_count; i++) {
+    tu_iso_packet_t const* pkt = &xfer->packets[i];
+    if (pkt->result != XFER_RESULT_SUCCESS) {
+      frame_error(p_video, TUH_VIDEO_FRAME_ERROR_XFER);
+    } else if (pkt->actual_len > 0) {
+      bool const eof = payload_process(p_video, xfer->buffer + offset, pkt->actual_len);
+      payload_end(p_video, eof);
+    }
+    offset += pkt->length;
+  }
+
+  TU_ASSERT(iso_submit(xfer, p_video->ep_size),);
+  frame_notify(idx);
+}
+
+// Smallest alternate fitting the negotiated payload, otherwise the largest one within CFG_TUH_VIDEO_EP_SZ
+static uint8_t iso_alt_select(const videoh_interface_t* p_video) {
+  uint8_t best = TUSB_INDEX_INVALID_8;
+  for (uint8_t i = 0; i < p_video->alt_count; i++) {
+    uint16_t const ep_size = p_video->alt[i].ep_size;
+    if (ep_size > CFG_TUH_VIDEO_EP_SZ) {
+      continue;
+    }
+    if (best == TUSB_INDEX_INVALID_8) {
+      best = i;
+    } else {
+      uint16_t const best_size = p_video->alt[best].ep_size;
+      bool const better = (best_size < p_video->max_payload) ? (ep_size > best_size)
+                                                             : (ep_size >= p_video->max_payload && ep_size < best_size);
+      if (better) {
+        best = i;
+      }
+    }
+  }
+  return best;
+}
+#endif
+
+// Open streaming endpoint and start receiving
+static bool stream_open(uint8_t idx) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+
+  p_video->fid          = VIDEOH_FID_NONE;
+  p_video->active       = false;
+  p_video->notify       = false;
+  p_video->payload_left = 0;
+  p_video->hdr_len      = 0;
+  p_video->saved_len    = 0;
+
+  if (p_video->ep_bulk.bLength != 0) {
+    TU_ASSERT(tuh_edpt_open(p_video->daddr, &p_video->ep_bulk));
+    p_video->ep_addr = p_video->ep_bulk.bEndpointAddress;
+    p_video->ep_size = tu_edpt_packet_size(&p_video->ep_bulk);
+    p_video->state   = VIDEOH_STREAM_STREAMING;
+    TU_ASSERT(bulk_submit(idx));
+    return true;
+  }
+
+#if CFG_TUH_ISO_EP_MAX
+  const videoh_alt_t* alt = &p_video->alt[p_video->alt_idx];
+  TU_ASSERT(tuh_edpt_open(p_video->daddr, &alt->ep));
+  p_video->ep_addr = alt->ep.bEndpointAddress;
+  p_video->ep_size = alt->ep_size;
+
+  for (uint8_t i = 0; i < 2; i++) {
+    tuh_iso_xfer_t* xfer = &p_video->xfer[i];
+    xfer->daddr       = p_video->daddr;
+    xfer->ep_addr     = p_video->ep_addr;
+    xfer->buffer      = _videoh_epbuf[idx].iso[i].buf;
+    xfer->packets     = p_video->packets[i];
+    xfer->complete_cb = iso_complete;
+    xfer->user_data   = idx;
+  }
+
+  // state is set before submitting since completion can be reported right away
+  p_video->state = VIDEOH_STREAM_STREAMING;
+  for (uint8_t i = 0; i < 2; i++) {
+    TU_ASSERT(iso_submit(&p_video->xfer[i], p_video->ep_size));
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Close streaming endpoint, frame being received is discarded and its buffer stays queued
+static void stream_close(videoh_interface_t* p_video) {
+  if (p_video->ep_addr != 0) {
+    tuh_edpt_close(p_video->daddr, p_video->ep_addr);
+    p_video->ep_addr = 0;
+  }
+  saved_restore(p_video);
+  p_video->active = false;
+}
+
+static void stream_start_complete(uint8_t idx, bool success) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+
+  if (success) {
+    success = stream_open(idx);
+  }
+
+  if (!success) {
+    stream_close(p_video);
+    p_video->state = VIDEOH_STREAM_IDLE;
+  }
+
+  tuh_video_stream_start_cb(idx, success);
+}
+
+static void stream_ctrl_complete(tuh_xfer_t* xfer);
+
+// Class request to probe or commit control of the streaming interface, data is in epbuf
+static bool stream_ctrl_xfer(uint8_t idx, uint8_t request, uint8_t selector) {
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+  videoh_epbuf_t* epbuf = &_videoh_epbuf[idx];
+
+  bool const is_get = (request & 0x80u) != 0;
+  if (!is_get) {
+    epbuf->ctrl = p_video->commit;
+  }
+
+  tusb_control_request_t const setup = {
+      .bmRequestType_bit = {
+          .recipient = TUSB_REQ_RCPT_INTERFACE,
+          .type      = TUSB_REQ_TYPE_CLASS,
+          .direction = is_get ? TUSB_DIR_IN : TUSB_DIR_OUT
+      },
+      .bRequest = request,
+      .wValue   = tu_htole16((uint16_t) (selector << 8)),
+      .wIndex   = tu_htole16(p_video->itf_vs),
+      .wLength  = tu_htole16(probe_len(p_video))
+  };
+
+  tuh_xfer_t xfer = {
+      .daddr       = p_video->daddr,
+      .ep_addr     = 0,
+      .setup       = &setup,
+      .buffer      = (uint8_t*) &epbuf->ctrl,
+      .complete_cb = stream_ctrl_complete,
+      .user_data   = idx
+  };
+
+  return tuh_control_xfer(&xfer);
+}
+
+// Probe SET_CUR -> probe GET_CUR -> commit SET_CUR -> SET_INTERFACE (isochronous only) -> streaming
+static void stream_ctrl_complete(tuh_xfer_t* xfer) {
+  uint8_t const idx = (uint8_t) xfer->user_data;
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+  bool success = (xfer->result == XFER_RESULT_SUCCESS);
+
+  switch (p_video->state) {
+    case VIDEOH_STREAM_STOPPING:
+      p_video->state = VIDEOH_STREAM_IDLE;
+      return;
+
+    case VIDEOH_STREAM_PROBE_SET:
+      p_video->state = VIDEOH_STREAM_PROBE_GET;
+      success = success && stream_ctrl_xfer(idx, VIDEO_REQUEST_GET_CUR, VIDEO_VS_CTL_PROBE);
+      break;
+
+    case VIDEOH_STREAM_PROBE_GET: {
+      // device may adjust interval and fills in frame and payload size, but must keep format and frame
+      const tuh_video_frame_info_t* info = &p_video->info[p_video->info_idx];
+      const video_probe_and_commit_control_t* probe = &_videoh_epbuf[idx].ctrl;
+      success = success && probe->bFormatIndex == info->format_index && probe->bFrameIndex == info->frame_index;
+      if (success) {
+        memcpy(&p_video->commit, probe, tu_min32(xfer->actual_len, probe_len(p_video)));
+        TU_LOG_DRV("  Video probe interval %lu, frame %lu, payload %lu\r\n",
+                   (unsigned long) tu_le32toh(p_video->commit.dwFrameInterval),
+                   (unsigned long) tu_le32toh(p_video->commit.dwMaxVideoFrameSize),
+                   (unsigned long) tu_le32toh(p_video->commit.dwMaxPayloadTransferSize));
+      }
+      p_video->state = VIDEOH_STREAM_COMMIT;
+      success = success && stream_ctrl_xfer(idx, VIDEO_REQUEST_SET_CUR, VIDEO_VS_CTL_COMMIT);
+      break;
+    }
+
+    case VIDEOH_STREAM_COMMIT:
+      p_video->max_payload = tu_le32toh(p_video->commit.dwMaxPayloadTransferSize);
+      if (p_video->max_payload == 0) {
+        p_video->max_payload = UINT32_MAX; // payload ends with a short packet
+      }
+      if (!success || p_video->ep_bulk.bLength != 0) {
+        stream_start_complete(idx, success);
+        return;
+      }
+    #if CFG_TUH_ISO_EP_MAX
+      p_video->alt_idx = iso_alt_select(p_video);
+      success = (p_video->alt_idx != TUSB_INDEX_INVALID_8);
+      if (success) {
+        TU_LOG_DRV("  Video select Alt %u, packet %u\r\n", p_video->alt[p_video->alt_idx].alt,
+                   p_video->alt[p_video->alt_idx].ep_size);
+        p_video->state = VIDEOH_STREAM_SET_ITF;
+        success = tuh_interface_set(p_video->daddr, p_video->itf_vs, p_video->alt[p_video->alt_idx].alt,
+                                    stream_ctrl_complete, idx);
+      }
+    #else
+      success = false;
+    #endif
+      break;
+
+    case VIDEOH_STREAM_SET_ITF:
+      stream_start_complete(idx, success);
+      return;
+
+    default:
+      return;
+  }
+
+  if (!success) {
+    stream_start_complete(idx, false);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+
+bool tuh_video_mounted(uint8_t idx) {
+  return get_itf(idx) != NULL;
+}
+
+uint8_t tuh_video_frame_info_count(uint8_t idx) {
+  const videoh_interface_t* p_video = get_itf(idx);
+  return (p_video != NULL) ? p_video->info_count : 0;
+}
+
+bool tuh_video_frame_info(uint8_t idx, uint8_t info_idx, tuh_video_frame_info_t* info) {
+  const videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && info_idx < p_video->info_count && info != NULL);
+  *info = p_video->info[info_idx];
+  return true;
+}
+
+uint8_t tuh_video_frame_info_find(uint8_t idx, uint8_t format, uint32_t fourcc, uint16_t width, uint16_t height) {
+  const videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL, TUSB_INDEX_INVALID_8);
+
+  for (uint8_t i = 0; i < p_video->info_count; i++) {
+    const tuh_video_frame_info_t* info = &p_video->info[i];
+    if (info->format == format && (fourcc == 0 || info->fourcc == fourcc) &&
+        (width == 0 || info->width == width) && (height == 0 || info->height == height)) {
+      return i;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+bool tuh_video_stream_start(uint8_t idx, uint8_t info_idx, uint32_t interval) {
+  videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && info_idx < p_video->info_count);
+  TU_VERIFY(p_video->state == VIDEOH_STREAM_IDLE);
+#if CFG_TUH_ISO_EP_MAX == 0
+  TU_VERIFY(p_video->ep_bulk.bLength != 0); // isochronous camera needs CFG_TUH_ISO_EP_MAX
+#endif
+
+  const tuh_video_frame_info_t* info = &p_video->info[info_idx];
+  p_video->info_idx = info_idx;
+
+  // hint device to keep frame interval
+  tu_memclr(&p_video->commit, sizeof(video_probe_and_commit_control_t));
+  p_video->commit.bmHint          = 1;
+  p_video->commit.bFormatIndex    = info->format_index;
+  p_video->commit.bFrameIndex     = info->frame_index;
+  p_video->commit.dwFrameInterval = tu_htole32(interval ? interval : info->default_interval);
+
+  TU_LOG_DRV("[%u] Video start format %u frame %u %ux%u\r\n", p_video->daddr, info->format_index, info->frame_index,
+             info->width, info->height);
+
+  p_video->state = VIDEOH_STREAM_PROBE_SET;
+  if (!stream_ctrl_xfer(idx, VIDEO_REQUEST_SET_CUR, VIDEO_VS_CTL_PROBE)) {
+    p_video->state = VIDEOH_STREAM_IDLE;
+    return false;
+  }
+
+  return true;
+}
+
+bool tuh_video_stream_stop(uint8_t idx) {
+  videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && p_video->state == VIDEOH_STREAM_STREAMING);
+
+  uint8_t const ep_addr = p_video->ep_addr;
+  stream_close(p_video);
+  p_video->state = VIDEOH_STREAM_STOPPING;
+
+  bool ok;
+  if (p_video->ep_bulk.bLength != 0) {
+    // bulk streaming is stopped by clearing halt of its endpoint
+    tusb_control_request_t const setup = {
+        .bmRequestType_bit = {
+            .recipient = TUSB_REQ_RCPT_ENDPOINT,
+            .type      = TUSB_REQ_TYPE_STANDARD,
+            .direction = TUSB_DIR_OUT
+        },
+        .bRequest = TUSB_REQ_CLEAR_FEATURE,
+        .wValue   = tu_htole16(TUSB_REQ_FEATURE_EDPT_HALT),
+        .wIndex   = tu_htole16(ep_addr),
+        .wLength  = 0
+    };
+
+    tuh_xfer_t xfer = {
+        .daddr       = p_video->daddr,
+        .ep_addr     = 0,
+        .setup       = &setup,
+        .buffer      = NULL,
+        .complete_cb = stream_ctrl_complete,
+        .user_data   = idx
+    };
+    ok = tuh_control_xfer(&xfer);
+  } else {
+    ok = tuh_interface_set(p_video->daddr, p_video->itf_vs, 0, stream_ctrl_complete, idx);
+  }
+
+  if (!ok) {
+    p_video->state = VIDEOH_STREAM_IDLE;
+  }
+
+  return true;
+}
+
+bool tuh_video_streaming(uint8_t idx) {
+  const videoh_interface_t* p_video = get_itf(idx);
+  return (p_video != NULL) && (p_video->state == VIDEOH_STREAM_STREAMING);
+}
+
+bool tuh_video_commit_get(uint8_t idx, video_probe_and_commit_control_t* commit) {
+  const videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && commit != NULL && p_video->state == VIDEOH_STREAM_STREAMING);
+  *commit = p_video->commit;
+  return true;
+}
+
+bool tuh_video_frame_queue(uint8_t idx, void* buffer, uint32_t bufsize) {
+  videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && buffer != NULL && bufsize > 0);
+
+  videoh_buf_t* buf = &p_video->buf[p_video->buf_queue];
+  TU_VERIFY(buf->state == VIDEOH_BUF_FREE);
+
+  buf->frame.buffer = (uint8_t*) buffer;
+  buf->frame.size   = bufsize;
+  buf->state        = VIDEOH_BUF_QUEUED;
+  p_video->buf_queue = buf_next(p_video->buf_queue);
+  return true;
+}
+
+bool tuh_video_frame_get(uint8_t idx, tuh_video_frame_t* frame) {
+  videoh_interface_t* p_video = get_itf(idx);
+  TU_VERIFY(p_video != NULL && frame != NULL);
+
+  videoh_buf_t* buf = &p_video->buf[p_video->buf_get];
+  TU_VERIFY(buf->state == VIDEOH_BUF_DONE);
+
+  *frame = buf->frame;
+  buf->state = VIDEOH_BUF_FREE;
+  p_video->buf_get = buf_next(p_video->buf_get);
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Class Driver API
+//--------------------------------------------------------------------+
+
+bool videoh_init(void) {
+  tu_memclr(_videoh_itf, sizeof(_videoh_itf));
+  return true;
+}
+
+bool videoh_deinit(void) {
+  return true;
+}
+
+// Parse a Video Function: VC interface followed by VS interfaces. Formats, frames and endpoints of the first VS
+// interface are recorded. Stop at the next function (IAD), a non-video interface or the end of configuration.
+uint16_t videoh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len) {
+  (void) rhport;
+  TU_VERIFY(TUSB_CLASS_VIDEO == desc_itf->bInterfaceClass &&
+            VIDEO_SUBCLASS_CONTROL == desc_itf->bInterfaceSubClass, 0);
+
+  const uint8_t idx = find_new_index();
+  TU_VERIFY(idx < CFG_TUH_VIDEO, 0);
+  videoh_interface_t* p_video = &_videoh_itf[idx];
+
+  TU_LOG_DRV("[%u] Video opening Interface %u\r\n", dev_addr, desc_itf->bInterfaceNumber);
+
+  const uint8_t* p_desc = tu_desc_next(desc_itf);
+  const uint8_t* desc_end = ((const uint8_t*) desc_itf) + max_len;
+  bool in_vc = true;
+  bool in_vs = false;  // alternate 0 of first VS interface
+  videoh_alt_t* alt = NULL;
+  uint8_t format = 0;
+  const uint8_t* desc_format = NULL;
+
+  p_video->itf_vc     = desc_itf->bInterfaceNumber;
+  p_video->itf_vs     = TUSB_INDEX_INVALID_8;
+  p_video->itf_last   = desc_itf->bInterfaceNumber;
+  p_video->info_count = 0;
+  p_video->alt_count  = 0;
+  tu_memclr(&p_video->ep_bulk, sizeof(tusb_desc_endpoint_t));
+
+  while (tu_desc_in_bounds(p_desc, desc_end) && tu_desc_len(p_desc) > 0) {
+    uint8_t const desc_type = tu_desc_type(p_desc);
+    if (desc_type == TUSB_DESC_INTERFACE_ASSOCIATION) {
+      break;
+    }
+
+    if (desc_type == TUSB_DESC_INTERFACE) {
+      const tusb_desc_interface_t* itf = (const tusb_desc_interface_t*) p_desc;
+      if (itf->bInterfaceClass != TUSB_CLASS_VIDEO || itf->bInterfaceSubClass != VIDEO_SUBCLASS_STREAMING) {
+        break;
+      }
+      if (p_video->itf_vs == TUSB_INDEX_INVALID_8) {
+        p_video->itf_vs = itf->bInterfaceNumber;
+      }
+      in_vc = false;
+      in_vs = (itf->bInterfaceNumber == p_video->itf_vs && itf->bAlternateSetting == 0);
+      alt = NULL;
+      p_video->itf_last = itf->bInterfaceNumber;
+      if (itf->bInterfaceNumber == p_video->itf_vs && itf->bAlternateSetting != 0 && itf->bNumEndpoints > 0) {
+        if (p_video->alt_count < CFG_TUH_VIDEO_ALT_MAX) {
+          alt = &p_video->alt[p_video->alt_count];
+          tu_memclr(alt, sizeof(videoh_alt_t));
+          alt->alt = itf->bAlternateSetting;
+        } else {
+          TU_LOG_DRV("  Video Alt %u skipped, increase CFG_TUH_VIDEO_ALT_MAX\r\n", itf->bAlternateSetting);
+        }
+      }
+    } else if (desc_type == TUSB_DESC_CS_INTERFACE && in_vc) {
+      if (tu_desc_subtype(p_desc) == VIDEO_CS_ITF_VC_HEADER) {
+        p_video->bcd_uvc = tu_le16toh(((const tusb_desc_video_control_header_t*) p_desc)->bcdUVC);
+      }
+    } else if (desc_type == TUSB_DESC_CS_INTERFACE && in_vs) {
+      uint8_t const subtype = tu_desc_subtype(p_desc);
+      if (subtype == VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED || subtype == VIDEO_CS_ITF_VS_FORMAT_MJPEG) {
+        format = subtype;
+        desc_format = p_desc;
+      } else if ((subtype == VIDEO_CS_ITF_VS_FRAME_UNCOMPRESSED && format == VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED) ||
+                 (subtype == VIDEO_CS_ITF_VS_FRAME_MJPEG && format == VIDEO_CS_ITF_VS_FORMAT_MJPEG)) {
+        if (p_video->info_count < CFG_TUH_VIDEO_FRAME_INFO_MAX) {
+          const tusb_desc_video_frame_uncompressed_t* desc_frame = (const tusb_desc_video_frame_uncompressed_t*) p_desc;
+          tuh_video_frame_info_t* info = &p_video->info[p_video->info_count++];
+          tu_memclr(info, sizeof(tuh_video_frame_info_t));
+          info->format           = format;
+          info->format_index     = desc_format[3]; // bFormatIndex of both format descriptors
+          info->frame_index      = desc_frame->bFrameIndex;
+          info->width            = tu_le16toh(desc_frame->wWidth);
+          info->height           = tu_le16toh(desc_frame->wHeight);
+          info->default_interval = tu_le32toh(desc_frame->dwDefaultFrameInterval);
+          info->max_frame_size   = tu_le32toh(desc_frame->dwMaxVideoFrameBufferSize);
+          if (format == VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED) {
+            const tusb_desc_video_format_uncompressed_t* desc_uncompressed =
+              (const tusb_desc_video_format_uncompressed_t*) desc_format;
+            info->fourcc         = tu_le32toh(tu_unaligned_read32(desc_uncompressed->guidFormat));
+            info->bits_per_pixel = desc_uncompressed->bBitsPerPixel;
+          }
+        } else {
+          TU_LOG_DRV("  Video frame skipped, increase CFG_TUH_VIDEO_FRAME_INFO_MAX\r\n");
+        }
+      }
+    } else if (desc_type == TUSB_DESC_ENDPOINT) {
+      const tusb_desc_endpoint_t* desc_ep = (const tusb_desc_endpoint_t*) p_desc;
+      if (in_vs && desc_ep->bmAttributes.xfer == TUSB_XFER_BULK && tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_IN) {
+        p_video->ep_bulk = *desc_ep;
+      } else if (alt != NULL && desc_ep->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+        uint16_t const mult = (uint16_t) (((tu_le16toh(desc_ep->wMaxPacketSize) >> 11) & 0x3u) + 1u);
+        alt->ep      = *desc_ep;
+        alt->ep_size = (uint16_t) (tu_edpt_packet_size(desc_ep) * mult);
+        p_video->alt_count++;
+        TU_LOG_DRV("  Alt %u: packet %u\r\n", alt->alt, alt->ep_size);
+        alt = NULL;
+      }
+    }
+
+    p_desc = tu_desc_next(p_desc);
+  }
+
+  TU_VERIFY(p_video->itf_vs != TUSB_INDEX_INVALID_8, 0);
+  p_video->daddr = dev_addr;
+
+  TU_LOG_DRV("  UVC %04X, %u frames, %s streaming\r\n", p_video->bcd_uvc, p_video->info_count,
+             p_video->ep_bulk.bLength ? "bulk" : "isochronous");
+
+  return (uint16_t) (p_desc - (const uint8_t*) desc_itf);
+}
+
+bool videoh_set_config(uint8_t dev_addr, uint8_t itf_num) {
+  for (uint8_t idx = 0; idx < CFG_TUH_VIDEO; idx++) {
+    videoh_interface_t* p_video = &_videoh_itf[idx];
+    if (p_video->daddr == dev_addr && p_video->itf_vc == itf_num) {
+      p_video->mounted = true;
+      tuh_video_mount_cb(idx);
+      // all VS interfaces of the function are bound to this driver
+      usbh_driver_set_config_complete(dev_addr, p_video->itf_last);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool videoh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  // bulk streaming endpoint, isochronous completes with tuh_iso_xfer() callbacks and VC interrupt endpoint is not used
+  for (uint8_t idx = 0; idx < CFG_TUH_VIDEO; idx++) {
+    videoh_interface_t* p_video = &_videoh_itf[idx];
+    if (p_video->daddr == dev_addr && p_video->ep_addr == ep_addr && p_video->state == VIDEOH_STREAM_STREAMING) {
+      bulk_complete(idx, result, xferred_bytes);
+      break;
+    }
+  }
+  return true;
+}
+
+void videoh_close(uint8_t dev_addr) {
+  for (uint8_t idx = 0; idx < CFG_TUH_VIDEO; idx++) {
+    videoh_interface_t* p_video = &_videoh_itf[idx];
+    if (p_video->daddr == dev_addr) {
+      TU_LOG_DRV("  Video close addr = %u index = %u\r\n", dev_addr, idx);
+      if (p_video->mounted) {
+        tuh_video_umount_cb(idx);
+      }
+      // endpoints and isochronous streams are released by usbh with the device
+      tu_memclr(p_video, sizeof(videoh_interface_t));
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_VIDEO_HOST_H_
+#define TUSB_VIDEO_HOST_H_
+
+#include "video.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Class Driver Configuration
+//--------------------------------------------------------------------+
+
+// Max number of frame descriptors (all MJPEG and uncompressed formats) recorded per video function
+#ifndef CFG_TUH_VIDEO_FRAME_INFO_MAX
+  #define CFG_TUH_VIDEO_FRAME_INFO_MAX 16
+#endif
+
+// Number of frame buffers the application can queue per video function
+#ifndef CFG_TUH_VIDEO_FRAME_BUF_COUNT
+  #define CFG_TUH_VIDEO_FRAME_BUF_COUNT 3
+#endif
+
+// Max number of isochronous alternate settings recorded per video streaming interface
+#ifndef CFG_TUH_VIDEO_ALT_MAX
+  #define CFG_TUH_VIDEO_ALT_MAX 8
+#endif
+
+// Max bytes of an isochronous packet (per service interval) of a streaming alternate setting. Larger alternates are
+// not selected. Only used with CFG_TUH_ISO_EP_MAX, bulk streaming needs no endpoint buffer.
+#ifndef CFG_TUH_VIDEO_EP_SZ
+  #define CFG_TUH_VIDEO_EP_SZ 1024
+#endif
+
+// Number of packets (service intervals) per isochronous transfer, each stream has 2 transfers in flight
+#ifndef CFG_TUH_VIDEO_ISO_PACKETS
+  #define CFG_TUH_VIDEO_ISO_PACKETS 8
+#endif
+
+#ifndef CFG_TUH_VIDEO_LOG_LEVEL
+  #define CFG_TUH_VIDEO_LOG_LEVEL CFG_TUH_LOG_LEVEL
+#endif
+
+//--------------------------------------------------------------------+
+// Type Definitions
+//--------------------------------------------------------------------+
+
+// Frame descriptor of a MJPEG or uncompressed format
+typedef struct {
+  uint8_t  format;           // VIDEO_CS_ITF_VS_FORMAT_MJPEG or VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED
+  uint8_t  format_index;     // bFormatIndex
+  uint8_t  frame_index;      // bFrameIndex
+  uint8_t  bits_per_pixel;   // uncompressed only
+  uint32_t fourcc;           // first 4 bytes of guidFormat e.g 'YUY2' = 0x32595559, 0 for MJPEG
+  uint16_t width;
+  uint16_t height;
+  uint32_t default_interval; // 100ns unit
+  uint32_t max_frame_size;   // dwMaxVideoFrameBufferSize
+} tuh_video_frame_info_t;
+
+// Error bits of a received frame
+enum {
+  TUH_VIDEO_FRAME_ERROR_PAYLOAD  = 0x01, // device set the error bit of a payload header
+  TUH_VIDEO_FRAME_ERROR_OVERFLOW = 0x02, // frame is larger than its buffer, data is truncated
+  TUH_VIDEO_FRAME_ERROR_XFER     = 0x04, // transfer failed, payload is lost
+  TUH_VIDEO_FRAME_ERROR_HEADER   = 0x08, // malformed payload header, payload is dropped
+};
+
+// Received frame. Frame data is not necessarily at the start of the queued buffer: bulk payloads are received in
+// place and the header of the first payload is left in front of the data.
+typedef struct {
+  uint8_t* buffer;  // buffer as queued with tuh_video_frame_queue()
+  uint32_t size;    // size of buffer
+  uint8_t* data;    // frame data within buffer
+  uint32_t length;  // bytes of frame data
+  uint32_t pts;     // presentation time stamp of the first payload with one, valid if has_pts
+  bool     has_pts;
+  bool     eof;     // terminated by End of Frame bit, otherwise by Frame ID toggle or frame size
+  uint8_t  status;  // TUH_VIDEO_FRAME_ERROR_ bits, 0 if frame is intact
+} tuh_video_frame_t;
+
+//--------------------------------------------------------------------+
+// Application API
+//--------------------------------------------------------------------+
+
+// Check if video function is mounted
+bool tuh_video_mounted(uint8_t idx);
+
+// Get number of frame descriptors
+uint8_t tuh_video_frame_info_count(uint8_t idx);
+
+// Get a frame descriptor, info_idx < tuh_video_frame_info_count()
+bool tuh_video_frame_info(uint8_t idx, uint8_t info_idx, tuh_video_frame_info_t* info);
+
+// Find frame descriptor of a format (VIDEO_CS_ITF_VS_FORMAT_) with matching size, 0 matches any. fourcc is only
+// compared for uncompressed format if not 0. Return info_idx or TUSB_INDEX_INVALID_8 if not found
+uint8_t tuh_video_frame_info_find(uint8_t idx, uint8_t format, uint32_t fourcc, uint16_t width, uint16_t height);
+
+// Start streaming a frame descriptor at frame interval (100ns unit, 0 for default): probe and commit the streaming
+// parameters, select the isochronous alternate fitting the negotiated payload size (or use the bulk endpoint), then
+// receive frames into queued buffers. Asynchronous: tuh_video_stream_start_cb() is invoked when complete.
+bool tuh_video_stream_start(uint8_t idx, uint8_t info_idx, uint32_t interval);
+
+// Stop streaming, frame being received is discarded but its buffer stays queued
+bool tuh_video_stream_stop(uint8_t idx);
+
+// Check if streaming
+bool tuh_video_streaming(uint8_t idx);
+
+// Get committed streaming parameters e.g dwMaxVideoFrameSize to size frame buffers
+bool tuh_video_commit_get(uint8_t idx, video_probe_and_commit_control_t* commit);
+
+// Queue a buffer to receive a frame into, buffers are filled in queued order. Bulk payloads are received directly into
+// the buffer, it must be accessible by the host controller (e.g CFG_TUH_MEM_SECTION). The buffer belongs to the stack
+// until returned by tuh_video_frame_get(). Return false if all buffer slots are in use
+bool tuh_video_frame_queue(uint8_t idx, void* buffer, uint32_t bufsize);
+
+// Get the oldest received frame, its buffer is returned to application. Return false if none
+bool tuh_video_frame_get(uint8_t idx, tuh_video_frame_t* frame);
+
+//--------------------------------------------------------------------+
+// Application Callback API (weak, optional)
+//--------------------------------------------------------------------+
+
+// Invoked when video function is mounted, frame descriptors can be queried
+void tuh_video_mount_cb(uint8_t idx);
+
+// Invoked when video function is unmounted, all queued buffers are released
+void tuh_video_umount_cb(uint8_t idx);
+
+// Invoked when tuh_video_stream_start() is complete
+void tuh_video_stream_start_cb(uint8_t idx, bool success);
+
+// Invoked when a frame is received, get it with tuh_video_frame_get()
+void tuh_video_frame_cb(uint8_t idx);
+
+//--------------------------------------------------------------------+
+// Internal Class Driver API
+//--------------------------------------------------------------------+
+bool     videoh_init(void);
+bool     videoh_deinit(void);
+uint16_t videoh_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_interface_t *desc_itf, uint16_t max_len);
+bool     videoh_set_config(uint8_t dev_addr, uint8_t itf_num);
+bool     videoh_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+void     videoh_close(uint8_t dev_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -77,6 +77,9 @@ extern uint32_t tusb_time_millis_api(void);
 // Delay in milliseconds, use tusb_time_millis_api() by default. required by some port/configuration with no RTOS
 extern void tusb_time_delay_ms_api(uint32_t ms);
 
+// Free running cycle counter e.g DWT->CYCCNT, required by CFG_TUD_EDPT_STATS and CFG_TUH_EDPT_STATS
+extern uint32_t tusb_cycle_count_api(void);
+
 // flush data cache
 extern void tusb_app_dcache_flush(uintptr_t addr, uint32_t data_size);
 
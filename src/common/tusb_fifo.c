@@ -12,7 +12,7 @@
 #define TU_FIFO_DBG 0
 
 
-#if OSAL_MUTEX_REQUIRED
+#if CFG_FIFO_MUTEX
 
 TU_ATTR_ALWAYS_INLINE static inline void ff_lock(osal_mutex_t mutex) {
   if (mutex != NULL) {
@@ -49,8 +49,8 @@ bool tu_fifo_config(tu_fifo_t *f, void *buffer, uint16_t depth, bool overwritabl
   f->buffer       = (uint8_t *)buffer;
   f->depth        = depth;
   f->overwritable = overwritable;
-  f->rd_idx       = 0u;
-  f->wr_idx       = 0u;
+  tu_ff_store_idx(&f->rd_idx, 0u);
+  tu_ff_store_idx(&f->wr_idx, 0u);
 
   ff_unlock(f->mutex_wr);
   ff_unlock(f->mutex_rd);
@@ -63,8 +63,8 @@ void tu_fifo_clear(tu_fifo_t *f) {
   ff_lock(f->mutex_wr);
   ff_lock(f->mutex_rd);
 
-  f->rd_idx = 0;
-  f->wr_idx = 0;
+  tu_ff_store_idx(&f->rd_idx, 0);
+  tu_ff_store_idx(&f->wr_idx, 0);
 
   ff_unlock(f->mutex_wr);
   ff_unlock(f->mutex_rd);
@@ -430,7 +430,7 @@ static uint16_t correct_read_index(tu_fifo_t *f, uint16_t wr_idx) {
     rd_idx = wr_idx + f->depth;
   }
 
-  f->rd_idx = rd_idx;
+  tu_ff_store_idx(&f->rd_idx, rd_idx);
   return rd_idx;
 }
 
@@ -475,8 +475,8 @@ uint16_t tu_fifo_peek_n_access_mode(tu_fifo_t *f, void *p_buffer, uint16_t n, ui
 // Read n items without removing it from the FIFO, correct read pointer if overflowed
 uint16_t tu_fifo_peek_n(tu_fifo_t *f, void *p_buffer, uint16_t n) {
   ff_lock(f->mutex_rd);
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   const uint16_t ret = tu_fifo_peek_n_access_mode(f, p_buffer, n, wr_idx, rd_idx, NULL);
   ff_unlock(f->mutex_rd);
   return ret;
@@ -487,9 +487,9 @@ uint16_t tu_fifo_read_n_access_mode(tu_fifo_t *f, void *buffer, uint16_t n, cons
   ff_lock(f->mutex_rd);
 
   // Peek the data: f->rd_idx might get modified in case of an overflow so we can not use a local variable
-  const uint16_t wr_idx = f->wr_idx;
-  n         = tu_fifo_peek_n_access_mode(f, buffer, n, wr_idx, f->rd_idx, access_mode);
-  f->rd_idx = advance_index(f->depth, f->rd_idx, n);
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  n         = tu_fifo_peek_n_access_mode(f, buffer, n, wr_idx, tu_ff_load_idx(&f->rd_idx), access_mode);
+  tu_ff_store_idx(&f->rd_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), n));
 
   ff_unlock(f->mutex_rd);
   return n;
@@ -504,8 +504,8 @@ uint16_t tu_fifo_write_n_access_mode(tu_fifo_t *f, const void *data, uint16_t n,
 
   ff_lock(f->mutex_wr);
 
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
+  uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
 
   const uint8_t *buf8 = (const uint8_t *)data;
 
@@ -567,9 +567,9 @@ uint16_t tu_fifo_write_n_access_mode(tu_fifo_t *f, const void *data, uint16_t n,
     {
       ff_push_n(f, buf8, n, wr_ptr);
     }
-    f->wr_idx = advance_index(f->depth, wr_idx, n);
+    tu_ff_store_idx(&f->wr_idx, advance_index(f->depth, wr_idx, n));
 
-    TU_LOG(TU_FIFO_DBG, "\tnew_wr = %u\r\n", f->wr_idx);
+    TU_LOG(TU_FIFO_DBG, "\tnew_wr = %u\r\n", tu_ff_load_idx(&f->wr_idx));
   }
 
   ff_unlock(f->mutex_wr);
@@ -580,12 +580,87 @@ uint16_t tu_fifo_write_n_access_mode(tu_fifo_t *f, const void *data, uint16_t n,
 uint16_t tu_fifo_discard_n(tu_fifo_t *f, uint16_t n) {
   const uint16_t count = tu_min16(n, tu_fifo_count(f)); // limit to available count
   ff_lock(f->mutex_rd);
-  f->rd_idx = advance_index(f->depth, f->rd_idx, count);
+  tu_ff_store_idx(&f->rd_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), count));
   ff_unlock(f->mutex_rd);
 
   return count;
 }
 
+uint16_t tu_fifo_truncate_n(tu_fifo_t *f, uint16_t n) {
+  ff_lock(f->mutex_wr);
+  const uint16_t count = tu_fifo_count(f);
+  const uint16_t discarded = (count > n) ? (uint16_t) (count - n) : 0;
+  if (discarded > 0) {
+    tu_ff_store_idx(&f->wr_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), n));
+  }
+  ff_unlock(f->mutex_wr);
+
+  return discarded;
+}
+
+//--------------------------------------------------------------------+
+// Reserve/Commit API
+//--------------------------------------------------------------------+
+
+// split n items starting at ptr into linear and wrapped spans
+static void ff_get_spans(const tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t ptr, uint16_t n) {
+  const uint16_t lin_len = tu_min16(n, f->depth - ptr);
+
+  info->linear.ptr  = (n > 0) ? (f->buffer + ptr) : NULL;
+  info->linear.len  = lin_len;
+  info->wrapped.ptr = (n > lin_len) ? f->buffer : NULL;
+  info->wrapped.len = n - lin_len;
+}
+
+// Reserve up to n free items for in-place writing, write mutex is held until tu_fifo_write_commit()
+uint16_t tu_fifo_write_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n) {
+  ff_lock(f->mutex_wr);
+
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
+
+  n = tu_min16(n, tu_ff_remaining_local(f->depth, wr_idx, rd_idx));
+  ff_get_spans(f, info, idx2ptr(f->depth, wr_idx), n);
+
+  return n;
+}
+
+// Publish n items written into the reserved spans and release write mutex
+void tu_fifo_write_commit(tu_fifo_t *f, uint16_t n) {
+  if (n > 0) {
+    tu_ff_store_idx(&f->wr_idx, advance_index(f->depth, tu_ff_load_idx(&f->wr_idx), n));
+  }
+  ff_unlock(f->mutex_wr);
+}
+
+// Reserve up to n items for in-place reading, correct read index if overflowed.
+// Read mutex is held until tu_fifo_read_commit()
+uint16_t tu_fifo_read_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n) {
+  ff_lock(f->mutex_rd);
+
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  uint16_t       rd_idx = tu_ff_load_idx(&f->rd_idx);
+
+  uint16_t count = tu_ff_overflow_count(f->depth, wr_idx, rd_idx);
+  if (count > f->depth) {
+    rd_idx = correct_read_index(f, wr_idx);
+    count  = f->depth;
+  }
+
+  n = tu_min16(n, count);
+  ff_get_spans(f, info, idx2ptr(f->depth, rd_idx), n);
+
+  return n;
+}
+
+// Consume n items from the reserved spans and release read mutex
+void tu_fifo_read_commit(tu_fifo_t *f, uint16_t n) {
+  if (n > 0) {
+    tu_ff_store_idx(&f->rd_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), n));
+  }
+  ff_unlock(f->mutex_rd);
+}
+
 //--------------------------------------------------------------------+
 // One API
 //--------------------------------------------------------------------+
@@ -615,11 +690,11 @@ static bool ff_peek_local(tu_fifo_t *f, void *buf, uint16_t wr_idx, uint16_t rd_
 bool tu_fifo_read(tu_fifo_t *f, void *buffer) {
   // Peek the data
   // f->rd_idx might get modified in case of an overflow so we can not use a local variable
-  const uint16_t wr_idx = f->wr_idx;
-  const bool ret = ff_peek_local(f, buffer, wr_idx, f->rd_idx);
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const bool ret = ff_peek_local(f, buffer, wr_idx, tu_ff_load_idx(&f->rd_idx));
   if (ret) {
     ff_lock(f->mutex_rd);
-    f->rd_idx = advance_index(f->depth, f->rd_idx, 1);
+    tu_ff_store_idx(&f->rd_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), 1));
     ff_unlock(f->mutex_rd);
   }
 
@@ -628,8 +703,8 @@ bool tu_fifo_read(tu_fifo_t *f, void *buffer) {
 
 // Read one item without removing it from the FIFO, correct read index if overflowed
 bool tu_fifo_peek(tu_fifo_t *f, void *p_buffer) {
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   return ff_peek_local(f, p_buffer, wr_idx, rd_idx);
 }
 
@@ -638,14 +713,14 @@ bool tu_fifo_write(tu_fifo_t *f, const void *data) {
   bool ret;
   ff_lock(f->mutex_wr);
 
-  const uint16_t wr_idx = f->wr_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
 
   if (tu_fifo_full(f) && !f->overwritable) {
     ret = false;
   } else {
     const uint16_t wr_ptr = idx2ptr(f->depth, wr_idx);
     memcpy(f->buffer + wr_ptr, data, 1);
-    f->wr_idx = advance_index(f->depth, wr_idx, 1);
+    tu_ff_store_idx(&f->wr_idx, advance_index(f->depth, wr_idx, 1));
     ret       = true;
   }
 
@@ -675,13 +750,13 @@ bool tu_fifo_write(tu_fifo_t *f, const void *data) {
  */
 /******************************************************************************/
 void tu_fifo_advance_write_pointer(tu_fifo_t *f, uint16_t n) {
-  f->wr_idx = advance_index(f->depth, f->wr_idx, n);
+  tu_ff_store_idx(&f->wr_idx, advance_index(f->depth, tu_ff_load_idx(&f->wr_idx), n));
 }
 
 // Correct the read index in case tu_fifo_overflow() returned true!
 void tu_fifo_correct_read_pointer(tu_fifo_t *f) {
   ff_lock(f->mutex_rd);
-  correct_read_index(f, f->wr_idx);
+  correct_read_index(f, tu_ff_load_idx(&f->wr_idx));
   ff_unlock(f->mutex_rd);
 }
 
@@ -702,7 +777,7 @@ void tu_fifo_correct_read_pointer(tu_fifo_t *f) {
  */
 /******************************************************************************/
 void tu_fifo_advance_read_pointer(tu_fifo_t *f, uint16_t n) {
-  f->rd_idx = advance_index(f->depth, f->rd_idx, n);
+  tu_ff_store_idx(&f->rd_idx, advance_index(f->depth, tu_ff_load_idx(&f->rd_idx), n));
 }
 
 /******************************************************************************/
@@ -722,8 +797,8 @@ void tu_fifo_advance_read_pointer(tu_fifo_t *f, uint16_t n) {
 /******************************************************************************/
 void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info) {
   // Operate on temporary values in case they change in between
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
+  uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
 
   uint16_t cnt = tu_ff_overflow_count(f->depth, wr_idx, rd_idx);
 
@@ -783,8 +858,8 @@ void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info) {
  */
 /******************************************************************************/
 void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info) {
-  uint16_t wr_idx = f->wr_idx;
-  uint16_t rd_idx = f->rd_idx;
+  uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   uint16_t remain = tu_ff_remaining_local(f->depth, wr_idx, rd_idx);
 
   if (remain == 0) {
@@ -19,8 +19,16 @@ extern "C" {
 //--------------------------------------------------------------------+
 // Configuration
 //--------------------------------------------------------------------+
+// Single-Producer Single-Consumer mode: each fifo is written from exactly one context and read from exactly one
+// context (e.g application task and USB task/ISR). Read/write indices are then published with acquire/release
+// ordering and no mutex is ever taken, even with an RTOS. Application must not write to the same fifo (e.g
+// tud_cdc_write()) from more than one thread when this is enabled.
+#ifndef CFG_TUSB_FIFO_SPSC
+  #define CFG_TUSB_FIFO_SPSC 0
+#endif
+
 // mutex is only needed for RTOS. For OS None, we don't get preempted
-#define CFG_FIFO_MUTEX      OSAL_MUTEX_REQUIRED
+#define CFG_FIFO_MUTEX      (OSAL_MUTEX_REQUIRED && !CFG_TUSB_FIFO_SPSC)
 
 #define CFG_TUSB_FIFO_HWFIFO_API (CFG_TUD_EDPT_DEDICATED_HWFIFO || CFG_TUH_EDPT_DEDICATED_HWFIFO)
 
@@ -106,7 +114,7 @@ typedef struct {
   volatile uint16_t wr_idx;     // write index
   volatile uint16_t rd_idx;     // read index
 
-#if OSAL_MUTEX_REQUIRED
+#if CFG_FIFO_MUTEX
   osal_mutex_t mutex_wr;
   osal_mutex_t mutex_rd;
 #endif
@@ -148,7 +156,7 @@ bool tu_fifo_config(tu_fifo_t *f, void *buffer, uint16_t depth, bool overwritabl
 void tu_fifo_set_overwritable(tu_fifo_t *f, bool overwritable);
 void tu_fifo_clear(tu_fifo_t *f);
 
-#if OSAL_MUTEX_REQUIRED
+#if CFG_FIFO_MUTEX
 TU_ATTR_ALWAYS_INLINE static inline
 void tu_fifo_config_mutex(tu_fifo_t *f, osal_mutex_t wr_mutex, osal_mutex_t rd_mutex) {
   f->mutex_wr = wr_mutex;
@@ -174,6 +182,19 @@ void tu_fifo_advance_read_pointer(tu_fifo_t *f, uint16_t n);
 void tu_fifo_get_read_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info);
 void tu_fifo_get_write_info(tu_fifo_t *f, tu_fifo_buffer_info_t *info);
 
+//--------------------------------------------------------------------+
+// Reserve/Commit API
+// Hand out up to n items as (up to) two linear spans so that producer/consumer can access the buffer in place,
+// then publish all items at once with commit. Commit count must not exceed the reserved count. Every reserve must be
+// followed by a commit (can be 0) since the corresponding mutex (if any) is held in between.
+// Write reserve never overwrites, even if fifo is overwritable.
+//--------------------------------------------------------------------+
+uint16_t tu_fifo_write_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n);
+void     tu_fifo_write_commit(tu_fifo_t *f, uint16_t n);
+
+uint16_t tu_fifo_read_reserve(tu_fifo_t *f, tu_fifo_buffer_info_t *info, uint16_t n);
+void     tu_fifo_read_commit(tu_fifo_t *f, uint16_t n);
+
 //--------------------------------------------------------------------+
 // Peek API
 // peek() will correct/re-index read pointer in case of an overflowed fifo to form a full fifo
@@ -206,6 +227,10 @@ TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_fifo_write_n(tu_fifo_t *f, const
   return tu_fifo_write_n_access_mode(f, data, n, NULL);
 }
 
+// keep first n items and discard the rest i.e move write pointer back to n items after read pointer with mutex
+// return number of discarded items
+uint16_t tu_fifo_truncate_n(tu_fifo_t *f, uint16_t n);
+
 //--------------------------------------------------------------------+
 // Hardware FIFO API
 // Special hardware FIFO/Buffer to hold USB data, usually requires certain access method these can be configured with
@@ -249,6 +274,39 @@ TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_ff_overflow_count(uint16_t depth
   }
 }
 
+// Index access: acquire/release in SPSC mode so that buffer contents are visible before the index that publishes them
+#if CFG_TUSB_FIFO_SPSC && (defined(__GNUC__) || defined(__clang__))
+TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_ff_load_idx(const volatile uint16_t *idx) {
+  return __atomic_load_n(idx, __ATOMIC_ACQUIRE);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void tu_ff_store_idx(volatile uint16_t *idx, uint16_t value) {
+  __atomic_store_n(idx, value, __ATOMIC_RELEASE);
+}
+#elif CFG_TUSB_FIFO_SPSC && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+  #include <stdatomic.h>
+TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_ff_load_idx(const volatile uint16_t *idx) {
+  const uint16_t value = *idx;
+  atomic_thread_fence(memory_order_acquire);
+  return value;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void tu_ff_store_idx(volatile uint16_t *idx, uint16_t value) {
+  atomic_thread_fence(memory_order_release);
+  *idx = value;
+}
+#elif CFG_TUSB_FIFO_SPSC
+  #error "CFG_TUSB_FIFO_SPSC requires GCC/Clang atomic builtins or C11 atomics"
+#else
+TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_ff_load_idx(const volatile uint16_t *idx) {
+  return *idx;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void tu_ff_store_idx(volatile uint16_t *idx, uint16_t value) {
+  *idx = value;
+}
+#endif
+
 // return remaining slot in fifo
 TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_ff_remaining_local(uint16_t depth, uint16_t wr_idx, uint16_t rd_idx) {
   const uint16_t ovf_count = tu_ff_overflow_count(depth, wr_idx, rd_idx);
@@ -265,28 +323,28 @@ TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_fifo_depth(const tu_fifo_t *f) {
 }
 
 TU_ATTR_ALWAYS_INLINE static inline bool tu_fifo_empty(const tu_fifo_t *f) {
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   return wr_idx == rd_idx;
 }
 
 // return number of items in fifo, capped to fifo's depth
 TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_fifo_count(const tu_fifo_t *f) {
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   return tu_min16(tu_ff_overflow_count(f->depth, wr_idx, rd_idx), f->depth);
 }
 
 // check if fifo is full
 TU_ATTR_ALWAYS_INLINE static inline bool tu_fifo_full(const tu_fifo_t *f) {
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   return tu_ff_overflow_count(f->depth, wr_idx, rd_idx) >= f->depth;
 }
 
 TU_ATTR_ALWAYS_INLINE static inline uint16_t tu_fifo_remaining(const tu_fifo_t *f) {
-  const uint16_t wr_idx = f->wr_idx;
-  const uint16_t rd_idx = f->rd_idx;
+  const uint16_t wr_idx = tu_ff_load_idx(&f->wr_idx);
+  const uint16_t rd_idx = tu_ff_load_idx(&f->rd_idx);
   return tu_ff_remaining_local(f->depth, wr_idx, rd_idx);
 }
 
@@ -43,8 +43,14 @@ typedef struct {
   uint8_t  *ep_buf; // set to NULL to use xfer_fifo when CFG_TUD_EDPT_DEDICATED_HWFIFO = 1
   tu_fifo_t ff;
 
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  uint16_t zc_len; // bytes of in-flight transfer submitted directly from/to fifo, 0 if ep_buf is used
+#endif
+
   // mutex: read if rx, otherwise write
+#if CFG_FIFO_MUTEX
   OSAL_MUTEX_DEF(ff_mutexdef);
+#endif
 }tu_edpt_stream_t;
 
 //--------------------------------------------------------------------+
@@ -71,6 +77,17 @@ bool tu_edpt_claim(volatile uint8_t* ep_state, osal_mutex_t mutex);
 // Release an endpoint with provided mutex
 bool tu_edpt_release(volatile uint8_t* ep_state, osal_mutex_t mutex);
 
+#if CFG_TUD_EDPT_STATS || CFG_TUH_EDPT_STATS
+// Record transfer submission in endpoint statistics
+TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stats_submit(tu_edpt_stats_t* stats) {
+  stats->submitted++;
+  stats->submit_cycle = tusb_cycle_count_api();
+}
+
+// Record transfer completion and its latency in endpoint statistics
+void tu_edpt_stats_complete(tu_edpt_stats_t* stats, uint8_t result, uint32_t xferred_bytes);
+#endif
+
 //--------------------------------------------------------------------+
 // Endpoint Stream
 //--------------------------------------------------------------------+
@@ -82,7 +99,7 @@ bool tu_edpt_stream_init(tu_edpt_stream_t *s, bool is_host, bool is_tx, bool ove
 // Deinit an endpoint stream
 TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_deinit(tu_edpt_stream_t *s) {
   (void)s;
-#if OSAL_MUTEX_REQUIRED
+#if CFG_FIFO_MUTEX
   if (s->ff.mutex_wr) {
     osal_mutex_delete(s->ff.mutex_wr);
   }
@@ -99,6 +116,7 @@ TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_open(tu_edpt_stream_t *s
   s->ep_addr = desc_ep->bEndpointAddress;
   s->mps = tu_edpt_packet_size(desc_ep);
   s->xfer_len = xfer_len;
+  // zero-copy span of a transfer still in flight from previous open is kept, see tu_edpt_stream_clear()
 }
 
 TU_ATTR_ALWAYS_INLINE static inline bool tu_edpt_stream_is_opened(const tu_edpt_stream_t *s) {
@@ -110,6 +128,19 @@ TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_close(tu_edpt_stream_t*
 }
 
 TU_ATTR_ALWAYS_INLINE static inline void tu_edpt_stream_clear(tu_edpt_stream_t *s) {
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  if (s->zc_len > 0) {
+    if (tu_edpt_dir(s->ep_addr) == TUSB_DIR_OUT) {
+      // controller is receiving into fifo: only discard already received data
+      tu_fifo_discard_n(&s->ff, tu_fifo_count(&s->ff));
+    } else {
+      // controller is sending from fifo: keep in-flight span at read pointer and drop data queued after it. Span is
+      // released by tu_edpt_stream_write_xfer() once transfer is complete
+      tu_fifo_truncate_n(&s->ff, s->zc_len);
+    }
+    return;
+  }
+#endif
   tu_fifo_clear(&s->ff);
 }
 
@@ -134,6 +165,15 @@ bool tu_edpt_stream_write_zlp_if_needed(tu_edpt_stream_t *s, uint32_t last_xferr
 // Note: if no fifo, return endpoint size if not busy, 0 otherwise
 uint32_t tu_edpt_stream_write_available(tu_edpt_stream_t *s);
 
+// Borrow up to n bytes of FIFO space as (up to) two linear spans to write in place. Must be followed by
+// tu_edpt_stream_write_commit() which publishes the first n written bytes and starts a transfer if needed.
+TU_ATTR_ALWAYS_INLINE static inline
+uint32_t tu_edpt_stream_write_reserve(tu_edpt_stream_t *s, tu_fifo_buffer_info_t *info, uint32_t n) {
+  return tu_fifo_write_reserve(&s->ff, info, (uint16_t) tu_min32(n, UINT16_MAX));
+}
+
+uint32_t tu_edpt_stream_write_commit(tu_edpt_stream_t *s, uint32_t n);
+
 //--------------------------------------------------------------------+
 // Stream Read
 //--------------------------------------------------------------------+
@@ -144,9 +184,26 @@ uint32_t tu_edpt_stream_read(tu_edpt_stream_t *s, void *buffer, uint32_t bufsize
 // Start an usb transfer if endpoint is not busy
 uint32_t tu_edpt_stream_read_xfer(tu_edpt_stream_t *s);
 
+// Borrow up to n received bytes as (up to) two linear spans to read in place. Must be followed by
+// tu_edpt_stream_read_commit() which consumes the first n bytes and prepares for more data.
+TU_ATTR_ALWAYS_INLINE static inline
+uint32_t tu_edpt_stream_read_reserve(tu_edpt_stream_t *s, tu_fifo_buffer_info_t *info, uint32_t n) {
+  return tu_fifo_read_reserve(&s->ff, info, (uint16_t) tu_min32(n, UINT16_MAX));
+}
+
+void tu_edpt_stream_read_commit(tu_edpt_stream_t *s, uint32_t n);
+
 // Complete read transfer by writing EP -> FIFO. Must be called in the transfer complete callback
 TU_ATTR_ALWAYS_INLINE static inline
 void tu_edpt_stream_read_xfer_complete(tu_edpt_stream_t* s, uint32_t xferred_bytes) {
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  if (s->zc_len > 0) {
+    // received directly into fifo
+    tu_fifo_advance_write_pointer(&s->ff, (uint16_t) xferred_bytes);
+    s->zc_len = 0;
+    return;
+  }
+#endif
   if (s->ep_buf != NULL) {
     tu_fifo_write_n(&s->ff, s->ep_buf, (uint16_t)xferred_bytes);
   }
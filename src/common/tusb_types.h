@@ -269,6 +269,35 @@ typedef enum {
 
 #define tusb_xfer_result_t xfer_result_t
 
+// One segment of a scatter/gather transfer
+typedef struct {
+  uint8_t* buf;
+  uint16_t len;
+} tu_edpt_seg_t;
+
+// One packet of an isochronous frame list
+typedef struct {
+  uint16_t length;     // requested bytes
+  uint16_t actual_len; // transferred bytes, updated on completion
+  uint8_t  result;     // xfer_result_t of this packet, updated on completion
+} tu_iso_packet_t;
+
+// Endpoint transfer statistics, see CFG_TUD_EDPT_STATS and CFG_TUH_EDPT_STATS
+#define TU_EDPT_STATS_HIST_BINS  24
+
+typedef struct {
+  uint32_t submitted;    // transfers submitted to controller driver
+  uint32_t completed;    // transfers completed, including failed ones
+  uint32_t stalls;       // stall issued (device) or completed with STALLED result
+  uint32_t errors;       // completed with FAILED, TIMEOUT or INVALID result
+  uint64_t bytes;        // bytes moved by completed transfers
+  uint32_t submit_cycle; // tusb_cycle_count_api() at last submission
+
+  // submit to complete latency: bin n counts latency in [2^n, 2^(n+1)) cycles, bin 0 also counts 0 and the last bin
+  // is open ended
+  uint32_t latency_hist[TU_EDPT_STATS_HIST_BINS];
+} tu_edpt_stats_t;
+
 // TODO remove
 enum {
   DESC_OFFSET_LEN  = 0,
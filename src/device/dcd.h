@@ -148,6 +148,13 @@ bool dcd_edpt_xfer            (uint8_t rhport, uint8_t ep_addr, uint8_t * buffer
 // This API is optional, may be useful for register-based for transferring data.
 bool dcd_edpt_xfer_fifo       (uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16_t total_bytes, bool is_isr);
 
+#ifdef TUP_DCD_EDPT_XFER_SG
+// Submit a scatter/gather transfer of count segments, e.g. chained DMA descriptors. Segment list must stay valid
+// until complete. dcd_event_xfer_complete() is invoked once with the total number of bytes of all segments.
+// Hook for ports only: no DCD implements it yet, usbd emulates it with one dcd_edpt_xfer() per segment.
+bool dcd_edpt_xfer_sg         (uint8_t rhport, uint8_t ep_addr, tu_edpt_seg_t const * segs, uint8_t count, bool is_isr);
+#endif
+
 // Stall endpoint, any queuing transfer should be removed from endpoint
 void dcd_edpt_stall           (uint8_t rhport, uint8_t ep_addr);
 
@@ -155,6 +162,10 @@ void dcd_edpt_stall           (uint8_t rhport, uint8_t ep_addr);
 // This API never calls with control endpoints, since it is auto cleared when receiving setup packet
 void dcd_edpt_clear_stall     (uint8_t rhport, uint8_t ep_addr);
 
+// Abort transfer in progress without reporting its completion, endpoint stays open and data toggle is kept.
+// Optional: default implementation stalls then clears stall, which also resets data toggle to DATA0
+void dcd_edpt_abort_xfer      (uint8_t rhport, uint8_t ep_addr);
+
 #ifdef TUP_DCD_EDPT_CLOSE_API
 // Close an endpoint.
 void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr);
@@ -107,6 +107,14 @@ typedef struct {
   usbd_control_xfer_cb_t complete_cb;
 } usbd_control_xfer_t;
 
+// Scatter/gather emulation: segments are submitted one by one, count = 0 if not active
+typedef struct {
+  tu_edpt_seg_t const* segs;
+  uint32_t xferred;
+  uint8_t count;
+  uint8_t idx;
+} usbd_edpt_sg_t;
+
 typedef struct {
   usbd_control_xfer_t ctrl_xfer;
 
@@ -131,9 +139,50 @@ typedef struct {
   uint8_t ep2drv[CFG_TUD_ENDPPOINT_MAX][2]; // map endpoint to driver ( 0xff is invalid ), can use only 4-bit each
 
   volatile uint8_t ep_status[CFG_TUD_ENDPPOINT_MAX][2];
+
+#if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  usbd_edpt_sg_t ep_sg[CFG_TUD_ENDPPOINT_MAX][2];
+#endif
 } usbd_device_t;
 
 static usbd_device_t    _usbd_dev;
+
+#if CFG_TUD_EDPT_STATS
+// kept across bus reset, cleared by tud_edpt_stats_clear()
+static tu_edpt_stats_t _usbd_ep_stats[CFG_TUD_ENDPPOINT_MAX][2];
+#endif
+
+TU_ATTR_ALWAYS_INLINE static inline void edpt_stats_submit(uint8_t ep_addr) {
+#if CFG_TUD_EDPT_STATS
+  tu_edpt_stats_submit(&_usbd_ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)]);
+#else
+  (void) ep_addr;
+#endif
+}
+
+// transfer is rejected by dcd
+TU_ATTR_ALWAYS_INLINE static inline void edpt_stats_error(uint8_t ep_addr) {
+#if CFG_TUD_EDPT_STATS
+  _usbd_ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)].errors++;
+#else
+  (void) ep_addr;
+#endif
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void edpt_stats_stall(uint8_t ep_addr) {
+#if CFG_TUD_EDPT_STATS
+  _usbd_ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)].stalls++;
+#else
+  (void) ep_addr;
+#endif
+}
+
+static void edpt0_stall(uint8_t rhport) {
+  dcd_edpt_stall(rhport, TU_EP0_OUT);
+  dcd_edpt_stall(rhport, TU_EP0_IN);
+  edpt_stats_stall(TU_EP0_OUT);
+  edpt_stats_stall(TU_EP0_IN);
+}
 static volatile uint8_t _usbd_queued_setup;
 
 CFG_TUD_MEM_SECTION static struct {
@@ -399,6 +448,12 @@ static OSAL_SPINLOCK_DEF(_usbd_spin, usbd_int_set);
 OSAL_QUEUE_DEF(usbd_int_set, _usbd_qdef, CFG_TUD_TASK_QUEUE_SZ, dcd_event_t);
 static osal_queue_t _usbd_q;
 
+// User SOF events are coalesced: at most one is queued, it reports the latest frame count when processed.
+// XFER_COMPLETE is never merged: endpoint stays busy until its completion is processed, and each one carries its own
+// transfer length and result
+static volatile bool _usbd_sof_queued = false;
+static volatile uint32_t _usbd_sof_frame_count;
+
 // Mutex for claiming endpoint
 #if OSAL_MUTEX_REQUIRED
   static osal_mutex_def_t _ubsd_mutexdef;
@@ -450,6 +505,41 @@ TU_ATTR_WEAK bool dcd_configure(uint8_t rhport, uint32_t cfg_id, const void* cfg
   return false;
 }
 
+// port without native abort: stall removes queued transfer, clearing it also resets data toggle.
+// Never invoked on stalled endpoint
+TU_ATTR_WEAK void dcd_edpt_abort_xfer(uint8_t rhport, uint8_t ep_addr) {
+  dcd_edpt_stall(rhport, ep_addr);
+  dcd_edpt_clear_stall(rhport, ep_addr);
+}
+
+//--------------------------------------------------------------------+
+// Scatter/Gather emulation for DCD without TUP_DCD_EDPT_XFER_SG
+//--------------------------------------------------------------------+
+#if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+// Called on completion of a segment: submit the next one and return true. Otherwise (last segment, short
+// packet or error) update event to the result of the whole transfer and return false.
+static bool edpt_sg_advance(dcd_event_t* event, bool in_isr) {
+  uint8_t const ep_addr = event->xfer_complete.ep_addr;
+  usbd_edpt_sg_t* sg = &_usbd_dev.ep_sg[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+  tu_edpt_seg_t const* seg = &sg->segs[sg->idx];
+  sg->xferred += event->xfer_complete.len;
+
+  if (event->xfer_complete.result == XFER_RESULT_SUCCESS && event->xfer_complete.len == seg->len &&
+      sg->idx + 1u < sg->count) {
+    sg->idx++;
+    seg++;
+    if (dcd_edpt_xfer(event->rhport, ep_addr, seg->buf, seg->len, in_isr)) {
+      return true;
+    }
+    event->xfer_complete.result = XFER_RESULT_FAILED;
+  }
+
+  event->xfer_complete.len = sg->xferred;
+  sg->count = 0;
+  return false;
+}
+#endif
+
 //--------------------------------------------------------------------+
 // Debug
 //--------------------------------------------------------------------+
@@ -508,6 +598,26 @@ void tud_sof_cb_enable(bool en) {
   usbd_sof_enable(_usbd_rhport, SOF_CONSUMER_USER, en);
 }
 
+#if CFG_TUD_EDPT_STATS
+bool tud_edpt_stats_get(uint8_t ep_addr, tu_edpt_stats_t* stats) {
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  TU_VERIFY(tud_inited() && epnum < CFG_TUD_ENDPPOINT_MAX && stats != NULL);
+
+  // snapshot since statistics are updated in ISR
+  usbd_spin_lock(false);
+  *stats = _usbd_ep_stats[epnum][tu_edpt_dir(ep_addr)];
+  usbd_spin_unlock(false);
+  return true;
+}
+
+void tud_edpt_stats_clear(void) {
+  TU_VERIFY(tud_inited(), );
+  usbd_spin_lock(false);
+  tu_memclr(_usbd_ep_stats, sizeof(_usbd_ep_stats));
+  usbd_spin_unlock(false);
+}
+#endif
+
 bool tud_inited(void) {
   return _usbd_rhport != RHPORT_INVALID;
 }
@@ -560,6 +670,7 @@ bool tud_rhport_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
   // Init device queue & task
   _usbd_q = osal_queue_create(&_usbd_qdef);
   TU_ASSERT(_usbd_q);
+  _usbd_sof_queued = false;
 
   // Get application driver if available
   _app_driver = usbd_app_driver_get_cb(&_app_driver_count);
@@ -674,6 +785,12 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
     return;
   }
 
+  // Events are taken from queue in batch of CFG_TUD_TASK_EVENT_BATCH to save queue locking. Only user SOF events are
+  // coalesced (in dcd_event_handler), every other event in a batch is processed on its own
+  dcd_event_t batch[CFG_TUD_TASK_EVENT_BATCH];
+  uint16_t batch_count = 0;
+  uint16_t batch_idx = 0;
+
   // Loop until there are no more events in the queue or CFG_TUD_TASK_EVENTS_PER_RUN is reached
   for (unsigned epr = 0;; epr++) {
 #if CFG_TUD_TASK_EVENTS_PER_RUN > 0
@@ -682,10 +799,19 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
       break;
     }
 #endif
-    dcd_event_t event;
-    if (!osal_queue_receive(_usbd_q, &event, timeout_ms)) {
-      return;
+    if (batch_idx == batch_count) {
+      uint16_t max_count = CFG_TUD_TASK_EVENT_BATCH;
+#if CFG_TUD_TASK_EVENTS_PER_RUN > 0
+      // do not take more than can be processed in this run
+      max_count = (uint16_t) tu_min32(max_count, CFG_TUD_TASK_EVENTS_PER_RUN - epr);
+#endif
+      batch_count = osal_queue_receive_n(_usbd_q, batch, sizeof(dcd_event_t), max_count, timeout_ms);
+      batch_idx = 0;
+      if (batch_count == 0) {
+        return;
+      }
     }
+    dcd_event_t event = batch[batch_idx++];
 
 #if CFG_TUSB_DEBUG >= CFG_TUD_LOG_LEVEL
     if (event.event_id == DCD_EVENT_SETUP_RECEIVED) {
@@ -730,8 +856,7 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
         if (!process_setup_received(event.rhport, &event.setup_received)) {
           TU_LOG_USBD("  Stall EP0\r\n");
           // Failed -> stall both control endpoint IN and OUT
-          dcd_edpt_stall(event.rhport, TU_EP0_OUT);
-          dcd_edpt_stall(event.rhport, TU_EP0_IN);
+          edpt0_stall(event.rhport);
         }
         break;
 
@@ -750,7 +875,11 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
           usbd_control_xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result, event.xfer_complete.len);
         } else {
           usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
-          TU_ASSERT(driver,);
+          if (driver == NULL) {
+            // stray completion: skip only this event, the rest of the batch is already taken from queue
+            TU_LOG_USBD("  No driver for EP %02X\r\n", ep_addr);
+            break;
+          }
 
           TU_LOG_USBD("  %s xfer callback\r\n", driver->name);
           driver->xfer_cb(event.rhport, ep_addr, (xfer_result_t) event.xfer_complete.result, event.xfer_complete.len);
@@ -786,12 +915,16 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
         }
         break;
 
-      case DCD_EVENT_SOF:
+      case DCD_EVENT_SOF: {
+        // read frame count before allowing ISR to queue next SOF
+        uint32_t const frame_count = _usbd_sof_frame_count;
+        _usbd_sof_queued = false;
         if (tu_bit_test(_usbd_dev.sof_consumer, SOF_CONSUMER_USER)) {
           TU_LOG_USBD("\r\n");
-          tud_sof_cb(event.sof.frame_count);
+          tud_sof_cb(frame_count);
         }
-      break;
+        break;
+      }
 
       default:
         TU_BREAKPOINT();
@@ -922,8 +1055,7 @@ static bool usbd_control_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t
       TU_ASSERT(status_stage_xact(rhport, ep_status));
     } else {
       // Stall both IN and OUT control endpoint
-      dcd_edpt_stall(rhport, TU_EP0_OUT);
-      dcd_edpt_stall(rhport, TU_EP0_IN);
+      edpt0_stall(rhport);
     }
   } else {
     // More data to transfer
@@ -1385,6 +1517,9 @@ static bool process_get_descriptor(uint8_t rhport, tusb_control_request_t const
 //--------------------------------------------------------------------+
 TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr) {
   bool send = false;
+#if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  dcd_event_t sg_event;
+#endif
   switch (event->event_id) {
     case DCD_EVENT_UNPLUGGED:
       _usbd_dev.connected = 0;
@@ -1432,8 +1567,12 @@ TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr)
       }
 
       if (tu_bit_test(_usbd_dev.sof_consumer, SOF_CONSUMER_USER)) {
-        dcd_event_t const event_sof = {.rhport = event->rhport, .event_id = DCD_EVENT_SOF, .sof.frame_count = event->sof.frame_count};
-        queue_event(&event_sof, in_isr);
+        // coalesce with SOF not yet processed by task
+        _usbd_sof_frame_count = event->sof.frame_count;
+        if (!_usbd_sof_queued) {
+          dcd_event_t const event_sof = {.rhport = event->rhport, .event_id = DCD_EVENT_SOF, .sof.frame_count = event->sof.frame_count};
+          _usbd_sof_queued = queue_event(&event_sof, in_isr);
+        }
       }
       break;
 
@@ -1449,6 +1588,20 @@ TU_ATTR_FAST_FUNC void dcd_event_handler(dcd_event_t const* event, bool in_isr)
       uint8_t const ep_dir = tu_edpt_dir(ep_addr);
 
       send = true;
+      #if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+      if (epnum > 0 && epnum < CFG_TUD_ENDPPOINT_MAX && _usbd_dev.ep_sg[epnum][ep_dir].count > 0) {
+        sg_event = *event;
+        if (edpt_sg_advance(&sg_event, in_isr)) {
+          return; // next segment submitted, endpoint is still busy
+        }
+        event = &sg_event;
+      }
+      #endif
+
+      #if CFG_TUD_EDPT_STATS
+      tu_edpt_stats_complete(&_usbd_ep_stats[epnum][ep_dir], event->xfer_complete.result, event->xfer_complete.len);
+      #endif
+
       if(epnum > 0) {
         usbd_class_driver_t const* driver = get_driver(_usbd_dev.ep2drv[epnum][ep_dir]);
 
@@ -1584,12 +1737,14 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t t
   // Set busy first since the actual transfer can be complete before dcd_edpt_xfer()
   // could return and USBD task can preempt and clear the busy
   _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
+  edpt_stats_submit(ep_addr);
 
   if (dcd_edpt_xfer(rhport, ep_addr, buffer, total_bytes, is_isr)) {
     return true;
   } else {
     // DCD error, mark endpoint as ready to allow next transfer
     _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+    edpt_stats_error(ep_addr);
     TU_LOG_USBD("FAILED\r\n");
     TU_BREAKPOINT();
     return false;
@@ -1615,6 +1770,7 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   // Set busy first since the actual transfer can be complete before dcd_edpt_xfer() could return
   // and usbd task can preempt and clear the busy
   _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
+  edpt_stats_submit(ep_addr);
 
   if (dcd_edpt_xfer_fifo(rhport, ep_addr, ff, total_bytes, is_isr)) {
     TU_LOG_USBD("OK\r\n");
@@ -1622,6 +1778,7 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   } else {
     // DCD error, mark endpoint as ready to allow next transfer
     _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+    edpt_stats_error(ep_addr);
     TU_LOG_USBD("failed\r\n");
     TU_BREAKPOINT();
     return false;
@@ -1636,6 +1793,50 @@ bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_
   #endif
 }
 
+#if CFG_TUD_EDPT_XFER_SG
+bool usbd_edpt_xfer_sg(uint8_t rhport, uint8_t ep_addr, tu_edpt_seg_t const* segs, uint8_t count, bool is_isr) {
+  rhport = _usbd_rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+
+  TU_ASSERT(epnum > 0 && count > 0);
+  TU_LOG_USBD("  Queue SG EP %02X with %u segments ...\r\n", ep_addr, count);
+
+  // Attempt to transfer on a busy endpoint, sound like an race condition !
+  TU_ASSERT((_usbd_dev.ep_status[epnum][dir] & TU_EDPT_STATE_BUSY) == 0);
+
+  // Set busy first since the actual transfer can be complete before dcd_edpt_xfer()
+  // could return and USBD task can preempt and clear the busy
+  _usbd_dev.ep_status[epnum][dir] |= TU_EDPT_STATE_BUSY;
+  edpt_stats_submit(ep_addr);
+
+  #ifdef TUP_DCD_EDPT_XFER_SG
+  bool const ok = dcd_edpt_xfer_sg(rhport, ep_addr, segs, count, is_isr);
+  #else
+  usbd_edpt_sg_t* sg = &_usbd_dev.ep_sg[epnum][dir];
+  sg->segs = segs;
+  sg->xferred = 0;
+  sg->idx = 0;
+  sg->count = count;
+
+  bool const ok = dcd_edpt_xfer(rhport, ep_addr, segs[0].buf, segs[0].len, is_isr);
+  if (!ok) {
+    sg->count = 0;
+  }
+  #endif
+
+  if (!ok) {
+    // DCD error, mark endpoint as ready to allow next transfer
+    _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+    edpt_stats_error(ep_addr);
+    TU_LOG_USBD("FAILED\r\n");
+    TU_BREAKPOINT();
+  }
+  return ok;
+}
+#endif
+
 bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr) {
   (void) rhport;
 
@@ -1654,7 +1855,11 @@ void usbd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
   // only stalled if currently cleared
   TU_LOG_USBD("    Stall EP %02X\r\n", ep_addr);
   dcd_edpt_stall(rhport, ep_addr);
+  edpt_stats_stall(ep_addr);
   _usbd_dev.ep_status[epnum][dir] |= (TU_EDPT_STATE_STALLED | TU_EDPT_STATE_BUSY);
+#if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  _usbd_dev.ep_sg[epnum][dir].count = 0; // stall removes queued transfer
+#endif
 }
 
 void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
@@ -1680,6 +1885,24 @@ void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
   _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~clear_mask;
 }
 
+void usbd_edpt_abort(uint8_t rhport, uint8_t ep_addr) {
+  rhport = _usbd_rhport;
+
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  uint8_t const dir = tu_edpt_dir(ep_addr);
+
+  TU_LOG_USBD("    Abort EP %02X\r\n", ep_addr);
+  // stall already removed queued transfer
+  if ((_usbd_dev.ep_status[epnum][dir] & TU_EDPT_STATE_STALLED) == 0) {
+    dcd_edpt_abort_xfer(rhport, ep_addr);
+  }
+  // no completion event follows an aborted transfer: release busy and claim here
+  _usbd_dev.ep_status[epnum][dir] &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+#if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  _usbd_dev.ep_sg[epnum][dir].count = 0;
+#endif
+}
+
 bool usbd_edpt_stalled(uint8_t rhport, uint8_t ep_addr) {
   (void) rhport;
 
@@ -1707,6 +1930,9 @@ void usbd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
 
   dcd_edpt_close(rhport, ep_addr);
   _usbd_dev.ep_status[epnum][dir] = 0;
+  #if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  _usbd_dev.ep_sg[epnum][dir].count = 0;
+  #endif
 #endif
 
   return;
@@ -1752,6 +1978,9 @@ bool usbd_edpt_iso_activate(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep)
   TU_ASSERT(tu_edpt_validate(desc_ep, (tusb_speed_t)_usbd_dev.speed));
 
   _usbd_dev.ep_status[epnum][dir] = 0;
+  #if CFG_TUD_EDPT_XFER_SG && !defined(TUP_DCD_EDPT_XFER_SG)
+  _usbd_dev.ep_sg[epnum][dir].count = 0;
+  #endif
   return dcd_edpt_iso_activate(rhport, desc_ep);
 #else
   (void) rhport; (void) desc_ep;
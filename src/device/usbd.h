@@ -122,6 +122,15 @@ bool tud_connect(void);
 // Enable or disable the Start Of Frame callback support
 void tud_sof_cb_enable(bool en);
 
+#if CFG_TUD_EDPT_STATS
+// Get transfer statistics of an endpoint. Latency is measured from submission to completion reported by the
+// controller driver, which excludes time spent in event queue and class callback.
+bool tud_edpt_stats_get(uint8_t ep_addr, tu_edpt_stats_t* stats);
+
+// Reset statistics of all endpoints
+void tud_edpt_stats_clear(void);
+#endif
+
 // Carry out Data and Status stage of control transfer
 // - If len = 0, it is equivalent to sending status only
 // - If len > wLength : it will be truncated
@@ -177,7 +186,8 @@ void tud_resume_cb(void);
 // Invoked when there is a new usb event, which need to be processed by tud_task()/tud_task_ext()
 void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr);
 
-// Invoked when a new (micro) frame started
+// Invoked when a new (micro) frame started. SOFs arriving before tud_task() processes the previous one are
+// coalesced, frame_count is then the latest one.
 void tud_sof_cb(uint32_t frame_count);
 
 // Invoked when received control request with VENDOR TYPE
@@ -278,6 +288,29 @@ bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_requ
   /* Endpoint In */\
   7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0
 
+// Length of template descriptor: BOT alternate 0 (23 bytes) + UAS alternate 1 (53 bytes)
+#define TUD_MSC_UAS_DESC_LEN    (TUD_MSC_DESC_LEN + 9 + 4*(7+4))
+
+// MSC with BOT (alternate 0) and USB Attached SCSI (alternate 1). UAS uses its own 4 pipes:
+// command out, status in, data in and data out, each followed by a Pipe Usage descriptor.
+// Interface number, string index, BOT EP Out & EP In address, UAS command, status, data in, data out address, EP size
+#define TUD_MSC_UAS_DESCRIPTOR(_itfnum, _stridx, _epout, _epin, _epcmd, _epstatus, _epdin, _epdout, _epsize) \
+  TUD_MSC_DESCRIPTOR(_itfnum, _stridx, _epout, _epin, _epsize),\
+  /* Interface alternate 1 */\
+  9, TUSB_DESC_INTERFACE, _itfnum, 1, 4, TUSB_CLASS_MSC, MSC_SUBCLASS_SCSI, MSC_PROTOCOL_UAS, _stridx,\
+  /* Command pipe */\
+  7, TUSB_DESC_ENDPOINT, _epcmd, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_COMMAND, 0,\
+  /* Status pipe */\
+  7, TUSB_DESC_ENDPOINT, _epstatus, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_STATUS, 0,\
+  /* Data in pipe */\
+  7, TUSB_DESC_ENDPOINT, _epdin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_DATA_IN, 0,\
+  /* Data out pipe */\
+  7, TUSB_DESC_ENDPOINT, _epdout, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0,\
+  4, MSC_UAS_DESC_PIPE_USAGE, MSC_UAS_PIPE_DATA_OUT, 0
+
 //--------------------------------------------------------------------+
 // Printer Descriptor Templates
 //--------------------------------------------------------------------+
@@ -72,6 +72,14 @@ bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t * buffer, uint16_t
 // Submit a usb ISO transfer by use of a FIFO (ring buffer) - all bytes in FIFO get transmitted
 bool usbd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t * ff, uint16_t total_bytes, bool is_isr);
 
+#if CFG_TUD_EDPT_XFER_SG
+// Submit a scatter/gather transfer of count segments (non-control endpoint only), completed with a single
+// xfer_cb() with total bytes of all segments which can exceed 64 KiB. Segment list must stay valid until
+// complete. All segments except the last must be a multiple of endpoint size. An OUT transfer ends early
+// on a short packet.
+bool usbd_edpt_xfer_sg(uint8_t rhport, uint8_t ep_addr, tu_edpt_seg_t const * segs, uint8_t count, bool is_isr);
+#endif
+
 // Claim an endpoint before submitting a transfer.
 // If caller does not make any transfer, it must release endpoint for others.
 bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr);
@@ -88,6 +96,10 @@ void usbd_edpt_stall(uint8_t rhport, uint8_t ep_addr);
 // Clear stalled endpoint
 void usbd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr);
 
+// Abort transfer in progress on an opened endpoint without invoking xfer_cb(), data toggle and stall are kept.
+// Completion already queued before this call may still be delivered
+void usbd_edpt_abort(uint8_t rhport, uint8_t ep_addr);
+
 // Check if endpoint is stalled
 bool usbd_edpt_stalled(uint8_t rhport, uint8_t ep_addr);
 
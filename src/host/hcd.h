@@ -145,6 +145,13 @@ bool hcd_edpt_close(uint8_t rhport, uint8_t daddr, uint8_t ep_addr);
 // Submit a transfer, when complete hcd_event_xfer_complete() must be invoked
 bool hcd_edpt_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t * buffer, uint16_t buflen);
 
+// Submit an isochronous transfer of a frame list, optional for HCD supporting isochronous. Packets are back to back
+// in buffer, one per service interval. HCD should accept a second transfer while one is in progress and schedule it
+// right after, so that the stream has no gap. Transfers complete in submission order, per-packet actual_len and
+// result must be updated before hcd_event_xfer_complete() is invoked.
+bool hcd_edpt_iso_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, tu_iso_packet_t* packets,
+                       uint16_t packet_count);
+
 // Abort a queued transfer. Note: it can only abort transfer that has not been started
 // Return true if a queued transfer is aborted, false if there is no transfer to abort
 bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr);
@@ -31,6 +31,12 @@ typedef struct {
   // uint16_t wHubCharacteristics;
   bool mtt;
   hub_port_status_response_t port_status;
+  tuh_xfer_cb_t port_status_cb; // user callback of intercepted port status request
+
+  // status change scan: bit 0 is the hub, bit n is port n
+  uint32_t scan_bm;    // changes reported by interrupt endpoint, not yet processed
+  uint16_t change_bm;  // change bits of the hub/port being processed, not yet cleared
+  bool     conn_change;
 } hub_interface_t;
 
 typedef struct {
@@ -38,7 +44,6 @@ typedef struct {
   TUH_EPBUF_DEF(ctrl_buf, CFG_TUH_HUB_BUFSIZE);
 } hub_epbuf_t;
 
-static tuh_xfer_cb_t user_complete_cb = NULL;
 static hub_interface_t hub_itfs[CFG_TUH_HUB];
 CFG_TUH_MEM_SECTION static hub_epbuf_t hub_epbufs[CFG_TUH_HUB];
 
@@ -130,13 +135,13 @@ bool hub_port_set_feature(uint8_t hub_addr, uint8_t hub_port, uint8_t feature,
 }
 
 static void port_get_status_complete (tuh_xfer_t* xfer) {
+  hub_interface_t* p_hub = get_hub_itf(xfer->daddr);
   if (xfer->result == XFER_RESULT_SUCCESS) {
-    hub_interface_t* p_hub = get_hub_itf(xfer->daddr);
     p_hub->port_status = *((const hub_port_status_response_t *) (uintptr_t) xfer->buffer);
   }
 
-  xfer->complete_cb = user_complete_cb;
-  user_complete_cb = NULL;
+  xfer->complete_cb = p_hub->port_status_cb;
+  p_hub->port_status_cb = NULL;
   if (xfer->complete_cb) {
     xfer->complete_cb(xfer);
   }
@@ -165,14 +170,13 @@ bool hub_port_get_status(uint8_t hub_addr, uint8_t hub_port, void* resp,
     .user_data   = user_data
   };
 
-  if (hub_port != 0) {
-    // intercept complete callback to save port status, ignore resp
+  if (hub_port != 0 && resp == NULL) {
+    // intercept complete callback to save port status
+    hub_interface_t* p_hub = get_hub_itf(hub_addr);
     hub_epbuf_t* p_epbuf = get_hub_epbuf(hub_addr);
     xfer.complete_cb = port_get_status_complete;
     xfer.buffer = p_epbuf->ctrl_buf;
-    user_complete_cb = complete_cb;
-  } else {
-    user_complete_cb = NULL;
+    p_hub->port_status_cb = complete_cb;
   }
 
   TU_LOG_DRV("HUB Get Port Status: addr = %u port = %u\r\n", hub_addr, hub_port);
@@ -250,8 +254,11 @@ bool hub_edpt_status_xfer(uint8_t daddr) {
   hub_interface_t* p_hub = get_hub_itf(daddr);
   hub_epbuf_t* p_epbuf = get_hub_epbuf(daddr);
 
+  // bitmap of hub + all ports, up to the size of status_change buffer
+  const uint16_t len = (uint16_t) tu_min8((uint8_t) ((p_hub->bNbrPorts + 8) / 8), sizeof(p_epbuf->status_change));
+
   TU_VERIFY(usbh_edpt_claim(daddr, p_hub->ep_in));
-  if (!usbh_edpt_xfer(daddr, p_hub->ep_in, p_epbuf->status_change, 1)) {
+  if (!usbh_edpt_xfer(daddr, p_hub->ep_in, p_epbuf->status_change, len)) {
     usbh_edpt_release(daddr, p_hub->ep_in);
     return false;
   }
@@ -347,20 +354,42 @@ static void config_port_power_complete (tuh_xfer_t* xfer) {
 
 //--------------------------------------------------------------------+
 // Connection Changes
+// All changes reported by the interrupt endpoint are processed in one scan: for the hub and each changed port,
+// get its status then clear all of its change bits back to back. The interrupt endpoint is only re-armed when the
+// scan is complete. Each hub has its own scan, hubs in a tier are scanned in parallel.
 //--------------------------------------------------------------------+
 enum {
   STATE_IDLE = 0,
   STATE_HUB_STATUS,
+  STATE_PORT_STATUS,
   STATE_CLEAR_CHANGE,
-  STATE_CHECK_CONN,
-  STATE_COMPLETE
 };
 
 static void process_new_status(tuh_xfer_t* xfer);
 
+// Start processing next hub/port in the scan bitmap. Return false if scan is complete or failed
+static bool scan_next(uint8_t daddr) {
+  hub_interface_t* p_hub = get_hub_itf(daddr);
+
+  for (uint8_t port = 0; p_hub->scan_bm != 0; port++) {
+    if (!tu_bit_test(p_hub->scan_bm, port)) {
+      continue;
+    }
+    p_hub->scan_bm = tu_bit_clear(p_hub->scan_bm, port);
+
+    if (port == 0) {
+      // Hub bit 0 is for the hub device events
+      return hub_get_status(daddr, get_hub_epbuf(daddr)->ctrl_buf, process_new_status, STATE_HUB_STATUS);
+    } else if (port <= p_hub->bNbrPorts) {
+      return hub_port_get_status(daddr, port, NULL, process_new_status, STATE_PORT_STATUS);
+    }
+  }
+
+  return false;
+}
+
 // callback as response of interrupt endpoint polling
 bool hub_xfer_cb(uint8_t daddr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
-  (void) xferred_bytes;
   (void) ep_addr;
 
   bool processed = false; // true if new status is processed
@@ -368,28 +397,19 @@ bool hub_xfer_cb(uint8_t daddr, uint8_t ep_addr, xfer_result_t result, uint32_t
   if (result == XFER_RESULT_SUCCESS) {
     hub_interface_t* p_hub = get_hub_itf(daddr);
     hub_epbuf_t *p_epbuf = get_hub_epbuf(daddr);
-    const uint8_t status_change = p_epbuf->status_change[0];
-    TU_LOG_DRV("  Hub Status Change = 0x%02X\r\n", status_change);
-
-    if (status_change == 0) {
-      // The status change event was neither for the hub, nor for any of its ports.
-      // This shouldn't happen, but it does with some devices. Re-Initiate the interrupt poll.
-      processed = false;
-    } else if (tu_bit_test(status_change, 0)) {
-      // Hub bit 0 is for the hub device events
-      processed = hub_get_status(daddr, p_epbuf->ctrl_buf, process_new_status, STATE_HUB_STATUS);
-    } else {
-      // Hub bits 1 to n are hub port events
-      for (uint8_t port=1; port <= p_hub->bNbrPorts; port++) {
-        if (tu_bit_test(status_change, port)) {
-          processed = hub_port_get_status(daddr, port, NULL, process_new_status, STATE_CLEAR_CHANGE);
-          break; // after completely processed one port, we will re-queue the status poll and handle next one
-        }
-      }
+
+    p_hub->scan_bm = 0;
+    for (uint32_t i = 0; i < tu_min32(xferred_bytes, sizeof(p_epbuf->status_change)); i++) {
+      p_hub->scan_bm |= ((uint32_t) p_epbuf->status_change[i]) << (8 * i);
     }
+    TU_LOG_DRV("  Hub Status Change = 0x%08" PRIX32 "\r\n", p_hub->scan_bm);
+
+    // The status change event may be neither for the hub, nor for any of its ports.
+    // This shouldn't happen, but it does with some devices. Re-Initiate the interrupt poll.
+    processed = scan_next(daddr);
   }
 
-  // If new status event is processed: next status pool is queued by usbh.c after handled this request
+  // If new status event is processed: next status pool is queued when the scan is complete
   // Otherwise re-queue the status poll here
   if (!processed) {
     TU_ASSERT(hub_edpt_status_xfer(daddr));
@@ -409,72 +429,61 @@ static void process_new_status(tuh_xfer_t* xfer) {
   const uint8_t port_num = (uint8_t) tu_le16toh(xfer->setup->wIndex);
   hub_interface_t *p_hub = get_hub_itf(daddr);
   const uintptr_t state = xfer->user_data;
-  bool processed = false; // true if new status is processed
 
   switch (state) {
     case STATE_HUB_STATUS: {
       hub_status_response_t hub_status = *((const hub_status_response_t *) (uintptr_t) xfer->buffer);
       TU_LOG_DRV("HUB Got hub status, addr = %u, status = %04x\r\n", daddr, hub_status.change.value);
-      if (hub_status.change.local_power_source) {
-        TU_LOG_DRV("  Local Power Change\r\n");
-        processed = hub_clear_feature(daddr, HUB_FEATURE_HUB_LOCAL_POWER_CHANGE,
-                                      process_new_status, STATE_COMPLETE);
-      } else if (hub_status.change.over_current) {
-        TU_LOG_DRV("  Over Current\r\n");
-        processed = hub_clear_feature(daddr, HUB_FEATURE_HUB_OVER_CURRENT_CHANGE,
-                                      process_new_status, STATE_COMPLETE);
-      }
+      // local power source and over current change
+      p_hub->change_bm = hub_status.change.value & 0x03u;
+      p_hub->conn_change = false;
       break;
     }
 
-    case STATE_CLEAR_CHANGE:
-      // Get port status complete --> clear change
-      if (p_hub->port_status.change.connection) {
-        // Connection change
-        // Port is powered and enabled
-        //TU_VERIFY(port_status.status_current.port_power && port_status.status_current.port_enable, );
-
-        // Acknowledge Port Connection Change
-        processed = hub_port_clear_feature(daddr, port_num, HUB_FEATURE_PORT_CONNECTION_CHANGE,
-                                           process_new_status, STATE_CHECK_CONN);
-      } else if (p_hub->port_status.change.port_enable) {
-        processed = hub_port_clear_feature(daddr, port_num, HUB_FEATURE_PORT_ENABLE_CHANGE,
-                                           process_new_status, STATE_COMPLETE);
-      } else if (p_hub->port_status.change.suspend) {
-        processed = hub_port_clear_feature(daddr, port_num, HUB_FEATURE_PORT_SUSPEND_CHANGE,
-                                           process_new_status, STATE_COMPLETE);
-      } else if (p_hub->port_status.change.over_current) {
-        processed = hub_port_clear_feature(daddr, port_num, HUB_FEATURE_PORT_OVER_CURRENT_CHANGE,
-                                           process_new_status, STATE_COMPLETE);
-      } else if (p_hub->port_status.change.reset) {
-        processed = hub_port_clear_feature(daddr, port_num, HUB_FEATURE_PORT_RESET_CHANGE,
-                                           process_new_status, STATE_COMPLETE);
-      }
-      break;
-
-    case STATE_CHECK_CONN: {
-      const hcd_event_t event = {
-        .rhport     = usbh_get_rhport(daddr),
-        .event_id   = p_hub->port_status.status.connection ? HCD_EVENT_DEVICE_ATTACH : HCD_EVENT_DEVICE_REMOVE,
-        .connection = {
-          .hub_addr = daddr,
-          .hub_port = port_num
-        }
-      };
-      hcd_event_handler(&event, false);
-      // skip status for attach event, usbh will do it after handled this enumeration
-      processed = (event.event_id == HCD_EVENT_DEVICE_ATTACH);
+    case STATE_PORT_STATUS:
+      // connection, enable, suspend, over current and reset change
+      p_hub->change_bm = p_hub->port_status.change.value & 0x1Fu;
+      p_hub->conn_change = p_hub->port_status.change.connection;
       break;
-    }
 
-    case STATE_COMPLETE:
+    case STATE_CLEAR_CHANGE:
     default:
-      processed = false; // complete this status, queue next status
       break;
+  }
 
+  // Acknowledge all changes of this hub/port: C_HUB_xxx features are 0-1, C_PORT_xxx features are 16-20
+  for (uint8_t bit = 0; p_hub->change_bm != 0; bit++) {
+    if (tu_bit_test(p_hub->change_bm, bit)) {
+      p_hub->change_bm = (uint16_t) tu_bit_clear(p_hub->change_bm, bit);
+      const uint8_t feature = (uint8_t) ((port_num ? HUB_FEATURE_PORT_CONNECTION_CHANGE : 0) + bit);
+      if (hub_port_clear_feature(daddr, port_num, feature, process_new_status, STATE_CLEAR_CHANGE)) {
+        return;
+      }
+    }
   }
 
-  if (!processed) {
+  if (p_hub->conn_change) {
+    p_hub->conn_change = false;
+    const hcd_event_t event = {
+      .rhport     = usbh_get_rhport(daddr),
+      .event_id   = p_hub->port_status.status.connection ? HCD_EVENT_DEVICE_ATTACH : HCD_EVENT_DEVICE_REMOVE,
+      .connection = {
+        .hub_addr = daddr,
+        .hub_port = port_num
+      }
+    };
+    hcd_event_handler(&event, false);
+
+    // Without concurrent enumeration, stop the scan for attach event: usbh will get next status after handled this
+    // enumeration, remaining changes are reported again by the hub.
+    if (CFG_TUH_ENUMERATION_MAX == 1 && event.event_id == HCD_EVENT_DEVICE_ATTACH) {
+      p_hub->scan_bm = 0;
+      return;
+    }
+  }
+
+  if (!scan_next(daddr)) {
+    // scan complete, queue next status
     TU_ASSERT(hub_edpt_status_xfer(daddr),);
   }
 }
@@ -158,7 +158,8 @@ bool hub_port_set_feature(uint8_t hub_addr, uint8_t hub_port, uint8_t feature,
                           tuh_xfer_cb_t complete_cb, uintptr_t user_data);
 
 // Get port status
-// If hub_port != 0, resp is ignored. hub_port_get_status_local() can be used to retrieve the status
+// If hub_port != 0 and resp is NULL, status is saved to local cache and can be retrieved with
+// hub_port_get_status_local(). Otherwise it is written to resp (must be in usb/dma-able memory).
 bool hub_port_get_status(uint8_t hub_addr, uint8_t hub_port, void *resp,
                          tuh_xfer_cb_t complete_cb, uintptr_t user_data);
 
@@ -22,17 +22,14 @@
 #endif
 
 #ifndef CFG_TUH_CONTROL_PENDING_QUEUE_SZ
+  // each enumerating device has at most one control transfer in flight
   #if CFG_TUH_HUB
-    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ 4
+    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ (CFG_TUH_ENUMERATION_MAX + 3)
   #else
-    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ 2
+    #define CFG_TUH_CONTROL_PENDING_QUEUE_SZ (CFG_TUH_ENUMERATION_MAX + 1)
   #endif
 #endif
 
-#ifndef CFG_TUH_INTERFACE_MAX
-  #define CFG_TUH_INTERFACE_MAX   8
-#endif
-
 enum {
   USBH_CONTROL_RETRY_MAX = 3,
 };
@@ -49,6 +46,12 @@ TU_ATTR_WEAK bool hcd_configure(uint8_t rhport, uint32_t cfg_id, const void* cfg
   return false;
 }
 
+TU_ATTR_WEAK bool hcd_edpt_iso_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer,
+                                    tu_iso_packet_t* packets, uint16_t packet_count) {
+  (void) rhport; (void) daddr; (void) ep_addr; (void) buffer; (void) packets; (void) packet_count;
+  return false;
+}
+
 TU_ATTR_WEAK void tuh_enum_descriptor_device_cb(uint8_t daddr, const tusb_desc_device_t *desc_device) {
   (void) daddr; (void) desc_device;
 }
@@ -62,6 +65,12 @@ TU_ATTR_WEAK void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_is
   (void) rhport; (void) eventid; (void) in_isr;
 }
 
+#if CFG_TUH_ENUM_CACHE
+TU_ATTR_WEAK void tuh_enum_cache_update_cb(uint8_t idx, const tuh_enum_cache_t* entry) {
+  (void) idx; (void) entry;
+}
+#endif
+
 TU_ATTR_WEAK bool hcd_dcache_clean(const void* addr, uint32_t data_size) {
   (void) addr; (void) data_size;
   return false;
@@ -131,6 +140,10 @@ typedef struct {
 
   volatile uint8_t ep_status[CFG_TUH_ENDPOINT_MAX][2];
 
+#if CFG_TUH_EDPT_STATS
+  tu_edpt_stats_t ep_stats[CFG_TUH_ENDPOINT_MAX][2];
+#endif
+
 #if CFG_TUH_API_EDPT_XFER
   // TODO array can be CFG_TUH_ENDPOINT_MAX-1
   struct {
@@ -165,14 +178,20 @@ OSAL_QUEUE_DEF(usbh_int_set, _usbh_qdef, CFG_TUH_TASK_QUEUE_SZ, hcd_event_t);
 static osal_queue_t _usbh_q;
 
 #if CFG_TUH_HUB
-// Deferred attachment queue, only needed when using hub
-OSAL_QUEUE_DEF(usbh_int_set, _usbh_daqdef, CFG_TUH_HUB, hcd_event_t);
+// Deferred attachment queue, only needed when using hub. With concurrent enumeration, hub keeps polling its status
+// while its ports are being enumerated, therefore more than one attach per hub can be pending.
+#if CFG_TUH_ENUMERATION_MAX > 1
+  #define USBH_DAQ_SIZE (CFG_TUH_DEVICE_MAX + CFG_TUH_HUB)
+#else
+  #define USBH_DAQ_SIZE CFG_TUH_HUB
+#endif
+OSAL_QUEUE_DEF(usbh_int_set, _usbh_daqdef, USBH_DAQ_SIZE, hcd_event_t);
 static osal_queue_t _usbh_daq;
 #endif
 
-// Control transfers: since most controllers do not support multiple control transfers
-// on multiple devices concurrently and control transfers are not used much except for
-// enumeration, we will only execute control transfers one at a time.
+// Control transfers: most controllers do not support multiple control transfers on multiple devices concurrently,
+// therefore by default only one control transfer is executed at a time. With CFG_TUH_CONTROL_XFER_MAX > 1, each slot
+// serves a different device, a device never has more than one control transfer in flight.
 typedef struct {
   uint8_t* buffer;
   tuh_xfer_cb_t complete_cb;
@@ -195,21 +214,57 @@ typedef struct {
   uint8_t*               buffer;
   tuh_xfer_cb_t          complete_cb;
   uintptr_t              user_data;
+  uint16_t               seq;       // submission order, entry is free if complete_cb is NULL
   uint8_t                daddr;
   uint8_t                daddr_gen;
 } usbh_pending_ctrl_t;
 
-// FIFO for pending async control transfers since we only execute 1 control transfer at a time
-TU_FIFO_DEF(_usbh_pending_ctrl_q, CFG_TUH_CONTROL_PENDING_QUEUE_SZ * sizeof(usbh_pending_ctrl_t), false);
+// Enumeration context of a newly attached device. Devices are debounced and configured concurrently, but only one
+// of them can own address 0 (from port reset until SET_ADDRESS is complete).
+typedef struct {
+  uint8_t daddr;           // 0 until addressed, TUSB_INDEX_INVALID_8 if context is free
+  uint8_t gen;             // bumped when context is released to identify stale callbacks
+  bool    wait_dev0;       // debounced and waiting for address 0 to be released
+  tuh_bus_info_t bus;      // bus info of the device
+  usbh_call_after_t delay; // pending enumeration delay
+#if CFG_TUH_ENUM_CACHE
+  uint8_t  cache_idx;      // matched enumeration cache entry
+  uint8_t  serial_len;
+  uint16_t langid;
+  uint32_t serial_hash;
+#endif
+} usbh_enum_t;
+
+#if CFG_TUH_ISO_EP_MAX
+#define USBH_ISO_QUEUE_DEPTH  2
 
+// Isochronous transfers of an endpoint queued to HCD, completed in order. Allocated by the first tuh_iso_xfer() and
+// kept until endpoint or device is closed.
 typedef struct {
-  uint8_t enumerating_daddr;  // device address of the device being enumerated
+  uint8_t daddr; // 0 if free
+  uint8_t ep_addr;
+  uint8_t count;
+  uint8_t reported; // completions queued by HCD, not yet processed by usbh task
+  uint8_t drop;     // completions of aborted transfers to discard
+  tuh_iso_xfer_t* queue[USBH_ISO_QUEUE_DEPTH];
+} usbh_iso_stream_t;
+#endif
+
+typedef struct {
+  uint8_t enum_dev0;          // index of enumeration context owning address 0
   uint8_t attach_debouncing_bm;  // bitmask for roothub port attach debouncing
-  tuh_bus_info_t dev0_bus;    // bus info for dev0 in enumeration
-  usbh_ctrl_xfer_info_t ctrl_xfer_info; // control transfer
+  usbh_enum_t enum_ctx[CFG_TUH_ENUMERATION_MAX];
+  usbh_ctrl_xfer_info_t ctrl_xfer_info[CFG_TUH_CONTROL_XFER_MAX]; // control transfer slots
+  // Async control transfers waiting for their device (or a slot) to become idle. Dispatched oldest first, which keeps
+  // the order of each device while a busy device does not block others.
+  usbh_pending_ctrl_t ctrl_pending[CFG_TUH_CONTROL_PENDING_QUEUE_SZ];
+  uint16_t ctrl_pending_seq;
   usbh_call_after_t call_after;
   // Per-daddr generation counter — bumped on usbh_device_close() to identify stale pending control transfer
   uint8_t daddr_gen[TOTAL_DEVICES + 1];
+#if CFG_TUH_ISO_EP_MAX
+  usbh_iso_stream_t iso_stream[CFG_TUH_ISO_EP_MAX];
+#endif
 #if CFG_TUSB_OS_HAS_SCHEDULER
   osal_task_handle_t task_hdl;  // host task handle, lazy-captured on first tuh_task_ext()
 #endif
@@ -219,11 +274,22 @@ static uint8_t _usbh_controller_id = TUSB_INDEX_INVALID_8;
 static usbh_data_t _usbh_data;
 
 typedef struct {
-  TUH_EPBUF_TYPE_DEF(tusb_control_request_t, request);
-  TUH_EPBUF_DEF(ctrl, CFG_TUH_ENUMERATION_BUFSIZE);
+  struct {
+    TUH_EPBUF_TYPE_DEF(tusb_control_request_t, request);
+  } ctrl[CFG_TUH_CONTROL_XFER_MAX];
+  struct {
+    TUH_EPBUF_DEF(ctrl, CFG_TUH_ENUMERATION_BUFSIZE);
+  } enum_buf[CFG_TUH_ENUMERATION_MAX];
 } usbh_epbuf_t;
 CFG_TUH_MEM_SECTION static usbh_epbuf_t _usbh_epbuf;
 
+#if CFG_TUH_ENUM_CACHE
+// Known devices, kept across tuh_deinit()/tuh_init()
+static tuh_enum_cache_t _usbh_enum_cache[CFG_TUH_ENUM_CACHE];
+static uint32_t _usbh_enum_cache_used[CFG_TUH_ENUM_CACHE]; // sequence number of last use, for replacement
+static uint32_t _usbh_enum_cache_seq;
+#endif
+
 //--------------------------------------------------------------------+
 // Class Driver
 //--------------------------------------------------------------------+
@@ -270,6 +336,19 @@ static usbh_class_driver_t const usbh_class_drivers[] = {
   },
   #endif
 
+  // before MIDI which also claims Audio Control interface
+  #if CFG_TUH_AUDIO
+  {
+      .name       = DRIVER_NAME("AUDIO"),
+      .init       = audioh_init,
+      .deinit     = audioh_deinit,
+      .open       = audioh_open,
+      .set_config = audioh_set_config,
+      .xfer_cb    = audioh_xfer_cb,
+      .close      = audioh_close
+  },
+  #endif
+
   #if CFG_TUH_MIDI
   {
       .name       = DRIVER_NAME("MIDI"),
@@ -294,6 +373,18 @@ static usbh_class_driver_t const usbh_class_drivers[] = {
   },
   #endif
 
+  #if CFG_TUH_VIDEO
+  {
+      .name       = DRIVER_NAME("VIDEO"),
+      .init       = videoh_init,
+      .deinit     = videoh_deinit,
+      .open       = videoh_open,
+      .set_config = videoh_set_config,
+      .xfer_cb    = videoh_xfer_cb,
+      .close      = videoh_close
+  },
+  #endif
+
   #if CFG_TUH_HUB
   {
       .name       = DRIVER_NAME("HUB"),
@@ -345,8 +436,11 @@ TU_ATTR_ALWAYS_INLINE static inline usbh_class_driver_t const *get_driver(uint8_
 //--------------------------------------------------------------------+
 // Function Inline and Prototypes
 //--------------------------------------------------------------------+
-static void enum_new_device(hcd_event_t* event);
-static void enum_delay_async(uintptr_t state);
+static bool enum_new_device(hcd_event_t* event);
+static void enum_delay_async(uintptr_t arg);
+static uint8_t enum_find(uint8_t daddr);
+static void enum_release(uint8_t idx);
+static void enum_dev0_next(void);
 static void process_remove_event(hcd_event_t *event);
 static void remove_device_tree(uint8_t rhport, uint8_t hub_addr, uint8_t hub_port);
 
@@ -360,6 +454,18 @@ TU_ATTR_ALWAYS_INLINE static inline usbh_device_t* get_device(uint8_t dev_addr)
   return &_usbh_devices[dev_addr-1];
 }
 
+// Statistics of transfer submitted to hcd, address 0 is not recorded
+TU_ATTR_ALWAYS_INLINE static inline void edpt_stats_submit(uint8_t daddr, uint8_t ep_addr) {
+#if CFG_TUH_EDPT_STATS
+  usbh_device_t* dev = get_device(daddr);
+  if (dev != NULL) {
+    tu_edpt_stats_submit(&dev->ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)]);
+  }
+#else
+  (void) daddr; (void) ep_addr;
+#endif
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool is_hub_addr(uint8_t daddr) {
   return (CFG_TUH_HUB > 0) && (daddr > CFG_TUH_DEVICE_MAX); //-V560
 }
@@ -370,14 +476,66 @@ TU_ATTR_ALWAYS_INLINE static inline bool queue_event(hcd_event_t const * event,
   return true;
 }
 
-TU_ATTR_ALWAYS_INLINE static inline void control_xfer_set_stage(uint8_t stage) {
-  if (_usbh_data.ctrl_xfer_info.stage != stage) {
+TU_ATTR_ALWAYS_INLINE static inline void control_xfer_set_stage(usbh_ctrl_xfer_info_t* ctrl_info, uint8_t stage) {
+  if (ctrl_info->stage != stage) {
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    _usbh_data.ctrl_xfer_info.stage = stage;
+    ctrl_info->stage = stage;
     (void) osal_mutex_unlock(_usbh_mutex);
   }
 }
 
+// Control slot with an in-flight transfer of daddr, or an idle slot if daddr is TUSB_INDEX_INVALID_8
+static usbh_ctrl_xfer_info_t* control_xfer_find(uint8_t daddr) {
+  for (uint8_t i = 0; i < CFG_TUH_CONTROL_XFER_MAX; i++) {
+    usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info[i];
+    if (daddr == TUSB_INDEX_INVALID_8) {
+      if (ctrl_info->stage == CONTROL_STAGE_IDLE) {
+        return ctrl_info;
+      }
+    } else if (ctrl_info->stage != CONTROL_STAGE_IDLE && ctrl_info->daddr == daddr) {
+      return ctrl_info;
+    }
+  }
+  return NULL;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline tusb_control_request_t* control_xfer_request(const usbh_ctrl_xfer_info_t* ctrl_info) {
+  return &_usbh_epbuf.ctrl[ctrl_info - _usbh_data.ctrl_xfer_info].request;
+}
+
+// Claim an idle slot for daddr, must be called with mutex held
+static void control_xfer_claim(usbh_ctrl_xfer_info_t* ctrl_info, uint8_t daddr, const tusb_control_request_t* setup,
+                               uint8_t* buffer, tuh_xfer_cb_t complete_cb, uintptr_t user_data) {
+  ctrl_info->stage        = CONTROL_STAGE_SETUP;
+  ctrl_info->daddr        = daddr;
+  ctrl_info->actual_len   = 0;
+  ctrl_info->failed_count = 0;
+  ctrl_info->buffer       = buffer;
+  ctrl_info->complete_cb  = complete_cb;
+  ctrl_info->user_data    = user_data;
+  *control_xfer_request(ctrl_info) = *setup;
+}
+
+// Oldest pending control transfer that can be started now i.e its device is idle and a slot is free.
+// Return NULL if there is none.
+static usbh_pending_ctrl_t* control_xfer_pending_next(void) {
+  if (control_xfer_find(TUSB_INDEX_INVALID_8) == NULL) {
+    return NULL;
+  }
+
+  usbh_pending_ctrl_t* next = NULL;
+  for (uint8_t i = 0; i < CFG_TUH_CONTROL_PENDING_QUEUE_SZ; i++) {
+    usbh_pending_ctrl_t* pending = &_usbh_data.ctrl_pending[i];
+    if (pending->complete_cb == NULL || control_xfer_find(pending->daddr) != NULL) {
+      continue;
+    }
+    if (next == NULL || (int16_t) (pending->seq - next->seq) < 0) {
+      next = pending;
+    }
+  }
+  return next;
+}
+
 bool usbh_defer_func_ms_async(uint32_t ms, tusb_defer_func_t func, uintptr_t param) {
   TU_ASSERT(_usbh_data.call_after.func == NULL);
   TU_LOG_USBH("USBH schedule function after %u ms\r\n", (unsigned int)ms);
@@ -388,28 +546,117 @@ bool usbh_defer_func_ms_async(uint32_t ms, tusb_defer_func_t func, uintptr_t par
   return true;
 }
 
+TU_ATTR_ALWAYS_INLINE static inline bool call_after_expired(const usbh_call_after_t* call_after) {
+  return call_after->func != NULL && (int32_t) (call_after->at_ms - tusb_time_millis_api()) <= 0;
+}
+
+// Invoke scheduled function if its delay is expired, and reduce timeout_ms to its remaining time
+static void call_after_process(usbh_call_after_t* call_after, uint32_t* timeout_ms) {
+  tusb_defer_func_t after_cb = call_after->func;
+  if (after_cb) {
+    int32_t remain_ms = (int32_t)(call_after->at_ms - tusb_time_millis_api());
+    if (remain_ms <= 0) {
+      // delay expired, run callback now
+      TU_LOG_USBH("USBH invoke scheduled function\r\n");
+      call_after->func = NULL;
+      after_cb(call_after->arg);
+    }
+
+    // above after_cb() can re-schedule another function, we need to re-check and reduce timeout of
+    // the main event timeout to make sure we aren't blocking more than call_after remaining ms.
+    if (call_after->func != NULL) {
+      remain_ms = (int32_t) (call_after->at_ms - tusb_time_millis_api());
+      if (remain_ms <= 0) {
+        *timeout_ms = 0; // expired already
+      } else if (*timeout_ms > (uint32_t)remain_ms) {
+        *timeout_ms = (uint32_t)remain_ms;
+      }
+    }
+  }
+}
+
+#if CFG_TUH_ISO_EP_MAX
+static usbh_iso_stream_t* iso_stream_find(uint8_t daddr, uint8_t ep_addr) {
+  for (uint8_t i = 0; i < CFG_TUH_ISO_EP_MAX; i++) {
+    usbh_iso_stream_t* stream = &_usbh_data.iso_stream[i];
+    if (stream->daddr == daddr && (daddr == 0 || stream->ep_addr == ep_addr)) {
+      return stream;
+    }
+  }
+  return NULL;
+}
+
+// Free streams of a device, ep_addr 0xff means all endpoints. Queued transfers are dropped without callback
+static void iso_stream_free(uint8_t daddr, uint8_t ep_addr) {
+  usbh_spin_lock(false);
+  for (uint8_t i = 0; i < CFG_TUH_ISO_EP_MAX; i++) {
+    usbh_iso_stream_t* stream = &_usbh_data.iso_stream[i];
+    if (stream->daddr == daddr && (ep_addr == TUSB_INDEX_INVALID_8 || stream->ep_addr == ep_addr)) {
+      tu_memclr(stream, sizeof(usbh_iso_stream_t));
+    }
+  }
+  usbh_spin_unlock(false);
+}
+
+// Complete the oldest queued transfer of an isochronous stream. Return false if endpoint is not streaming
+static bool iso_stream_complete(uint8_t daddr, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes) {
+  tuh_iso_xfer_t* xfer = NULL;
+
+  usbh_spin_lock(false);
+  usbh_iso_stream_t* stream = iso_stream_find(daddr, ep_addr);
+  if (stream != NULL && stream->reported > 0) {
+    stream->reported--;
+  }
+  if (stream != NULL && stream->drop > 0) {
+    stream->drop--; // late completion of an aborted transfer
+  } else if (stream != NULL && stream->count > 0) {
+    xfer = stream->queue[0];
+    stream->count--;
+    for (uint8_t i = 0; i < stream->count; i++) {
+      stream->queue[i] = stream->queue[i + 1];
+    }
+  }
+  usbh_spin_unlock(false);
+
+  TU_VERIFY(stream != NULL);
+  if (xfer != NULL) {
+    xfer->result     = result;
+    xfer->actual_len = xferred_bytes;
+    xfer->complete_cb(xfer);
+  }
+
+  return true;
+}
+#endif
+
 TU_ATTR_ALWAYS_INLINE static inline void usbh_device_close(uint8_t rhport, uint8_t daddr) {
   hcd_device_close(rhport, daddr);
 
+#if CFG_TUH_ISO_EP_MAX
+  if (daddr != 0) {
+    iso_stream_free(daddr, TUSB_INDEX_INVALID_8);
+  }
+#endif
+
   // Bump the generation under the mutex so a concurrent producer in
   // tuh_control_xfer stamps a value that is strictly monotonic w.r.t. close.
   (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
   _usbh_data.daddr_gen[daddr]++;
   (void) osal_mutex_unlock(_usbh_mutex);
 
+  // invalidate if enumerating, dev0 is owned by one of the enumerating devices. Look it up before failing the control
+  // xfer below: its callback may end the enumeration and hand address 0 over to the next device already.
+  const uint8_t enum_idx = (daddr == 0) ? _usbh_data.enum_dev0 : enum_find(daddr);
+  const uint8_t enum_gen = (enum_idx < CFG_TUH_ENUMERATION_MAX) ? _usbh_data.enum_ctx[enum_idx].gen : 0;
+
   // If this device has in-flight control xfer, complete as FAILED
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-  if (daddr == ctrl_info->daddr && ctrl_info->stage != CONTROL_STAGE_IDLE) {
+  if (control_xfer_find(daddr) != NULL) {
     control_xfer_complete(daddr, XFER_RESULT_FAILED);
   }
 
-  // invalidate if enumerating
-  if (daddr == _usbh_data.enumerating_daddr) {
-    _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8;
-    // clear enum delay function of the device being removed
-    if (_usbh_data.call_after.func == enum_delay_async) {
-      _usbh_data.call_after.func = NULL;
-    }
+  if (enum_idx < CFG_TUH_ENUMERATION_MAX && _usbh_data.enum_ctx[enum_idx].gen == enum_gen) {
+    enum_release(enum_idx);
+    enum_dev0_next();
   }
 }
 
@@ -424,7 +671,7 @@ bool tuh_mounted(uint8_t dev_addr) {
 
 bool tuh_connected(uint8_t daddr) {
   if (daddr == 0) {
-    return _usbh_data.enumerating_daddr == 0;
+    return _usbh_data.enum_dev0 != TUSB_INDEX_INVALID_8;
   } else {
     const usbh_device_t* dev = get_device(daddr);
     TU_VERIFY(dev != NULL);
@@ -553,7 +800,10 @@ bool tuh_rhport_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
     tu_memclr(&_usbh_data, sizeof(_usbh_data));
 
     _usbh_controller_id = TUSB_INDEX_INVALID_8;
-    _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8;
+    _usbh_data.enum_dev0 = TUSB_INDEX_INVALID_8;
+    for (uint8_t i = 0; i < CFG_TUH_ENUMERATION_MAX; i++) {
+      _usbh_data.enum_ctx[i].daddr = TUSB_INDEX_INVALID_8;
+    }
 
     for (uint8_t i = 0; i < TOTAL_DEVICES; i++) {
       clear_device(&_usbh_devices[i]);
@@ -609,10 +859,20 @@ bool tuh_deinit(uint8_t rhport) {
     _usbh_daq = NULL;
   #endif
 
-    // Fire FAILED cb for any queued async control xfer so callers aren't stranded.
-    usbh_pending_ctrl_t pending;
-    while (tu_fifo_read_n(&_usbh_pending_ctrl_q, &pending, sizeof(pending)) == sizeof(pending)) {
-      if (pending.complete_cb) {
+    // Fire FAILED cb for any queued async control xfer (oldest first) so callers aren't stranded.
+    usbh_pending_ctrl_t* oldest;
+    do {
+      oldest = NULL;
+      for (uint8_t i = 0; i < CFG_TUH_CONTROL_PENDING_QUEUE_SZ; i++) {
+        usbh_pending_ctrl_t* p = &_usbh_data.ctrl_pending[i];
+        if (p->complete_cb != NULL && (oldest == NULL || (int16_t) (p->seq - oldest->seq) < 0)) {
+          oldest = p;
+        }
+      }
+
+      if (oldest != NULL) {
+        const usbh_pending_ctrl_t pending = *oldest;
+        oldest->complete_cb = NULL;
         tuh_xfer_t x = {
           .daddr       = pending.daddr,
           .ep_addr     = 0,
@@ -625,8 +885,7 @@ bool tuh_deinit(uint8_t rhport) {
         };
         pending.complete_cb(&x);
       }
-    }
-    tu_fifo_clear(&_usbh_pending_ctrl_q);
+    } while (oldest != NULL);
 
   #if OSAL_MUTEX_REQUIRED
     // TODO make sure there is no task waiting on this mutex
@@ -649,21 +908,23 @@ bool tuh_task_event_ready(void) {
   }
 
   #if CFG_TUH_HUB
-  if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8 &&
+  if (enum_find(TUSB_INDEX_INVALID_8) < CFG_TUH_ENUMERATION_MAX &&
       !osal_queue_empty(_usbh_daq)) {
     return true;
   }
   #endif
 
   // Pending control xfer waiting for an idle slot
-  if (_usbh_data.ctrl_xfer_info.stage == CONTROL_STAGE_IDLE &&
-      !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
+  if (control_xfer_pending_next() != NULL) {
     return true;
   }
 
-  if (_usbh_data.call_after.func) {
-    int32_t remain_ms = (int32_t)(_usbh_data.call_after.at_ms - tusb_time_millis_api());
-    if (remain_ms <= 0) {
+  if (call_after_expired(&_usbh_data.call_after)) {
+    return true;
+  }
+
+  for (uint8_t i = 0; i < CFG_TUH_ENUMERATION_MAX; i++) {
+    if (call_after_expired(&_usbh_data.enum_ctx[i].delay)) {
       return true;
     }
   }
@@ -711,45 +972,27 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
     }
   #endif
 
-    // Process call_after_ms function if ms is reached
-    tusb_defer_func_t after_cb = _usbh_data.call_after.func;
-    if (after_cb) {
-      int32_t remain_ms = (int32_t)(_usbh_data.call_after.at_ms - tusb_time_millis_api());
-      if (remain_ms <= 0) {
-        // delay expired, run callback now
-        TU_LOG_USBH("USBH invoke scheduled function\r\n");
-        _usbh_data.call_after.func = NULL;
-        after_cb(_usbh_data.call_after.arg);
-      }
-
-      // above after_cb() can re-schedule another function, we need to re-check and reduce timeout of
-      // the main event timeout to make sure we aren't blocking more than call_after remaining ms.
-      if (_usbh_data.call_after.func != NULL) {
-        remain_ms = (int32_t) (_usbh_data.call_after.at_ms - tusb_time_millis_api());
-        if (remain_ms <= 0) {
-          timeout_ms = 0; // expired already
-        } else if (timeout_ms > (uint32_t)remain_ms) {
-          timeout_ms = (uint32_t)remain_ms;
-        }
-      }
+    // Process call_after_ms function and enumeration delays if ms is reached
+    call_after_process(&_usbh_data.call_after, &timeout_ms);
+    for (uint8_t i = 0; i < CFG_TUH_ENUMERATION_MAX; i++) {
+      call_after_process(&_usbh_data.enum_ctx[i].delay, &timeout_ms);
     }
 
     // Drain pending async control xfers. Slot transitions and dispatch are
     // decoupled: completion / abort / device_close set stage = IDLE via
-    // control_xfer_set_stage() and the actual FIFO drain happens here in the
+    // control_xfer_set_stage() and the actual pending drain happens here in the
     // event loop. The check is a fast non-mutex sanity gate; the dispatcher
     // itself re-checks under the mutex.
-    if (_usbh_data.ctrl_xfer_info.stage == CONTROL_STAGE_IDLE &&
-        !tu_fifo_empty(&_usbh_pending_ctrl_q)) {
+    if (control_xfer_pending_next() != NULL) {
       control_xfer_dispatch_pending();
     }
 
     hcd_event_t event;
 
   #if CFG_TUH_HUB
-    // Get deferred device attachments if none is enumerating
+    // Get deferred device attachments if an enumeration context is free
     bool has_deferred_attach = false;
-    if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8) {
+    if (enum_find(TUSB_INDEX_INVALID_8) < CFG_TUH_ENUMERATION_MAX) {
       // zero wait to avoid blocking the main event queue
       has_deferred_attach = osal_queue_receive(_usbh_daq, &event, 0);
     }
@@ -769,16 +1012,14 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
         // Force remove currently mounted with the same bus info (rhport, hub addr, hub port) if exists
         process_remove_event(&event);
 
-        // due to the shared control buffer, we must fully complete enumerating one device first.
-        if (_usbh_data.enumerating_daddr == TUSB_INDEX_INVALID_8) {
+        // each enumerating device has its own context and buffer, defer if all of them are in use
+        if (enum_new_device(&event)) {
           // New device attached and we are ready
           TU_LOG_USBH("[%u:] USBH Device Attach\r\n", event.rhport);
-          _usbh_data.enumerating_daddr = 0; // enumerate new device with address 0
-          enum_new_device(&event);
         }
   #if CFG_TUH_HUB
         else {
-          TU_LOG_USBH("[%u:] USBH Defer Attach until current enumeration complete\r\n", event.rhport);
+          TU_LOG_USBH("[%u:] USBH Defer Attach until an enumeration complete\r\n", event.rhport);
           TU_ASSERT(osal_queue_send(_usbh_daq, &event, in_isr), );
         }
   #endif
@@ -810,7 +1051,14 @@ void tuh_task_ext(uint32_t timeout_ms, bool in_isr) {
 
           if (0 == epnum) {
             usbh_control_xfer_cb(event.dev_addr, ep_addr, (xfer_result_t) event.xfer_complete.result, event.xfer_complete.len);
-          } else {
+          }
+          #if CFG_TUH_ISO_EP_MAX
+          else if (iso_stream_complete(event.dev_addr, ep_addr, (xfer_result_t) event.xfer_complete.result,
+                                       event.xfer_complete.len)) {
+            // isochronous stream, complete_cb is invoked
+          }
+          #endif
+          else {
             // Prefer application callback over built-in one if available. This occurs when tuh_edpt_xfer() is used
             // with enabled driver e.g HID endpoint
             #if CFG_TUH_API_EDPT_XFER
@@ -885,7 +1133,7 @@ static void control_xfer_sync_complete(tuh_xfer_t* xfer) {
 bool tuh_control_xfer (tuh_xfer_t* xfer) {
   const uint8_t daddr = xfer->daddr;
   TU_VERIFY(daddr <= TOTAL_DEVICES && xfer->ep_addr == 0 && xfer->setup); // EP0 with setup packet
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
+  usbh_ctrl_xfer_info_t* ctrl_info = NULL;
 
 #if CFG_TUSB_OS_HAS_SCHEDULER
   // Sync (complete_cb == NULL) from a host-stack callback is forbidden on
@@ -897,45 +1145,44 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
               osal_task_get_current_handle() == _usbh_data.task_hdl));
 #endif
 
-  // Slot is single-threaded — when busy, sync callers block until it frees
+  // Each slot is single-threaded and a device owns at most one slot — when the
+  // device is busy or all slots are taken, sync callers block until it frees
   // (blocking semantics require the result); async callers get queued in the
-  // pending FIFO and submitted by control_xfer_complete() when the slot
-  // drains. The test-and-{claim|enqueue} is one critical section so a slot
-  // that becomes IDLE between the check and the enqueue can't strand an async
-  // request in a queue nothing else drains.
+  // pending pool and submitted by the event loop when a slot drains. The
+  // test-and-{claim|enqueue} is one critical section so a slot that becomes
+  // IDLE between the check and the enqueue can't strand an async request in a
+  // queue nothing else drains.
   const bool is_nonblocking = (xfer->complete_cb != NULL);
   while (true) {
     TU_VERIFY(tuh_connected(daddr));
-    bool claimed = false;
     bool is_queued = false;
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    if (ctrl_info->stage == CONTROL_STAGE_IDLE) {
-      ctrl_info->stage        = CONTROL_STAGE_SETUP;
-      ctrl_info->daddr        = daddr;
-      ctrl_info->actual_len   = 0;
-      ctrl_info->failed_count = 0;
-
-      ctrl_info->buffer       = xfer->buffer;
-      ctrl_info->complete_cb  = xfer->complete_cb;
-      ctrl_info->user_data    = xfer->user_data;
-      _usbh_epbuf.request     = (*xfer->setup);
-      claimed = true;
+    if (control_xfer_find(daddr) == NULL) {
+      ctrl_info = control_xfer_find(TUSB_INDEX_INVALID_8);
+    }
+    if (ctrl_info != NULL) {
+      control_xfer_claim(ctrl_info, daddr, xfer->setup, xfer->buffer, xfer->complete_cb, xfer->user_data);
     } else if (is_nonblocking) {
       // Async + busy: queue the transfer.
-      const usbh_pending_ctrl_t entry = {
-        .setup       = *xfer->setup,
-        .buffer      = xfer->buffer,
-        .complete_cb = xfer->complete_cb,
-        .user_data   = xfer->user_data,
-        .daddr       = daddr,
-        .daddr_gen   = _usbh_data.daddr_gen[daddr]
-      };
-      is_queued = tu_fifo_write_n(&_usbh_pending_ctrl_q, &entry, sizeof(entry)) == sizeof(entry);
+      for (uint8_t i = 0; i < CFG_TUH_CONTROL_PENDING_QUEUE_SZ; i++) {
+        usbh_pending_ctrl_t* entry = &_usbh_data.ctrl_pending[i];
+        if (entry->complete_cb == NULL) {
+          entry->setup       = *xfer->setup;
+          entry->buffer      = xfer->buffer;
+          entry->complete_cb = xfer->complete_cb;
+          entry->user_data   = xfer->user_data;
+          entry->seq         = _usbh_data.ctrl_pending_seq++;
+          entry->daddr       = daddr;
+          entry->daddr_gen   = _usbh_data.daddr_gen[daddr];
+          is_queued = true;
+          break;
+        }
+      }
     }
 
     (void) osal_mutex_unlock(_usbh_mutex);
 
-    if (claimed) {
+    if (ctrl_info != NULL) {
       break;
     }
 
@@ -967,8 +1214,9 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
     ctrl_info->complete_cb = control_xfer_sync_complete;
   }
 
-  if (!hcd_setup_send(usbh_get_rhport(daddr), daddr, (uint8_t const *) &_usbh_epbuf.request)) {
-    control_xfer_set_stage(CONTROL_STAGE_IDLE);
+  edpt_stats_submit(daddr, 0);
+  if (!hcd_setup_send(usbh_get_rhport(daddr), daddr, (uint8_t const *) control_xfer_request(ctrl_info))) {
+    control_xfer_set_stage(ctrl_info, CONTROL_STAGE_IDLE);
     return false;
   }
 
@@ -995,30 +1243,23 @@ bool tuh_control_xfer (tuh_xfer_t* xfer) {
   return true;
 }
 
-// Start control transfer from pending fifo
+// Start control transfers from pending pool, as many as there are idle devices and free slots
 static void control_xfer_dispatch_pending(void) {
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-
   while (true) {
     usbh_pending_ctrl_t xfer;
-    bool has_xfer = false;
+    usbh_ctrl_xfer_info_t* ctrl_info = NULL;
 
     (void) osal_mutex_lock(_usbh_mutex, OSAL_TIMEOUT_WAIT_FOREVER);
-    if (ctrl_info->stage == CONTROL_STAGE_IDLE &&
-        tu_fifo_read_n(&_usbh_pending_ctrl_q, &xfer, sizeof(xfer)) == sizeof(xfer)) {
-      ctrl_info->stage        = CONTROL_STAGE_SETUP;
-      ctrl_info->daddr        = xfer.daddr;
-      ctrl_info->actual_len   = 0;
-      ctrl_info->failed_count = 0;
-      ctrl_info->buffer       = xfer.buffer;
-      ctrl_info->complete_cb  = xfer.complete_cb;
-      ctrl_info->user_data    = xfer.user_data;
-      _usbh_epbuf.request     = xfer.setup;
-      has_xfer = true;
+    usbh_pending_ctrl_t* next = control_xfer_pending_next();
+    if (next != NULL) {
+      xfer = *next;
+      next->complete_cb = NULL; // free entry
+      ctrl_info = control_xfer_find(TUSB_INDEX_INVALID_8);
+      control_xfer_claim(ctrl_info, xfer.daddr, &xfer.setup, xfer.buffer, xfer.complete_cb, xfer.user_data);
     }
     (void) osal_mutex_unlock(_usbh_mutex);
 
-    if (!has_xfer) {
+    if (ctrl_info == NULL) {
       return; // nothing to do
     }
 
@@ -1029,8 +1270,9 @@ static void control_xfer_dispatch_pending(void) {
                   (xfer.setup.bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD && xfer.setup.bRequest <= TUSB_REQ_SYNCH_FRAME) ?
                       tu_str_std_request[xfer.setup.bRequest] : "Class Request");
       TU_LOG_BUF_USBH(&xfer.setup, 8);
-      if (hcd_setup_send(usbh_get_rhport(xfer.daddr), xfer.daddr, (uint8_t const *) &_usbh_epbuf.request)) {
-        return; // transfer kicked-off, we are done
+      edpt_stats_submit(xfer.daddr, 0);
+      if (hcd_setup_send(usbh_get_rhport(xfer.daddr), xfer.daddr, (uint8_t const *) control_xfer_request(ctrl_info))) {
+        continue; // transfer kicked-off, try to fill other slots
       }
     }
 
@@ -1041,10 +1283,11 @@ static void control_xfer_dispatch_pending(void) {
 
 static void control_xfer_complete(uint8_t daddr, xfer_result_t result) {
   TU_LOG_USBH("\r\n");
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
+  usbh_ctrl_xfer_info_t* ctrl_info = control_xfer_find(daddr);
+  TU_VERIFY(ctrl_info != NULL, );
 
   // duplicate xfer since user can execute control transfer within callback
-  tusb_control_request_t const request = _usbh_epbuf.request;
+  tusb_control_request_t const request = *control_xfer_request(ctrl_info);
   tuh_xfer_t xfer_temp = {
     .daddr       = daddr,
     .ep_addr     = 0,
@@ -1057,7 +1300,7 @@ static void control_xfer_complete(uint8_t daddr, xfer_result_t result) {
   };
 
   // set to IDLE before callback since cb can invoke another transfer
-  control_xfer_set_stage(CONTROL_STAGE_IDLE);
+  control_xfer_set_stage(ctrl_info, CONTROL_STAGE_IDLE);
 
   if (xfer_temp.complete_cb != NULL) {
     xfer_temp.complete_cb(&xfer_temp);
@@ -1068,14 +1311,14 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
   (void) ep_addr;
 
   const uint8_t rhport = usbh_get_rhport(daddr);
-  tusb_control_request_t const * request = &_usbh_epbuf.request;
-  usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
+  usbh_ctrl_xfer_info_t* ctrl_info = control_xfer_find(daddr);
 
   // Drop stale completions: slot already released (abort/close fired its cb)
   // or now owns a different device's xfer (a pending entry was dispatched).
-  if (ctrl_info->stage == CONTROL_STAGE_IDLE || ctrl_info->daddr != daddr) {
+  if (ctrl_info == NULL) {
     return true;
   }
+  tusb_control_request_t const * request = control_xfer_request(ctrl_info);
 
   switch (result) {
     case XFER_RESULT_STALLED:
@@ -1093,6 +1336,7 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
         ctrl_info->actual_len = 0; // reset actual_len
         (void) osal_mutex_unlock(_usbh_mutex);
 
+        edpt_stats_submit(daddr, 0);
         if (!hcd_setup_send(rhport, daddr, (uint8_t const *) request)) {
           control_xfer_complete(daddr, XFER_RESULT_FAILED);
           return false;
@@ -1109,8 +1353,9 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
         case CONTROL_STAGE_SETUP:
           if (request->wLength > 0) {
             // DATA stage: initial data toggle is always 1
-            control_xfer_set_stage(CONTROL_STAGE_DATA);
+            control_xfer_set_stage(ctrl_info, CONTROL_STAGE_DATA);
             const uint8_t ep_data = tu_edpt_addr(0, request->bmRequestType_bit.direction);
+            edpt_stats_submit(daddr, ep_data);
             TU_ASSERT(hcd_edpt_xfer(rhport, daddr, ep_data, ctrl_info->buffer, request->wLength));
             return true;
           }
@@ -1124,8 +1369,9 @@ static bool usbh_control_xfer_cb (uint8_t daddr, uint8_t ep_addr, xfer_result_t
             ctrl_info->actual_len = (uint16_t) xferred_bytes;
 
             // ACK stage: toggle is always 1
-            control_xfer_set_stage(CONTROL_STAGE_ACK);
+            control_xfer_set_stage(ctrl_info, CONTROL_STAGE_ACK);
             const uint8_t ep_status = tu_edpt_addr(0, 1 - request->bmRequestType_bit.direction);
+            edpt_stats_submit(daddr, ep_status);
             TU_ASSERT(hcd_edpt_xfer(rhport, daddr, ep_status, NULL, 0));
             break;
           }
@@ -1184,15 +1430,29 @@ bool tuh_edpt_abort_xfer(uint8_t daddr, uint8_t ep_addr) {
     // Also include dev0 for aborting enumerating
     const uint8_t rhport = usbh_get_rhport(daddr);
 
-    // control transfer: only 1 control at a time, check if we are aborting the current one
-    const usbh_ctrl_xfer_info_t* ctrl_info = &_usbh_data.ctrl_xfer_info;
-    TU_VERIFY(daddr == ctrl_info->daddr && ctrl_info->stage != CONTROL_STAGE_IDLE);
+    // control transfer: only 1 control per device at a time, check if it has one in flight
+    TU_VERIFY(control_xfer_find(daddr) != NULL);
     hcd_edpt_abort_xfer(rhport, daddr, ep_addr);
     control_xfer_complete(daddr, XFER_RESULT_ABORTED);
   } else {
     usbh_device_t* dev = get_device(daddr);
     TU_VERIFY(dev);
 
+    #if CFG_TUH_ISO_EP_MAX
+    usbh_iso_stream_t* stream = iso_stream_find(daddr, ep_addr);
+    if (stream != NULL) {
+      TU_VERIFY(stream->count > 0);
+      hcd_edpt_abort_xfer(dev->bus_info.rhport, daddr, ep_addr);
+      // all queued transfers are dropped. Completions already reported by HCD are for aborted transfers and must
+      // not pop one submitted afterward
+      usbh_spin_lock(false);
+      stream->count = 0;
+      stream->drop  = stream->reported;
+      usbh_spin_unlock(false);
+      return true;
+    }
+    #endif
+
     TU_VERIFY(dev->ep_status[epnum][dir] & TU_EDPT_STATE_BUSY); // non-control skip if not busy
     // abort then mark as ready and release endpoint
     hcd_edpt_abort_xfer(dev->bus_info.rhport, daddr, ep_addr);
@@ -1213,8 +1473,10 @@ uint8_t usbh_get_rhport(uint8_t daddr) {
   return bus_info.rhport;
 }
 
-uint8_t *usbh_get_enum_buf(void) {
-  return _usbh_epbuf.ctrl;
+uint8_t *usbh_get_enum_buf(uint8_t daddr) {
+  const uint8_t idx = enum_find(daddr);
+  TU_VERIFY(idx < CFG_TUH_ENUMERATION_MAX, NULL);
+  return _usbh_epbuf.enum_buf[idx].ctrl;
 }
 
 void usbh_int_set(bool enabled) {
@@ -1303,12 +1565,16 @@ bool usbh_edpt_xfer_with_callback(uint8_t dev_addr, uint8_t ep_addr, uint8_t* bu
   dev->ep_callback[epnum][dir].user_data   = user_data;
 #endif
 
+  edpt_stats_submit(dev_addr, ep_addr);
   if (hcd_edpt_xfer(dev->bus_info.rhport, dev_addr, ep_addr, buffer, total_bytes)) {
     TU_LOG_USBH("OK\r\n");
     return true;
   } else {
     // HCD error, clear busy and claimed to allow next transfer
     *ep_state &= (uint8_t) ~(TU_EDPT_STATE_BUSY | TU_EDPT_STATE_CLAIMED);
+    #if CFG_TUH_EDPT_STATS
+    dev->ep_stats[epnum][dir].errors++;
+    #endif
     TU_LOG1("Failed\r\n");
 //    TU_BREAKPOINT();
     return false;
@@ -1344,9 +1610,82 @@ bool tuh_edpt_open(uint8_t dev_addr, tusb_desc_endpoint_t const* desc_ep) {
 bool tuh_edpt_close(uint8_t daddr, uint8_t ep_addr) {
   TU_VERIFY(0 != tu_edpt_number(ep_addr)); // cannot close EP0
   tuh_edpt_abort_xfer(daddr, ep_addr); // abort any pending transfer
+#if CFG_TUH_ISO_EP_MAX
+  iso_stream_free(daddr, ep_addr);
+#endif
   return hcd_edpt_close(usbh_get_rhport(daddr), daddr, ep_addr);
 }
 
+#if CFG_TUH_ISO_EP_MAX
+bool tuh_iso_xfer(tuh_iso_xfer_t* xfer) {
+  uint8_t const daddr = xfer->daddr;
+  uint8_t const ep_addr = xfer->ep_addr;
+  TU_VERIFY(daddr && tu_edpt_number(ep_addr) && xfer->complete_cb != NULL && xfer->packet_count > 0);
+
+  usbh_device_t* dev = get_device(daddr);
+  TU_VERIFY(dev && dev->connected);
+
+  // queue to this endpoint's stream, allocate one if not streaming yet
+  usbh_spin_lock(false);
+  usbh_iso_stream_t* stream = iso_stream_find(daddr, ep_addr);
+  bool const allocated = (stream == NULL);
+  if (allocated) {
+    stream = iso_stream_find(0, 0);
+    if (stream != NULL) {
+      stream->daddr   = daddr;
+      stream->ep_addr = ep_addr;
+    }
+  }
+  bool const queued = (stream != NULL && stream->count < USBH_ISO_QUEUE_DEPTH);
+  if (queued) {
+    stream->queue[stream->count++] = xfer;
+  }
+  usbh_spin_unlock(false);
+  TU_VERIFY(queued);
+
+  TU_LOG_USBH("  Queue ISO EP %02X with %u packets\r\n", ep_addr, xfer->packet_count);
+
+  edpt_stats_submit(daddr, ep_addr);
+  if (!hcd_edpt_iso_xfer(dev->bus_info.rhport, daddr, ep_addr, xfer->buffer, xfer->packets, xfer->packet_count)) {
+    // remove from queue: completions only pop from the head, this transfer is still the last one
+    usbh_spin_lock(false);
+    stream->count--;
+    if (allocated && stream->count == 0) {
+      tu_memclr(stream, sizeof(usbh_iso_stream_t)); // release slot claimed above
+    }
+    usbh_spin_unlock(false);
+    #if CFG_TUH_EDPT_STATS
+    dev->ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)].errors++;
+    #endif
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+#if CFG_TUH_EDPT_STATS
+bool tuh_edpt_stats_get(uint8_t daddr, uint8_t ep_addr, tu_edpt_stats_t* stats) {
+  usbh_device_t const* dev = get_device(daddr);
+  uint8_t const epnum = tu_edpt_number(ep_addr);
+  TU_VERIFY(dev != NULL && epnum < CFG_TUH_ENDPOINT_MAX && stats != NULL);
+
+  // snapshot since statistics are updated in ISR
+  usbh_spin_lock(false);
+  *stats = dev->ep_stats[epnum][tu_edpt_dir(ep_addr)];
+  usbh_spin_unlock(false);
+  return true;
+}
+
+void tuh_edpt_stats_clear(uint8_t daddr) {
+  usbh_device_t* dev = get_device(daddr);
+  TU_VERIFY(dev != NULL, );
+  usbh_spin_lock(false);
+  tu_memclr(dev->ep_stats, sizeof(dev->ep_stats));
+  usbh_spin_unlock(false);
+}
+#endif
+
 bool usbh_edpt_busy(uint8_t dev_addr, uint8_t ep_addr) {
   usbh_device_t* dev = get_device(dev_addr);
   TU_VERIFY(dev);
@@ -1365,8 +1704,10 @@ bool tuh_bus_info_get(uint8_t daddr, tuh_bus_info_t* bus_info) {
   usbh_device_t const* dev = get_device(daddr);
   if (dev != NULL) {
     *bus_info = dev->bus_info;
+  } else if (_usbh_data.enum_dev0 < CFG_TUH_ENUMERATION_MAX) {
+    *bus_info = _usbh_data.enum_ctx[_usbh_data.enum_dev0].bus;
   } else {
-    *bus_info = _usbh_data.dev0_bus;
+    tu_memclr(bus_info, sizeof(tuh_bus_info_t));
   }
   return true;
 }
@@ -1388,6 +1729,29 @@ TU_ATTR_FAST_FUNC void hcd_event_handler(hcd_event_t const* event, bool in_isr)
       }
       break;
 
+#if CFG_TUH_EDPT_STATS || CFG_TUH_ISO_EP_MAX
+    case HCD_EVENT_XFER_COMPLETE: {
+      uint8_t const ep_addr = event->xfer_complete.ep_addr;
+  #if CFG_TUH_EDPT_STATS
+      usbh_device_t* dev = get_device(event->dev_addr);
+      if (dev != NULL) {
+        tu_edpt_stats_complete(&dev->ep_stats[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)],
+                               event->xfer_complete.result, event->xfer_complete.len);
+      }
+  #endif
+  #if CFG_TUH_ISO_EP_MAX
+      // count completions in flight to usbh task, see tuh_edpt_abort_xfer()
+      if (event->dev_addr != 0 && tu_edpt_number(ep_addr) != 0) {
+        usbh_iso_stream_t* stream = iso_stream_find(event->dev_addr, ep_addr);
+        if (stream != NULL) {
+          stream->reported++;
+        }
+      }
+  #endif
+      break;
+    }
+#endif
+
     default:
       // nothing to do
       break;
@@ -1588,15 +1952,7 @@ bool tuh_interface_set(uint8_t daddr, uint8_t itf_num, uint8_t itf_alt,
 
 // process detach event from rhport:hub_addr:hub_port
 static void process_remove_event(hcd_event_t *event) {
-  if (_usbh_data.enumerating_daddr == 0 &&
-      event->rhport == _usbh_data.dev0_bus.rhport &&
-      event->connection.hub_addr == _usbh_data.dev0_bus.hub_addr &&
-      event->connection.hub_port == _usbh_data.dev0_bus.hub_port) {
-    // dev0 is unplugged while enumerating (not yet assigned an address)
-    usbh_device_close(_usbh_data.dev0_bus.rhport, 0);
-  } else {
-    remove_device_tree(event->rhport, event->connection.hub_addr, event->connection.hub_port);
-  }
+  remove_device_tree(event->rhport, event->connection.hub_addr, event->connection.hub_port);
 }
 
 // remove a device at rhport:hub_addr:hub_port and all of its downstream
@@ -1607,6 +1963,21 @@ static void remove_device_tree(uint8_t rhport, uint8_t hub_addr, uint8_t hub_por
   #endif
 
   do {
+    // devices not assigned an address yet are only known by their enumeration context
+    for (uint8_t idx = 0; idx < CFG_TUH_ENUMERATION_MAX; idx++) {
+      const usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+      if (ctx->daddr == 0 && ctx->bus.rhport == rhport &&
+          (hub_addr == 0 || ctx->bus.hub_addr == hub_addr) &&
+          (hub_port == 0 || ctx->bus.hub_port == hub_port)) {
+        TU_LOG_USBH("[%u:%u:%u] unplugged while enumerating\r\n", rhport, ctx->bus.hub_addr, ctx->bus.hub_port);
+        if (idx == _usbh_data.enum_dev0) {
+          usbh_device_close(rhport, 0); // also release its enumeration context
+        } else {
+          enum_release(idx);
+        }
+      }
+    }
+
     for (uint8_t dev_id = 0; dev_id < TOTAL_DEVICES; dev_id++) {
       usbh_device_t* dev = &_usbh_devices[dev_id];
       uint8_t const daddr = dev_id + 1u;
@@ -1668,8 +2039,9 @@ static void remove_device_tree(uint8_t rhport, uint8_t hub_addr, uint8_t hub_por
 //--------------------------------------------------------------------+
 // Enumeration Process
 // is a lengthy process with a series of control transfer to configure newly attached device.
-// NOTE: due to the shared control buffer, we must complete enumerating
-// one device before enumerating another one.
+// NOTE: each enumerating device has its own context and control buffer (up to CFG_TUH_ENUMERATION_MAX), which allows
+// debouncing and configuring devices on different hub ports concurrently. However, there is only one address 0 on
+// the bus: port reset and SET_ADDRESS are serialized, other devices wait until address 0 is released.
 //--------------------------------------------------------------------+
 enum {                                      // USB 2.0 specs 7.1.7 for timing
   ENUM_DEBOUNCING_DELAY_MS           = 150, // T(ATTDB)  minimum 100 ms for stable connection
@@ -1701,12 +2073,15 @@ enum {
   ENUM_GET_9BYTE_CONFIG_DESC,
   ENUM_GET_FULL_CONFIG_DESC,
   ENUM_SET_CONFIG,
-  ENUM_CONFIG_DRIVER
+  ENUM_CONFIG_DRIVER,
+  ENUM_CACHE_SERIAL,        // known device: check serial number
+  ENUM_CACHE_CONFIG_HEADER, // known device: validate cached configuration
 };
 
 static uint8_t enum_get_new_address(bool is_hub);
-static bool    enum_parse_configuration_desc(uint8_t dev_addr, const tusb_desc_configuration_t *desc_cfg);
-static void    enum_full_complete(bool success);
+static bool    enum_parse_configuration_desc(uint8_t dev_addr, const tusb_desc_configuration_t *desc_cfg,
+                                             const uint8_t *drv_hint);
+static void    enum_full_complete(uint8_t idx, bool success);
 static void    process_enumeration(tuh_xfer_t *xfer);
 
 enum {
@@ -1719,52 +2094,141 @@ enum {
   ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY,
 };
 
+// Callback argument of enumeration transfer/delay: [generation | context index | state]
+TU_ATTR_ALWAYS_INLINE static inline uintptr_t enum_arg(uint8_t idx, uint8_t state) {
+  return ((uintptr_t) _usbh_data.enum_ctx[idx].gen << 16) | ((uintptr_t) idx << 8) | state;
+}
+
+// Get context index from callback argument, TUSB_INDEX_INVALID_8 if the context is already released
+static uint8_t enum_arg_idx(uintptr_t arg) {
+  const uint8_t idx = (uint8_t) (arg >> 8);
+  TU_VERIFY(idx < CFG_TUH_ENUMERATION_MAX, TUSB_INDEX_INVALID_8);
+  const usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+  TU_VERIFY(ctx->daddr != TUSB_INDEX_INVALID_8 && ctx->gen == (uint8_t) (arg >> 16), TUSB_INDEX_INVALID_8);
+  return idx;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t* enum_buf(uint8_t idx) {
+  return _usbh_epbuf.enum_buf[idx].ctrl;
+}
+
+// find enumeration context of a device, TUSB_INDEX_INVALID_8 finds a free context
+static uint8_t enum_find(uint8_t daddr) {
+  for (uint8_t idx = 0; idx < CFG_TUH_ENUMERATION_MAX; idx++) {
+    if (_usbh_data.enum_ctx[idx].daddr == daddr) {
+      return idx;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+static void enum_release(uint8_t idx) {
+  usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+  ctx->daddr      = TUSB_INDEX_INVALID_8;
+  ctx->gen++;
+  ctx->wait_dev0  = false;
+  ctx->delay.func = NULL;
+  if (_usbh_data.enum_dev0 == idx) {
+    _usbh_data.enum_dev0 = TUSB_INDEX_INVALID_8;
+  }
+}
+
+static void enum_delay_ms(uint8_t idx, uint32_t ms, uint8_t state) {
+  usbh_call_after_t* delay = &_usbh_data.enum_ctx[idx].delay;
+  delay->func  = enum_delay_async;
+  delay->arg   = enum_arg(idx, state);
+  // add one to ensure we wait at least 'ms' milliseconds
+  delay->at_ms = tusb_time_millis_api() + ms + 1;
+}
+
+// Take address 0 and reset the port, or wait until address 0 is released by other enumerating device
+static void enum_port_reset(uint8_t idx) {
+  usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+  if (_usbh_data.enum_dev0 != TUSB_INDEX_INVALID_8) {
+    TU_LOG_USBH("[%u:%u:%u] Wait for address 0\r\n", ctx->bus.rhport, ctx->bus.hub_addr, ctx->bus.hub_port);
+    ctx->wait_dev0 = true;
+    return;
+  }
+  _usbh_data.enum_dev0 = idx;
+
+  #if CFG_TUH_HUB
+  if (ctx->bus.hub_addr != 0) {
+    if (!hub_port_reset(ctx->bus.hub_addr, ctx->bus.hub_port, process_enumeration,
+                        enum_arg(idx, ENUM_HUB_RESET_COMPLETE))) {
+      enum_full_complete(idx, false);
+    }
+  } else
+  #endif
+  {
+    hcd_port_reset(ctx->bus.rhport); // reset port
+    enum_delay_ms(idx, ENUM_RESET_ROOT_DELAY_MS, ENUM_AFTER_RESET_ROOT_DELAY);
+  }
+}
+
+// Address 0 is released: continue with the next device waiting for it
+static void enum_dev0_next(void) {
+  if (_usbh_data.enum_dev0 != TUSB_INDEX_INVALID_8) {
+    return;
+  }
+  for (uint8_t idx = 0; idx < CFG_TUH_ENUMERATION_MAX; idx++) {
+    usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+    if (ctx->wait_dev0) {
+      ctx->wait_dev0 = false;
+      enum_port_reset(idx);
+      return;
+    }
+  }
+}
+
 // process async delay in enumeration
-static void enum_delay_async(uintptr_t state) {
-  tuh_bus_info_t *dev0_bus = &_usbh_data.dev0_bus;
+static void enum_delay_async(uintptr_t arg) {
+  const uint8_t idx = enum_arg_idx(arg);
+  TU_VERIFY(idx != TUSB_INDEX_INVALID_8, );
+  usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
+  const uint8_t state = (uint8_t) arg;
+
   switch (state) {
     case ENUM_AFTER_DEBOUNCING_DELAY:
   #if CFG_TUH_HUB
-      if (dev0_bus->hub_addr != 0) {
+      if (ctx->bus.hub_addr != 0) {
         // connected via hub
-        TU_VERIFY(dev0_bus->hub_port != 0, );
-        TU_ASSERT(hub_port_get_status(dev0_bus->hub_addr, dev0_bus->hub_port, NULL, process_enumeration,
-                                      ENUM_HUB_RERSET), );
+        TU_VERIFY(ctx->bus.hub_port != 0, );
+        TU_ASSERT(hub_port_get_status(ctx->bus.hub_addr, ctx->bus.hub_port, enum_buf(idx), process_enumeration,
+                                      enum_arg(idx, ENUM_HUB_RERSET)), );
       } else
   #endif
       {
         // connected directly to roothub
-        _usbh_data.attach_debouncing_bm &= (uint8_t)~TU_BIT(dev0_bus->rhport); // clear roothub debouncing delay
-        if (!hcd_port_connect_status(dev0_bus->rhport)) {
+        _usbh_data.attach_debouncing_bm &= (uint8_t)~TU_BIT(ctx->bus.rhport); // clear roothub debouncing delay
+        if (!hcd_port_connect_status(ctx->bus.rhport)) {
           TU_LOG_USBH("Device unplugged while debouncing\r\n");
-          enum_full_complete(false);
+          enum_full_complete(idx, false);
           return;
         }
-        hcd_port_reset(dev0_bus->rhport); // reset port
-        usbh_defer_func_ms_async(ENUM_RESET_ROOT_DELAY_MS, enum_delay_async, ENUM_AFTER_RESET_ROOT_DELAY);
+        enum_port_reset(idx);
       }
       break;
 
     case ENUM_AFTER_RESET_ROOT_DELAY:
-      hcd_port_reset_end(dev0_bus->rhport);
-      usbh_defer_func_ms_async(ENUM_RESET_ROOT_POST_DELAY_MS, enum_delay_async, ENUM_AFTER_RESET_ROOT_POST_DELAY);
+      hcd_port_reset_end(ctx->bus.rhport);
+      enum_delay_ms(idx, ENUM_RESET_ROOT_POST_DELAY_MS, ENUM_AFTER_RESET_ROOT_POST_DELAY);
       break;
 
     case ENUM_AFTER_RESET_ROOT_POST_DELAY:
-      if (!hcd_port_connect_status(dev0_bus->rhport)) {
+      if (!hcd_port_connect_status(ctx->bus.rhport)) {
         // device unplugged while delaying
-        enum_full_complete(false);
+        enum_full_complete(idx, false);
         return;
       }
 
-      dev0_bus->speed = hcd_port_speed_get(dev0_bus->rhport);
-      TU_LOG_USBH("%s Speed\r\n", tu_str_speed[dev0_bus->speed]);
+      ctx->bus.speed = hcd_port_speed_get(ctx->bus.rhport);
+      TU_LOG_USBH("%s Speed\r\n", tu_str_speed[ctx->bus.speed]);
 
       // fake transfer to kick-off the enumeration process
       tuh_xfer_t xfer;
       xfer.daddr     = 0;
       xfer.result    = XFER_RESULT_SUCCESS;
-      xfer.user_data = ENUM_ADDR0_DEVICE_DESC;
+      xfer.user_data = enum_arg(idx, ENUM_ADDR0_DEVICE_DESC);
       process_enumeration(&xfer);
       break;
 
@@ -1772,9 +2236,9 @@ static void enum_delay_async(uintptr_t state) {
     case ENUM_AFTER_RESET_HUB_DELAY:
     case ENUM_AFTER_RESET_HUB_DELAY_RETRY:
       // get status after reset complete to check for reset change
-      TU_ASSERT(hub_port_get_status(dev0_bus->hub_addr, dev0_bus->hub_port, NULL, process_enumeration,
-                                    state == ENUM_AFTER_RESET_HUB_DELAY ? ENUM_HUB_CLEAR_RESET
-                                                                        : ENUM_HUB_CLEAR_RESET_RETRY), );
+      TU_ASSERT(hub_port_get_status(ctx->bus.hub_addr, ctx->bus.hub_port, enum_buf(idx), process_enumeration,
+                                    enum_arg(idx, state == ENUM_AFTER_RESET_HUB_DELAY ? ENUM_HUB_CLEAR_RESET
+                                                                                      : ENUM_HUB_CLEAR_RESET_RETRY)), );
       break;
   #endif
 
@@ -1782,27 +2246,27 @@ static void enum_delay_async(uintptr_t state) {
       // TODO probably doesn't need to open/close each enumeration
       if (!usbh_edpt_control_open(0, 8)) {
         TU_LOG_USBH("Failed to open dev0's control endpoint\r\n");
-        enum_full_complete(false); // Stop enumeration gracefully
+        enum_full_complete(idx, false); // Stop enumeration gracefully
         return;
       }
       // Get first 8 bytes of device descriptor for control endpoint size
       TU_LOG_USBH("Get 8 byte of Device Descriptor\r\n");
-      TU_ASSERT(tuh_descriptor_get_device(0, _usbh_epbuf.ctrl, 8, process_enumeration, ENUM_SET_ADDR), );
+      TU_ASSERT(tuh_descriptor_get_device(0, enum_buf(idx), 8, process_enumeration, enum_arg(idx, ENUM_SET_ADDR)), );
       break;
 
     case ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY: {
-      const uint8_t  new_addr = _usbh_data.enumerating_daddr;
+      const uint8_t  new_addr = ctx->daddr;
       usbh_device_t *new_dev  = get_device(new_addr);
       TU_ASSERT(new_dev, );
       if (!usbh_edpt_control_open(new_addr, new_dev->desc_device.bMaxPacketSize0)) {
         TU_LOG_USBH("Failed to open new device's control endpoint\r\n");
         clear_device(new_dev);
-        enum_full_complete(false);
+        enum_full_complete(idx, false);
         return;
       }
       TU_LOG_USBH("Get Device Descriptor\r\n");
-      TU_ASSERT(tuh_descriptor_get_device(new_addr, _usbh_epbuf.ctrl, sizeof(tusb_desc_device_t), process_enumeration,
-                                          ENUM_GET_STRING_LANGUAGE_ID_LEN), );
+      TU_ASSERT(tuh_descriptor_get_device(new_addr, enum_buf(idx), sizeof(tusb_desc_device_t), process_enumeration,
+                                          enum_arg(idx, ENUM_GET_STRING_LANGUAGE_ID_LEN)), );
       break;
     }
 
@@ -1811,26 +2275,131 @@ static void enum_delay_async(uintptr_t state) {
   }
 }
 
-// start a new enumeration process
-static void enum_new_device(hcd_event_t *event) {
-  tuh_bus_info_t *dev0_bus = &_usbh_data.dev0_bus;
-  dev0_bus->rhport         = event->rhport;
-  dev0_bus->hub_addr       = event->connection.hub_addr;
-  dev0_bus->hub_port       = event->connection.hub_port;
-  usbh_defer_func_ms_async(ENUM_DEBOUNCING_DELAY_MS, enum_delay_async, ENUM_AFTER_DEBOUNCING_DELAY);
+// start a new enumeration process, return false if there is no free enumeration context
+static bool enum_new_device(hcd_event_t *event) {
+  const uint8_t idx = enum_find(TUSB_INDEX_INVALID_8);
+  TU_VERIFY(idx < CFG_TUH_ENUMERATION_MAX);
+
+  usbh_enum_t *ctx = &_usbh_data.enum_ctx[idx];
+  ctx->daddr        = 0; // enumerate new device with address 0
+  ctx->bus.rhport   = event->rhport;
+  ctx->bus.hub_addr = event->connection.hub_addr;
+  ctx->bus.hub_port = event->connection.hub_port;
+  ctx->bus.speed    = TUSB_SPEED_INVALID;
+#if CFG_TUH_ENUM_CACHE
+  ctx->cache_idx    = TUSB_INDEX_INVALID_8;
+  ctx->serial_len   = 0;
+  ctx->serial_hash  = 0;
+#endif
+  enum_delay_ms(idx, ENUM_DEBOUNCING_DELAY_MS, ENUM_AFTER_DEBOUNCING_DELAY);
+  return true;
+}
+
+#if CFG_TUH_ENUM_CACHE
+//--------------------------------------------------------------------+
+// Enumeration Cache
+// Known devices are identified by VID/PID/bcdDevice and the hash of their serial string. Their re-enumeration skips
+// string descriptors, reuses cached configuration descriptor (if its 9-byte header still matches) and interface
+// driver binding.
+//--------------------------------------------------------------------+
+// FNV-1a
+static uint32_t enum_cache_hash(const uint8_t *buf, uint16_t len) {
+  uint32_t hash = 2166136261u;
+  for (uint16_t i = 0; i < len; i++) {
+    hash ^= buf[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// find cache entry of a device, serial number is only compared if with_serial is true
+static uint8_t enum_cache_find(const usbh_device_t *dev, bool with_serial, uint8_t serial_len, uint32_t serial_hash) {
+  for (uint8_t i = 0; i < CFG_TUH_ENUM_CACHE; i++) {
+    const tuh_enum_cache_t *entry = &_usbh_enum_cache[i];
+    if (entry->valid && entry->vid == dev->desc_device.idVendor && entry->pid == dev->desc_device.idProduct &&
+        entry->bcd_device == dev->desc_device.bcdDevice &&
+        (entry->serial_len != 0) == (dev->desc_device.iSerialNumber != 0) &&
+        (!with_serial || (entry->serial_len == serial_len && entry->serial_hash == serial_hash))) {
+      return i;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+static void enum_cache_store(uint8_t idx, uint8_t daddr, uint8_t config_idx, const uint8_t *desc_cfg) {
+  const usbh_enum_t   *ctx = &_usbh_data.enum_ctx[idx];
+  const usbh_device_t *dev = get_device(daddr);
+  TU_VERIFY(dev != NULL, );
+
+  tuh_enum_cache_t entry;
+  tu_memclr(&entry, sizeof(entry));
+  entry.valid       = true;
+  entry.config_idx  = config_idx;
+  entry.vid         = dev->desc_device.idVendor;
+  entry.pid         = dev->desc_device.idProduct;
+  entry.bcd_device  = dev->desc_device.bcdDevice;
+  entry.langid      = ctx->langid;
+  entry.serial_len  = ctx->serial_len;
+  entry.serial_hash = ctx->serial_hash;
+  memcpy(entry.itf2drv, dev->itf2drv, CFG_TUH_INTERFACE_MAX);
+  memcpy(entry.config_header, desc_cfg, sizeof(entry.config_header));
+
+  const uint16_t total_len = tu_le16toh(tu_unaligned_read16(desc_cfg + offsetof(tusb_desc_configuration_t, wTotalLength)));
+  if (total_len <= CFG_TUH_ENUM_CACHE_CONFIG_SIZE) {
+    entry.config_len = total_len;
+    memcpy(entry.config, desc_cfg, total_len);
+  }
+
+  // same device updates its entry, otherwise take a free or the least recently used one
+  uint8_t slot = enum_cache_find(dev, true, entry.serial_len, entry.serial_hash);
+  if (slot == TUSB_INDEX_INVALID_8) {
+    slot = 0;
+    for (uint8_t i = 0; i < CFG_TUH_ENUM_CACHE; i++) {
+      if (!_usbh_enum_cache[i].valid) {
+        slot = i;
+        break;
+      }
+      if ((int32_t) (_usbh_enum_cache_used[i] - _usbh_enum_cache_used[slot]) < 0) {
+        slot = i;
+      }
+    }
+  }
+
+  _usbh_enum_cache_used[slot] = ++_usbh_enum_cache_seq;
+  if (0 != memcmp(&_usbh_enum_cache[slot], &entry, sizeof(entry))) {
+    memcpy(&_usbh_enum_cache[slot], &entry, sizeof(entry));
+    tuh_enum_cache_update_cb(slot, &entry);
+  }
+}
+
+bool tuh_enum_cache_set(uint8_t idx, const tuh_enum_cache_t *entry) {
+  TU_VERIFY(idx < CFG_TUH_ENUM_CACHE && entry != NULL);
+  memcpy(&_usbh_enum_cache[idx], entry, sizeof(tuh_enum_cache_t));
+  _usbh_enum_cache_used[idx] = ++_usbh_enum_cache_seq;
+  return true;
+}
+
+void tuh_enum_cache_clear(void) {
+  tu_memclr(_usbh_enum_cache, sizeof(_usbh_enum_cache));
+  tu_memclr(_usbh_enum_cache_used, sizeof(_usbh_enum_cache_used));
 }
+#endif
 
 // process device enumeration
 static void process_enumeration(tuh_xfer_t *xfer) {
+  const uint8_t idx = enum_arg_idx(xfer->user_data);
+  TU_VERIFY(idx != TUSB_INDEX_INVALID_8, ); // stale transfer of a released enumeration
+
   if (XFER_RESULT_FAILED == xfer->result) {
-    enum_full_complete(false); // failed to enum
+    enum_full_complete(idx, false); // failed to enum
     return;
   }
 
   const uint8_t   daddr    = xfer->daddr;
-  const uintptr_t state    = xfer->user_data;
+  const uint8_t   state    = (uint8_t) xfer->user_data;
   usbh_device_t  *dev      = get_device(daddr);
-  tuh_bus_info_t *dev0_bus = &_usbh_data.dev0_bus;
+  usbh_enum_t    *ctx      = &_usbh_data.enum_ctx[idx];
+  uint8_t        *ctrl_buf = enum_buf(idx);
   if (daddr > 0) {
     TU_ASSERT(dev != NULL,);
   }
@@ -1840,66 +2409,69 @@ static void process_enumeration(tuh_xfer_t *xfer) {
   switch (state) {
   #if CFG_TUH_HUB
     case ENUM_HUB_RERSET: {
-      hub_port_status_response_t port_status;
-      hub_port_get_status_local(dev0_bus->hub_addr, dev0_bus->hub_port, &port_status);
+      const hub_port_status_response_t *port_status = (const hub_port_status_response_t *) (uintptr_t) ctrl_buf;
 
-      if (0 == port_status.status.connection) {
+      if (0 == port_status->status.connection) {
         TU_LOG_USBH("Device unplugged from hub while debouncing\r\n");
         is_enum_failed = true;
       } else {
-        TU_ASSERT(hub_port_reset(dev0_bus->hub_addr, dev0_bus->hub_port, process_enumeration,
-                                 ENUM_HUB_RESET_COMPLETE), );
+        enum_port_reset(idx);
       }
       break;
     }
 
     case ENUM_HUB_RESET_COMPLETE:
       // wait for reset to take effect
-      usbh_defer_func_ms_async(ENUM_RESET_HUB_DELAY_MS, enum_delay_async, ENUM_AFTER_RESET_HUB_DELAY);
+      enum_delay_ms(idx, ENUM_RESET_HUB_DELAY_MS, ENUM_AFTER_RESET_HUB_DELAY);
       break;
 
     case ENUM_HUB_CLEAR_RESET:
     case ENUM_HUB_CLEAR_RESET_RETRY: {
-      hub_port_status_response_t port_status;
-      hub_port_get_status_local(dev0_bus->hub_addr, dev0_bus->hub_port, &port_status);
+      const hub_port_status_response_t *port_status = (const hub_port_status_response_t *) (uintptr_t) ctrl_buf;
 
-      if (1 == port_status.change.reset) {
+      if (1 == port_status->change.reset) {
         // Acknowledge Port Reset Change
-        TU_ASSERT(hub_port_clear_reset_change(dev0_bus->hub_addr, dev0_bus->hub_port, process_enumeration,
-                                              ENUM_HUB_CLEAR_RESET_COMPLETE), );
-      } else if (state == ENUM_HUB_CLEAR_RESET) {
-        // retry one more time if reset change not set yet
-        usbh_defer_func_ms_async(ENUM_RESET_HUB_DELAY_MS, enum_delay_async, ENUM_AFTER_RESET_HUB_DELAY_RETRY);
-      } else {
-        // retry but still not set --> failed
-        is_enum_failed = true;
+        TU_ASSERT(hub_port_clear_reset_change(ctx->bus.hub_addr, ctx->bus.hub_port, process_enumeration,
+                                              enum_arg(idx, ENUM_HUB_CLEAR_RESET_COMPLETE)), );
+        break;
+      } else if (!(port_status->status.port_enable && !port_status->status.reset)) {
+        if (state == ENUM_HUB_CLEAR_RESET) {
+          // retry one more time if reset change not set yet
+          enum_delay_ms(idx, ENUM_RESET_HUB_DELAY_MS, ENUM_AFTER_RESET_HUB_DELAY_RETRY);
+        } else {
+          // retry but still not set --> failed
+          is_enum_failed = true;
+        }
+        break;
       }
-      break;
+      // Reset is complete but its change is already acknowledged by hub driver (polling status of other ports
+      // while this one is enumerating), continue with the port status we got.
+      TU_ATTR_FALLTHROUGH;
     }
 
     case ENUM_HUB_CLEAR_RESET_COMPLETE: {
-      hub_port_status_response_t port_status;
-      hub_port_get_status_local(dev0_bus->hub_addr, dev0_bus->hub_port, &port_status);
+      // clear feature has no data stage, buffer still holds the status after reset
+      const hub_port_status_response_t *port_status = (const hub_port_status_response_t *) (uintptr_t) ctrl_buf;
 
-      if (0 == port_status.status.connection) {
+      if (0 == port_status->status.connection) {
         TU_LOG_USBH("Device unplugged from hub (not addressed yet)\r\n");
         is_enum_failed = true;
         break;
       }
 
-      dev0_bus->speed = (port_status.status.high_speed)  ? TUSB_SPEED_HIGH
-                        : (port_status.status.low_speed) ? TUSB_SPEED_LOW
+      ctx->bus.speed = (port_status->status.high_speed)  ? TUSB_SPEED_HIGH
+                       : (port_status->status.low_speed) ? TUSB_SPEED_LOW
                                                          : TUSB_SPEED_FULL;
       TU_ATTR_FALLTHROUGH;
     }
   #endif
 
     case ENUM_ADDR0_DEVICE_DESC:
-      usbh_defer_func_ms_async(ENUM_RESET_RECOVERY_DELAY_MS, enum_delay_async, ENUM_AFTER_RESET_RECOVERY_DELAY);
+      enum_delay_ms(idx, ENUM_RESET_RECOVERY_DELAY_MS, ENUM_AFTER_RESET_RECOVERY_DELAY);
       break;
 
     case ENUM_SET_ADDR: {
-      const tusb_desc_device_t *desc_device = (const tusb_desc_device_t *) _usbh_epbuf.ctrl;
+      const tusb_desc_device_t *desc_device = (const tusb_desc_device_t *) ctrl_buf;
       if (!(desc_device->bDescriptorType == TUSB_DESC_DEVICE && desc_device->bMaxPacketSize0 >= 8)) {
         TU_LOG_USBH("Invalid Device descriptor\r\n");
         is_enum_failed = true;
@@ -1910,11 +2482,11 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       TU_ASSERT(new_addr != 0,);
 
       usbh_device_t* new_dev = get_device(new_addr);
-      new_dev->bus_info = *dev0_bus;
+      new_dev->bus_info = ctx->bus;
       new_dev->connected = 1;
       new_dev->desc_device.bMaxPacketSize0 = desc_device->bMaxPacketSize0;
 
-      TU_ASSERT(tuh_address_set(0, new_addr, process_enumeration, ENUM_GET_DEVICE_DESC), );
+      TU_ASSERT(tuh_address_set(0, new_addr, process_enumeration, enum_arg(idx, ENUM_GET_DEVICE_DESC)), );
       break;
     }
 
@@ -1922,11 +2494,15 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       const uint8_t  new_addr = (uint8_t)tu_le16toh(xfer->setup->wValue);
       usbh_device_t *new_dev  = get_device(new_addr);
       TU_ASSERT(new_dev, );
-      new_dev->addressed           = 1;
-      _usbh_data.enumerating_daddr = new_addr;
+      new_dev->addressed = 1;
+      ctx->daddr         = new_addr;
 
-      usbh_device_close(dev0_bus->rhport, 0); // close dev0
-      usbh_defer_func_ms_async(ENUM_SET_ADDRESS_RECOVERY_DELAY_MS, enum_delay_async, ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY);
+      // release dev0 and let the next waiting device reset its port
+      _usbh_data.enum_dev0 = TUSB_INDEX_INVALID_8;
+      usbh_device_close(ctx->bus.rhport, 0); // close dev0
+      enum_dev0_next();
+
+      enum_delay_ms(idx, ENUM_SET_ADDRESS_RECOVERY_DELAY_MS, ENUM_AFTER_SET_ADDRESS_RECOVERY_DELAY);
       break;
     }
 
@@ -1934,31 +2510,67 @@ static void process_enumeration(tuh_xfer_t *xfer) {
     // to determine the length first. otherwise, some device may have buffer overflow.
     case ENUM_GET_STRING_LANGUAGE_ID_LEN: {
       // save the received device descriptor
-      tusb_desc_device_t const *desc_device = (tusb_desc_device_t const *) _usbh_epbuf.ctrl;
+      tusb_desc_device_t const *desc_device = (tusb_desc_device_t const *) ctrl_buf;
 
       memcpy(&dev->desc_device, (const uint8_t*) desc_device + offsetof(tusb_desc_device_t, bcdUSB), sizeof(desc_device_noheader_t));
 
       tuh_enum_descriptor_device_cb(daddr, desc_device); // callback
-      tuh_descriptor_get_string_langid(daddr, _usbh_epbuf.ctrl, 2,
-                                       process_enumeration, ENUM_GET_STRING_LANGUAGE_ID);
+
+  #if CFG_TUH_ENUM_CACHE
+      // Known device: skip string descriptors, serial number is still needed since it is part of the key
+      ctx->cache_idx = enum_cache_find(dev, false, 0, 0);
+      if (ctx->cache_idx != TUSB_INDEX_INVALID_8) {
+        const tuh_enum_cache_t *entry = &_usbh_enum_cache[ctx->cache_idx];
+        TU_LOG_USBH("Enumeration cache hit [%u]\r\n", ctx->cache_idx);
+        if (entry->serial_len != 0) {
+          TU_ASSERT(tuh_descriptor_get_string(daddr, dev->desc_device.iSerialNumber, entry->langid, ctrl_buf,
+                                              entry->serial_len, process_enumeration, enum_arg(idx, ENUM_CACHE_SERIAL)),);
+        } else {
+          TU_ASSERT(tuh_descriptor_get_configuration(daddr, entry->config_idx, ctrl_buf, 9, process_enumeration,
+                                                     enum_arg(idx, ENUM_CACHE_CONFIG_HEADER)),);
+        }
+        break;
+      }
+  #endif
+
+      tuh_descriptor_get_string_langid(daddr, ctrl_buf, 2,
+                                       process_enumeration, enum_arg(idx, ENUM_GET_STRING_LANGUAGE_ID));
       break;
     }
 
+  #if CFG_TUH_ENUM_CACHE
+    case ENUM_CACHE_SERIAL:
+      ctx->langid      = tu_le16toh(xfer->setup->wIndex);
+      ctx->serial_len  = (uint8_t) xfer->actual_len;
+      ctx->serial_hash = enum_cache_hash(ctrl_buf, ctx->serial_len);
+      ctx->cache_idx   = enum_cache_find(dev, true, ctx->serial_len, ctx->serial_hash);
+      if (ctx->cache_idx == TUSB_INDEX_INVALID_8) {
+        // another device with the same VID/PID/bcdDevice: full enumeration
+        TU_LOG_USBH("Enumeration cache miss: serial number\r\n");
+        tuh_descriptor_get_string_langid(daddr, ctrl_buf, 2,
+                                         process_enumeration, enum_arg(idx, ENUM_GET_STRING_LANGUAGE_ID));
+      } else {
+        TU_ASSERT(tuh_descriptor_get_configuration(daddr, _usbh_enum_cache[ctx->cache_idx].config_idx, ctrl_buf, 9,
+                                                   process_enumeration, enum_arg(idx, ENUM_CACHE_CONFIG_HEADER)),);
+      }
+      break;
+  #endif
+
     case ENUM_GET_STRING_LANGUAGE_ID: {
       const uint8_t str_len = xfer->buffer[0];
-      tuh_descriptor_get_string_langid(daddr, _usbh_epbuf.ctrl, str_len,
-                                       process_enumeration, ENUM_GET_STRING_MANUFACTURER_LEN);
+      tuh_descriptor_get_string_langid(daddr, ctrl_buf, str_len,
+                                       process_enumeration, enum_arg(idx, ENUM_GET_STRING_MANUFACTURER_LEN));
       break;
     }
 
     case ENUM_GET_STRING_MANUFACTURER_LEN: {
-      const tusb_desc_string_t* desc_langid = (const tusb_desc_string_t *) _usbh_epbuf.ctrl;
+      const tusb_desc_string_t* desc_langid = (const tusb_desc_string_t *) ctrl_buf;
       if (desc_langid->bLength >= 4) {
         langid = tu_le16toh(desc_langid->utf16le[0]); // previous request is langid
       }
       if (dev->desc_device.iManufacturer != 0) {
-        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, _usbh_epbuf.ctrl, 2,
-                                  process_enumeration, ENUM_GET_STRING_MANUFACTURER);
+        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, ctrl_buf, 2,
+                                  process_enumeration, enum_arg(idx, ENUM_GET_STRING_MANUFACTURER));
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -1968,8 +2580,8 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iManufacturer != 0)  {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, _usbh_epbuf.ctrl, str_len,
-                                  process_enumeration, ENUM_GET_STRING_PRODUCT_LEN);
+        tuh_descriptor_get_string(daddr, dev->desc_device.iManufacturer, langid, ctrl_buf, str_len,
+                                  process_enumeration, enum_arg(idx, ENUM_GET_STRING_PRODUCT_LEN));
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -1981,7 +2593,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
           langid = tu_le16toh(xfer->setup->wIndex); // get langid from previous setup packet if not fall through
         }
         tuh_descriptor_get_string(
-            daddr, dev->desc_device.iProduct, langid, _usbh_epbuf.ctrl, 2, process_enumeration, ENUM_GET_STRING_PRODUCT);
+            daddr, dev->desc_device.iProduct, langid, ctrl_buf, 2, process_enumeration, enum_arg(idx, ENUM_GET_STRING_PRODUCT));
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -1991,8 +2603,8 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iProduct != 0) {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iProduct, langid, _usbh_epbuf.ctrl, str_len,
-                            process_enumeration, ENUM_GET_STRING_SERIAL_LEN);
+        tuh_descriptor_get_string(daddr, dev->desc_device.iProduct, langid, ctrl_buf, str_len,
+                            process_enumeration, enum_arg(idx, ENUM_GET_STRING_SERIAL_LEN));
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -2004,7 +2616,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
           langid = tu_le16toh(xfer->setup->wIndex); // get langid from previous setup packet if not fall through
         }
         tuh_descriptor_get_string(
-            daddr, dev->desc_device.iSerialNumber, langid, _usbh_epbuf.ctrl, 2, process_enumeration, ENUM_GET_STRING_SERIAL);
+            daddr, dev->desc_device.iSerialNumber, langid, ctrl_buf, 2, process_enumeration, enum_arg(idx, ENUM_GET_STRING_SERIAL));
         break;
       }
       TU_ATTR_FALLTHROUGH;
@@ -2014,24 +2626,54 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       if (dev->desc_device.iSerialNumber != 0) {
         langid = tu_le16toh(xfer->setup->wIndex); // langid from length's request
         const uint8_t str_len = xfer->buffer[0];
-        tuh_descriptor_get_string(daddr, dev->desc_device.iSerialNumber, langid, _usbh_epbuf.ctrl, str_len,
-                                  process_enumeration, ENUM_GET_9BYTE_CONFIG_DESC);
+        tuh_descriptor_get_string(daddr, dev->desc_device.iSerialNumber, langid, ctrl_buf, str_len,
+                                  process_enumeration, enum_arg(idx, ENUM_GET_9BYTE_CONFIG_DESC));
         break;
       }
       TU_ATTR_FALLTHROUGH;
     }
 
     case ENUM_GET_9BYTE_CONFIG_DESC: {
+  #if CFG_TUH_ENUM_CACHE
+      if (state == ENUM_GET_9BYTE_CONFIG_DESC) {
+        // not fall through: previous request is the serial string, save it as cache key
+        ctx->langid      = tu_le16toh(xfer->setup->wIndex);
+        ctx->serial_len  = (uint8_t) xfer->actual_len;
+        ctx->serial_hash = enum_cache_hash(ctrl_buf, ctx->serial_len);
+      }
+  #endif
       // Get 9-byte for total length
       uint8_t const config_idx = 0;
       TU_LOG_USBH("Get Configuration[%u] Descriptor (9 bytes)\r\n", config_idx);
-      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, 9,
-                                                 process_enumeration, ENUM_GET_FULL_CONFIG_DESC),);
+      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, ctrl_buf, 9,
+                                                 process_enumeration, enum_arg(idx, ENUM_GET_FULL_CONFIG_DESC)),);
       break;
     }
 
+  #if CFG_TUH_ENUM_CACHE
+    case ENUM_CACHE_CONFIG_HEADER: {
+      const tuh_enum_cache_t *entry = &_usbh_enum_cache[ctx->cache_idx];
+      if (0 == memcmp(ctrl_buf, entry->config_header, sizeof(entry->config_header))) {
+        if (entry->config_len != 0) {
+          // reuse cached configuration descriptor
+          memcpy(ctrl_buf, entry->config, entry->config_len);
+          if (tuh_enum_descriptor_configuration_cb(daddr, entry->config_idx, (const tusb_desc_configuration_t *) ctrl_buf)) {
+            TU_ASSERT(tuh_configuration_set(daddr, entry->config_idx + 1u, process_enumeration,
+                                            enum_arg(idx, ENUM_CONFIG_DRIVER)),);
+            break;
+          }
+        }
+      } else {
+        TU_LOG_USBH("Enumeration cache miss: configuration changed\r\n");
+        ctx->cache_idx = TUSB_INDEX_INVALID_8;
+      }
+      // get full configuration descriptor with the header we got
+      TU_ATTR_FALLTHROUGH;
+    }
+  #endif
+
     case ENUM_GET_FULL_CONFIG_DESC: {
-      uint8_t const* desc_config = _usbh_epbuf.ctrl;
+      uint8_t const* desc_config = ctrl_buf;
 
       // Use offsetof to avoid pointer to the odd/misaligned address
       uint16_t const total_len = tu_le16toh(tu_unaligned_read16(desc_config + offsetof(tusb_desc_configuration_t, wTotalLength)));
@@ -2042,21 +2684,21 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       // Get full configuration descriptor
       uint8_t const config_idx = (uint8_t) tu_le16toh(xfer->setup->wIndex);
       TU_LOG_USBH("Get Configuration[%u] Descriptor\r\n", config_idx);
-      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, total_len,
-                                                 process_enumeration, ENUM_SET_CONFIG),);
+      TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, ctrl_buf, total_len,
+                                                 process_enumeration, enum_arg(idx, ENUM_SET_CONFIG)),);
       break;
     }
 
     case ENUM_SET_CONFIG: {
       uint8_t config_idx = (uint8_t) tu_le16toh(xfer->setup->wIndex);
-      if (tuh_enum_descriptor_configuration_cb(daddr, config_idx, (const tusb_desc_configuration_t*) _usbh_epbuf.ctrl)) {
-        TU_ASSERT(tuh_configuration_set(daddr, config_idx+1u, process_enumeration, ENUM_CONFIG_DRIVER),);
+      if (tuh_enum_descriptor_configuration_cb(daddr, config_idx, (const tusb_desc_configuration_t*) ctrl_buf)) {
+        TU_ASSERT(tuh_configuration_set(daddr, config_idx+1u, process_enumeration, enum_arg(idx, ENUM_CONFIG_DRIVER)),);
       } else {
         config_idx++;
         TU_ASSERT(config_idx < dev->desc_device.bNumConfigurations,);
         TU_LOG_USBH("Get Configuration[%u] Descriptor (9 bytes)\r\n", config_idx);
-        TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, _usbh_epbuf.ctrl, 9,
-                                                   process_enumeration, ENUM_GET_FULL_CONFIG_DESC),);
+        TU_ASSERT(tuh_descriptor_get_configuration(daddr, config_idx, ctrl_buf, 9,
+                                                   process_enumeration, enum_arg(idx, ENUM_GET_FULL_CONFIG_DESC)),);
       }
       break;
     }
@@ -2065,16 +2707,27 @@ static void process_enumeration(tuh_xfer_t *xfer) {
       TU_LOG_USBH("Device configured\r\n");
       dev->configured = 1;
 
-  #if CFG_TUH_HUB
+  #if CFG_TUH_HUB && CFG_TUH_ENUMERATION_MAX == 1
       // get next hub status now since device can be unplugged before set_configure() is complete
-      if (_usbh_data.dev0_bus.hub_addr != 0) {
-        hub_edpt_status_xfer(_usbh_data.dev0_bus.hub_addr);
+      if (ctx->bus.hub_addr != 0) {
+        hub_edpt_status_xfer(ctx->bus.hub_addr);
       }
   #endif
 
-      // Parse configuration & set up drivers
+      // Parse configuration & set up drivers, known device starts with drivers bound last time
       // driver_open() must not make any usb transfer
-      TU_ASSERT(enum_parse_configuration_desc(daddr, (tusb_desc_configuration_t*) _usbh_epbuf.ctrl),);
+  #if CFG_TUH_ENUM_CACHE
+      const uint8_t *drv_hint =
+        (ctx->cache_idx != TUSB_INDEX_INVALID_8) ? _usbh_enum_cache[ctx->cache_idx].itf2drv : NULL;
+  #else
+      const uint8_t *drv_hint = NULL;
+  #endif
+      TU_ASSERT(enum_parse_configuration_desc(daddr, (tusb_desc_configuration_t*) ctrl_buf, drv_hint),);
+
+  #if CFG_TUH_ENUM_CACHE
+      // save before class drivers can use the enumeration buffer in set_config()
+      enum_cache_store(idx, daddr, (uint8_t) (tu_le16toh(xfer->setup->wValue) - 1u), ctrl_buf);
+  #endif
 
       // Start the Set Configuration process for interfaces (itf = TUSB_INDEX_INVALID_8)
       // Since driver can perform control transfer within its set_config, this is done asynchronously.
@@ -2090,7 +2743,7 @@ static void process_enumeration(tuh_xfer_t *xfer) {
   }
 
   if (is_enum_failed) {
-    enum_full_complete(false);
+    enum_full_complete(idx, false);
   }
 }
 
@@ -2121,7 +2774,8 @@ static uint8_t enum_get_new_address(bool is_hub) {
   return 0; // invalid address
 }
 
-static bool enum_parse_configuration_desc(uint8_t dev_addr, tusb_desc_configuration_t const* desc_cfg) {
+static bool enum_parse_configuration_desc(uint8_t dev_addr, tusb_desc_configuration_t const* desc_cfg,
+                                          const uint8_t *drv_hint) {
   usbh_device_t* dev = get_device(dev_addr);
   uint16_t const total_len = tu_le16toh(desc_cfg->wTotalLength);
   uint8_t const* desc_end = ((uint8_t const*) desc_cfg) + total_len;
@@ -2148,20 +2802,24 @@ static bool enum_parse_configuration_desc(uint8_t dev_addr, tusb_desc_configurat
     // uint16_t const drv_len = tu_desc_get_interface_total_len(desc_itf, assoc_itf_count, (uint16_t)
     // (desc_end-p_desc)); TU_ASSERT(drv_len >= sizeof(tusb_desc_interface_t));
 
-    // Find a driver for this interface
+    // Find a driver for this interface, try the hinted driver (if any) first
     const uint16_t remaining_len = (uint16_t)(desc_end - p_desc);
-    uint8_t        drv_id;
-    for (drv_id = 0; drv_id < TOTAL_DRIVER_COUNT; drv_id++) {
-      const usbh_class_driver_t *driver = get_driver(drv_id);
-      if (driver) {
+    const uint8_t  hint_id = (drv_hint != NULL && desc_itf->bInterfaceNumber < CFG_TUH_INTERFACE_MAX) ?
+                              drv_hint[desc_itf->bInterfaceNumber] : TUSB_INDEX_INVALID_8;
+    uint8_t drv_id = TOTAL_DRIVER_COUNT;
+    for (uint8_t i = 0; i <= TOTAL_DRIVER_COUNT; i++) {
+      const uint8_t try_id = (i == 0) ? hint_id : (uint8_t) (i - 1);
+      const usbh_class_driver_t *driver = get_driver(try_id);
+      if (driver && (i == 0 || try_id != hint_id)) {
         const uint16_t drv_len = driver->open(dev->bus_info.rhport, dev_addr, desc_itf, remaining_len);
         if ((sizeof(tusb_desc_interface_t) <= drv_len) && (drv_len <= remaining_len)) {
           // open successfully
           TU_LOG_USBH("  %s opened\r\n", driver->name);
 
           // bind found driver to all interfaces and endpoint within drv_len
-          tu_bind_driver_to_ep_itf(drv_id, dev->ep2drv, dev->itf2drv, CFG_TUH_INTERFACE_MAX, p_desc, drv_len);
+          tu_bind_driver_to_ep_itf(try_id, dev->ep2drv, dev->itf2drv, CFG_TUH_INTERFACE_MAX, p_desc, drv_len);
 
+          drv_id = try_id;
           p_desc += drv_len; // next Interface
           break;             // exit driver find loop
         }
@@ -2198,7 +2856,7 @@ void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num) {
 
   // all interfaces are configured
   if (itf_num == CFG_TUH_INTERFACE_MAX) {
-    enum_full_complete(true);
+    enum_full_complete(enum_find(dev_addr), true);
 
     if (is_hub_addr(dev_addr)) {
       TU_LOG_USBH("HUB address = %u is mounted\r\n", dev_addr);
@@ -2209,19 +2867,27 @@ void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num) {
   }
 }
 
-static void enum_full_complete(bool success) {
+static void enum_full_complete(uint8_t idx, bool success) {
   (void)success;
   TU_LOG_USBH("Enumeration complete: success = %u\r\n", success);
+  TU_VERIFY(idx < CFG_TUH_ENUMERATION_MAX, );
+  usbh_enum_t* ctx = &_usbh_data.enum_ctx[idx];
 
-  _usbh_data.enumerating_daddr = TUSB_INDEX_INVALID_8; // mark enumeration as complete
-  _usbh_data.call_after.func = NULL;
-
-  #if CFG_TUH_HUB
+  #if CFG_TUH_HUB && CFG_TUH_ENUMERATION_MAX == 1
   // Hub status is already requested in case of successful enumeration
-  if (!success && _usbh_data.dev0_bus.hub_addr != 0) {
-    hub_edpt_status_xfer(_usbh_data.dev0_bus.hub_addr);
+  if (!success && ctx->bus.hub_addr != 0) {
+    hub_edpt_status_xfer(ctx->bus.hub_addr);
   }
   #endif
+
+  // failed while owning address 0: close dev0 for the next device
+  if (_usbh_data.enum_dev0 == idx) {
+    _usbh_data.enum_dev0 = TUSB_INDEX_INVALID_8;
+    usbh_device_close(ctx->bus.rhport, 0);
+  }
+
+  enum_release(idx); // mark enumeration as complete
+  enum_dev0_next();
 }
 
 #endif
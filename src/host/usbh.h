@@ -53,6 +53,26 @@ struct tuh_xfer_s {
   // uint32_t timeout_ms;    // place holder, not supported yet
 };
 
+struct tuh_iso_xfer_s;
+typedef struct tuh_iso_xfer_s tuh_iso_xfer_t;
+typedef void (*tuh_iso_xfer_cb_t)(tuh_iso_xfer_t* xfer);
+
+// Isochronous transfer of a frame list: packet_count packets, one per service interval, stored back to back in
+// buffer. Each packet is at most the endpoint's max packet size (times transactions per micro-frame for highspeed).
+struct tuh_iso_xfer_s {
+  uint8_t daddr;
+  uint8_t ep_addr;
+  uint16_t packet_count;
+  xfer_result_t result;      // failed only if no packet got through, see packets[] for per-packet result
+
+  uint32_t actual_len;       // sum of packets' actual_len
+
+  uint8_t* buffer;
+  tu_iso_packet_t* packets;  // per-packet length, actual_len and result are updated on completion
+  tuh_iso_xfer_cb_t complete_cb;
+  uintptr_t user_data;
+};
+
 // Subject to change
 typedef struct {
   uint8_t daddr;
@@ -70,6 +90,24 @@ typedef struct {
 #define hcd_devtree_info_t tuh_bus_info_t
 #define hcd_devtree_get_info(_daddr, _bus_info) tuh_bus_info_get(_daddr, _bus_info)
 
+#if CFG_TUH_ENUM_CACHE
+// Enumeration cache entry of a known device. Driver IDs are only valid for the same firmware build
+typedef struct {
+  bool     valid;
+  uint8_t  config_idx;      // configuration index selected by tuh_enum_descriptor_configuration_cb()
+  uint16_t vid;
+  uint16_t pid;
+  uint16_t bcd_device;
+  uint16_t langid;          // langid used to get serial string
+  uint8_t  serial_len;      // length of serial string descriptor, 0 if there is none
+  uint32_t serial_hash;     // hash of serial string descriptor
+  uint8_t  itf2drv[CFG_TUH_INTERFACE_MAX]; // driver bound to each interface number
+  uint8_t  config_header[9];               // for validating cached configuration descriptor
+  uint16_t config_len;      // length of cached configuration, 0 if it is larger than CFG_TUH_ENUM_CACHE_CONFIG_SIZE
+  uint8_t  config[CFG_TUH_ENUM_CACHE_CONFIG_SIZE];
+} tuh_enum_cache_t;
+#endif
+
 // ConfigID for tuh_configure()
 enum {
   TUH_CFGID_INVALID = 0,
@@ -125,6 +163,12 @@ void tuh_umount_cb(uint8_t daddr);
 // Invoked when there is a new usb event, which need to be processed by tuh_task()/tuh_task_ext()
 void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr);
 
+#if CFG_TUH_ENUM_CACHE
+// Invoked when an enumeration cache entry is added or changed. Application can save it to non-volatile memory
+// and restore it with tuh_enum_cache_set() after reboot
+void tuh_enum_cache_update_cb(uint8_t idx, const tuh_enum_cache_t* entry);
+#endif
+
 //--------------------------------------------------------------------+
 // APPLICATION API
 //--------------------------------------------------------------------+
@@ -259,6 +303,30 @@ bool tuh_edpt_close(uint8_t daddr, uint8_t ep_addr);
 // Return true if a queued transfer is aborted, false if there is no transfer to abort
 bool tuh_edpt_abort_xfer(uint8_t daddr, uint8_t ep_addr);
 
+#if CFG_TUH_ISO_EP_MAX
+// Submit an isochronous transfer, complete_cb is required. Up to 2 transfers can be queued per endpoint: the second
+// one is scheduled right after the first so that the stream has no gap. Resubmitting in complete_cb keeps streaming.
+// xfer (and its buffer, packets) must stay valid until its complete_cb is invoked.
+bool tuh_iso_xfer(tuh_iso_xfer_t* xfer);
+#endif
+
+#if CFG_TUH_EDPT_STATS
+// Get transfer statistics of a device endpoint, kept until device is removed. Control stages are recorded as
+// separate transfers on EP0. Latency is measured from submission to completion reported by the controller driver.
+bool tuh_edpt_stats_get(uint8_t daddr, uint8_t ep_addr, tu_edpt_stats_t* stats);
+
+// Reset statistics of all endpoints of a device
+void tuh_edpt_stats_clear(uint8_t daddr);
+#endif
+
+#if CFG_TUH_ENUM_CACHE
+// Restore an enumeration cache entry e.g from non-volatile memory, idx < CFG_TUH_ENUM_CACHE
+bool tuh_enum_cache_set(uint8_t idx, const tuh_enum_cache_t* entry);
+
+// Forget all known devices
+void tuh_enum_cache_clear(void);
+#endif
+
 // Set Address (control transfer)
 bool tuh_address_set(uint8_t daddr, uint8_t new_addr,
                      tuh_xfer_cb_t complete_cb, uintptr_t user_data);
@@ -11,6 +11,7 @@
 #include "osal/osal.h"
 #include "common/tusb_fifo.h"
 #include "common/tusb_private.h"
+#include "usbh.h"
 
 #ifdef __cplusplus
  extern "C" {
@@ -45,7 +46,8 @@ void usbh_driver_set_config_complete(uint8_t dev_addr, uint8_t itf_num);
 
 uint8_t usbh_get_rhport(uint8_t daddr);
 
-uint8_t* usbh_get_enum_buf(void);
+// Get enumeration buffer of a device, only valid until its enumeration (including set_config) is complete
+uint8_t* usbh_get_enum_buf(uint8_t daddr);
 
 void usbh_int_set(bool enabled);
 
@@ -54,6 +54,21 @@ typedef void (*osal_task_func_t)(void* param);
   #error OS is not supported yet
 #endif
 
+// Batch receive for ports without a native one: wait up to msec for the first item, then take the ones already
+// queued. item_size must match the queue definition.
+#ifndef OSAL_QUEUE_RECEIVE_N
+TU_ATTR_ALWAYS_INLINE static inline uint16_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint16_t item_size,
+                                                                  uint16_t max_count, uint32_t msec) {
+  uint8_t* p_item = (uint8_t*) data;
+  uint16_t count = 0;
+  while (count < max_count && osal_queue_receive(qhdl, p_item, (count == 0) ? msec : 0)) {
+    p_item += item_size;
+    count++;
+  }
+  return count;
+}
+#endif
+
 /*--------------------------------------------------------------------
   OSAL Porting API
   Should be implemented as static inline function in osal_port.h header
@@ -81,6 +96,7 @@ typedef void (*osal_task_func_t)(void* param);
     osal_queue_t osal_queue_create(osal_queue_def_t* qdef);
     bool osal_queue_delete(osal_queue_t qhdl);
     bool osal_queue_receive(osal_queue_t qhdl, void* data, uint32_t msec);
+    uint16_t osal_queue_receive_n(osal_queue_t qhdl, void* data, uint16_t item_size, uint16_t max_count, uint32_t msec); // optional
     bool osal_queue_send(osal_queue_t qhdl, void const * data, bool in_isr);
     bool osal_queue_empty(osal_queue_t qhdl);
 --------------------------------------------------------------------------*/
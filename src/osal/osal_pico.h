@@ -153,6 +153,20 @@ TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_receive(osal_queue_t qhdl, v
   return success;
 }
 
+// Receive up to max_count items in a single critical section
+#define OSAL_QUEUE_RECEIVE_N 1
+TU_ATTR_ALWAYS_INLINE static inline uint16_t osal_queue_receive_n(osal_queue_t qhdl, void *data, uint16_t item_size,
+                                                                  uint16_t max_count, uint32_t msec) {
+  (void)msec; // not used, always behave as msec = 0
+  (void)item_size;
+
+  critical_section_enter_blocking(&qhdl->critsec);
+  const uint16_t count = tu_fifo_read_n(&qhdl->ff, data, (uint16_t)(max_count * qhdl->item_size));
+  critical_section_exit(&qhdl->critsec);
+
+  return (uint16_t)(count / qhdl->item_size);
+}
+
 TU_ATTR_ALWAYS_INLINE static inline bool osal_queue_send(osal_queue_t qhdl, const void *data, bool in_isr) {
   (void)in_isr;
 
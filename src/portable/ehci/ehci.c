@@ -54,6 +54,85 @@
 #define QHD_MAX      (CFG_TUH_DEVICE_MAX*CFG_TUH_ENDPOINT_MAX + CFG_TUH_HUB)
 #define QTD_MAX      QHD_MAX
 
+// Number of isochronous endpoints that can be opened at the same time, 0 to disable isochronous support
+#ifndef CFG_TUH_EHCI_ISO_EP_MAX
+  #define CFG_TUH_EHCI_ISO_EP_MAX   0
+#endif
+
+// Isochronous TD pools: iTD for highspeed, siTD for full-speed (split) endpoints. Each TD serves one endpoint
+// for one frame, a transfer takes as many TDs as frames it spans.
+#ifndef CFG_TUH_EHCI_ITD_MAX
+  #define CFG_TUH_EHCI_ITD_MAX      (8*CFG_TUH_EHCI_ISO_EP_MAX)
+#endif
+
+#ifndef CFG_TUH_EHCI_SITD_MAX
+  #define CFG_TUH_EHCI_SITD_MAX     (8*CFG_TUH_EHCI_ISO_EP_MAX)
+#endif
+
+// Periodic bandwidth budget, simplified bus time of USB 2.0 5.11.3 in bytes: periodic transfers may use 80% of a
+// micro-frame on highspeed and 90% of a frame on full-speed (behind transaction translator). The budget is tracked
+// over 8 frames which is the period of the interval tree, longer intervals are served every 8 ms.
+enum {
+  BW_FRAMES         = 8,
+  BW_HS_UFRAME_MAX  = 6000,
+  BW_FS_FRAME_MAX   = 1350,
+  BW_HS_OVERHEAD    = 40,
+  BW_FS_OVERHEAD    = 16,
+  BW_SPLIT_BYTES    = 188, // max full-speed bytes per micro-frame
+};
+
+// Periodic bandwidth reservation of an endpoint
+typedef struct {
+  uint8_t  period;  // frames: 1, 2, 4 or 8
+  uint8_t  phase;   // first frame, less than period
+  uint8_t  smask;   // micro-frames of (start-split) transactions
+  uint8_t  cmask;   // micro-frames of complete-split transactions
+  uint16_t hs_cost; // highspeed bus bytes in each micro-frame of smask and cmask
+  uint16_t fs_cost; // full-speed bus bytes in each frame, 0 for highspeed endpoint
+} ehci_bw_t;
+
+#if CFG_TUH_EHCI_ISO_EP_MAX
+// Transfers queued per iso endpoint, next one is scheduled right after the current one
+#define ISO_XFER_QUEUE  2
+
+// Isochronous transfer, each packet takes a transaction (iTD) or a siTD
+typedef struct {
+  uint8_t* buffer;
+  tu_iso_packet_t* packets; // NULL if submitted by hcd_edpt_xfer(): buffer is split into max size packets
+  uint32_t buflen;
+  uint16_t packet_count;
+  uint32_t last_frame;      // frame of the last TD
+} ehci_iso_xfer_t;
+
+// Isochronous endpoint, its TDs are linked directly in the frame list (ahead of the interval tree)
+typedef struct {
+  uint8_t  dev_addr;
+  uint8_t  ep_addr;     // 0 if not opened
+  uint8_t  speed;
+  uint8_t  interval_uf; // service interval in micro-frames, up to 8 ms
+  uint16_t max_packet_size;
+  uint16_t packet_size; // bytes per service interval: max packet size * mult
+  uint8_t  mult;
+  uint8_t  hub_addr;
+  uint8_t  hub_port;
+  uint8_t  xfer_head;   // oldest queued transfer
+  volatile uint8_t xfer_count;
+  ehci_bw_t bw;
+  uint32_t next_frame;  // frame after the last scheduled one, next transfer continues from here
+  ehci_iso_xfer_t xfer[ISO_XFER_QUEUE];
+} ehci_iso_ep_t;
+
+// Software state of an iTD/siTD
+typedef struct {
+  uint8_t  owner;     // iso endpoint index + 1, 0 if free
+  uint8_t  slot;      // frame list slot where TD is linked
+  uint8_t  xfer;      // index of transfer in endpoint queue
+  uint8_t  xact_mask; // iTD: scheduled transactions
+  uint16_t packet;    // first packet of TD
+  uint16_t length;    // siTD: requested bytes
+} ehci_iso_td_info_t;
+#endif
+
 typedef struct {
   ehci_link_t period_framelist[FRAMELIST_SIZE];
 
@@ -71,6 +150,18 @@ typedef struct {
   ehci_qhd_t qhd_pool[QHD_MAX];
   ehci_qtd_t qtd_pool[QTD_MAX] TU_ATTR_ALIGNED(32);
 
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  ehci_itd_t  itd_pool[CFG_TUH_EHCI_ITD_MAX];
+  ehci_sitd_t sitd_pool[CFG_TUH_EHCI_SITD_MAX];
+  ehci_iso_td_info_t itd_info[CFG_TUH_EHCI_ITD_MAX];
+  ehci_iso_td_info_t sitd_info[CFG_TUH_EHCI_SITD_MAX];
+  ehci_iso_ep_t iso_ep[CFG_TUH_EHCI_ISO_EP_MAX];
+#endif
+
+  // bytes reserved by periodic endpoints in each micro-frame (highspeed) and frame (full-speed)
+  uint16_t bw_hs[BW_FRAMES][8];
+  uint16_t bw_fs[BW_FRAMES];
+
   ehci_registers_t* regs;         // operational register
   ehci_cap_registers_t* cap_regs; // capability register
 
@@ -148,6 +239,20 @@ TU_ATTR_ALWAYS_INLINE static inline void list_insert (ehci_link_t *current, ehci
 TU_ATTR_ALWAYS_INLINE static inline void list_remove(ehci_link_t* head, ehci_link_t* prev, ehci_qhd_t* qhd);
 static void list_remove_qhd_by_addr(ehci_link_t *list_head, uint8_t dev_addr, uint8_t ep_addr);
 
+static bool bw_reserve(ehci_bw_t* bw, bool fixed_phase);
+static void bw_apply(ehci_bw_t const* bw, bool add);
+static void qhd_bw_get(ehci_qhd_t const* qhd, ehci_bw_t* bw);
+
+#if CFG_TUH_EHCI_ISO_EP_MAX
+static ehci_iso_ep_t* iso_ep_find(uint8_t dev_addr, uint8_t ep_addr);
+static bool iso_ep_open(uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc);
+static void iso_ep_close(ehci_iso_ep_t* iso);
+static bool iso_xfer(ehci_iso_ep_t* iso, uint8_t* buffer, uint32_t buflen, tu_iso_packet_t* packets,
+                     uint16_t packet_count);
+static bool iso_abort(ehci_iso_ep_t* iso);
+static void iso_xfer_complete_isr(void);
+#endif
+
 static void ehci_disable_schedule(ehci_registers_t* regs, bool is_period) {
   // maybe have a timeout for status
   if (is_period) {
@@ -284,6 +389,15 @@ void hcd_device_close(uint8_t rhport, uint8_t daddr) {
     list_remove_qhd_by_addr((ehci_link_t *) &ehci_data.period_head_arr[i], daddr, TUSB_INDEX_INVALID_8);
   }
 
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EP_MAX; i++) {
+    ehci_iso_ep_t* iso = &ehci_data.iso_ep[i];
+    if (iso->ep_addr != 0 && iso->dev_addr == daddr) {
+      iso_ep_close(iso);
+    }
+  }
+#endif
+
   // Async doorbell (EHCI 4.8.2 for operational details)
   ehci_data.regs->command_bm.async_adv_doorbell = 1;
 }
@@ -297,11 +411,11 @@ static void init_periodic_list(uint8_t rhport) {
     ehci_data.period_head_arr[i].qtd_overlay.halted = 1; // dummy node, always inactive
   }
 
-  // TODO EHCI_FRAMELIST_SIZE with other size than 8
   // all links --> period_head_arr[0] (1ms)
   // 0, 2, 4, 6 etc --> period_head_arr[1] (2ms)
-  // 1, 5 --> period_head_arr[2] (4ms)
-  // 3 --> period_head_arr[3] (8ms)
+  // 1, 5, 9, 13 etc --> period_head_arr[2] (4ms)
+  // 3, 11, 19 etc --> period_head_arr[3] (8ms)
+  // Bandwidth allocator relies on this layout, see bw_tree_phase()
 
   ehci_link_t * const framelist  = ehci_data.period_framelist;
   ehci_link_t * const head_1ms = (ehci_link_t *) &ehci_data.period_head_arr[0];
@@ -310,7 +424,7 @@ static void init_periodic_list(uint8_t rhport) {
   ehci_link_t * const head_8ms = (ehci_link_t *) &ehci_data.period_head_arr[3];
 
   for (uint32_t i = 0; i < FRAMELIST_SIZE; i++) {
-    framelist[i].address = (uint32_t) head_1ms;
+    framelist[i].address = (uint32_t) (uintptr_t) head_1ms;
     framelist[i].type = EHCI_QTYPE_QHD;
   }
 
@@ -322,7 +436,9 @@ static void init_periodic_list(uint8_t rhport) {
     list_insert(framelist + i, head_4ms, EHCI_QTYPE_QHD);
   }
 
-  list_insert(framelist + 3, head_8ms, EHCI_QTYPE_QHD);
+  for (uint32_t i = 3; i < FRAMELIST_SIZE; i += 8) {
+    list_insert(framelist + i, head_8ms, EHCI_QTYPE_QHD);
+  }
 
   head_1ms->terminate = 1;
 }
@@ -331,8 +447,8 @@ bool ehci_init(uint8_t rhport, uint32_t capability_reg, uint32_t operatial_reg)
 {
   tu_memclr(&ehci_data, sizeof(ehci_data_t));
 
-  ehci_data.regs = (ehci_registers_t*) operatial_reg;
-  ehci_data.cap_regs = (ehci_cap_registers_t*) capability_reg;
+  ehci_data.regs = (ehci_registers_t*) (uintptr_t) operatial_reg;
+  ehci_data.cap_regs = (ehci_cap_registers_t*) (uintptr_t) capability_reg;
 
   ehci_registers_t* regs = ehci_data.regs;
 
@@ -356,17 +472,17 @@ bool ehci_init(uint8_t rhport, uint32_t capability_reg, uint32_t operatial_reg)
   ehci_qhd_t * const async_head = list_get_async_head(rhport);
   tu_memclr(async_head, sizeof(ehci_qhd_t));
 
-  async_head->next.address               = (uint32_t) async_head; // circular list, next is itself
+  async_head->next.address               = (uint32_t) (uintptr_t) async_head; // circular list, next is itself
   async_head->next.type                  = EHCI_QTYPE_QHD;
   async_head->head_list_flag             = 1;
   async_head->qtd_overlay.halted         = 1; // inactive most of time
   async_head->qtd_overlay.next.terminate = 1; // TODO removed if verified
 
-  regs->async_list_addr = (uint32_t) async_head;
+  regs->async_list_addr = (uint32_t) (uintptr_t) async_head;
 
   //------------- Periodic List -------------//
   init_periodic_list(rhport);
-  regs->periodic_list_base = (uint32_t) ehci_data.period_framelist;
+  regs->periodic_list_base = (uint32_t) (uintptr_t) ehci_data.period_framelist;
 
   hcd_dcache_clean(&ehci_data, sizeof(ehci_data_t));
 
@@ -414,8 +530,14 @@ bool ehci_deinit(uint8_t rhport) {
 //--------------------------------------------------------------------+
 
 bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc) {
-  // TODO not support ISO yet
-  TU_ASSERT (ep_desc->bmAttributes.xfer != TUSB_XFER_ISOCHRONOUS);
+  if (ep_desc->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+#if CFG_TUH_EHCI_ISO_EP_MAX
+    return iso_ep_open(dev_addr, ep_desc);
+#else
+    TU_LOG1("EHCI: isochronous is not enabled, see CFG_TUH_EHCI_ISO_EP_MAX\r\n");
+    return false;
+#endif
+  }
 
   //------------- Prepare Queue Head -------------//
   ehci_qhd_t *p_qhd;
@@ -443,13 +565,22 @@ bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const
       list_head = (ehci_link_t *) list_get_async_head(rhport);
       break;
 
-    case TUSB_XFER_INTERRUPT:
-      list_head = list_get_period_head(rhport, p_qhd->interval_ms);
-      break;
+    case TUSB_XFER_INTERRUPT: {
+      ehci_bw_t bw;
+      qhd_bw_get(p_qhd, &bw);
+      if (!bw_reserve(&bw, true)) {
+        TU_LOG1("EHCI: periodic bandwidth exceeded\r\n");
+        p_qhd->used = 0;
+        return false;
+      }
+
+      // transactions may be moved to less loaded micro-frames
+      p_qhd->int_smask    = bw.smask;
+      p_qhd->fl_int_cmask = bw.cmask;
 
-    case TUSB_XFER_ISOCHRONOUS:
-      // TODO iso is not supported
+      list_head = list_get_period_head(rhport, p_qhd->interval_ms);
       break;
+    }
 
     default:
       break;
@@ -465,6 +596,14 @@ bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const
 }
 
 bool hcd_edpt_close(uint8_t rhport, uint8_t daddr, uint8_t ep_addr) {
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  ehci_iso_ep_t* iso = iso_ep_find(daddr, ep_addr);
+  if (iso != NULL) {
+    iso_ep_close(iso);
+    return true;
+  }
+#endif
+
   ehci_qhd_t* qhd = qhd_get_from_addr(daddr, ep_addr);
   TU_VERIFY(qhd != NULL);
 
@@ -508,6 +647,13 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
   uint8_t const epnum = tu_edpt_number(ep_addr);
   uint8_t const dir   = tu_edpt_dir(ep_addr);
 
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  ehci_iso_ep_t* iso = iso_ep_find(dev_addr, ep_addr);
+  if (iso != NULL) {
+    return iso_xfer(iso, buffer, buflen, NULL, 0);
+  }
+#endif
+
   ehci_qhd_t* qhd = qhd_get_from_addr(dev_addr, ep_addr);
   TU_VERIFY(qhd != NULL);
   ehci_qtd_t* qtd;
@@ -548,11 +694,31 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
   return true;
 }
 
+bool hcd_edpt_iso_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, tu_iso_packet_t* packets,
+                       uint16_t packet_count) {
+  (void) rhport;
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  ehci_iso_ep_t* iso = iso_ep_find(daddr, ep_addr);
+  TU_VERIFY(iso != NULL);
+  return iso_xfer(iso, buffer, 0, packets, packet_count);
+#else
+  (void) daddr; (void) ep_addr; (void) buffer; (void) packets; (void) packet_count;
+  return false;
+#endif
+}
+
 bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
   (void) rhport;
 
-  // TODO ISO not supported yet
+#if CFG_TUH_EHCI_ISO_EP_MAX
+  ehci_iso_ep_t* iso = iso_ep_find(dev_addr, ep_addr);
+  if (iso != NULL) {
+    return iso_abort(iso);
+  }
+#endif
+
   ehci_qhd_t* qhd = qhd_get_from_addr(dev_addr, ep_addr);
+  TU_VERIFY(qhd != NULL);
   ehci_qtd_t * volatile qtd = qhd->attached_qtd;
   TU_VERIFY(qtd != NULL); // no queued transfer
 
@@ -560,7 +726,7 @@ bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
   TU_VERIFY(qtd->active); // transfer is already complete
 
   // HC is still processing, disable HC list schedule before making changes
-  bool const is_period = (qhd->interval_ms > 0);
+  bool const is_period = qhd_is_periodic(qhd);
 
   ehci_disable_schedule(ehci_data.regs, is_period);
 
@@ -660,7 +826,7 @@ void qhd_xfer_complete_isr(ehci_qhd_t * qhd) {
 
     // invalidate dcache if IN transfer with data
     if (dir == 1 && qhd->attached_buffer != 0 && xferred_bytes > 0) {
-      hcd_dcache_invalidate((void*) qhd->attached_buffer, xferred_bytes);
+      hcd_dcache_invalidate((void*) (uintptr_t) qhd->attached_buffer, xferred_bytes);
     }
 
     // remove and free TD before invoking callback
@@ -684,7 +850,7 @@ void proccess_async_xfer_isr(ehci_qhd_t * const list_head) {
 
 TU_ATTR_ALWAYS_INLINE static inline
 void process_period_xfer_isr(uint8_t rhport, uint32_t interval_ms) {
-  uint32_t const period_1ms_addr = (uint32_t) list_get_period_head(rhport, 1u);
+  uint32_t const period_1ms_addr = (uint32_t) (uintptr_t) list_get_period_head(rhport, 1u);
   ehci_link_t next_link = *list_get_period_head(rhport, interval_ms);
 
   while (!next_link.terminate) {
@@ -702,7 +868,7 @@ void process_period_xfer_isr(uint8_t rhport, uint32_t interval_ms) {
       }
         break;
 
-      // TODO support hs/fs ISO
+      // iTD/siTD are linked in frame list ahead of the interval tree, completed by iso_xfer_complete_isr()
       case EHCI_QTYPE_ITD:
       case EHCI_QTYPE_SITD:
       case EHCI_QTYPE_FSTN:
@@ -730,6 +896,11 @@ void hcd_int_handler(uint8_t rhport, bool in_isr) {
   if (int_status & EHCI_INT_MASK_FRAMELIST_ROLLOVER) {
     ehci_data.uframe_number += (FRAMELIST_SIZE << 3);
     regs->status = EHCI_INT_MASK_FRAMELIST_ROLLOVER; // Acknowledge
+
+#if CFG_TUH_EHCI_ISO_EP_MAX
+    // retire iso transfer whose last TD was missed (no interrupt on complete) and no other transfer completed since
+    iso_xfer_complete_isr();
+#endif
   }
 
   if (int_status & EHCI_INT_MASK_PORT_CHANGE) {
@@ -750,10 +921,14 @@ void hcd_int_handler(uint8_t rhport, bool in_isr) {
   if (usb_int) {
     proccess_async_xfer_isr(list_get_async_head(rhport));
 
-    for ( uint32_t i = 1; i <= FRAMELIST_SIZE; i *= 2 ) {
+    for ( uint32_t i = 1; i <= BW_FRAMES; i *= 2 ) {
       process_period_xfer_isr(rhport, i);
     }
 
+#if CFG_TUH_EHCI_ISO_EP_MAX
+    iso_xfer_complete_isr();
+#endif
+
     regs->status = usb_int; // Acknowledge
   }
 
@@ -772,7 +947,8 @@ void hcd_int_handler(uint8_t rhport, bool in_isr) {
 // Get head of periodic list
 TU_ATTR_ALWAYS_INLINE static inline ehci_link_t* list_get_period_head(uint8_t rhport, uint32_t interval_ms) {
   (void) rhport;
-  return (ehci_link_t*) &ehci_data.period_head_arr[ tu_log2( tu_min32(FRAMELIST_SIZE, interval_ms) ) ];
+  // interval longer than 8 ms is served by the 8 ms list
+  return (ehci_link_t*) &ehci_data.period_head_arr[ tu_log2( tu_min32(BW_FRAMES, interval_ms) ) ];
 }
 
 // Get head of async list
@@ -782,12 +958,12 @@ TU_ATTR_ALWAYS_INLINE static inline ehci_qhd_t* list_get_async_head(uint8_t rhpo
 }
 
 TU_ATTR_ALWAYS_INLINE static inline ehci_link_t* list_next(ehci_link_t const *p_link) {
-  return (ehci_link_t*) tu_align32(p_link->address);
+  return (ehci_link_t*) (uintptr_t) tu_align32(p_link->address);
 }
 
 TU_ATTR_ALWAYS_INLINE static inline void list_insert(ehci_link_t *current, ehci_link_t *entry, uint8_t type) {
   entry->address = current->address;
-  current->address = ((uint32_t) entry) | (type << 1);
+  current->address = ((uint32_t) (uintptr_t) entry) | (type << 1);
 }
 
 // Remove a queue head from the list.
@@ -798,9 +974,13 @@ TU_ATTR_ALWAYS_INLINE static inline void list_remove(ehci_link_t* head, ehci_lin
   prev->address = qhd->next.address;
 
   // link the removed qhd's next to list head
-  qhd->next.address = ((uint32_t) head) | (EHCI_QTYPE_QHD << 1);
+  qhd->next.address = ((uint32_t) (uintptr_t) head) | (EHCI_QTYPE_QHD << 1);
 
   if (qhd_is_periodic(qhd)) {
+    ehci_bw_t bw;
+    qhd_bw_get(qhd, &bw);
+    bw_apply(&bw, false);
+
     // period list queue element is guarantee to be free in the next frame (1 ms)
     qhd->used = 0;
   } else {
@@ -855,7 +1035,7 @@ TU_ATTR_ALWAYS_INLINE static inline ehci_qhd_t *qhd_find_free(void) {
 
 // Next queue head link
 TU_ATTR_ALWAYS_INLINE static inline ehci_qhd_t *qhd_next(ehci_qhd_t const *p_qhd) {
-  return (ehci_qhd_t *) tu_align32(p_qhd->next.address);
+  return (ehci_qhd_t *) (uintptr_t) tu_align32(p_qhd->next.address);
 }
 
 // Get queue head from device + endpoint address
@@ -918,10 +1098,10 @@ static void qhd_init(ehci_qhd_t *p_qhd, uint8_t dev_addr, tusb_desc_endpoint_t c
           // sub millisecond interval
           p_qhd->interval_ms = 0;
           p_qhd->int_smask = (interval == 1) ? 0xff : // 0b11111111
-                             (interval == 2) ? 0xaa /* 0b10101010 */ : 0x44 /* 0b01000100 */;
+                             (interval == 2) ? 0x55 /* 0b01010101 */ : 0x11 /* 0b00010001 */;
         } else {
           p_qhd->interval_ms = (uint8_t) tu_min16(1 << (interval - 4), 255);
-          p_qhd->int_smask = TU_BIT(interval % 8);
+          p_qhd->int_smask = 0x01; // micro-frame is picked by bandwidth allocator
         }
       } else {
         TU_ASSERT(0 != interval, );
@@ -932,10 +1112,6 @@ static void qhd_init(ehci_qhd_t *p_qhd, uint8_t dev_addr, tusb_desc_endpoint_t c
       }
       break;
 
-    case TUSB_XFER_ISOCHRONOUS:
-      // TODO not support ISO yet
-      break;
-
     default: break;
   }
 
@@ -967,7 +1143,7 @@ static void qhd_attach_qtd(ehci_qhd_t *qhd, ehci_qtd_t *qtd) {
   // clean and invalidate cache before physically write
   hcd_dcache_clean_invalidate(qtd, sizeof(ehci_qtd_t));
 
-  qhd->qtd_overlay.next.address = (uint32_t) qtd;
+  qhd->qtd_overlay.next.address = (uint32_t) (uintptr_t) qtd;
   hcd_dcache_clean_invalidate(qhd, sizeof(ehci_qhd_t));
 }
 
@@ -1012,10 +1188,651 @@ static void qtd_init(ehci_qtd_t* qtd, void const* buffer, uint16_t total_bytes)
   qtd->total_bytes         = total_bytes;
   qtd->expected_bytes      = total_bytes;
 
-  qtd->buffer[0] = (uint32_t) buffer;
+  qtd->buffer[0] = (uint32_t) (uintptr_t) buffer;
   for(uint8_t i=1; i<5; i++) {
     qtd->buffer[i] |= tu_align4k(qtd->buffer[i - 1] ) + 4096;
   }
 }
 
+//--------------------------------------------------------------------+
+// Periodic Bandwidth
+//--------------------------------------------------------------------+
+
+// Period in frames (1, 2, 4 or 8) of an interval in frames
+TU_ATTR_ALWAYS_INLINE static inline uint8_t bw_period(uint32_t interval_ms) {
+  return (uint8_t) (1u << tu_log2(tu_min32(tu_max32(interval_ms, 1), BW_FRAMES)));
+}
+
+// First frame of an interval list in the periodic tree built by init_periodic_list()
+TU_ATTR_ALWAYS_INLINE static inline uint8_t bw_tree_phase(uint8_t period) {
+  return (period > 1) ? (uint8_t) (period / 2 - 1) : 0;
+}
+
+// Bus load of the busiest (micro)frame if endpoint is added, UINT32_MAX if it exceeds the periodic budget
+static uint32_t bw_peak(ehci_bw_t const* bw) {
+  uint8_t const umask = bw->smask | bw->cmask;
+  uint32_t hs_peak = 0;
+  uint32_t fs_peak = 0;
+
+  for (uint8_t f = bw->phase; f < BW_FRAMES; f += bw->period) {
+    for (uint8_t u = 0; u < 8; u++) {
+      if (tu_bit_test(umask, u)) {
+        uint32_t const load = ehci_data.bw_hs[f][u] + bw->hs_cost;
+        if (load > BW_HS_UFRAME_MAX) {
+          return UINT32_MAX;
+        }
+        hs_peak = tu_max32(hs_peak, load);
+      }
+    }
+
+    if (bw->fs_cost) {
+      uint32_t const load = ehci_data.bw_fs[f] + bw->fs_cost;
+      if (load > BW_FS_FRAME_MAX) {
+        return UINT32_MAX;
+      }
+      fs_peak = tu_max32(fs_peak, load);
+    }
+  }
+
+  return hs_peak + fs_peak;
+}
+
+static void bw_apply(ehci_bw_t const* bw, bool add) {
+  uint8_t const umask = bw->smask | bw->cmask;
+
+  for (uint8_t f = bw->phase; f < BW_FRAMES; f += bw->period) {
+    for (uint8_t u = 0; u < 8; u++) {
+      if (tu_bit_test(umask, u)) {
+        ehci_data.bw_hs[f][u] = add ? (uint16_t) (ehci_data.bw_hs[f][u] + bw->hs_cost) :
+                                      (uint16_t) (ehci_data.bw_hs[f][u] - bw->hs_cost);
+      }
+    }
+    ehci_data.bw_fs[f] = add ? (uint16_t) (ehci_data.bw_fs[f] + bw->fs_cost) :
+                               (uint16_t) (ehci_data.bw_fs[f] - bw->fs_cost);
+  }
+}
+
+// Reserve bandwidth for an endpoint, spread it to the least loaded frame phase (unless fixed by the interval tree)
+// and micro-frames. smask/cmask are shifted in place. Return false if the periodic schedule is over-subscribed.
+// Note: full-speed budget is shared by all transaction translators.
+static bool bw_reserve(ehci_bw_t* bw, bool fixed_phase) {
+  uint8_t const umask = bw->smask | bw->cmask;
+  TU_ASSERT(umask != 0 && bw->period != 0 && bw->period <= BW_FRAMES);
+
+  uint8_t const shift_max   = (uint8_t) (7 - tu_log2(umask));
+  uint8_t const phase_first = fixed_phase ? bw->phase : 0;
+  uint8_t const phase_last  = fixed_phase ? bw->phase : (uint8_t) (bw->period - 1);
+
+  ehci_bw_t best = *bw;
+  uint32_t best_peak = UINT32_MAX;
+
+  for (uint8_t phase = phase_first; phase <= phase_last; phase++) {
+    for (uint8_t shift = 0; shift <= shift_max; shift++) {
+      ehci_bw_t candidate = *bw;
+      candidate.phase = phase;
+      candidate.smask = (uint8_t) (bw->smask << shift);
+      candidate.cmask = (uint8_t) (bw->cmask << shift);
+
+      uint32_t const peak = bw_peak(&candidate);
+      if (peak < best_peak) {
+        best_peak = peak;
+        best = candidate;
+      }
+    }
+  }
+
+  TU_VERIFY(best_peak != UINT32_MAX);
+
+  *bw = best;
+  bw_apply(bw, true);
+
+  return true;
+}
+
+// Bandwidth of an interrupt queue head, derived from its endpoint characteristics
+static void qhd_bw_get(ehci_qhd_t const* qhd, ehci_bw_t* bw) {
+  uint16_t const mps = qhd->max_packet_size;
+
+  bw->period = bw_period(qhd->interval_ms);
+  bw->phase  = bw_tree_phase(bw->period);
+  bw->smask  = qhd->int_smask;
+  bw->cmask  = qhd->fl_int_cmask;
+
+  if (qhd->ep_speed == TUSB_SPEED_HIGH) {
+    bw->hs_cost = (uint16_t) (mps + BW_HS_OVERHEAD);
+    bw->fs_cost = 0;
+  } else {
+    // split transaction: start/complete split on highspeed, the actual transaction on full/low speed
+    bw->hs_cost = (uint16_t) (tu_min16(mps, BW_SPLIT_BYTES) + BW_HS_OVERHEAD);
+    bw->fs_cost = (uint16_t) ((mps + BW_FS_OVERHEAD) * (qhd->ep_speed == TUSB_SPEED_LOW ? 8 : 1));
+  }
+}
+
+//--------------------------------------------------------------------+
+// Isochronous helper
+//--------------------------------------------------------------------+
+#if CFG_TUH_EHCI_ISO_EP_MAX
+
+TU_ATTR_ALWAYS_INLINE static inline bool iso_is_highspeed(ehci_iso_ep_t const* iso) {
+  return iso->speed == TUSB_SPEED_HIGH;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t iso_owner(ehci_iso_ep_t const* iso) {
+  return (uint8_t) (iso - ehci_data.iso_ep + 1);
+}
+
+static ehci_iso_ep_t* iso_ep_find(uint8_t dev_addr, uint8_t ep_addr) {
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EP_MAX; i++) {
+    ehci_iso_ep_t* iso = &ehci_data.iso_ep[i];
+    if (iso->ep_addr != 0 && iso->dev_addr == dev_addr && iso->ep_addr == ep_addr) {
+      return iso;
+    }
+  }
+  return NULL;
+}
+
+static bool iso_ep_open(uint8_t dev_addr, tusb_desc_endpoint_t const * ep_desc) {
+  if (iso_ep_find(dev_addr, ep_desc->bEndpointAddress) != NULL) {
+    return true; // already opened
+  }
+
+  ehci_iso_ep_t* iso = NULL;
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EP_MAX; i++) {
+    if (ehci_data.iso_ep[i].ep_addr == 0) {
+      iso = &ehci_data.iso_ep[i];
+      break;
+    }
+  }
+  TU_ASSERT(iso);
+
+  tuh_bus_info_t bus_info;
+  tuh_bus_info_get(dev_addr, &bus_info);
+
+  uint16_t const mps = tu_edpt_packet_size(ep_desc);
+  uint8_t const interval = ep_desc->bInterval;
+  bool const is_in = (tu_edpt_dir(ep_desc->bEndpointAddress) == TUSB_DIR_IN);
+
+  // interval is 2^(bInterval-1) (micro)frames, only up to 8 ms is supported
+  TU_ASSERT(interval >= 1);
+
+  tu_memclr(iso, sizeof(ehci_iso_ep_t));
+  iso->dev_addr        = dev_addr;
+  iso->speed           = bus_info.speed;
+  iso->hub_addr        = bus_info.hub_addr;
+  iso->hub_port        = bus_info.hub_port;
+  iso->max_packet_size = mps;
+
+  ehci_bw_t* bw = &iso->bw;
+  if (iso_is_highspeed(iso)) {
+    TU_ASSERT(interval <= 7);
+    iso->interval_uf = (uint8_t) (1u << (interval - 1));
+    iso->mult        = (uint8_t) (1 + ((tu_le16toh(ep_desc->wMaxPacketSize) >> 11) & 0x03));
+
+    bw->period  = (uint8_t) tu_max32(iso->interval_uf / 8, 1);
+    bw->smask   = (iso->interval_uf == 1) ? 0xff : (iso->interval_uf == 2) ? 0x55 :
+                  (iso->interval_uf == 4) ? 0x11 : 0x01;
+    bw->hs_cost = (uint16_t) (mps * iso->mult + BW_HS_OVERHEAD);
+  } else {
+    TU_ASSERT(interval <= 4 && mps <= 1023);
+    iso->interval_uf = (uint8_t) (8u << (interval - 1));
+    iso->mult        = 1;
+
+    // EHCI 4.12.3: full-speed data is moved in 188 bytes per micro-frame. OUT is split in consecutive start-splits,
+    // IN has a start-split then complete-splits from 2 micro-frames later until the last data can be returned.
+    uint8_t const nsplit = (uint8_t) tu_max32(tu_div_ceil(mps, BW_SPLIT_BYTES), 1);
+    bw->period = (uint8_t) (1u << (interval - 1));
+    if (is_in) {
+      bw->smask = 0x01;
+      bw->cmask = (uint8_t) (((1u << (nsplit + 1)) - 1) << 2);
+    } else {
+      bw->smask = (uint8_t) ((1u << nsplit) - 1);
+      bw->cmask = 0;
+    }
+    bw->hs_cost = (uint16_t) (tu_min16(mps, BW_SPLIT_BYTES) + BW_HS_OVERHEAD);
+    bw->fs_cost = (uint16_t) (mps + BW_FS_OVERHEAD);
+  }
+
+  iso->packet_size = (uint16_t) (mps * iso->mult);
+
+  if (!bw_reserve(bw, false)) {
+    TU_LOG1("EHCI: periodic bandwidth exceeded\r\n");
+    return false;
+  }
+
+  iso->ep_addr = ep_desc->bEndpointAddress;
+  return true;
+}
+
+static void iso_ep_close(ehci_iso_ep_t* iso) {
+  (void) iso_abort(iso);
+  bw_apply(&iso->bw, false);
+  iso->ep_addr = 0;
+}
+
+// Link TD at head of its frame list slot: TD's next must be visible to HC before the slot points to it
+static void iso_td_link(ehci_link_t* td, uint32_t td_size, uint8_t slot, uint8_t type) {
+  ehci_link_t* fl = &ehci_data.period_framelist[slot];
+
+  td->address = fl->address;
+  hcd_dcache_clean(td, td_size);
+
+  fl->address = ((uint32_t) (uintptr_t) td) | (type << 1);
+  hcd_dcache_clean(fl, sizeof(ehci_link_t));
+}
+
+// Unlink TD from its frame list slot, iTD/siTD are always ahead of the interval tree queue heads
+static void iso_td_unlink(ehci_link_t* td, uint8_t slot) {
+  ehci_link_t* prev = &ehci_data.period_framelist[slot];
+
+  while (!prev->terminate && (prev->type == EHCI_QTYPE_ITD || prev->type == EHCI_QTYPE_SITD)) {
+    ehci_link_t* cur = list_next(prev);
+    if (cur == td) {
+      prev->address = td->address;
+      hcd_dcache_clean(prev, sizeof(ehci_link_t));
+      return;
+    }
+    prev = cur;
+  }
+}
+
+// Unlink and free TDs of a queued transfer, xfer_idx 0xff means all transfers
+static void iso_td_release(ehci_iso_ep_t* iso, uint8_t xfer_idx) {
+  uint8_t const owner = iso_owner(iso);
+  bool const is_hs = iso_is_highspeed(iso);
+  ehci_iso_td_info_t* info = is_hs ? ehci_data.itd_info : ehci_data.sitd_info;
+  uint8_t const pool_size = is_hs ? CFG_TUH_EHCI_ITD_MAX : CFG_TUH_EHCI_SITD_MAX;
+
+  for (uint8_t i = 0; i < pool_size; i++) {
+    if (info[i].owner == owner && (xfer_idx == TUSB_INDEX_INVALID_8 || info[i].xfer == xfer_idx)) {
+      ehci_link_t* td = is_hs ? &ehci_data.itd_pool[i].next : &ehci_data.sitd_pool[i].next;
+      iso_td_unlink(td, info[i].slot);
+      info[i].owner = 0;
+    }
+  }
+}
+
+static uint8_t iso_td_free_count(ehci_iso_td_info_t const* info, uint8_t count) {
+  uint8_t result = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (info[i].owner == 0) {
+      result++;
+    }
+  }
+  return result;
+}
+
+static uint8_t iso_td_alloc(ehci_iso_td_info_t* info, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (info[i].owner == 0) {
+      return i;
+    }
+  }
+  return TUSB_INDEX_INVALID_8;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t iso_packet_length(ehci_iso_ep_t const* iso, ehci_iso_xfer_t const* xfer,
+                                                               uint16_t pkt) {
+  if (xfer->packets != NULL) {
+    return xfer->packets[pkt].length;
+  }
+  uint32_t const offset = (uint32_t) pkt * iso->packet_size;
+  return (uint16_t) tu_min32(xfer->buflen - offset, iso->packet_size);
+}
+
+// Fill iTD with transactions of one frame starting from packet *pkt, return number of bytes scheduled
+static uint32_t itd_init(ehci_itd_t* itd, ehci_iso_td_info_t* info, ehci_iso_ep_t const* iso,
+                         ehci_iso_xfer_t const* xfer, uint8_t const* buffer, uint16_t* pkt, bool ioc) {
+  tu_memclr(itd, sizeof(ehci_itd_t));
+
+  uint32_t const page0 = tu_align4k((uint32_t) (uintptr_t) buffer);
+  for (uint8_t p = 0; p < 7; p++) {
+    itd->BufferPointer[p] = page0 + p * 4096u;
+  }
+
+  // EHCI 3.3.3 endpoint characteristics are stored in low bits of buffer pointers
+  itd->BufferPointer[0] |= iso->dev_addr | ((uint32_t) tu_edpt_number(iso->ep_addr) << 8);
+  itd->BufferPointer[1] |= iso->max_packet_size | ((uint32_t) tu_edpt_dir(iso->ep_addr) << 11);
+  itd->BufferPointer[2] |= iso->mult;
+
+  uint32_t addr = (uint32_t) (uintptr_t) buffer;
+  uint8_t last = 0;
+  info->packet = *pkt;
+  info->xact_mask = 0;
+
+  for (uint8_t u = 0; u < 8 && *pkt < xfer->packet_count; u++) {
+    if (!tu_bit_test(iso->bw.smask, u)) {
+      continue;
+    }
+
+    uint16_t const len = iso_packet_length(iso, xfer, *pkt);
+    itd->xact[u].offset      = addr & 0xfffu;
+    itd->xact[u].page_select = (tu_align4k(addr) - page0) >> 12;
+    itd->xact[u].length      = len;
+    itd->xact[u].active      = 1;
+
+    info->xact_mask |= (uint8_t) TU_BIT(u);
+    last = u;
+    addr += len;
+    (*pkt)++;
+  }
+  itd->xact[last].int_on_complete = ioc ? 1 : 0;
+
+  return addr - (uint32_t) (uintptr_t) buffer;
+}
+
+// Fill siTD with packet *pkt, return number of bytes scheduled
+static uint32_t sitd_init(ehci_sitd_t* sitd, ehci_iso_td_info_t* info, ehci_iso_ep_t const* iso,
+                          ehci_iso_xfer_t const* xfer, uint8_t const* buffer, uint16_t* pkt, bool ioc) {
+  tu_memclr(sitd, sizeof(ehci_sitd_t));
+
+  uint16_t const len = iso_packet_length(iso, xfer, *pkt);
+  uint8_t const dir = tu_edpt_dir(iso->ep_addr);
+
+  sitd->dev_addr     = iso->dev_addr;
+  sitd->ep_number    = tu_edpt_number(iso->ep_addr);
+  sitd->hub_addr     = iso->hub_addr;
+  sitd->port_number  = iso->hub_port;
+  sitd->direction    = dir;
+  sitd->int_smask    = iso->bw.smask;
+  sitd->fl_int_cmask = iso->bw.cmask;
+
+  sitd->total_bytes     = len;
+  sitd->active          = 1;
+  sitd->int_on_complete = ioc ? 1 : 0;
+  sitd->back.terminate  = 1;
+
+  sitd->buffer[0] = (uint32_t) (uintptr_t) buffer;
+  sitd->buffer[1] = tu_align4k((uint32_t) (uintptr_t) buffer) + 4096u;
+
+  if (dir == TUSB_DIR_OUT) {
+    // one start-split per 188 bytes: trim smask to the actual packet, TP is ALL (0) or BEGIN (1)
+    uint8_t const tcount = (uint8_t) tu_max32(tu_div_ceil(len, BW_SPLIT_BYTES), 1);
+    uint8_t first = 0;
+    while (!tu_bit_test(iso->bw.smask, first)) {
+      first++;
+    }
+    sitd->int_smask = (uint8_t) (((1u << tcount) - 1) << first);
+    sitd->buffer[1] |= ((tcount > 1 ? 1u : 0u) << 3) | tcount;
+  }
+
+  info->packet = *pkt;
+  info->length = len;
+  (*pkt)++;
+
+  return len;
+}
+
+static bool iso_xfer(ehci_iso_ep_t* iso, uint8_t* buffer, uint32_t buflen, tu_iso_packet_t* packets,
+                     uint16_t packet_count) {
+  TU_VERIFY(iso->xfer_count < ISO_XFER_QUEUE);
+
+  if (packets == NULL) {
+    packet_count = (uint16_t) tu_max32(tu_div_ceil(buflen, iso->packet_size), 1);
+  } else {
+    TU_ASSERT(packet_count > 0);
+    buflen = 0;
+    for (uint16_t i = 0; i < packet_count; i++) {
+      TU_ASSERT(packets[i].length <= iso->packet_size);
+      buflen += packets[i].length;
+    }
+  }
+
+  bool const is_hs = iso_is_highspeed(iso);
+  uint8_t const period = iso->bw.period;
+
+  // packets per TD: transactions in a frame for iTD, one for siTD
+  uint8_t per_td = 1;
+  if (is_hs) {
+    per_td = 0;
+    for (uint8_t u = 0; u < 8; u++) {
+      per_td += tu_bit_test(iso->bw.smask, u) ? 1 : 0;
+    }
+  }
+  uint32_t const td_count = tu_div_ceil(packet_count, per_td);
+
+  ehci_iso_td_info_t* info = is_hs ? ehci_data.itd_info : ehci_data.sitd_info;
+  uint8_t const pool_size = is_hs ? CFG_TUH_EHCI_ITD_MAX : CFG_TUH_EHCI_SITD_MAX;
+  TU_ASSERT(td_count <= iso_td_free_count(info, pool_size));
+
+  // TDs are linked at least 2 frames ahead of the controller. Continue right after previous transfer if still
+  // possible, otherwise (re)start the stream at the reserved phase.
+  uint32_t const now = hcd_frame_number(0);
+  uint32_t start = iso->next_frame;
+  if ((int32_t) (start - now) < 2 || (start + (td_count - 1) * period - now) >= FRAMELIST_SIZE) {
+    start = now + 2;
+    start += (uint32_t) (iso->bw.phase + period - start % period) % period;
+  }
+  uint32_t const last_frame = start + (td_count - 1) * period;
+
+  // whole transfer must fit in the frame list without wrapping around
+  TU_ASSERT(last_frame - now < FRAMELIST_SIZE);
+
+  if (tu_edpt_dir(iso->ep_addr)) {
+    hcd_dcache_invalidate(buffer, buflen);
+  } else {
+    hcd_dcache_clean(buffer, buflen);
+  }
+
+  // ISR only looks at queued transfers, this one is not counted until all its TDs are linked
+  uint8_t const xfer_idx = (uint8_t) ((iso->xfer_head + iso->xfer_count) % ISO_XFER_QUEUE);
+  ehci_iso_xfer_t* xfer = &iso->xfer[xfer_idx];
+  xfer->buffer       = buffer;
+  xfer->packets      = packets;
+  xfer->buflen       = buflen;
+  xfer->packet_count = packet_count;
+  xfer->last_frame   = last_frame;
+  iso->next_frame    = last_frame + period;
+
+  uint8_t const owner = iso_owner(iso);
+  uint32_t offset = 0;
+  uint16_t pkt = 0;
+  for (uint32_t t = 0; t < td_count; t++) {
+    uint8_t const slot = (uint8_t) ((start + t * period) % FRAMELIST_SIZE);
+    bool const ioc = (t == td_count - 1);
+    uint8_t const idx = iso_td_alloc(info, pool_size);
+
+    info[idx].owner = owner;
+    info[idx].slot  = slot;
+    info[idx].xfer  = xfer_idx;
+
+    if (is_hs) {
+      ehci_itd_t* itd = &ehci_data.itd_pool[idx];
+      offset += itd_init(itd, &info[idx], iso, xfer, buffer + offset, &pkt, ioc);
+      iso_td_link(&itd->next, sizeof(ehci_itd_t), slot, EHCI_QTYPE_ITD);
+    } else {
+      ehci_sitd_t* sitd = &ehci_data.sitd_pool[idx];
+      offset += sitd_init(sitd, &info[idx], iso, xfer, buffer + offset, &pkt, ioc);
+      iso_td_link(&sitd->next, sizeof(ehci_sitd_t), slot, EHCI_QTYPE_SITD);
+    }
+  }
+
+  usbh_spin_lock(false);
+  iso->xfer_count++;
+  usbh_spin_unlock(false);
+
+  return true;
+}
+
+static bool iso_abort(ehci_iso_ep_t* iso) {
+  TU_VERIFY(iso->xfer_count > 0);
+
+  // HC may be processing TDs, disable periodic schedule before making changes
+  ehci_disable_schedule(ehci_data.regs, true);
+  iso_td_release(iso, TUSB_INDEX_INVALID_8);
+  iso->xfer_count = 0;
+  ehci_enable_schedule(ehci_data.regs, true);
+
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline void iso_packet_done(ehci_iso_xfer_t* xfer, uint16_t pkt, uint16_t len,
+                                                         bool failed) {
+  if (xfer->packets != NULL && pkt < xfer->packet_count) {
+    xfer->packets[pkt].actual_len = len;
+    xfer->packets[pkt].result = failed ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS;
+  }
+}
+
+// A TD is missed if it is still active after its frame: TDs of a transfer are within one frame list period
+// ending at the transfer's last frame, which gives back the full frame number from the slot.
+TU_ATTR_ALWAYS_INLINE static inline bool iso_td_expired(ehci_iso_xfer_t const* xfer, uint8_t slot, uint32_t now) {
+  uint32_t const td_frame = xfer->last_frame - ((xfer->last_frame - slot) % FRAMELIST_SIZE);
+  return (int32_t) (now - td_frame) > 0;
+}
+
+// Bytes moved by iTD transaction u, 0 if it failed or was missed
+static uint16_t itd_xact_result(ehci_itd_t const* itd, uint8_t u, bool* failed) {
+  *failed = itd->xact[u].active || itd->xact[u].error || itd->xact[u].babble_err || itd->xact[u].buffer_err;
+  return *failed ? 0 : (uint16_t) itd->xact[u].length;
+}
+
+// Bytes moved by siTD, 0 if it failed or was missed
+static uint16_t sitd_result(ehci_sitd_t const* sitd, ehci_iso_td_info_t const* info, bool* failed) {
+  *failed = sitd->active || sitd->error || sitd->xact_err || sitd->babble_err || sitd->buffer_err ||
+            sitd->missed_uframe;
+  return *failed ? 0 : (uint16_t) (info->length - sitd->total_bytes);
+}
+
+// Check the oldest transfer of an endpoint: return false if still in progress, otherwise update per-packet result
+// and total bytes. Transfer is done when each of its TDs is either inactive or missed (frame has passed).
+static bool iso_xfer_check(ehci_iso_ep_t* iso, uint32_t now, uint32_t* xferred_bytes, xfer_result_t* result) {
+  uint8_t const owner = iso_owner(iso);
+  ehci_iso_xfer_t* xfer = &iso->xfer[iso->xfer_head];
+
+  uint16_t packet_count = 0;
+  uint16_t error_count = 0;
+  *xferred_bytes = 0;
+
+  if (iso_is_highspeed(iso)) {
+    for (uint8_t t = 0; t < CFG_TUH_EHCI_ITD_MAX; t++) {
+      ehci_iso_td_info_t const* info = &ehci_data.itd_info[t];
+      if (info->owner != owner || info->xfer != iso->xfer_head) {
+        continue;
+      }
+      ehci_itd_t* itd = &ehci_data.itd_pool[t];
+      hcd_dcache_invalidate(itd, sizeof(ehci_itd_t));
+      bool const expired = iso_td_expired(xfer, info->slot, now);
+
+      uint16_t pkt = info->packet;
+      for (uint8_t u = 0; u < 8; u++) {
+        if (!tu_bit_test(info->xact_mask, u)) {
+          continue;
+        }
+        if (itd->xact[u].active && !expired) {
+          return false;
+        }
+
+        bool failed;
+        uint16_t const len = itd_xact_result(itd, u, &failed);
+        iso_packet_done(xfer, pkt++, len, failed);
+
+        packet_count++;
+        error_count += failed ? 1 : 0;
+        *xferred_bytes += len;
+      }
+    }
+  } else {
+    for (uint8_t t = 0; t < CFG_TUH_EHCI_SITD_MAX; t++) {
+      ehci_iso_td_info_t const* info = &ehci_data.sitd_info[t];
+      if (info->owner != owner || info->xfer != iso->xfer_head) {
+        continue;
+      }
+      ehci_sitd_t* sitd = &ehci_data.sitd_pool[t];
+      hcd_dcache_invalidate(sitd, sizeof(ehci_sitd_t));
+
+      if (sitd->active && !iso_td_expired(xfer, info->slot, now)) {
+        return false;
+      }
+
+      bool failed;
+      uint16_t const len = sitd_result(sitd, info, &failed);
+      iso_packet_done(xfer, info->packet, len, failed);
+
+      packet_count++;
+      error_count += failed ? 1 : 0;
+      *xferred_bytes += len;
+    }
+  }
+
+  // transfer fails only if no packet makes it through, single packet errors are normal for isochronous
+  *result = (error_count == packet_count) ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS;
+  return true;
+}
+
+// IN transfer without packet list (hcd_edpt_xfer): each packet is received at its max size offset, move short
+// packets down so that the buffer holds the reported bytes contiguously. Called before TDs are released.
+static void iso_in_compact(ehci_iso_ep_t const* iso, ehci_iso_xfer_t const* xfer) {
+  uint8_t const owner = iso_owner(iso);
+  bool const is_hs = iso_is_highspeed(iso);
+  ehci_iso_td_info_t const* info = is_hs ? ehci_data.itd_info : ehci_data.sitd_info;
+  uint8_t const pool_size = is_hs ? CFG_TUH_EHCI_ITD_MAX : CFG_TUH_EHCI_SITD_MAX;
+
+  uint32_t dst = 0;
+  uint16_t pkt = 0;
+  while (pkt < xfer->packet_count) {
+    // TDs are not allocated in packet order, look up the one starting at this packet
+    uint8_t t = 0;
+    while (t < pool_size && !(info[t].owner == owner && info[t].xfer == iso->xfer_head && info[t].packet == pkt)) {
+      t++;
+    }
+    TU_VERIFY(t < pool_size,);
+
+    // lengths of the packets in this TD: up to 8 transactions of iTD, single packet of siTD
+    uint16_t len[8];
+    uint8_t count = 0;
+    bool failed;
+    if (is_hs) {
+      for (uint8_t u = 0; u < 8; u++) {
+        if (tu_bit_test(info[t].xact_mask, u)) {
+          len[count++] = itd_xact_result(&ehci_data.itd_pool[t], u, &failed);
+        }
+      }
+    } else {
+      len[count++] = sitd_result(&ehci_data.sitd_pool[t], &info[t], &failed);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+      uint32_t const src = (uint32_t) pkt * iso->packet_size;
+      if (len[i] > 0 && src != dst) {
+        memmove(xfer->buffer + dst, xfer->buffer + src, len[i]);
+      }
+      dst += len[i];
+      pkt++;
+    }
+  }
+}
+
+// Retire completed iso transfers in submission order
+static void iso_xfer_complete_isr(void) {
+  uint32_t const now = hcd_frame_number(0);
+
+  for (uint8_t i = 0; i < CFG_TUH_EHCI_ISO_EP_MAX; i++) {
+    ehci_iso_ep_t* iso = &ehci_data.iso_ep[i];
+
+    while (iso->xfer_count > 0) {
+      uint32_t xferred_bytes;
+      xfer_result_t result;
+      if (!iso_xfer_check(iso, now, &xferred_bytes, &result)) {
+        break;
+      }
+
+      ehci_iso_xfer_t const* xfer = &iso->xfer[iso->xfer_head];
+      if (tu_edpt_dir(iso->ep_addr) && xferred_bytes > 0) {
+        hcd_dcache_invalidate(xfer->buffer, xfer->buflen);
+        if (xfer->packets == NULL && xferred_bytes < xfer->buflen) {
+          iso_in_compact(iso, xfer);
+        }
+      }
+
+      iso_td_release(iso, iso->xfer_head);
+      iso->xfer_head = (uint8_t) ((iso->xfer_head + 1) % ISO_XFER_QUEUE);
+      iso->xfer_count--;
+
+      hcd_event_xfer_complete(iso->dev_addr, iso->ep_addr, xferred_bytes, result, true);
+    }
+  }
+}
+
+#endif
+
 #endif
@@ -24,16 +24,6 @@
  extern "C" {
 #endif
 
-//--------------------------------------------------------------------+
-// EHCI CONFIGURATION & CONSTANTS
-//--------------------------------------------------------------------+
-
-// TODO merge OHCI with EHCI
-enum {
-	EHCI_MAX_ITD  = 4,
-  EHCI_MAX_SITD = 16
-};
-
 //--------------------------------------------------------------------+
 // EHCI Data Structure
 //--------------------------------------------------------------------+
@@ -141,12 +131,10 @@ typedef struct TU_ATTR_ALIGNED(32) {
   uint8_t pid;
   uint8_t interval_ms;// polling interval in frames (or millisecond)
 
-  uint8_t TU_RESERVED[4];
-
   // Attached TD management, note usbh will only queue 1 TD per QHD.
   // buffer for dcache invalidate since td's buffer is modified by HC and finding initial buffer address is not trivial
   uint32_t attached_buffer;
-  ehci_qtd_t *volatile attached_qtd;
+  ehci_qtd_t *volatile attached_qtd; // last member: 32-byte alignment pads the struct to 64 with 32 or 64-bit pointer
 } ehci_qhd_t;
 TU_VERIFY_STATIC( sizeof(ehci_qhd_t) == 64, "size is not correct" );
 
@@ -705,6 +705,22 @@ void dcd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
   }
 }
 
+// Disable endpoint to drop transfer in progress, data toggle is kept
+void dcd_edpt_abort_xfer(uint8_t rhport, uint8_t ep_addr) {
+  dwc2_regs_t* dwc2 = DWC2_REG(rhport);
+  const uint8_t epnum = tu_edpt_number(ep_addr);
+  const uint8_t dir = tu_edpt_dir(ep_addr);
+  dwc2_dep_t* dep = &dwc2->ep[dir == TUSB_DIR_IN ? 0 : 1][epnum];
+
+  edpt_disable(rhport, ep_addr, false);
+  dep->ctl |= EPCTL_USBAEP; // keep endpoint active, disable deactivates it
+
+  // stop TXFE interrupt from filling the flushed fifo with the aborted transfer
+  if (dir == TUSB_DIR_IN) {
+    dwc2->diepempmsk &= ~(1u << epnum);
+  }
+}
+
 void dcd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   uint8_t const epnum = tu_edpt_number(ep_addr);
@@ -479,6 +479,19 @@ typedef union {
 } dwc2_channel_tsize_t;
 TU_VERIFY_STATIC(sizeof(dwc2_channel_tsize_t) == 4, "incorrect size");
 
+// HCTSIZ in Scatter/Gather DMA mode: transfer size and packet count are taken from descriptors
+typedef union {
+  uint32_t value;
+  struct TU_ATTR_PACKED {
+    uint32_t sched_info : 8; // 0..7 Micro-frames of a frame scheduled for periodic highspeed channel
+    uint32_t ntd        : 8; // 8..15 Number of transfer descriptors - 1
+    uint32_t rsv16_28   :13; // 16..28 Reserved
+    uint32_t pid        : 2; // 29..30 Packet ID
+    uint32_t do_ping    : 1; // 31 Do PING
+  };
+} dwc2_channel_tsize_ddma_t;
+TU_VERIFY_STATIC(sizeof(dwc2_channel_tsize_ddma_t) == 4, "incorrect size");
+
 typedef union {
   uint32_t value;
   struct TU_ATTR_PACKED {
@@ -500,6 +513,13 @@ typedef struct {
   volatile uint32_t hcdmab;       // 51C + 20*ch Host Channel DMA Address
 } dwc2_channel_t;
 
+// Host Scatter/Gather DMA descriptor, see HDESC_* for status quadlet
+typedef struct {
+  volatile uint32_t status;
+  volatile uint32_t buf;
+} dwc2_host_dma_desc_t;
+TU_VERIFY_STATIC(sizeof(dwc2_host_dma_desc_t) == 8, "incorrect size");
+
 //--------------------------------------------------------------------
 // Device Register Bitfield
 //--------------------------------------------------------------------
@@ -859,6 +879,22 @@ TU_VERIFY_STATIC(offsetof(dwc2_regs_t, fifo   ) == 0x1000, "incorrect size");
 #define HCFG_FSLS_ONLY_Msk               (0x1UL << HCFG_FSLS_ONLY_Pos)            // 0x00000004
 #define HCFG_FSLS_ONLY                   HCFG_FSLS_ONLY_Msk                       // FS- and LS-only support
 
+#define HCFG_DESCDMA_Pos                 (23U)
+#define HCFG_DESCDMA_Msk                 (0x1UL << HCFG_DESCDMA_Pos)              // 0x00800000
+#define HCFG_DESCDMA                     HCFG_DESCDMA_Msk                         // Scatter/Gather DMA enable
+
+#define HCFG_FRLISTEN_Pos                (24U)
+#define HCFG_FRLISTEN_Msk                (0x3UL << HCFG_FRLISTEN_Pos)             // 0x03000000
+#define HCFG_FRLISTEN                    HCFG_FRLISTEN_Msk                        // Frame list entries
+#define HCFG_FRLISTEN_8                  (0x0UL << HCFG_FRLISTEN_Pos)             // 0x00000000
+#define HCFG_FRLISTEN_16                 (0x1UL << HCFG_FRLISTEN_Pos)             // 0x01000000
+#define HCFG_FRLISTEN_32                 (0x2UL << HCFG_FRLISTEN_Pos)             // 0x02000000
+#define HCFG_FRLISTEN_64                 (0x3UL << HCFG_FRLISTEN_Pos)             // 0x03000000
+
+#define HCFG_PERSCHEDENA_Pos             (26U)
+#define HCFG_PERSCHEDENA_Msk             (0x1UL << HCFG_PERSCHEDENA_Pos)          // 0x04000000
+#define HCFG_PERSCHEDENA                 HCFG_PERSCHEDENA_Msk                     // Periodic schedule enable
+
 /********************  Bit definition for PCGCR register  ********************/
 #define PCGCR_STPPCLK_Pos                (0U)
 #define PCGCR_STPPCLK_Msk                (0x1UL << PCGCR_STPPCLK_Pos)             // 0x00000001
@@ -2099,6 +2135,12 @@ TU_VERIFY_STATIC(offsetof(dwc2_regs_t, fifo   ) == 0x1000, "incorrect size");
 #define HCTSIZ_PID_Pos                   (29U)
 #define HCTSIZ_PID_Msk                   (0x3UL << HCTSIZ_PID_Pos)                // 0x60000000
 #define HCTSIZ_PID                       HCTSIZ_PID_Msk                           // Data PID
+#define HCTSIZ_SCHINFO_Pos               (0U)
+#define HCTSIZ_SCHINFO_Msk               (0xFFUL << HCTSIZ_SCHINFO_Pos)           // 0x000000FF
+#define HCTSIZ_SCHINFO                   HCTSIZ_SCHINFO_Msk                       // Schedule info (Scatter/Gather DMA)
+#define HCTSIZ_NTD_Pos                   (8U)
+#define HCTSIZ_NTD_Msk                   (0xFFUL << HCTSIZ_NTD_Pos)               // 0x0000FF00
+#define HCTSIZ_NTD                       HCTSIZ_NTD_Msk                           // Number of descriptors - 1 (Scatter/Gather DMA)
 
 /********************  Bit definition for DIEPDMA register  ********************/
 #define DIEPDMA_DMAADDR_Pos              (0U)
@@ -2109,6 +2151,32 @@ TU_VERIFY_STATIC(offsetof(dwc2_regs_t, fifo   ) == 0x1000, "incorrect size");
 #define HCDMA_DMAADDR_Pos                (0U)
 #define HCDMA_DMAADDR_Msk                (0xFFFFFFFFUL << HCDMA_DMAADDR_Pos)      // 0xFFFFFFFF
 #define HCDMA_DMAADDR                    HCDMA_DMAADDR_Msk                        // DMA address
+#define HCDMA_CTD_Pos                    (3U)
+#define HCDMA_CTD_Msk                    (0xFFUL << HCDMA_CTD_Pos)                // 0x000007F8
+#define HCDMA_CTD                        HCDMA_CTD_Msk                            // Current descriptor index (Scatter/Gather DMA)
+
+/********************  Bit definition for Host DMA descriptor status  ********************/
+#define HDESC_NBYTES_Pos                 (0U)
+#define HDESC_NBYTES_Msk                 (0x1FFFFUL << HDESC_NBYTES_Pos)          // 0x0001FFFF
+#define HDESC_NBYTES                     HDESC_NBYTES_Msk                         // Bytes to transfer, remaining when done
+#define HDESC_ISO_NBYTES_Pos             (0U)
+#define HDESC_ISO_NBYTES_Msk             (0xFFFUL << HDESC_ISO_NBYTES_Pos)        // 0x00000FFF
+#define HDESC_ISO_NBYTES                 HDESC_ISO_NBYTES_Msk                     // Isochronous bytes to transfer
+#define HDESC_SETUP_Pos                  (24U)
+#define HDESC_SETUP_Msk                  (0x1UL << HDESC_SETUP_Pos)               // 0x01000000
+#define HDESC_SETUP                      HDESC_SETUP_Msk                          // Setup packet
+#define HDESC_IOC_Pos                    (25U)
+#define HDESC_IOC_Msk                    (0x1UL << HDESC_IOC_Pos)                 // 0x02000000
+#define HDESC_IOC                        HDESC_IOC_Msk                            // Interrupt on complete
+#define HDESC_EOL_Pos                    (26U)
+#define HDESC_EOL_Msk                    (0x1UL << HDESC_EOL_Pos)                 // 0x04000000
+#define HDESC_EOL                        HDESC_EOL_Msk                            // End of list
+#define HDESC_STS_Pos                    (28U)
+#define HDESC_STS_Msk                    (0x3UL << HDESC_STS_Pos)                 // 0x30000000
+#define HDESC_STS                        HDESC_STS_Msk                            // Status: 0 success, otherwise error
+#define HDESC_ACTIVE_Pos                 (31U)
+#define HDESC_ACTIVE_Msk                 (0x1UL << HDESC_ACTIVE_Pos)              // 0x80000000
+#define HDESC_ACTIVE                     HDESC_ACTIVE_Msk                         // Descriptor is owned by the core
 
                                                                                   /********************  Bit definition for DTXFSTS register  ********************/
 #define DTXFSTS_INEPTFSAV_Pos            (0U)
@@ -15,6 +15,7 @@
 
 #include "host/hcd.h"
 #include "host/usbh.h"
+#include "host/usbh_pvt.h"
 #include "dwc2_common.h"
 
   // Debug level for DWC2
@@ -25,9 +26,22 @@
     #define CFG_TUH_DWC2_ENDPOINT_MAX 16u
   #endif
 
+  // Max number of isochronous endpoints with Scatter/Gather DMA, each takes a 2KB descriptor list. 0 to disable
+  #ifndef CFG_TUH_DWC2_ISO_EP_MAX
+    #define CFG_TUH_DWC2_ISO_EP_MAX 0
+  #endif
+
   #define DWC2_CHANNEL_COUNT_MAX 16u // absolute max channel count
 TU_VERIFY_STATIC(CFG_TUH_DWC2_ENDPOINT_MAX <= 255, "currently only use 8-bit for index");
 
+#if CFG_TUH_DWC2_DMA_DESC_ENABLE && !CFG_TUH_DWC2_DMA_ENABLE
+#error CFG_TUH_DWC2_DMA_DESC_ENABLE require CFG_TUH_DWC2_DMA_ENABLE
+#endif
+
+#if CFG_TUH_DWC2_ISO_EP_MAX && !CFG_TUH_DWC2_DMA_DESC_ENABLE
+#error CFG_TUH_DWC2_ISO_EP_MAX require CFG_TUH_DWC2_DMA_DESC_ENABLE
+#endif
+
 enum {
   HPRT_W1_MASK = HPRT_CONN_DETECT | HPRT_ENABLE | HPRT_ENABLE_CHANGE | HPRT_OVER_CURRENT_CHANGE | HPRT_SUSPEND
 };
@@ -40,6 +54,27 @@ enum {
   HCD_XFER_PERIOD_SPLIT_NYET_MAX = 3
 };
 
+// Non-periodic IN transfer NAKing for this many frames gives up its channel when other endpoints are waiting for one
+enum {
+  HCD_XFER_NAK_PREEMPT_FRAMES = 2
+};
+
+// Channel preemption state
+enum {
+  HCD_PREEMPT_NONE = 0,
+  HCD_PREEMPT_REQUESTED, // split channel: halt at next NAK, channel must not be disabled in the middle of a split
+  HCD_PREEMPT_HALTING,   // channel is being halted, requeue endpoint when halted
+};
+
+// Scatter/Gather DMA
+enum {
+  DDMA_FRAME_LIST_SIZE = 64,     // frame list entries (HCFG.FrListEn), each is a bitmap of channels serviced in a frame
+  DDMA_ISO_LIST_HS     = 256,    // highspeed isochronous list: a descriptor per micro-frame
+  DDMA_ISO_LIST_FS     = 64,     // full-speed isochronous list: a descriptor per frame
+  DDMA_ISO_START_DELAY = 2,      // frames between now and the first packet of a (re)started isochronous stream
+  DDMA_FRNUM_MASK      = 0x3fff, // HFNUM.FrNum is 14-bit
+};
+
 //--------------------------------------------------------------------
 //
 //--------------------------------------------------------------------
@@ -68,6 +103,7 @@ typedef struct {
 
   uint8_t* buffer;
   uint16_t buflen;
+  uint16_t carried_bytes; // bytes transferred before the transfer is preempted, buffer/buflen is advanced accordingly
 } hcd_endpoint_t;
 
 // Additional info for each channel when it is active
@@ -86,14 +122,70 @@ typedef struct {
                            // be composed of multiple channel_xfer_start() (retry with NAK/NYET)
   uint16_t fifo_bytes;     // bytes written/read from/to FIFO (may not be transferred on USB bus).
   uint8_t  retry_disabled; // 1: channel was disabled to throttle a split retry (NAK in / XactErr out); re-arm on its halt
+  uint8_t  preempt;        // HCD_PREEMPT_*
+  uint16_t nak_uframes;    // micro-frames without progress while other endpoints are waiting for a channel
+  uint32_t nak_hctsiz;     // hctsiz at previous SOF, transfer makes progress if it changes
 } hcd_xfer_t;
 
+#if CFG_TUH_DWC2_ISO_EP_MAX
+// Transfers queued per iso endpoint, next one is scheduled right after the current one
+#define ISO_XFER_QUEUE  2
+
+typedef struct {
+  uint8_t* buffer;
+  tu_iso_packet_t* packets; // NULL if submitted by hcd_edpt_xfer(): buffer is split into max size packets
+  uint32_t buflen;
+  uint16_t packet_count;
+  uint16_t first_frnum;     // (micro)frame of the first packet
+} hcd_iso_xfer_t;
+
+// Isochronous endpoint: its channel stays enabled and services a descriptor list indexed by (micro)frame number
+typedef struct {
+  uint8_t  opened;
+  uint8_t  ep_id;
+  uint8_t  ch_id;           // channel servicing the list, TUSB_INDEX_INVALID_8 if not started
+  uint8_t  xfer_head;       // oldest queued transfer
+  volatile uint8_t xfer_count;
+  uint16_t interval;        // (micro)frames between 2 packets
+  uint16_t packet_size;     // bytes per service interval: max packet size * mult
+  uint16_t next_frnum;      // (micro)frame after the last scheduled packet, next transfer continues from here
+  hcd_iso_xfer_t xfer[ISO_XFER_QUEUE];
+} hcd_iso_ep_t;
+#endif
+
 typedef struct {
   hcd_xfer_t xfer[DWC2_CHANNEL_COUNT_MAX];
   hcd_endpoint_t edpt[CFG_TUH_DWC2_ENDPOINT_MAX];
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  hcd_iso_ep_t iso_ep[CFG_TUH_DWC2_ISO_EP_MAX];
+  #endif
+
+  // Endpoints with a submitted transfer waiting for a free channel, in order. More endpoints than channels can be
+  // opened, transfers are started from here whenever a channel is released.
+  uint8_t ready_ep[CFG_TUH_DWC2_ENDPOINT_MAX];
+  uint8_t ready_count;
 } hcd_data_t;
 
 static hcd_data_t _hcd_data;
+
+#if CFG_TUH_DWC2_DMA_DESC_ENABLE
+// Descriptor list of a non-isochronous channel. HCDMA[8:3] is the index of current descriptor, list must therefore be
+// 512-byte aligned. A transfer takes only one descriptor since its 17-bit size covers any hcd_edpt_xfer() buffer.
+typedef struct {
+  TU_ATTR_ALIGNED(512) dwc2_host_dma_desc_t desc;
+} hcd_ddma_list_t;
+
+typedef struct {
+  TU_ATTR_ALIGNED(512) uint32_t frame_list[DDMA_FRAME_LIST_SIZE];
+  hcd_ddma_list_t list[DWC2_CHANNEL_COUNT_MAX];
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  // HCDMA[10:3] is the descriptor index of highspeed isochronous list
+  TU_ATTR_ALIGNED(2048) dwc2_host_dma_desc_t iso_list[CFG_TUH_DWC2_ISO_EP_MAX][DDMA_ISO_LIST_HS];
+  #endif
+} hcd_ddma_t;
+
+CFG_TUH_MEM_SECTION static hcd_ddma_t _hcd_ddma;
+#endif
 static tuh_configure_dwc2_t _tuh_cfg = {.use_hs_phy = TUH_OPT_HIGH_SPEED};
 
 //--------------------------------------------------------------------
@@ -126,6 +218,12 @@ TU_ATTR_ALWAYS_INLINE static inline bool dma_host_enabled(const dwc2_regs_t* dwc
   return CFG_TUH_DWC2_DMA_ENABLE && ghwcfg2.arch == GHWCFG2_ARCH_INTERNAL_DMA;
 }
 
+// Scatter/Gather DMA: must be enabled and supported by core
+TU_ATTR_ALWAYS_INLINE static inline bool dma_desc_host_enabled(const dwc2_regs_t* dwc2) {
+  const dwc2_ghwcfg4_t ghwcfg4 = {.value = dwc2->ghwcfg4};
+  return CFG_TUH_DWC2_DMA_DESC_ENABLE && dma_host_enabled(dwc2) && ghwcfg4.dma_desc_enabled;
+}
+
 #if CFG_TUH_MEM_DCACHE_ENABLE
 bool hcd_dcache_clean(const void* addr, uint32_t data_size) {
   TU_VERIFY(addr && data_size);
@@ -223,6 +321,449 @@ TU_ATTR_ALWAYS_INLINE static inline uint8_t channel_find_enabled(dwc2_regs_t* dw
   return TUSB_INDEX_INVALID_8;
 }
 
+TU_ATTR_ALWAYS_INLINE static inline void sof_irq_enable(dwc2_regs_t* dwc2) {
+  if (0 == (dwc2->gintmsk & GINTMSK_SOFM)) {
+    dwc2->gintsts = GINTSTS_SOF;
+    dwc2->gintmsk |= GINTMSK_SOFM;
+  }
+}
+
+// Put endpoint at the tail of ready queue. SOF is enabled to start it later and preempt NAKing channels meanwhile
+static bool ready_push(dwc2_regs_t* dwc2, uint8_t ep_id) {
+  TU_ASSERT(_hcd_data.ready_count < CFG_TUH_DWC2_ENDPOINT_MAX);
+  _hcd_data.ready_ep[_hcd_data.ready_count++] = ep_id;
+  sof_irq_enable(dwc2);
+  return true;
+}
+
+// Remove endpoint from ready queue, return true if it was queued
+static bool ready_remove(uint8_t ep_id) {
+  for (uint8_t i = 0; i < _hcd_data.ready_count; i++) {
+    if (_hcd_data.ready_ep[i] == ep_id) {
+      _hcd_data.ready_count--;
+      memmove(&_hcd_data.ready_ep[i], &_hcd_data.ready_ep[i + 1], _hcd_data.ready_count - i);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+//--------------------------------------------------------------------
+// Scatter/Gather DMA
+//--------------------------------------------------------------------
+#if CFG_TUH_DWC2_DMA_DESC_ENABLE
+
+// Frames between 2 services of a periodic channel in frame list: power of 2 up to frame list size
+TU_ATTR_ALWAYS_INLINE static inline uint8_t ddma_frame_period(uint32_t uframe_interval) {
+  uint8_t period = 1;
+  while (period < DDMA_FRAME_LIST_SIZE && ((uint32_t) period << 1) <= (uframe_interval >> 3)) {
+    period <<= 1;
+  }
+  return period;
+}
+
+// Micro-frames serviced in a scheduled frame (HCTSIZ.SchedInfo), only used by highspeed channel
+TU_ATTR_ALWAYS_INLINE static inline uint8_t ddma_sched_info(const hcd_endpoint_t* edpt) {
+  if (edpt->speed != TUSB_SPEED_HIGH) {
+    return 0xff;
+  }
+  switch (edpt->uframe_interval) {
+    case 1:  return 0xff;
+    case 2:  return 0x55;
+    case 4:  return 0x11;
+    default: return 0x01;
+  }
+}
+
+// Add (or remove) channel to every period-th frame of the periodic frame list, starting at phase
+static void ddma_frame_list_update(uint8_t ch_id, uint8_t period, uint8_t phase, bool add) {
+  for (uint8_t i = 0; i < DDMA_FRAME_LIST_SIZE; i++) {
+    if (add && (i % period) == phase) {
+      _hcd_ddma.frame_list[i] |= TU_BIT(ch_id);
+    } else {
+      _hcd_ddma.frame_list[i] &= ~TU_BIT(ch_id);
+    }
+  }
+  hcd_dcache_clean(_hcd_ddma.frame_list, sizeof(_hcd_ddma.frame_list));
+}
+
+// Start transfer with a single-descriptor list: the core retries NAK/NYET (and PING) on its own until the descriptor
+// is done or failed, then halts the channel. Periodic channel is serviced in its frames of the frame list.
+static bool channel_xfer_start_ddma(dwc2_regs_t* dwc2, uint8_t ch_id) {
+  hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
+  hcd_endpoint_t* edpt = &_hcd_data.edpt[xfer->ep_id];
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  dwc2_host_dma_desc_t* desc = &_hcd_ddma.list[ch_id].desc;
+
+  channel->hcchar = (edpt->hcchar & ~HCCHAR_CHENA);
+  channel->hcsplt = 0;
+
+  uint32_t status = HDESC_ACTIVE | HDESC_IOC | HDESC_EOL | (edpt->buflen & HDESC_NBYTES_Msk);
+  if (edpt->next_pid == HCTSIZ_PID_SETUP) {
+    status |= HDESC_SETUP;
+  }
+  desc->buf    = (uint32_t) (uintptr_t) edpt->buffer;
+  desc->status = status;
+  hcd_dcache_clean(desc, sizeof(dwc2_host_dma_desc_t));
+
+  if (edpt->hcchar_bm.ep_dir == TUSB_DIR_OUT) {
+    hcd_dcache_clean(edpt->buffer, edpt->buflen);
+  }
+
+  dwc2_channel_tsize_ddma_t hctsiz = {.value = 0};
+  hctsiz.pid = edpt->next_pid;
+  hctsiz.ntd = 0; // 1 descriptor
+  if (channel_is_periodic(edpt->hcchar)) {
+    // spread channels of the same period over frames
+    const uint8_t period = ddma_frame_period(edpt->uframe_interval);
+    hctsiz.sched_info = ddma_sched_info(edpt);
+    ddma_frame_list_update(ch_id, period, ch_id & (period - 1), true);
+  }
+  channel->hctsiz = hctsiz.value;
+  channel->hcdma = (uint32_t) (uintptr_t) desc;
+
+  // control data and status stage always start with DATA1, other endpoints save PID when channel is halted
+  if (edpt->hcchar_bm.ep_num == 0) {
+    edpt->next_pid = HCTSIZ_PID_DATA1;
+  }
+
+  channel->hcint = 0xFFFFFFFFU; // clear all channel interrupts
+  channel->hcintmsk = HCINT_HALTED;
+  dwc2->haintmsk |= TU_BIT(ch_id);
+  channel->hcchar |= HCCHAR_CHENA;
+
+  return true;
+}
+
+#if CFG_TUH_DWC2_ISO_EP_MAX
+TU_ATTR_ALWAYS_INLINE static inline uint16_t iso_list_size(dwc2_regs_t* dwc2) {
+  return (hprt_speed_get(dwc2) == TUSB_SPEED_HIGH) ? DDMA_ISO_LIST_HS : DDMA_ISO_LIST_FS;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline dwc2_host_dma_desc_t* iso_list(const hcd_iso_ep_t* iso) {
+  return _hcd_ddma.iso_list[iso - _hcd_data.iso_ep];
+}
+
+static hcd_iso_ep_t* iso_ep_find(uint8_t ep_id) {
+  for (uint8_t i = 0; i < CFG_TUH_DWC2_ISO_EP_MAX; i++) {
+    hcd_iso_ep_t* iso = &_hcd_data.iso_ep[i];
+    if (iso->opened && iso->ep_id == ep_id) {
+      return iso;
+    }
+  }
+  return NULL;
+}
+
+static bool iso_ep_open(dwc2_regs_t* dwc2, uint8_t ep_id) {
+  hcd_iso_ep_t* iso = NULL;
+  for (uint8_t i = 0; i < CFG_TUH_DWC2_ISO_EP_MAX; i++) {
+    if (!_hcd_data.iso_ep[i].opened) {
+      iso = &_hcd_data.iso_ep[i];
+      break;
+    }
+  }
+  TU_ASSERT(iso);
+
+  const hcd_endpoint_t* edpt = &_hcd_data.edpt[ep_id];
+  const uint16_t list_size = iso_list_size(dwc2);
+  const uint32_t interval = (list_size == DDMA_ISO_LIST_HS) ? edpt->uframe_interval : (edpt->uframe_interval >> 3);
+
+  // list must hold at least 2 packets
+  TU_ASSERT(interval >= 1 && interval <= list_size / 2u);
+
+  tu_memclr(iso, sizeof(hcd_iso_ep_t));
+  iso->opened      = 1;
+  iso->ep_id       = ep_id;
+  iso->ch_id       = TUSB_INDEX_INVALID_8;
+  iso->interval    = (uint16_t) interval;
+  iso->packet_size = (uint16_t) (edpt->hcchar_bm.ep_size * edpt->hcchar_bm.err_multi_count);
+
+  tu_memclr(iso_list(iso), DDMA_ISO_LIST_HS * sizeof(dwc2_host_dma_desc_t));
+  hcd_dcache_clean(iso_list(iso), DDMA_ISO_LIST_HS * sizeof(dwc2_host_dma_desc_t));
+
+  return true;
+}
+
+// Enable channel for the endpoint's list, HCDMA is the list base since the core picks descriptor by frame number
+static bool iso_channel_start(dwc2_regs_t* dwc2, hcd_iso_ep_t* iso) {
+  const uint8_t ch_id = channel_alloc(dwc2);
+  TU_ASSERT(ch_id < DWC2_CHANNEL_COUNT_MAX);
+  hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
+  xfer->ep_id = iso->ep_id;
+  xfer->result = XFER_RESULT_INVALID;
+
+  const hcd_endpoint_t* edpt = &_hcd_data.edpt[iso->ep_id];
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+
+  channel->hcchar = (edpt->hcchar & ~HCCHAR_CHENA);
+  channel->hcsplt = 0;
+
+  // highspeed high-bandwidth: IN starts with DATA2/DATA1 for 3/2 transactions, OUT with MDATA
+  const uint8_t mult = edpt->hcchar_bm.err_multi_count;
+  dwc2_channel_tsize_ddma_t hctsiz = {.value = 0};
+  if (mult <= 1) {
+    hctsiz.pid = HCTSIZ_PID_DATA0;
+  } else if (edpt->hcchar_bm.ep_dir == TUSB_DIR_IN) {
+    hctsiz.pid = (mult == 2) ? HCTSIZ_PID_DATA1 : HCTSIZ_PID_DATA2;
+  } else {
+    hctsiz.pid = HCTSIZ_PID_MDATA;
+  }
+  hctsiz.ntd = (uint8_t) (iso_list_size(dwc2) - 1);
+  hctsiz.sched_info = ddma_sched_info(edpt);
+  channel->hctsiz = hctsiz.value;
+  channel->hcdma = (uint32_t) (uintptr_t) iso_list(iso);
+
+  ddma_frame_list_update(ch_id, ddma_frame_period(edpt->uframe_interval), 0, true);
+
+  channel->hcint = 0xFFFFFFFFU; // clear all channel interrupts
+  channel->hcintmsk = HCINT_XFER_COMPLETE | HCINT_HALTED;
+  dwc2->haintmsk |= TU_BIT(ch_id);
+  channel->hcchar |= HCCHAR_CHENA;
+
+  iso->ch_id = ch_id;
+  return true;
+}
+
+TU_ATTR_ALWAYS_INLINE static inline uint16_t iso_packet_length(const hcd_iso_ep_t* iso, const hcd_iso_xfer_t* xfer,
+                                                               uint16_t pkt) {
+  if (xfer->packets != NULL) {
+    return xfer->packets[pkt].length;
+  }
+  const uint32_t offset = (uint32_t) pkt * iso->packet_size;
+  return (uint16_t) tu_min32(xfer->buflen - offset, iso->packet_size);
+}
+
+TU_ATTR_ALWAYS_INLINE static inline dwc2_host_dma_desc_t* iso_packet_desc(const hcd_iso_ep_t* iso,
+                                                                          const hcd_iso_xfer_t* xfer,
+                                                                          uint16_t list_size, uint16_t pkt) {
+  const uint32_t frnum = xfer->first_frnum + (uint32_t) pkt * iso->interval;
+  return &iso_list(iso)[frnum & (list_size - 1u)];
+}
+
+static bool iso_xfer(dwc2_regs_t* dwc2, hcd_iso_ep_t* iso, uint8_t* buffer, uint32_t buflen,
+                     tu_iso_packet_t* packets, uint16_t packet_count) {
+  TU_VERIFY(iso->xfer_count < ISO_XFER_QUEUE);
+
+  if (packets == NULL) {
+    packet_count = (uint16_t) tu_max32(tu_div_ceil(buflen, iso->packet_size), 1);
+  } else {
+    TU_ASSERT(packet_count > 0);
+    buflen = 0;
+    for (uint16_t i = 0; i < packet_count; i++) {
+      TU_ASSERT(packets[i].length <= iso->packet_size);
+      buflen += packets[i].length;
+    }
+  }
+
+  const uint16_t list_size = iso_list_size(dwc2);
+  const uint16_t frame_len = (list_size == DDMA_ISO_LIST_HS) ? 8 : 1; // list entries per frame
+  const uint32_t span = (uint32_t) (packet_count - 1) * iso->interval;
+  const uint16_t now = dwc2->hfnum & DDMA_FRNUM_MASK;
+
+  // Continue right after previous transfer if it is still at least a frame ahead of the core, otherwise (re)start
+  // the stream a few frames later
+  uint16_t start = iso->next_frnum;
+  const uint16_t ahead = (start - now) & DDMA_FRNUM_MASK;
+  if (ahead < frame_len || ahead >= list_size) {
+    const uint16_t delay = frame_len * DDMA_ISO_START_DELAY;
+    start = (uint16_t) ((now + delay + iso->interval - 1) & ~(iso->interval - 1u) & DDMA_FRNUM_MASK);
+  }
+
+  // whole transfer must fit in the list without wrapping over descriptors in use
+  TU_ASSERT(((start + span - now) & DDMA_FRNUM_MASK) < list_size);
+
+  if (_hcd_data.edpt[iso->ep_id].hcchar_bm.ep_dir == TUSB_DIR_IN) {
+    hcd_dcache_invalidate(buffer, buflen);
+  } else {
+    hcd_dcache_clean(buffer, buflen);
+  }
+
+  // ISR only looks at queued transfers, this one is not counted until all its descriptors are active
+  const uint8_t xfer_idx = (uint8_t) ((iso->xfer_head + iso->xfer_count) % ISO_XFER_QUEUE);
+  hcd_iso_xfer_t* xfer = &iso->xfer[xfer_idx];
+  xfer->buffer       = buffer;
+  xfer->packets      = packets;
+  xfer->buflen       = buflen;
+  xfer->packet_count = packet_count;
+  xfer->first_frnum  = start;
+
+  uint32_t offset = 0;
+  for (uint16_t i = 0; i < packet_count; i++) {
+    dwc2_host_dma_desc_t* desc = iso_packet_desc(iso, xfer, list_size, i);
+    const uint16_t len = iso_packet_length(iso, xfer, i);
+    desc->buf    = (uint32_t) (uintptr_t) (buffer + offset);
+    desc->status = HDESC_ACTIVE | (i == packet_count - 1 ? HDESC_IOC : 0) | (len & HDESC_ISO_NBYTES_Msk);
+    offset += len;
+  }
+  hcd_dcache_clean(iso_list(iso), list_size * sizeof(dwc2_host_dma_desc_t));
+
+  bool ret = true;
+  usbh_spin_lock(false);
+  if (iso->ch_id == TUSB_INDEX_INVALID_8) {
+    ret = iso_channel_start(dwc2, iso);
+  }
+  if (ret) {
+    iso->xfer_count++;
+    iso->next_frnum = (uint16_t) ((start + span + iso->interval) & DDMA_FRNUM_MASK);
+  } else {
+    for (uint16_t i = 0; i < packet_count; i++) {
+      iso_packet_desc(iso, xfer, list_size, i)->status = 0;
+    }
+  }
+  usbh_spin_unlock(false);
+
+  return ret;
+}
+
+// Queued transfers are dropped without completion. Channel keeps servicing the (now inactive) list, next transfer
+// restarts the stream.
+static bool iso_abort(hcd_iso_ep_t* iso) {
+  TU_VERIFY(iso->xfer_count > 0);
+
+  usbh_spin_lock(false);
+  iso->xfer_count = 0;
+  tu_memclr(iso_list(iso), DDMA_ISO_LIST_HS * sizeof(dwc2_host_dma_desc_t));
+  hcd_dcache_clean(iso_list(iso), DDMA_ISO_LIST_HS * sizeof(dwc2_host_dma_desc_t));
+  usbh_spin_unlock(false);
+
+  return true;
+}
+
+// Retire done transfers in submission order. If force (channel halted), all queued transfers are retired and packets
+// whose descriptor is still active count as failed.
+static void iso_xfer_retire(dwc2_regs_t* dwc2, hcd_iso_ep_t* iso, bool force) {
+  const hcd_endpoint_t* edpt = &_hcd_data.edpt[iso->ep_id];
+  const bool is_in = (edpt->hcchar_bm.ep_dir == TUSB_DIR_IN);
+  const uint8_t ep_addr = tu_edpt_addr(edpt->hcchar_bm.ep_num, edpt->hcchar_bm.ep_dir);
+  const uint16_t list_size = iso_list_size(dwc2);
+
+  hcd_dcache_invalidate(iso_list(iso), list_size * sizeof(dwc2_host_dma_desc_t));
+
+  while (iso->xfer_count > 0) {
+    hcd_iso_xfer_t* xfer = &iso->xfer[iso->xfer_head];
+
+    // descriptors are processed in frame order, transfer is done when its last one is
+    const dwc2_host_dma_desc_t* last = iso_packet_desc(iso, xfer, list_size, xfer->packet_count - 1);
+    if (!force && (last->status & HDESC_ACTIVE)) {
+      break;
+    }
+
+    uint32_t xferred_bytes = 0;
+    uint16_t error_count = 0;
+    for (uint16_t i = 0; i < xfer->packet_count; i++) {
+      dwc2_host_dma_desc_t* desc = iso_packet_desc(iso, xfer, list_size, i);
+      const uint32_t status = desc->status;
+      const bool failed = (status & (HDESC_ACTIVE | HDESC_STS_Msk)) != 0;
+
+      uint16_t len = 0;
+      if (!failed) {
+        len = iso_packet_length(iso, xfer, i);
+        if (is_in) {
+          len -= (uint16_t) (status & HDESC_ISO_NBYTES_Msk); // IN: remaining bytes
+        }
+      }
+
+      if (xfer->packets != NULL) {
+        xfer->packets[i].actual_len = len;
+        xfer->packets[i].result = failed ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS;
+      }
+
+      xferred_bytes += len;
+      error_count += failed ? 1 : 0;
+      desc->status = 0;
+    }
+
+    if (is_in && xferred_bytes > 0) {
+      hcd_dcache_invalidate(xfer->buffer, xfer->buflen);
+    }
+
+    iso->xfer_head = (uint8_t) ((iso->xfer_head + 1) % ISO_XFER_QUEUE);
+    iso->xfer_count--;
+
+    // transfer fails only if no packet makes it through, single packet errors are normal for isochronous
+    const xfer_result_t result = (error_count == xfer->packet_count) ? XFER_RESULT_FAILED : XFER_RESULT_SUCCESS;
+    hcd_event_xfer_complete(edpt->hcchar_bm.dev_addr, ep_addr, xferred_bytes, result, true);
+  }
+
+  hcd_dcache_clean(iso_list(iso), list_size * sizeof(dwc2_host_dma_desc_t));
+}
+
+static void handle_channel_iso_ddma(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t hcint) {
+  hcd_iso_ep_t* iso = iso_ep_find(_hcd_data.xfer[ch_id].ep_id);
+  TU_VERIFY(iso != NULL && iso->ch_id == ch_id,);
+
+  if (hcint & HCINT_XFER_COMPLETE) {
+    iso_xfer_retire(dwc2, iso, false);
+  }
+
+  if (hcint & HCINT_HALTED) {
+    // halted on error (e.g AHB error): release channel and retire what is queued, next transfer restarts the stream
+    ddma_frame_list_update(ch_id, 1, 0, false);
+    channel_dealloc(dwc2, ch_id);
+    iso->ch_id = TUSB_INDEX_INVALID_8;
+    iso_xfer_retire(dwc2, iso, true);
+  }
+}
+#endif
+
+// Channel halted in Scatter/Gather DMA: the descriptor holds the result of the whole transfer
+static bool handle_channel_ddma(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t hcint) {
+  hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  hcd_endpoint_t* edpt = &_hcd_data.edpt[xfer->ep_id];
+
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  if (edpt->hcchar_bm.ep_type == HCCHAR_EPTYPE_ISOCHRONOUS && xfer->closing == 0) {
+    handle_channel_iso_ddma(dwc2, ch_id, hcint);
+    return false;
+  }
+  #endif
+
+  if (0 == (hcint & HCINT_HALTED)) {
+    return false;
+  }
+
+  if (channel_is_periodic(edpt->hcchar)) {
+    ddma_frame_list_update(ch_id, 1, 0, false);
+  }
+
+  if (xfer->closing == 1) {
+    return true;
+  }
+
+  dwc2_host_dma_desc_t* desc = &_hcd_ddma.list[ch_id].desc;
+  hcd_dcache_invalidate(desc, sizeof(dwc2_host_dma_desc_t));
+  const uint32_t status = desc->status;
+
+  const dwc2_channel_tsize_ddma_t hctsiz = {.value = channel->hctsiz};
+  if (edpt->hcchar_bm.ep_num != 0) {
+    edpt->next_pid = hctsiz.pid; // save PID
+  }
+
+  if (hcint & HCINT_STALL) {
+    xfer->result = XFER_RESULT_STALLED;
+  } else if ((hcint & (HCINT_AHB_ERR | HCINT_BABBLE_ERR | HCINT_XCS_XACT_ERR | HCINT_BUFFER_NA)) ||
+             (status & HDESC_STS_Msk)) {
+    xfer->result = XFER_RESULT_FAILED;
+  } else if (status & HDESC_ACTIVE) {
+    // halted by hcd_edpt_abort_xfer() before the descriptor is processed: no completion
+    channel_dealloc(dwc2, ch_id);
+    return false;
+  } else {
+    xfer->result = XFER_RESULT_SUCCESS;
+  }
+
+  if (0 == (status & HDESC_ACTIVE)) {
+    xfer->xferred_bytes = (uint16_t) (edpt->buflen - (status & HDESC_NBYTES_Msk)); // remaining bytes
+    if (edpt->hcchar_bm.ep_dir == TUSB_DIR_IN && xfer->xferred_bytes > 0) {
+      hcd_dcache_invalidate(edpt->buffer, xfer->xferred_bytes);
+    }
+  }
+
+  return true;
+}
+#endif
 
 // Allocate a new endpoint
 TU_ATTR_ALWAYS_INLINE static inline uint8_t edpt_alloc(void) {
@@ -246,6 +787,16 @@ static void edpt_close(dwc2_regs_t *dwc2, uint8_t ep_id) {
   hcd_endpoint_t *edpt = &_hcd_data.edpt[ep_id];
   edpt->closing        = 1; // mark endpoint as closing
 
+  ready_remove(ep_id);
+
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  // queued iso transfers are dropped, its channel (if any) is released below
+  hcd_iso_ep_t* iso = iso_ep_find(ep_id);
+  if (iso != NULL) {
+    iso->opened = 0;
+  }
+  #endif
+
   // disable active channel belong to this endpoint
   for (uint8_t ch_id = 0; ch_id < DWC2_CHANNEL_COUNT_MAX; ch_id++) {
     hcd_xfer_t *xfer = &_hcd_data.xfer[ch_id];
@@ -338,11 +889,11 @@ static void dfifo_host_init(uint8_t rhport, bool is_hs_phy) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   const dwc2_ghwcfg2_t ghwcfg2 = {.value = dwc2->ghwcfg2};
 
-  // Scatter/Gather DMA mode is not yet supported. Buffer DMA only need 1 words per channel
+  // Buffer DMA only need 1 words per channel, Scatter/Gather DMA need 4 words per channel
   const bool is_dma = dma_host_enabled(dwc2);
   uint16_t dfifo_top = dwc2_controller->otg_dfifo_depth;
   if (is_dma) {
-    dfifo_top -= ghwcfg2.num_host_ch;
+    dfifo_top -= (dma_desc_host_enabled(dwc2) ? 4u : 1u) * ghwcfg2.num_host_ch;
   }
 
   // fixed allocation for now, improve later:
@@ -419,6 +970,17 @@ bool hcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
     dwc2->hcfg |= HCFG_FSLS_ONLY;  // disable high speed mode
   }
 
+  #if CFG_TUH_DWC2_DMA_DESC_ENABLE
+  if (dma_desc_host_enabled(dwc2)) {
+    // Scatter/Gather DMA: periodic channels are serviced in frames where their bit is set in frame list
+    TU_LOG1("DWC2: descriptor DMA is experimental\r\n");
+    tu_memclr(&_hcd_ddma, sizeof(_hcd_ddma));
+    hcd_dcache_clean(&_hcd_ddma, sizeof(_hcd_ddma));
+    dwc2->hflbaddr = (uint32_t) (uintptr_t) _hcd_ddma.frame_list;
+    dwc2->hcfg = (dwc2->hcfg & ~HCFG_FRLISTEN) | HCFG_DESCDMA | HCFG_FRLISTEN_64 | HCFG_PERSCHEDENA;
+  }
+  #endif
+
   // configure a fixed-allocated fifo scheme
   dfifo_host_init(rhport, is_hs_phy);
 
@@ -566,6 +1128,35 @@ bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, const tusb_desc_endpoint_t*
       break;
   }
 
+  #if CFG_TUH_DWC2_DMA_DESC_ENABLE
+  if (dma_desc_host_enabled(dwc2)) {
+    if (hcsplt_bm->split_en) {
+      TU_LOG1("DWC2: split transaction is not supported with Scatter/Gather DMA\r\n");
+      edpt_dealloc(edpt);
+      return false;
+    }
+
+    // multi count: transactions per micro-frame of highspeed periodic endpoint, must be at least 1
+    if (channel_is_periodic(edpt->hcchar)) {
+      hcchar_bm->err_multi_count =
+        (bus_info.speed == TUSB_SPEED_HIGH) ? (1 + ((tu_le16toh(desc_ep->wMaxPacketSize) >> 11) & 0x03)) : 1;
+    }
+
+    if (desc_ep->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+      #if CFG_TUH_DWC2_ISO_EP_MAX
+      if (!iso_ep_open(dwc2, ep_id)) {
+        edpt_dealloc(edpt);
+        return false;
+      }
+      #else
+      TU_LOG1("DWC2: isochronous is not enabled, see CFG_TUH_DWC2_ISO_EP_MAX\r\n");
+      edpt_dealloc(edpt);
+      return false;
+      #endif
+    }
+  }
+  #endif
+
   return true;
 }
 
@@ -650,7 +1241,7 @@ static bool channel_xfer_start(dwc2_regs_t* dwc2, uint8_t ch_id) {
     channel->hcintmsk = HCINT_HALTED;
     dwc2->haintmsk |= TU_BIT(ch_id);
 
-    channel->hcdma = (uint32_t) edpt->buffer;
+    channel->hcdma = (uint32_t) (uintptr_t) edpt->buffer;
 
     if (hcchar_bm->ep_dir == TUSB_DIR_IN) {
       channel_send_in_token(dwc2, channel);
@@ -694,14 +1285,58 @@ static bool channel_xfer_start(dwc2_regs_t* dwc2, uint8_t ch_id) {
 // kick-off transfer with an endpoint
 static bool edpt_xfer_kickoff(dwc2_regs_t* dwc2, uint8_t ep_id) {
   uint8_t ch_id = channel_alloc(dwc2);
-  TU_ASSERT(ch_id < 16); // all channel are in used
+  TU_VERIFY(ch_id < 16); // all channel are in used
   hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
   xfer->ep_id = ep_id;
   xfer->result = XFER_RESULT_INVALID;
 
+  #if CFG_TUH_DWC2_DMA_DESC_ENABLE
+  if (dma_desc_host_enabled(dwc2)) {
+    return channel_xfer_start_ddma(dwc2, ch_id);
+  }
+  #endif
+
   return channel_xfer_start(dwc2, ch_id);
 }
 
+// Start waiting endpoints in order while there is free channel
+static void ready_dispatch(dwc2_regs_t* dwc2) {
+  while (_hcd_data.ready_count > 0 && edpt_xfer_kickoff(dwc2, _hcd_data.ready_ep[0])) {
+    _hcd_data.ready_count--;
+    memmove(&_hcd_data.ready_ep[0], &_hcd_data.ready_ep[1], _hcd_data.ready_count);
+  }
+}
+
+// Channel is halted to preempt its NAKing IN transfer: save progress, release channel and requeue endpoint at the tail
+// so that NAKing endpoints take turn (round-robin) with the waiting ones. Return false if endpoint cannot be requeued,
+// transfer is then left untouched on its channel.
+static bool channel_xfer_preempt(dwc2_regs_t* dwc2, uint8_t ch_id) {
+  hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
+  const dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  hcd_endpoint_t* edpt = &_hcd_data.edpt[xfer->ep_id];
+  const dwc2_channel_tsize_t hctsiz = {.value = channel->hctsiz};
+
+  TU_VERIFY(ready_push(dwc2, xfer->ep_id));
+
+  edpt->next_pid = hctsiz.pid; // also for EP0: data stage is resumed
+
+  // Slave: received bytes are counted in xferred_bytes. DMA: xferred_bytes counts split packets already advanced in
+  // buffer, hctsiz.xfer_size is the remaining of current buffer.
+  uint16_t advance;
+  if (dma_host_enabled(dwc2)) {
+    advance = edpt->buflen - hctsiz.xfer_size;
+    edpt->carried_bytes += xfer->xferred_bytes + advance;
+  } else {
+    advance = xfer->xferred_bytes;
+    edpt->carried_bytes += advance;
+  }
+  edpt->buffer += advance;
+  edpt->buflen -= advance;
+
+  channel_dealloc(dwc2, ch_id);
+  return true;
+}
+
 bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t * buffer, uint16_t buflen) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   const uint8_t ep_num = tu_edpt_number(ep_addr);
@@ -720,7 +1355,37 @@ bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *
     edpt->hcchar_bm.ep_dir = ep_dir;
   }
 
-  return edpt_xfer_kickoff(dwc2, ep_id);
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  hcd_iso_ep_t* iso = iso_ep_find(ep_id);
+  if (iso != NULL) {
+    return iso_xfer(dwc2, iso, buffer, buflen, NULL, 0);
+  }
+  #endif
+
+  // queue behind endpoints already waiting for a channel, started right away if there is a free one
+  edpt->carried_bytes = 0;
+  usbh_spin_lock(false);
+  const bool ret = ready_push(dwc2, ep_id);
+  ready_dispatch(dwc2);
+  usbh_spin_unlock(false);
+
+  return ret;
+}
+
+bool hcd_edpt_iso_xfer(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, tu_iso_packet_t* packets,
+                       uint16_t packet_count) {
+#if CFG_TUH_DWC2_ISO_EP_MAX
+  dwc2_regs_t* dwc2 = DWC2_REG(rhport);
+  const uint8_t ep_id = edpt_find_opened(daddr, tu_edpt_number(ep_addr), tu_edpt_dir(ep_addr));
+  TU_VERIFY(ep_id < CFG_TUH_DWC2_ENDPOINT_MAX);
+  TU_VERIFY(_hcd_data.edpt[ep_id].closing == 0);
+  hcd_iso_ep_t* iso = iso_ep_find(ep_id);
+  TU_VERIFY(iso != NULL);
+  return iso_xfer(dwc2, iso, buffer, 0, packets, packet_count);
+#else
+  (void) rhport; (void) daddr; (void) ep_addr; (void) buffer; (void) packets; (void) packet_count;
+  return false;
+#endif
 }
 
 // Abort a queued transfer. Note: it can only abort transfer that has not been started
@@ -732,12 +1397,28 @@ bool hcd_edpt_abort_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr) {
   const uint8_t ep_id = edpt_find_opened(dev_addr, ep_num, ep_dir);
   TU_VERIFY(ep_id < CFG_TUH_DWC2_ENDPOINT_MAX);
 
+  #if CFG_TUH_DWC2_ISO_EP_MAX
+  hcd_iso_ep_t* iso = iso_ep_find(ep_id);
+  if (iso != NULL) {
+    return iso_abort(iso);
+  }
+  #endif
+
   // hcd_int_disable(rhport);
 
+  // transfer waiting for a channel is simply dropped
+  usbh_spin_lock(false);
+  const bool was_queued = ready_remove(ep_id);
+  usbh_spin_unlock(false);
+  if (was_queued) {
+    return true;
+  }
+
   // Find enabled channeled and disable it, channel will be de-allocated in the interrupt handler
   const uint8_t ch_id = channel_find_enabled(dwc2, dev_addr, ep_num, ep_dir);
   if (ch_id < 16) {
     dwc2_channel_t* channel = &dwc2->channel[ch_id];
+    _hcd_data.xfer[ch_id].preempt = HCD_PREEMPT_NONE; // aborted, not to be requeued
     channel_disable(dwc2, channel);
   }
 
@@ -809,11 +1490,7 @@ static void channel_xfer_in_retry(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t hci
       const dwc2_channel_tsize_t hctsiz = {.value = channel->hctsiz};
       edpt->next_pid = hctsiz.pid; // save PID
       edpt->uframe_countdown = edpt->uframe_interval - ucount;
-      // enable SOF interrupt if not already enabled
-      if (0 == (dwc2->gintmsk & GINTMSK_SOFM)) {
-        dwc2->gintsts = GINTSTS_SOF;
-        dwc2->gintmsk |= GINTMSK_SOFM;
-      }
+      sof_irq_enable(dwc2); // enable SOF interrupt if not already enabled
       // already halted, de-allocate channel (called from DMA isr)
       channel_dealloc(dwc2, ch_id);
     }
@@ -971,6 +1648,9 @@ static bool handle_channel_in_slave(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t h
       hcsplt.split_compl = 0; // restart with start-split
       channel->hcsplt = hcsplt.value;
     }
+    if (xfer->preempt == HCD_PREEMPT_REQUESTED) {
+      xfer->preempt = HCD_PREEMPT_HALTING;
+    }
 
     channel_disable(dwc2, channel);
   } else if (hcint & HCINT_ACK) {
@@ -1199,6 +1879,9 @@ static bool handle_channel_in_dma(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t hci
       // path); no frame deferral. Programming Guide 3.5 (p73) Note permits disable on NAK/FrmOvrn splits.
       if ((hcint & HCINT_NAK) && hcsplt.split_en && !channel_is_periodic(channel->hcchar)) {
         xfer->retry_disabled = 1;
+        if (xfer->preempt == HCD_PREEMPT_REQUESTED) {
+          xfer->preempt = HCD_PREEMPT_HALTING;
+        }
         channel_disable(dwc2, channel);
       } else {
         channel_xfer_in_retry(dwc2, ch_id, hcint);
@@ -1307,6 +1990,14 @@ static bool handle_channel_out_dma(dwc2_regs_t* dwc2, uint8_t ch_id, uint32_t hc
 }
 #endif
 
+// Channel halted for preemption, unless transfer is also complete/failed or endpoint is closing
+TU_ATTR_ALWAYS_INLINE static inline bool channel_is_preempted(const hcd_xfer_t* xfer, uint32_t hcint) {
+  const uint32_t done_mask =
+    HCINT_XFER_COMPLETE | HCINT_STALL | HCINT_BABBLE_ERR | HCINT_XACT_ERR | HCINT_AHB_ERR | HCINT_DATATOGGLE_ERR;
+  return xfer->preempt == HCD_PREEMPT_HALTING && (hcint & HCINT_HALTED) && 0 == (hcint & done_mask) &&
+         xfer->closing == 0 && xfer->result == XFER_RESULT_INVALID;
+}
+
 static void handle_channel_irq(uint8_t rhport, bool in_isr) {
   dwc2_regs_t* dwc2 = DWC2_REG(rhport);
   const bool is_dma = dma_host_enabled(dwc2);
@@ -1323,7 +2014,17 @@ static void handle_channel_irq(uint8_t rhport, bool in_isr) {
       channel->hcint = hcint; // clear interrupt
 
       bool is_done = false;
-      if (is_dma) {
+      if (channel_is_preempted(xfer, hcint)) {
+        if (channel_xfer_preempt(dwc2, ch_id)) {
+          continue;
+        }
+        xfer->result = XFER_RESULT_FAILED; // could not be requeued, channel is already halted
+        is_done = true;
+      } else if (dma_desc_host_enabled(dwc2)) {
+        #if CFG_TUH_DWC2_DMA_DESC_ENABLE
+        is_done = handle_channel_ddma(dwc2, ch_id, hcint);
+        #endif
+      } else if (is_dma) {
         #if CFG_TUH_DWC2_DMA_ENABLE
         if (hcchar.ep_dir == TUSB_DIR_OUT) {
           is_done = handle_channel_out_dma(dwc2, ch_id, hcint);
@@ -1331,7 +2032,7 @@ static void handle_channel_irq(uint8_t rhport, bool in_isr) {
           is_done = handle_channel_in_dma(dwc2, ch_id, hcint);
           if (is_done && (channel->hcdma > xfer->xferred_bytes)) {
             // hcdma is increased by word --> need to align4
-            hcd_dcache_invalidate((void*) tu_align4(channel->hcdma - xfer->xferred_bytes), xfer->xferred_bytes);
+            hcd_dcache_invalidate((void*) (uintptr_t) tu_align4(channel->hcdma - xfer->xferred_bytes), xfer->xferred_bytes);
           }
         }
         #endif
@@ -1350,13 +2051,55 @@ static void handle_channel_irq(uint8_t rhport, bool in_isr) {
           hcd_endpoint_t *edpt = &_hcd_data.edpt[xfer->ep_id];
           edpt_dealloc(edpt);
         } else {
+          const hcd_endpoint_t* edpt = &_hcd_data.edpt[xfer->ep_id];
           const uint8_t ep_addr = tu_edpt_addr(hcchar.ep_num, hcchar.ep_dir);
-          hcd_event_xfer_complete(hcchar.dev_addr, ep_addr, xfer->xferred_bytes, (xfer_result_t)xfer->result, in_isr);
+          const uint32_t xferred_bytes = edpt->carried_bytes + xfer->xferred_bytes;
+          hcd_event_xfer_complete(hcchar.dev_addr, ep_addr, xferred_bytes, (xfer_result_t)xfer->result, in_isr);
         }
         channel_dealloc(dwc2, ch_id);
       }
     }
   }
+
+  // released channels go to waiting endpoints
+  ready_dispatch(dwc2);
+}
+
+// Called every SOF while endpoints are waiting for a channel: halt non-periodic IN channels that make no progress
+// (device keeps NAKing) for HCD_XFER_NAK_PREEMPT_FRAMES, their endpoints are requeued when halted.
+// Not used with Scatter/Gather DMA since progress of an active descriptor is unknown when its channel is halted.
+static void channel_nak_preempt(dwc2_regs_t* dwc2, uint32_t ucount) {
+  if (dma_desc_host_enabled(dwc2)) {
+    return;
+  }
+
+  const uint8_t max_channel = dwc2_channel_count(dwc2);
+  for (uint8_t ch_id = 0; ch_id < max_channel; ch_id++) {
+    hcd_xfer_t* xfer = &_hcd_data.xfer[ch_id];
+    dwc2_channel_t* channel = &dwc2->channel[ch_id];
+    const dwc2_channel_char_t hcchar = {.value = channel->hcchar};
+    if (!xfer->allocated || xfer->closing || xfer->preempt != HCD_PREEMPT_NONE ||
+        hcchar.ep_dir != TUSB_DIR_IN || channel_is_periodic(hcchar.value)) {
+      continue;
+    }
+
+    const uint32_t hctsiz = channel->hctsiz;
+    if (hctsiz != xfer->nak_hctsiz) {
+      xfer->nak_hctsiz = hctsiz;
+      xfer->nak_uframes = 0;
+      continue;
+    }
+
+    xfer->nak_uframes = (uint16_t) (xfer->nak_uframes + ucount);
+    if (xfer->nak_uframes >= 8u * HCD_XFER_NAK_PREEMPT_FRAMES) {
+      if (channel->hcsplt & HCSPLT_SPLITEN) {
+        xfer->preempt = HCD_PREEMPT_REQUESTED;
+      } else {
+        xfer->preempt = HCD_PREEMPT_HALTING;
+        channel_disable(dwc2, channel);
+      }
+    }
+  }
 }
 
 // SOF is enabled for scheduled periodic transfer
@@ -1366,6 +2109,7 @@ static bool handle_sof_irq(uint8_t rhport, bool in_isr) {
   dwc2->gintsts = GINTSTS_SOF; // Clear the SOF interrupt flag
 
   bool more_isr = false;
+  bool periodic_waiting = false;
 
   // If highspeed then SOF is 125us, else 1ms
   const uint32_t ucount = (hprt_speed_get(dwc2) == TUSB_SPEED_HIGH ? 1 : 8);
@@ -1378,6 +2122,7 @@ static bool handle_sof_irq(uint8_t rhport, bool in_isr) {
         if (edpt->uframe_countdown == 0) {
           if (!edpt_xfer_kickoff(dwc2, ep_id)) {
             edpt->uframe_countdown = ucount; // failed to start, try again next frame
+            periodic_waiting = true;
           }
         }
 
@@ -1386,6 +2131,12 @@ static bool handle_sof_irq(uint8_t rhport, bool in_isr) {
     }
   }
 
+  if (_hcd_data.ready_count > 0 || periodic_waiting) {
+    channel_nak_preempt(dwc2, ucount);
+    ready_dispatch(dwc2);
+    more_isr = more_isr || (_hcd_data.ready_count > 0);
+  }
+
   return more_isr;
 }
 
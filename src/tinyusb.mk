@@ -4,6 +4,8 @@ TINYUSB_SRC_C += \
 	src/common/tusb_fifo.c \
 	src/device/usbd.c \
 	src/typec/usbc.c \
+	src/class/audio/audio_convert.c \
+	src/class/audio/audio_feedback.c \
 	src/class/audio/audio_device.c \
 	src/class/cdc/cdc_device.c \
 	src/class/dfu/dfu_device.c \
@@ -21,9 +23,11 @@ TINYUSB_SRC_C += \
 	src/class/vendor/vendor_device.c \
   src/host/usbh.c \
   src/host/hub.c \
+  src/class/audio/audio_host.c \
   src/class/cdc/cdc_host.c \
   src/class/hid/hid_host.c \
   src/class/midi/midi_host.c \
   src/class/midi/midi2_host.c \
   src/class/msc/msc_host.c \
   src/class/vendor/vendor_host.c \
+  src/class/video/video_host.c \
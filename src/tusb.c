@@ -236,6 +236,31 @@ bool tu_edpt_release(volatile uint8_t* ep_state, osal_mutex_t mutex) {
   return ret;
 }
 
+#if CFG_TUD_EDPT_STATS || CFG_TUH_EDPT_STATS
+void tu_edpt_stats_complete(tu_edpt_stats_t* stats, uint8_t result, uint32_t xferred_bytes) {
+  uint32_t const latency = tusb_cycle_count_api() - stats->submit_cycle;
+  uint8_t const bin = (latency == 0) ? 0 : tu_log2(latency);
+
+  stats->completed++;
+  stats->bytes += xferred_bytes;
+  stats->latency_hist[tu_min8(bin, TU_EDPT_STATS_HIST_BINS - 1)]++;
+
+  switch (result) {
+    case XFER_RESULT_STALLED:
+      stats->stalls++;
+      break;
+
+    case XFER_RESULT_FAILED:
+    case XFER_RESULT_TIMEOUT:
+    case XFER_RESULT_INVALID:
+      stats->errors++;
+      break;
+
+    default: break;
+  }
+}
+#endif
+
 #if CFG_TUSB_DEBUG
 bool tu_edpt_validate(const tusb_desc_endpoint_t *desc_ep, tusb_speed_t speed) {
   const uint16_t max_packet_size = tu_edpt_packet_size(desc_ep);
@@ -312,7 +337,7 @@ bool tu_edpt_stream_init(tu_edpt_stream_t *s, bool is_host, bool is_tx, bool ove
   s->is_host = is_host;
   tu_fifo_config(&s->ff, ff_buf, ff_bufsize, overwritable);
 
-  #if OSAL_MUTEX_REQUIRED
+  #if CFG_FIFO_MUTEX
   if (ff_buf != NULL && ff_bufsize > 0) {
     osal_mutex_t new_mutex = osal_mutex_create(&s->ff_mutexdef);
     tu_fifo_config_mutex(&s->ff, is_tx ? new_mutex : NULL, is_tx ? NULL : new_mutex);
@@ -320,6 +345,9 @@ bool tu_edpt_stream_init(tu_edpt_stream_t *s, bool is_host, bool is_tx, bool ove
   #endif
 
   s->ep_buf = ep_buf;
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  s->zc_len = 0;
+#endif
 
   return true;
 }
@@ -338,20 +366,21 @@ static bool stream_claim(tu_edpt_stream_t *s) {
   return false;
 }
 
-static bool stream_xfer(tu_edpt_stream_t *s, uint16_t count) {
+static bool stream_xfer(tu_edpt_stream_t *s, uint8_t *buf, uint16_t count) {
   if (s->is_host) {
     #if CFG_TUH_ENABLED
-    return usbh_edpt_xfer(s->hwid, s->ep_addr, count ? s->ep_buf : NULL, count);
+    return usbh_edpt_xfer(s->hwid, s->ep_addr, count ? buf : NULL, count);
   #endif
   } else {
     #if CFG_TUD_ENABLED
     if (s->ep_buf == NULL) {
       return usbd_edpt_xfer_fifo(s->hwid, s->ep_addr, &s->ff, count, false);
     } else {
-      return usbd_edpt_xfer(s->hwid, s->ep_addr, count ? s->ep_buf : NULL, count, false);
+      return usbd_edpt_xfer(s->hwid, s->ep_addr, count ? buf : NULL, count, false);
     }
   #endif
   }
+  (void) buf;
   return false;
 }
 
@@ -375,25 +404,86 @@ bool tu_edpt_stream_write_zlp_if_needed(tu_edpt_stream_t *s, uint32_t last_xferr
   // ZLP condition: no pending data, last transferred bytes is multiple of packet size
   TU_VERIFY(tu_fifo_empty(&s->ff) && last_xferred_bytes > 0 && (0 == (last_xferred_bytes & (s->mps - 1))));
   TU_VERIFY(stream_claim(s));
-  TU_ASSERT(stream_xfer(s, 0));
+  TU_ASSERT(stream_xfer(s, NULL, 0));
   return true;
 }
 
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+// Get fifo linear region to be sent directly. Return 0 if data should be copied to ep_buf instead
+static uint16_t stream_zc_tx_span(tu_edpt_stream_t *s, uint8_t **buf) {
+  // overwritable fifo can be modified by writer while transferring
+  if (s->is_host || s->ep_buf == NULL || s->ff.overwritable) {
+    return 0;
+  }
+
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_read_info(&s->ff, &info);
+
+  uint16_t count = tu_min16(info.linear.len, s->xfer_len);
+  if (info.wrapped.len > 0 || count < info.linear.len) {
+    // more data follows: avoid a short packet in the middle of stream, ep_buf can join the wrapped part instead
+    count = (uint16_t) (count & ~(s->mps - 1));
+  }
+
+  if (count > 0) {
+    *buf = info.linear.ptr;
+  }
+  return count;
+}
+
+// Get fifo linear region to receive directly. Return 0 if data should be received to ep_buf instead
+static uint16_t stream_zc_rx_span(tu_edpt_stream_t *s, uint8_t **buf, uint16_t count) {
+  // dcache: controller DMA must not share cache lines with data written by CPU to fifo
+  if (s->is_host || s->ep_buf == NULL || CFG_TUD_MEM_DCACHE_ENABLE) {
+    return 0;
+  }
+
+  tu_fifo_buffer_info_t info;
+  tu_fifo_get_write_info(&s->ff, &info);
+
+  count = tu_min16(count, (uint16_t) (info.linear.len & ~(s->mps - 1)));
+  if (count > 0) {
+    *buf = info.linear.ptr;
+  }
+  return count;
+}
+#endif
+
 uint32_t tu_edpt_stream_write_xfer(tu_edpt_stream_t *s) {
   const uint16_t ff_count = tu_fifo_count(&s->ff);
   TU_VERIFY(ff_count > 0, 0); // skip if no data
   TU_VERIFY(stream_claim(s), 0);
 
-  // Pull data from FIFO -> EP buf
+  uint8_t *buf = s->ep_buf;
   uint16_t count;
+
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+  // endpoint is claimed i.e previous transfer is complete: its data can be released from fifo now
+  if (s->zc_len > 0) {
+    tu_fifo_advance_read_pointer(&s->ff, s->zc_len);
+    s->zc_len = 0;
+  }
+
+  count = stream_zc_tx_span(s, &buf);
+  if (count > 0) {
+    s->zc_len = count;
+  } else
+#endif
   if (s->ep_buf == NULL) {
     count = tu_fifo_count(&s->ff); // re-get count since fifo can be changed
   } else {
+    // Pull data from FIFO -> EP buf
     count = tu_fifo_read_n(&s->ff, s->ep_buf, s->xfer_len);
   }
 
   if (count > 0) {
-    TU_ASSERT(stream_xfer(s, count), 0);
+    if (!stream_xfer(s, buf, count)) {
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+      s->zc_len = 0; // data remains in fifo
+#endif
+      TU_BREAKPOINT();
+      return 0;
+    }
     return count;
   } else {
     // Release endpoint since we don't make any transfer
@@ -419,6 +509,16 @@ uint32_t tu_edpt_stream_write_available(tu_edpt_stream_t *s) {
   return (uint32_t)tu_fifo_remaining(&s->ff);
 }
 
+uint32_t tu_edpt_stream_write_commit(tu_edpt_stream_t *s, uint32_t n) {
+  tu_fifo_write_commit(&s->ff, (uint16_t) n);
+
+  // same flush condition as tu_edpt_stream_write()
+  if ((tu_fifo_count(&s->ff) >= s->mps) || (tu_fifo_depth(&s->ff) < s->mps)) {
+    tu_edpt_stream_write_xfer(s);
+  }
+  return n;
+}
+
 //--------------------------------------------------------------------+
 // Stream Read
 //--------------------------------------------------------------------+
@@ -437,7 +537,23 @@ uint32_t tu_edpt_stream_read_xfer(tu_edpt_stream_t *s) {
     // multiple of packet size limit by ep bufsize
     uint16_t count = (uint16_t) (available & ~(s->mps - 1));
     count = tu_min16(count, s->xfer_len);
-    TU_ASSERT(stream_xfer(s, count), 0);
+
+    uint8_t *buf = s->ep_buf;
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+    const uint16_t zc_count = stream_zc_rx_span(s, &buf, count);
+    if (zc_count > 0) {
+      count     = zc_count;
+      s->zc_len = zc_count;
+    }
+#endif
+
+    if (!stream_xfer(s, buf, count)) {
+#if CFG_TUD_EDPT_STREAM_ZERO_COPY
+      s->zc_len = 0; // data remains in fifo
+#endif
+      TU_BREAKPOINT();
+      return 0;
+    }
     return count;
   } else {
     // Release endpoint since we don't make any transfer
@@ -452,6 +568,11 @@ uint32_t tu_edpt_stream_read(tu_edpt_stream_t *s, void *buffer, uint32_t bufsize
   return num_read;
 }
 
+void tu_edpt_stream_read_commit(tu_edpt_stream_t *s, uint32_t n) {
+  tu_fifo_read_commit(&s->ff, (uint16_t) n);
+  tu_edpt_stream_read_xfer(s);
+}
+
 //--------------------------------------------------------------------+
 // Debug
 //--------------------------------------------------------------------+
@@ -40,6 +40,10 @@
     #include "class/cdc/cdc_host.h"
   #endif
 
+  #if CFG_TUH_AUDIO
+    #include "class/audio/audio_host.h"
+  #endif
+
   #if CFG_TUH_MIDI
     #include "class/midi/midi_host.h"
   #endif
@@ -51,6 +55,10 @@
   #if CFG_TUH_VENDOR
     #include "class/vendor/vendor_host.h"
   #endif
+
+  #if CFG_TUH_VIDEO
+    #include "class/video/video_host.h"
+  #endif
 #else
   #ifndef tuh_int_handler
   #define tuh_int_handler(...)
@@ -303,6 +303,14 @@
   #define CFG_TUH_DWC2_DMA_ENABLE CFG_TUH_DWC2_DMA_ENABLE_DEFAULT
 #endif
 
+// Scatter/Gather (descriptor) DMA mode for host, require CFG_TUH_DWC2_DMA_ENABLE and core support (GHWCFG4).
+// Channels process descriptor lists, NAK/NYET are retried by the core without interrupt. Split transaction is not
+// supported in this mode i.e full/low speed devices behind a highspeed hub.
+// Experimental: not yet validated on hardware nor against a register model, keep disabled for production.
+#ifndef CFG_TUH_DWC2_DMA_DESC_ENABLE
+  #define CFG_TUH_DWC2_DMA_DESC_ENABLE 0
+#endif
+
 // Slave mode for host
 #ifndef CFG_TUH_DWC2_SLAVE_ENABLE
   #ifndef CFG_TUH_DWC2_SLAVE_ENABLE_DEFAULT
@@ -565,6 +573,25 @@
   #define CFG_TUD_MEM_DCACHE_LINE_SIZE CFG_TUSB_MEM_DCACHE_LINE_SIZE
 #endif
 
+// Transfer endpoint stream (CDC, vendor etc.) data directly from/to its FIFO linear region instead of copying
+// through the endpoint buffer. Stream FIFOs are then placed in CFG_TUD_MEM_SECTION which must be DMA capable.
+#ifndef CFG_TUD_EDPT_STREAM_ZERO_COPY
+  #define CFG_TUD_EDPT_STREAM_ZERO_COPY 0
+#endif
+
+// Enable usbd_edpt_xfer_sg() scatter/gather transfers. usbd submits one segment after another from the transfer
+// complete event. No DCD defines TUP_DCD_EDPT_XFER_SG (native segment list, e.g. chained DMA descriptors) yet, so
+// this emulation is always used.
+#ifndef CFG_TUD_EDPT_XFER_SG
+  #define CFG_TUD_EDPT_XFER_SG 0
+#endif
+
+// Per endpoint transfer statistics and latency histogram, see tud_edpt_stats_get(). Application must implement
+// tusb_cycle_count_api()
+#ifndef CFG_TUD_EDPT_STATS
+  #define CFG_TUD_EDPT_STATS 0
+#endif
+
 #ifndef CFG_TUD_ENDPOINT0_SIZE
   #define CFG_TUD_ENDPOINT0_SIZE  64
 #endif
@@ -582,6 +609,12 @@
   #define CFG_TUD_TASK_EVENTS_PER_RUN  16
 #endif
 
+// max events taken from the event queue at once by tud_task_ext(), stored on its stack. Only user SOF events are
+// coalesced, transfer complete events are always processed one by one
+#ifndef CFG_TUD_TASK_EVENT_BATCH
+  #define CFG_TUD_TASK_EVENT_BATCH  4
+#endif
+
 // default to max hardware endpoint, but can be smaller to save RAM
 #ifndef CFG_TUD_ENDPPOINT_MAX
   #define CFG_TUD_ENDPPOINT_MAX   TUP_DCD_ENDPOINT_MAX
@@ -683,6 +716,12 @@
   #define CFG_TUD_EDPT_DEDICATED_HWFIFO 0
 #endif
 
+// Zero-copy stream needs controller DMA access to the stream fifo, which is not the case with dedicated hw FIFO
+#if CFG_TUD_EDPT_DEDICATED_HWFIFO && CFG_TUD_EDPT_STREAM_ZERO_COPY
+  #undef  CFG_TUD_EDPT_STREAM_ZERO_COPY
+  #define CFG_TUD_EDPT_STREAM_ZERO_COPY 0
+#endif
+
 //--------------------------------------------------------------------
 // Host Options (Default)
 //--------------------------------------------------------------------
@@ -694,6 +733,34 @@
   #ifndef CFG_TUH_ENUMERATION_BUFSIZE
     #define CFG_TUH_ENUMERATION_BUFSIZE 256
   #endif
+
+  // Number of devices (behind hubs) that can be enumerated at the same time. Each of them has its own
+  // CFG_TUH_ENUMERATION_BUFSIZE buffer, so that debouncing and descriptor fetching of different ports overlap.
+  #ifndef CFG_TUH_ENUMERATION_MAX
+    #define CFG_TUH_ENUMERATION_MAX 1
+  #endif
+
+  // Number of control transfers (to different devices) that can be in flight at the same time. Each device still has
+  // at most one outstanding control transfer. Only raise this if the HCD can run control transfers of multiple
+  // devices concurrently e.g one QHD/ED per device (EHCI, OHCI) or enough host channels (DWC2).
+  #ifndef CFG_TUH_CONTROL_XFER_MAX
+    #define CFG_TUH_CONTROL_XFER_MAX 1
+  #endif
+
+  #ifndef CFG_TUH_INTERFACE_MAX
+    #define CFG_TUH_INTERFACE_MAX 8
+  #endif
+
+  // Number of known devices (VID/PID/bcdDevice/serial) remembered to speed up their re-enumeration, 0 to disable.
+  // String descriptors are skipped and configuration descriptor up to CFG_TUH_ENUM_CACHE_CONFIG_SIZE is reused
+  // after its 9-byte header is validated.
+  #ifndef CFG_TUH_ENUM_CACHE
+    #define CFG_TUH_ENUM_CACHE 0
+  #endif
+
+  #ifndef CFG_TUH_ENUM_CACHE_CONFIG_SIZE
+    #define CFG_TUH_ENUM_CACHE_CONFIG_SIZE 128
+  #endif
 #endif // CFG_TUH_ENABLED
 
 // Attribute to place data in accessible RAM for host controller (default: CFG_TUSB_MEM_SECTION)
@@ -807,6 +874,10 @@
   { 0x067b, 0x23f3 }  /* GS */
 #endif
 
+#ifndef CFG_TUH_AUDIO
+  #define CFG_TUH_AUDIO  0
+#endif
+
 #ifndef CFG_TUH_HID
   #define CFG_TUH_HID    0
 #endif
@@ -839,10 +910,26 @@
   #define CFG_TUH_VENDOR 0
 #endif
 
+#ifndef CFG_TUH_VIDEO
+  #define CFG_TUH_VIDEO  0
+#endif
+
 #ifndef CFG_TUH_API_EDPT_XFER
   #define CFG_TUH_API_EDPT_XFER 0
 #endif
 
+// Number of isochronous endpoints streaming with tuh_iso_xfer() at the same time, 0 to disable. Requires an HCD
+// implementing hcd_edpt_iso_xfer()
+#ifndef CFG_TUH_ISO_EP_MAX
+  #define CFG_TUH_ISO_EP_MAX 0
+#endif
+
+// Per endpoint transfer statistics and latency histogram, see tuh_edpt_stats_get(). Application must implement
+// tusb_cycle_count_api()
+#ifndef CFG_TUH_EDPT_STATS
+  #define CFG_TUH_EDPT_STATS 0
+#endif
+
 #ifndef CFG_TUH_EDPT_DEDICATED_HWFIFO
   #define CFG_TUH_EDPT_DEDICATED_HWFIFO 0
 #endif
@@ -0,0 +1,625 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+#include "tusb_option.h"
+#include "device/dcd.h"
+#include "device/usbd.h"
+
+#include "dcd_sim.h"
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF PROTYPES
+//--------------------------------------------------------------------+
+
+// Packet timing of the emulated bus. Overheads are expressed in byte times and cover
+// SYNC, PID, CRC, EOP, handshake and inter-packet delay. Bit stuffing is ignored.
+typedef struct {
+  uint32_t byte_ps;       // time of one byte on the wire in picoseconds
+  uint32_t frame_ps;      // (micro)frame period in picoseconds
+  uint8_t  xact_overhead; // data transaction: token + data packet + handshake
+  uint8_t  nak_overhead;  // NAKed transaction: token + NAK handshake
+} sim_bus_timing_t;
+
+static const sim_bus_timing_t _timing_ls = { .byte_ps = 5333333, .frame_ps = 1000000000u, .xact_overhead = 13, .nak_overhead = 6 };
+static const sim_bus_timing_t _timing_fs = { .byte_ps = 666667, .frame_ps = 1000000000u, .xact_overhead = 13, .nak_overhead = 6 };
+static const sim_bus_timing_t _timing_hs = { .byte_ps = 16667, .frame_ps = 125000000u, .xact_overhead = 40, .nak_overhead = 24 };
+
+typedef struct {
+  uint8_t*   buffer;
+  tu_fifo_t* ff;
+#ifdef TUP_DCD_EDPT_XFER_SG
+  tu_edpt_seg_t const* segs;
+#endif
+  uint32_t   total_len;
+  uint32_t   actual_len;
+  uint16_t   mps;
+  uint8_t    xfer_type;
+  bool       opened;
+  bool       busy;
+  bool       stalled;
+} sim_edpt_t;
+
+typedef struct {
+  sim_config_t cfg;
+  sim_stats_t  stats;
+
+  sim_bus_timing_t const* timing;
+  uint64_t bus_ps;
+  uint64_t next_sof_ps;
+  uint32_t frame_count;
+
+  tusb_speed_t speed;
+  uint8_t address;
+  bool int_enabled;
+  bool sof_enabled;
+
+  sim_edpt_t edpt[CFG_TUD_ENDPPOINT_MAX][2];
+} sim_state_t;
+
+static sim_state_t _sim;
+
+enum {
+  SIM_XACT_NAK   = -1,
+  SIM_XACT_STALL = -2,
+};
+
+//--------------------------------------------------------------------+
+// Bus clock
+//--------------------------------------------------------------------+
+static void bus_advance(uint32_t byte_times) {
+  _sim.bus_ps += (uint64_t) byte_times * _sim.timing->byte_ps;
+
+  while (_sim.bus_ps >= _sim.next_sof_ps) {
+    _sim.next_sof_ps += _sim.timing->frame_ps;
+    _sim.frame_count++;
+    if (_sim.sof_enabled && _sim.int_enabled) {
+      // HS reports the same frame number for all 8 microframes
+      uint32_t const frame = (_sim.speed == TUSB_SPEED_HIGH) ? (_sim.frame_count >> 3) : _sim.frame_count;
+      uint64_t const t0 = sim_cycles();
+      dcd_event_sof(0, frame & 0x7ffu, true);
+      _sim.stats.isr_cycles += sim_cycles() - t0;
+    }
+  }
+
+  _sim.stats.bus_ns = _sim.bus_ps / 1000u;
+}
+
+static inline sim_edpt_t* get_edpt(uint8_t ep_addr) {
+  return &_sim.edpt[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+}
+
+static void xfer_complete(uint8_t ep_addr, sim_edpt_t* ep) {
+  ep->busy = false;
+  _sim.stats.transfers++;
+
+  uint64_t const t0 = sim_cycles();
+  dcd_event_xfer_complete(0, ep_addr, ep->actual_len, XFER_RESULT_SUCCESS, true);
+  _sim.stats.isr_cycles += sim_cycles() - t0;
+}
+
+// Copy packet data between the host and the transfer memory of endpoint at actual_len
+static void edpt_copy(sim_edpt_t* ep, uint8_t* host_buf, uint16_t count, bool is_out) {
+  if (ep->ff != NULL) {
+    if (is_out) {
+      tu_fifo_write_n(ep->ff, host_buf, count);
+    } else {
+      tu_fifo_read_n(ep->ff, host_buf, count);
+    }
+    return;
+  }
+
+#ifdef TUP_DCD_EDPT_XFER_SG
+  if (ep->segs != NULL) {
+    // packet can span segments, like a chained DMA descriptor list
+    tu_edpt_seg_t const* seg = ep->segs;
+    uint32_t offset = ep->actual_len;
+    while (offset >= seg->len) {
+      offset -= seg->len;
+      seg++;
+    }
+    while (count > 0) {
+      uint16_t const n = tu_min16(count, (uint16_t) (seg->len - offset));
+      if (is_out) {
+        memcpy(seg->buf + offset, host_buf, n);
+      } else {
+        memcpy(host_buf, seg->buf + offset, n);
+      }
+      host_buf += n;
+      count -= n;
+      offset = 0;
+      seg++;
+    }
+    return;
+  }
+#endif
+
+  if (is_out) {
+    memcpy(ep->buffer + ep->actual_len, host_buf, count);
+  } else {
+    memcpy(host_buf, ep->buffer + ep->actual_len, count);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Transactions: one packet between virtual host and device endpoint
+//--------------------------------------------------------------------+
+
+// Host -> device data packet. Return number of bytes accepted or SIM_XACT_NAK/STALL
+static int32_t xact_out(uint8_t ep_addr, uint8_t const* data, uint16_t len) {
+  sim_edpt_t* ep = get_edpt(ep_addr);
+
+  if (ep->stalled) {
+    bus_advance(_sim.timing->nak_overhead);
+    return SIM_XACT_STALL;
+  }
+  if (!ep->busy) {
+    bus_advance(_sim.timing->nak_overhead);
+    _sim.stats.naks++;
+    return SIM_XACT_NAK;
+  }
+
+  uint16_t const count = (uint16_t) tu_min32(len, ep->total_len - ep->actual_len);
+
+  if (count > 0) {
+    edpt_copy(ep, (uint8_t*) (uintptr_t) data, count, true);
+  }
+  ep->actual_len += count;
+
+  bus_advance(_sim.timing->xact_overhead + len);
+  _sim.stats.packets++;
+  if (ep_addr != 0) {
+    _sim.stats.bytes += count;
+  }
+
+  if (len < ep->mps || ep->actual_len >= ep->total_len) {
+    xfer_complete(ep_addr, ep);
+  }
+
+  return count;
+}
+
+// Device -> host data packet of at most max_len. Return number of bytes sent or SIM_XACT_NAK/STALL
+static int32_t xact_in(uint8_t ep_addr, uint8_t* buf, uint16_t max_len) {
+  sim_edpt_t* ep = get_edpt(ep_addr);
+
+  if (ep->stalled) {
+    bus_advance(_sim.timing->nak_overhead);
+    return SIM_XACT_STALL;
+  }
+  if (!ep->busy) {
+    bus_advance(_sim.timing->nak_overhead);
+    _sim.stats.naks++;
+    return SIM_XACT_NAK;
+  }
+
+  uint16_t count = (uint16_t) tu_min32(ep->mps, ep->total_len - ep->actual_len);
+  count = tu_min16(count, max_len); // babble is truncated
+
+  if (count > 0) {
+    edpt_copy(ep, buf, count, false);
+  }
+  ep->actual_len += count;
+
+  bus_advance(_sim.timing->xact_overhead + count);
+  _sim.stats.packets++;
+  if (ep_addr != 0x80) {
+    _sim.stats.bytes += count;
+  }
+
+  if (count < ep->mps || ep->actual_len >= ep->total_len) {
+    xfer_complete(ep_addr, ep);
+  }
+
+  return count;
+}
+
+//--------------------------------------------------------------------+
+// Virtual Host API
+//--------------------------------------------------------------------+
+void sim_init(sim_config_t const* cfg) {
+  tu_varclr(&_sim);
+  _sim.cfg = *cfg;
+  if (_sim.cfg.nak_limit == 0) {
+    _sim.cfg.nak_limit = 1000;
+  }
+  _sim.timing = &_timing_fs;
+  _sim.next_sof_ps = _sim.timing->frame_ps;
+}
+
+void sim_device_task(void) {
+  uint64_t const t0 = sim_cycles();
+  _sim.cfg.device_task();
+  _sim.stats.task_cycles += sim_cycles() - t0;
+  _sim.stats.task_runs++;
+}
+
+void sim_attach(tusb_speed_t speed) {
+  _sim.speed = speed;
+  _sim.timing = (speed == TUSB_SPEED_HIGH) ? &_timing_hs : (speed == TUSB_SPEED_LOW) ? &_timing_ls : &_timing_fs;
+  _sim.next_sof_ps = _sim.bus_ps + _sim.timing->frame_ps;
+
+  dcd_event_bus_reset(0, speed, true);
+  sim_device_task();
+}
+
+uint32_t sim_out(uint8_t ep_addr, void const* data, uint32_t len, bool terminate) {
+  uint8_t const* buf = (uint8_t const*) data;
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  uint32_t sent = 0;
+  uint32_t naks = 0;
+  bool zlp = (len == 0);
+
+  while (sent < len || zlp) {
+    uint16_t const pkt_len = zlp ? 0 : (uint16_t) tu_min32(ep->mps, len - sent);
+    int32_t const ret = xact_out(ep_addr, buf + sent, pkt_len);
+
+    if (ret == SIM_XACT_STALL) {
+      break;
+    }
+    if (ret == SIM_XACT_NAK) {
+      if (++naks > _sim.cfg.nak_limit) {
+        break;
+      }
+      sim_device_task();
+      continue;
+    }
+
+    naks = 0;
+    if (!ep->busy) {
+      sim_device_task(); // device runs concurrently with the bus, let it react to completed transfer
+    }
+    if (zlp) {
+      break;
+    }
+    sent += pkt_len;
+
+    // open ended transfer (full-sized last packet): terminate with a ZLP if requested
+    if (sent == len && terminate && pkt_len == ep->mps && ep->busy) {
+      zlp = true;
+    }
+  }
+
+  return sent;
+}
+
+uint32_t sim_in(uint8_t ep_addr, void* buf, uint32_t len) {
+  uint8_t* p = (uint8_t*) buf;
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  uint32_t received = 0;
+  uint32_t naks = 0;
+
+  while (1) {
+    uint16_t const max_len = (uint16_t) tu_min32(ep->mps, len - received);
+    int32_t const ret = xact_in(ep_addr, p + received, max_len);
+
+    if (ret == SIM_XACT_STALL) {
+      break;
+    }
+    if (ret == SIM_XACT_NAK) {
+      if (++naks > _sim.cfg.nak_limit) {
+        break;
+      }
+      sim_device_task();
+      continue;
+    }
+
+    naks = 0;
+    received += (uint32_t) ret;
+    if (!ep->busy) {
+      sim_device_task(); // device runs concurrently with the bus, let it react to completed transfer
+    }
+
+    // short packet or host buffer is full
+    if ((uint32_t) ret < ep->mps || received >= len) {
+      break;
+    }
+  }
+
+  return received;
+}
+
+void sim_next_frame(void) {
+  uint64_t const remain = _sim.next_sof_ps - _sim.bus_ps;
+  bus_advance((uint32_t) ((remain + _sim.timing->byte_ps - 1) / _sim.timing->byte_ps));
+  sim_device_task();
+}
+
+uint32_t sim_iso_in(uint8_t ep_addr, void* buf, uint32_t len) {
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  uint32_t count = 0;
+  if (ep->busy) {
+    int32_t const ret = xact_in(ep_addr, (uint8_t*) buf, (uint16_t) tu_min32(len, UINT16_MAX));
+    count = (ret > 0) ? (uint32_t) ret : 0;
+  }
+  sim_next_frame();
+  return count;
+}
+
+uint32_t sim_iso_out(uint8_t ep_addr, void const* data, uint32_t len) {
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  uint32_t count = 0;
+  if (ep->busy) {
+    int32_t const ret = xact_out(ep_addr, (uint8_t const*) data, (uint16_t) tu_min32(len, ep->mps));
+    count = (ret > 0) ? (uint32_t) ret : 0;
+  }
+  sim_next_frame();
+  return count;
+}
+
+bool sim_control(tusb_control_request_t const* request, void* data, uint16_t* actual_len) {
+  // SETUP is always accepted and clears EP0 stall
+  for (uint8_t dir = 0; dir < 2; dir++) {
+    _sim.edpt[0][dir].stalled = false;
+    _sim.edpt[0][dir].busy = false;
+  }
+  bus_advance(_sim.timing->xact_overhead + sizeof(tusb_control_request_t));
+  dcd_event_setup_received(0, (uint8_t const*) request, true);
+  sim_device_task();
+
+  uint16_t const wLength = request->wLength;
+  uint16_t data_len = 0;
+
+  if (wLength > 0) {
+    if (request->bmRequestType_bit.direction == TUSB_DIR_IN) {
+      data_len = (uint16_t) sim_in(0x80, data, wLength);
+    } else {
+      data_len = (uint16_t) sim_out(0x00, data, wLength, false);
+    }
+    if (_sim.edpt[0][0].stalled || _sim.edpt[0][1].stalled) {
+      return false;
+    }
+  }
+
+  // status stage is opposite direction of data stage
+  if (wLength > 0 && request->bmRequestType_bit.direction == TUSB_DIR_IN) {
+    sim_out(0x00, NULL, 0, false);
+  } else {
+    sim_in(0x80, NULL, 0);
+  }
+  if (_sim.edpt[0][0].stalled || _sim.edpt[0][1].stalled) {
+    return false;
+  }
+
+  // let the stack process status completion
+  sim_device_task();
+
+  if (actual_len != NULL) {
+    *actual_len = data_len;
+  }
+  return true;
+}
+
+bool sim_enumerate(uint8_t cfg_num) {
+  uint8_t desc[512];
+
+  tusb_control_request_t request = {
+    .bmRequestType_bit = { .recipient = TUSB_REQ_RCPT_DEVICE, .type = TUSB_REQ_TYPE_STANDARD, .direction = TUSB_DIR_IN },
+    .bRequest = TUSB_REQ_GET_DESCRIPTOR,
+    .wValue = TUSB_DESC_DEVICE << 8,
+    .wIndex = 0,
+    .wLength = 64
+  };
+  TU_ASSERT(sim_control(&request, desc, NULL));
+
+  request.bmRequestType_bit.direction = TUSB_DIR_OUT;
+  request.bRequest = TUSB_REQ_SET_ADDRESS;
+  request.wValue = 1;
+  request.wLength = 0;
+  TU_ASSERT(sim_control(&request, NULL, NULL));
+
+  request.bmRequestType_bit.direction = TUSB_DIR_IN;
+  request.bRequest = TUSB_REQ_GET_DESCRIPTOR;
+  request.wValue = (uint16_t) ((TUSB_DESC_CONFIGURATION << 8) | (cfg_num - 1));
+  request.wLength = sizeof(tusb_desc_configuration_t);
+  TU_ASSERT(sim_control(&request, desc, NULL));
+
+  uint16_t const total_len = tu_unaligned_read16(desc + offsetof(tusb_desc_configuration_t, wTotalLength));
+  request.wLength = tu_min16(total_len, sizeof(desc));
+  TU_ASSERT(sim_control(&request, desc, NULL));
+
+  request.bmRequestType_bit.direction = TUSB_DIR_OUT;
+  request.bRequest = TUSB_REQ_SET_CONFIGURATION;
+  request.wValue = cfg_num;
+  request.wLength = 0;
+  TU_ASSERT(sim_control(&request, NULL, NULL));
+
+  return tud_mounted();
+}
+
+void sim_stats_reset(void) {
+  tu_varclr(&_sim.stats);
+  _sim.stats.bus_ns = _sim.bus_ps / 1000u;
+}
+
+sim_stats_t const* sim_stats_get(void) {
+  return &_sim.stats;
+}
+
+uint64_t sim_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t val;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(val));
+  return val;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// count every event queued to the device stack
+void tud_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+  (void) rhport; (void) eventid; (void) in_isr;
+  _sim.stats.events++;
+}
+
+//--------------------------------------------------------------------+
+// Controller API
+//--------------------------------------------------------------------+
+bool dcd_init(uint8_t rhport, const tusb_rhport_init_t* rh_init) {
+  (void) rhport; (void) rh_init;
+  tu_memclr(_sim.edpt, sizeof(_sim.edpt));
+  _sim.address = 0;
+  _sim.sof_enabled = false;
+  return true;
+}
+
+bool dcd_deinit(uint8_t rhport) {
+  (void) rhport;
+  tu_memclr(_sim.edpt, sizeof(_sim.edpt));
+  return true;
+}
+
+void dcd_int_handler(uint8_t rhport) {
+  (void) rhport; // events are generated synchronously by the virtual host
+}
+
+void dcd_int_enable(uint8_t rhport) {
+  (void) rhport;
+  _sim.int_enabled = true;
+}
+
+void dcd_int_disable(uint8_t rhport) {
+  (void) rhport;
+  _sim.int_enabled = false;
+}
+
+void dcd_set_address(uint8_t rhport, uint8_t dev_addr) {
+  _sim.address = dev_addr;
+  // Respond with status
+  dcd_edpt_xfer(rhport, tu_edpt_addr(0, TUSB_DIR_IN), NULL, 0, false);
+}
+
+void dcd_remote_wakeup(uint8_t rhport) {
+  (void) rhport;
+}
+
+void dcd_connect(uint8_t rhport) {
+  (void) rhport;
+}
+
+void dcd_disconnect(uint8_t rhport) {
+  (void) rhport;
+}
+
+void dcd_sof_enable(uint8_t rhport, bool en) {
+  (void) rhport;
+  _sim.sof_enabled = en;
+}
+
+//--------------------------------------------------------------------+
+// Endpoint API
+//--------------------------------------------------------------------+
+static void edpt_open(tusb_desc_endpoint_t const* desc_ep) {
+  sim_edpt_t* ep = get_edpt(desc_ep->bEndpointAddress);
+  tu_memclr(ep, sizeof(sim_edpt_t));
+  ep->mps = tu_edpt_packet_size(desc_ep);
+  ep->xfer_type = desc_ep->bmAttributes.xfer;
+  ep->opened = true;
+}
+
+bool dcd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep) {
+  (void) rhport;
+  TU_ASSERT(tu_edpt_number(desc_ep->bEndpointAddress) < CFG_TUD_ENDPPOINT_MAX);
+  edpt_open(desc_ep);
+  return true;
+}
+
+void dcd_edpt_close_all(uint8_t rhport) {
+  (void) rhport;
+  for (uint8_t epnum = 1; epnum < CFG_TUD_ENDPPOINT_MAX; epnum++) {
+    tu_memclr(_sim.edpt[epnum], sizeof(_sim.edpt[epnum]));
+  }
+}
+
+#ifdef TUP_DCD_EDPT_CLOSE_API
+void dcd_edpt_close(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  tu_memclr(get_edpt(ep_addr), sizeof(sim_edpt_t));
+}
+#else
+bool dcd_edpt_iso_alloc(uint8_t rhport, uint8_t ep_addr, uint16_t largest_packet_size) {
+  (void) rhport; (void) largest_packet_size;
+  TU_ASSERT(tu_edpt_number(ep_addr) < CFG_TUD_ENDPPOINT_MAX);
+  return true;
+}
+
+bool dcd_edpt_iso_activate(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep) {
+  (void) rhport;
+  edpt_open(desc_ep);
+  return true;
+}
+#endif
+
+bool dcd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr) {
+  (void) rhport; (void) is_isr;
+  sim_edpt_t* ep = get_edpt(ep_addr);
+
+  if (tu_edpt_number(ep_addr) == 0) {
+    ep->mps = CFG_TUD_ENDPOINT0_SIZE;
+  } else {
+    TU_ASSERT(ep->opened);
+  }
+  TU_ASSERT(!ep->busy);
+
+  ep->buffer = buffer;
+  ep->ff = NULL;
+#ifdef TUP_DCD_EDPT_XFER_SG
+  ep->segs = NULL;
+#endif
+  ep->total_len = total_bytes;
+  ep->actual_len = 0;
+  ep->busy = true;
+  return true;
+}
+
+bool dcd_edpt_xfer_fifo(uint8_t rhport, uint8_t ep_addr, tu_fifo_t* ff, uint16_t total_bytes, bool is_isr) {
+  TU_ASSERT(dcd_edpt_xfer(rhport, ep_addr, NULL, total_bytes, is_isr));
+  get_edpt(ep_addr)->ff = ff;
+  return true;
+}
+
+#ifdef TUP_DCD_EDPT_XFER_SG
+bool dcd_edpt_xfer_sg(uint8_t rhport, uint8_t ep_addr, tu_edpt_seg_t const* segs, uint8_t count, bool is_isr) {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    total += segs[i].len;
+  }
+
+  TU_ASSERT(dcd_edpt_xfer(rhport, ep_addr, NULL, 0, is_isr));
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  ep->segs = segs;
+  ep->total_len = total;
+  return true;
+}
+#endif
+
+void dcd_edpt_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  sim_edpt_t* ep = get_edpt(ep_addr);
+  ep->stalled = true;
+  ep->busy = false;
+}
+
+void dcd_edpt_abort_xfer(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  get_edpt(ep_addr)->busy = false;
+}
+
+void dcd_edpt_clear_stall(uint8_t rhport, uint8_t ep_addr) {
+  (void) rhport;
+  get_edpt(ep_addr)->stalled = false;
+}
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_DCD_SIM_H_
+#define TUSB_DCD_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common/tusb_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Simulated device controller for running the device stack on a Linux host.
+//
+// Instead of a bus, dcd_sim is driven by a scripted virtual host: the benchmark
+// calls sim_control() / sim_out() / sim_in() which move data packet by packet into
+// and out of the transfers the stack has queued with dcd_edpt_xfer(). Every packet
+// advances an emulated bus clock according to FS/HS packet timing, so throughput
+// numbers measured in bus time are deterministic and independent of the machine.
+// When an endpoint has nothing queued the host is NAKed and the device loop
+// (sim_config_t.device_task) is run so the stack and application can catch up.
+
+typedef struct {
+  uint64_t bus_ns;       // emulated bus time
+  uint64_t bytes;        // payload bytes moved on non-control endpoints
+  uint32_t packets;      // data packets (including ZLPs)
+  uint32_t naks;         // packets NAKed because no transfer was queued
+  uint32_t transfers;    // device transfers completed (dcd_event_xfer_complete)
+  uint32_t events;       // events queued to the device stack
+  uint32_t task_runs;    // device loop invocations
+  uint64_t task_cycles;  // cycles spent in the device loop
+  uint64_t isr_cycles;   // cycles spent in the simulated interrupt (event handler + xfer_isr)
+} sim_stats_t;
+
+typedef struct {
+  void (*device_task)(void); // device main loop: tud_task() plus application task(s)
+  uint32_t nak_limit;        // consecutive NAKs before sim_out()/sim_in() give up
+} sim_config_t;
+
+// Configure simulator, must be called before tusb_init()
+void sim_init(sim_config_t const* cfg);
+
+// Connect the virtual host: bus reset at given speed, then wait for the stack to settle
+void sim_attach(tusb_speed_t speed);
+
+// Full control transfer on EP0 (setup, optional data, status). Return false if stalled.
+// For IN request, up to wLength bytes are stored into data. actual_len (optional) returns data stage length.
+bool sim_control(tusb_control_request_t const* request, void* data, uint16_t* actual_len);
+
+// Standard enumeration: get device descriptor, set address, get configuration, set configuration
+bool sim_enumerate(uint8_t cfg_num);
+
+// Host sends len bytes to an OUT endpoint. If terminate is true, a ZLP is sent when
+// the last packet is full-sized and the device transfer is still open.
+// Return number of bytes accepted by the device before the NAK limit is reached.
+uint32_t sim_out(uint8_t ep_addr, void const* data, uint32_t len, bool terminate);
+
+// Host reads up to len bytes from an IN endpoint, stopping at a short packet.
+// Return number of bytes received.
+uint32_t sim_in(uint8_t ep_addr, void* buf, uint32_t len);
+
+// Isochronous/interrupt style: one transaction on the endpoint in the current (micro)frame,
+// then advance to the next (micro)frame. Return number of bytes moved (0 if not armed).
+uint32_t sim_iso_in(uint8_t ep_addr, void* buf, uint32_t len);
+uint32_t sim_iso_out(uint8_t ep_addr, void const* data, uint32_t len);
+
+// Advance bus time to the start of the next (micro)frame and issue SOF if enabled
+void sim_next_frame(void);
+
+// Run device loop once (accounted in stats)
+void sim_device_task(void);
+
+// Statistics
+void sim_stats_reset(void);
+sim_stats_t const* sim_stats_get(void);
+
+// Free running cycle counter of the host CPU (TSC on x86, virtual counter on aarch64, ns otherwise)
+uint64_t sim_cycles(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
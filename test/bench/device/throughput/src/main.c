@@ -0,0 +1,683 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+// Throughput and latency benchmark of the device stack running on dcd_sim.
+//
+// A scripted virtual host enumerates the composite device (CDC, MSC, NCM, vendor and UAC2 microphone)
+// then streams a fixed amount of data through each class. Results are reported as:
+// - bus MB/s, ev/s: payload throughput and event rate in emulated bus time (deterministic). ev/s is "-" for
+//                   classes completing transfers in xfer_isr, which queue no event
+// - cyc/xfer      : host CPU cycles spent in tud_task_ext() + class xfer_cb + simulated ISR per transfer
+// - host MB/s     : payload throughput in wall clock time of the machine running the benchmark
+// Each bench runs BENCH_RUNS times, cyc/xfer and host MB/s are the median of all runs.
+//
+// Usage: throughput [full|high]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tusb.h"
+#include "class/net/ncm.h"
+#include "dcd_sim.h"
+#include "usb_descriptors.h"
+
+//--------------------------------------------------------------------+
+// MACRO CONSTANT TYPEDEF PROTYPES
+//--------------------------------------------------------------------+
+#define BENCH_BULK_TOTAL   (1024u * 1024u)
+#define BENCH_CHUNK        4096u
+#define BENCH_AUDIO_MS     1000u
+
+// runs of each bench, host cycle and wall clock figures vary between runs and are reported as median
+#ifndef BENCH_RUNS
+#define BENCH_RUNS         5u
+#endif
+
+#define DISK_BLOCK_SIZE    512u
+#define DISK_BLOCK_NUM     256u
+#define MSC_BLOCKS_PER_CMD 64u
+
+// emulated storage latency of each read10/write10 callback (asynchronous IO), 0 for synchronous memcpy
+#ifndef MSC_IO_LATENCY_NS
+#define MSC_IO_LATENCY_NS  40000u
+#endif
+
+#define NET_DATAGRAM_SIZE  1514u
+
+typedef struct {
+  const char* name;
+  uint32_t (*run)(void); // return payload bytes moved
+  bool xfer_isr;         // transfers complete in class xfer_isr without queuing an event
+} bench_t;
+
+static uint8_t _host_buf[CFG_TUD_NCM_OUT_NTB_MAX_SIZE > BENCH_CHUNK ? CFG_TUD_NCM_OUT_NTB_MAX_SIZE : BENCH_CHUNK];
+static uint8_t _dev_buf[BENCH_CHUNK];
+static uint8_t _disk[DISK_BLOCK_NUM][DISK_BLOCK_SIZE];
+
+// device application state
+static struct {
+  uint32_t cdc_tx_remain;
+  uint32_t cdc_rx_count;
+  uint32_t vendor_tx_remain;
+  uint32_t vendor_rx_count;
+  uint32_t net_tx_remain;
+  uint32_t net_rx_count;
+  bool     net_rx_pending;
+  const uint8_t* net_rx_lent[CFG_TUD_NCM_OUT_NTB_N * CFG_TUD_NCM_OUT_MAX_DATAGRAMS_PER_NTB];
+  uint16_t net_rx_lent_count;
+  bool     audio_streaming;
+  uint32_t audio_written;
+
+  // pending asynchronous disk IO
+  uint8_t* msc_io_dst;
+  uint8_t const* msc_io_src;
+  uint32_t msc_io_count;
+  uint64_t msc_io_done_ns;
+} _app;
+
+//--------------------------------------------------------------------+
+// Device Application
+//--------------------------------------------------------------------+
+static void cdc_task(void) {
+  uint32_t count;
+  while ((count = tud_cdc_read(_dev_buf, sizeof(_dev_buf))) > 0) {
+    _app.cdc_rx_count += count;
+  }
+
+  while (_app.cdc_tx_remain > 0) {
+    uint32_t const len = tu_min32(tu_min32(tud_cdc_write_available(), _app.cdc_tx_remain), sizeof(_dev_buf));
+    if (len == 0) {
+      break;
+    }
+    tud_cdc_write(_dev_buf, len);
+    _app.cdc_tx_remain -= len;
+  }
+  tud_cdc_write_flush();
+}
+
+static void vendor_task(void) {
+  uint32_t count;
+  while ((count = tud_vendor_read(_dev_buf, sizeof(_dev_buf))) > 0) {
+    _app.vendor_rx_count += count;
+  }
+
+  while (_app.vendor_tx_remain > 0) {
+    uint32_t const len = tu_min32(tu_min32(tud_vendor_write_available(), _app.vendor_tx_remain), sizeof(_dev_buf));
+    if (len == 0) {
+      break;
+    }
+    tud_vendor_write(_dev_buf, len);
+    _app.vendor_tx_remain -= len;
+  }
+  tud_vendor_write_flush();
+}
+
+static void net_task(void) {
+  // mimic a zero-copy network stack glue: consume lent datagrams, return them then renew
+  if (_app.net_rx_pending) {
+    _app.net_rx_pending = false;
+    for (uint16_t i = 0; i < _app.net_rx_lent_count; i++) {
+      tud_network_recv_release(_app.net_rx_lent[i]);
+    }
+    _app.net_rx_lent_count = 0;
+    tud_network_recv_renew();
+  }
+
+  while (_app.net_tx_remain > 0 && tud_network_can_xmit(NET_DATAGRAM_SIZE)) {
+    tud_network_xmit(NULL, NET_DATAGRAM_SIZE);
+    _app.net_tx_remain -= tu_min32(_app.net_tx_remain, NET_DATAGRAM_SIZE);
+  }
+}
+
+static void audio_task(void) {
+  if (!_app.audio_streaming) {
+    return;
+  }
+
+  // emulate I2S DMA producing samples in real (bus) time
+  uint32_t const bytes_per_ms = CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE / 1000 * CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX *
+                                CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX;
+  uint64_t const due = sim_stats_get()->bus_ns * bytes_per_ms / 1000000u;
+
+  while (_app.audio_written < due) {
+    uint16_t const len = (uint16_t) tu_min32((uint32_t) (due - _app.audio_written), sizeof(_dev_buf));
+    uint16_t const written = tud_audio_write(_dev_buf, len);
+    if (written == 0) {
+      break;
+    }
+    _app.audio_written += written;
+  }
+}
+
+static void msc_task(void) {
+  if (_app.msc_io_count > 0 && sim_stats_get()->bus_ns >= _app.msc_io_done_ns) {
+    uint32_t const count = _app.msc_io_count;
+    _app.msc_io_count = 0;
+    memcpy(_app.msc_io_dst, _app.msc_io_src, count);
+    tud_msc_async_io_done((int32_t) count, false);
+  }
+}
+
+static void device_task(void) {
+  tud_task();
+  msc_task();
+  cdc_task();
+  vendor_task();
+  net_task();
+  audio_task();
+}
+
+//--------------------------------------------------------------------+
+// Class callbacks
+//--------------------------------------------------------------------+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+  (void) lun;
+  memcpy(vendor_id, "TinyUSB ", 8);
+  memcpy(product_id, "Bench Disk      ", 16);
+  memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+  (void) lun;
+  return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
+  (void) lun;
+  *block_count = DISK_BLOCK_NUM;
+  *block_size = DISK_BLOCK_SIZE;
+}
+
+// complete disk IO now or after MSC_IO_LATENCY_NS of bus time
+static int32_t msc_disk_io(uint8_t* dst, uint8_t const* src, uint32_t count) {
+  if (MSC_IO_LATENCY_NS == 0) {
+    memcpy(dst, src, count);
+    return (int32_t) count;
+  }
+  _app.msc_io_dst = dst;
+  _app.msc_io_src = src;
+  _app.msc_io_count = count;
+  _app.msc_io_done_ns = sim_stats_get()->bus_ns + MSC_IO_LATENCY_NS;
+  return TUD_MSC_RET_ASYNC;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  (void) lun;
+  uint8_t const* addr = _disk[lba % DISK_BLOCK_NUM] + offset;
+  uint32_t const count = tu_min32(bufsize, DISK_BLOCK_SIZE * (DISK_BLOCK_NUM - lba % DISK_BLOCK_NUM) - offset);
+  return msc_disk_io((uint8_t*) buffer, addr, count);
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
+  (void) lun;
+  uint8_t* addr = _disk[lba % DISK_BLOCK_NUM] + offset;
+  uint32_t const count = tu_min32(bufsize, DISK_BLOCK_SIZE * (DISK_BLOCK_NUM - lba % DISK_BLOCK_NUM) - offset);
+  return msc_disk_io(addr, buffer, count);
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, uint16_t bufsize) {
+  (void) buffer; (void) bufsize; (void) scsi_cmd;
+  tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+  return -1;
+}
+
+uint16_t tud_network_recv_batch_cb(const ncm_datagram_t datagrams[], uint16_t count) {
+  count = tu_min16(count, (uint16_t) (TU_ARRAY_SIZE(_app.net_rx_lent) - _app.net_rx_lent_count));
+  for (uint16_t i = 0; i < count; i++) {
+    _app.net_rx_lent[_app.net_rx_lent_count++] = datagrams[i].buffer;
+    _app.net_rx_count += datagrams[i].len;
+  }
+  _app.net_rx_pending = true;
+  return count;
+}
+
+uint16_t tud_network_xmit_cb(uint8_t* dst, void* ref, uint16_t arg) {
+  (void) ref;
+  memset(dst, 0xa5, arg);
+  return arg;
+}
+
+void tud_network_init_cb(void) {
+}
+
+bool tud_audio_set_itf_cb(uint8_t rhport, tusb_control_request_t const* p_request) {
+  (void) rhport;
+  if (tu_u16_low(p_request->wIndex) == ITF_NUM_AUDIO_STREAMING) {
+    _app.audio_streaming = tu_u16_low(p_request->wValue) != 0;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Virtual host scripts
+//--------------------------------------------------------------------+
+static bool host_set_interface(uint8_t itf, uint8_t alt) {
+  tusb_control_request_t const request = {
+    .bmRequestType_bit = { .recipient = TUSB_REQ_RCPT_INTERFACE, .type = TUSB_REQ_TYPE_STANDARD, .direction = TUSB_DIR_OUT },
+    .bRequest = TUSB_REQ_SET_INTERFACE,
+    .wValue = alt,
+    .wIndex = itf,
+    .wLength = 0
+  };
+  return sim_control(&request, NULL, NULL);
+}
+
+static bool host_cdc_set_dtr(void) {
+  tusb_control_request_t const request = {
+    .bmRequestType_bit = { .recipient = TUSB_REQ_RCPT_INTERFACE, .type = TUSB_REQ_TYPE_CLASS, .direction = TUSB_DIR_OUT },
+    .bRequest = CDC_REQUEST_SET_CONTROL_LINE_STATE,
+    .wValue = 0x03,
+    .wIndex = ITF_NUM_CDC,
+    .wLength = 0
+  };
+  return sim_control(&request, NULL, NULL);
+}
+
+// keep running device until condition is met, bounded by a number of device loop
+#define DEVICE_RUN_UNTIL(_cond)                           \
+  do {                                                    \
+    for (uint32_t _i = 0; _i < 1000 && !(_cond); _i++) {  \
+      sim_device_task();                                  \
+    }                                                     \
+  } while (0)
+
+static uint32_t bench_cdc_out(void) {
+  _app.cdc_rx_count = 0;
+  for (uint32_t sent = 0; sent < BENCH_BULK_TOTAL; sent += BENCH_CHUNK) {
+    if (sim_out(EPNUM_CDC_OUT, _host_buf, BENCH_CHUNK, false) != BENCH_CHUNK) {
+      break;
+    }
+  }
+  DEVICE_RUN_UNTIL(_app.cdc_rx_count >= BENCH_BULK_TOTAL);
+  return _app.cdc_rx_count;
+}
+
+static uint32_t bench_cdc_in(void) {
+  uint32_t received = 0;
+  _app.cdc_tx_remain = BENCH_BULK_TOTAL;
+  while (received < BENCH_BULK_TOTAL) {
+    uint32_t const count = sim_in(EPNUM_CDC_IN, _host_buf, BENCH_CHUNK);
+    if (count == 0 && _app.cdc_tx_remain == 0 && !tud_cdc_write_available()) {
+      break;
+    }
+    received += count;
+  }
+  return received;
+}
+
+static uint32_t msc_command(bool is_read, uint32_t tag, uint32_t lba) {
+  uint32_t const data_len = MSC_BLOCKS_PER_CMD * DISK_BLOCK_SIZE;
+  msc_cbw_t cbw = {
+    .signature = MSC_CBW_SIGNATURE,
+    .tag = tag,
+    .total_bytes = data_len,
+    .dir = is_read ? TUSB_DIR_IN_MASK : 0,
+    .lun = 0,
+    .cmd_len = sizeof(scsi_read10_t),
+  };
+  scsi_read10_t const cmd = {
+    .cmd_code = is_read ? SCSI_CMD_READ_10 : SCSI_CMD_WRITE_10,
+    .lba = tu_htonl(lba),
+    .block_count = tu_htons(MSC_BLOCKS_PER_CMD)
+  };
+  memcpy(cbw.command, &cmd, sizeof(cmd));
+
+  TU_VERIFY(sim_out(EPNUM_MSC_OUT, &cbw, sizeof(cbw), false) == sizeof(cbw), 0);
+
+  uint32_t xferred = 0;
+  while (xferred < data_len) {
+    uint32_t const len = tu_min32(data_len - xferred, BENCH_CHUNK);
+    uint32_t const count = is_read ? sim_in(EPNUM_MSC_IN, _host_buf, len) : sim_out(EPNUM_MSC_OUT, _host_buf, len, false);
+    if (count == 0) {
+      break;
+    }
+    xferred += count;
+  }
+
+  msc_csw_t csw;
+  TU_VERIFY(sim_in(EPNUM_MSC_IN, &csw, sizeof(csw)) == sizeof(csw), 0);
+  TU_VERIFY(csw.signature == MSC_CSW_SIGNATURE && csw.tag == tag && csw.status == MSC_CSW_STATUS_PASSED, 0);
+
+  return xferred;
+}
+
+static uint32_t bench_msc(bool is_read) {
+  uint32_t total = 0;
+  uint32_t const cmd_count = BENCH_BULK_TOTAL / (MSC_BLOCKS_PER_CMD * DISK_BLOCK_SIZE);
+  for (uint32_t i = 0; i < cmd_count; i++) {
+    uint32_t const count = msc_command(is_read, i + 1, (i * MSC_BLOCKS_PER_CMD) % DISK_BLOCK_NUM);
+    if (count == 0) {
+      break;
+    }
+    total += count;
+  }
+  return total;
+}
+
+static uint32_t bench_msc_read(void) {
+  return bench_msc(true);
+}
+
+static uint32_t bench_msc_write(void) {
+  return bench_msc(false);
+}
+
+// UAS: host keeps up to queue depth commands outstanding, device starts the next one without waiting for host
+static bool uas_send_command(bool is_read, uint16_t tag, uint32_t lba) {
+  msc_uas_cmd_iu_t iu = {
+    .iu_id = MSC_UAS_IU_COMMAND,
+    .tag = tu_htons(tag),
+  };
+  scsi_read10_t const cmd = {
+    .cmd_code = is_read ? SCSI_CMD_READ_10 : SCSI_CMD_WRITE_10,
+    .lba = tu_htonl(lba),
+    .block_count = tu_htons(MSC_BLOCKS_PER_CMD)
+  };
+  memcpy(iu.cdb, &cmd, sizeof(cmd));
+  return sim_out(EPNUM_UAS_CMD, &iu, sizeof(iu), false) == sizeof(iu);
+}
+
+static uint32_t uas_complete_command(bool is_read, uint16_t tag) {
+  uint32_t const data_len = MSC_BLOCKS_PER_CMD * DISK_BLOCK_SIZE;
+
+  msc_uas_ready_iu_t ready;
+  TU_VERIFY(sim_in(EPNUM_UAS_STATUS, &ready, sizeof(ready)) == sizeof(ready), 0);
+  TU_VERIFY(ready.iu_id == (is_read ? MSC_UAS_IU_READ_READY : MSC_UAS_IU_WRITE_READY) && tu_ntohs(ready.tag) == tag, 0);
+
+  uint32_t xferred = 0;
+  while (xferred < data_len) {
+    uint32_t const len = tu_min32(data_len - xferred, BENCH_CHUNK);
+    uint32_t const count = is_read ? sim_in(EPNUM_UAS_DATA_IN, _host_buf, len) :
+                                     sim_out(EPNUM_UAS_DATA_OUT, _host_buf, len, false);
+    if (count == 0) {
+      break;
+    }
+    xferred += count;
+  }
+
+  msc_uas_sense_iu_t sense;
+  TU_VERIFY(sim_in(EPNUM_UAS_STATUS, &sense, sizeof(sense)) >= offsetof(msc_uas_sense_iu_t, sense), 0);
+  TU_VERIFY(sense.iu_id == MSC_UAS_IU_SENSE && tu_ntohs(sense.tag) == tag && sense.status == SCSI_STATUS_GOOD, 0);
+
+  return xferred;
+}
+
+static uint32_t bench_msc_uas(bool is_read) {
+  uint32_t total = 0;
+  uint32_t sent = 0;
+  uint32_t const cmd_count = BENCH_BULK_TOTAL / (MSC_BLOCKS_PER_CMD * DISK_BLOCK_SIZE);
+
+  TU_VERIFY(host_set_interface(ITF_NUM_MSC, 1), 0);
+  for (uint32_t i = 0; i < cmd_count; i++) {
+    while (sent < cmd_count && sent < i + CFG_TUD_MSC_UAS_QUEUE_DEPTH) {
+      if (!uas_send_command(is_read, (uint16_t) (sent + 1), (sent * MSC_BLOCKS_PER_CMD) % DISK_BLOCK_NUM)) {
+        break;
+      }
+      sent++;
+    }
+
+    uint32_t const count = uas_complete_command(is_read, (uint16_t) (i + 1));
+    if (count == 0) {
+      break;
+    }
+    total += count;
+  }
+  TU_VERIFY(host_set_interface(ITF_NUM_MSC, 0), total);
+
+  return total;
+}
+
+static uint32_t bench_msc_uas_read(void) {
+  return bench_msc_uas(true);
+}
+
+static uint32_t bench_msc_uas_write(void) {
+  return bench_msc_uas(false);
+}
+
+static uint32_t bench_ncm_out(void) {
+  // NTB with as many full size datagrams as fit into the device OUT NTB
+  uint16_t const dg_count = 2;
+  uint16_t const ndp_len = (uint16_t) (sizeof(ndp16_t) + (dg_count + 1) * sizeof(ndp16_datagram_t));
+  uint16_t const dg_offset = (uint16_t) tu_align4(sizeof(nth16_t) + ndp_len + 3);
+  uint16_t const dg_stride = (uint16_t) tu_align4(NET_DATAGRAM_SIZE + 3);
+  uint16_t const ntb_len = (uint16_t) (dg_offset + (dg_count - 1) * dg_stride + NET_DATAGRAM_SIZE);
+  TU_VERIFY(ntb_len <= CFG_TUD_NCM_OUT_NTB_MAX_SIZE, 0);
+
+  memset(_host_buf, 0, ntb_len);
+  nth16_t* nth = (nth16_t*) (uintptr_t) _host_buf;
+  nth->dwSignature = NTH16_SIGNATURE;
+  nth->wHeaderLength = sizeof(nth16_t);
+  nth->wBlockLength = ntb_len;
+  nth->wNdpIndex = sizeof(nth16_t);
+
+  ndp16_t* ndp = (ndp16_t*) (uintptr_t) (_host_buf + sizeof(nth16_t));
+  ndp->dwSignature = NDP16_SIGNATURE_NCM0;
+  ndp->wLength = ndp_len;
+  ndp->wNextNdpIndex = 0;
+
+  ndp16_datagram_t* dg = (ndp16_datagram_t*) (uintptr_t) (_host_buf + sizeof(nth16_t) + sizeof(ndp16_t));
+  for (uint16_t i = 0; i < dg_count; i++) {
+    dg[i].wDatagramIndex = (uint16_t) (dg_offset + i * dg_stride);
+    dg[i].wDatagramLength = NET_DATAGRAM_SIZE;
+  }
+
+  _app.net_rx_count = 0;
+  uint32_t const ntb_count = BENCH_BULK_TOTAL / (dg_count * NET_DATAGRAM_SIZE);
+  for (uint32_t i = 0; i < ntb_count; i++) {
+    nth->wSequence = (uint16_t) i;
+    if (sim_out(EPNUM_NCM_OUT, _host_buf, ntb_len, true) != ntb_len) {
+      break;
+    }
+  }
+  DEVICE_RUN_UNTIL(!_app.net_rx_pending);
+  return _app.net_rx_count;
+}
+
+static uint32_t bench_ncm_in(void) {
+  uint32_t received = 0;
+  _app.net_tx_remain = BENCH_BULK_TOTAL;
+
+  while (received < BENCH_BULK_TOTAL) {
+    uint32_t const count = sim_in(EPNUM_NCM_IN, _host_buf, CFG_TUD_NCM_IN_NTB_MAX_SIZE);
+    if (count == 0) {
+      if (_app.net_tx_remain == 0) {
+        break;
+      }
+      continue; // ZLP
+    }
+
+    // count datagram payload of the received NTB
+    nth16_t const* nth = (nth16_t const*) (uintptr_t) _host_buf;
+    TU_VERIFY(nth->dwSignature == NTH16_SIGNATURE, received);
+    ndp16_datagram_t const* dg = (ndp16_datagram_t const*) (uintptr_t) (_host_buf + nth->wNdpIndex + sizeof(ndp16_t));
+    for (; dg->wDatagramIndex != 0 && dg->wDatagramLength != 0; dg++) {
+      received += dg->wDatagramLength;
+    }
+  }
+
+  return received;
+}
+
+static uint32_t bench_vendor_out(void) {
+  _app.vendor_rx_count = 0;
+  for (uint32_t sent = 0; sent < BENCH_BULK_TOTAL; sent += BENCH_CHUNK) {
+    if (sim_out(EPNUM_VENDOR_OUT, _host_buf, BENCH_CHUNK, false) != BENCH_CHUNK) {
+      break;
+    }
+  }
+  DEVICE_RUN_UNTIL(_app.vendor_rx_count >= BENCH_BULK_TOTAL);
+  return _app.vendor_rx_count;
+}
+
+static uint32_t bench_vendor_in(void) {
+  uint32_t received = 0;
+  _app.vendor_tx_remain = BENCH_BULK_TOTAL;
+  while (received < BENCH_BULK_TOTAL) {
+    uint32_t const count = sim_in(EPNUM_VENDOR_IN, _host_buf, BENCH_CHUNK);
+    if (count == 0 && _app.vendor_tx_remain == 0 && !tud_vendor_write_available()) {
+      break;
+    }
+    received += count;
+  }
+  return received;
+}
+
+static uint32_t bench_audio_in(void) {
+  uint32_t const frames_per_ms = (tud_speed_get() == TUSB_SPEED_HIGH) ? 8 : 1;
+  uint32_t received = 0;
+
+  TU_VERIFY(host_set_interface(ITF_NUM_AUDIO_STREAMING, 1), 0);
+  _app.audio_written = (uint32_t) (sim_stats_get()->bus_ns * (CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE / 1000) *
+                                   CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX / 1000000u);
+
+  for (uint32_t i = 0; i < BENCH_AUDIO_MS * frames_per_ms; i++) {
+    received += sim_iso_in(EPNUM_AUDIO_IN, _host_buf, CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX);
+  }
+
+  TU_VERIFY(host_set_interface(ITF_NUM_AUDIO_STREAMING, 0), received);
+  return received;
+}
+
+static const bench_t _bench_list[] = {
+  { "cdc_out"   , bench_cdc_out    , false },
+  { "cdc_in"    , bench_cdc_in     , false },
+  { "msc_write" , bench_msc_write  , false },
+  { "msc_read"  , bench_msc_read   , false },
+  { "uas_write" , bench_msc_uas_write , false },
+  { "uas_read"  , bench_msc_uas_read  , false },
+  { "ncm_out"   , bench_ncm_out    , false },
+  { "ncm_in"    , bench_ncm_in     , false },
+  { "vendor_out", bench_vendor_out , false },
+  { "vendor_in" , bench_vendor_in  , false },
+  { "audio_in"  , bench_audio_in   , true },
+};
+
+//--------------------------------------------------------------------+
+// Main
+//--------------------------------------------------------------------+
+#if CFG_TUD_EDPT_STATS
+uint32_t tusb_cycle_count_api(void) {
+  return (uint32_t) sim_cycles();
+}
+
+// Print endpoint statistics accumulated over all benches, latency in host cycles (upper bound of median bin)
+static void print_edpt_stats(void) {
+  printf("\n%-6s %9s %12s %7s %7s %12s\n", "ep", "xfers", "bytes", "stalls", "errors", "p50 cycles");
+  for (uint8_t epnum = 0; epnum < CFG_TUD_ENDPPOINT_MAX; epnum++) {
+    for (uint8_t dir = 0; dir < 2; dir++) {
+      uint8_t const ep_addr = tu_edpt_addr(epnum, dir);
+      tu_edpt_stats_t stats;
+      if (!tud_edpt_stats_get(ep_addr, &stats) || stats.submitted == 0) {
+        continue;
+      }
+
+      uint32_t count = 0;
+      uint8_t bin = 0;
+      while (bin < TU_EDPT_STATS_HIST_BINS - 1 && (count += stats.latency_hist[bin]) * 2 < stats.completed) {
+        bin++;
+      }
+      printf("0x%02x   %9u %12llu %7u %7u %12lu\n", ep_addr, (unsigned) stats.completed,
+             (unsigned long long) stats.bytes, (unsigned) stats.stalls, (unsigned) stats.errors, 1ul << (bin + 1));
+    }
+  }
+}
+#endif
+
+static double median(double* v, size_t n) {
+  for (size_t i = 1; i < n; i++) {
+    double const x = v[i];
+    size_t j = i;
+    for (; j > 0 && v[j - 1] > x; j--) {
+      v[j] = v[j - 1];
+    }
+    v[j] = x;
+  }
+  return (n & 1) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static double wall_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+  tusb_speed_t speed = TUSB_SPEED_HIGH;
+  if (argc > 1 && strcmp(argv[1], "full") == 0) {
+    speed = TUSB_SPEED_FULL;
+  }
+
+  sim_config_t const sim_cfg = {
+    .device_task = device_task,
+    .nak_limit = 10000
+  };
+  sim_init(&sim_cfg);
+
+  tusb_rhport_init_t const dev_init = {
+    .role = TUSB_ROLE_DEVICE,
+    .speed = TUSB_SPEED_AUTO
+  };
+  tusb_init(BOARD_TUD_RHPORT, &dev_init);
+
+  sim_attach(speed);
+  if (!sim_enumerate(1) || !host_cdc_set_dtr() || !host_set_interface(ITF_NUM_NCM_DATA, 1)) {
+    printf("enumeration failed\n");
+    return 1;
+  }
+
+  printf("TinyUSB device benchmark on dcd_sim, %s speed\n", speed == TUSB_SPEED_HIGH ? "High" : "Full");
+  printf("%-11s %10s %10s %10s %10s %9s %10s %10s\n",
+         "bench", "bytes", "bus ms", "bus MB/s", "bus ev/s", "xfers", "cyc/xfer", "host MB/s");
+
+  int ret = 0;
+  for (size_t i = 0; i < TU_ARRAY_SIZE(_bench_list); i++) {
+    bench_t const* bench = &_bench_list[i];
+
+    double cyc_xfer[BENCH_RUNS];
+    double host_mbps[BENCH_RUNS];
+    uint32_t bytes = 0;
+    double bus_s = 0;
+    sim_stats_t stats = { 0 };
+
+    // bus figures are deterministic, the ones of the last run are reported
+    for (uint32_t run = 0; run < BENCH_RUNS; run++) {
+      sim_stats_reset();
+      uint64_t const bus_start = sim_stats_get()->bus_ns;
+      double const t0 = wall_seconds();
+      bytes = bench->run();
+      double const wall = wall_seconds() - t0;
+      stats = *sim_stats_get();
+
+      bus_s = (double) (stats.bus_ns - bus_start) / 1e9;
+      double const cycles = (double) (stats.task_cycles + stats.isr_cycles);
+      cyc_xfer[run] = stats.transfers ? cycles / (double) stats.transfers : 0.0;
+      host_mbps[run] = (double) bytes / 1e6 / wall;
+
+      if (bytes == 0) {
+        ret = 1;
+        break;
+      }
+    }
+
+    char ev_rate[16] = "-";
+    if (!bench->xfer_isr) {
+      snprintf(ev_rate, sizeof(ev_rate), "%.0f", (double) stats.events / bus_s);
+    }
+    printf("%-11s %10u %10.3f %10.3f %10s %9u %10.0f %10.2f\n", bench->name, (unsigned) bytes, bus_s * 1e3,
+           (double) bytes / 1e6 / bus_s, ev_rate, (unsigned) stats.transfers, median(cyc_xfer, BENCH_RUNS),
+           median(host_mbps, BENCH_RUNS));
+  }
+
+#if CFG_TUD_EDPT_STATS
+  print_edpt_stats();
+#endif
+
+  return ret;
+}
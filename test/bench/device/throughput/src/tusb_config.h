@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef TUSB_CONFIG_H_
+#define TUSB_CONFIG_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//--------------------------------------------------------------------+
+// Simulated Port Configuration
+//--------------------------------------------------------------------+
+
+// dcd_sim is not an MCU: describe the virtual controller here
+#define TUP_DCD_ENDPOINT_MAX    16
+#define TUP_RHPORT_HIGHSPEED    1
+
+#define BOARD_TUD_RHPORT        0
+
+//--------------------------------------------------------------------
+// Common Configuration
+//--------------------------------------------------------------------
+
+// defined by compiler flags for flexibility
+#ifndef CFG_TUSB_MCU
+#error CFG_TUSB_MCU must be defined
+#endif
+
+#ifndef CFG_TUSB_OS
+#define CFG_TUSB_OS           OPT_OS_NONE
+#endif
+
+#ifndef CFG_TUSB_DEBUG
+#define CFG_TUSB_DEBUG        0
+#endif
+
+// Enable Device stack
+#define CFG_TUD_ENABLED       1
+
+// High speed capable, actual speed is selected by the virtual host at bus reset
+#define CFG_TUD_MAX_SPEED     OPT_MODE_HIGH_SPEED
+
+#define CFG_TUSB_MEM_SECTION
+#define CFG_TUSB_MEM_ALIGN    __attribute__ ((aligned(4)))
+
+//--------------------------------------------------------------------
+// DEVICE CONFIGURATION
+//--------------------------------------------------------------------
+
+#define CFG_TUD_ENDPOINT0_SIZE    64
+#define CFG_TUD_TASK_QUEUE_SZ     64
+
+//------------- CLASS -------------//
+#define CFG_TUD_CDC              1
+#define CFG_TUD_MSC              1
+#define CFG_TUD_NCM              1
+#define CFG_TUD_VENDOR           1
+#define CFG_TUD_AUDIO            1
+
+// CDC FIFO size of TX and RX
+#define CFG_TUD_CDC_RX_BUFSIZE   4096
+#define CFG_TUD_CDC_TX_BUFSIZE   4096
+
+// CDC Endpoint transfer buffer size, larger is faster
+#define CFG_TUD_CDC_RX_EPSIZE    512
+#define CFG_TUD_CDC_TX_EPSIZE    2048
+
+// MSC Buffer size of Device Mass storage
+#define CFG_TUD_MSC_EP_BUFSIZE   4096
+
+// Overlap disk IO with USB transfer
+#ifndef CFG_TUD_MSC_EP_BUFCOUNT
+#define CFG_TUD_MSC_EP_BUFCOUNT  2
+#endif
+
+// USB Attached SCSI on MSC alternate 1
+#define CFG_TUD_MSC_UAS          1
+
+// Vendor FIFO size of TX and RX
+#define CFG_TUD_VENDOR_RX_BUFSIZE 4096
+#define CFG_TUD_VENDOR_TX_BUFSIZE 4096
+#define CFG_TUD_VENDOR_RX_EPSIZE  512
+#define CFG_TUD_VENDOR_TX_EPSIZE  2048
+
+// NCM
+#define CFG_TUD_NCM_OUT_NTB_MAX_SIZE  3200
+#define CFG_TUD_NCM_IN_NTB_MAX_SIZE   3200
+#define CFG_TUD_NCM_OUT_NTB_N         2
+#define CFG_TUD_NCM_IN_NTB_N          2
+#define CFG_TUD_NCM_RECV_BATCH        1
+#define CFG_TUD_NCM_RECV_LEND         1
+
+//------------- AUDIO -------------//
+#define CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE              48000
+#define CFG_TUD_AUDIO_ENABLE_EP_IN                    1
+#define CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX    2
+#define CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX            4
+
+// Largest packet is the full speed one (1 ms worth of samples)
+#define CFG_TUD_AUDIO_EP_IN_FLOW_CONTROL              1
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX             TUD_AUDIO_EP_SIZE(0, CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX)
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SW_BUF_SZ          (8 * CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX)
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif /* TUSB_CONFIG_H_ */
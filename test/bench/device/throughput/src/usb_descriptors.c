@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "tusb.h"
+#include "usb_descriptors.h"
+
+//--------------------------------------------------------------------+
+// Device Descriptors
+//--------------------------------------------------------------------+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+
+  // Use Interface Association Descriptor (IAD) for CDC, NCM and Audio
+  .bDeviceClass       = TUSB_CLASS_MISC,
+  .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4F00,
+  .bcdDevice          = 0x0100,
+
+  .iManufacturer      = STRID_MANUFACTURER,
+  .iProduct           = STRID_PRODUCT,
+  .iSerialNumber      = STRID_SERIAL,
+
+  .bNumConfigurations = 0x01
+};
+
+uint8_t const *tud_descriptor_device_cb(void) {
+  return (uint8_t const *) &desc_device;
+}
+
+//--------------------------------------------------------------------+
+// Configuration Descriptor
+//--------------------------------------------------------------------+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_UAS_DESC_LEN + TUD_CDC_NCM_DESC_LEN + \
+                          TUD_VENDOR_DESC_LEN + TUD_AUDIO20_MIC_FOUR_CH_DESC_LEN)
+
+#define CONFIG_DESCRIPTOR(_bulk_size, _audio_size) \
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100), \
+  TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 0, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, _bulk_size), \
+  TUD_MSC_UAS_DESCRIPTOR(ITF_NUM_MSC, 0, EPNUM_MSC_OUT, EPNUM_MSC_IN, EPNUM_UAS_CMD, EPNUM_UAS_STATUS, \
+                         EPNUM_UAS_DATA_IN, EPNUM_UAS_DATA_OUT, _bulk_size), \
+  TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, STRID_MAC, EPNUM_NCM_NOTIF, 64, EPNUM_NCM_OUT, EPNUM_NCM_IN, _bulk_size, \
+                         CFG_TUD_NET_MTU, 10, 0), \
+  TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, 0, EPNUM_VENDOR_OUT, EPNUM_VENDOR_IN, _bulk_size), \
+  TUD_AUDIO20_MIC_FOUR_CH_DESCRIPTOR(ITF_NUM_AUDIO_CONTROL, 0, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX, \
+                                     CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX * 8, EPNUM_AUDIO_IN, _audio_size)
+
+static uint8_t const desc_fs_configuration[] = {
+  CONFIG_DESCRIPTOR(64, AUDIO_EP_SIZE_FS)
+};
+
+static uint8_t const desc_hs_configuration[] = {
+  CONFIG_DESCRIPTOR(512, AUDIO_EP_SIZE_HS)
+};
+
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index) {
+  (void) index;
+  return (tud_speed_get() == TUSB_SPEED_HIGH) ? desc_hs_configuration : desc_fs_configuration;
+}
+
+//--------------------------------------------------------------------+
+// String Descriptors
+//--------------------------------------------------------------------+
+static char const *string_desc_arr[] = {
+  (const char[]) {0x09, 0x04}, // 0: is supported language is English (0x0409)
+  "TinyUSB",                   // 1: Manufacturer
+  "TinyUSB Benchmark",         // 2: Product
+  "123456",                    // 3: Serials
+  "020000000001",              // 4: NCM MAC address
+};
+
+static uint16_t _desc_str[32 + 1];
+
+uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+  (void) langid;
+  size_t chr_count;
+
+  if (index == STRID_LANGID) {
+    memcpy(&_desc_str[1], string_desc_arr[0], 2);
+    chr_count = 1;
+  } else {
+    if (!(index < TU_ARRAY_SIZE(string_desc_arr))) {
+      return NULL;
+    }
+
+    const char *str = string_desc_arr[index];
+    chr_count = tu_min32(strlen(str), 32);
+    for (size_t i = 0; i < chr_count; i++) {
+      _desc_str[1 + i] = (uint16_t) str[i];
+    }
+  }
+
+  // first byte is length (including header), second byte is string type
+  _desc_str[0] = (uint16_t) ((TUSB_DESC_STRING << 8) | (2 * chr_count + 2));
+  return _desc_str;
+}
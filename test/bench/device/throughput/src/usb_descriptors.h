@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 Ha Thach (tinyusb.org)
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef USB_DESCRIPTORS_H_
+#define USB_DESCRIPTORS_H_
+
+enum {
+  ITF_NUM_CDC = 0,
+  ITF_NUM_CDC_DATA,
+  ITF_NUM_MSC,
+  ITF_NUM_NCM,
+  ITF_NUM_NCM_DATA,
+  ITF_NUM_VENDOR,
+  ITF_NUM_AUDIO_CONTROL,
+  ITF_NUM_AUDIO_STREAMING,
+  ITF_NUM_TOTAL
+};
+
+enum {
+  STRID_LANGID = 0,
+  STRID_MANUFACTURER,
+  STRID_PRODUCT,
+  STRID_SERIAL,
+  STRID_MAC,
+};
+
+#define EPNUM_CDC_NOTIF   0x81
+#define EPNUM_CDC_OUT     0x02
+#define EPNUM_CDC_IN      0x82
+
+#define EPNUM_MSC_OUT     0x03
+#define EPNUM_MSC_IN      0x83
+
+#define EPNUM_NCM_NOTIF   0x84
+#define EPNUM_NCM_OUT     0x05
+#define EPNUM_NCM_IN      0x85
+
+#define EPNUM_VENDOR_OUT  0x06
+#define EPNUM_VENDOR_IN   0x86
+
+#define EPNUM_AUDIO_IN    0x87
+
+// MSC alternate 1: USB Attached SCSI pipes
+#define EPNUM_UAS_CMD      0x08
+#define EPNUM_UAS_STATUS   0x88
+#define EPNUM_UAS_DATA_IN  0x89
+#define EPNUM_UAS_DATA_OUT 0x09
+
+#define AUDIO_EP_SIZE_FS  TUD_AUDIO_EP_SIZE(0, CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX)
+#define AUDIO_EP_SIZE_HS  TUD_AUDIO_EP_SIZE(1, CFG_TUD_AUDIO_FUNC_1_SAMPLE_RATE, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX)
+
+#endif
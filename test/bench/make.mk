@@ -0,0 +1,83 @@
+# ---------------------------------------
+# Common make definition for all benchmarks
+# ---------------------------------------
+
+#-------------- TOP and EXAMPLE_PATH ------------
+
+# Set TOP to be the path to get from the current directory (where make was
+# invoked) to the top of the tree. $(lastword $(MAKEFILE_LIST)) returns
+# the name of this makefile relative to where make was invoked.
+THIS_MAKEFILE := $(lastword $(MAKEFILE_LIST))
+
+# strip off /test/bench/make.mk to get for example ../../..
+# and Set TOP to an absolute path
+TOP = $(abspath $(subst make.mk,../..,$(THIS_MAKEFILE)))
+
+# Set EXAMPLE_PATH to the relative path from TOP to the current directory, ie test/bench/device/throughput
+EXAMPLE_PATH = $(subst $(TOP)/,,$(abspath .))
+
+# Build directory
+BUILD := _build
+PROJECT := $(notdir $(CURDIR))
+
+#-------------- Benchmark compiler  ------------
+
+# Benchmarks run natively on the build machine, default to gcc
+ifeq ($(origin CC),default)
+  CC = gcc
+endif
+SIZE = size
+MKDIR = mkdir
+RM = rm
+
+#-------------- Source files and compiler flags --------------
+INC += $(TOP)/test/bench
+
+# Compiler Flags
+CFLAGS += \
+  -ggdb \
+  -fdata-sections \
+  -ffunction-sections \
+  -fno-strict-aliasing \
+  -Wall \
+  -Wextra \
+  -Werror \
+  -Wfatal-errors \
+  -Wdouble-promotion \
+  -Wstrict-prototypes \
+  -Wstrict-overflow \
+  -Werror-implicit-function-declaration \
+  -Wfloat-equal \
+  -Wundef \
+  -Wshadow \
+  -Wwrite-strings \
+  -Wsign-compare \
+  -Wmissing-format-attribute \
+  -Wunreachable-code \
+  -Wcast-align \
+  -Wcast-qual \
+  -Wnull-dereference \
+  -Wuninitialized \
+  -Wunused \
+  -Wredundant-decls \
+  -std=gnu11
+
+# Simulated controller is not an MCU, port attributes are described in tusb_config.h
+CFLAGS += \
+  -DCFG_TUSB_MCU=OPT_MCU_NONE \
+  -D_BENCH
+
+# Debugging/Optimization: benchmark the same optimization level as firmware builds by default
+ifeq ($(DEBUG), 1)
+  CFLAGS += -Og
+else
+  CFLAGS += -O2
+endif
+
+# Extra stack options to compare, e.g make CFG="-DCFG_TUD_EDPT_STREAM_ZERO_COPY=1" clean all run
+CFLAGS += $(CFG)
+
+# Log level is mapped to TUSB DEBUG option
+ifneq ($(LOG),)
+  CFLAGS += -DCFG_TUSB_DEBUG=$(LOG)
+endif
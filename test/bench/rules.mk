@@ -0,0 +1,86 @@
+# ---------------------------------------
+# Common make rules for all benchmarks
+# ---------------------------------------
+
+# Set all as default goal
+.DEFAULT_GOAL := all
+
+# TinyUSB Stack source
+SRC_C += \
+	src/tusb.c \
+	src/common/tusb_fifo.c \
+	src/device/usbd.c \
+	src/class/audio/audio_convert.c \
+	src/class/audio/audio_feedback.c \
+	src/class/audio/audio_device.c \
+	src/class/cdc/cdc_device.c \
+	src/class/msc/msc_device.c \
+	src/class/net/ncm_device.c \
+	src/class/vendor/vendor_device.c
+
+# Simulated device controller driven by a virtual host
+SRC_C += test/bench/dcd_sim.c
+
+# TinyUSB stack include
+INC += $(TOP)/src
+
+CFLAGS += $(addprefix -I,$(INC))
+
+LDFLAGS += -Wl,-Map=$@.map -Wl,-gc-sections
+
+OBJ += $(addprefix $(BUILD)/obj/, $(SRC_C:.c=.o))
+
+# Verbose mode
+ifeq ("$(V)","1")
+$(info CFLAGS  $(CFLAGS) ) $(info )
+$(info LDFLAGS $(LDFLAGS)) $(info )
+endif
+
+# ---------------------------------------
+# Rules
+# ---------------------------------------
+
+all: $(BUILD)/$(PROJECT)
+
+OBJ_DIRS = $(sort $(dir $(OBJ)))
+$(OBJ): | $(OBJ_DIRS)
+$(OBJ_DIRS):
+	@$(MKDIR) -p $@
+
+$(BUILD)/$(PROJECT): $(OBJ)
+	@echo LINK $@
+	@$(CC) -o $@ $^ $(LIBS) $(LDFLAGS)
+
+# We set vpath to point to the top of the tree so that the source files
+# can be located. By following this scheme, it allows a single build rule
+# to be used to compile all .c files.
+vpath %.c . $(TOP)
+$(BUILD)/obj/%.o: %.c
+	@echo CC $(notdir $@)
+	@$(CC) $(CFLAGS) -c -MD -o $@ $<
+
+# Run benchmark at full and high speed
+.PHONY: run
+run: $(BUILD)/$(PROJECT)
+	./$(BUILD)/$(PROJECT) full
+	./$(BUILD)/$(PROJECT) high
+
+.PHONY: clean
+clean:
+	$(RM) -rf $(BUILD)
+
+# No external dependencies, target exists for parity with fuzz harnesses
+.PHONY: get-deps
+get-deps:
+
+size: $(BUILD)/$(PROJECT)
+	-@echo ''
+	@$(SIZE) $<
+	-@echo ''
+
+# Print out the value of a make variable.
+# https://stackoverflow.com/questions/16467718/how-to-print-out-a-variable-in-makefile
+print-%:
+	@echo $* = $($*)
+
+-include $(OBJ:.o=.d)
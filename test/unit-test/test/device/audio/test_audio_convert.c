@@ -0,0 +1,347 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "audio_convert.h"
+TEST_SOURCE_FILE("audio_convert.c")
+
+// Conversion stage is built on host with the scalar and word-at-a-time kernels, which are the reference for the
+// Helium/DSP ones
+
+void setUp(void) {}
+void tearDown(void) {}
+
+enum { FMT_COUNT = AUDIO_SAMPLE_FORMAT_COUNT };
+
+// Q31 test pattern: full scale, sign boundaries and all bits set in the low bytes
+static const int32_t q31_pattern[] = {
+  0x12345678, -0x12345678, INT32_MAX, INT32_MIN, 0, -1, 0x00FFFFFF, -0x00FFFF01, 0x40000000, 0x7FFF0000, -0x10000,
+};
+#define PATTERN_LEN TU_ARRAY_SIZE(q31_pattern)
+
+static void layout_set(audio_layout_t* layout, uint8_t format, uint8_t channels, bool planar) {
+  layout->format   = format;
+  layout->channels = channels;
+  layout->planar   = planar;
+}
+
+void test_sample_size(void) {
+  TEST_ASSERT_EQUAL(2, audio_sample_size(AUDIO_SAMPLE_FORMAT_S16));
+  TEST_ASSERT_EQUAL(3, audio_sample_size(AUDIO_SAMPLE_FORMAT_S24));
+  TEST_ASSERT_EQUAL(4, audio_sample_size(AUDIO_SAMPLE_FORMAT_S24_32));
+  TEST_ASSERT_EQUAL(4, audio_sample_size(AUDIO_SAMPLE_FORMAT_S32));
+  TEST_ASSERT_EQUAL(4, audio_sample_size(AUDIO_SAMPLE_FORMAT_F32));
+  TEST_ASSERT_EQUAL(0, audio_sample_size(FMT_COUNT));
+
+  audio_layout_t layout;
+  layout_set(&layout, AUDIO_SAMPLE_FORMAT_S24, 8, false);
+  TEST_ASSERT_EQUAL(24, audio_frame_size(&layout));
+}
+
+void test_convert_s16_to_s32(void) {
+  // odd count exercises word path and tail
+  int16_t const src[5] = {0x1234, -1, INT16_MIN, INT16_MAX, -0x1234};
+  int32_t dst[5];
+  void const* s[1] = {src};
+  void* d[1] = {dst};
+  audio_layout_t sl, dl;
+  layout_set(&sl, AUDIO_SAMPLE_FORMAT_S16, 1, false);
+  layout_set(&dl, AUDIO_SAMPLE_FORMAT_S32, 1, false);
+
+  audio_convert(&dl, d, 0, &sl, s, 0, 5);
+  TEST_ASSERT_EQUAL_HEX32(0x12340000, dst[0]);
+  TEST_ASSERT_EQUAL_HEX32(0xFFFF0000, dst[1]);
+  TEST_ASSERT_EQUAL_HEX32(0x80000000, dst[2]);
+  TEST_ASSERT_EQUAL_HEX32(0x7FFF0000, dst[3]);
+  TEST_ASSERT_EQUAL_HEX32((uint32_t) -0x12340000, dst[4]);
+
+  // narrowing truncates
+  int16_t back[5];
+  dst[0] |= 0xFFFF;
+  s[0] = dst;
+  d[0] = back;
+  audio_convert(&sl, d, 0, &dl, s, 0, 5);
+  TEST_ASSERT_EQUAL_INT16_ARRAY(src, back, 5);
+}
+
+void test_convert_s24_packed(void) {
+  // 7 samples: one 4-sample word group and 3 in tail
+  uint8_t const src[21] = {
+    0x56, 0x34, 0x12, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F,
+    0x01, 0x02, 0x03, 0xAA, 0xBB, 0xCC, 0x00, 0x00, 0x00
+  };
+  int32_t const expected[7] = {
+    0x12345600, (int32_t) 0xFFFFFF00, (int32_t) 0x80000000, 0x7FFFFF00, 0x03020100, (int32_t) 0xCCBBAA00, 0
+  };
+  int32_t dst[7];
+  void const* s[1] = {src};
+  void* d[1] = {dst};
+  audio_layout_t sl, dl;
+  layout_set(&sl, AUDIO_SAMPLE_FORMAT_S24, 7, false);
+  layout_set(&dl, AUDIO_SAMPLE_FORMAT_S32, 7, false);
+
+  audio_convert(&dl, d, 0, &sl, s, 0, 1);
+  TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, dst, 7);
+
+  uint8_t back[21];
+  s[0] = dst;
+  d[0] = back;
+  audio_convert(&sl, d, 0, &dl, s, 0, 1);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(src, back, 21);
+}
+
+void test_convert_s24_in_32(void) {
+  int32_t const src[3] = {(int32_t) 0x80000100, 0x7FFFFFFF, 0x00000200};
+  int32_t dst[3];
+  void const* s[1] = {src};
+  void* d[1] = {dst};
+  audio_layout_t sl, dl;
+  layout_set(&sl, AUDIO_SAMPLE_FORMAT_S32, 1, false);
+  layout_set(&dl, AUDIO_SAMPLE_FORMAT_S24_32, 1, false);
+
+  // LSB justified, sign extended
+  audio_convert(&dl, d, 0, &sl, s, 0, 3);
+  TEST_ASSERT_EQUAL_HEX32(0xFF800001, dst[0]);
+  TEST_ASSERT_EQUAL_HEX32(0x007FFFFF, dst[1]);
+  TEST_ASSERT_EQUAL_HEX32(0x00000002, dst[2]);
+
+  int32_t back[3];
+  s[0] = dst;
+  d[0] = back;
+  audio_convert(&sl, d, 0, &dl, s, 0, 3);
+  TEST_ASSERT_EQUAL_HEX32(0x80000100, back[0]);
+  TEST_ASSERT_EQUAL_HEX32(0x7FFFFF00, back[1]);
+  TEST_ASSERT_EQUAL_HEX32(0x00000200, back[2]);
+}
+
+void test_convert_float(void) {
+  float const src[6] = {0.5f, -0.5f, 1.5f, -1.0f, -2.0f, 0.0f};
+  int32_t dst[6];
+  void const* s[1] = {src};
+  void* d[1] = {dst};
+  audio_layout_t sl, dl;
+  layout_set(&sl, AUDIO_SAMPLE_FORMAT_F32, 2, false);
+  layout_set(&dl, AUDIO_SAMPLE_FORMAT_S32, 2, false);
+
+  // clipped to full scale
+  audio_convert(&dl, d, 0, &sl, s, 0, 3);
+  TEST_ASSERT_EQUAL_HEX32(0x40000000, dst[0]);
+  TEST_ASSERT_EQUAL_HEX32(0xC0000000, dst[1]);
+  TEST_ASSERT_EQUAL_HEX32(0x7FFFFFFF, dst[2]);
+  TEST_ASSERT_EQUAL_HEX32(0x80000000, dst[3]);
+  TEST_ASSERT_EQUAL_HEX32(0x80000000, dst[4]);
+  TEST_ASSERT_EQUAL_HEX32(0, dst[5]);
+
+  // S16 to float
+  int16_t const s16[2] = {0x4000, INT16_MIN};
+  float f[2];
+  s[0] = s16;
+  d[0] = f;
+  layout_set(&sl, AUDIO_SAMPLE_FORMAT_S16, 2, false);
+  layout_set(&dl, AUDIO_SAMPLE_FORMAT_F32, 2, false);
+  audio_convert(&dl, d, 0, &sl, s, 0, 1);
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, f[0]);
+  TEST_ASSERT_EQUAL_FLOAT(-1.0f, f[1]);
+}
+
+void test_convert_planar_interleaved(void) {
+  // 3 channels x 5 frames interleaved S16, converted at frame offset into planar S24_32 and back
+  int16_t src[15];
+  for (int16_t i = 0; i < 15; i++) {
+    src[i] = (int16_t) ((i % 3) * 1000 - i);
+  }
+
+  int32_t plane[3][8];
+  memset(plane, 0x55, sizeof(plane));
+  void const* s[1] = {src};
+  void* d[3] = {plane[0], plane[1], plane[2]};
+  audio_layout_t il, pl;
+  layout_set(&il, AUDIO_SAMPLE_FORMAT_S16, 3, false);
+  layout_set(&pl, AUDIO_SAMPLE_FORMAT_S24_32, 3, true);
+
+  audio_convert(&pl, d, 2, &il, s, 1, 4);
+  for (uint8_t ch = 0; ch < 3; ch++) {
+    TEST_ASSERT_EQUAL_HEX32(0x55555555, plane[ch][1]);
+    for (uint8_t f = 0; f < 4; f++) {
+      TEST_ASSERT_EQUAL_INT32(src[(f + 1) * 3 + ch] * 256, plane[ch][2 + f]);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x55555555, plane[ch][6]);
+  }
+
+  int16_t back[12];
+  void const* ps[3] = {plane[0], plane[1], plane[2]};
+  void* b[1] = {back};
+  audio_convert(&il, b, 0, &pl, ps, 2, 4);
+  TEST_ASSERT_EQUAL_INT16_ARRAY(src + 3, back, 12);
+}
+
+// Word-at-a-time (contiguous) kernels must match the scalar (strided) ones for all format pairs
+void test_convert_contiguous_matches_strided(void) {
+  enum { CH = 2, FRAMES = 40 }; // more than a block
+  int32_t q31[CH * FRAMES];
+  for (uint32_t i = 0; i < CH * FRAMES; i++) {
+    q31[i] = (int32_t) ((uint32_t) q31_pattern[i % PATTERN_LEN] + i * 0x01010101u);
+  }
+
+  for (uint8_t sf = 0; sf < FMT_COUNT; sf++) {
+    // source in format sf
+    uint8_t src[CH * FRAMES * 4];
+    void const* q[1] = {q31};
+    void* s[1] = {src};
+    audio_layout_t ql, sl;
+    layout_set(&ql, AUDIO_SAMPLE_FORMAT_S32, CH, false);
+    layout_set(&sl, sf, CH, false);
+    audio_convert(&sl, s, 0, &ql, q, 0, FRAMES);
+
+    for (uint8_t df = 0; df < FMT_COUNT; df++) {
+      uint8_t contiguous[CH * FRAMES * 4];
+      uint8_t strided[CH * FRAMES * 4];
+      uint8_t plane[CH][FRAMES * 4];
+      audio_layout_t dl, pl;
+      layout_set(&dl, df, CH, false);
+      layout_set(&pl, df, CH, true);
+
+      void const* cs[1] = {src};
+      void* cd[1] = {contiguous};
+      audio_convert(&dl, cd, 0, &sl, cs, 0, FRAMES);
+
+      void* pd[CH] = {plane[0], plane[1]};
+      void const* ps[CH] = {plane[0], plane[1]};
+      void* sd[1] = {strided};
+      audio_convert(&pl, pd, 0, &sl, cs, 0, FRAMES);
+      audio_convert(&dl, sd, 0, &pl, ps, 0, FRAMES);
+
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(strided, contiguous, CH * FRAMES * audio_sample_size(df));
+    }
+  }
+}
+
+void test_mix(void) {
+  int16_t const a[4] = {0x1000, 0x7000, -0x7000, 0x0100};
+  int16_t const b[4] = {0x1000, 0x7000, -0x7000, -0x0100};
+  int16_t dst[4];
+  void const* sa[1] = {a};
+  void const* sb[1] = {b};
+  void const* const* src[2] = {sa, sb};
+  void* d[1] = {dst};
+  audio_layout_t l;
+  layout_set(&l, AUDIO_SAMPLE_FORMAT_S16, 1, false);
+
+  // unity gain saturates
+  audio_mix(&l, d, 0, &l, src, NULL, 2, 0, 4);
+  TEST_ASSERT_EQUAL_HEX16(0x2000, dst[0]);
+  TEST_ASSERT_EQUAL_HEX16(0x7FFF, dst[1]);
+  TEST_ASSERT_EQUAL_HEX16(0x8000, dst[2]);
+  TEST_ASSERT_EQUAL_HEX16(0x0000, dst[3]);
+
+  // half gain each
+  uint16_t const gain[2] = {AUDIO_GAIN_UNITY / 2, AUDIO_GAIN_UNITY / 2};
+  audio_mix(&l, d, 0, &l, src, gain, 2, 0, 4);
+  TEST_ASSERT_EQUAL_HEX16(0x1000, dst[0]);
+  TEST_ASSERT_EQUAL_HEX16(0x7000, dst[1]);
+  TEST_ASSERT_EQUAL_HEX16((uint16_t) -0x7000, dst[2]);
+
+  // gain on single stream, max gain doubles
+  uint16_t const max_gain = 0xFFFF;
+  audio_mix(&l, d, 0, &l, src, &max_gain, 1, 0, 1);
+  TEST_ASSERT_EQUAL_HEX16(0x1FFF, dst[0]);
+}
+
+//--------------------------------------------------------------------+
+// FIFO: 20 bytes is not a multiple of S24 stereo frame (6 bytes) so frames and samples are split by the wrap
+//--------------------------------------------------------------------+
+static uint8_t _ff_buf[20];
+static tu_fifo_t _ff;
+
+static void s24_frames(uint8_t* buf, uint8_t first, uint8_t n_frames) {
+  for (uint8_t i = 0; i < n_frames * 6; i++) {
+    buf[i] = (uint8_t) (first + i);
+  }
+}
+
+void test_fifo_read_convert_wrap(void) {
+  tu_fifo_config(&_ff, _ff_buf, sizeof(_ff_buf), false);
+  audio_layout_t ffl, pl;
+  layout_set(&ffl, AUDIO_SAMPLE_FORMAT_S24, 2, false);
+  layout_set(&pl, AUDIO_SAMPLE_FORMAT_S32, 2, true);
+
+  // move indices to 12
+  uint8_t raw[18];
+  s24_frames(raw, 0, 2);
+  TEST_ASSERT_EQUAL(12, tu_fifo_write_n(&_ff, raw, 12));
+  int32_t plane[2][4];
+  void* d[2] = {plane[0], plane[1]};
+  TEST_ASSERT_EQUAL(2, audio_fifo_read_convert(&_ff, &ffl, &pl, d, 4));
+
+  // frame 0 linear, frame 1 split in left sample, frame 2 wrapped. Partial frame is not read
+  s24_frames(raw, 0x40, 3);
+  TEST_ASSERT_EQUAL(18, tu_fifo_write_n(&_ff, raw, 18));
+  TEST_ASSERT_EQUAL(3, audio_fifo_read_convert(&_ff, &ffl, &pl, d, 4));
+  for (uint8_t f = 0; f < 3; f++) {
+    for (uint8_t ch = 0; ch < 2; ch++) {
+      uint8_t const* p = raw + f * 6 + ch * 3;
+      uint32_t const expected = ((uint32_t) p[2] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[0] << 8);
+      TEST_ASSERT_EQUAL_HEX32(expected, plane[ch][f]);
+    }
+  }
+  TEST_ASSERT_EQUAL(0, tu_fifo_count(&_ff));
+
+  // format must be set and match
+  audio_layout_t none = {0};
+  TEST_ASSERT_EQUAL(0, audio_fifo_read_convert(&_ff, &none, &pl, d, 4));
+}
+
+void test_fifo_write_mix_wrap(void) {
+  tu_fifo_config(&_ff, _ff_buf, sizeof(_ff_buf), false);
+  audio_layout_t ffl, pl;
+  layout_set(&ffl, AUDIO_SAMPLE_FORMAT_S24, 2, false);
+  layout_set(&pl, AUDIO_SAMPLE_FORMAT_S32, 2, true);
+
+  // move indices to 14: frame 1 is split in right sample
+  uint8_t raw[18];
+  TEST_ASSERT_EQUAL(14, tu_fifo_write_n(&_ff, raw, 14));
+  TEST_ASSERT_EQUAL(14, tu_fifo_read_n(&_ff, raw, 14));
+
+  int32_t left[4] = {0x01020300, 0x11121300, 0x21222300, 0x31323300};
+  int32_t right[4] = {0x41424300, 0x51525300, 0x61626300, 0x71727300};
+  void const* stream[2] = {left, right};
+  void const* const* src[1] = {stream};
+
+  // only 3 whole frames fit
+  TEST_ASSERT_EQUAL(3, audio_fifo_write_mix(&_ff, &ffl, &pl, src, NULL, 1, 4));
+  TEST_ASSERT_EQUAL(18, tu_fifo_read_n(&_ff, raw, 18));
+  for (uint8_t f = 0; f < 3; f++) {
+    uint8_t const* p = raw + f * 6;
+    TEST_ASSERT_EQUAL_HEX32((uint32_t) left[f], tu_u32(p[2], p[1], p[0], 0));
+    TEST_ASSERT_EQUAL_HEX32((uint32_t) right[f], tu_u32(p[5], p[4], p[3], 0));
+  }
+
+  // fifo full
+  TEST_ASSERT_EQUAL(18, tu_fifo_write_n(&_ff, raw, 18));
+  TEST_ASSERT_EQUAL(0, audio_fifo_write_mix(&_ff, &ffl, &pl, src, NULL, 1, 4));
+}
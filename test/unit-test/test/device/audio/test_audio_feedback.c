@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "audio_feedback.h"
+TEST_SOURCE_FILE("audio_feedback.c")
+
+// Controller is pure fixed point math, tested standalone and in a simulated host/FIFO loop
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// 48 kHz, 16-bit stereo
+#define FRAME_SIZE 4u
+#define NOMINAL_FS (48u << 16)
+#define MIN_FS     (47u << 16)
+#define MAX_FS     (49u << 16)
+#define SETPOINT   (4u * 48u * FRAME_SIZE) // 4 ms
+
+// controller tuning in audio_feedback.c
+#define FB_PI_LOCK_FRAMES 256u
+#define FB_PI_RATE_SHIFT  3
+
+static audio_feedback_pi_t pi;
+
+// Host accumulates feedback into packet sizes and applies it with a delay, sink consumes at drifted rate.
+typedef struct {
+  uint32_t fb_hist[32];
+  uint32_t acc;
+  int64_t  level_q16;
+} loop_t;
+
+// Return max level deviation from set-point over the last second
+static uint32_t run_loop(loop_t* loop, int32_t ppm, uint32_t frames_per_ms, uint32_t ms, uint8_t fb_delay) {
+  uint32_t const n = ms * frames_per_ms;
+  int64_t const consume_q16 = ((int64_t) 48000 * (1000000 + ppm) * FRAME_SIZE << 16) / 1000000 / (1000 * frames_per_ms);
+  uint32_t max_dev = 0;
+
+  for (uint32_t t = 0; t < n; t++) {
+    loop->acc += loop->fb_hist[(t - fb_delay) % 32];
+    uint32_t const samples = loop->acc >> 16;
+    loop->acc &= 0xFFFF;
+
+    loop->level_q16 += ((int64_t) samples * FRAME_SIZE) << 16;
+    loop->level_q16 -= consume_q16;
+    if (loop->level_q16 < 0) {
+      loop->level_q16 = 0;
+    }
+
+    uint16_t const level = (uint16_t) (loop->level_q16 >> 16);
+    loop->fb_hist[t % 32] = audio_feedback_pi_level_update(&pi, level);
+
+    if (t + 1000 * frames_per_ms >= n) {
+      uint32_t const dev = level > pi.setpoint ? level - pi.setpoint : pi.setpoint - level;
+      max_dev = tu_max32(max_dev, dev);
+    }
+  }
+
+  return max_dev;
+}
+
+static void loop_init(loop_t* loop, uint32_t nominal, uint16_t level) {
+  for (uint32_t i = 0; i < 32; i++) {
+    loop->fb_hist[i] = nominal;
+  }
+  loop->acc = 0;
+  loop->level_q16 = (int64_t) level << 16;
+}
+
+void test_init(void) {
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+  TEST_ASSERT_EQUAL_UINT32(NOMINAL_FS, pi.value);
+  TEST_ASSERT_EQUAL_UINT32(NOMINAL_FS, pi.base);
+  TEST_ASSERT_EQUAL_UINT32(SETPOINT << 16, pi.lvl_avg);
+  TEST_ASSERT_EQUAL(0, pi.hs_shift);
+  TEST_ASSERT_FALSE(pi.locked);
+
+  // at set-point nothing changes
+  TEST_ASSERT_EQUAL_UINT32(NOMINAL_FS, audio_feedback_pi_level_update(&pi, SETPOINT));
+  TEST_ASSERT_EQUAL_INT32(0, pi.integral);
+}
+
+void test_direction(void) {
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+  TEST_ASSERT_TRUE(audio_feedback_pi_level_update(&pi, SETPOINT / 2) > NOMINAL_FS);
+
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+  TEST_ASSERT_TRUE(audio_feedback_pi_level_update(&pi, SETPOINT * 3 / 2) < NOMINAL_FS);
+}
+
+void test_clamp_anti_windup(void) {
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+
+  // Empty FIFO for a long time: clamped at max, integral does not wind up
+  for (uint32_t i = 0; i < 1000; i++) {
+    TEST_ASSERT_TRUE(audio_feedback_pi_level_update(&pi, 0) <= MAX_FS);
+  }
+  TEST_ASSERT_EQUAL_UINT32(MAX_FS, pi.value);
+  int32_t const integral = pi.integral;
+  audio_feedback_pi_level_update(&pi, 0);
+  TEST_ASSERT_EQUAL_INT32(integral, pi.integral);
+
+  // Overfull: clamped at min
+  for (uint32_t i = 0; i < 1000; i++) {
+    TEST_ASSERT_TRUE(audio_feedback_pi_level_update(&pi, SETPOINT * 4) >= MIN_FS);
+  }
+  TEST_ASSERT_EQUAL_UINT32(MIN_FS, pi.value);
+}
+
+void test_lock_unlock(void) {
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+
+  for (uint32_t i = 0; i < FB_PI_LOCK_FRAMES - 1; i++) {
+    audio_feedback_pi_level_update(&pi, SETPOINT + 1);
+  }
+  TEST_ASSERT_FALSE(pi.locked);
+  audio_feedback_pi_level_update(&pi, SETPOINT + 1);
+  TEST_ASSERT_TRUE(pi.locked);
+
+  // big disturbance e.g stream paused, back to acquire
+  for (uint32_t i = 0; i < 100 && pi.locked; i++) {
+    audio_feedback_pi_level_update(&pi, 0);
+  }
+  TEST_ASSERT_FALSE(pi.locked);
+  TEST_ASSERT_EQUAL(0, pi.lock_count);
+}
+
+void test_rate_update(void) {
+  audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+
+  // first measurement replaces nominal
+  uint32_t const measured = NOMINAL_FS + 0x100;
+  TEST_ASSERT_EQUAL_UINT32(measured, audio_feedback_pi_rate_update(&pi, measured));
+  TEST_ASSERT_TRUE(pi.measured);
+
+  // outlier (e.g missed SOF) is dropped
+  TEST_ASSERT_EQUAL_UINT32(measured, audio_feedback_pi_rate_update(&pi, MAX_FS * 2));
+  TEST_ASSERT_EQUAL_UINT32(measured, pi.base);
+
+  // jitter is low-passed
+  audio_feedback_pi_rate_update(&pi, measured + 0x800);
+  TEST_ASSERT_EQUAL_UINT32(measured + (0x800 >> FB_PI_RATE_SHIFT), pi.base);
+}
+
+void test_loop_full_speed(void) {
+  static const int32_t ppm[] = { 0, 100, -300, 1000 };
+
+  for (uint32_t i = 0; i < TU_ARRAY_SIZE(ppm); i++) {
+    loop_t loop;
+    audio_feedback_pi_init(&pi, NOMINAL_FS, MIN_FS, MAX_FS, SETPOINT, false);
+    loop_init(&loop, NOMINAL_FS, 0);
+
+    // start from empty FIFO, settle then level stays within a packet jitter of set-point
+    run_loop(&loop, ppm[i], 1, 10000, 8);
+    TEST_ASSERT_TRUE(pi.locked);
+    TEST_ASSERT_TRUE(run_loop(&loop, ppm[i], 1, 5000, 8) < 8 * FRAME_SIZE);
+  }
+}
+
+void test_loop_high_speed(void) {
+  uint32_t const nominal = 6u << 16;
+  loop_t loop;
+
+  audio_feedback_pi_init(&pi, nominal, 5u << 16, 7u << 16, SETPOINT / 2, true);
+  TEST_ASSERT_EQUAL(3, pi.hs_shift);
+  loop_init(&loop, nominal, SETPOINT / 2);
+
+  run_loop(&loop, -500, 8, 10000, 16);
+  TEST_ASSERT_TRUE(pi.locked);
+  TEST_ASSERT_TRUE(run_loop(&loop, -500, 8, 5000, 16) < 8 * FRAME_SIZE);
+}
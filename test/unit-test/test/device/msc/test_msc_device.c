@@ -32,6 +32,7 @@
 #include "tusb_fifo.h"
 #include "tusb.h"
 #include "usbd.h"
+#include "usbd_pvt.h"
 TEST_SOURCE_FILE("usbd_control.c")
 TEST_SOURCE_FILE("msc_device.c")
 
@@ -53,6 +54,10 @@ enum
 
   EDPT_MSC_OUT  = 0x01,
   EDPT_MSC_IN   = 0x81,
+
+  // UAS data pipes share endpoints with BOT
+  EDPT_UAS_CMD    = 0x02,
+  EDPT_UAS_STATUS = 0x82,
 };
 
 uint8_t const rhport = 0;
@@ -74,6 +79,17 @@ uint8_t const data_desc_configuration[] =
   TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, TUD_OPT_HIGH_SPEED ? 512 : 64),
 };
 
+#define CONFIG_UAS_TOTAL_LEN    (TUD_CONFIG_DESC_LEN + TUD_MSC_UAS_DESC_LEN)
+
+uint8_t const data_desc_configuration_uas[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_UAS_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+
+  // Interface number, string index, BOT EP Out & EP In, UAS command, status, data in, data out, EP size
+  TUD_MSC_UAS_DESCRIPTOR(ITF_NUM_MSC, 0, EDPT_MSC_OUT, EDPT_MSC_IN, EDPT_UAS_CMD, EDPT_UAS_STATUS, EDPT_MSC_IN,
+                         EDPT_MSC_OUT, 512),
+};
+
 tusb_control_request_t const request_set_configuration =
 {
   .bmRequestType = 0x00,
@@ -141,16 +157,61 @@ bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, boo
   return true;
 }
 
+// Storage result of next read10/write10 callbacks, one entry per call. Entries are number of bytes to copy,
+// IO_FULL for the whole buffer, or TUD_MSC_RET_BUSY/ERROR/ASYNC. Calls after the script copy the whole buffer
+#define IO_SCRIPT_MAX  8
+#define IO_FULL        INT32_MAX
+
+typedef struct {
+  uint32_t lba;
+  uint32_t offset;
+  uint8_t* buffer;
+  uint32_t bufsize;
+  bool     out_busy; // WRITE10: next host data is being received while this chunk is written
+} io_call_t;
+
+static int32_t   io_script[IO_SCRIPT_MAX];
+static uint8_t   io_script_count;
+static io_call_t io_calls[32];
+static uint8_t   io_call_count;
+
+static bool edpt_model_busy(uint8_t ep_addr);
+
+static int32_t io_next(uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
+  io_call_t* call = &io_calls[io_call_count++ % TU_ARRAY_SIZE(io_calls)];
+  call->lba = lba;
+  call->offset = offset;
+  call->buffer = (uint8_t*) buffer;
+  call->bufsize = bufsize;
+  call->out_busy = edpt_model_busy(EDPT_MSC_OUT);
+
+  int32_t ret = IO_FULL;
+  if (io_script_count > 0) {
+    ret = io_script[0];
+    io_script_count--;
+    memmove(io_script, io_script + 1, io_script_count * sizeof(int32_t));
+  }
+  return (ret == IO_FULL) ? (int32_t) bufsize : ret;
+}
+
+static void io_script_set(int32_t const* script, uint8_t count) {
+  memcpy(io_script, script, count * sizeof(int32_t));
+  io_script_count = count;
+}
+
 // Callback invoked when received READ10 command.
 // Copy disk's data to buffer (up to bufsize) and return number of copied bytes.
 int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize)
 {
   (void) lun;
 
-  uint8_t const* addr = msc_disk[lba] + offset;
-  memcpy(buffer, addr, bufsize);
+  int32_t const ret = io_next(lba, offset, buffer, bufsize);
+  if (ret > 0) {
+    uint8_t const* addr = msc_disk[lba] + offset;
+    memcpy(buffer, addr, (size_t) ret);
+  }
 
-  return bufsize;
+  return ret;
 }
 
 // Callback invoked when received WRITE10 command.
@@ -159,10 +220,13 @@ int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t*
 {
   (void) lun;
 
-  uint8_t* addr = msc_disk[lba] + offset;
-  memcpy(addr, buffer, bufsize);
+  int32_t const ret = io_next(lba, offset, buffer, bufsize);
+  if (ret > 0) {
+    uint8_t* addr = msc_disk[lba] + offset;
+    memcpy(addr, buffer, (size_t) ret);
+  }
 
-  return bufsize;
+  return ret;
 }
 
 // Callback invoked when received an SCSI command not in built-in list below
@@ -198,6 +262,123 @@ uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid)
   return NULL;
 }
 
+//--------------------------------------------------------------------+
+// DCD model: keep the transfer queued on each endpoint, host side completes it
+//--------------------------------------------------------------------+
+typedef struct {
+  uint8_t* buf;
+  uint16_t len;
+  bool     busy;
+  uint8_t  abort_count;
+  uint8_t  clear_stall_count;
+} edpt_model_t;
+
+static edpt_model_t edpt_model[CFG_TUD_ENDPPOINT_MAX][2];
+static uint8_t edpt_open_count;
+
+static edpt_model_t* model_get(uint8_t ep_addr) {
+  return &edpt_model[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+}
+
+static bool edpt_open_cb(uint8_t rhport_, tusb_desc_endpoint_t const* desc_ep, int cmock_num_calls) {
+  (void) rhport_; (void) desc_ep; (void) cmock_num_calls;
+  edpt_open_count++;
+  return true;
+}
+
+static bool edpt_xfer_cb(uint8_t rhport_, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr,
+                         int cmock_num_calls) {
+  (void) rhport_; (void) is_isr; (void) cmock_num_calls;
+  edpt_model_t* ep = model_get(ep_addr);
+  TEST_ASSERT_FALSE(ep->busy);
+  ep->buf = buffer;
+  ep->len = total_bytes;
+  ep->busy = true;
+  return true;
+}
+
+static void edpt_stall_cb(uint8_t rhport_, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport_; (void) cmock_num_calls;
+  model_get(ep_addr)->busy = false;
+}
+
+static void edpt_clear_stall_cb(uint8_t rhport_, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport_; (void) cmock_num_calls;
+  model_get(ep_addr)->clear_stall_count++;
+}
+
+static void edpt_abort_xfer_cb(uint8_t rhport_, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport_; (void) cmock_num_calls;
+  edpt_model_t* ep = model_get(ep_addr);
+  ep->busy = false;
+  ep->abort_count++;
+}
+
+static bool edpt_model_busy(uint8_t ep_addr) {
+  return model_get(ep_addr)->busy;
+}
+
+static void model_init(uint8_t const* desc_cfg) {
+  tu_memclr(edpt_model, sizeof(edpt_model));
+  edpt_open_count = 0;
+  io_script_count = 0;
+  io_call_count = 0;
+
+  dcd_edpt_open_StubWithCallback(edpt_open_cb);
+  dcd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+  dcd_edpt_stall_StubWithCallback(edpt_stall_cb);
+  dcd_edpt_clear_stall_StubWithCallback(edpt_clear_stall_cb);
+  dcd_edpt_abort_xfer_StubWithCallback(edpt_abort_xfer_cb);
+  dcd_edpt0_status_complete_Ignore();
+  dcd_set_address_Ignore();
+
+  desc_configuration = desc_cfg;
+}
+
+// host sends data to an OUT endpoint with queued transfer
+static void host_out(uint8_t ep_addr, void const* data, uint16_t len) {
+  edpt_model_t* ep = model_get(ep_addr);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_TRUE(len <= ep->len);
+  memcpy(ep->buf, data, len);
+  ep->busy = false;
+  dcd_event_xfer_complete(rhport, ep_addr, len, XFER_RESULT_SUCCESS, false);
+  tud_task();
+}
+
+// host receives data from an IN endpoint with queued transfer, return its length
+static uint16_t host_in(uint8_t ep_addr, void* buf, uint16_t bufsize) {
+  edpt_model_t* ep = model_get(ep_addr);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_TRUE(ep->len <= bufsize);
+  const uint16_t len = ep->len;
+  if (len) {
+    memcpy(buf, ep->buf, len);
+  }
+  ep->busy = false;
+  dcd_event_xfer_complete(rhport, ep_addr, len, XFER_RESULT_SUCCESS, false);
+  tud_task();
+  return len;
+}
+
+// control request without data stage
+static void host_control(tusb_control_request_t const* request) {
+  dcd_event_setup_received(rhport, (uint8_t const*) request, false);
+  tud_task();
+  TEST_ASSERT_EQUAL(0, host_in(EDPT_CTRL_IN, NULL, 0)); // status stage
+}
+
+static void host_set_interface(uint8_t alt) {
+  tusb_control_request_t const request = {
+    .bmRequestType = 0x01,
+    .bRequest      = TUSB_REQ_SET_INTERFACE,
+    .wValue        = alt,
+    .wIndex        = ITF_NUM_MSC,
+    .wLength       = 0
+  };
+  host_control(&request);
+}
+
 void setUp(void)
 {
   dcd_int_disable_Ignore();
@@ -282,3 +463,546 @@ void test_msc(void)
 
   tud_task();
 }
+
+//--------------------------------------------------------------------+
+// READ10/WRITE10 data stage with CFG_TUD_MSC_EP_BUFCOUNT buffers
+//--------------------------------------------------------------------+
+static void bot_enumerate(void) {
+  model_init(data_desc_configuration);
+  host_control(&request_set_configuration);
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy); // CBW
+
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], 0x10 + i, DISK_BLOCK_SIZE);
+  }
+}
+
+static void bot_send_rdwr10(uint32_t tag, uint8_t cmd_code, uint32_t lba, uint16_t count) {
+  msc_cbw_t cbw = {
+    .signature   = MSC_CBW_SIGNATURE,
+    .tag         = tag,
+    .total_bytes = (uint32_t) count * DISK_BLOCK_SIZE,
+    .dir         = (cmd_code == SCSI_CMD_READ_10) ? TUSB_DIR_IN_MASK : 0,
+    .cmd_len     = sizeof(scsi_read10_t),
+  };
+  scsi_read10_t const cmd = {
+    .cmd_code    = cmd_code,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(count)
+  };
+  memcpy(cbw.command, &cmd, sizeof(cmd));
+  host_out(EDPT_MSC_OUT, &cbw, sizeof(cbw));
+}
+
+// receive CSW, return its status
+static uint8_t bot_recv_csw(uint32_t tag, uint32_t residue) {
+  msc_csw_t csw;
+  TEST_ASSERT_EQUAL(sizeof(msc_csw_t), host_in(EDPT_MSC_IN, &csw, sizeof(csw)));
+  TEST_ASSERT_EQUAL_HEX32(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL_HEX32(tag, csw.tag);
+  TEST_ASSERT_EQUAL_UINT32(residue, csw.data_residue);
+  return csw.status;
+}
+
+static void host_clear_halt(uint8_t ep_addr) {
+  tusb_control_request_t const request = {
+    .bmRequestType = 0x02,
+    .bRequest      = TUSB_REQ_CLEAR_FEATURE,
+    .wValue        = TUSB_REQ_FEATURE_EDPT_HALT,
+    .wIndex        = ep_addr,
+    .wLength       = 0
+  };
+  host_control(&request);
+}
+
+static void io_check_call(uint8_t n, uint32_t lba, uint32_t offset, uint32_t bufsize) {
+  TEST_ASSERT_TRUE(n < io_call_count);
+  TEST_ASSERT_EQUAL_UINT32(lba, io_calls[n].lba);
+  TEST_ASSERT_EQUAL_UINT32(offset, io_calls[n].offset);
+  TEST_ASSERT_EQUAL_UINT32(bufsize, io_calls[n].bufsize);
+}
+
+void test_read10_pingpong(void) {
+  bot_enumerate();
+  bot_send_rdwr10(1, SCSI_CMD_READ_10, 2, 4);
+
+  // storage reads ahead into the second buffer while the first one is sent
+  TEST_ASSERT_EQUAL(2, io_call_count);
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_IN)->busy);
+
+  uint8_t* bufs[4];
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t data[DISK_BLOCK_SIZE];
+    bufs[i] = model_get(EDPT_MSC_IN)->buf;
+    TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_MEMORY(msc_disk[2 + i], data, DISK_BLOCK_SIZE);
+    io_check_call(i, 2 + i, 0, DISK_BLOCK_SIZE);
+  }
+  TEST_ASSERT_EQUAL(4, io_call_count);
+
+  // buffers alternate
+  TEST_ASSERT_TRUE(bufs[0] != bufs[1]);
+  TEST_ASSERT_EQUAL_PTR(bufs[0], bufs[2]);
+  TEST_ASSERT_EQUAL_PTR(bufs[1], bufs[3]);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(1, 0));
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy);
+}
+
+void test_write10_pingpong(void) {
+  bot_enumerate();
+  bot_send_rdwr10(2, SCSI_CMD_WRITE_10, 4, 4);
+
+  uint8_t* bufs[4];
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t data[DISK_BLOCK_SIZE];
+    memset(data, 0xA0 + i, sizeof(data));
+    bufs[i] = model_get(EDPT_MSC_OUT)->buf;
+    host_out(EDPT_MSC_OUT, data, sizeof(data));
+    TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[4 + i], DISK_BLOCK_SIZE);
+    io_check_call(i, 4 + i, 0, DISK_BLOCK_SIZE);
+  }
+
+  // next host data is received while previous one is written to storage
+  TEST_ASSERT_TRUE(io_calls[0].out_busy);
+  TEST_ASSERT_TRUE(io_calls[1].out_busy);
+  TEST_ASSERT_TRUE(io_calls[2].out_busy);
+  TEST_ASSERT_TRUE(bufs[0] != bufs[1]);
+  TEST_ASSERT_EQUAL_PTR(bufs[0], bufs[2]);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(2, 0));
+}
+
+void test_read10_partial(void) {
+  bot_enumerate();
+  int32_t const script[] = { 256, 100 };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(3, SCSI_CMD_READ_10, 1, 1);
+
+  // each partial read is sent as is, callback is invoked again for the rest of the block
+  io_check_call(0, 1, 0, DISK_BLOCK_SIZE);
+  io_check_call(1, 1, 256, 256);
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(256, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL(100, host_in(EDPT_MSC_IN, data + 256, sizeof(data) - 256));
+  io_check_call(2, 1, 356, 156);
+  TEST_ASSERT_EQUAL(156, host_in(EDPT_MSC_IN, data + 356, sizeof(data) - 356));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[1], data, DISK_BLOCK_SIZE);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(3, 0));
+}
+
+void test_write10_partial(void) {
+  bot_enumerate();
+  int32_t const script[] = { 200 };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(4, SCSI_CMD_WRITE_10, 3, 1);
+
+  uint8_t data[DISK_BLOCK_SIZE];
+  memset(data, 0x5A, sizeof(data));
+  host_out(EDPT_MSC_OUT, data, sizeof(data));
+
+  // left over is written with adjusted offset
+  TEST_ASSERT_EQUAL(2, io_call_count);
+  io_check_call(0, 3, 0, DISK_BLOCK_SIZE);
+  io_check_call(1, 3, 200, DISK_BLOCK_SIZE - 200);
+  TEST_ASSERT_EQUAL_MEMORY(data, msc_disk[3], DISK_BLOCK_SIZE);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(4, 0));
+}
+
+void test_read10_async(void) {
+  bot_enumerate();
+  int32_t const script[] = { TUD_MSC_RET_ASYNC };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(5, SCSI_CMD_READ_10, 6, 2);
+
+  // nothing is sent or read ahead until storage is done
+  TEST_ASSERT_EQUAL(1, io_call_count);
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_IN)->busy);
+
+  memcpy(io_calls[0].buffer, msc_disk[6], DISK_BLOCK_SIZE);
+  TEST_ASSERT_TRUE(tud_msc_async_io_done(DISK_BLOCK_SIZE, false));
+  tud_task();
+
+  TEST_ASSERT_EQUAL(2, io_call_count);
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[6], data, DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[7], data, DISK_BLOCK_SIZE);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(5, 0));
+}
+
+void test_write10_async(void) {
+  bot_enumerate();
+  int32_t const script[] = { TUD_MSC_RET_ASYNC };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(6, SCSI_CMD_WRITE_10, 8, 2);
+
+  uint8_t data[2][DISK_BLOCK_SIZE];
+  memset(data[0], 0xC0, DISK_BLOCK_SIZE);
+  memset(data[1], 0xC1, DISK_BLOCK_SIZE);
+
+  // second block is received while first one is pending in storage
+  host_out(EDPT_MSC_OUT, data[0], DISK_BLOCK_SIZE);
+  host_out(EDPT_MSC_OUT, data[1], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(1, io_call_count);
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_IN)->busy);
+
+  memcpy(msc_disk[8], io_calls[0].buffer, DISK_BLOCK_SIZE);
+  TEST_ASSERT_TRUE(tud_msc_async_io_done(DISK_BLOCK_SIZE, false));
+  tud_task();
+
+  TEST_ASSERT_EQUAL(2, io_call_count);
+  TEST_ASSERT_EQUAL_MEMORY(data[0], msc_disk[8], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(data[1], msc_disk[9], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(6, 0));
+}
+
+void test_read10_busy_retry(void) {
+  bot_enumerate();
+  int32_t const script[] = { TUD_MSC_RET_BUSY, TUD_MSC_RET_BUSY };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(7, SCSI_CMD_READ_10, 0, 1);
+  tud_task();
+
+  // retried with the same parameters when no transfer is in progress
+  TEST_ASSERT_EQUAL(3, io_call_count);
+  io_check_call(0, 0, 0, DISK_BLOCK_SIZE);
+  io_check_call(1, 0, 0, DISK_BLOCK_SIZE);
+  io_check_call(2, 0, 0, DISK_BLOCK_SIZE);
+
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[0], data, DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(7, 0));
+}
+
+void test_write10_busy_retry(void) {
+  bot_enumerate();
+  int32_t const script[] = { TUD_MSC_RET_BUSY };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(8, SCSI_CMD_WRITE_10, 10, 2);
+
+  uint8_t data[2][DISK_BLOCK_SIZE];
+  memset(data[0], 0xE0, DISK_BLOCK_SIZE);
+  memset(data[1], 0xE1, DISK_BLOCK_SIZE);
+
+  // busy while next block is being received: retry is not deferred but done when it arrives
+  host_out(EDPT_MSC_OUT, data[0], DISK_BLOCK_SIZE);
+  tud_task();
+  TEST_ASSERT_EQUAL(1, io_call_count);
+
+  host_out(EDPT_MSC_OUT, data[1], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(3, io_call_count);
+  io_check_call(1, 10, 0, DISK_BLOCK_SIZE);
+  io_check_call(2, 11, 0, DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(data[0], msc_disk[10], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL_MEMORY(data[1], msc_disk[11], DISK_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_recv_csw(8, 0));
+}
+
+void test_read10_error_in_flight(void) {
+  bot_enumerate();
+  int32_t const script[] = { IO_FULL, TUD_MSC_RET_ERROR };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(9, SCSI_CMD_READ_10, 0, 2);
+
+  // read ahead fails while first block is in flight: it is still sent, then data-in is stalled
+  TEST_ASSERT_EQUAL(2, io_call_count);
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[0], data, DISK_BLOCK_SIZE);
+  TEST_ASSERT_TRUE(usbd_edpt_stalled(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_IN)->busy);
+  TEST_ASSERT_EQUAL(2, io_call_count);
+
+  // status is sent once host clears the stall
+  host_clear_halt(EDPT_MSC_IN);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, bot_recv_csw(9, DISK_BLOCK_SIZE));
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy);
+}
+
+void test_write10_error_in_flight(void) {
+  bot_enumerate();
+  int32_t const script[] = { TUD_MSC_RET_ERROR };
+  io_script_set(script, TU_ARRAY_SIZE(script));
+  bot_send_rdwr10(10, SCSI_CMD_WRITE_10, 0, 2);
+
+  // write fails while second block is being received: data-out is stalled, dropping that transfer
+  uint8_t data[DISK_BLOCK_SIZE] = { 0 };
+  host_out(EDPT_MSC_OUT, data, sizeof(data));
+  TEST_ASSERT_EQUAL(1, io_call_count);
+  TEST_ASSERT_TRUE(io_calls[0].out_busy);
+  TEST_ASSERT_TRUE(usbd_edpt_stalled(rhport, EDPT_MSC_OUT));
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_OUT)->busy);
+
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_FAILED, bot_recv_csw(10, 2 * DISK_BLOCK_SIZE));
+
+  // next CBW once host clears the stall
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_OUT)->busy);
+  host_clear_halt(EDPT_MSC_OUT);
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy);
+}
+
+//--------------------------------------------------------------------+
+// USB Attached SCSI
+//--------------------------------------------------------------------+
+static void uas_enumerate(void) {
+  model_init(data_desc_configuration_uas);
+  host_control(&request_set_configuration);
+
+  // BOT pair and UAS command/status pipes, UAS data pipes share BOT endpoints and are opened once
+  TEST_ASSERT_EQUAL(4, edpt_open_count);
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy); // CBW
+
+  host_set_interface(1);
+}
+
+static void uas_send_cmd(uint16_t tag, uint8_t const* cdb, uint8_t cdb_len) {
+  msc_uas_cmd_iu_t iu = {
+    .iu_id = MSC_UAS_IU_COMMAND,
+    .tag   = tu_htons(tag),
+  };
+  memcpy(iu.cdb, cdb, cdb_len);
+  host_out(EDPT_UAS_CMD, &iu, sizeof(iu));
+}
+
+static void uas_send_read10(uint16_t tag, uint32_t lba, uint16_t count) {
+  scsi_read10_t const cmd = {
+    .cmd_code    = SCSI_CMD_READ_10,
+    .lba         = tu_htonl(lba),
+    .block_count = tu_htons(count)
+  };
+  uas_send_cmd(tag, (uint8_t const*) &cmd, sizeof(cmd));
+}
+
+static void uas_send_tur(uint16_t tag) {
+  uint8_t const cdb[6] = { SCSI_CMD_TEST_UNIT_READY };
+  uas_send_cmd(tag, cdb, sizeof(cdb));
+}
+
+static void uas_send_tmf(uint16_t tag, uint8_t function, uint16_t task_tag) {
+  msc_uas_task_mgmt_iu_t const iu = {
+    .iu_id    = MSC_UAS_IU_TASK_MGMT,
+    .tag      = tu_htons(tag),
+    .function = function,
+    .task_tag = tu_htons(task_tag),
+  };
+  host_out(EDPT_UAS_CMD, &iu, sizeof(iu));
+}
+
+// receive next IU on status pipe and check its id and tag, return the whole IU
+static msc_uas_sense_iu_t uas_recv_status(uint8_t iu_id, uint16_t tag) {
+  msc_uas_sense_iu_t iu;
+  tu_memclr(&iu, sizeof(iu));
+  host_in(EDPT_UAS_STATUS, &iu, sizeof(iu));
+  TEST_ASSERT_EQUAL_HEX8(iu_id, iu.iu_id);
+  TEST_ASSERT_EQUAL_UINT16(tag, tu_ntohs(iu.tag));
+  return iu;
+}
+
+static void uas_recv_response(uint16_t tag, uint8_t resp_code) {
+  msc_uas_sense_iu_t iu = uas_recv_status(MSC_UAS_IU_RESPONSE, tag);
+  TEST_ASSERT_EQUAL_HEX8(resp_code, ((msc_uas_response_iu_t const*) &iu)->resp_code);
+}
+
+static void uas_recv_sense_good(uint16_t tag) {
+  msc_uas_sense_iu_t iu = uas_recv_status(MSC_UAS_IU_SENSE, tag);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_STATUS_GOOD, iu.status);
+}
+
+// READ10 of one block which is already dispatched: READ READY, data then SENSE
+static void uas_complete_read10(uint16_t tag, uint32_t lba) {
+  uint8_t data[DISK_BLOCK_SIZE];
+  uas_recv_status(MSC_UAS_IU_READ_READY, tag);
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_MEMORY(msc_disk[lba], data, DISK_BLOCK_SIZE);
+  uas_recv_sense_good(tag);
+}
+
+void test_uas_cmd_queue(void) {
+  uas_enumerate();
+  for (uint8_t i = 0; i < DISK_BLOCK_NUM; i++) {
+    memset(msc_disk[i], i, DISK_BLOCK_SIZE);
+  }
+
+  // first command is executed, the others are queued while command pipe is re-armed
+  uas_send_read10(1, 3, 1);
+  uas_send_tur(2);
+  uas_send_read10(3, 5, 1);
+
+  // commands complete in order, each one with its own tag
+  uas_complete_read10(1, 3);
+  uas_recv_sense_good(2);
+  uas_complete_read10(3, 5);
+  TEST_ASSERT_FALSE(model_get(EDPT_UAS_STATUS)->busy);
+  TEST_ASSERT_TRUE(model_get(EDPT_UAS_CMD)->busy);
+}
+
+void test_uas_cmd_queue_full(void) {
+  uas_enumerate();
+
+  // one command is executed and CFG_TUD_MSC_UAS_QUEUE_DEPTH are queued, command pipe is then held
+  uas_send_read10(1, 0, 1);
+  for (uint16_t tag = 2; tag < 2 + CFG_TUD_MSC_UAS_QUEUE_DEPTH; tag++) {
+    TEST_ASSERT_TRUE(model_get(EDPT_UAS_CMD)->busy);
+    uas_send_tur(tag);
+  }
+  TEST_ASSERT_FALSE(model_get(EDPT_UAS_CMD)->busy);
+
+  // room in queue once the first queued command is dispatched
+  uas_complete_read10(1, 0);
+  TEST_ASSERT_TRUE(model_get(EDPT_UAS_CMD)->busy);
+  for (uint16_t tag = 2; tag < 2 + CFG_TUD_MSC_UAS_QUEUE_DEPTH; tag++) {
+    uas_recv_sense_good(tag);
+  }
+}
+
+void test_uas_overlapped_tag(void) {
+  uas_enumerate();
+
+  uas_send_read10(5, 0, 1);
+  uas_recv_status(MSC_UAS_IU_READ_READY, 5);
+
+  // tag of command being executed is reused: response IU, command pipe is held until it is sent
+  uas_send_tur(5);
+  TEST_ASSERT_FALSE(model_get(EDPT_UAS_CMD)->busy);
+  uas_recv_response(5, MSC_UAS_RESP_OVERLAPPED_TAG);
+  TEST_ASSERT_TRUE(model_get(EDPT_UAS_CMD)->busy);
+
+  // tag of queued command is reused as well
+  uas_send_tur(6);
+  uas_send_tur(6);
+  uas_recv_response(6, MSC_UAS_RESP_OVERLAPPED_TAG);
+
+  // original commands are not affected
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  uas_recv_sense_good(5);
+  uas_recv_sense_good(6);
+}
+
+void test_uas_task_mgmt(void) {
+  uas_enumerate();
+
+  uas_send_read10(1, 0, 1);
+  uas_recv_status(MSC_UAS_IU_READ_READY, 1);
+  uas_send_tur(2);
+  uas_send_tur(3);
+
+  // query: queued and executing commands are in use
+  uas_send_tmf(10, MSC_UAS_TMF_QUERY_TASK, 2);
+  uas_recv_response(10, MSC_UAS_RESP_TMF_SUCCEEDED);
+  uas_send_tmf(11, MSC_UAS_TMF_QUERY_TASK, 1);
+  uas_recv_response(11, MSC_UAS_RESP_TMF_SUCCEEDED);
+
+  // abort queued command, it is no longer found
+  uas_send_tmf(12, MSC_UAS_TMF_ABORT_TASK, 2);
+  uas_recv_response(12, MSC_UAS_RESP_TMF_COMPLETE);
+  uas_send_tmf(13, MSC_UAS_TMF_QUERY_TASK, 2);
+  uas_recv_response(13, MSC_UAS_RESP_TMF_COMPLETE);
+
+  // command being executed cannot be aborted
+  uas_send_tmf(14, MSC_UAS_TMF_ABORT_TASK, 1);
+  uas_recv_response(14, MSC_UAS_RESP_TMF_FAILED);
+
+  // reset drops queued commands
+  uas_send_tmf(15, MSC_UAS_TMF_LOGICAL_UNIT_RESET, 0);
+  uas_recv_response(15, MSC_UAS_RESP_TMF_COMPLETE);
+
+  uas_send_tmf(16, 0x40, 0);
+  uas_recv_response(16, MSC_UAS_RESP_TMF_NOT_SUPPORTED);
+
+  // executing command completes, dropped command 3 has no status
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+  uas_recv_sense_good(1);
+  TEST_ASSERT_FALSE(model_get(EDPT_UAS_STATUS)->busy);
+}
+
+void test_uas_status_sequencing(void) {
+  uas_enumerate();
+
+  // READ READY is in flight when data stage is complete and a response is queued
+  uas_send_read10(1, 0, 1);
+  uas_send_tmf(2, MSC_UAS_TMF_QUERY_TASK, 1);
+  uint8_t data[DISK_BLOCK_SIZE];
+  TEST_ASSERT_EQUAL(DISK_BLOCK_SIZE, host_in(EDPT_MSC_IN, data, sizeof(data)));
+
+  // response goes first, then SENSE of current command
+  uas_recv_status(MSC_UAS_IU_READ_READY, 1);
+  uas_recv_response(2, MSC_UAS_RESP_TMF_SUCCEEDED);
+  uas_recv_sense_good(1);
+
+  // failed command reports its sense data in SENSE IU, data pipes are not stalled
+  uint8_t const cdb[6] = { 0x1D }; // SEND DIAGNOSTIC, data-out is not supported
+  uas_send_cmd(3, cdb, sizeof(cdb));
+  msc_uas_sense_iu_t iu = uas_recv_status(MSC_UAS_IU_SENSE, 3);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_STATUS_CHECK_CONDITION, iu.status);
+  TEST_ASSERT_EQUAL_UINT16(sizeof(scsi_sense_fixed_resp_t), tu_ntohs(iu.sense_len));
+  TEST_ASSERT_EQUAL_HEX8(SCSI_SENSE_ILLEGAL_REQUEST, ((scsi_sense_fixed_resp_t const*) iu.sense)->sense_key);
+  TEST_ASSERT_FALSE(usbd_edpt_stalled(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_FALSE(usbd_edpt_stalled(rhport, EDPT_MSC_OUT));
+
+  // invalid IU
+  uint8_t const bad_iu[16] = { 0x7f, 0, 0, 9 };
+  host_out(EDPT_UAS_CMD, bad_iu, sizeof(bad_iu));
+  uas_recv_response(9, MSC_UAS_RESP_INVALID_IU);
+}
+
+// bot command without data stage, return CSW status
+static uint8_t bot_test_unit_ready(uint32_t tag) {
+  msc_cbw_t cbw = {
+    .signature   = MSC_CBW_SIGNATURE,
+    .tag         = tag,
+    .total_bytes = 0,
+    .cmd_len     = 6,
+  };
+  cbw.command[0] = SCSI_CMD_TEST_UNIT_READY;
+  host_out(EDPT_MSC_OUT, &cbw, sizeof(cbw));
+
+  msc_csw_t csw;
+  TEST_ASSERT_EQUAL(sizeof(msc_csw_t), host_in(EDPT_MSC_IN, &csw, sizeof(csw)));
+  TEST_ASSERT_EQUAL_HEX32(MSC_CSW_SIGNATURE, csw.signature);
+  TEST_ASSERT_EQUAL_HEX32(tag, csw.tag);
+  return csw.status;
+}
+
+void test_uas_alt_switch(void) {
+  uas_enumerate();
+
+  // BOT pipes are aborted, toggle of all UAS pipes are reset without closing
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_MSC_OUT)->abort_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_MSC_IN)->abort_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_UAS_CMD)->clear_stall_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_UAS_STATUS)->clear_stall_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_MSC_IN)->clear_stall_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_MSC_OUT)->clear_stall_count);
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_OUT)->busy);
+  TEST_ASSERT_TRUE(model_get(EDPT_UAS_CMD)->busy);
+
+  // switch back while READ10 data is in flight on shared data-in pipe
+  uas_send_read10(1, 0, 1);
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_IN)->busy);
+  host_set_interface(0);
+
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_UAS_CMD)->abort_count);
+  TEST_ASSERT_EQUAL(1, model_get(EDPT_UAS_STATUS)->abort_count);
+  TEST_ASSERT_EQUAL(2, model_get(EDPT_MSC_IN)->abort_count);
+  TEST_ASSERT_FALSE(model_get(EDPT_MSC_IN)->busy);
+  TEST_ASSERT_FALSE(model_get(EDPT_UAS_CMD)->busy);
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_EQUAL(4, edpt_open_count); // nothing is re-opened
+
+  // BOT works with a fresh CBW
+  TEST_ASSERT_TRUE(model_get(EDPT_MSC_OUT)->busy);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, bot_test_unit_ready(0x1234));
+
+  // and UAS again
+  host_set_interface(1);
+  uas_send_tur(7);
+  uas_recv_sense_good(7);
+}
@@ -0,0 +1,428 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "ncm.h"
+#include "net_device.h"
+TEST_SOURCE_FILE("ncm_device.c")
+
+// Mock File
+#include "mock_usbd.h"
+#include "mock_usbd_pvt.h"
+
+//--------------------------------------------------------------------+
+// Descriptors
+//--------------------------------------------------------------------+
+enum {
+  ITF_NUM_NCM  = 0,
+  EP_NOTIF     = 0x81,
+  EP_OUT       = 0x02,
+  EP_IN        = 0x82,
+  EP_SIZE      = 64,
+  DATAGRAM_LEN = 60,
+  // NTB header, NDP and datagram pointers of a transmit NTB
+  XMIT_HDR_LEN = sizeof(nth16_t) + sizeof(ndp16_t) + (CFG_TUD_NCM_IN_MAX_DATAGRAMS_PER_NTB + 1) * sizeof(ndp16_datagram_t),
+};
+
+TU_VERIFY_STATIC(CFG_TUD_NCM_OUT_NTB_N == 2 && CFG_TUD_NCM_IN_NTB_N == 2, "2 NTBs per direction");
+TU_VERIFY_STATIC(CFG_TUD_NCM_IN_NTB_MAX_SIZE % EP_SIZE == 0, "max size NTB ends on packet boundary");
+
+static uint8_t const desc_ncm[] = {
+  TUD_CDC_NCM_DESCRIPTOR(ITF_NUM_NCM, 0, 0, EP_NOTIF, 16, EP_OUT, EP_IN, EP_SIZE, CFG_TUD_NET_MTU, 50, 0)
+};
+
+//--------------------------------------------------------------------+
+// usbd mock callbacks
+//--------------------------------------------------------------------+
+// an endpoint has a single transfer in flight, completed by the test
+typedef struct {
+  uint8_t* buf;
+  uint16_t len;
+  bool     busy;
+  uint8_t  count; // transfers submitted
+} edpt_t;
+
+static edpt_t edpts[3][2];
+
+static edpt_t* edpt_get(uint8_t ep_addr) {
+  return &edpts[tu_edpt_number(ep_addr)][tu_edpt_dir(ep_addr)];
+}
+
+static bool edpt_xfer_cb(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr,
+                         int cmock_num_calls) {
+  (void) rhport; (void) is_isr; (void) cmock_num_calls;
+  edpt_t* ep = edpt_get(ep_addr);
+  TEST_ASSERT_FALSE(ep->busy);
+  ep->buf  = buffer;
+  ep->len  = total_bytes;
+  ep->busy = true;
+  ep->count++;
+  return true;
+}
+
+static bool edpt_busy_cb(uint8_t rhport, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  return edpt_get(ep_addr)->busy;
+}
+
+static bool open_edpt_pair_cb(uint8_t rhport, uint8_t const* p_desc, uint8_t ep_count, uint8_t xfer_type,
+                              uint8_t* ep_out, uint8_t* ep_in, int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  TEST_ASSERT_EQUAL(2, ep_count);
+  TEST_ASSERT_EQUAL(TUSB_XFER_BULK, xfer_type);
+  for (uint8_t i = 0; i < ep_count; i++) {
+    tusb_desc_endpoint_t const* desc_ep = (tusb_desc_endpoint_t const*) p_desc;
+    if (tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_IN) {
+      *ep_in = desc_ep->bEndpointAddress;
+    } else {
+      *ep_out = desc_ep->bEndpointAddress;
+    }
+    p_desc = tu_desc_next(p_desc);
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Glue logic
+//--------------------------------------------------------------------+
+#define RX_MAX 16
+
+static ncm_datagram_t rx[RX_MAX]; // datagrams accepted by the glue logic
+static uint8_t  rx_count;
+static uint8_t  batch_count;      // tud_network_recv_batch_cb() invocations
+static uint16_t batch_accept;     // datagrams accepted per invocation
+static bool     batch_out_armed;  // OUT endpoint was re-armed with another NTB when the last batch was passed
+static bool     rx_hold;          // accepted datagrams are kept until app_release(), returned right away otherwise
+
+static bool in_ntb(uint8_t const* ptr, uint8_t const* ntb) {
+  return ptr >= ntb && ptr < ntb + CFG_TUD_NCM_OUT_NTB_MAX_SIZE;
+}
+
+uint16_t tud_network_recv_batch_cb(const ncm_datagram_t datagrams[], uint16_t count) {
+  edpt_t const* ep = edpt_get(EP_OUT);
+  batch_count++;
+  batch_out_armed = ep->busy && !in_ntb(datagrams[0].buffer, ep->buf);
+
+  uint16_t const accepted = tu_min16(count, batch_accept);
+  for (uint16_t i = 0; i < accepted; i++) {
+    TEST_ASSERT_TRUE(rx_count < RX_MAX);
+    rx[rx_count++] = datagrams[i];
+    if (!rx_hold) {
+      tud_network_recv_release(datagrams[i].buffer);
+    }
+  }
+  return accepted;
+}
+
+uint16_t tud_network_xmit_cb(uint8_t* dst, void* ref, uint16_t arg) {
+  (void) ref;
+  memset(dst, 0xAA, arg);
+  return arg;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+// open the interface and select the data alternate setting
+static void ncm_activate(void) {
+  TEST_ASSERT_EQUAL(sizeof(desc_ncm) - 8,
+                    netd_open(0, (tusb_desc_interface_t const*) (desc_ncm + 8), sizeof(desc_ncm) - 8));
+
+  tusb_control_request_t const request = {
+    .bmRequestType = 0x01,
+    .bRequest      = TUSB_REQ_SET_INTERFACE,
+    .wValue        = 1,
+    .wIndex        = ITF_NUM_NCM + 1,
+    .wLength       = 0,
+  };
+  TEST_ASSERT_TRUE(netd_control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+}
+
+// host sends an NTB of count datagrams into the armed OUT transfer, datagram i is filled with (tag + i)
+static void host_send(uint8_t tag, uint8_t count) {
+  edpt_t* ep = edpt_get(EP_OUT);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_EQUAL(CFG_TUD_NCM_OUT_NTB_MAX_SIZE, ep->len);
+
+  uint16_t const ndp_len = (uint16_t) (sizeof(ndp16_t) + (count + 1) * sizeof(ndp16_datagram_t));
+  uint16_t pos = (uint16_t) (sizeof(nth16_t) + ndp_len);
+  ndp16_datagram_t* ndp_datagram = (ndp16_datagram_t*) (ep->buf + sizeof(nth16_t) + sizeof(ndp16_t));
+  for (uint8_t i = 0; i < count; i++) {
+    ndp_datagram[i].wDatagramIndex  = pos;
+    ndp_datagram[i].wDatagramLength = DATAGRAM_LEN;
+    memset(ep->buf + pos, tag + i, DATAGRAM_LEN);
+    pos += DATAGRAM_LEN;
+  }
+  ndp_datagram[count].wDatagramIndex  = 0;
+  ndp_datagram[count].wDatagramLength = 0;
+
+  nth16_t const nth = {
+    .dwSignature   = NTH16_SIGNATURE,
+    .wHeaderLength = sizeof(nth16_t),
+    .wSequence     = tag,
+    .wBlockLength  = pos,
+    .wNdpIndex     = sizeof(nth16_t),
+  };
+  ndp16_t const ndp = {
+    .dwSignature   = NDP16_SIGNATURE_NCM0,
+    .wLength       = ndp_len,
+    .wNextNdpIndex = 0,
+  };
+  memcpy(ep->buf, &nth, sizeof(nth));
+  memcpy(ep->buf + sizeof(nth16_t), &ndp, sizeof(ndp));
+
+  ep->busy = false;
+  TEST_ASSERT_TRUE(netd_xfer_cb(0, EP_OUT, XFER_RESULT_SUCCESS, pos));
+}
+
+// usbd closes all endpoints on bus reset, host enumerates and activates the interface again
+static void bus_reset(void) {
+  memset(edpts, 0, sizeof(edpts));
+  netd_reset(0);
+  ncm_activate();
+}
+
+static void app_release(uint8_t i) {
+  tud_network_recv_release(rx[i].buffer);
+  rx[i].buffer = NULL;
+}
+
+static void check_datagram(ncm_datagram_t const* datagram, uint8_t tag) {
+  TEST_ASSERT_EQUAL(DATAGRAM_LEN, datagram->len);
+  TEST_ASSERT_EACH_EQUAL_HEX8(tag, datagram->buffer, DATAGRAM_LEN);
+}
+
+static void app_xmit(uint16_t size) {
+  TEST_ASSERT_TRUE(tud_network_can_xmit(size));
+  tud_network_xmit(NULL, size);
+}
+
+// host completes the IN transfer
+static void host_receive(void) {
+  edpt_t* ep = edpt_get(EP_IN);
+  TEST_ASSERT_TRUE(ep->busy);
+  ep->busy = false;
+  TEST_ASSERT_TRUE(netd_xfer_cb(0, EP_IN, XFER_RESULT_SUCCESS, ep->len));
+}
+
+void setUp(void) {
+  usbd_edpt_open_IgnoreAndReturn(true);
+  tud_control_status_IgnoreAndReturn(true);
+  tud_speed_get_IgnoreAndReturn(TUSB_SPEED_FULL);
+  usbd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+  usbd_edpt_busy_StubWithCallback(edpt_busy_cb);
+  usbd_open_edpt_pair_StubWithCallback(open_edpt_pair_cb);
+
+  memset(edpts, 0, sizeof(edpts));
+  rx_count        = 0;
+  batch_count     = 0;
+  batch_accept    = UINT16_MAX;
+  batch_out_armed = false;
+  rx_hold         = false;
+
+  netd_init();
+  ncm_activate();
+  TEST_ASSERT_EQUAL(1, edpt_get(EP_OUT)->count);
+}
+
+// lent datagrams survive netd_init(), return them for the next test
+void tearDown(void) {
+  for (uint8_t i = 0; rx_hold && i < rx_count; i++) {
+    if (rx[i].buffer != NULL) {
+      app_release(i);
+    }
+  }
+}
+
+//--------------------------------------------------------------------+
+// Receive
+//--------------------------------------------------------------------+
+// all datagrams of an NTB are passed at once, the OUT endpoint is already armed with the next NTB by then
+void test_recv_batch_rearm_before_glue(void) {
+  host_send(0x10, 3);
+  TEST_ASSERT_EQUAL(1, batch_count);
+  TEST_ASSERT_TRUE(batch_out_armed);
+  TEST_ASSERT_EQUAL(3, rx_count);
+  for (uint8_t i = 0; i < 3; i++) {
+    check_datagram(&rx[i], 0x10 + i);
+  }
+
+  // NTB is free again after all of its datagrams are accepted
+  host_send(0x20, 1);
+  TEST_ASSERT_EQUAL(2, batch_count);
+  TEST_ASSERT_TRUE(batch_out_armed);
+  check_datagram(&rx[3], 0x20);
+  TEST_ASSERT_EQUAL(3, edpt_get(EP_OUT)->count);
+}
+
+// datagrams not accepted are passed again by tud_network_recv_renew(), reception continues meanwhile
+void test_recv_batch_partial_accept(void) {
+  batch_accept = 1;
+  host_send(0x10, 3);
+  TEST_ASSERT_EQUAL(1, rx_count);
+  check_datagram(&rx[0], 0x10);
+
+  // second NTB is received while the first one is held by the glue logic, no NTB is left to re-arm. Completion
+  // passes the rest of the first NTB again.
+  host_send(0x20, 2);
+  TEST_ASSERT_EQUAL(2, rx_count);
+  check_datagram(&rx[1], 0x11);
+  TEST_ASSERT_FALSE(edpt_get(EP_OUT)->busy);
+
+  batch_accept = UINT16_MAX;
+  tud_network_recv_renew();
+  TEST_ASSERT_EQUAL(5, rx_count);
+  check_datagram(&rx[2], 0x12);
+  check_datagram(&rx[3], 0x20);
+  check_datagram(&rx[4], 0x21);
+  TEST_ASSERT_TRUE(edpt_get(EP_OUT)->busy);
+}
+
+//--------------------------------------------------------------------+
+// Receive lending
+//--------------------------------------------------------------------+
+// NTB is reused after its last lent datagram is returned, reception pauses while all NTBs are lent
+void test_recv_lend_pause_resume(void) {
+  edpt_t const* ep = edpt_get(EP_OUT);
+  uint8_t* const ntb0 = ep->buf;
+  rx_hold = true;
+  host_send(0x10, 2);
+  host_send(0x20, 2);
+  TEST_ASSERT_FALSE(ep->busy);
+
+  app_release(0);
+  TEST_ASSERT_FALSE(ep->busy);
+  check_datagram(&rx[1], 0x11);
+  app_release(1);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_EQUAL_PTR(ntb0, ep->buf);
+
+  // datagrams still lent are untouched by the new reception
+  host_send(0x30, 1);
+  TEST_ASSERT_FALSE(ep->busy);
+  check_datagram(&rx[2], 0x20);
+  check_datagram(&rx[3], 0x21);
+  check_datagram(&rx[4], 0x30);
+}
+
+// datagrams lent before a bus reset stay valid, their NTB is left out of reception until all are returned
+void test_recv_lend_across_reset(void) {
+  edpt_t const* ep = edpt_get(EP_OUT);
+  uint8_t* const ntb0 = ep->buf;
+  rx_hold = true;
+  host_send(0x10, 2);
+
+  bus_reset();
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_TRUE(ep->buf != ntb0);
+  host_send(0x20, 1);
+  TEST_ASSERT_FALSE(ep->busy);
+  check_datagram(&rx[0], 0x10);
+  check_datagram(&rx[1], 0x11);
+
+  app_release(0);
+  TEST_ASSERT_FALSE(ep->busy);
+  app_release(1);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_EQUAL_PTR(ntb0, ep->buf);
+}
+
+// datagrams not yet accepted are dropped by a bus reset, the NTB is reused after the accepted ones are returned
+void test_recv_lend_partial_across_reset(void) {
+  edpt_t const* ep = edpt_get(EP_OUT);
+  uint8_t* const ntb0 = ep->buf;
+  rx_hold      = true;
+  batch_accept = 1;
+  host_send(0x10, 3);
+
+  bus_reset();
+  TEST_ASSERT_TRUE(ep->buf != ntb0);
+  batch_accept = UINT16_MAX;
+  host_send(0x20, 1);
+  TEST_ASSERT_EQUAL(2, rx_count);
+  check_datagram(&rx[0], 0x10);
+  check_datagram(&rx[1], 0x20);
+  TEST_ASSERT_FALSE(ep->busy);
+
+  app_release(0);
+  TEST_ASSERT_TRUE(ep->busy);
+  TEST_ASSERT_EQUAL_PTR(ntb0, ep->buf);
+}
+
+//--------------------------------------------------------------------+
+// Transmit
+//--------------------------------------------------------------------+
+// NTB ending on a packet boundary is padded to a short packet instead of being followed by a ZLP
+void test_xmit_pad_instead_of_zlp(void) {
+  app_xmit(EP_SIZE - XMIT_HDR_LEN);
+  edpt_t const* ep = edpt_get(EP_IN);
+  TEST_ASSERT_EQUAL(1, ep->count);
+  TEST_ASSERT_EQUAL(EP_SIZE + 1, ep->len);
+
+  host_receive();
+  TEST_ASSERT_EQUAL(1, ep->count);
+  TEST_ASSERT_FALSE(ep->busy);
+}
+
+// NTB of maximum size can't be padded, ZLP is sent before the next NTB
+void test_xmit_zlp_max_size(void) {
+  app_xmit(CFG_TUD_NCM_IN_NTB_MAX_SIZE - XMIT_HDR_LEN);
+  edpt_t const* ep = edpt_get(EP_IN);
+  TEST_ASSERT_EQUAL(CFG_TUD_NCM_IN_NTB_MAX_SIZE, ep->len);
+
+  host_receive();
+  TEST_ASSERT_EQUAL(2, ep->count);
+  TEST_ASSERT_EQUAL(0, ep->len);
+
+  app_xmit(100);
+  TEST_ASSERT_EQUAL(2, ep->count);
+  host_receive();
+  TEST_ASSERT_EQUAL(3, ep->count);
+  TEST_ASSERT_EQUAL(XMIT_HDR_LEN + 100, ep->len);
+}
+
+// datagrams queued while an NTB is on the wire are collected in the next NTB, started on completion
+void test_xmit_next_ntb_on_completion(void) {
+  app_xmit(100);
+  edpt_t const* ep = edpt_get(EP_IN);
+  TEST_ASSERT_EQUAL(1, ep->count);
+
+  app_xmit(100);
+  app_xmit(60);
+  TEST_ASSERT_EQUAL(1, ep->count);
+
+  host_receive();
+  TEST_ASSERT_EQUAL(2, ep->count);
+  TEST_ASSERT_EQUAL(XMIT_HDR_LEN + 160, ep->len);
+
+  xmit_ntb_t const* ntb = (xmit_ntb_t const*) ep->buf;
+  TEST_ASSERT_EQUAL(1, ntb->nth.wSequence);
+  TEST_ASSERT_EQUAL(100, ntb->ndp_datagram[0].wDatagramLength);
+  TEST_ASSERT_EQUAL(60, ntb->ndp_datagram[1].wDatagramLength);
+  TEST_ASSERT_EQUAL(0, ntb->ndp_datagram[2].wDatagramIndex);
+}
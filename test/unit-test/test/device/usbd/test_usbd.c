@@ -29,6 +29,7 @@
 #include "tusb_fifo.h"
 #include "tusb.h"
 #include "usbd.h"
+#include "usbd_pvt.h"
 TEST_SOURCE_FILE("usbd.c")
 
 // Mock File
@@ -43,10 +44,18 @@ uint32_t tusb_time_millis_api(void) {
   return 0;
 }
 
+// cycle counter for endpoint statistics, advanced by test
+static uint32_t cycle_count;
+uint32_t tusb_cycle_count_api(void) {
+  return cycle_count;
+}
+
 enum
 {
   EDPT_CTRL_OUT = 0x00,
-  EDPT_CTRL_IN  = 0x80
+  EDPT_CTRL_IN  = 0x80,
+  EDPT_MSC_OUT  = 0x01,
+  EDPT_MSC_IN   = 0x81,
 };
 
 uint8_t const rhport = 0;
@@ -100,6 +109,23 @@ tusb_control_request_t const req_get_desc_configuration =
   .wLength = 256
 };
 
+uint8_t const data_desc_configuration_msc[] =
+{
+  // Config number, interface count, string index, total length, attribute, power in mA
+  TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUD_CONFIG_DESC_LEN + TUD_MSC_DESC_LEN, 0x00, 100),
+  // Interface number, string index, EP Out & EP In address, EP size
+  TUD_MSC_DESCRIPTOR(0, 0, EDPT_MSC_OUT, EDPT_MSC_IN, 512),
+};
+
+tusb_control_request_t const req_set_configuration =
+{
+  .bmRequestType = 0x00,
+  .bRequest = TUSB_REQ_SET_CONFIGURATION,
+  .wValue = 1,
+  .wIndex = 0x0000,
+  .wLength = 0
+};
+
 // Vendor OUT control request (direction OUT, type Vendor, recipient Device), 8-byte data stage
 tusb_control_request_t const req_vendor_out =
 {
@@ -296,3 +322,329 @@ void test_usbd_control_out_overrun_clamp(void)
 
   tud_task();
 }
+
+//--------------------------------------------------------------------+
+// Event batch
+//--------------------------------------------------------------------+
+
+// Events are taken from queue in batch: a stray transfer complete (endpoint without driver) is skipped alone,
+// the SETUP behind it in the same batch must still be processed
+void test_usbd_stray_xfer_complete_in_batch(void)
+{
+  desc_device = (uint8_t const *) &data_desc_device;
+
+  // bus reset clears endpoint to driver mapping
+  mscd_reset_Expect(rhport);
+  dcd_event_bus_reset(rhport, TUSB_SPEED_HIGH, false);
+  dcd_event_xfer_complete(rhport, 0x81, 8, XFER_RESULT_SUCCESS, false);
+  dcd_event_setup_received(rhport, (uint8_t*) &req_get_desc_device, false);
+
+  // data
+  dcd_edpt_xfer_ExpectWithArrayAndReturn(rhport, EDPT_CTRL_IN, (uint8_t*)&data_desc_device, sizeof(tusb_desc_device_t), sizeof(tusb_desc_device_t), false, true);
+  dcd_event_xfer_complete(rhport, EDPT_CTRL_IN, sizeof(tusb_desc_device_t), 0, false);
+
+  // status
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_CTRL_OUT, NULL, 0, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_CTRL_OUT, 0, 0, false);
+  dcd_edpt0_status_complete_ExpectWithArray(rhport, &req_get_desc_device, 1);
+
+  tud_task();
+}
+
+//--------------------------------------------------------------------+
+// Scatter/Gather transfer (emulated by usbd, mock dcd has no TUP_DCD_EDPT_XFER_SG)
+//--------------------------------------------------------------------+
+
+static uint8_t sg_buf[3][32768];
+
+// bus reset then set configuration with MSC interface so that its endpoints are bound to msc driver
+static void configure_msc(void)
+{
+  desc_configuration = data_desc_configuration_msc;
+
+  mscd_reset_Expect(rhport);
+  dcd_event_bus_reset(rhport, TUSB_SPEED_HIGH, false);
+  tud_task();
+
+  dcd_event_setup_received(rhport, (uint8_t*) &req_set_configuration, false);
+  mscd_open_ExpectAndReturn(rhport, NULL, TUD_MSC_DESC_LEN, TUD_MSC_DESC_LEN);
+  mscd_open_IgnoreArg_itf_desc();
+  mscd_open_IgnoreArg_max_len();
+
+  // status
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_CTRL_IN, NULL, 0, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_CTRL_IN, 0, 0, false);
+  dcd_edpt0_status_complete_ExpectWithArray(rhport, &req_set_configuration, 1);
+
+  tud_task();
+  TEST_ASSERT_TRUE(tud_mounted());
+}
+
+// Segments are submitted one after another, class driver is notified once with total bytes
+void test_usbd_xfer_sg_in(void)
+{
+  tu_edpt_seg_t const segs[] = {
+    { .buf = sg_buf[0], .len = 512 },
+    { .buf = sg_buf[1], .len = 100 },
+  };
+  configure_msc();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_IN, segs, TU_ARRAY_SIZE(segs), false));
+  TEST_ASSERT_TRUE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+
+  // next segment is submitted from dcd event handler, endpoint is still busy
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[1], 100, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  tud_task();
+  TEST_ASSERT_TRUE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 100, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_SUCCESS, 612, true);
+  tud_task();
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+}
+
+// Total of all segments is reported even if it exceeds 16-bit transfer length
+void test_usbd_xfer_sg_exceed_64k(void)
+{
+  tu_edpt_seg_t const segs[] = {
+    { .buf = sg_buf[0], .len = 32768 },
+    { .buf = sg_buf[1], .len = 32768 },
+    { .buf = sg_buf[2], .len = 32768 },
+  };
+  configure_msc();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_OUT, sg_buf[0], 32768, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_OUT, segs, TU_ARRAY_SIZE(segs), false));
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_OUT, sg_buf[1], 32768, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_OUT, 32768, XFER_RESULT_SUCCESS, false);
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_OUT, sg_buf[2], 32768, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_OUT, 32768, XFER_RESULT_SUCCESS, false);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_OUT, 32768, XFER_RESULT_SUCCESS, false);
+
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_OUT, XFER_RESULT_SUCCESS, 3*32768UL, true);
+  tud_task();
+}
+
+// OUT short packet ends the transfer early, remaining segments are not submitted
+void test_usbd_xfer_sg_out_short_packet(void)
+{
+  tu_edpt_seg_t const segs[] = {
+    { .buf = sg_buf[0], .len = 1024 },
+    { .buf = sg_buf[1], .len = 1024 },
+  };
+  configure_msc();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_OUT, sg_buf[0], 1024, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_OUT, segs, TU_ARRAY_SIZE(segs), false));
+
+  dcd_event_xfer_complete(rhport, EDPT_MSC_OUT, 200, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_OUT, XFER_RESULT_SUCCESS, 200, true);
+  tud_task();
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_OUT));
+}
+
+// Error on a segment completes the whole transfer with that result and bytes transferred so far
+void test_usbd_xfer_sg_error(void)
+{
+  tu_edpt_seg_t const segs[] = {
+    { .buf = sg_buf[0], .len = 512 },
+    { .buf = sg_buf[1], .len = 512 },
+    { .buf = sg_buf[2], .len = 512 },
+  };
+  configure_msc();
+
+  // failed segment
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_IN, segs, TU_ARRAY_SIZE(segs), false));
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[1], 512, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 64, XFER_RESULT_STALLED, false);
+
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_STALLED, 576, true);
+  tud_task();
+
+  // dcd rejects next segment
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_IN, segs, TU_ARRAY_SIZE(segs), false));
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[1], 512, false, false);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_FAILED, 512, true);
+  tud_task();
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+}
+
+//--------------------------------------------------------------------+
+// Endpoint abort
+//--------------------------------------------------------------------+
+
+// Transfer in progress is aborted in dcd, endpoint is ready for the next one without xfer_cb()
+void test_usbd_edpt_abort(void)
+{
+  configure_msc();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_claim(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+
+  dcd_edpt_abort_xfer_Expect(rhport, EDPT_MSC_IN);
+  usbd_edpt_abort(rhport, EDPT_MSC_IN);
+  TEST_ASSERT_TRUE(usbd_edpt_ready(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_TRUE(usbd_edpt_claim(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_TRUE(usbd_edpt_release(rhport, EDPT_MSC_IN));
+  tud_task();
+
+  // stalled endpoint has no transfer in dcd and stays stalled
+  dcd_edpt_stall_Expect(rhport, EDPT_MSC_IN);
+  usbd_edpt_stall(rhport, EDPT_MSC_IN);
+  usbd_edpt_abort(rhport, EDPT_MSC_IN);
+  TEST_ASSERT_TRUE(usbd_edpt_stalled(rhport, EDPT_MSC_IN));
+  TEST_ASSERT_FALSE(usbd_edpt_busy(rhport, EDPT_MSC_IN));
+}
+
+//--------------------------------------------------------------------+
+// Endpoint statistics
+//--------------------------------------------------------------------+
+
+static tu_edpt_stats_t msc_in_stats(void)
+{
+  tu_edpt_stats_t stats;
+  TEST_ASSERT_TRUE(tud_edpt_stats_get(EDPT_MSC_IN, &stats));
+  return stats;
+}
+
+// Counters and latency histogram are updated on submission and completion
+void test_usbd_edpt_stats(void)
+{
+  configure_msc();
+  tud_edpt_stats_clear();
+
+  // latency of 300 cycles lands in bin 8 [256, 512)
+  cycle_count = 1000;
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+  cycle_count = 1300;
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_SUCCESS, 512, true);
+  tud_task();
+
+  tu_edpt_stats_t stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(1, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(512, stats.bytes);
+  TEST_ASSERT_EQUAL(0, stats.stalls);
+  TEST_ASSERT_EQUAL(0, stats.errors);
+  TEST_ASSERT_EQUAL(1, stats.latency_hist[8]);
+
+  // latency across counter wrap: 0x110 cycles is also bin 8, failed transfer counts its bytes
+  cycle_count = 0xFFFFFF00UL;
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+  cycle_count = 0x10;
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 64, XFER_RESULT_FAILED, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_FAILED, 64, true);
+  tud_task();
+
+  stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(2, stats.completed);
+  TEST_ASSERT_EQUAL(576, stats.bytes);
+  TEST_ASSERT_EQUAL(1, stats.errors);
+  TEST_ASSERT_EQUAL(2, stats.latency_hist[8]);
+
+  // zero latency is bin 0, latency beyond the histogram goes to the last bin
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 0, XFER_RESULT_STALLED, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_STALLED, 0, true);
+  tud_task();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+  cycle_count += 0x80000000UL;
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_SUCCESS, 512, true);
+  tud_task();
+
+  stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(4, stats.completed);
+  TEST_ASSERT_EQUAL(1, stats.stalls);
+  TEST_ASSERT_EQUAL(1, stats.latency_hist[0]);
+  TEST_ASSERT_EQUAL(1, stats.latency_hist[TU_EDPT_STATS_HIST_BINS - 1]);
+
+  // transfer rejected by dcd is submitted but never completes
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, false);
+  TEST_ASSERT_FALSE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+
+  // stall issued by class driver
+  dcd_edpt_stall_Expect(rhport, EDPT_MSC_IN);
+  usbd_edpt_stall(rhport, EDPT_MSC_IN);
+
+  stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(5, stats.submitted);
+  TEST_ASSERT_EQUAL(4, stats.completed);
+  TEST_ASSERT_EQUAL(2, stats.errors);
+  TEST_ASSERT_EQUAL(2, stats.stalls);
+
+  // other direction of the endpoint is untouched
+  TEST_ASSERT_TRUE(tud_edpt_stats_get(EDPT_MSC_OUT, &stats));
+  TEST_ASSERT_EQUAL(0, stats.submitted);
+  TEST_ASSERT_FALSE(tud_edpt_stats_get(CFG_TUD_ENDPPOINT_MAX, &stats));
+}
+
+// Scatter/gather transfer is counted once with its total bytes
+void test_usbd_edpt_stats_xfer_sg(void)
+{
+  tu_edpt_seg_t const segs[] = {
+    { .buf = sg_buf[0], .len = 512 },
+    { .buf = sg_buf[1], .len = 100 },
+  };
+  configure_msc();
+  tud_edpt_stats_clear();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer_sg(rhport, EDPT_MSC_IN, segs, TU_ARRAY_SIZE(segs), false));
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[1], 100, false, true);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 100, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_SUCCESS, 612, true);
+  tud_task();
+
+  tu_edpt_stats_t const stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(1, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(612, stats.bytes);
+}
+
+// Statistics are kept across bus reset and only cleared on request
+void test_usbd_edpt_stats_clear(void)
+{
+  configure_msc();
+  tud_edpt_stats_clear();
+
+  dcd_edpt_xfer_ExpectAndReturn(rhport, EDPT_MSC_IN, sg_buf[0], 512, false, true);
+  TEST_ASSERT_TRUE(usbd_edpt_xfer(rhport, EDPT_MSC_IN, sg_buf[0], 512, false));
+  dcd_event_xfer_complete(rhport, EDPT_MSC_IN, 512, XFER_RESULT_SUCCESS, false);
+  mscd_xfer_cb_ExpectAndReturn(rhport, EDPT_MSC_IN, XFER_RESULT_SUCCESS, 512, true);
+  tud_task();
+
+  configure_msc();
+  tu_edpt_stats_t stats = msc_in_stats();
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(512, stats.bytes);
+
+  // control endpoint has counted the transfers of enumeration
+  TEST_ASSERT_TRUE(tud_edpt_stats_get(EDPT_CTRL_IN, &stats));
+  TEST_ASSERT_TRUE(stats.completed > 0);
+
+  tud_edpt_stats_clear();
+  stats = msc_in_stats();
+  static tu_edpt_stats_t const zero;
+  TEST_ASSERT_EQUAL_MEMORY(&zero, &stats, sizeof(stats));
+  TEST_ASSERT_TRUE(tud_edpt_stats_get(EDPT_CTRL_IN, &stats));
+  TEST_ASSERT_EQUAL(0, stats.completed);
+}
@@ -0,0 +1,304 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "video_device.h"
+TEST_SOURCE_FILE("video_device.c")
+
+// Mock File
+#include "mock_usbd.h"
+#include "mock_usbd_pvt.h"
+
+//--------------------------------------------------------------------+
+// Descriptors
+//--------------------------------------------------------------------+
+enum {
+  ITF_NUM_VIDEO_CONTROL = 0,
+  ITF_NUM_VIDEO_STREAMING,
+  EP_VIDEO = 0x81,
+  EP_SIZE  = 64,
+  HDR_LEN  = TUD_VIDEO_PAYLOAD_HEADER_LEN,
+  DATA_LEN = CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE - HDR_LEN,
+};
+
+// MJPEG 160x120 10 fps over bulk, payload size is limited by the endpoint buffer
+static const uint8_t desc_video[] = {
+  TUD_VIDEO_DESC_STD_VC(ITF_NUM_VIDEO_CONTROL, 0, 0),
+    TUD_VIDEO_DESC_CS_VC(0x0150, TUD_VIDEO_DESC_CAMERA_TERM_LEN + TUD_VIDEO_DESC_OUTPUT_TERM_LEN, 27000000,
+                         ITF_NUM_VIDEO_STREAMING),
+      TUD_VIDEO_DESC_CAMERA_TERM(1, 0, 0, 0, 0, 0, 0),
+      TUD_VIDEO_DESC_OUTPUT_TERM(2, VIDEO_TT_STREAMING, 0, 1, 0),
+  TUD_VIDEO_DESC_STD_VS(ITF_NUM_VIDEO_STREAMING, 0, 1, 0),
+    TUD_VIDEO_DESC_CS_VS_INPUT(1, TUD_VIDEO_DESC_CS_VS_FMT_MJPEG_LEN + TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT_LEN,
+                               EP_VIDEO, 0, 2, 0, 0, 0, 0),
+      TUD_VIDEO_DESC_CS_VS_FMT_MJPEG(1, 1, 0, 1, 0, 0, 0, 0),
+        TUD_VIDEO_DESC_CS_VS_FRM_MJPEG_CONT(1, 0, 160, 120, 3072000, 30720000, 38400,
+                                            1000000, 1000000, 1000000, 1000000),
+      TUD_VIDEO_DESC_EP_BULK(EP_VIDEO, EP_SIZE, 1),
+};
+
+//--------------------------------------------------------------------+
+// usbd mock callbacks
+//--------------------------------------------------------------------+
+#define XFER_MAX 16
+
+typedef struct {
+  uint8_t* buf;
+  uint16_t len;
+  uint8_t  data[CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE]; // (first segment) content at submit time
+  uint8_t* seg_buf;  // second segment of scatter/gather transfer
+  uint16_t seg_len;
+} xfer_t;
+
+static xfer_t   xfers[XFER_MAX];
+static uint8_t  xfer_count;
+static void const* ctrl_data;
+static video_probe_and_commit_control_t ctrl_in; // IN data stage of the last control request
+
+static bool edpt_xfer_cb(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr,
+                         int cmock_num_calls) {
+  (void) rhport; (void) is_isr; (void) cmock_num_calls;
+  TEST_ASSERT_EQUAL_HEX8(EP_VIDEO, ep_addr);
+  TEST_ASSERT_TRUE(xfer_count < XFER_MAX && total_bytes <= CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE);
+  xfer_t* x = &xfers[xfer_count++];
+  x->buf = buffer;
+  x->len = total_bytes;
+  memcpy(x->data, buffer, total_bytes);
+  x->seg_buf = NULL;
+  x->seg_len = 0;
+  return true;
+}
+
+static bool edpt_xfer_sg_cb(uint8_t rhport, uint8_t ep_addr, tu_edpt_seg_t const* segs, uint8_t count, bool is_isr,
+                            int cmock_num_calls) {
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL(0, segs[0].len % EP_SIZE);
+  TEST_ASSERT_TRUE(edpt_xfer_cb(rhport, ep_addr, segs[0].buf, segs[0].len, is_isr, cmock_num_calls));
+  xfer_t* x = &xfers[xfer_count - 1];
+  x->seg_buf = segs[1].buf;
+  x->seg_len = segs[1].len;
+  return true;
+}
+
+static bool control_xfer_cb(uint8_t rhport, tusb_control_request_t const* request, void* buffer, uint16_t len,
+                            int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  if (request->bmRequestType_bit.direction == TUSB_DIR_OUT) {
+    // OUT data stage: host data lands in the driver buffer
+    if (ctrl_data) {
+      memcpy(buffer, ctrl_data, len);
+    }
+  } else {
+    memcpy(&ctrl_in, buffer, tu_min16(len, sizeof(ctrl_in)));
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Helper
+//--------------------------------------------------------------------+
+static void commit(void) {
+  video_probe_and_commit_control_t param = {
+    .bFormatIndex    = 1,
+    .bFrameIndex     = 1,
+    .dwFrameInterval = 1000000,
+  };
+  tusb_control_request_t const request = {
+    .bmRequestType = 0x21,
+    .bRequest      = VIDEO_REQUEST_SET_CUR,
+    .wValue        = VIDEO_VS_CTL_COMMIT << 8,
+    .wIndex        = ITF_NUM_VIDEO_STREAMING,
+    .wLength       = sizeof(param),
+  };
+  ctrl_data = &param;
+  TEST_ASSERT_TRUE(videod_control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+  TEST_ASSERT_TRUE(videod_control_xfer_cb(0, CONTROL_STAGE_DATA, &request));
+  ctrl_data = NULL;
+}
+
+// Complete transfer n, next one (if any) is submitted
+static void xfer_done(uint8_t n) {
+  TEST_ASSERT_EQUAL(n + 1, xfer_count);
+  TEST_ASSERT_TRUE(videod_xfer_cb(0, EP_VIDEO, XFER_RESULT_SUCCESS, xfers[n].len + xfers[n].seg_len));
+}
+
+// Source clock is the weak callback (0) in this test
+static void check_header(xfer_t const* x, bool fid, bool eof, uint32_t pts) {
+  TEST_ASSERT_EQUAL(HDR_LEN, x->data[0]);
+  tusb_video_payload_header_t const* hdr = (tusb_video_payload_header_t const*) x->data;
+  TEST_ASSERT_EQUAL(fid, hdr->FrameID);
+  TEST_ASSERT_EQUAL(eof, hdr->EndOfFrame);
+  TEST_ASSERT_EQUAL(1, hdr->PresentationTime);
+  TEST_ASSERT_EQUAL(1, hdr->SourceClockReference);
+  TEST_ASSERT_EQUAL_UINT32(pts, tu_unaligned_read32(x->data + 2));
+  TEST_ASSERT_EQUAL_UINT32(0, tu_unaligned_read32(x->data + 6));
+  TEST_ASSERT_EQUAL_UINT16(0, tu_unaligned_read16(x->data + 10));
+}
+
+void setUp(void) {
+  usbd_edpt_claim_IgnoreAndReturn(true);
+  usbd_edpt_open_IgnoreAndReturn(true);
+  usbd_edpt_close_Ignore();
+  usbd_edpt_iso_alloc_IgnoreAndReturn(true);
+  usbd_edpt_iso_activate_IgnoreAndReturn(true);
+  tud_control_status_IgnoreAndReturn(true);
+  usbd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+  usbd_edpt_xfer_sg_StubWithCallback(edpt_xfer_sg_cb);
+  tud_control_xfer_StubWithCallback(control_xfer_cb);
+
+  xfer_count = 0;
+  videod_init();
+  TEST_ASSERT_EQUAL(sizeof(desc_video), videod_open(0, (tusb_desc_interface_t const*) desc_video, sizeof(desc_video)));
+  commit();
+}
+
+void tearDown(void) {}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+void test_commit(void) {
+  tusb_control_request_t const request = {
+    .bmRequestType = 0xA1,
+    .bRequest      = VIDEO_REQUEST_GET_CUR,
+    .wValue        = VIDEO_VS_CTL_COMMIT << 8,
+    .wIndex        = ITF_NUM_VIDEO_STREAMING,
+    .wLength       = sizeof(video_probe_and_commit_control_t),
+  };
+  TEST_ASSERT_TRUE(videod_control_xfer_cb(0, CONTROL_STAGE_SETUP, &request));
+  TEST_ASSERT_EQUAL_UINT32(CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE, ctrl_in.dwMaxPayloadTransferSize);
+  TEST_ASSERT_EQUAL_UINT32(CFG_TUD_VIDEO_CLOCK_FREQUENCY, ctrl_in.dwClockFrequency);
+
+  // payloads are sized to the negotiated value
+  uint8_t frame[1000] = { 0 };
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame, sizeof(frame)));
+  TEST_ASSERT_EQUAL(CFG_TUD_VIDEO_STREAMING_EP_BUFSIZE, xfers[0].len);
+}
+
+void test_frame_xfer_copy(void) {
+  uint8_t frame[DATA_LEN * 2 + 10];
+  for (size_t i = 0; i < sizeof(frame); i++) {
+    frame[i] = (uint8_t) i;
+  }
+
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame, sizeof(frame)));
+  TEST_ASSERT_FALSE(tud_video_n_frame_xfer(0, 0, frame, sizeof(frame))); // busy
+  xfer_done(0);
+  xfer_done(1);
+  xfer_done(2);
+  TEST_ASSERT_EQUAL(3, xfer_count); // frame complete, nothing more queued
+
+  // every payload is staged in the driver's endpoint buffer
+  uint8_t const* ep_buf = xfers[0].buf;
+  TEST_ASSERT_TRUE(ep_buf < frame || ep_buf >= frame + sizeof(frame));
+  uint16_t const len[] = { HDR_LEN + DATA_LEN, HDR_LEN + DATA_LEN, HDR_LEN + 10 };
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_PTR(ep_buf, xfers[i].buf);
+    TEST_ASSERT_EQUAL(len[i], xfers[i].len);
+    TEST_ASSERT_EQUAL(0, xfers[i].seg_len);
+    check_header(&xfers[i], 1, i == 2, 0);
+    TEST_ASSERT_EQUAL_MEMORY(frame + i * DATA_LEN, xfers[i].data + HDR_LEN, len[i] - HDR_LEN);
+  }
+
+  // next frame toggles FID
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer(0, 0, frame, 10));
+  check_header(&xfers[3], 0, true, 0);
+}
+
+void test_frame_xfer_slices(void) {
+  // 2 lines of 300 bytes with a stride of 320, then a short chunk
+  enum { LINE = 300, STRIDE = 320, CHUNK = 20 };
+  uint8_t buf[2 * STRIDE + CHUNK];
+  uint8_t ref[sizeof(buf)];
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t) (i * 7 + 1);
+  }
+  memcpy(ref, buf, sizeof(buf));
+
+  tud_video_slice_t const slices[] = {
+    { buf, LINE },
+    { buf + STRIDE, 0 }, // empty slice is skipped
+    { buf + STRIDE, LINE },
+    { buf + 2 * STRIDE, CHUNK },
+  };
+  TEST_ASSERT_FALSE(tud_video_n_frame_xfer_slices(0, 0, slices, 0, 0));
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer_slices(0, 0, slices, TU_ARRAY_SIZE(slices), 0x12345678));
+  for (uint8_t i = 0; i < 5; i++) {
+    xfer_done(i);
+  }
+  TEST_ASSERT_EQUAL(5, xfer_count);
+
+  // Payloads never span slices: each line is DATA_LEN + rest. Header and first packet are in endpoint buffer, the
+  // rest of the payload is sent from the slice
+  uint8_t const* ep_buf = xfers[0].buf;
+  TEST_ASSERT_TRUE(ep_buf < buf || ep_buf >= buf + sizeof(buf));
+  for (uint8_t i = 0; i < 5; i++) {
+    uint8_t* data;
+    uint16_t data_len;
+    if (i < 4) {
+      data     = buf + (i / 2) * STRIDE + ((i & 1) ? DATA_LEN : 0);
+      data_len = (i & 1) ? (LINE - DATA_LEN) : DATA_LEN;
+    } else {
+      data     = buf + 2 * STRIDE;
+      data_len = CHUNK;
+    }
+    uint16_t const head_len = tu_min16(data_len, EP_SIZE - HDR_LEN);
+
+    TEST_ASSERT_EQUAL_PTR(ep_buf, xfers[i].buf);
+    TEST_ASSERT_EQUAL(HDR_LEN + head_len, xfers[i].len);
+    check_header(&xfers[i], 1, i == 4, 0x12345678);
+    TEST_ASSERT_EQUAL_MEMORY(data, xfers[i].data + HDR_LEN, head_len);
+    if (head_len < data_len) {
+      TEST_ASSERT_EQUAL_PTR(data + head_len, xfers[i].seg_buf);
+      TEST_ASSERT_EQUAL(data_len - head_len, xfers[i].seg_len);
+    } else {
+      TEST_ASSERT_EQUAL(0, xfers[i].seg_len);
+    }
+  }
+
+  // Slice memory is never written
+  TEST_ASSERT_EQUAL_MEMORY(ref, buf, sizeof(buf));
+
+  // Stream is free again for the next frame
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer_slices(0, 0, slices, 1, 0));
+  check_header(&xfers[5], 0, false, 0);
+}
+
+void test_frame_xfer_slices_abandon_on_commit(void) {
+  uint8_t buf[1000];
+  memset(buf, 0x5A, sizeof(buf));
+  tud_video_slice_t const slice = { buf, sizeof(buf) };
+
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer_slices(0, 0, &slice, 1, 0));
+  TEST_ASSERT_EQUAL_PTR(buf + EP_SIZE - HDR_LEN, xfers[0].seg_buf);
+
+  // New commit in the middle of the frame abandons it, next frame starts from its first slice
+  commit();
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x5A, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(tud_video_n_frame_xfer_slices(0, 0, &slice, 1, 0));
+  TEST_ASSERT_EQUAL_PTR(buf + EP_SIZE - HDR_LEN, xfers[1].seg_buf);
+}
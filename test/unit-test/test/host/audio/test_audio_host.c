@@ -0,0 +1,345 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "osal/osal.h"
+#include "tusb_fifo.h"
+#include "audio_host.h"
+TEST_SOURCE_FILE("audio_host.c")
+
+// Mock File
+#include "mock_usbh.h"
+#include "mock_usbh_pvt.h"
+
+//--------------------------------------------------------------------+
+// Descriptor: UAC2 fullspeed headset
+//  - Speaker: IT 1 (USB streaming) -> OT 3, AS interface 1 alt 1 (16-bit stereo) and alt 2 (24-bit stereo)
+//    with asynchronous OUT 0x01 and feedback IN 0x81
+//  - Microphone: IT 5 -> OT 6 (USB streaming), AS interface 2 alt 1 (16-bit mono) with IN 0x82
+//  - Both terminals are clocked by programmable clock source 4, microphone through clock selector 9
+//  - Followed by a MIDI streaming interface which belongs to MIDI driver
+//--------------------------------------------------------------------+
+enum {
+  DADDR = 1,
+  EP_SPK = 0x01,
+  EP_FB = 0x81,
+  EP_MIC = 0x82,
+};
+
+#include "usbh_model.h"
+
+static const uint8_t desc_audio[] = {
+  // Audio Control interface
+  9, TUSB_DESC_INTERFACE, 0, 0, 0, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_CONTROL, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  9, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_HEADER, 0x00, 0x02, 0x08, 83, 0, 0,
+  8, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_CLOCK_SOURCE, 4, 0x03, 0x07, 0, 0,
+  17, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_INPUT_TERMINAL, 1, 0x01, 0x01, 0, 4, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+  12, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_OUTPUT_TERMINAL, 3, 0x01, 0x03, 0, 1, 4, 0, 0, 0,
+  17, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_INPUT_TERMINAL, 5, 0x01, 0x02, 0, 9, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+  8, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_CLOCK_SELECTOR, 9, 1, 4, 0x03, 0,
+  12, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AC_INTERFACE_OUTPUT_TERMINAL, 6, 0x01, 0x01, 0, 5, 9, 0, 0, 0,
+
+  // Speaker streaming interface
+  9, TUSB_DESC_INTERFACE, 1, 0, 0, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_STREAMING, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  9, TUSB_DESC_INTERFACE, 1, 1, 2, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_STREAMING, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  16, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_AS_GENERAL, 1, 0, AUDIO20_FORMAT_TYPE_I, 0x01, 0, 0, 0, 2, 0, 0, 0, 0, 0,
+  6, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_FORMAT_TYPE, AUDIO20_FORMAT_TYPE_I, 2, 16,
+  7, TUSB_DESC_ENDPOINT, EP_SPK, 0x05, 196, 0, 1,
+  8, TUSB_DESC_CS_ENDPOINT, AUDIO20_CS_EP_SUBTYPE_GENERAL, 0, 0, 0, 0, 0,
+  7, TUSB_DESC_ENDPOINT, EP_FB, 0x11, 3, 0, 1,
+  9, TUSB_DESC_INTERFACE, 1, 2, 2, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_STREAMING, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  16, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_AS_GENERAL, 1, 0, AUDIO20_FORMAT_TYPE_I, 0x01, 0, 0, 0, 2, 0, 0, 0, 0, 0,
+  6, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_FORMAT_TYPE, AUDIO20_FORMAT_TYPE_I, 3, 24,
+  7, TUSB_DESC_ENDPOINT, EP_SPK, 0x05, U16_TO_U8S_LE(294), 1,
+  8, TUSB_DESC_CS_ENDPOINT, AUDIO20_CS_EP_SUBTYPE_GENERAL, 0, 0, 0, 0, 0,
+  7, TUSB_DESC_ENDPOINT, EP_FB, 0x11, 3, 0, 1,
+
+  // Microphone streaming interface
+  9, TUSB_DESC_INTERFACE, 2, 0, 0, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_STREAMING, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  9, TUSB_DESC_INTERFACE, 2, 1, 1, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_STREAMING, AUDIO_INT_PROTOCOL_CODE_V2, 0,
+  16, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_AS_GENERAL, 6, 0, AUDIO20_FORMAT_TYPE_I, 0x01, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+  6, TUSB_DESC_CS_INTERFACE, AUDIO20_CS_AS_INTERFACE_FORMAT_TYPE, AUDIO20_FORMAT_TYPE_I, 2, 16,
+  7, TUSB_DESC_ENDPOINT, EP_MIC, 0x05, 98, 0, 1,
+  8, TUSB_DESC_CS_ENDPOINT, AUDIO20_CS_EP_SUBTYPE_GENERAL, 0, 0, 0, 0, 0,
+
+  // MIDI streaming interface
+  9, TUSB_DESC_INTERFACE, 3, 0, 2, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_MIDI_STREAMING, 0, 0,
+};
+
+// length of the audio function, up to MIDI streaming interface
+#define DESC_AUDIO_LEN  (sizeof(desc_audio) - 9)
+
+// Complete oldest transfer of an endpoint, all packets get actual_len (clamped to requested length)
+static tuh_iso_xfer_t* iso_complete(uint8_t ep_addr, uint16_t actual_len) {
+  tuh_iso_xfer_t* xfer = iso_pop(ep_addr);
+  xfer->actual_len = 0;
+  for (uint16_t i = 0; i < xfer->packet_count; i++) {
+    xfer->packets[i].actual_len = tu_min16(actual_len, xfer->packets[i].length);
+    xfer->packets[i].result = XFER_RESULT_SUCCESS;
+    xfer->actual_len += xfer->packets[i].actual_len;
+  }
+  xfer->result = XFER_RESULT_SUCCESS;
+  xfer->complete_cb(xfer);
+  return xfer;
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static void mount(void) {
+  uint16_t const len = audioh_open(0, DADDR, (const tusb_desc_interface_t*) desc_audio, sizeof(desc_audio));
+  TEST_ASSERT_EQUAL(DESC_AUDIO_LEN, len);
+  TEST_ASSERT_TRUE(audioh_set_config(DADDR, 0));
+}
+
+// start 16-bit stereo speaker at 48 kHz
+static void start_speaker(void) {
+  TEST_ASSERT_TRUE(tuh_audio_stream_start(0, 0, 48000));
+  ctrl_complete(XFER_RESULT_SUCCESS); // SET_CUR sampling frequency
+  ctrl_complete(XFER_RESULT_SUCCESS); // SET_INTERFACE
+}
+
+void setUp(void) {
+  uint8_t const ep_addr[] = { EP_SPK, EP_FB, EP_MIC };
+  usbh_model_init(ep_addr, sizeof(ep_addr));
+
+  audioh_init();
+}
+
+void tearDown(void) {
+  audioh_close(DADDR);
+}
+
+void test_audio_host_open_requires_uac2_control(void) {
+  static const uint8_t desc_uac1[] = {
+    9, TUSB_DESC_INTERFACE, 0, 0, 0, TUSB_CLASS_AUDIO, AUDIO_SUBCLASS_CONTROL, 0, 0,
+  };
+  TEST_ASSERT_EQUAL(0, audioh_open(0, DADDR, (const tusb_desc_interface_t*) desc_uac1, sizeof(desc_uac1)));
+  // streaming interface alone is not a function
+  TEST_ASSERT_EQUAL(0, audioh_open(0, DADDR, (const tusb_desc_interface_t*) (desc_audio + 92), 9));
+}
+
+void test_audio_host_open_parse_function(void) {
+  mount();
+  TEST_ASSERT_EQUAL(2, _set_config_itf); // all streaming interfaces are bound
+  TEST_ASSERT_TRUE(tuh_audio_mounted(0));
+  TEST_ASSERT_EQUAL(3, tuh_audio_alt_count(0));
+
+  tuh_audio_alt_info_t info;
+  TEST_ASSERT_TRUE(tuh_audio_alt_info(0, 0, &info));
+  TEST_ASSERT_EQUAL(1, info.itf_num);
+  TEST_ASSERT_EQUAL(1, info.alt);
+  TEST_ASSERT_EQUAL(TUSB_DIR_OUT, info.dir);
+  TEST_ASSERT_EQUAL(AUDIO20_FORMAT_TYPE_I, info.format_type);
+  TEST_ASSERT_EQUAL(2, info.channels);
+  TEST_ASSERT_EQUAL(2, info.subslot_size);
+  TEST_ASSERT_EQUAL(16, info.bit_resolution);
+  TEST_ASSERT_EQUAL(4, info.clock_id);
+  TEST_ASSERT_EQUAL(196, info.ep_size);
+  TEST_ASSERT_TRUE(info.has_feedback);
+
+  TEST_ASSERT_TRUE(tuh_audio_alt_info(0, 1, &info));
+  TEST_ASSERT_EQUAL(2, info.alt);
+  TEST_ASSERT_EQUAL(24, info.bit_resolution);
+  TEST_ASSERT_EQUAL(294, info.ep_size);
+
+  // clock is found through selector
+  TEST_ASSERT_TRUE(tuh_audio_alt_info(0, 2, &info));
+  TEST_ASSERT_EQUAL(2, info.itf_num);
+  TEST_ASSERT_EQUAL(TUSB_DIR_IN, info.dir);
+  TEST_ASSERT_EQUAL(1, info.channels);
+  TEST_ASSERT_EQUAL(4, info.clock_id);
+  TEST_ASSERT_FALSE(info.has_feedback);
+
+  TEST_ASSERT_FALSE(tuh_audio_alt_info(0, 3, &info));
+}
+
+void test_audio_host_alt_find(void) {
+  mount();
+  TEST_ASSERT_EQUAL(0, tuh_audio_alt_find(0, TUSB_DIR_OUT, 0, 0));
+  TEST_ASSERT_EQUAL(1, tuh_audio_alt_find(0, TUSB_DIR_OUT, 2, 24));
+  TEST_ASSERT_EQUAL(2, tuh_audio_alt_find(0, TUSB_DIR_IN, 1, 16));
+  TEST_ASSERT_EQUAL(TUSB_INDEX_INVALID_8, tuh_audio_alt_find(0, TUSB_DIR_IN, 2, 0));
+}
+
+void test_audio_host_start_set_rate_then_interface(void) {
+  mount();
+  TEST_ASSERT_TRUE(tuh_audio_stream_start(0, 0, 48000));
+  TEST_ASSERT_FALSE(tuh_audio_stream_start(0, 0, 48000)); // already starting
+
+  // SET_CUR sampling frequency of clock 4
+  TEST_ASSERT_TRUE(_ctrl.pending);
+  TEST_ASSERT_EQUAL(AUDIO20_CS_REQ_CUR, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(TUSB_DIR_OUT, _ctrl.setup.bmRequestType_bit.direction);
+  TEST_ASSERT_EQUAL(TUSB_REQ_TYPE_CLASS, _ctrl.setup.bmRequestType_bit.type);
+  TEST_ASSERT_EQUAL(AUDIO20_CS_CTRL_SAM_FREQ << 8, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(0x0400, _ctrl.setup.wIndex);
+  TEST_ASSERT_EQUAL(4, _ctrl.setup.wLength);
+  uint8_t const rate[] = { 0x80, 0xBB, 0x00, 0x00 };
+  TEST_ASSERT_EQUAL_MEMORY(rate, _ctrl.data, 4);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  TEST_ASSERT_TRUE(_ctrl.pending);
+  TEST_ASSERT_EQUAL(TUSB_REQ_SET_INTERFACE, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(1, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(1, _ctrl.setup.wIndex);
+  TEST_ASSERT_FALSE(tuh_audio_streaming(0, TUSB_DIR_OUT));
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  TEST_ASSERT_TRUE(tuh_audio_streaming(0, TUSB_DIR_OUT));
+  TEST_ASSERT_FALSE(tuh_audio_streaming(0, TUSB_DIR_IN));
+
+  // 2 data transfers in flight, 48 stereo frames per packet of silence, and feedback
+  sim_ep_t* ep = sim_ep(EP_SPK);
+  TEST_ASSERT_EQUAL(2, ep->count);
+  TEST_ASSERT_EQUAL(CFG_TUH_AUDIO_ISO_PACKETS, ep->queue[0]->packet_count);
+  TEST_ASSERT_EQUAL(192, ep->queue[0]->packets[0].length);
+  TEST_ASSERT_EQUAL(0, ep->queue[0]->buffer[0]);
+  TEST_ASSERT_EQUAL(1, sim_ep(EP_FB)->count);
+  TEST_ASSERT_EQUAL(3, sim_ep(EP_FB)->queue[0]->packets[0].length);
+}
+
+void test_audio_host_start_rate_rejected(void) {
+  mount();
+  TEST_ASSERT_TRUE(tuh_audio_stream_start(0, 0, 44100));
+  ctrl_complete(XFER_RESULT_STALLED);
+
+  TEST_ASSERT_FALSE(_ctrl.pending); // no SET_INTERFACE
+  TEST_ASSERT_FALSE(tuh_audio_streaming(0, TUSB_DIR_OUT));
+  TEST_ASSERT_FALSE(sim_ep(EP_SPK)->opened);
+
+  // can be started again
+  start_speaker();
+  TEST_ASSERT_TRUE(tuh_audio_streaming(0, TUSB_DIR_OUT));
+}
+
+void test_audio_host_start_packet_too_large(void) {
+  mount();
+  TEST_ASSERT_FALSE(tuh_audio_stream_start(0, 1, 48000));
+  TEST_ASSERT_FALSE(_ctrl.pending);
+}
+
+void test_audio_host_out_stream_from_fifo(void) {
+  mount();
+  start_speaker();
+
+  // write 100 frames and a partial frame: only whole frames are taken
+  uint8_t samples[401];
+  for (uint16_t i = 0; i < sizeof(samples); i++) {
+    samples[i] = (uint8_t) (i + 1);
+  }
+  TEST_ASSERT_EQUAL(400, tuh_audio_write(0, samples, sizeof(samples)));
+
+  // refilled transfer takes 4 packets of 48 frames: 192 frames, FIFO underruns after 100 and is padded with silence
+  tuh_iso_xfer_t* xfer = iso_complete(EP_SPK, 192);
+  TEST_ASSERT_EQUAL(2, sim_ep(EP_SPK)->count);
+  TEST_ASSERT_EQUAL_MEMORY(samples, xfer->buffer, 400);
+  TEST_ASSERT_EQUAL(0, xfer->buffer[400]);
+  TEST_ASSERT_EQUAL(0, xfer->buffer[4 * 192 - 1]);
+  TEST_ASSERT_EQUAL(CFG_TUH_AUDIO_TX_BUFSIZE - CFG_TUH_AUDIO_TX_BUFSIZE % 4, tuh_audio_write_available(0));
+}
+
+void test_audio_host_out_paced_by_feedback(void) {
+  mount();
+  start_speaker();
+  TEST_ASSERT_EQUAL(48u << 16, tuh_audio_feedback_get(0));
+
+  // fullspeed feedback 48.5 samples per frame in 10.14
+  tuh_iso_xfer_t* fb = sim_ep(EP_FB)->queue[0];
+  uint32_t const value = (97u << 14) / 2;
+  fb->buffer[0] = (uint8_t) value;
+  fb->buffer[1] = (uint8_t) (value >> 8);
+  fb->buffer[2] = (uint8_t) (value >> 16);
+  iso_complete(EP_FB, 3);
+  TEST_ASSERT_EQUAL(0x308000, tuh_audio_feedback_get(0));
+  TEST_ASSERT_EQUAL(1, sim_ep(EP_FB)->count); // resubmitted
+
+  tuh_iso_xfer_t* xfer = iso_complete(EP_SPK, 192);
+  TEST_ASSERT_EQUAL(192, xfer->packets[0].length);
+  TEST_ASSERT_EQUAL(196, xfer->packets[1].length);
+  TEST_ASSERT_EQUAL(192, xfer->packets[2].length);
+  TEST_ASSERT_EQUAL(196, xfer->packets[3].length);
+
+  // feedback far off nominal is ignored
+  fb = sim_ep(EP_FB)->queue[0];
+  fb->buffer[0] = 0;
+  fb->buffer[1] = 0;
+  fb->buffer[2] = 0x10; // 64 samples per frame
+  iso_complete(EP_FB, 3);
+  TEST_ASSERT_EQUAL(0x308000, tuh_audio_feedback_get(0));
+}
+
+void test_audio_host_in_stream_to_fifo(void) {
+  mount();
+  TEST_ASSERT_TRUE(tuh_audio_stream_start(0, 2, 48000));
+  TEST_ASSERT_EQUAL(0x0400, _ctrl.setup.wIndex); // clock 4 through selector
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_TRUE(tuh_audio_streaming(0, TUSB_DIR_IN));
+
+  sim_ep_t* ep = sim_ep(EP_MIC);
+  TEST_ASSERT_EQUAL(2, ep->count);
+  TEST_ASSERT_EQUAL(98, ep->queue[0]->packets[0].length);
+
+  // 48 mono frames plus one stray byte per packet, packets are at offset of their requested length
+  tuh_iso_xfer_t* xfer = ep->queue[0];
+  for (uint16_t p = 0; p < CFG_TUH_AUDIO_ISO_PACKETS; p++) {
+    for (uint16_t i = 0; i < 97; i++) {
+      xfer->buffer[p * 98 + i] = (uint8_t) (p + 1);
+    }
+  }
+  iso_complete(EP_MIC, 97);
+  TEST_ASSERT_EQUAL(4 * 96, tuh_audio_available(0));
+  TEST_ASSERT_EQUAL(2, ep->count); // resubmitted
+
+  uint8_t buf[4 * 96];
+  TEST_ASSERT_EQUAL(96, tuh_audio_read(0, buf, 97)); // whole frames only
+  TEST_ASSERT_EQUAL(1, buf[0]);
+  TEST_ASSERT_EQUAL(1, buf[95]);
+  TEST_ASSERT_EQUAL(3 * 96, tuh_audio_read(0, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL(2, buf[0]);
+  TEST_ASSERT_EQUAL(4, buf[2 * 96 + 95]);
+  TEST_ASSERT_EQUAL(0, tuh_audio_available(0));
+}
+
+void test_audio_host_stop_and_unmount(void) {
+  mount();
+  start_speaker();
+
+  TEST_ASSERT_TRUE(tuh_audio_stream_stop(0, TUSB_DIR_OUT));
+  TEST_ASSERT_FALSE(sim_ep(EP_SPK)->opened);
+  TEST_ASSERT_FALSE(sim_ep(EP_FB)->opened);
+  TEST_ASSERT_EQUAL(TUSB_REQ_SET_INTERFACE, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(0, _ctrl.setup.wValue);
+  TEST_ASSERT_FALSE(tuh_audio_stream_start(0, 0, 48000)); // still stopping
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_FALSE(tuh_audio_streaming(0, TUSB_DIR_OUT));
+  TEST_ASSERT_FALSE(tuh_audio_stream_stop(0, TUSB_DIR_OUT));
+
+  audioh_close(DADDR);
+  TEST_ASSERT_FALSE(tuh_audio_mounted(0));
+}
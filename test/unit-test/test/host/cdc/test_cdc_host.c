@@ -0,0 +1,221 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+#include "usbh.h"
+#include "cdc_host.h"
+TEST_SOURCE_FILE("usbh.c")
+
+// Mock File
+#include "mock_hcd.h"
+
+// FT232R device descriptor
+#define HCD_MODEL_VID        0x0403
+#define HCD_MODEL_PID        0x6001
+#define HCD_MODEL_BCD_DEVICE 0x0600
+#define HCD_MODEL_EP0_SIZE   8
+#include "hcd_device_model.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+// cdc host runs on usbh on top of mock hcd, with a FT232R modeled on root port. Control requests are answered by the
+// model, bulk IN transfers are completed by the test with packets prefixed by the 2 FTDI status bytes.
+
+enum {
+  RHPORT  = 0,
+  DADDR   = 1,
+  EP_IN   = 0x81,
+  EP_OUT  = 0x02,
+  EP_SIZE = 64,
+  PAYLOAD = EP_SIZE - 2, // payload of a full packet
+};
+
+TU_VERIFY_STATIC(CFG_TUH_CDC_RX_EPSIZE == 2 * EP_SIZE, "transfer is 2 packets");
+TU_VERIFY_STATIC(CFG_TUH_CDC_RX_BUFSIZE == 4 * EP_SIZE, "fifo is 4 packets");
+
+static uint8_t const desc_configuration[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(9 + 9 + 7 + 7), 1, 1, 0, TU_BIT(7), 45,
+  9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_VENDOR_SPECIFIC, 0xff, 0xff, 0,
+  7, TUSB_DESC_ENDPOINT, EP_IN, TUSB_XFER_BULK, U16_TO_U8S_LE(EP_SIZE), 0,
+  7, TUSB_DESC_ENDPOINT, EP_OUT, TUSB_XFER_BULK, U16_TO_U8S_LE(EP_SIZE), 0,
+};
+
+//--------------------------------------------------------------------+
+// Device model
+//--------------------------------------------------------------------+
+// bulk IN transfer submitted by the driver
+static uint8_t* rx_buf;
+static uint16_t rx_len;
+
+static uint8_t rx_cb_count;
+static uint32_t payload_seq; // index of next payload byte sent by device
+
+// payload pattern with a period prime to fifo size, stale fifo content does not match
+TU_ATTR_ALWAYS_INLINE static inline uint8_t payload_byte(uint32_t i) {
+  return (uint8_t) (i % 251);
+}
+
+void tuh_cdc_rx_cb(uint8_t idx) {
+  (void) idx;
+  rx_cb_count++;
+}
+
+static uint8_t const* device_desc_configuration(uint16_t* len) {
+  *len = sizeof(desc_configuration);
+  return desc_configuration;
+}
+
+// FTDI vendor requests have no data stage
+static uint8_t const* device_ctrl_response(uint16_t* len) {
+  *len = 0;
+  return NULL;
+}
+
+// bulk IN is held until device_send()
+static bool device_edpt_xfer(uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen) {
+  (void) daddr;
+  TEST_ASSERT_EQUAL_HEX8(EP_IN, ep_addr);
+  TEST_ASSERT_NULL(rx_buf);
+  rx_buf = buffer;
+  rx_len = buflen;
+  return true;
+}
+
+// device completes pending bulk IN transfer with packets of given payload sizes
+static void device_send(uint8_t const* payload_len, uint8_t count) {
+  TEST_ASSERT_NOT_NULL(rx_buf);
+  uint16_t len = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(payload_len[i] <= PAYLOAD);
+    TEST_ASSERT_TRUE(i + 1 == count || payload_len[i] == PAYLOAD); // only last packet can be short
+    rx_buf[len++] = 0x01; // modem status
+    rx_buf[len++] = 0x60; // line status
+    for (uint8_t j = 0; j < payload_len[i]; j++) {
+      rx_buf[len++] = payload_byte(payload_seq++);
+    }
+  }
+  TEST_ASSERT_TRUE(len <= rx_len);
+
+  rx_buf = NULL;
+  hcd_event_xfer_complete(DADDR, EP_IN, len, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+}
+
+// application reads count bytes, they must be the payload sequence without status bytes
+static uint32_t read_seq;
+static void app_read(uint32_t count) {
+  uint8_t buf[CFG_TUH_CDC_RX_BUFSIZE];
+  TEST_ASSERT_EQUAL(count, tuh_cdc_read_available(0));
+  TEST_ASSERT_EQUAL(count, tuh_cdc_read(0, buf, sizeof(buf)));
+  for (uint32_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL_HEX8(payload_byte(read_seq), buf[i]);
+    read_seq++;
+  }
+  task_run(0);
+}
+
+void setUp(void) {
+  rx_buf      = NULL;
+  rx_len      = 0;
+  rx_cb_count = 0;
+  payload_seq = 0;
+  read_seq    = 0;
+
+  hcd_port_reset_Ignore();
+  hcd_model_init(RHPORT);
+
+  connected = true;
+  hcd_event_device_attach(RHPORT, false);
+  task_run(500);
+  TEST_ASSERT_TRUE(tuh_cdc_mounted(0));
+}
+
+void tearDown(void) {
+  tuh_deinit(RHPORT);
+}
+
+//--------------------------------------------------------------------+
+// FTDI receive
+//--------------------------------------------------------------------+
+void test_ftdi_rx_multi_packet(void) {
+  TEST_ASSERT_EQUAL(CFG_TUH_CDC_RX_EPSIZE, rx_len); // read covers multiple packets
+
+  uint8_t const packets[] = { PAYLOAD, PAYLOAD };
+  device_send(packets, 2);
+  TEST_ASSERT_EQUAL(1, rx_cb_count);
+  app_read(2 * PAYLOAD);
+}
+
+void test_ftdi_rx_short_packet(void) {
+  uint8_t const packets[] = { PAYLOAD, 10 };
+  device_send(packets, 2);
+  app_read(PAYLOAD + 10);
+}
+
+// idle device only sends status
+void test_ftdi_rx_status_only(void) {
+  uint8_t const packets[] = { 0 };
+  device_send(packets, 1);
+  TEST_ASSERT_EQUAL(0, rx_cb_count);
+  TEST_ASSERT_EQUAL(0, tuh_cdc_read_available(0));
+  TEST_ASSERT_NOT_NULL(rx_buf); // next transfer is queued
+}
+
+// payload is split into fifo linear and wrapped spans
+void test_ftdi_rx_fifo_wrap(void) {
+  uint8_t const packets[] = { PAYLOAD, PAYLOAD };
+
+  // move fifo pointers to 8 bytes before the end of its buffer
+  for (uint8_t i = 0; i < 2; i++) {
+    device_send(packets, 2);
+    app_read(2 * PAYLOAD);
+  }
+
+  // first packet crosses the end of fifo buffer
+  device_send(packets, 2);
+  app_read(2 * PAYLOAD);
+
+  // packet boundary at the end of fifo buffer
+  uint8_t const short_packets[] = { PAYLOAD, 40 };
+  for (uint8_t i = 0; i < 3; i++) {
+    device_send(short_packets, 2);
+    app_read(PAYLOAD + 40);
+  }
+}
+
+// no transfer is queued while fifo has no room for a packet
+void test_ftdi_rx_fifo_full(void) {
+  uint8_t const packets[] = { PAYLOAD, PAYLOAD };
+  device_send(packets, 2);
+  device_send(packets, 2);
+  TEST_ASSERT_NULL(rx_buf); // fifo has no space for another transfer
+  app_read(4 * PAYLOAD);
+  TEST_ASSERT_NOT_NULL(rx_buf);
+}
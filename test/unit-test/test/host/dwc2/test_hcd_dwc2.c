@@ -0,0 +1,979 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "hcd.h"
+#include "dwc2_common.h"
+TEST_SOURCE_FILE("hcd_dwc2.c")
+TEST_SOURCE_FILE("dwc2_common.c")
+
+// Mock File
+#include "mock_usbh.h"
+
+// The GD32VF103 port has its core at a fixed address where the register block below is mapped. Channel DMA addresses
+// are 32-bit: the test executable is linked with -no-pie so that its static transfer buffers and the driver's
+// descriptor lists are addressable by the controller model. Slave, buffer DMA or Scatter/Gather DMA mode is picked at
+// runtime by GHWCFG2/GHWCFG4, like on real core.
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+enum {
+  DADDR = 1,
+  EP_A  = 0x81,
+  EP_B  = 0x82,
+  EP_C  = 0x83,
+  EP_D  = 0x84,
+  EP_OUT = 0x01,
+  MPS   = 64,
+};
+
+enum {
+  XACT_PER_FRAME     = 4, // transaction attempts of a channel per frame
+  NAK_PREEMPT_FRAMES = 2, // HCD_XFER_NAK_PREEMPT_FRAMES
+  FRAME_LIST_SIZE    = 64, // HCFG.FrListEn
+  ISO_LIST_FS        = 64, // full-speed isochronous descriptor list: one per frame
+};
+
+typedef enum {
+  CORE_SLAVE,
+  CORE_DMA,
+  CORE_DDMA,
+} core_mode_t;
+
+// Device side of an endpoint
+typedef struct {
+  uint16_t pkts;    // packets answered (IN) or accepted (OUT) before NAKing
+  uint8_t  toggle;  // data toggle of next packet: 0 or 1
+  uint8_t  count;   // IN packets sent so far, each packet is filled with (ep_num << 4 | count)
+  uint8_t  stall;   // answer next token with STALL
+  uint16_t xacts;   // tokens received
+  uint16_t iso_len; // isochronous IN: bytes per packet
+} dev_ep_t;
+
+// Received packet waiting in RX FIFO (slave)
+typedef struct {
+  uint8_t  ch_id;
+  uint16_t len;
+  uint32_t hcint; // raised once the packet is popped
+  uint8_t  data[MPS];
+} rx_entry_t;
+
+static dwc2_regs_t* dwc2;
+static core_mode_t core_mode;
+static uint32_t frame_number;
+static bool sof_pending;
+
+static dev_ep_t dev_ep[16];
+static uint32_t ch_int[16]; // channel interrupts not yet acknowledged by driver
+
+// data received by OUT endpoint of device
+static uint8_t dev_out[256];
+static uint16_t dev_out_len;
+
+// Scatter/Gather DMA: bytes done of the channel's current descriptor, error injected in a frame
+static uint32_t ddma_offset[16];
+static uint32_t iso_err_frame; // isochronous packet is lost (descriptor status is error)
+static uint32_t ahb_err_frame; // isochronous channel halts with AHB error
+
+static rx_entry_t rx_fifo[4];
+static uint8_t rx_count;
+static uint32_t rx_popped_hcint[16]; // interrupts of popped packets, raised after driver returns
+
+static tuh_bus_info_t bus_info;
+
+static uint8_t buf_a[256] TU_ATTR_ALIGNED(4);
+static uint8_t buf_b[256] TU_ATTR_ALIGNED(4);
+
+// Completion events reported by the driver
+static hcd_event_t events[8];
+static uint8_t event_count;
+
+//--------------------------------------------------------------------+
+// Stubs
+//--------------------------------------------------------------------+
+void hcd_event_handler(hcd_event_t const* event, bool in_isr) {
+  (void) in_isr;
+  TEST_ASSERT_LESS_THAN(TU_ARRAY_SIZE(events), event_count);
+  events[event_count++] = *event;
+}
+
+void usbh_spin_lock(bool in_isr) {
+  (void) in_isr;
+}
+
+void usbh_spin_unlock(bool in_isr) {
+  (void) in_isr;
+}
+
+bool hcd_dcache_clean(void const* addr, uint32_t data_size) {
+  (void) addr;
+  (void) data_size;
+  return true;
+}
+
+bool hcd_dcache_invalidate(void const* addr, uint32_t data_size) {
+  (void) addr;
+  (void) data_size;
+  return true;
+}
+
+bool hcd_dcache_clean_invalidate(void const* addr, uint32_t data_size) {
+  (void) addr;
+  (void) data_size;
+  return true;
+}
+
+static bool bus_info_get_cb(uint8_t daddr, tuh_bus_info_t* info, int cmock_num_calls) {
+  (void) daddr;
+  (void) cmock_num_calls;
+  *info = bus_info;
+  return true;
+}
+
+// Reading a packet pops it from RX FIFO
+void tu_hwfifo_read(const volatile void* hwfifo, uint8_t* dest, uint16_t len, const tu_hwfifo_access_t* access_mode) {
+  (void) access_mode;
+  TEST_ASSERT_EQUAL_PTR(dwc2->fifo[0], hwfifo);
+  TEST_ASSERT_NOT_EQUAL(0, rx_count);
+  const rx_entry_t* rx = &rx_fifo[0];
+  TEST_ASSERT_EQUAL(rx->len, len);
+
+  memcpy(dest, rx->data, len);
+  rx_popped_hcint[rx->ch_id] |= rx->hcint;
+
+  rx_count--;
+  memmove(&rx_fifo[0], &rx_fifo[1], rx_count * sizeof(rx_entry_t));
+  if (rx_count > 0) {
+    dwc2_grxstsp_t grxstsp = {.value = 0};
+    grxstsp.ep_ch_num = rx_fifo[0].ch_id;
+    grxstsp.byte_count = rx_fifo[0].len;
+    grxstsp.packet_status = GRXSTS_PKTSTS_RX_DATA;
+    dwc2->grxstsp = grxstsp.value;
+  } else {
+    dwc2->gintsts &= ~GINTSTS_RXFLVL;
+  }
+}
+
+void tu_hwfifo_write(volatile void* hwfifo, const uint8_t* src, uint16_t len, const tu_hwfifo_access_t* access_mode) {
+  (void) hwfifo;
+  (void) src;
+  (void) len;
+  (void) access_mode;
+  TEST_FAIL_MESSAGE("slave OUT is not modeled");
+}
+
+//--------------------------------------------------------------------+
+// Controller model
+//--------------------------------------------------------------------+
+
+// Core clears its self-clearing reset and flush bits while hcd_init() polls them
+static void core_reset_tick(int sig) {
+  (void) sig;
+  uint32_t grstctl = dwc2->grstctl;
+  if (grstctl & GRSTCTL_CSRST) {
+    grstctl |= GRSTCTL_CSRST_DONE;
+  }
+  grstctl &= ~(GRSTCTL_TXFFLSH | GRSTCTL_RXFFLSH);
+  dwc2->grstctl = grstctl | GRSTCTL_AHBIDL;
+}
+
+// Power up core with ch_count channels in slave, buffer DMA or Scatter/Gather DMA mode, a full-speed device is then
+// connected
+static void hc_init(core_mode_t mode, uint8_t ch_count) {
+  core_mode = mode;
+  memset((void*) (uintptr_t) dwc2, 0, sizeof(dwc2_regs_t));
+
+  dwc2_ghwcfg2_t ghwcfg2 = {.value = 0};
+  ghwcfg2.arch        = (mode == CORE_SLAVE) ? GHWCFG2_ARCH_SLAVE_ONLY : GHWCFG2_ARCH_INTERNAL_DMA;
+  ghwcfg2.fs_phy_type = 1; // dedicated full-speed PHY only
+  ghwcfg2.num_host_ch = (uint8_t) (ch_count - 1) & 0x0fu;
+  dwc2->ghwcfg2 = ghwcfg2.value;
+
+  dwc2_ghwcfg4_t ghwcfg4 = {.value = 0};
+  ghwcfg4.dma_desc_enabled = (mode == CORE_DDMA) ? 1 : 0;
+  dwc2->ghwcfg4 = ghwcfg4.value;
+  dwc2->gsnpsid = DWC2_CORE_REV_4_20a;
+  dwc2->grstctl = GRSTCTL_AHBIDL;
+
+  struct sigaction sa = {.sa_handler = core_reset_tick, .sa_flags = SA_RESTART};
+  sigaction(SIGALRM, &sa, NULL);
+  struct itimerval tick = {.it_interval = {.tv_usec = 100}, .it_value = {.tv_usec = 100}};
+  setitimer(ITIMER_REAL, &tick, NULL);
+
+  const tusb_rhport_init_t rh_init = {.role = TUSB_ROLE_HOST, .speed = TUSB_SPEED_FULL};
+  const bool ret = hcd_init(0, &rh_init);
+
+  tick = (struct itimerval) {0};
+  setitimer(ITIMER_REAL, &tick, NULL);
+  TEST_ASSERT_TRUE(ret);
+
+  dwc2->gintsts = 0;
+  dwc2->hprt = HPRT_POWER | HPRT_CONN_STATUS | HPRT_ENABLE | (HPRT_SPEED_FULL << HPRT_SPEED_Pos);
+
+  // request queues and TX FIFOs never fill up
+  const uint32_t txsts = (8u << 16) | 0x100u;
+  dwc2->hnptxsts = txsts;
+  dwc2->hptxsts = txsts;
+}
+
+// Channel halts when disabled by driver
+static void hc_halt_disabled(void) {
+  for (uint8_t ch_id = 0; ch_id < TU_ARRAY_SIZE(dwc2->channel); ch_id++) {
+    dwc2_channel_t* channel = &dwc2->channel[ch_id];
+    if ((channel->hcchar & (HCCHAR_CHENA | HCCHAR_CHDIS)) == (HCCHAR_CHENA | HCCHAR_CHDIS)) {
+      channel->hcchar &= ~(HCCHAR_CHENA | HCCHAR_CHDIS);
+      ch_int[ch_id] |= HCINT_HALTED;
+      ddma_offset[ch_id] = 0; // descriptor is left as is
+    }
+
+    ch_int[ch_id] |= rx_popped_hcint[ch_id];
+    rx_popped_hcint[ch_id] = 0;
+  }
+}
+
+// Raise pending interrupts until driver has handled all of them
+static void hc_irq(void) {
+  for (uint8_t loop = 0; loop < 32; loop++) {
+    hc_halt_disabled();
+
+    uint32_t haint = 0;
+    for (uint8_t ch_id = 0; ch_id < TU_ARRAY_SIZE(dwc2->channel); ch_id++) {
+      dwc2->channel[ch_id].hcint = ch_int[ch_id];
+      if (ch_int[ch_id] & dwc2->channel[ch_id].hcintmsk) {
+        haint |= TU_BIT(ch_id);
+      }
+    }
+    haint &= dwc2->haintmsk;
+    dwc2->haint = haint;
+
+    uint32_t gintsts = GINTSTS_CMODE_HOST;
+    if (sof_pending) {
+      gintsts |= GINTSTS_SOF;
+    }
+    if (haint) {
+      gintsts |= GINTSTS_HCINT;
+    }
+    if (rx_count) {
+      gintsts |= GINTSTS_RXFLVL;
+    }
+    dwc2->gintsts = gintsts;
+
+    if (0 == (gintsts & dwc2->gintmsk)) {
+      return;
+    }
+    hcd_int_handler(0, true);
+
+    // driver acknowledges SOF and interrupts of all channels flagged in HAINT
+    sof_pending = false;
+    for (uint8_t ch_id = 0; ch_id < TU_ARRAY_SIZE(dwc2->channel); ch_id++) {
+      if (tu_bit_test(haint, ch_id)) {
+        ch_int[ch_id] = 0;
+      }
+    }
+  }
+  TEST_FAIL_MESSAGE("interrupt storm");
+}
+
+// Channel halts by itself (DMA)
+static void hc_channel_halt(uint8_t ch_id, uint32_t hcint) {
+  dwc2->channel[ch_id].hcchar &= ~HCCHAR_CHENA;
+  ch_int[ch_id] |= hcint | HCINT_HALTED;
+}
+
+// Scatter/Gather DMA: isochronous channel services the descriptor of current frame in its list, inactive one is
+// skipped. Channel stays enabled until it is disabled or halted on error.
+static void hc_xact_iso_ddma(uint8_t ch_id) {
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  const dwc2_channel_char_t hcchar = {.value = channel->hcchar};
+  const dwc2_channel_tsize_ddma_t hctsiz = {.value = channel->hctsiz};
+  TEST_ASSERT_EQUAL(ISO_LIST_FS - 1, hctsiz.ntd);
+
+  if (frame_number == ahb_err_frame) {
+    hc_channel_halt(ch_id, HCINT_AHB_ERR);
+    return;
+  }
+
+  dwc2_host_dma_desc_t* list = (dwc2_host_dma_desc_t*) (uintptr_t) channel->hcdma;
+  dwc2_host_dma_desc_t* desc = &list[frame_number & hctsiz.ntd];
+  if (0 == (desc->status & HDESC_ACTIVE)) {
+    return;
+  }
+
+  dev_ep_t* dev = &dev_ep[hcchar.ep_num];
+  dev->xacts++;
+  const uint16_t nbytes = (uint16_t) (desc->status & HDESC_ISO_NBYTES_Msk);
+  uint32_t status = desc->status & ~(HDESC_ACTIVE | HDESC_ISO_NBYTES_Msk);
+  uint8_t* buf = (uint8_t*) (uintptr_t) desc->buf;
+
+  if (frame_number == iso_err_frame) {
+    status |= (1u << HDESC_STS_Pos) | nbytes;
+  } else if (hcchar.ep_dir == TUSB_DIR_IN) {
+    const uint16_t len = tu_min16(dev->iso_len, nbytes);
+    memset(buf, (hcchar.ep_num << 4) | dev->count, len);
+    dev->count++;
+    status |= (uint32_t) (nbytes - len); // remaining bytes
+  } else {
+    memcpy(dev_out + dev_out_len, buf, nbytes);
+    dev_out_len += nbytes;
+  }
+
+  desc->status = status;
+  if (status & HDESC_IOC) {
+    ch_int[ch_id] |= HCINT_XFER_COMPLETE;
+  }
+}
+
+// Scatter/Gather DMA: one transaction of the channel's single descriptor, core retries NAK by itself. Descriptor is
+// written back with remaining bytes when done, channel then halts at end of list.
+static void hc_xact_ddma(uint8_t ch_id) {
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  const dwc2_channel_char_t hcchar = {.value = channel->hcchar};
+  TEST_ASSERT_EQUAL(DADDR, hcchar.dev_addr);
+
+  if (hcchar.ep_type == HCCHAR_EPTYPE_ISOCHRONOUS) {
+    hc_xact_iso_ddma(ch_id);
+    return;
+  }
+
+  dwc2_channel_tsize_ddma_t hctsiz = {.value = channel->hctsiz};
+  TEST_ASSERT_EQUAL(0, hctsiz.ntd);
+  dwc2_host_dma_desc_t* desc = (dwc2_host_dma_desc_t*) (uintptr_t) channel->hcdma;
+  TEST_ASSERT_TRUE_MESSAGE(desc->status & HDESC_ACTIVE, "descriptor is not active");
+
+  dev_ep_t* dev = &dev_ep[hcchar.ep_num];
+  dev->xacts++;
+  if (dev->stall) {
+    desc->status &= ~HDESC_ACTIVE;
+    ddma_offset[ch_id] = 0;
+    hc_channel_halt(ch_id, HCINT_STALL);
+    return;
+  }
+  if (dev->pkts == 0) {
+    ch_int[ch_id] |= HCINT_NAK;
+    return;
+  }
+  TEST_ASSERT_EQUAL_MESSAGE(dev->toggle ? HCTSIZ_PID_DATA1 : HCTSIZ_PID_DATA0, hctsiz.pid, "data toggle");
+
+  uint32_t remaining = (desc->status & HDESC_NBYTES_Msk) - ddma_offset[ch_id]; // written back when done
+  const uint16_t len = (uint16_t) tu_min32(hcchar.ep_size, remaining);
+  uint8_t* buf = (uint8_t*) (uintptr_t) desc->buf + ddma_offset[ch_id];
+  if (hcchar.ep_dir == TUSB_DIR_IN) {
+    memset(buf, (hcchar.ep_num << 4) | dev->count, len);
+    dev->count++;
+  } else {
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(dev_out), dev_out_len + len);
+    memcpy(dev_out + dev_out_len, buf, len);
+    dev_out_len += len;
+  }
+  dev->pkts--;
+  dev->toggle ^= 1;
+  hctsiz.pid = dev->toggle ? HCTSIZ_PID_DATA1 : HCTSIZ_PID_DATA0;
+  channel->hctsiz = hctsiz.value;
+  ch_int[ch_id] |= HCINT_ACK;
+
+  ddma_offset[ch_id] += len;
+  remaining -= len;
+  if (remaining == 0 || len < hcchar.ep_size) {
+    const uint32_t status = desc->status;
+    desc->status = (status & ~(HDESC_ACTIVE | HDESC_NBYTES_Msk)) | remaining;
+    ddma_offset[ch_id] = 0;
+    if (status & HDESC_IOC) {
+      ch_int[ch_id] |= HCINT_XFER_COMPLETE;
+    }
+    if (status & HDESC_EOL) {
+      hc_channel_halt(ch_id, 0);
+    }
+  }
+}
+
+// One transaction of an enabled channel. Periodic channel has one per frame, scheduled by frame list in Scatter/Gather
+// DMA. Slave and buffer DMA only model IN: device NAKs or answers a max packet size packet.
+static void hc_xact(uint8_t ch_id, uint8_t slot) {
+  dwc2_channel_t* channel = &dwc2->channel[ch_id];
+  const dwc2_channel_char_t hcchar = {.value = channel->hcchar};
+  if (!hcchar.enable || hcchar.disable) {
+    return;
+  }
+
+  const bool is_periodic = (hcchar.ep_type == HCCHAR_EPTYPE_INTERRUPT || hcchar.ep_type == HCCHAR_EPTYPE_ISOCHRONOUS);
+  if (is_periodic && slot > 0) {
+    return;
+  }
+
+  if (core_mode == CORE_DDMA) {
+    if (is_periodic) {
+      const uint32_t* frame_list = (const uint32_t*) (uintptr_t) dwc2->hflbaddr;
+      if (!tu_bit_test(frame_list[frame_number % FRAME_LIST_SIZE], ch_id)) {
+        return;
+      }
+    }
+    hc_xact_ddma(ch_id);
+    return;
+  }
+
+  TEST_ASSERT_EQUAL(TUSB_DIR_IN, hcchar.ep_dir);
+  TEST_ASSERT_EQUAL(DADDR, hcchar.dev_addr);
+
+  // slave: wait until previous packet is popped from RX FIFO
+  for (uint8_t i = 0; i < rx_count; i++) {
+    if (rx_fifo[i].ch_id == ch_id) {
+      return;
+    }
+  }
+
+  dev_ep_t* dev = &dev_ep[hcchar.ep_num];
+  if (dev->pkts == 0) {
+    ch_int[ch_id] |= HCINT_NAK;
+    return;
+  }
+
+  dwc2_channel_tsize_t hctsiz = {.value = channel->hctsiz};
+  TEST_ASSERT_EQUAL_MESSAGE(dev->toggle ? HCTSIZ_PID_DATA1 : HCTSIZ_PID_DATA0, hctsiz.pid, "data toggle");
+  TEST_ASSERT_NOT_EQUAL(0, hctsiz.packet_count);
+
+  const uint16_t len = (uint16_t) tu_min32(hcchar.ep_size, hctsiz.xfer_size);
+  const uint8_t fill = (uint8_t) ((hcchar.ep_num << 4) | dev->count);
+  dev->pkts--;
+  dev->count++;
+  dev->toggle ^= 1;
+
+  hctsiz.xfer_size -= len;
+  hctsiz.packet_count--;
+  hctsiz.pid = dev->toggle ? HCTSIZ_PID_DATA1 : HCTSIZ_PID_DATA0;
+  channel->hctsiz = hctsiz.value;
+
+  const bool done = (hctsiz.packet_count == 0) || (len < hcchar.ep_size);
+  const uint32_t hcint = HCINT_ACK | (done ? HCINT_XFER_COMPLETE : 0);
+
+  if (core_mode == CORE_SLAVE) {
+    TEST_ASSERT_LESS_THAN(TU_ARRAY_SIZE(rx_fifo), rx_count);
+    rx_entry_t* rx = &rx_fifo[rx_count++];
+    rx->ch_id = ch_id;
+    rx->len   = len;
+    rx->hcint = hcint;
+    memset(rx->data, fill, len);
+
+    if (rx_count == 1) {
+      dwc2_grxstsp_t grxstsp = {.value = 0};
+      grxstsp.ep_ch_num = ch_id;
+      grxstsp.byte_count = len;
+      grxstsp.packet_status = GRXSTS_PKTSTS_RX_DATA;
+      dwc2->grxstsp = grxstsp.value;
+    }
+  } else {
+    memset((void*) (uintptr_t) channel->hcdma, fill, len);
+    channel->hcdma += len;
+    ch_int[ch_id] |= hcint;
+    if (done) {
+      hc_channel_halt(ch_id, 0); // transfer is done
+    }
+  }
+}
+
+// Run one (full-speed) frame: SOF then transaction attempts of every enabled channel
+static void hc_frame(void) {
+  frame_number++;
+  dwc2->hfnum = frame_number & HFNUM_FRNUM_Msk;
+  sof_pending = true;
+  hc_irq();
+  sof_pending = false;
+
+  for (uint8_t i = 0; i < XACT_PER_FRAME; i++) {
+    for (uint8_t ch_id = 0; ch_id < TU_ARRAY_SIZE(dwc2->channel); ch_id++) {
+      hc_xact(ch_id, i);
+    }
+    hc_irq();
+  }
+}
+
+static void hc_run(uint32_t frames) {
+  for (uint32_t i = 0; i < frames; i++) {
+    hc_frame();
+  }
+}
+
+// endpoint whose transfer is on channel, 0 if channel is not enabled
+static uint8_t channel_owner(uint8_t ch_id) {
+  const dwc2_channel_char_t hcchar = {.value = dwc2->channel[ch_id].hcchar};
+  return hcchar.enable ? tu_edpt_addr(hcchar.ep_num, hcchar.ep_dir) : 0;
+}
+
+static void open_edpt(uint8_t ep_addr, uint8_t xfer_type, uint8_t interval) {
+  tusb_desc_endpoint_t const desc = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = ep_addr,
+    .bmAttributes     = { .xfer = xfer_type },
+    .wMaxPacketSize   = MPS,
+    .bInterval        = interval,
+  };
+  TEST_ASSERT_TRUE(hcd_edpt_open(0, DADDR, &desc));
+}
+
+static void open_bulk(uint8_t ep_addr) {
+  open_edpt(ep_addr, TUSB_XFER_BULK, 0);
+}
+
+static void check_xfer_result(const hcd_event_t* event, uint8_t ep_addr, uint32_t len, xfer_result_t result) {
+  TEST_ASSERT_EQUAL(HCD_EVENT_XFER_COMPLETE, event->event_id);
+  TEST_ASSERT_EQUAL(DADDR, event->dev_addr);
+  TEST_ASSERT_EQUAL_HEX8(ep_addr, event->xfer_complete.ep_addr);
+  TEST_ASSERT_EQUAL(result, event->xfer_complete.result);
+  TEST_ASSERT_EQUAL(len, event->xfer_complete.len);
+}
+
+static void check_xfer_complete(const hcd_event_t* event, uint8_t ep_addr, uint32_t len) {
+  check_xfer_result(event, ep_addr, len, XFER_RESULT_SUCCESS);
+}
+
+// Scatter/Gather DMA: driver's descriptor list of a channel and periodic frame list
+static dwc2_host_dma_desc_t* channel_desc(uint8_t ch_id) {
+  return (dwc2_host_dma_desc_t*) (uintptr_t) dwc2->channel[ch_id].hcdma;
+}
+
+static const uint32_t* frame_list(void) {
+  return (const uint32_t*) (uintptr_t) dwc2->hflbaddr;
+}
+
+static void check_frame_list(uint8_t ch_id, uint8_t period, uint8_t phase) {
+  for (uint8_t i = 0; i < FRAME_LIST_SIZE; i++) {
+    const bool scheduled = (period > 0) && (i % period == phase);
+    TEST_ASSERT_EQUAL_MESSAGE(scheduled, tu_bit_test(frame_list()[i], ch_id), "frame list");
+  }
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+void setUp(void) {
+  if (dwc2 == NULL) {
+    void* regs = mmap((void*) DWC2_REG_BASE, sizeof(dwc2_regs_t), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    TEST_ASSERT_EQUAL_PTR(DWC2_REG_BASE, regs);
+    dwc2 = (dwc2_regs_t*) regs;
+  }
+
+  memset(dev_ep, 0, sizeof(dev_ep));
+  memset(ch_int, 0, sizeof(ch_int));
+  memset(rx_popped_hcint, 0, sizeof(rx_popped_hcint));
+  memset(ddma_offset, 0, sizeof(ddma_offset));
+  memset(dev_out, 0, sizeof(dev_out));
+  dev_out_len = 0;
+  iso_err_frame = UINT32_MAX;
+  ahb_err_frame = UINT32_MAX;
+  memset(buf_a, 0, sizeof(buf_a));
+  memset(buf_b, 0, sizeof(buf_b));
+  rx_count = 0;
+  frame_number = 0;
+  sof_pending = false;
+  event_count = 0;
+
+  bus_info = (tuh_bus_info_t) { .rhport = 0, .hub_addr = 0, .hub_port = 0, .speed = TUSB_SPEED_FULL };
+  tuh_bus_info_get_StubWithCallback(bus_info_get_cb);
+}
+
+void tearDown(void) {
+}
+
+// Transfer that cannot be queued for a channel is reported to caller
+void test_xfer_ready_queue_full(void) {
+  hc_init(CORE_SLAVE, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  for (uint8_t i = 0; i < CFG_TUH_DWC2_ENDPOINT_MAX; i++) {
+    TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+  }
+  TEST_ASSERT_FALSE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+}
+
+// Channel NAKing for NAK_PREEMPT_FRAMES frames is given to the endpoint waiting for it
+void test_nak_preempt_budget(void) {
+  hc_init(CORE_SLAVE, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+  dev_ep[2].pkts = 1;
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+
+  // first SOF takes the transfer size as reference, budget runs from there
+  hc_frame();
+  for (uint8_t i = 0; i < NAK_PREEMPT_FRAMES; i++) {
+    TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+    hc_frame();
+  }
+
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_B, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x20, buf_b, MPS);
+
+  // preempted endpoint takes the channel back
+  TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+}
+
+// A packet received within the budget restarts it, transfer keeps its channel until done
+void test_nak_preempt_progress_restarts_budget(void) {
+  hc_init(CORE_SLAVE, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+  dev_ep[2].pkts = 1;
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, 4 * MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+
+  for (uint8_t i = 0; i < 4; i++) {
+    dev_ep[1].pkts = 1;
+    hc_run(NAK_PREEMPT_FRAMES);
+  }
+
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[0], EP_A, 4 * MPS);
+  check_xfer_complete(&events[1], EP_B, MPS);
+}
+
+// Without endpoint waiting for a channel, a NAKing transfer is never preempted and SOF interrupt is off
+void test_nak_preempt_none_waiting(void) {
+  hc_init(CORE_SLAVE, 1);
+  open_bulk(EP_A);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  hc_run(10 * NAK_PREEMPT_FRAMES);
+
+  TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+  TEST_ASSERT_EQUAL_HEX32(0, dwc2->gintmsk & GINTMSK_SOFM);
+
+  dev_ep[1].pkts = 1;
+  hc_frame();
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_A, MPS);
+}
+
+// NAKing endpoints take turns on a single channel
+void test_nak_preempt_round_robin(void) {
+  hc_init(CORE_SLAVE, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+  open_bulk(EP_C);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_C, buf_b + MPS, MPS));
+
+  // each holds the channel for the reference frame and the budget
+  const uint8_t owner[] = { EP_A, EP_A, EP_B, EP_B, EP_B, EP_C, EP_C, EP_C, EP_A, EP_A, EP_A, EP_B };
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(owner); i++) {
+    hc_frame();
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(owner[i], channel_owner(0), "frame");
+  }
+  TEST_ASSERT_EQUAL(0, event_count);
+}
+
+// Preempted transfer resumes after bytes already received, with the data toggle where it stopped
+static void xfer_preempt_resume(core_mode_t mode) {
+  hc_init(mode, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+  dev_ep[1].pkts = 1;
+  dev_ep[2].pkts = 1;
+
+  // even packet count: PID precomputed for the next transfer differs from the one in the middle of this transfer
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, 4 * MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+
+  // 1st packet of A, then budget from the next SOF
+  hc_run(2 + NAK_PREEMPT_FRAMES);
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_B, MPS);
+
+  // A is back on channel for the remaining 3 packets starting with DATA1
+  TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+  const dwc2_channel_tsize_t hctsiz = {.value = dwc2->channel[0].hctsiz};
+  TEST_ASSERT_EQUAL(3 * MPS, hctsiz.xfer_size);
+  TEST_ASSERT_EQUAL(3, hctsiz.packet_count);
+  TEST_ASSERT_EQUAL(HCTSIZ_PID_DATA1, hctsiz.pid);
+  if (mode == CORE_DMA) {
+    TEST_ASSERT_EQUAL_HEX32((uint32_t) (uintptr_t) (buf_a + MPS), dwc2->channel[0].hcdma);
+  }
+
+  dev_ep[1].pkts = 3;
+  hc_frame();
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[1], EP_A, 4 * MPS); // carried bytes are included
+  for (uint8_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EACH_EQUAL_HEX8(0x10 + i, buf_a + i * MPS, MPS);
+  }
+}
+
+void test_xfer_preempt_resume_slave(void) {
+  xfer_preempt_resume(CORE_SLAVE);
+}
+
+void test_xfer_preempt_resume_dma(void) {
+  xfer_preempt_resume(CORE_DMA);
+}
+
+//--------------------------------------------------------------------+
+// Scatter/Gather DMA
+//--------------------------------------------------------------------+
+
+// Transfer takes a single descriptor, the core retries NAK on its own and writes back the remaining bytes when done
+void test_ddma_bulk_in(void) {
+  hc_init(CORE_DDMA, 1);
+  TEST_ASSERT_EQUAL_HEX32(HCFG_DESCDMA | HCFG_FRLISTEN_64 | HCFG_PERSCHEDENA,
+                          dwc2->hcfg & (HCFG_DESCDMA | HCFG_FRLISTEN | HCFG_PERSCHEDENA));
+  TEST_ASSERT_NOT_EQUAL(0, dwc2->hflbaddr);
+  TEST_ASSERT_EQUAL(0, dwc2->hflbaddr % 512);
+
+  open_bulk(EP_A);
+  dev_ep[1].pkts = 2;
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, 150));
+  const dwc2_host_dma_desc_t* desc = channel_desc(0);
+  TEST_ASSERT_EQUAL(0, dwc2->channel[0].hcdma % 512);
+  TEST_ASSERT_EQUAL_HEX32((uint32_t) (uintptr_t) buf_a, desc->buf);
+  TEST_ASSERT_EQUAL_HEX32(HDESC_ACTIVE | HDESC_IOC | HDESC_EOL | 150, desc->status);
+  TEST_ASSERT_EQUAL_HEX32(HCINT_HALTED, dwc2->channel[0].hcintmsk);
+
+  // device NAKs after 2 packets: no interrupt, descriptor stays active
+  hc_run(3);
+  TEST_ASSERT_EQUAL(0, event_count);
+  TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+  TEST_ASSERT_TRUE(desc->status & HDESC_ACTIVE);
+
+  dev_ep[1].pkts = 1;
+  hc_frame();
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_A, 150);
+  TEST_ASSERT_EQUAL_HEX32(HDESC_IOC | HDESC_EOL, desc->status);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x10, buf_a, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x11, buf_a + MPS, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x12, buf_a + 2 * MPS, 150 - 2 * MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0, buf_a + 150, sizeof(buf_a) - 150);
+
+  // odd packet count: next transfer starts with DATA1 saved from halted channel
+  dev_ep[1].pkts = 1;
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_b, MPS));
+  hc_frame();
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[1], EP_A, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x13, buf_b, MPS);
+}
+
+void test_ddma_bulk_out(void) {
+  hc_init(CORE_DDMA, 1);
+  open_bulk(EP_OUT);
+  for (uint8_t i = 0; i < 100; i++) {
+    buf_b[i] = i;
+  }
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_OUT, buf_b, 100));
+  hc_run(2);
+  TEST_ASSERT_EQUAL(0, event_count);
+  TEST_ASSERT_EQUAL(2 * XACT_PER_FRAME, dev_ep[1].xacts);
+
+  dev_ep[1].pkts = 2;
+  hc_frame();
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_OUT, 100);
+  TEST_ASSERT_EQUAL(100, dev_out_len);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(buf_b, dev_out, 100);
+}
+
+// Interrupt channel is serviced once in every bInterval-th frame of the frame list, and removed from it when halted
+void test_ddma_interrupt_frame_list(void) {
+  hc_init(CORE_DDMA, 2);
+  open_bulk(EP_A);
+  open_edpt(EP_C, TUSB_XFER_INTERRUPT, 4);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_C, buf_b, MPS));
+  TEST_ASSERT_EQUAL_HEX8(EP_C, channel_owner(1));
+
+  // channels of the same period are spread over frames by channel number, non-periodic ones are not in the list
+  check_frame_list(1, 4, 1);
+  check_frame_list(0, 0, 0);
+
+  hc_run(8);
+  TEST_ASSERT_EQUAL(2, dev_ep[3].xacts);
+  TEST_ASSERT_EQUAL(0, event_count);
+
+  dev_ep[3].pkts = 1;
+  hc_run(4);
+  TEST_ASSERT_EQUAL(3, dev_ep[3].xacts);
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_C, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x30, buf_b, MPS);
+
+  check_frame_list(1, 0, 0);
+  TEST_ASSERT_EQUAL_HEX8(0, channel_owner(1));
+  TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+}
+
+// Channel halted before its descriptor is done is released without completion
+void test_ddma_abort(void) {
+  hc_init(CORE_DDMA, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  hc_run(2);
+  const dwc2_host_dma_desc_t* desc = channel_desc(0);
+
+  TEST_ASSERT_TRUE(hcd_edpt_abort_xfer(0, DADDR, EP_A));
+  hc_irq();
+  TEST_ASSERT_EQUAL(0, event_count);
+  TEST_ASSERT_TRUE(desc->status & HDESC_ACTIVE);
+  TEST_ASSERT_EQUAL_HEX8(0, channel_owner(0));
+
+  // channel is free for the next transfer
+  dev_ep[2].pkts = 1;
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+  hc_frame();
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_B, MPS);
+}
+
+void test_ddma_stall(void) {
+  hc_init(CORE_DDMA, 1);
+  open_bulk(EP_A);
+  dev_ep[1].stall = 1;
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  hc_frame();
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_result(&events[0], EP_A, 0, XFER_RESULT_STALLED);
+  TEST_ASSERT_EQUAL_HEX8(0, channel_owner(0));
+}
+
+// A NAKing transfer keeps its channel: progress of an active descriptor is unknown
+void test_ddma_no_nak_preempt(void) {
+  hc_init(CORE_DDMA, 1);
+  open_bulk(EP_A);
+  open_bulk(EP_B);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_A, buf_a, MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_B, buf_b, MPS));
+  for (uint8_t i = 0; i < 4 * NAK_PREEMPT_FRAMES; i++) {
+    hc_frame();
+    TEST_ASSERT_EQUAL_HEX8(EP_A, channel_owner(0));
+  }
+  TEST_ASSERT_EQUAL(0, dev_ep[2].xacts);
+
+  dev_ep[1].pkts = 1;
+  dev_ep[2].pkts = 1;
+  hc_frame();
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[0], EP_A, MPS);
+  check_xfer_complete(&events[1], EP_B, MPS);
+}
+
+// Isochronous list is indexed by frame number: queued transfers are back to back, a lost packet only fails itself
+void test_ddma_iso_in(void) {
+  hc_init(CORE_DDMA, 1);
+  open_edpt(EP_D, TUSB_XFER_ISOCHRONOUS, 1);
+  dev_ep[4].iso_len = MPS - 4;
+  tu_iso_packet_t packets[3] = {{.length = MPS}, {.length = MPS}, {.length = MPS}};
+
+  // stream starts 2 frames ahead, second transfer follows the first one
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_D, buf_a, 3 * MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_iso_xfer(0, DADDR, EP_D, buf_b, packets, 3));
+  TEST_ASSERT_EQUAL_HEX8(EP_D, channel_owner(0));
+  TEST_ASSERT_EQUAL_HEX32(HCINT_XFER_COMPLETE | HCINT_HALTED, dwc2->channel[0].hcintmsk);
+  check_frame_list(0, 1, 0);
+
+  const dwc2_host_dma_desc_t* list = channel_desc(0);
+  for (uint8_t i = 0; i < ISO_LIST_FS; i++) {
+    const bool active = (i >= 2 && i < 8);
+    TEST_ASSERT_EQUAL_MESSAGE(active, (list[i].status & HDESC_ACTIVE) != 0, "active");
+    TEST_ASSERT_EQUAL_MESSAGE(i == 4 || i == 7, (list[i].status & HDESC_IOC) != 0, "ioc");
+  }
+  TEST_ASSERT_EQUAL_HEX32((uint32_t) (uintptr_t) (buf_a + MPS), list[3].buf);
+  TEST_ASSERT_EQUAL_HEX32((uint32_t) (uintptr_t) (buf_b + 2 * MPS), list[7].buf);
+
+  iso_err_frame = 6;
+  hc_run(4);
+  TEST_ASSERT_EQUAL(1, event_count);
+  check_xfer_complete(&events[0], EP_D, 3 * (MPS - 4));
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EACH_EQUAL_HEX8(0x40 + i, buf_a + i * MPS, MPS - 4);
+  }
+
+  hc_run(3);
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[1], EP_D, 2 * (MPS - 4));
+  TEST_ASSERT_EQUAL(MPS - 4, packets[0].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, packets[0].result);
+  TEST_ASSERT_EQUAL(0, packets[1].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_FAILED, packets[1].result);
+  TEST_ASSERT_EQUAL(MPS - 4, packets[2].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, packets[2].result);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x43, buf_b, MPS - 4);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x44, buf_b + 2 * MPS, MPS - 4);
+
+  // channel keeps servicing the list, retired descriptors are inactive
+  TEST_ASSERT_EQUAL_HEX8(EP_D, channel_owner(0));
+  for (uint8_t i = 0; i < ISO_LIST_FS; i++) {
+    TEST_ASSERT_EQUAL_HEX32(0, list[i].status);
+  }
+  hc_run(2);
+  TEST_ASSERT_EQUAL(2, event_count);
+}
+
+// Channel halted on AHB error retires all queued transfers, then next transfer restarts the stream
+void test_ddma_iso_ahb_error(void) {
+  hc_init(CORE_DDMA, 1);
+  open_edpt(EP_D, TUSB_XFER_ISOCHRONOUS, 1);
+  dev_ep[4].iso_len = MPS;
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_D, buf_a, 3 * MPS));
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_D, buf_b, 3 * MPS));
+
+  ahb_err_frame = 3;
+  hc_run(3);
+  TEST_ASSERT_EQUAL(2, event_count);
+  check_xfer_complete(&events[0], EP_D, MPS); // first packet made it through
+  check_xfer_result(&events[1], EP_D, 0, XFER_RESULT_FAILED);
+  TEST_ASSERT_EQUAL_HEX8(0, channel_owner(0));
+  check_frame_list(0, 0, 0);
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_D, buf_b, MPS));
+  TEST_ASSERT_EQUAL_HEX8(EP_D, channel_owner(0));
+  check_frame_list(0, 1, 0);
+  hc_run(8);
+  TEST_ASSERT_EQUAL(3, event_count);
+  check_xfer_complete(&events[2], EP_D, MPS);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x41, buf_b, MPS);
+}
@@ -0,0 +1,303 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "hcd.h"
+#include "ehci_api.h"
+#include "ehci.h"
+TEST_SOURCE_FILE("ehci.c")
+
+// Mock File
+#include "mock_usbh.h"
+
+// EHCI structures hold 32-bit addresses: the test executable is linked with -no-pie so that its static data (driver
+// pools, registers below and transfer buffers) is addressable by the software controller model.
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+
+// frame list size used by ehci.c for ChipIdea (OPT_MCU_LPC18XX)
+#define FRAMELIST_SIZE  8
+
+enum {
+  DADDR = 1,
+  EP_IN = 0x81,
+};
+
+static ehci_cap_registers_t cap_regs;
+static ehci_registers_t op_regs;
+
+static tuh_bus_info_t bus_info;
+
+// Device side: bytes answered to each IN packet, frames the controller does not service
+static uint16_t dev_in_len[32];
+static uint8_t dev_pkt;
+static uint32_t missed_frames; // bitmap of frame numbers
+
+static uint8_t buffer[2048] TU_ATTR_ALIGNED(4);
+
+// Completion events reported by the driver
+static hcd_event_t events[4];
+static uint8_t event_count;
+
+//--------------------------------------------------------------------+
+// Stubs
+//--------------------------------------------------------------------+
+void hcd_event_handler(hcd_event_t const* event, bool in_isr) {
+  (void) in_isr;
+  TEST_ASSERT_LESS_THAN(TU_ARRAY_SIZE(events), event_count);
+  events[event_count++] = *event;
+}
+
+void usbh_spin_lock(bool in_isr) {
+  (void) in_isr;
+}
+
+void usbh_spin_unlock(bool in_isr) {
+  (void) in_isr;
+}
+
+static bool bus_info_get_cb(uint8_t daddr, tuh_bus_info_t* info, int cmock_num_calls) {
+  (void) daddr;
+  (void) cmock_num_calls;
+  *info = bus_info;
+  return true;
+}
+
+//--------------------------------------------------------------------+
+// Controller model: execute iTD/siTD linked in the frame list slot of the current frame
+//--------------------------------------------------------------------+
+static uint32_t frame_number;
+
+// device fills each IN packet with its packet index
+static void dev_in(uint8_t* dst, uint16_t len) {
+  memset(dst, 0x10 + dev_pkt, len);
+  dev_pkt++;
+}
+
+static void hc_itd(ehci_itd_t* itd) {
+  for (uint8_t u = 0; u < 8; u++) {
+    if (!itd->xact[u].active) {
+      continue;
+    }
+    uint32_t const page = itd->BufferPointer[itd->xact[u].page_select] & ~0xfffu;
+    uint8_t* dst = (uint8_t*) (uintptr_t) (page + itd->xact[u].offset);
+    uint16_t const len = tu_min16(dev_in_len[dev_pkt], (uint16_t) itd->xact[u].length);
+
+    dev_in(dst, len);
+    itd->xact[u].length = len;
+    itd->xact[u].active = 0;
+    if (itd->xact[u].int_on_complete) {
+      op_regs.status |= EHCI_INT_MASK_USB;
+    }
+  }
+}
+
+static void hc_sitd(ehci_sitd_t* sitd) {
+  if (!sitd->active) {
+    return;
+  }
+  uint8_t* dst = (uint8_t*) (uintptr_t) sitd->buffer[0];
+  uint16_t const len = tu_min16(dev_in_len[dev_pkt], (uint16_t) sitd->total_bytes);
+
+  dev_in(dst, len);
+  sitd->total_bytes -= len;
+  sitd->active = 0;
+  if (sitd->int_on_complete) {
+    op_regs.status |= EHCI_INT_MASK_USB;
+  }
+}
+
+// Run one frame then raise interrupts of this frame, frame index advances to the next frame afterwards
+static void hc_run_frame(void) {
+  ehci_link_t const* framelist = (ehci_link_t const*) (uintptr_t) op_regs.periodic_list_base;
+  ehci_link_t link = framelist[(op_regs.frame_index >> 3) % FRAMELIST_SIZE];
+
+  if (!tu_bit_test(missed_frames, frame_number)) {
+    while (!link.terminate && (link.type == EHCI_QTYPE_ITD || link.type == EHCI_QTYPE_SITD)) {
+      void* td = (void*) (uintptr_t) (link.address & ~0x1fu);
+      if (link.type == EHCI_QTYPE_ITD) {
+        hc_itd((ehci_itd_t*) td);
+      } else {
+        hc_sitd((ehci_sitd_t*) td);
+      }
+      link = *(ehci_link_t const*) td;
+    }
+  }
+
+  if (op_regs.status & EHCI_INT_MASK_ALL) {
+    hcd_int_handler(0, true);
+  }
+  op_regs.status = EHCI_INT_MASK_PERIODIC_SCHED_STATUS | EHCI_INT_MASK_ASYNC_SCHED_STATUS; // W1C acknowledged
+
+  frame_number++;
+  op_regs.frame_index += 8;
+  if (op_regs.frame_index == FRAMELIST_SIZE * 8) {
+    op_regs.frame_index = 0;
+    op_regs.status |= EHCI_INT_MASK_FRAMELIST_ROLLOVER;
+  }
+}
+
+// run until a completion event or frame limit
+static void hc_run(uint32_t max_frames) {
+  for (uint32_t i = 0; i < max_frames && event_count == 0; i++) {
+    hc_run_frame();
+  }
+}
+
+static void open_iso(uint8_t ep_addr, uint16_t mps, uint8_t interval) {
+  tusb_desc_endpoint_t const desc = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = ep_addr,
+    .bmAttributes     = { .xfer = TUSB_XFER_ISOCHRONOUS },
+    .wMaxPacketSize   = mps,
+    .bInterval        = interval,
+  };
+  TEST_ASSERT_TRUE(hcd_edpt_open(0, DADDR, &desc));
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+void setUp(void) {
+  memset((void*) (uintptr_t) &cap_regs, 0, sizeof(cap_regs));
+  memset((void*) (uintptr_t) &op_regs, 0, sizeof(op_regs));
+  memset(dev_in_len, 0, sizeof(dev_in_len));
+  memset(buffer, 0, sizeof(buffer));
+  dev_pkt = 0;
+  missed_frames = 0;
+  frame_number = 0;
+  event_count = 0;
+
+  bus_info = (tuh_bus_info_t) { .rhport = 0, .hub_addr = 0, .hub_port = 0, .speed = TUSB_SPEED_HIGH };
+  tuh_bus_info_get_StubWithCallback(bus_info_get_cb);
+
+  TEST_ASSERT_TRUE(ehci_init(0, (uint32_t) (uintptr_t) &cap_regs, (uint32_t) (uintptr_t) &op_regs));
+  op_regs.status = EHCI_INT_MASK_PERIODIC_SCHED_STATUS | EHCI_INT_MASK_ASYNC_SCHED_STATUS;
+}
+
+void tearDown(void) {
+}
+
+// Highspeed IN submitted without packet list: short packets are moved together so that the buffer holds the
+// reported bytes contiguously
+void test_itd_in_short_packets_compacted(void) {
+  open_iso(EP_IN, 64, 1); // every micro-frame: 8 packets per iTD
+
+  uint16_t const lens[10] = { 64, 10, 64, 0, 30, 64, 64, 5, 64, 20 };
+  memcpy(dev_in_len, lens, sizeof(lens));
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_IN, buffer, sizeof(lens) / 2 * 64));
+  hc_run(8);
+
+  TEST_ASSERT_EQUAL(1, event_count);
+  TEST_ASSERT_EQUAL(HCD_EVENT_XFER_COMPLETE, events[0].event_id);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, events[0].xfer_complete.result);
+
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < 10; i++) {
+    for (uint16_t b = 0; b < lens[i]; b++) {
+      TEST_ASSERT_EQUAL_HEX8(0x10 + i, buffer[total + b]);
+    }
+    total += lens[i];
+  }
+  TEST_ASSERT_EQUAL(total, events[0].xfer_complete.len);
+}
+
+// Full-speed IN (siTD) submitted without packet list is compacted the same way
+void test_sitd_in_short_packets_compacted(void) {
+  bus_info.speed    = TUSB_SPEED_FULL;
+  bus_info.hub_addr = 2;
+  bus_info.hub_port = 1;
+  open_iso(EP_IN, 192, 1);
+
+  uint16_t const lens[3] = { 100, 192, 50 };
+  memcpy(dev_in_len, lens, sizeof(lens));
+
+  TEST_ASSERT_TRUE(hcd_edpt_xfer(0, DADDR, EP_IN, buffer, 3 * 192));
+  hc_run(8);
+
+  TEST_ASSERT_EQUAL(1, event_count);
+  TEST_ASSERT_EQUAL(342, events[0].xfer_complete.len);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x10, buffer, 100);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x11, buffer + 100, 192);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x12, buffer + 292, 50);
+}
+
+// A TD missed in the middle of a transfer is retired by the interrupt of the last TD: its frame is already past
+void test_missed_td_retired_on_next_interrupt(void) {
+  open_iso(EP_IN, 64, 4); // once per frame: one packet per iTD
+
+  tu_iso_packet_t packets[3] = { { .length = 64 }, { .length = 64 }, { .length = 64 } };
+  dev_in_len[0] = 64;
+  dev_in_len[1] = 32;
+
+  TEST_ASSERT_TRUE(hcd_edpt_iso_xfer(0, DADDR, EP_IN, buffer, packets, 3));
+
+  // transfer starts 2 frames ahead, the 2nd TD is missed
+  missed_frames = TU_BIT(3);
+  for (uint8_t i = 0; i < 5; i++) {
+    hc_run_frame();
+  }
+
+  TEST_ASSERT_EQUAL(1, event_count);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, events[0].xfer_complete.result);
+  TEST_ASSERT_EQUAL(96, events[0].xfer_complete.len);
+
+  TEST_ASSERT_EQUAL(64, packets[0].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, packets[0].result);
+  TEST_ASSERT_EQUAL(0, packets[1].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_FAILED, packets[1].result);
+  TEST_ASSERT_EQUAL(32, packets[2].actual_len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, packets[2].result);
+}
+
+// Missed last TD raises no interrupt: transfer is retired by frame list rollover at the latest
+void test_missed_last_td_retired_on_rollover(void) {
+  open_iso(EP_IN, 64, 4);
+
+  tu_iso_packet_t packets[2] = { { .length = 64 }, { .length = 64 } };
+  dev_in_len[0] = 64;
+
+  TEST_ASSERT_TRUE(hcd_edpt_iso_xfer(0, DADDR, EP_IN, buffer, packets, 2));
+
+  missed_frames = TU_BIT(3);
+  for (uint8_t i = 0; i < FRAMELIST_SIZE - 1; i++) {
+    hc_run_frame();
+  }
+  TEST_ASSERT_EQUAL(0, event_count);
+
+  hc_run(2);
+  TEST_ASSERT_EQUAL(1, event_count);
+  TEST_ASSERT_EQUAL(64, events[0].xfer_complete.len);
+  TEST_ASSERT_EQUAL(XFER_RESULT_FAILED, packets[1].result);
+}
@@ -0,0 +1,523 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+#include "usbh.h"
+#include "hub.h"
+TEST_SOURCE_FILE("usbh.c")
+
+// Mock File
+#include "mock_hcd.h"
+#define HCD_MODEL_NO_CONTROL
+#include "hcd_device_model.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+// usbh and hub driver run on top of mock hcd. The hcd callbacks below model a full speed hub on root port with
+// vendor devices (desc_device of hcd_device_model.h) plugged into its ports: each one answers control requests sent
+// to its current address.
+
+enum {
+  RHPORT    = 0,
+  HUB_ADDR  = CFG_TUH_DEVICE_MAX + 1,
+  HUB_PORTS = 4,
+  HUB_EP    = 0x81,
+  LOG_MAX   = 128,
+};
+
+static tusb_desc_device_t const desc_device_hub = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = TUSB_CLASS_HUB,
+  .bDeviceSubClass    = 0,
+  .bDeviceProtocol    = HUB_PROTOCOL_FULL_SPEED,
+  .bMaxPacketSize0    = 64,
+  .idVendor           = 0xCafe,
+  .idProduct          = 0x4010,
+  .bcdDevice          = 0x0100,
+  .iManufacturer      = 0,
+  .iProduct           = 0,
+  .iSerialNumber      = 0,
+  .bNumConfigurations = 1,
+};
+
+static uint8_t const desc_configuration_hub[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(9 + 9 + 7), 1, 1, 0, TU_BIT(7), 50,
+  9, TUSB_DESC_INTERFACE, 0, 0, 1, TUSB_CLASS_HUB, 0, 0, 0,
+  7, TUSB_DESC_ENDPOINT, HUB_EP, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(1), 255,
+};
+
+static hub_desc_cs_t const desc_hub = {
+  .bLength             = sizeof(hub_desc_cs_t),
+  .bDescriptorType     = 0x29,
+  .bNbrPorts           = HUB_PORTS,
+  .wHubCharacteristics = 0,
+  .bPwrOn2PwrGood      = 1,
+  .bHubContrCurrent    = 0,
+  .DeviceRemovable     = 0,
+  .PortPwrCtrlMask     = 0xff,
+};
+
+// vendor interface without endpoint, no class driver binds to it
+static uint8_t const desc_configuration_vendor[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(9 + 9), 1, 1, 0, TU_BIT(7), 50,
+  9, TUSB_DESC_INTERFACE, 0, 0, 0, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0,
+};
+
+//--------------------------------------------------------------------+
+// Bus model
+//--------------------------------------------------------------------+
+enum {
+  ADDR_NONE = 0xff, // not reachable: unplugged or its port is not reset yet
+};
+
+// model[0] is the hub on root port, model[n] is the device on hub port n
+typedef struct {
+  bool present;
+  uint8_t addr;
+  bool ctrl_held;
+  uint8_t vendor_count; // vendor requests received
+  tusb_control_request_t request; // last setup
+} model_device_t;
+
+static model_device_t model[1 + HUB_PORTS];
+static hub_port_status_response_t port_status[1 + HUB_PORTS]; // index 0 is the hub status (hub_status_response_t layout)
+
+static bool ctrl_hold; // vendor requests are not completed by the device
+static uint8_t addr0_conflict; // port reset while another device still answers on address 0
+
+// hub interrupt endpoint
+static uint8_t* int_buf;
+static uint8_t int_arm_count;
+
+// control requests received by the hub
+static tusb_control_request_t hub_log[LOG_MAX];
+static uint8_t hub_log_count;
+
+static model_device_t* model_find(uint8_t daddr) {
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(model); i++) {
+    if (model[i].present && model[i].addr == daddr) {
+      return &model[i];
+    }
+  }
+  return NULL;
+}
+
+// hub class request, return data for IN request
+static uint8_t const* hub_request(tusb_control_request_t const* req, uint16_t* len) {
+  TEST_ASSERT_TRUE(hub_log_count < LOG_MAX);
+  hub_log[hub_log_count++] = *req;
+
+  uint8_t const port = (uint8_t) req->wIndex;
+  TEST_ASSERT_TRUE(port <= HUB_PORTS);
+  hub_port_status_response_t* ps = &port_status[port];
+
+  switch (req->bRequest) {
+    case HUB_REQUEST_GET_DESCRIPTOR:
+      *len = sizeof(desc_hub);
+      return (uint8_t const*) &desc_hub;
+
+    case HUB_REQUEST_GET_STATUS:
+      *len = 4;
+      return (uint8_t const*) ps;
+
+    case HUB_REQUEST_SET_FEATURE:
+      if (req->wValue == HUB_FEATURE_PORT_POWER) {
+        ps->status.port_power = 1;
+      } else if (req->wValue == HUB_FEATURE_PORT_RESET) {
+        // reset completes right away, device now answers on address 0
+        if (model_find(0) != NULL) {
+          addr0_conflict++;
+        }
+        ps->status.port_enable = 1;
+        ps->change.reset = 1;
+        if (model[port].present) {
+          model[port].addr = 0;
+        }
+      }
+      break;
+
+    case HUB_REQUEST_CLEAR_FEATURE:
+      if (port == 0) {
+        ps->change.value &= (uint16_t) ~TU_BIT(req->wValue);
+      } else if (req->wValue >= HUB_FEATURE_PORT_CONNECTION_CHANGE) {
+        ps->change.value &= (uint16_t) ~TU_BIT(req->wValue - HUB_FEATURE_PORT_CONNECTION_CHANGE);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  *len = 0;
+  return NULL;
+}
+
+// data to answer a control IN request of a device, NULL if request has no data
+static uint8_t const* device_response(model_device_t* dev, uint16_t* len) {
+  tusb_control_request_t const* req = &dev->request;
+  bool const is_hub = (dev == &model[0]);
+
+  if (req->bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS && is_hub) {
+    return hub_request(req, len);
+  }
+
+  *len = 0;
+  if (req->bmRequestType_bit.type != TUSB_REQ_TYPE_STANDARD) {
+    return NULL;
+  }
+
+  switch (req->bRequest) {
+    case TUSB_REQ_GET_DESCRIPTOR:
+      switch (tu_u16_high(req->wValue)) {
+        case TUSB_DESC_DEVICE:
+          *len = sizeof(tusb_desc_device_t);
+          return is_hub ? (uint8_t const*) &desc_device_hub : (uint8_t const*) &desc_device;
+        case TUSB_DESC_CONFIGURATION:
+          *len = is_hub ? sizeof(desc_configuration_hub) : sizeof(desc_configuration_vendor);
+          return is_hub ? desc_configuration_hub : desc_configuration_vendor;
+        case TUSB_DESC_STRING:
+          *len = sizeof(desc_langid);
+          return desc_langid;
+        default:
+          return NULL;
+      }
+
+    case TUSB_REQ_SET_ADDRESS:
+      dev->addr = (uint8_t) req->wValue;
+      return NULL;
+
+    default:
+      return NULL;
+  }
+}
+
+static void port_reset_cb(uint8_t rhport, int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  model[0].addr = 0;
+}
+
+static bool setup_send_cb(uint8_t rhport, uint8_t daddr, uint8_t const setup_packet[8], int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  model_device_t* dev = model_find(daddr);
+  if (dev == NULL) {
+    hcd_event_xfer_complete(daddr, 0x00, 0, XFER_RESULT_FAILED, false); // no device answers on this address
+    return true;
+  }
+
+  memcpy(&dev->request, setup_packet, 8);
+  if (dev->request.bmRequestType_bit.type == TUSB_REQ_TYPE_VENDOR) {
+    dev->vendor_count++;
+    dev->ctrl_held = ctrl_hold;
+  }
+  if (!dev->ctrl_held) {
+    hcd_event_xfer_complete(daddr, 0x00, 8, XFER_RESULT_SUCCESS, false);
+  }
+  return true;
+}
+
+static bool edpt_xfer_cb(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen,
+                         int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+
+  if (daddr == HUB_ADDR && ep_addr == HUB_EP) {
+    int_buf = buffer;
+    int_arm_count++;
+    return true;
+  }
+
+  TEST_ASSERT_EQUAL(0, tu_edpt_number(ep_addr));
+  model_device_t* dev = model_find(daddr);
+  TEST_ASSERT_NOT_NULL(dev);
+
+  // response is computed once per request at data stage, or at status stage if there is no data
+  uint16_t len = buflen;
+  bool const is_data = (dev->request.wLength > 0) && (ep_addr == (uint8_t) tu_edpt_addr(0, dev->request.bmRequestType_bit.direction));
+  if (is_data || dev->request.wLength == 0) {
+    uint16_t resp_len;
+    uint8_t const* resp = device_response(dev, &resp_len);
+    if (is_data && ep_addr == 0x80) {
+      len = tu_min16(buflen, resp_len);
+      memcpy(buffer, resp, len);
+    }
+  }
+
+  hcd_event_xfer_complete(daddr, ep_addr, len, XFER_RESULT_SUCCESS, false);
+  return true;
+}
+
+// hub reports status change of hub (bit 0) and its ports on interrupt endpoint
+static void hub_status_change(uint8_t bitmap) {
+  TEST_ASSERT_NOT_NULL(int_buf);
+  int_buf[0] = bitmap;
+  int_buf = NULL;
+  hcd_event_xfer_complete(HUB_ADDR, HUB_EP, 1, XFER_RESULT_SUCCESS, false);
+}
+
+static void port_plug(uint8_t port) {
+  model[port].present = true;
+  model[port].addr = ADDR_NONE;
+  port_status[port].status.connection = 1;
+  port_status[port].change.connection = 1;
+}
+
+static void port_unplug(uint8_t port) {
+  model[port].present = false;
+  port_status[port].status.connection = 0;
+  port_status[port].status.port_enable = 0;
+  port_status[port].change.connection = 1;
+}
+
+static bool hub_log_has(uint8_t bRequest, uint16_t wValue, uint16_t wIndex) {
+  for (uint8_t i = 0; i < hub_log_count; i++) {
+    if (hub_log[i].bRequest == bRequest && hub_log[i].wValue == wValue && hub_log[i].wIndex == wIndex) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void setUp(void) {
+  ctrl_hold      = false;
+  addr0_conflict = 0;
+  int_buf        = NULL;
+  int_arm_count  = 0;
+  hub_log_count  = 0;
+  memset(model, 0, sizeof(model));
+  memset(port_status, 0, sizeof(port_status));
+  for (uint8_t i = 0; i < TU_ARRAY_SIZE(model); i++) {
+    model[i].addr = ADDR_NONE;
+  }
+
+  hcd_port_reset_StubWithCallback(port_reset_cb);
+  hcd_setup_send_StubWithCallback(setup_send_cb);
+  hcd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+  hcd_model_init(RHPORT);
+
+  // mount hub
+  model[0].present = true;
+  connected = true;
+  hcd_event_device_attach(RHPORT, false);
+  task_run(500);
+  TEST_ASSERT_TRUE(tuh_mounted(HUB_ADDR));
+  TEST_ASSERT_EQUAL(1, int_arm_count);
+  hub_log_count = 0;
+}
+
+void tearDown(void) {
+  tuh_deinit(RHPORT);
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+void test_hub_mount(void) {
+  for (uint8_t port = 1; port <= HUB_PORTS; port++) {
+    TEST_ASSERT_EQUAL(1, port_status[port].status.port_power);
+  }
+}
+
+// all changes of the bitmap are acknowledged in one scan before the interrupt endpoint is polled again
+void test_hub_scan_bitmap(void) {
+  port_status[0].change.value = TU_BIT(HUB_FEATURE_HUB_OVER_CURRENT_CHANGE);
+  port_plug(1);
+  port_plug(3);
+  port_status[3].change.port_enable = 1;
+  port_status[3].change.over_current = 1;
+
+  hub_status_change(TU_BIT(0) | TU_BIT(1) | TU_BIT(3));
+  task_run(0);
+
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_GET_STATUS, 0, 0));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_CLEAR_FEATURE, HUB_FEATURE_HUB_OVER_CURRENT_CHANGE, 0));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_GET_STATUS, 0, 1));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_CLEAR_FEATURE, HUB_FEATURE_PORT_CONNECTION_CHANGE, 1));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_GET_STATUS, 0, 3));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_CLEAR_FEATURE, HUB_FEATURE_PORT_CONNECTION_CHANGE, 3));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_CLEAR_FEATURE, HUB_FEATURE_PORT_ENABLE_CHANGE, 3));
+  TEST_ASSERT_TRUE(hub_log_has(HUB_REQUEST_CLEAR_FEATURE, HUB_FEATURE_PORT_OVER_CURRENT_CHANGE, 3));
+  TEST_ASSERT_FALSE(hub_log_has(HUB_REQUEST_GET_STATUS, 0, 2)); // unchanged port is not queried
+  TEST_ASSERT_EQUAL(3 + 5, hub_log_count);
+
+  for (uint8_t i = 0; i <= HUB_PORTS; i++) {
+    TEST_ASSERT_EQUAL_HEX16(0, port_status[i].change.value);
+  }
+  TEST_ASSERT_EQUAL(2, int_arm_count); // re-armed once, after the scan
+
+  // both devices are enumerated
+  task_run(1000);
+  TEST_ASSERT_TRUE(tuh_mounted(1));
+  TEST_ASSERT_TRUE(tuh_mounted(2));
+}
+
+// status change without any hub/port bit does not stop polling
+void test_hub_scan_empty(void) {
+  hub_status_change(0);
+  task_run(0);
+  TEST_ASSERT_EQUAL(0, hub_log_count);
+  TEST_ASSERT_EQUAL(2, int_arm_count);
+}
+
+void test_hub_port_unplug(void) {
+  port_plug(2);
+  hub_status_change(TU_BIT(2));
+  task_run(1000);
+  TEST_ASSERT_TRUE(tuh_mounted(1));
+
+  port_unplug(2);
+  hub_status_change(TU_BIT(2));
+  task_run(0);
+  TEST_ASSERT_FALSE(tuh_connected(1));
+  TEST_ASSERT_EQUAL_HEX16(0, port_status[2].change.value);
+}
+
+//--------------------------------------------------------------------+
+// Concurrent enumeration
+//--------------------------------------------------------------------+
+// run until all devices on hub are mounted, return elapsed time
+static uint32_t run_until_mounted(uint8_t count) {
+  uint32_t const start_ms = now_ms;
+  for (uint32_t ms = 0; ms < 2000; ms++) {
+    bool all_mounted = true;
+    for (uint8_t daddr = 1; daddr <= count; daddr++) {
+      all_mounted = all_mounted && tuh_mounted(daddr);
+    }
+    if (all_mounted) {
+      break;
+    }
+    task_run(1);
+  }
+  return now_ms - start_ms;
+}
+
+// debouncing and descriptors fetching of ports overlap, address 0 is used by one device at a time
+void test_hub_enumerate_concurrently(void) {
+  for (uint8_t port = 1; port <= HUB_PORTS; port++) {
+    port_plug(port);
+  }
+  hub_status_change(0x1E);
+
+  uint32_t const elapsed_ms = run_until_mounted(HUB_PORTS);
+  for (uint8_t daddr = 1; daddr <= HUB_PORTS; daddr++) {
+    TEST_ASSERT_TRUE(tuh_mounted(daddr));
+  }
+  TEST_ASSERT_EQUAL(0, addr0_conflict);
+
+  // one at a time takes at least a debouncing delay (150 ms) per device
+  TEST_ASSERT_LESS_THAN_UINT32(2 * 150, elapsed_ms);
+}
+
+// device unplugged while waiting for address 0 does not stall the others
+void test_hub_enumerate_unplug_waiting(void) {
+  for (uint8_t port = 1; port <= 3; port++) {
+    port_plug(port);
+  }
+  hub_status_change(0x0E);
+  task_run(152); // debounced, one device is resetting and the others wait for address 0
+
+  port_unplug(3);
+  hub_status_change(TU_BIT(3));
+
+  run_until_mounted(2);
+  TEST_ASSERT_TRUE(tuh_mounted(1));
+  TEST_ASSERT_TRUE(tuh_mounted(2));
+  TEST_ASSERT_FALSE(tuh_connected(3));
+  TEST_ASSERT_FALSE(hub_log_has(HUB_REQUEST_SET_FEATURE, HUB_FEATURE_PORT_RESET, 3)); // its enumeration is cancelled
+  TEST_ASSERT_EQUAL(0, addr0_conflict);
+}
+
+//--------------------------------------------------------------------+
+// Concurrent control transfers
+//--------------------------------------------------------------------+
+static tusb_control_request_t const req_vendor = {
+  .bmRequestType = 0x40, .bRequest = 0x01, .wValue = 0, .wIndex = 0, .wLength = 0
+};
+
+static uint8_t ctrl_done[1 + HUB_PORTS];
+
+static void ctrl_complete_cb(tuh_xfer_t* xfer) {
+  TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, xfer->result);
+  ctrl_done[xfer->daddr]++;
+}
+
+static void ctrl_submit(uint8_t daddr) {
+  tuh_xfer_t xfer = {
+    .daddr       = daddr,
+    .ep_addr     = 0,
+    .setup       = &req_vendor,
+    .buffer      = NULL,
+    .complete_cb = ctrl_complete_cb,
+    .user_data   = 0
+  };
+  TEST_ASSERT_TRUE(tuh_control_xfer(&xfer));
+}
+
+// device completes its held setup stage
+static void ctrl_release(uint8_t daddr) {
+  model_device_t* dev = model_find(daddr);
+  TEST_ASSERT_TRUE(dev->ctrl_held);
+  dev->ctrl_held = false;
+  hcd_event_xfer_complete(daddr, 0x00, 8, XFER_RESULT_SUCCESS, false);
+}
+
+// transfers of different devices are in flight together, a device still runs one transfer at a time
+void test_hub_control_concurrent(void) {
+  memset(ctrl_done, 0, sizeof(ctrl_done));
+  port_plug(1);
+  port_plug(2);
+  hub_status_change(TU_BIT(1) | TU_BIT(2));
+  run_until_mounted(2);
+  TEST_ASSERT_TRUE(tuh_mounted(2));
+
+  ctrl_hold = true;
+  ctrl_submit(1);
+  ctrl_submit(2);
+  ctrl_submit(1);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, model[1].vendor_count);
+  TEST_ASSERT_EQUAL(1, model[2].vendor_count);
+
+  // slot freed by device 2 is not used for device 1 while its first transfer is in flight
+  ctrl_release(2);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, ctrl_done[2]);
+  TEST_ASSERT_EQUAL(1, model[1].vendor_count);
+
+  ctrl_release(1);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, ctrl_done[1]);
+  TEST_ASSERT_EQUAL(2, model[1].vendor_count);
+
+  ctrl_release(1);
+  task_run(0);
+  TEST_ASSERT_EQUAL(2, ctrl_done[1]);
+}
@@ -0,0 +1,600 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+#include "usbh.h"
+#include "msc_host.h"
+TEST_SOURCE_FILE("usbh.c")
+
+// Mock File
+#include "mock_hcd.h"
+
+#define HCD_MODEL_PID      0x4003
+#define HCD_MODEL_EP0_SIZE 8
+#include "hcd_device_model.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+// msc host runs on usbh on top of mock hcd, with a Bulk-Only mass storage device modeled on root port. Bulk transfers
+// are completed by the model as usbh events, a command is therefore in progress until the usbh task runs.
+
+enum {
+  RHPORT      = 0,
+  DADDR       = 1,
+  EP_IN       = 0x81,
+  EP_OUT      = 0x02,
+  EP_SIZE     = 64,
+  BLOCK_SIZE  = 512,
+  DISK_BLOCKS = 64, // blocks backed by model storage, others read as pattern
+  RA_BLOCKS   = CFG_TUH_MSC_READAHEAD_SIZE / BLOCK_SIZE,
+  SEQ_LBA     = 16, // reads not following the previous one, readahead is not started
+};
+
+TU_VERIFY_STATIC(RA_BLOCKS == 8, "readahead is 8 blocks");
+TU_VERIFY_STATIC(CFG_TUH_MSC_QUEUE_DEPTH == 4, "queue holds 4 requests");
+
+static uint8_t const desc_configuration[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(9 + 9 + 7 + 7), 1, 1, 0, TU_BIT(7), 50,
+  9, TUSB_DESC_INTERFACE, 0, 0, 2, TUSB_CLASS_MSC, MSC_SUBCLASS_SCSI, MSC_PROTOCOL_BOT, 0,
+  7, TUSB_DESC_ENDPOINT, EP_IN, TUSB_XFER_BULK, U16_TO_U8S_LE(EP_SIZE), 0,
+  7, TUSB_DESC_ENDPOINT, EP_OUT, TUSB_XFER_BULK, U16_TO_U8S_LE(EP_SIZE), 0,
+};
+
+//--------------------------------------------------------------------+
+// Device model
+//--------------------------------------------------------------------+
+static uint64_t disk_block_count;
+static uint8_t disk[DISK_BLOCKS][BLOCK_SIZE];
+
+// command in progress
+static struct {
+  enum { BOT_CBW = 0, BOT_DATA, BOT_CSW } stage;
+  msc_cbw_t cbw;
+  uint64_t lba;
+  uint32_t data_len;   // bytes device has for data stage
+  uint32_t data_xferred;
+  uint8_t resp[32];    // response of non read/write commands
+} bot;
+
+// commands received by device
+static struct {
+  uint8_t cmd_code;
+  uint64_t lba;
+  uint32_t block_count;
+  uint32_t total_bytes;
+} cmd_log[16];
+static uint8_t cmd_count;
+
+static uint32_t data_limit;     // device ends read/write data stage after this many bytes
+static bool cbw_xfer_fail;      // hcd fails next CBW transfer
+static void (*cbw_xfer_hook)(void);
+
+// read/write completion seen by application
+static struct {
+  uintptr_t arg;
+  uint8_t status;
+  uint32_t total_bytes;
+  uint32_t data_residue;
+} done_log[16];
+static uint8_t done_count;
+
+TU_ATTR_ALWAYS_INLINE static inline uint8_t disk_pattern(uint64_t lba, uint32_t i) {
+  return (uint8_t) ((lba * 7 + i) % 251);
+}
+
+static uint32_t be32(uint8_t const* p) {
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static void put_be32(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t) (v >> 24);
+  p[1] = (uint8_t) (v >> 16);
+  p[2] = (uint8_t) (v >> 8);
+  p[3] = (uint8_t) v;
+}
+
+static bool rw_complete_cb(uint8_t daddr, tuh_msc_complete_data_t const* cb_data) {
+  (void) daddr;
+  TEST_ASSERT_TRUE(done_count < TU_ARRAY_SIZE(done_log));
+  done_log[done_count].arg          = cb_data->user_arg;
+  done_log[done_count].status       = cb_data->csw->status;
+  done_log[done_count].total_bytes  = cb_data->cbw->total_bytes;
+  done_log[done_count].data_residue = cb_data->csw->data_residue;
+  done_count++;
+  return true;
+}
+
+static uint8_t const* device_desc_configuration(uint16_t* len) {
+  *len = sizeof(desc_configuration);
+  return desc_configuration;
+}
+
+static uint8_t const* device_ctrl_response(uint16_t* len) {
+  static uint8_t const max_lun = 0;
+  if (ctrl_request.bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS && ctrl_request.bRequest == MSC_REQ_GET_MAX_LUN) {
+    *len = 1;
+    return &max_lun;
+  }
+  *len = 0;
+  return NULL;
+}
+
+// device receives a CBW, prepare data stage
+static void bot_command(uint8_t const* buffer) {
+  memcpy(&bot.cbw, buffer, sizeof(msc_cbw_t));
+  TEST_ASSERT_EQUAL_HEX32(MSC_CBW_SIGNATURE, bot.cbw.signature);
+
+  uint8_t const* cmd = bot.cbw.command;
+  uint32_t block_count = 0;
+  bot.lba = 0;
+  bot.data_len = 0;
+  bot.data_xferred = 0;
+
+  switch (cmd[0]) {
+    case SCSI_CMD_READ_10:
+    case SCSI_CMD_WRITE_10:
+      bot.lba = be32(cmd + 2);
+      block_count = ((uint32_t) cmd[7] << 8) | cmd[8];
+      bot.data_len = tu_min32(block_count * BLOCK_SIZE, data_limit);
+      break;
+
+    case SCSI_CMD_READ_16:
+    case SCSI_CMD_WRITE_16:
+      bot.lba = ((uint64_t) be32(cmd + 2) << 32) | be32(cmd + 6);
+      block_count = be32(cmd + 10);
+      bot.data_len = tu_min32(block_count * BLOCK_SIZE, data_limit);
+      break;
+
+    case SCSI_CMD_READ_CAPACITY_10: {
+      const uint64_t last_lba = disk_block_count - 1;
+      put_be32(bot.resp, (last_lba > UINT32_MAX) ? UINT32_MAX : (uint32_t) last_lba);
+      put_be32(bot.resp + 4, BLOCK_SIZE);
+      bot.data_len = 8;
+      break;
+    }
+
+    case SCSI_CMD_SERVICE_ACTION_IN_16: {
+      TEST_ASSERT_EQUAL(SCSI_SERVICE_ACTION_READ_CAPACITY_16, cmd[1] & 0x1f);
+      const uint64_t last_lba = disk_block_count - 1;
+      memset(bot.resp, 0, sizeof(bot.resp));
+      put_be32(bot.resp, (uint32_t) (last_lba >> 32));
+      put_be32(bot.resp + 4, (uint32_t) last_lba);
+      put_be32(bot.resp + 8, BLOCK_SIZE);
+      bot.data_len = 32;
+      break;
+    }
+
+    default:
+      break;
+  }
+  bot.data_len = tu_min32(bot.data_len, bot.cbw.total_bytes);
+
+  TEST_ASSERT_TRUE(cmd_count < TU_ARRAY_SIZE(cmd_log));
+  cmd_log[cmd_count].cmd_code    = cmd[0];
+  cmd_log[cmd_count].lba         = bot.lba;
+  cmd_log[cmd_count].block_count = block_count;
+  cmd_log[cmd_count].total_bytes = bot.cbw.total_bytes;
+  cmd_count++;
+
+  bot.stage = bot.cbw.total_bytes ? BOT_DATA : BOT_CSW;
+}
+
+// device transfers data stage into/from host buffer, return number of bytes
+static uint16_t bot_data(uint8_t* buffer, uint16_t buflen) {
+  TEST_ASSERT_EQUAL(BOT_DATA, bot.stage);
+  const uint16_t len = (uint16_t) tu_min32(buflen, bot.data_len - bot.data_xferred);
+  const uint8_t cmd_code = bot.cbw.command[0];
+
+  for (uint16_t i = 0; i < len; i++) {
+    const uint32_t offset = bot.data_xferred + i;
+    const uint64_t lba = bot.lba + offset / BLOCK_SIZE;
+    const uint32_t idx = offset % BLOCK_SIZE;
+
+    if (cmd_code == SCSI_CMD_READ_10 || cmd_code == SCSI_CMD_READ_16) {
+      buffer[i] = (lba < DISK_BLOCKS) ? disk[lba][idx] : disk_pattern(lba, idx);
+    } else if (cmd_code == SCSI_CMD_WRITE_10 || cmd_code == SCSI_CMD_WRITE_16) {
+      TEST_ASSERT_TRUE(lba < DISK_BLOCKS);
+      disk[lba][idx] = buffer[i];
+    } else {
+      buffer[i] = bot.resp[offset];
+    }
+  }
+  bot.data_xferred += len;
+
+  // data stage ends with a short packet or when all expected data is transferred
+  if (len < buflen || bot.data_xferred == bot.cbw.total_bytes) {
+    bot.stage = BOT_CSW;
+  }
+  return len;
+}
+
+static void bot_status(uint8_t* buffer) {
+  TEST_ASSERT_EQUAL(BOT_CSW, bot.stage);
+  msc_csw_t const csw = {
+    .signature    = MSC_CSW_SIGNATURE,
+    .tag          = bot.cbw.tag,
+    .data_residue = bot.cbw.total_bytes - bot.data_xferred,
+    .status       = MSC_CSW_STATUS_PASSED
+  };
+  memcpy(buffer, &csw, sizeof(msc_csw_t));
+  bot.stage = BOT_CBW;
+}
+
+static bool device_edpt_xfer(uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen) {
+  uint16_t len = buflen;
+
+  if (ep_addr == EP_OUT && bot.stage == BOT_CBW) {
+    TEST_ASSERT_EQUAL(sizeof(msc_cbw_t), buflen);
+    if (cbw_xfer_hook) {
+      cbw_xfer_hook();
+      cbw_xfer_hook = NULL;
+    }
+    if (cbw_xfer_fail) {
+      cbw_xfer_fail = false;
+      return false;
+    }
+    bot_command(buffer);
+  } else if (ep_addr == EP_IN && bot.stage == BOT_CSW) {
+    TEST_ASSERT_EQUAL(sizeof(msc_csw_t), buflen);
+    bot_status(buffer);
+  } else {
+    TEST_ASSERT_TRUE(ep_addr == EP_IN || ep_addr == EP_OUT);
+    TEST_ASSERT_EQUAL(tu_edpt_dir(ep_addr), bot.cbw.dir ? TUSB_DIR_IN : TUSB_DIR_OUT);
+    len = bot_data(buffer, buflen);
+  }
+
+  hcd_event_xfer_complete(daddr, ep_addr, len, XFER_RESULT_SUCCESS, false);
+  return true;
+}
+
+static void device_attach(uint64_t block_count) {
+  disk_block_count = block_count;
+  connected = true;
+  hcd_event_device_attach(RHPORT, false);
+  task_run(500);
+  TEST_ASSERT_TRUE(tuh_msc_mounted(DADDR));
+  cmd_count = 0;
+}
+
+static void check_read(uint8_t const* buf, uint64_t lba, uint32_t block_count) {
+  for (uint32_t b = 0; b < block_count; b++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(disk[lba + b], buf + b * BLOCK_SIZE, BLOCK_SIZE);
+  }
+}
+
+static void check_done(uint8_t idx, uintptr_t arg, uint32_t total_bytes, uint32_t data_residue) {
+  TEST_ASSERT_EQUAL(arg, done_log[idx].arg);
+  TEST_ASSERT_EQUAL(MSC_CSW_STATUS_PASSED, done_log[idx].status);
+  TEST_ASSERT_EQUAL(total_bytes, done_log[idx].total_bytes);
+  TEST_ASSERT_EQUAL(data_residue, done_log[idx].data_residue);
+}
+
+void setUp(void) {
+  cmd_count     = 0;
+  done_count    = 0;
+  data_limit    = UINT32_MAX;
+  cbw_xfer_fail = false;
+  cbw_xfer_hook = NULL;
+  memset(&bot, 0, sizeof(bot));
+  for (uint32_t lba = 0; lba < DISK_BLOCKS; lba++) {
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+      disk[lba][i] = disk_pattern(lba, i);
+    }
+  }
+
+  hcd_port_reset_Ignore();
+  hcd_model_init(RHPORT);
+}
+
+void tearDown(void) {
+  tuh_deinit(RHPORT);
+}
+
+//--------------------------------------------------------------------+
+// Capacity
+//--------------------------------------------------------------------+
+void test_read_capacity10(void) {
+  device_attach(DISK_BLOCKS);
+  TEST_ASSERT_EQUAL(DISK_BLOCKS, tuh_msc_get_block_count64(DADDR, 0));
+  TEST_ASSERT_EQUAL(BLOCK_SIZE, tuh_msc_get_block_size(DADDR, 0));
+}
+
+// device larger than 2 TiB reports 0xFFFFFFFF as last LBA in Read Capacity 10
+void test_read_capacity16_fallback(void) {
+  const uint64_t block_count = 0x100000000ull + 0x100;
+  device_attach(block_count);
+  TEST_ASSERT_EQUAL_UINT64(block_count, tuh_msc_get_block_count64(DADDR, 0));
+  TEST_ASSERT_EQUAL(UINT32_MAX, tuh_msc_get_block_count(DADDR, 0));
+  TEST_ASSERT_EQUAL(BLOCK_SIZE, tuh_msc_get_block_size(DADDR, 0));
+
+  // blocks above 32-bit LBA are accessed with Read 16
+  const uint64_t lba = 0x100000010ull;
+  uint8_t buf[2 * BLOCK_SIZE];
+  TEST_ASSERT_TRUE(tuh_msc_read16(DADDR, 0, buf, lba, 2, rw_complete_cb, 1));
+  task_flush();
+
+  TEST_ASSERT_EQUAL(1, cmd_count);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_CMD_READ_16, cmd_log[0].cmd_code);
+  TEST_ASSERT_EQUAL_UINT64(lba, cmd_log[0].lba);
+  TEST_ASSERT_EQUAL(2, cmd_log[0].block_count);
+  TEST_ASSERT_EQUAL(1, done_count);
+  check_done(0, 1, 2 * BLOCK_SIZE, 0);
+  for (uint32_t i = 0; i < sizeof(buf); i++) {
+    TEST_ASSERT_EQUAL_HEX8(disk_pattern(lba + i / BLOCK_SIZE, i % BLOCK_SIZE), buf[i]);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Request queue
+//--------------------------------------------------------------------+
+// requests submitted while a command is in progress are queued, adjacent ones are merged into one command
+void test_queue_merge_adjacent(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[4][BLOCK_SIZE];
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[0], SEQ_LBA, 1, rw_complete_cb, 0));
+  TEST_ASSERT_EQUAL(1, cmd_count);
+  TEST_ASSERT_FALSE(tuh_msc_ready(DADDR));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[1], SEQ_LBA + 1, 1, rw_complete_cb, 1));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[2], SEQ_LBA + 2, 1, rw_complete_cb, 2));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[3], SEQ_LBA + 3, 1, rw_complete_cb, 3));
+  TEST_ASSERT_EQUAL(1, cmd_count);
+  task_flush();
+
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  TEST_ASSERT_EQUAL(SEQ_LBA + 1, cmd_log[1].lba);
+  TEST_ASSERT_EQUAL(3, cmd_log[1].block_count);
+  TEST_ASSERT_EQUAL(4, done_count);
+  for (uint8_t i = 0; i < 4; i++) {
+    check_done(i, i, BLOCK_SIZE, 0); // each request reports its own command
+    check_read(buf[i], SEQ_LBA + i, 1);
+  }
+  TEST_ASSERT_TRUE(tuh_msc_ready(DADDR));
+}
+
+void test_queue_no_merge(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[4][BLOCK_SIZE];
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[0], SEQ_LBA, 1, rw_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[1], SEQ_LBA + 4, 1, rw_complete_cb, 1)); // not adjacent
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, buf[1], SEQ_LBA + 5, 1, rw_complete_cb, 2)); // other command
+  task_flush();
+
+  TEST_ASSERT_EQUAL(3, cmd_count);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_CMD_READ_10, cmd_log[1].cmd_code);
+  TEST_ASSERT_EQUAL(SEQ_LBA + 4, cmd_log[1].lba);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_CMD_WRITE_10, cmd_log[2].cmd_code);
+  TEST_ASSERT_EQUAL(SEQ_LBA + 5, cmd_log[2].lba);
+  TEST_ASSERT_EQUAL(3, done_count);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(disk[SEQ_LBA + 4], disk[SEQ_LBA + 5], BLOCK_SIZE);
+}
+
+void test_queue_full(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+
+  for (uint8_t i = 0; i < CFG_TUH_MSC_QUEUE_DEPTH; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, SEQ_LBA + 2 * i, 1, rw_complete_cb, i));
+  }
+  TEST_ASSERT_FALSE(tuh_msc_read10(DADDR, 0, buf, SEQ_LBA, 1, rw_complete_cb, 0xff));
+  task_flush();
+
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_QUEUE_DEPTH, done_count);
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, SEQ_LBA, 1, rw_complete_cb, 0xff));
+  task_flush();
+  TEST_ASSERT_EQUAL(CFG_TUH_MSC_QUEUE_DEPTH + 1, done_count);
+}
+
+// merged writes are sent back-to-back from each request buffer
+void test_queue_merge_write(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[3][2 * BLOCK_SIZE];
+  for (uint8_t i = 0; i < 3; i++) {
+    memset(buf[i], 0xa0 + i, sizeof(buf[i]));
+  }
+
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, buf[0], SEQ_LBA, 1, rw_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, buf[1], SEQ_LBA + 1, 2, rw_complete_cb, 1));
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, buf[2], SEQ_LBA + 3, 1, rw_complete_cb, 2));
+  task_flush();
+
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  TEST_ASSERT_EQUAL(3, cmd_log[1].block_count);
+  TEST_ASSERT_EQUAL(3, done_count);
+  check_done(1, 1, 2 * BLOCK_SIZE, 0);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0xa0, disk[SEQ_LBA], BLOCK_SIZE);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0xa1, disk[SEQ_LBA + 1], BLOCK_SIZE);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0xa1, disk[SEQ_LBA + 2], BLOCK_SIZE);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0xa2, disk[SEQ_LBA + 3], BLOCK_SIZE);
+}
+
+// device ends merged data stage early, each request reports residue of its own share
+void test_queue_merge_residue(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[4][2 * BLOCK_SIZE];
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[0], SEQ_LBA, 1, rw_complete_cb, 0));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[1], SEQ_LBA + 1, 1, rw_complete_cb, 1));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[2], SEQ_LBA + 2, 2, rw_complete_cb, 2));
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[3], SEQ_LBA + 4, 1, rw_complete_cb, 3));
+  data_limit = 2 * BLOCK_SIZE;
+  task_flush();
+
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  TEST_ASSERT_EQUAL(4, cmd_log[1].block_count);
+  TEST_ASSERT_EQUAL(4, done_count);
+  check_done(0, 0, BLOCK_SIZE, 0);
+  check_done(1, 1, BLOCK_SIZE, 0);
+  check_done(2, 2, 2 * BLOCK_SIZE, BLOCK_SIZE);
+  check_done(3, 3, BLOCK_SIZE, BLOCK_SIZE);
+  check_read(buf[1], SEQ_LBA + 1, 1);
+  check_read(buf[2], SEQ_LBA + 2, 1);
+}
+
+// read submitted from other task while a SCSI command is being started
+static uint8_t hook_buf[BLOCK_SIZE];
+static void hook_submit_read(void) {
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, hook_buf, SEQ_LBA, 1, rw_complete_cb, 1));
+}
+
+// read/write submitted while a SCSI command claims the endpoint is started once that command fails
+void test_queue_scsi_command_failed(void) {
+  device_attach(DISK_BLOCKS);
+
+  cbw_xfer_fail = true;
+  cbw_xfer_hook = hook_submit_read;
+  TEST_ASSERT_FALSE(tuh_msc_test_unit_ready(DADDR, 0, rw_complete_cb, 0xff));
+
+  TEST_ASSERT_EQUAL(1, cmd_count);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_CMD_READ_10, cmd_log[0].cmd_code);
+  task_flush();
+  TEST_ASSERT_EQUAL(1, done_count);
+  check_done(0, 1, BLOCK_SIZE, 0);
+  check_read(hook_buf, SEQ_LBA, 1);
+}
+
+//--------------------------------------------------------------------+
+// Readahead
+//--------------------------------------------------------------------+
+// sequential single block reads are served from a full cache read
+void test_readahead_hit(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[RA_BLOCKS][BLOCK_SIZE];
+
+  for (uint8_t i = 0; i < RA_BLOCKS; i++) {
+    TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[i], i, 1, rw_complete_cb, i));
+    task_flush();
+    TEST_ASSERT_EQUAL(i + 1, done_count);
+    check_done(i, i, BLOCK_SIZE, 0);
+    check_read(buf[i], i, 1);
+  }
+
+  TEST_ASSERT_EQUAL(1, cmd_count);
+  TEST_ASSERT_EQUAL(0, cmd_log[0].lba);
+  TEST_ASSERT_EQUAL(RA_BLOCKS, cmd_log[0].block_count);
+
+  // next block is past the cache, read again
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf[0], RA_BLOCKS, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  TEST_ASSERT_EQUAL(RA_BLOCKS, cmd_log[1].lba);
+  check_read(buf[0], RA_BLOCKS, 1);
+}
+
+// readahead is limited to the end of medium
+void test_readahead_end_of_medium(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+
+  // sequential read from the last block
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, DISK_BLOCKS - 3, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, DISK_BLOCKS - 2, 1, rw_complete_cb, 1));
+  task_flush();
+
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  TEST_ASSERT_EQUAL(DISK_BLOCKS - 2, cmd_log[1].lba);
+  TEST_ASSERT_EQUAL(2, cmd_log[1].block_count);
+  check_read(buf, DISK_BLOCKS - 2, 1);
+}
+
+// write to cached blocks drops the cache
+void test_readahead_invalidate_write(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+  uint8_t wr_buf[BLOCK_SIZE];
+  memset(wr_buf, 0x5a, sizeof(wr_buf));
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 0, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, wr_buf, 2, 1, rw_complete_cb, 1));
+  task_flush();
+  TEST_ASSERT_EQUAL(2, cmd_count);
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 2, 1, rw_complete_cb, 2));
+  task_flush();
+  TEST_ASSERT_EQUAL(3, cmd_count);
+  TEST_ASSERT_EQUAL_HEX8(SCSI_CMD_READ_10, cmd_log[2].cmd_code);
+  TEST_ASSERT_EACH_EQUAL_HEX8(0x5a, buf, BLOCK_SIZE);
+}
+
+// write outside cached blocks keeps the cache
+void test_readahead_write_elsewhere(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 0, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_TRUE(tuh_msc_write10(DADDR, 0, buf, RA_BLOCKS, 1, rw_complete_cb, 1));
+  task_flush();
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 1, 1, rw_complete_cb, 2));
+  task_flush();
+
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  check_read(buf, 1, 1);
+}
+
+// other SCSI command may change medium content, cache is dropped
+void test_readahead_invalidate_scsi_command(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 0, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_TRUE(tuh_msc_test_unit_ready(DADDR, 0, NULL, 0));
+  task_flush();
+  TEST_ASSERT_EQUAL(2, cmd_count);
+
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 1, 1, rw_complete_cb, 1));
+  task_flush();
+  TEST_ASSERT_EQUAL(3, cmd_count);
+  TEST_ASSERT_EQUAL(1, cmd_log[2].lba);
+}
+
+// short cache read is not kept, request still gets its data
+void test_readahead_short_fill(void) {
+  device_attach(DISK_BLOCKS);
+  uint8_t buf[BLOCK_SIZE];
+
+  data_limit = 2 * BLOCK_SIZE;
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 0, 1, rw_complete_cb, 0));
+  task_flush();
+  TEST_ASSERT_EQUAL(RA_BLOCKS, cmd_log[0].block_count);
+  check_done(0, 0, BLOCK_SIZE, 0);
+  check_read(buf, 0, 1);
+
+  data_limit = UINT32_MAX;
+  TEST_ASSERT_TRUE(tuh_msc_read10(DADDR, 0, buf, 1, 1, rw_complete_cb, 1));
+  task_flush();
+  TEST_ASSERT_EQUAL(2, cmd_count);
+  check_read(buf, 1, 1);
+}
@@ -0,0 +1,503 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+#include "usbh.h"
+TEST_SOURCE_FILE("usbh.c")
+
+// Mock File
+#include "mock_hcd.h"
+#include "hcd_device_model.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+// usbh runs on top of mock hcd with a single vendor device modeled on root port (hcd_device_model.h). Isochronous
+// transfers are recorded and completed by the test.
+
+enum {
+  RHPORT   = 0,
+  DADDR    = 1,
+  EP_ISO   = 0x81,
+  ISO_SIZE = 64,
+};
+
+// vendor interface with an isochronous IN endpoint on alternate 0, no class driver binds to it
+#define CONFIG_TOTAL_LEN  (9 + 9 + 7)
+static uint8_t const desc_configuration[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(CONFIG_TOTAL_LEN), 1, 1, 0, TU_BIT(7), 50,
+  9, TUSB_DESC_INTERFACE, 0, 0, 1, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0,
+  7, TUSB_DESC_ENDPOINT, EP_ISO, TUSB_XFER_ISOCHRONOUS, U16_TO_U8S_LE(ISO_SIZE), 1,
+};
+
+// same configuration with a higher bMaxPower e.g after a firmware update
+static uint8_t const desc_configuration_changed[] = {
+  9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(CONFIG_TOTAL_LEN), 1, 1, 0, TU_BIT(7), 100,
+  9, TUSB_DESC_INTERFACE, 0, 0, 1, TUSB_CLASS_VENDOR_SPECIFIC, 0, 0, 0,
+  7, TUSB_DESC_ENDPOINT, EP_ISO, TUSB_XFER_ISOCHRONOUS, U16_TO_U8S_LE(ISO_SIZE), 1,
+};
+
+// cycle counter for endpoint statistics, advanced by test
+static uint32_t cycle_count;
+uint32_t tusb_cycle_count_api(void) {
+  return cycle_count;
+}
+
+//--------------------------------------------------------------------+
+// Device model
+//--------------------------------------------------------------------+
+// last isochronous transfer submitted to hcd
+static uint8_t* iso_buffer;
+static uint32_t iso_count;
+static bool     iso_accept;
+
+static uint8_t config_desc_count; // configuration descriptor requests
+static bool    config_changed;    // device answers with desc_configuration_changed
+
+static uint8_t const* device_desc_configuration(uint16_t* len) {
+  config_desc_count++;
+  *len = sizeof(desc_configuration);
+  return config_changed ? desc_configuration_changed : desc_configuration;
+}
+
+static uint8_t const* device_ctrl_response(uint16_t* len) {
+  *len = 0;
+  return NULL;
+}
+
+static bool device_edpt_xfer(uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen) {
+  (void) daddr; (void) ep_addr; (void) buffer; (void) buflen;
+  TEST_FAIL_MESSAGE("only control is used with tuh_edpt_xfer()");
+  return false;
+}
+
+static bool edpt_iso_xfer_cb(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, tu_iso_packet_t* packets,
+                             uint16_t packet_count, int cmock_num_calls) {
+  (void) rhport; (void) daddr; (void) ep_addr; (void) packets; (void) packet_count; (void) cmock_num_calls;
+  if (!iso_accept) {
+    return false;
+  }
+  iso_buffer = buffer;
+  iso_count++;
+  return true;
+}
+
+// entry of the last tuh_enum_cache_update_cb()
+static tuh_enum_cache_t cache_entry;
+static uint8_t cache_update_count;
+
+void tuh_enum_cache_update_cb(uint8_t idx, const tuh_enum_cache_t* entry) {
+  TEST_ASSERT_TRUE(idx < CFG_TUH_ENUM_CACHE);
+  cache_entry = *entry;
+  cache_update_count++;
+}
+
+static void device_attach(void) {
+  connected = true;
+  hcd_event_device_attach(RHPORT, false);
+  task_run(500);
+  TEST_ASSERT_TRUE(tuh_mounted(DADDR));
+}
+
+static void device_detach(void) {
+  connected = false;
+  hcd_event_device_remove(RHPORT, false);
+  task_run(1);
+}
+
+void setUp(void) {
+  cycle_count = 0;
+  iso_buffer = NULL;
+  iso_count  = 0;
+  iso_accept = true;
+  config_desc_count  = 0;
+  config_changed     = false;
+  cache_update_count = 0;
+  memset(&cache_entry, 0, sizeof(cache_entry));
+
+  hcd_port_reset_Ignore();
+  hcd_edpt_iso_xfer_StubWithCallback(edpt_iso_xfer_cb);
+  hcd_model_init(RHPORT);
+  tuh_enum_cache_clear(); // cache outlives the host stack
+}
+
+void tearDown(void) {
+  tuh_deinit(RHPORT);
+}
+
+//--------------------------------------------------------------------+
+// Enumeration
+//--------------------------------------------------------------------+
+void test_enumeration(void) {
+  device_attach();
+
+  uint16_t vid, pid;
+  TEST_ASSERT_TRUE(tuh_vid_pid_get(DADDR, &vid, &pid));
+  TEST_ASSERT_EQUAL_HEX16(0xCafe, vid);
+  TEST_ASSERT_EQUAL_HEX16(0x4001, pid);
+
+  device_detach();
+  TEST_ASSERT_FALSE(tuh_connected(DADDR));
+}
+
+//--------------------------------------------------------------------+
+// Enumeration cache
+//--------------------------------------------------------------------+
+// enumerate device, return number of control transfers
+static uint32_t device_enumerate(void) {
+  setup_count       = 0;
+  config_desc_count = 0;
+  device_attach();
+  return setup_count;
+}
+
+// known device skips langid string and reuses the cached configuration descriptor after its header is validated
+void test_enum_cache_hit(void) {
+  uint32_t const full = device_enumerate();
+  TEST_ASSERT_EQUAL(2, config_desc_count);
+  TEST_ASSERT_EQUAL(1, cache_update_count);
+  TEST_ASSERT_EQUAL_HEX16(0xCafe, cache_entry.vid);
+  TEST_ASSERT_EQUAL_HEX16(0x4001, cache_entry.pid);
+  TEST_ASSERT_EQUAL(CONFIG_TOTAL_LEN, cache_entry.config_len);
+  TEST_ASSERT_EQUAL_MEMORY(desc_configuration, cache_entry.config, CONFIG_TOTAL_LEN);
+  device_detach();
+
+  TEST_ASSERT_EQUAL(full - 3, device_enumerate());
+  TEST_ASSERT_EQUAL(1, config_desc_count);
+  TEST_ASSERT_EQUAL(1, cache_update_count); // entry unchanged
+}
+
+// changed configuration header invalidates the cached descriptor, it is fetched again and the entry updated
+void test_enum_cache_config_changed(void) {
+  uint32_t const full = device_enumerate();
+  device_detach();
+
+  config_changed = true;
+  TEST_ASSERT_EQUAL(full - 2, device_enumerate());
+  TEST_ASSERT_EQUAL(2, config_desc_count);
+  TEST_ASSERT_EQUAL(2, cache_update_count);
+  TEST_ASSERT_EQUAL_MEMORY(desc_configuration_changed, cache_entry.config, CONFIG_TOTAL_LEN);
+  device_detach();
+
+  TEST_ASSERT_EQUAL(full - 3, device_enumerate());
+  TEST_ASSERT_EQUAL(2, cache_update_count);
+}
+
+// cleared cache enumerates a known device from scratch, restoring its saved entry makes it known again
+void test_enum_cache_clear_restore(void) {
+  uint32_t const full = device_enumerate();
+  device_detach();
+  tuh_enum_cache_t const saved = cache_entry;
+
+  tuh_enum_cache_clear();
+  TEST_ASSERT_EQUAL(full, device_enumerate());
+  TEST_ASSERT_EQUAL(2, config_desc_count);
+  device_detach();
+
+  tuh_enum_cache_clear();
+  TEST_ASSERT_FALSE(tuh_enum_cache_set(CFG_TUH_ENUM_CACHE, &saved));
+  TEST_ASSERT_TRUE(tuh_enum_cache_set(CFG_TUH_ENUM_CACHE - 1, &saved));
+  TEST_ASSERT_EQUAL(full - 3, device_enumerate());
+  TEST_ASSERT_EQUAL(1, config_desc_count);
+}
+
+//--------------------------------------------------------------------+
+// Isochronous
+//--------------------------------------------------------------------+
+static uint8_t     iso_buf[2][4 * ISO_SIZE];
+static tu_iso_packet_t iso_packets[2][4];
+static tuh_iso_xfer_t iso_xfer[2];
+static tuh_iso_xfer_t* iso_done[4];
+static uint8_t iso_done_count;
+
+static void iso_complete_cb(tuh_iso_xfer_t* xfer) {
+  TEST_ASSERT_TRUE(iso_done_count < TU_ARRAY_SIZE(iso_done));
+  iso_done[iso_done_count++] = xfer;
+}
+
+static tuh_iso_xfer_t* iso_setup(uint8_t i) {
+  tuh_iso_xfer_t* xfer = &iso_xfer[i];
+  tu_memclr(xfer, sizeof(tuh_iso_xfer_t));
+  for (uint8_t p = 0; p < 4; p++) {
+    iso_packets[i][p].length = ISO_SIZE;
+  }
+  xfer->daddr        = DADDR;
+  xfer->ep_addr      = EP_ISO;
+  xfer->buffer       = iso_buf[i];
+  xfer->packets      = iso_packets[i];
+  xfer->packet_count = 4;
+  xfer->complete_cb  = iso_complete_cb;
+  return xfer;
+}
+
+static void iso_open(void) {
+  iso_done_count = 0;
+  device_attach();
+  tusb_desc_endpoint_t const* desc_ep = (tusb_desc_endpoint_t const*) (desc_configuration + 9 + 9);
+  TEST_ASSERT_TRUE(tuh_edpt_open(DADDR, desc_ep));
+}
+
+void test_iso_xfer(void) {
+  iso_open();
+
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(0)));
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(1)));
+  TEST_ASSERT_FALSE(tuh_iso_xfer(iso_setup(1))); // queue is full
+  TEST_ASSERT_EQUAL(2, iso_count);
+
+  hcd_event_xfer_complete(DADDR, EP_ISO, 4 * ISO_SIZE, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, iso_done_count);
+  TEST_ASSERT_EQUAL_PTR(&iso_xfer[0], iso_done[0]);
+  TEST_ASSERT_EQUAL(4 * ISO_SIZE, iso_xfer[0].actual_len);
+
+  hcd_event_xfer_complete(DADDR, EP_ISO, 2 * ISO_SIZE, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+  TEST_ASSERT_EQUAL(2, iso_done_count);
+  TEST_ASSERT_EQUAL_PTR(&iso_xfer[1], iso_done[1]);
+}
+
+// Completion reported by hcd before abort is for the aborted transfer, it must not complete one submitted afterward
+void test_iso_abort_late_completion(void) {
+  iso_open();
+
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(0)));
+  hcd_event_xfer_complete(DADDR, EP_ISO, 4 * ISO_SIZE, XFER_RESULT_SUCCESS, false); // not yet processed
+  TEST_ASSERT_TRUE(tuh_edpt_abort_xfer(DADDR, EP_ISO));
+
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(1)));
+  task_run(0);
+  TEST_ASSERT_EQUAL(0, iso_done_count);
+
+  // completion of the new transfer
+  hcd_event_xfer_complete(DADDR, EP_ISO, 4 * ISO_SIZE, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, iso_done_count);
+  TEST_ASSERT_EQUAL_PTR(&iso_xfer[1], iso_done[0]);
+}
+
+// Stream slot claimed by a transfer hcd rejects is given back
+void test_iso_xfer_failed_release_stream(void) {
+  iso_open();
+
+  // each rejected endpoint would hold a stream slot
+  iso_accept = false;
+  for (uint8_t i = 0; i < CFG_TUH_ISO_EP_MAX; i++) {
+    tuh_iso_xfer_t* xfer = iso_setup(0);
+    xfer->ep_addr = (uint8_t) (EP_ISO + i);
+    TEST_ASSERT_FALSE(tuh_iso_xfer(xfer));
+  }
+
+  // all slots are still available to other endpoints
+  iso_accept = true;
+  for (uint8_t i = 0; i < CFG_TUH_ISO_EP_MAX; i++) {
+    tuh_iso_xfer_t* xfer = iso_setup(i % 2);
+    xfer->ep_addr = (uint8_t) (EP_ISO + CFG_TUH_ISO_EP_MAX + i);
+    TEST_ASSERT_TRUE(tuh_iso_xfer(xfer));
+  }
+}
+
+//--------------------------------------------------------------------+
+// Control
+//--------------------------------------------------------------------+
+static tusb_control_request_t const req_vendor[3] = {
+  { .bmRequestType = 0x40, .bRequest = 0x01, .wValue = 0, .wIndex = 0, .wLength = 0 },
+  { .bmRequestType = 0x40, .bRequest = 0x02, .wValue = 0, .wIndex = 0, .wLength = 0 },
+  { .bmRequestType = 0x40, .bRequest = 0x03, .wValue = 0, .wIndex = 0, .wLength = 0 },
+};
+
+static xfer_result_t ctrl_result[3];
+static uint8_t ctrl_done_count[3];
+
+static void ctrl_complete_cb(tuh_xfer_t* xfer) {
+  uintptr_t const i = xfer->user_data;
+  ctrl_result[i] = xfer->result;
+  ctrl_done_count[i]++;
+}
+
+static bool ctrl_submit(uint8_t i) {
+  tuh_xfer_t xfer = {
+    .daddr       = DADDR,
+    .ep_addr     = 0,
+    .setup       = &req_vendor[i],
+    .buffer      = NULL,
+    .complete_cb = ctrl_complete_cb,
+    .user_data   = i
+  };
+  return tuh_control_xfer(&xfer);
+}
+
+static void ctrl_open(void) {
+  memset(ctrl_result, XFER_RESULT_INVALID, sizeof(ctrl_result));
+  memset(ctrl_done_count, 0, sizeof(ctrl_done_count));
+  device_attach();
+  ctrl_hold = true;
+  setup_count = 0;
+}
+
+// transfers queued to the same device are sent one at a time, in submission order
+void test_control_pending_order(void) {
+  ctrl_open();
+
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(ctrl_submit(i));
+  }
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, setup_count);
+
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_HEX8(req_vendor[i].bRequest, ctrl_request.bRequest);
+    hcd_event_xfer_complete(DADDR, 0x00, 8, XFER_RESULT_SUCCESS, false);
+    task_run(0);
+    TEST_ASSERT_EQUAL(1, ctrl_done_count[i]);
+    TEST_ASSERT_EQUAL(XFER_RESULT_SUCCESS, ctrl_result[i]);
+  }
+  TEST_ASSERT_EQUAL(3, setup_count);
+}
+
+// in-flight and pending transfers of an unplugged device fail once, pending ones are never sent
+void test_control_device_close(void) {
+  ctrl_open();
+
+  TEST_ASSERT_TRUE(ctrl_submit(0));
+  TEST_ASSERT_TRUE(ctrl_submit(1));
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, setup_count);
+
+  device_detach();
+  TEST_ASSERT_EQUAL(1, setup_count);
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_EQUAL(1, ctrl_done_count[i]);
+    TEST_ASSERT_EQUAL(XFER_RESULT_FAILED, ctrl_result[i]);
+  }
+
+  // late completion of the aborted setup is dropped
+  hcd_event_xfer_complete(DADDR, 0x00, 8, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, ctrl_done_count[0]);
+  TEST_ASSERT_EQUAL(1, setup_count);
+}
+
+//--------------------------------------------------------------------+
+// Endpoint statistics
+//--------------------------------------------------------------------+
+static tu_edpt_stats_t edpt_stats(uint8_t ep_addr) {
+  tu_edpt_stats_t stats;
+  TEST_ASSERT_TRUE(tuh_edpt_stats_get(DADDR, ep_addr, &stats));
+  return stats;
+}
+
+// stages of a control transfer are recorded as separate transfers on their EP0 direction
+void test_edpt_stats_control(void) {
+  ctrl_open();
+  ctrl_hold = false;
+  tuh_edpt_stats_clear(DADDR);
+
+  TEST_ASSERT_TRUE(ctrl_submit(0));
+  task_run(0);
+  TEST_ASSERT_EQUAL(1, ctrl_done_count[0]);
+
+  // setup
+  tu_edpt_stats_t stats = edpt_stats(0x00);
+  TEST_ASSERT_EQUAL(1, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(8, stats.bytes);
+  TEST_ASSERT_EQUAL(1, stats.latency_hist[0]);
+
+  // status
+  stats = edpt_stats(0x80);
+  TEST_ASSERT_EQUAL(1, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(0, stats.bytes);
+}
+
+void test_edpt_stats_iso(void) {
+  iso_open();
+  tuh_edpt_stats_clear(DADDR);
+
+  // latency of 40 cycles lands in bin 5 [32, 64)
+  cycle_count = 5000;
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(0)));
+  cycle_count += 40;
+  hcd_event_xfer_complete(DADDR, EP_ISO, 3 * ISO_SIZE, XFER_RESULT_SUCCESS, false);
+  task_run(0);
+
+  tu_edpt_stats_t stats = edpt_stats(EP_ISO);
+  TEST_ASSERT_EQUAL(1, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(3 * ISO_SIZE, stats.bytes);
+  TEST_ASSERT_EQUAL(1, stats.latency_hist[5]);
+  TEST_ASSERT_EQUAL(0, stats.errors);
+
+  // rejected by hcd: submitted but never completes
+  iso_accept = false;
+  TEST_ASSERT_FALSE(tuh_iso_xfer(iso_setup(1)));
+  stats = edpt_stats(EP_ISO);
+  TEST_ASSERT_EQUAL(2, stats.submitted);
+  TEST_ASSERT_EQUAL(1, stats.completed);
+  TEST_ASSERT_EQUAL(1, stats.errors);
+
+  iso_accept = true;
+  TEST_ASSERT_TRUE(tuh_iso_xfer(iso_setup(1)));
+  hcd_event_xfer_complete(DADDR, EP_ISO, 0, XFER_RESULT_STALLED, false);
+  task_run(0);
+  stats = edpt_stats(EP_ISO);
+  TEST_ASSERT_EQUAL(2, stats.completed);
+  TEST_ASSERT_EQUAL(1, stats.stalls);
+  TEST_ASSERT_EQUAL(1, stats.errors);
+
+  // other direction is untouched
+  stats = edpt_stats(tu_edpt_addr(tu_edpt_number(EP_ISO), TUSB_DIR_OUT));
+  TEST_ASSERT_EQUAL(0, stats.submitted);
+}
+
+// statistics belong to the device: dropped on removal, counted from scratch on next enumeration
+void test_edpt_stats_device_removed(void) {
+  device_attach();
+  tu_edpt_stats_t const enum_stats = edpt_stats(0x00);
+  TEST_ASSERT_TRUE(enum_stats.completed > 0);
+
+  device_detach();
+  tu_edpt_stats_t stats = edpt_stats(0x00);
+  TEST_ASSERT_EQUAL(0, stats.submitted);
+  TEST_ASSERT_EQUAL(0, stats.completed);
+
+  tuh_enum_cache_clear(); // same enumeration requests as the first time
+  device_attach();
+  stats = edpt_stats(0x00);
+  TEST_ASSERT_EQUAL(enum_stats.submitted, stats.submitted);
+  TEST_ASSERT_EQUAL(enum_stats.completed, stats.completed);
+  TEST_ASSERT_EQUAL(enum_stats.bytes, stats.bytes);
+
+  tuh_edpt_stats_clear(DADDR);
+  stats = edpt_stats(0x00);
+  TEST_ASSERT_EQUAL(0, stats.submitted);
+  TEST_ASSERT_EQUAL(0, stats.completed);
+}
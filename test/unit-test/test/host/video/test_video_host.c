@@ -0,0 +1,515 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb_option.h"
+#include "video_host.h"
+TEST_SOURCE_FILE("video_host.c")
+
+// Mock File
+#include "mock_usbh.h"
+#include "mock_usbh_pvt.h"
+
+//--------------------------------------------------------------------+
+// Descriptors
+//--------------------------------------------------------------------+
+enum {
+  DADDR = 1,
+  EP_VIDEO = 0x81,
+};
+
+#include "usbh_model.h"
+
+// UVC 1.5 bulk camera: MJPEG 160x120 and YUY2 4x2, followed by an interface of another function
+static const uint8_t desc_bulk[] = {
+  9, TUSB_DESC_INTERFACE, 0, 0, 0, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_CONTROL, VIDEO_ITF_PROTOCOL_15, 0,
+  13, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VC_HEADER, U16_TO_U8S_LE(0x0150), U16_TO_U8S_LE(22),
+      U32_TO_U8S_LE(48000000), 1, 1,
+  9, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VC_OUTPUT_TERMINAL, 2, U16_TO_U8S_LE(0x0101), 0, 1, 0,
+
+  9, TUSB_DESC_INTERFACE, 1, 0, 1, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_STREAMING, VIDEO_ITF_PROTOCOL_15, 0,
+  15, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_INPUT_HEADER, 2, U16_TO_U8S_LE(113), EP_VIDEO, 0, 2, 0, 0, 0, 1, 0, 0,
+  11, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FORMAT_MJPEG, 1, 1, 0, 1, 0, 0, 0, 0,
+  30, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FRAME_MJPEG, 1, 0, U16_TO_U8S_LE(160), U16_TO_U8S_LE(120),
+      U32_TO_U8S_LE(9216000), U32_TO_U8S_LE(9216000), U32_TO_U8S_LE(38400), U32_TO_U8S_LE(333333), 1,
+      U32_TO_U8S_LE(333333),
+  27, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED, 2, 1, TUD_VIDEO_GUID_YUY2, 16, 1, 0, 0, 0, 0,
+  30, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FRAME_UNCOMPRESSED, 1, 0, U16_TO_U8S_LE(4), U16_TO_U8S_LE(2),
+      U32_TO_U8S_LE(1920), U32_TO_U8S_LE(1920), U32_TO_U8S_LE(16), U32_TO_U8S_LE(666666), 1, U32_TO_U8S_LE(666666),
+  7, TUSB_DESC_ENDPOINT, EP_VIDEO, TUSB_XFER_BULK, U16_TO_U8S_LE(64), 0,
+
+  9, TUSB_DESC_INTERFACE, 2, 0, 1, TUSB_CLASS_HID, 0, 0, 0,
+};
+
+// UVC 1.0 isochronous camera: MJPEG 160x120, alternates of 128, 512 and 2048 (2 transactions) bytes
+static const uint8_t desc_iso[] = {
+  9, TUSB_DESC_INTERFACE, 0, 0, 0, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_CONTROL, VIDEO_ITF_PROTOCOL_UNDEFINED, 0,
+  13, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VC_HEADER, U16_TO_U8S_LE(0x0100), U16_TO_U8S_LE(13),
+      U32_TO_U8S_LE(48000000), 1, 1,
+
+  9, TUSB_DESC_INTERFACE, 1, 0, 0, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_STREAMING, VIDEO_ITF_PROTOCOL_UNDEFINED, 0,
+  14, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_INPUT_HEADER, 1, U16_TO_U8S_LE(55), EP_VIDEO, 0, 2, 0, 0, 0, 1, 0,
+  11, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FORMAT_MJPEG, 1, 1, 0, 1, 0, 0, 0, 0,
+  30, TUSB_DESC_CS_INTERFACE, VIDEO_CS_ITF_VS_FRAME_MJPEG, 1, 0, U16_TO_U8S_LE(160), U16_TO_U8S_LE(120),
+      U32_TO_U8S_LE(9216000), U32_TO_U8S_LE(9216000), U32_TO_U8S_LE(38400), U32_TO_U8S_LE(333333), 1,
+      U32_TO_U8S_LE(333333),
+  9, TUSB_DESC_INTERFACE, 1, 1, 1, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_STREAMING, VIDEO_ITF_PROTOCOL_UNDEFINED, 0,
+  7, TUSB_DESC_ENDPOINT, EP_VIDEO, 0x05, U16_TO_U8S_LE(128), 1,
+  9, TUSB_DESC_INTERFACE, 1, 2, 1, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_STREAMING, VIDEO_ITF_PROTOCOL_UNDEFINED, 0,
+  7, TUSB_DESC_ENDPOINT, EP_VIDEO, 0x05, U16_TO_U8S_LE(512), 1,
+  9, TUSB_DESC_INTERFACE, 1, 3, 1, TUSB_CLASS_VIDEO, VIDEO_SUBCLASS_STREAMING, VIDEO_ITF_PROTOCOL_UNDEFINED, 0,
+  7, TUSB_DESC_ENDPOINT, EP_VIDEO, 0x05, U16_TO_U8S_LE(0x0C00), 1,
+};
+
+static uint8_t _seq; // payload data is a running counter
+
+// Build a payload: header of hdr_len with bmHeaderInfo (End of Header is added) and PTS if flagged, then data_len
+// bytes of the running counter
+static uint16_t payload_build(uint8_t* buf, uint8_t hdr_len, uint8_t info, uint16_t data_len) {
+  tu_memclr(buf, hdr_len);
+  buf[0] = hdr_len;
+  buf[1] = (uint8_t) (info | 0x80u);
+  if (info & 0x04u) {
+    buf[2] = 0x78; buf[3] = 0x56; buf[4] = 0x34; buf[5] = 0x12;
+  }
+  for (uint16_t i = 0; i < data_len; i++) {
+    buf[hdr_len + i] = _seq++;
+  }
+  return (uint16_t) (hdr_len + data_len);
+}
+
+// Device sends a bulk transfer of a payload header and data
+static void bulk_payload(uint8_t hdr_len, uint8_t info, uint16_t data_len) {
+  uint8_t buf[1024];
+  uint16_t const len = payload_build(buf, hdr_len, info, data_len);
+  sim_ep_t* ep = sim_ep(EP_VIDEO);
+  TEST_ASSERT_TRUE(ep->pending);
+  TEST_ASSERT_TRUE(len <= ep->len);
+  ep->pending = false;
+  memcpy(ep->buffer, buf, len);
+  videoh_xfer_cb(DADDR, EP_VIDEO, XFER_RESULT_SUCCESS, len);
+}
+
+// Device sends bulk transfer of raw data (continuation of a payload)
+static void bulk_data(uint16_t data_len) {
+  sim_ep_t* ep = sim_ep(EP_VIDEO);
+  TEST_ASSERT_TRUE(ep->pending);
+  TEST_ASSERT_TRUE(data_len <= ep->len);
+  ep->pending = false;
+  for (uint16_t i = 0; i < data_len; i++) {
+    ep->buffer[i] = _seq++;
+  }
+  videoh_xfer_cb(DADDR, EP_VIDEO, XFER_RESULT_SUCCESS, data_len);
+}
+
+static void frame_check(const tuh_video_frame_t* frame, uint8_t first, uint32_t len) {
+  TEST_ASSERT_EQUAL(len, frame->length);
+  for (uint32_t i = 0; i < len; i++) {
+    TEST_ASSERT_EQUAL_HEX8((uint8_t) (first + i), frame->data[i]);
+  }
+}
+
+//--------------------------------------------------------------------+
+// Tests
+//--------------------------------------------------------------------+
+static uint8_t _fb[2][1024];
+
+static void mount(const uint8_t* desc, uint16_t len) {
+  TEST_ASSERT_TRUE(videoh_open(0, DADDR, (const tusb_desc_interface_t*) desc, len) > 0);
+  TEST_ASSERT_TRUE(videoh_set_config(DADDR, 0));
+}
+
+// Probe and commit, device answers probe with frame and payload size
+static void stream_start(uint8_t info_idx, uint32_t frame_size, uint32_t payload_size) {
+  tuh_video_frame_info_t info;
+  TEST_ASSERT_TRUE(tuh_video_frame_info(0, info_idx, &info));
+  TEST_ASSERT_TRUE(tuh_video_stream_start(0, info_idx, 0));
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  video_probe_and_commit_control_t probe;
+  tu_memclr(&probe, sizeof(probe));
+  probe.bFormatIndex             = info.format_index;
+  probe.bFrameIndex              = info.frame_index;
+  probe.dwFrameInterval          = info.default_interval;
+  probe.dwMaxVideoFrameSize      = frame_size;
+  probe.dwMaxPayloadTransferSize = payload_size;
+  memcpy(_ctrl.buffer, &probe, _ctrl.setup.wLength);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  ctrl_complete(XFER_RESULT_SUCCESS); // commit
+}
+
+void setUp(void) {
+  uint8_t const ep_addr[] = { EP_VIDEO };
+  usbh_model_init(ep_addr, sizeof(ep_addr));
+  tu_memclr(_fb, sizeof(_fb));
+  _seq = 0;
+
+  videoh_init();
+}
+
+void tearDown(void) {
+  videoh_close(DADDR);
+}
+
+void test_video_host_open_requires_control_interface(void) {
+  TEST_ASSERT_EQUAL(0, videoh_open(0, DADDR, (const tusb_desc_interface_t*) (desc_bulk + 31), 9));
+  // control interface without streaming interface
+  TEST_ASSERT_EQUAL(0, videoh_open(0, DADDR, (const tusb_desc_interface_t*) desc_bulk, 31));
+}
+
+void test_video_host_open_parse_formats(void) {
+  TEST_ASSERT_EQUAL(sizeof(desc_bulk) - 9, videoh_open(0, DADDR, (const tusb_desc_interface_t*) desc_bulk,
+                                                       sizeof(desc_bulk)));
+  TEST_ASSERT_TRUE(videoh_set_config(DADDR, 0));
+  TEST_ASSERT_EQUAL(1, _set_config_itf);
+  TEST_ASSERT_TRUE(tuh_video_mounted(0));
+  TEST_ASSERT_EQUAL(2, tuh_video_frame_info_count(0));
+
+  tuh_video_frame_info_t info;
+  TEST_ASSERT_TRUE(tuh_video_frame_info(0, 0, &info));
+  TEST_ASSERT_EQUAL(VIDEO_CS_ITF_VS_FORMAT_MJPEG, info.format);
+  TEST_ASSERT_EQUAL(1, info.format_index);
+  TEST_ASSERT_EQUAL(1, info.frame_index);
+  TEST_ASSERT_EQUAL(160, info.width);
+  TEST_ASSERT_EQUAL(120, info.height);
+  TEST_ASSERT_EQUAL(333333, info.default_interval);
+  TEST_ASSERT_EQUAL(38400, info.max_frame_size);
+  TEST_ASSERT_EQUAL(0, info.fourcc);
+
+  TEST_ASSERT_TRUE(tuh_video_frame_info(0, 1, &info));
+  TEST_ASSERT_EQUAL(VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED, info.format);
+  TEST_ASSERT_EQUAL(2, info.format_index);
+  TEST_ASSERT_EQUAL_HEX32(0x32595559, info.fourcc);
+  TEST_ASSERT_EQUAL(16, info.bits_per_pixel);
+  TEST_ASSERT_FALSE(tuh_video_frame_info(0, 2, &info));
+
+  TEST_ASSERT_EQUAL(0, tuh_video_frame_info_find(0, VIDEO_CS_ITF_VS_FORMAT_MJPEG, 0, 160, 120));
+  TEST_ASSERT_EQUAL(1, tuh_video_frame_info_find(0, VIDEO_CS_ITF_VS_FORMAT_UNCOMPRESSED, 0x32595559, 0, 0));
+  TEST_ASSERT_EQUAL(TUSB_INDEX_INVALID_8, tuh_video_frame_info_find(0, VIDEO_CS_ITF_VS_FORMAT_MJPEG, 0, 640, 0));
+}
+
+void test_video_host_start_probe_commit(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_stream_start(0, 0, 0));
+  TEST_ASSERT_FALSE(tuh_video_stream_start(0, 0, 0)); // already starting
+
+  // probe SET_CUR with 1.5 length, hint to keep default interval
+  TEST_ASSERT_EQUAL(VIDEO_REQUEST_SET_CUR, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(TUSB_REQ_TYPE_CLASS, _ctrl.setup.bmRequestType_bit.type);
+  TEST_ASSERT_EQUAL(TUSB_DIR_OUT, _ctrl.setup.bmRequestType_bit.direction);
+  TEST_ASSERT_EQUAL(VIDEO_VS_CTL_PROBE << 8, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(1, _ctrl.setup.wIndex);
+  TEST_ASSERT_EQUAL(48, _ctrl.setup.wLength);
+  video_probe_and_commit_control_t const* sent = (video_probe_and_commit_control_t const*) _ctrl.data;
+  TEST_ASSERT_EQUAL(1, sent->bmHint);
+  TEST_ASSERT_EQUAL(1, sent->bFormatIndex);
+  TEST_ASSERT_EQUAL(1, sent->bFrameIndex);
+  TEST_ASSERT_EQUAL(333333, sent->dwFrameInterval);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  TEST_ASSERT_EQUAL(VIDEO_REQUEST_GET_CUR, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(TUSB_DIR_IN, _ctrl.setup.bmRequestType_bit.direction);
+  video_probe_and_commit_control_t* probe = (video_probe_and_commit_control_t*) _ctrl.buffer;
+  probe->dwFrameInterval          = 666666;
+  probe->dwMaxVideoFrameSize      = 38400;
+  probe->dwMaxPayloadTransferSize = 3072;
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  // commit what device answered
+  TEST_ASSERT_EQUAL(VIDEO_REQUEST_SET_CUR, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(VIDEO_VS_CTL_COMMIT << 8, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(666666, sent->dwFrameInterval);
+  TEST_ASSERT_EQUAL(3072, sent->dwMaxPayloadTransferSize);
+  TEST_ASSERT_FALSE(tuh_video_streaming(0));
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  // bulk streams without SET_INTERFACE
+  TEST_ASSERT_FALSE(_ctrl.pending);
+  TEST_ASSERT_TRUE(tuh_video_streaming(0));
+  TEST_ASSERT_TRUE(sim_ep(EP_VIDEO)->opened && sim_ep(EP_VIDEO)->pending);
+
+  video_probe_and_commit_control_t commit;
+  TEST_ASSERT_TRUE(tuh_video_commit_get(0, &commit));
+  TEST_ASSERT_EQUAL(38400, commit.dwMaxVideoFrameSize);
+}
+
+void test_video_host_start_probe_rejected(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_stream_start(0, 0, 0));
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  // device answers another format
+  ((video_probe_and_commit_control_t*) _ctrl.buffer)->bFormatIndex = 2;
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_FALSE(_ctrl.pending);
+  TEST_ASSERT_FALSE(tuh_video_streaming(0));
+  TEST_ASSERT_FALSE(sim_ep(EP_VIDEO)->opened);
+
+  stream_start(0, 38400, 100);
+  TEST_ASSERT_TRUE(tuh_video_streaming(0));
+}
+
+void test_video_host_bulk_frame_in_place(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[1], 256));
+  stream_start(0, 38400, 100);
+
+  // first payload is received at start of buffer
+  TEST_ASSERT_EQUAL_PTR(_fb[0], sim_ep(EP_VIDEO)->buffer);
+  TEST_ASSERT_EQUAL(100, sim_ep(EP_VIDEO)->len);
+  bulk_payload(12, 0x04, 88);
+
+  // next payloads are received with their header over the tail of frame data
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 88, sim_ep(EP_VIDEO)->buffer);
+  bulk_payload(12, 0x00, 40);
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 128, sim_ep(EP_VIDEO)->buffer);
+
+  // shorter header: data is moved down to the frame tail
+  tuh_video_frame_t frame;
+  TEST_ASSERT_FALSE(tuh_video_frame_get(0, &frame));
+  bulk_payload(2, 0x02, 10);
+
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[0], frame.buffer);
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 12, frame.data);
+  frame_check(&frame, 0, 138);
+  TEST_ASSERT_TRUE(frame.has_pts);
+  TEST_ASSERT_EQUAL_HEX32(0x12345678, frame.pts);
+  TEST_ASSERT_TRUE(frame.eof);
+  TEST_ASSERT_EQUAL(0, frame.status);
+  TEST_ASSERT_FALSE(tuh_video_frame_get(0, &frame));
+
+  // next frame goes to next buffer, the got one can be queued again
+  TEST_ASSERT_EQUAL_PTR(_fb[1], sim_ep(EP_VIDEO)->buffer);
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+}
+
+void test_video_host_bulk_fid_toggle_ends_frame(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[1], 256));
+  stream_start(0, 38400, 100);
+
+  bulk_payload(2, 0x00, 30);
+  bulk_payload(2, 0x00, 30);
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 60, sim_ep(EP_VIDEO)->buffer);
+
+  // toggled Frame ID: frame ends without EOF, payload is moved to the next buffer
+  bulk_payload(2, 0x01, 30);
+  tuh_video_frame_t frame;
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 2, frame.data);
+  frame_check(&frame, 0, 60); // tail under header is restored
+  TEST_ASSERT_FALSE(frame.eof);
+  TEST_ASSERT_FALSE(frame.has_pts);
+
+  TEST_ASSERT_EQUAL_PTR(_fb[1] + 28, sim_ep(EP_VIDEO)->buffer);
+  bulk_payload(2, 0x03, 5);
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[1], frame.data);
+  frame_check(&frame, 60, 35);
+  TEST_ASSERT_TRUE(frame.eof);
+}
+
+void test_video_host_bulk_payload_spans_transfers(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 1000));
+  stream_start(0, 38400, 0); // no payload size: payload ends with short packet
+
+  // transfer is limited by buffer, cut on packet boundary
+  TEST_ASSERT_EQUAL(960, sim_ep(EP_VIDEO)->len);
+  bulk_payload(2, 0x02, 958);
+
+  // continuation has no header, End of Frame applies when payload ends
+  tuh_video_frame_t frame;
+  TEST_ASSERT_FALSE(tuh_video_frame_get(0, &frame));
+  bulk_data(30);
+
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  frame_check(&frame, 0, 988);
+  TEST_ASSERT_TRUE(frame.eof);
+  TEST_ASSERT_EQUAL(0, frame.status);
+}
+
+void test_video_host_bulk_overflow(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 200));
+  stream_start(0, 38400, 300);
+
+  TEST_ASSERT_EQUAL(192, sim_ep(EP_VIDEO)->len);
+  bulk_payload(2, 0x02, 190);
+
+  // rest of payload does not fit: received into staging buffer and truncated
+  TEST_ASSERT_TRUE(sim_ep(EP_VIDEO)->buffer < _fb[0] || sim_ep(EP_VIDEO)->buffer >= _fb[0] + 200);
+  TEST_ASSERT_EQUAL(108, sim_ep(EP_VIDEO)->len);
+  bulk_data(50);
+
+  tuh_video_frame_t frame;
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  frame_check(&frame, 0, 198);
+  TEST_ASSERT_EQUAL(TUH_VIDEO_FRAME_ERROR_OVERFLOW, frame.status);
+}
+
+void test_video_host_drop_without_buffer(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  stream_start(0, 38400, 100);
+
+  // no buffer queued: payload is dropped into staging buffer
+  bulk_payload(2, 0x00, 20);
+
+  // buffer queued in the middle of a frame is used from next frame
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  bulk_payload(2, 0x00, 20);
+  TEST_ASSERT_EQUAL_PTR(_fb[0], sim_ep(EP_VIDEO)->buffer);
+  bulk_payload(2, 0x00, 20);
+  tuh_video_frame_t frame;
+  TEST_ASSERT_FALSE(tuh_video_frame_get(0, &frame));
+
+  // error bit is reported with frame
+  bulk_payload(2, 0x01 | 0x40 | 0x02, 20);
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[0] + 2, frame.data);
+  frame_check(&frame, 60, 20);
+  TEST_ASSERT_EQUAL(TUH_VIDEO_FRAME_ERROR_PAYLOAD, frame.status);
+}
+
+void test_video_host_uncompressed_ends_at_frame_size(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[1], 256));
+  stream_start(1, 16, 100);
+
+  bulk_payload(2, 0x00, 10);
+  bulk_payload(2, 0x00, 6);
+  tuh_video_frame_t frame;
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  frame_check(&frame, 0, 16);
+  TEST_ASSERT_FALSE(frame.eof);
+
+  // trailing payload of the same frame is dropped, next frame starts in place in next buffer
+  bulk_payload(2, 0x00, 4);
+  TEST_ASSERT_EQUAL_PTR(_fb[1], sim_ep(EP_VIDEO)->buffer);
+  bulk_payload(2, 0x01, 16);
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[1] + 2, frame.data);
+  frame_check(&frame, 20, 16);
+}
+
+void test_video_host_bulk_stop(void) {
+  mount(desc_bulk, sizeof(desc_bulk));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  stream_start(0, 38400, 100);
+  bulk_payload(2, 0x00, 20);
+
+  // bulk is stopped by clearing endpoint halt
+  TEST_ASSERT_TRUE(tuh_video_stream_stop(0));
+  TEST_ASSERT_FALSE(sim_ep(EP_VIDEO)->opened);
+  TEST_ASSERT_EQUAL(TUSB_REQ_CLEAR_FEATURE, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(TUSB_REQ_RCPT_ENDPOINT, _ctrl.setup.bmRequestType_bit.recipient);
+  TEST_ASSERT_EQUAL(TUSB_REQ_FEATURE_EDPT_HALT, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(EP_VIDEO, _ctrl.setup.wIndex);
+  TEST_ASSERT_FALSE(tuh_video_stream_start(0, 0, 0)); // still stopping
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_FALSE(tuh_video_streaming(0));
+
+  // partial frame is discarded, its buffer stays queued
+  tuh_video_frame_t frame;
+  TEST_ASSERT_FALSE(tuh_video_frame_get(0, &frame));
+  stream_start(0, 38400, 100);
+  TEST_ASSERT_EQUAL_PTR(_fb[0], sim_ep(EP_VIDEO)->buffer);
+
+  videoh_close(DADDR);
+  TEST_ASSERT_FALSE(tuh_video_mounted(0));
+}
+
+void test_video_host_iso_stream(void) {
+  TEST_ASSERT_EQUAL(sizeof(desc_iso), videoh_open(0, DADDR, (const tusb_desc_interface_t*) desc_iso,
+                                                  sizeof(desc_iso)));
+  TEST_ASSERT_TRUE(videoh_set_config(DADDR, 0));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[0], 256));
+  TEST_ASSERT_TRUE(tuh_video_frame_queue(0, _fb[1], 256));
+
+  // UVC 1.0 probe length
+  TEST_ASSERT_TRUE(tuh_video_stream_start(0, 0, 0));
+  TEST_ASSERT_EQUAL(26, _ctrl.setup.wLength);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  video_probe_and_commit_control_t* probe = (video_probe_and_commit_control_t*) _ctrl.buffer;
+  probe->dwMaxPayloadTransferSize = 400;
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+
+  // smallest alternate fitting the payload
+  TEST_ASSERT_EQUAL(TUSB_REQ_SET_INTERFACE, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(2, _ctrl.setup.wValue);
+  TEST_ASSERT_EQUAL(1, _ctrl.setup.wIndex);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_TRUE(tuh_video_streaming(0));
+  TEST_ASSERT_EQUAL(2, sim_ep(EP_VIDEO)->count);
+  TEST_ASSERT_EQUAL(CFG_TUH_VIDEO_ISO_PACKETS, sim_ep(EP_VIDEO)->queue[0]->packet_count);
+  TEST_ASSERT_EQUAL(512, sim_ep(EP_VIDEO)->queue[0]->packets[0].length);
+
+  // each packet is a payload at offset of requested length, empty packets are skipped
+  tuh_iso_xfer_t* xfer = iso_pop(EP_VIDEO);
+  for (uint16_t i = 0; i < xfer->packet_count; i++) {
+    xfer->packets[i].actual_len = 0;
+    xfer->packets[i].result = XFER_RESULT_SUCCESS;
+  }
+  xfer->packets[0].actual_len = payload_build(xfer->buffer, 2, 0x00, 100);
+  xfer->packets[2].actual_len = payload_build(xfer->buffer + 2 * 512, 2, 0x02, 20);
+  xfer->packets[3].actual_len = payload_build(xfer->buffer + 3 * 512, 2, 0x01, 8);
+  xfer->packets[4].result = XFER_RESULT_FAILED;
+  xfer->complete_cb(xfer);
+  TEST_ASSERT_EQUAL(2, sim_ep(EP_VIDEO)->count); // resubmitted
+
+  tuh_video_frame_t frame;
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  TEST_ASSERT_EQUAL_PTR(_fb[0], frame.data);
+  frame_check(&frame, 0, 120);
+  TEST_ASSERT_TRUE(frame.eof);
+  TEST_ASSERT_EQUAL(0, frame.status);
+
+  // lost packet is flagged on the frame being received
+  xfer = iso_pop(EP_VIDEO);
+  for (uint16_t i = 0; i < xfer->packet_count; i++) {
+    xfer->packets[i].actual_len = 0;
+    xfer->packets[i].result = XFER_RESULT_SUCCESS;
+  }
+  xfer->packets[0].actual_len = payload_build(xfer->buffer, 2, 0x03, 4);
+  xfer->complete_cb(xfer);
+  TEST_ASSERT_TRUE(tuh_video_frame_get(0, &frame));
+  frame_check(&frame, 120, 12);
+  TEST_ASSERT_EQUAL(TUH_VIDEO_FRAME_ERROR_XFER, frame.status);
+
+  TEST_ASSERT_TRUE(tuh_video_stream_stop(0));
+  TEST_ASSERT_FALSE(sim_ep(EP_VIDEO)->opened);
+  TEST_ASSERT_EQUAL(TUSB_REQ_SET_INTERFACE, _ctrl.setup.bRequest);
+  TEST_ASSERT_EQUAL(0, _ctrl.setup.wValue);
+  ctrl_complete(XFER_RESULT_SUCCESS);
+  TEST_ASSERT_FALSE(tuh_video_streaming(0));
+}
@@ -0,0 +1,213 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef HCD_DEVICE_MODEL_H_
+#define HCD_DEVICE_MODEL_H_
+
+// Device model for host stack tests running usbh on top of mock hcd. It is included by the test file only, everything
+// is therefore static.
+//
+// A full speed device on root port enumerates with desc_device, desc_langid and the configuration descriptor of the
+// test. Setup and control stages are completed by the model on their own. The test provides:
+// - device_desc_configuration(): configuration descriptor
+// - device_ctrl_response(): data to answer a class or vendor control IN request, NULL if request has no data
+// - device_edpt_xfer(): transfer of a non-control endpoint
+//
+// Test modeling several devices (e.g behind a hub) defines HCD_MODEL_NO_CONTROL and stubs hcd_setup_send() and
+// hcd_edpt_xfer() on its own.
+
+#include <string.h>
+#include "unity.h"
+#include "tusb.h"
+#include "mock_hcd.h"
+
+// Device descriptor, test can override these before including this file
+#ifndef HCD_MODEL_VID
+  #define HCD_MODEL_VID 0xCafe
+#endif
+
+#ifndef HCD_MODEL_PID
+  #define HCD_MODEL_PID 0x4001
+#endif
+
+#ifndef HCD_MODEL_BCD_DEVICE
+  #define HCD_MODEL_BCD_DEVICE 0x0100
+#endif
+
+#ifndef HCD_MODEL_EP0_SIZE
+  #define HCD_MODEL_EP0_SIZE 64
+#endif
+
+static uint32_t now_ms;
+uint32_t tusb_time_millis_api(void) {
+  return now_ms;
+}
+
+static tusb_desc_device_t const desc_device = {
+  .bLength            = sizeof(tusb_desc_device_t),
+  .bDescriptorType    = TUSB_DESC_DEVICE,
+  .bcdUSB             = 0x0200,
+  .bDeviceClass       = 0,
+  .bDeviceSubClass    = 0,
+  .bDeviceProtocol    = 0,
+  .bMaxPacketSize0    = HCD_MODEL_EP0_SIZE,
+  .idVendor           = HCD_MODEL_VID,
+  .idProduct          = HCD_MODEL_PID,
+  .bcdDevice          = HCD_MODEL_BCD_DEVICE,
+  .iManufacturer      = 0,
+  .iProduct           = 0,
+  .iSerialNumber      = 0,
+  .bNumConfigurations = 1,
+};
+
+static uint8_t const desc_langid[] = { 4, TUSB_DESC_STRING, U16_TO_U8S_LE(0x0409) };
+
+static bool connected; // device is plugged into root port
+
+static bool port_connect_status_cb(uint8_t rhport, int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  return connected;
+}
+
+static tusb_speed_t port_speed_get_cb(uint8_t rhport, int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  return TUSB_SPEED_FULL;
+}
+
+#ifndef HCD_MODEL_NO_CONTROL
+static tusb_control_request_t ctrl_request; // last setup
+static uint32_t setup_count;
+static bool     ctrl_hold; // setup of vendor requests is not completed by the device
+
+// provided by the test
+static uint8_t const* device_desc_configuration(uint16_t* len);
+static uint8_t const* device_ctrl_response(uint16_t* len);
+static bool device_edpt_xfer(uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen);
+
+static bool setup_send_cb(uint8_t rhport, uint8_t daddr, uint8_t const setup_packet[8], int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  memcpy(&ctrl_request, setup_packet, 8);
+  setup_count++;
+  bool const is_vendor = (ctrl_request.bmRequestType_bit.type == TUSB_REQ_TYPE_VENDOR);
+  if (!(is_vendor && ctrl_hold)) {
+    hcd_event_xfer_complete(daddr, 0x00, 8, XFER_RESULT_SUCCESS, false);
+  }
+  return true;
+}
+
+// data to answer a control IN request, NULL if request has no data
+static uint8_t const* ctrl_response(uint16_t* len) {
+  if (ctrl_request.bmRequestType_bit.type != TUSB_REQ_TYPE_STANDARD) {
+    return device_ctrl_response(len);
+  }
+
+  if (ctrl_request.bRequest == TUSB_REQ_GET_DESCRIPTOR) {
+    switch (tu_u16_high(ctrl_request.wValue)) {
+      case TUSB_DESC_DEVICE:
+        *len = sizeof(desc_device);
+        return (uint8_t const*) &desc_device;
+      case TUSB_DESC_CONFIGURATION:
+        return device_desc_configuration(len);
+      case TUSB_DESC_STRING:
+        *len = sizeof(desc_langid);
+        return desc_langid;
+      default:
+        break;
+    }
+  }
+  *len = 0;
+  return NULL;
+}
+
+static bool edpt_xfer_cb(uint8_t rhport, uint8_t daddr, uint8_t ep_addr, uint8_t* buffer, uint16_t buflen,
+                         int cmock_num_calls) {
+  (void) rhport; (void) cmock_num_calls;
+  if (tu_edpt_number(ep_addr) != 0) {
+    return device_edpt_xfer(daddr, ep_addr, buffer, buflen);
+  }
+
+  uint16_t len = buflen;
+  if (ep_addr == 0x80 && buflen > 0) {
+    uint16_t resp_len;
+    uint8_t const* resp = ctrl_response(&resp_len);
+    len = tu_min16(buflen, resp_len);
+    memcpy(buffer, resp, len);
+  }
+  hcd_event_xfer_complete(daddr, ep_addr, len, XFER_RESULT_SUCCESS, false);
+  return true;
+}
+#endif
+
+// process all events ready at current time, a run of tuh_task() handles up to CFG_TUH_TASK_EVENTS_PER_RUN only
+static void task_flush(void) {
+  do {
+    tuh_task();
+  } while (tuh_task_event_ready());
+}
+
+// run usbh task for ms milliseconds
+static void task_run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    task_flush();
+    now_ms++;
+  }
+  task_flush();
+}
+
+// Stub mock hcd with the model and init host stack, device is not plugged yet. hcd_port_reset() is left to the test.
+static void hcd_model_init(uint8_t rhport) {
+  now_ms    = 1000;
+  connected = false;
+  #ifndef HCD_MODEL_NO_CONTROL
+  memset(&ctrl_request, 0, sizeof(ctrl_request));
+  setup_count = 0;
+  ctrl_hold   = false;
+  #endif
+
+  hcd_init_IgnoreAndReturn(true);
+  hcd_deinit_IgnoreAndReturn(true);
+  hcd_int_enable_Ignore();
+  hcd_int_disable_Ignore();
+  hcd_port_reset_end_Ignore();
+  hcd_device_close_Ignore();
+  hcd_edpt_open_IgnoreAndReturn(true);
+  hcd_edpt_close_IgnoreAndReturn(true);
+  hcd_edpt_abort_xfer_IgnoreAndReturn(true);
+  hcd_port_connect_status_StubWithCallback(port_connect_status_cb);
+  hcd_port_speed_get_StubWithCallback(port_speed_get_cb);
+  #ifndef HCD_MODEL_NO_CONTROL
+  hcd_setup_send_StubWithCallback(setup_send_cb);
+  hcd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+  #endif
+
+  tusb_rhport_init_t const host_init = {
+    .role  = TUSB_ROLE_HOST,
+    .speed = TUSB_SPEED_AUTO
+  };
+  TEST_ASSERT_TRUE(tusb_init(rhport, &host_init));
+}
+
+#endif
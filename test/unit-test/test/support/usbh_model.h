@@ -0,0 +1,212 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#ifndef USBH_MODEL_H_
+#define USBH_MODEL_H_
+
+// Model of usbh for class driver tests running on top of mock usbh. It is included by the test file only, everything
+// is therefore static.
+//
+// - control transfers, including SET_INTERFACE, are held until completed by ctrl_complete()
+// - bulk and interrupt transfers are held per endpoint until completed by the test
+// - isochronous transfers are queued per endpoint, up to 2, and taken by the test with iso_pop()
+// - queued transfers are dropped without callback when their endpoint is closed
+//
+// The test defines DADDR of the device before including this file, its endpoints are given to usbh_model_init().
+
+#include <string.h>
+#include "unity.h"
+#include "mock_usbh.h"
+#include "mock_usbh_pvt.h"
+
+#ifndef USBH_MODEL_EP_MAX
+  #define USBH_MODEL_EP_MAX 4
+#endif
+
+static struct {
+  bool pending;
+  tusb_control_request_t setup;
+  uint8_t data[64]; // data of OUT request
+  uint8_t* buffer;
+  tuh_xfer_cb_t complete_cb;
+  uintptr_t user_data;
+} _ctrl;
+
+typedef struct {
+  uint8_t ep_addr;
+  bool opened;
+
+  // bulk/interrupt transfer
+  bool pending;
+  uint8_t* buffer;
+  uint16_t len;
+
+  // isochronous transfers
+  uint8_t count;
+  tuh_iso_xfer_t* queue[2];
+} sim_ep_t;
+
+static sim_ep_t _sim_ep[USBH_MODEL_EP_MAX];
+static uint8_t _set_config_itf;
+
+static sim_ep_t* sim_ep(uint8_t ep_addr) {
+  for (uint8_t i = 0; i < USBH_MODEL_EP_MAX; i++) {
+    if (_sim_ep[i].ep_addr == ep_addr) {
+      return &_sim_ep[i];
+    }
+  }
+  return NULL;
+}
+
+static tusb_speed_t speed_get_cb(uint8_t daddr, int cmock_num_calls) {
+  (void) daddr; (void) cmock_num_calls;
+  return TUSB_SPEED_FULL;
+}
+
+static bool edpt_open_cb(uint8_t daddr, tusb_desc_endpoint_t const* desc_ep, int cmock_num_calls) {
+  (void) cmock_num_calls;
+  TEST_ASSERT_EQUAL(DADDR, daddr);
+  sim_ep_t* ep = sim_ep(desc_ep->bEndpointAddress);
+  TEST_ASSERT_NOT_NULL(ep);
+  ep->opened = true;
+  return true;
+}
+
+static bool edpt_close_cb(uint8_t daddr, uint8_t ep_addr, int cmock_num_calls) {
+  (void) daddr; (void) cmock_num_calls;
+  sim_ep_t* ep = sim_ep(ep_addr);
+  TEST_ASSERT_NOT_NULL(ep);
+  ep->opened  = false;
+  ep->pending = false;
+  ep->count   = 0;
+  return true;
+}
+
+static bool edpt_xfer_cb(uint8_t dev_addr, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes,
+                         tuh_xfer_cb_t complete_cb, uintptr_t user_data, int cmock_num_calls) {
+  (void) complete_cb; (void) user_data; (void) cmock_num_calls;
+  TEST_ASSERT_EQUAL(DADDR, dev_addr);
+  sim_ep_t* ep = sim_ep(ep_addr);
+  TEST_ASSERT_NOT_NULL(ep);
+  TEST_ASSERT_TRUE(ep->opened && !ep->pending && total_bytes > 0);
+  ep->pending = true;
+  ep->buffer  = buffer;
+  ep->len     = total_bytes;
+  return true;
+}
+
+static bool iso_xfer_cb(tuh_iso_xfer_t* xfer, int cmock_num_calls) {
+  (void) cmock_num_calls;
+  sim_ep_t* ep = sim_ep(xfer->ep_addr);
+  TEST_ASSERT_NOT_NULL(ep);
+  TEST_ASSERT_TRUE(ep->opened && ep->count < 2 && xfer->packet_count > 0);
+  ep->queue[ep->count++] = xfer;
+  return true;
+}
+
+static bool control_xfer_cb(tuh_xfer_t* xfer, int cmock_num_calls) {
+  (void) cmock_num_calls;
+  TEST_ASSERT_FALSE(_ctrl.pending);
+  _ctrl.pending     = true;
+  _ctrl.setup       = *xfer->setup;
+  _ctrl.buffer      = xfer->buffer;
+  _ctrl.complete_cb = xfer->complete_cb;
+  _ctrl.user_data   = xfer->user_data;
+  if (xfer->buffer != NULL && _ctrl.setup.bmRequestType_bit.direction == TUSB_DIR_OUT) {
+    TEST_ASSERT_TRUE(_ctrl.setup.wLength <= sizeof(_ctrl.data));
+    memcpy(_ctrl.data, xfer->buffer, _ctrl.setup.wLength);
+  }
+  return true;
+}
+
+static bool interface_set_cb(uint8_t daddr, uint8_t itf_num, uint8_t itf_alt, tuh_xfer_cb_t complete_cb,
+                             uintptr_t user_data, int cmock_num_calls) {
+  tusb_control_request_t const request = {
+    .bmRequestType_bit = { .recipient = TUSB_REQ_RCPT_INTERFACE, .type = TUSB_REQ_TYPE_STANDARD,
+                           .direction = TUSB_DIR_OUT },
+    .bRequest = TUSB_REQ_SET_INTERFACE,
+    .wValue   = itf_alt,
+    .wIndex   = itf_num,
+    .wLength  = 0
+  };
+  tuh_xfer_t xfer = { .daddr = daddr, .setup = &request, .complete_cb = complete_cb, .user_data = user_data };
+  return control_xfer_cb(&xfer, cmock_num_calls);
+}
+
+static void set_config_complete_cb(uint8_t dev_addr, uint8_t itf_num, int cmock_num_calls) {
+  (void) cmock_num_calls;
+  TEST_ASSERT_EQUAL(DADDR, dev_addr);
+  _set_config_itf = itf_num;
+}
+
+// complete pending control transfer, IN data is written to _ctrl.buffer by the test beforehand
+static void ctrl_complete(xfer_result_t result) {
+  TEST_ASSERT_TRUE(_ctrl.pending);
+  _ctrl.pending = false;
+  tuh_xfer_t xfer = {
+    .daddr       = DADDR,
+    .setup       = &_ctrl.setup,
+    .result      = result,
+    .actual_len  = (result == XFER_RESULT_SUCCESS) ? _ctrl.setup.wLength : 0,
+    .buffer      = _ctrl.buffer,
+    .complete_cb = _ctrl.complete_cb,
+    .user_data   = _ctrl.user_data
+  };
+  _ctrl.complete_cb(&xfer);
+}
+
+// take oldest queued isochronous transfer of an endpoint, test fills packets and invokes its complete_cb
+static tuh_iso_xfer_t* iso_pop(uint8_t ep_addr) {
+  sim_ep_t* ep = sim_ep(ep_addr);
+  TEST_ASSERT_NOT_NULL(ep);
+  TEST_ASSERT_TRUE(ep->count > 0);
+  tuh_iso_xfer_t* xfer = ep->queue[0];
+  ep->queue[0] = ep->queue[1];
+  ep->count--;
+  return xfer;
+}
+
+// Reset the model with endpoints of the device and stub mock usbh
+static void usbh_model_init(uint8_t const* ep_addr, uint8_t ep_count) {
+  TEST_ASSERT_TRUE(ep_count <= USBH_MODEL_EP_MAX);
+  tu_memclr(&_ctrl, sizeof(_ctrl));
+  tu_memclr(_sim_ep, sizeof(_sim_ep));
+  for (uint8_t i = 0; i < ep_count; i++) {
+    _sim_ep[i].ep_addr = ep_addr[i];
+  }
+  _set_config_itf = 0;
+
+  tuh_speed_get_StubWithCallback(speed_get_cb);
+  tuh_edpt_open_StubWithCallback(edpt_open_cb);
+  tuh_edpt_close_StubWithCallback(edpt_close_cb);
+  usbh_edpt_xfer_with_callback_StubWithCallback(edpt_xfer_cb);
+  tuh_iso_xfer_StubWithCallback(iso_xfer_cb);
+  tuh_control_xfer_StubWithCallback(control_xfer_cb);
+  tuh_interface_set_StubWithCallback(interface_set_cb);
+  usbh_driver_set_config_complete_StubWithCallback(set_config_complete_cb);
+}
+
+#endif
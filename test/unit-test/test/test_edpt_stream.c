@@ -0,0 +1,228 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2025, hathach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This file is part of the TinyUSB stack.
+ */
+
+#include <string.h>
+#include "unity.h"
+
+// Files to test
+#include "tusb.h"
+TEST_SOURCE_FILE("tusb.c")
+
+// Mock File
+#include "mock_dcd.h"
+#include "mock_usbd.h"
+#include "mock_usbd_pvt.h"
+
+//--------------------------------------------------------------------+
+// MACRO TYPEDEF CONSTANT ENUM DECLARATION
+//--------------------------------------------------------------------+
+// Zero-copy (CFG_TUD_EDPT_STREAM_ZERO_COPY) device endpoint stream: transfers are submitted from/to the fifo linear
+// region, which must stay untouched by the application until the transfer completes.
+
+enum {
+  EP_OUT   = 0x01,
+  EP_IN    = 0x81,
+  EP_SIZE  = 64,
+  XFER_LEN = 128,
+  FF_SIZE  = 256,
+};
+
+uint32_t tusb_time_millis_api(void) {
+  return 0;
+}
+
+static uint8_t ff_buf[FF_SIZE];
+static uint8_t ep_buf[XFER_LEN];
+static tu_edpt_stream_t stream;
+
+static uint8_t data_a[XFER_LEN];
+static uint8_t data_c[XFER_LEN];
+
+// endpoint model: claimed/busy until transfer completes
+static bool ep_busy;
+static uint8_t* xfer_buf;
+static uint16_t xfer_len;
+static uint8_t xfer_count;
+
+static bool edpt_claim_cb(uint8_t rhport, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport; (void) ep_addr; (void) cmock_num_calls;
+  if (ep_busy) {
+    return false;
+  }
+  ep_busy = true;
+  return true;
+}
+
+static bool edpt_release_cb(uint8_t rhport, uint8_t ep_addr, int cmock_num_calls) {
+  (void) rhport; (void) ep_addr; (void) cmock_num_calls;
+  ep_busy = false;
+  return true;
+}
+
+static bool edpt_xfer_cb(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes, bool is_isr,
+                         int cmock_num_calls) {
+  (void) rhport; (void) ep_addr; (void) is_isr; (void) cmock_num_calls;
+  xfer_buf = buffer;
+  xfer_len = total_bytes;
+  xfer_count++;
+  return true;
+}
+
+static void stream_open(uint8_t ep_addr) {
+  tusb_desc_endpoint_t const desc = {
+    .bLength          = sizeof(tusb_desc_endpoint_t),
+    .bDescriptorType  = TUSB_DESC_ENDPOINT,
+    .bEndpointAddress = ep_addr,
+    .bmAttributes     = { .xfer = TUSB_XFER_BULK },
+    .wMaxPacketSize   = EP_SIZE,
+    .bInterval        = 0,
+  };
+  tu_edpt_stream_open(&stream, 0, &desc, XFER_LEN);
+  tu_edpt_stream_clear(&stream);
+}
+
+// transfer complete: endpoint is free again
+static void xfer_complete(void) {
+  ep_busy = false;
+}
+
+void setUp(void) {
+  memset(&stream, 0, sizeof(stream));
+  memset(ff_buf, 0, sizeof(ff_buf));
+  memset(ep_buf, 0, sizeof(ep_buf));
+  memset(data_a, 'A', sizeof(data_a));
+  memset(data_c, 'C', sizeof(data_c));
+  ep_busy = false;
+  xfer_buf = NULL;
+  xfer_len = 0;
+  xfer_count = 0;
+
+  usbd_edpt_claim_StubWithCallback(edpt_claim_cb);
+  usbd_edpt_release_StubWithCallback(edpt_release_cb);
+  usbd_edpt_xfer_StubWithCallback(edpt_xfer_cb);
+}
+
+void tearDown(void) {
+}
+
+//--------------------------------------------------------------------+
+// Write
+//--------------------------------------------------------------------+
+static void tx_open_and_send_a(void) {
+  TEST_ASSERT_TRUE(tu_edpt_stream_init(&stream, false, true, false, ff_buf, FF_SIZE, ep_buf));
+  stream_open(EP_IN);
+
+  TEST_ASSERT_EQUAL(XFER_LEN, tu_edpt_stream_write(&stream, data_a, XFER_LEN));
+  TEST_ASSERT_EQUAL(1, xfer_count);
+  TEST_ASSERT_EQUAL_PTR(ff_buf, xfer_buf); // sent directly from fifo
+  TEST_ASSERT_EQUAL(XFER_LEN, xfer_len);
+}
+
+// data written after clear must not land on the span still being sent
+static void tx_check_inflight_kept(void) {
+  TEST_ASSERT_EQUAL(XFER_LEN, tu_edpt_stream_read_available(&stream));
+  TEST_ASSERT_EQUAL(FF_SIZE - XFER_LEN, tu_edpt_stream_write_available(&stream));
+
+  TEST_ASSERT_EQUAL(XFER_LEN, tu_edpt_stream_write(&stream, data_c, XFER_LEN));
+  TEST_ASSERT_EQUAL_MEMORY(data_a, ff_buf, XFER_LEN);
+
+  // span is released on completion, next transfer is the data written after clear
+  xfer_complete();
+  TEST_ASSERT_EQUAL(XFER_LEN, tu_edpt_stream_write_xfer(&stream));
+  TEST_ASSERT_EQUAL(2, xfer_count);
+  TEST_ASSERT_EQUAL_PTR(ff_buf + XFER_LEN, xfer_buf);
+  TEST_ASSERT_EQUAL_MEMORY(data_c, xfer_buf, XFER_LEN);
+}
+
+void test_write_zero_copy(void) {
+  tx_open_and_send_a();
+
+  xfer_complete();
+  TEST_ASSERT_EQUAL(0, tu_edpt_stream_write_xfer(&stream));
+  TEST_ASSERT_TRUE(tu_edpt_stream_empty(&stream));
+  TEST_ASSERT_FALSE(ep_busy);
+}
+
+void test_write_clear_while_in_flight(void) {
+  tx_open_and_send_a();
+
+  tu_edpt_stream_write(&stream, data_c, EP_SIZE); // queued behind in-flight span, dropped by clear
+  tu_edpt_stream_clear(&stream);
+
+  tx_check_inflight_kept();
+}
+
+void test_write_reopen_while_in_flight(void) {
+  tx_open_and_send_a();
+
+  tu_edpt_stream_close(&stream);
+  stream_open(EP_IN);
+
+  tx_check_inflight_kept();
+}
+
+//--------------------------------------------------------------------+
+// Read
+//--------------------------------------------------------------------+
+static void rx_open_and_receive(void) {
+  TEST_ASSERT_TRUE(tu_edpt_stream_init(&stream, false, false, false, ff_buf, FF_SIZE, ep_buf));
+  stream_open(EP_OUT);
+
+  TEST_ASSERT_EQUAL(XFER_LEN, tu_edpt_stream_read_xfer(&stream));
+  TEST_ASSERT_EQUAL_PTR(ff_buf, xfer_buf); // received directly into fifo
+}
+
+// controller writes into the span then completes, data must show up in fifo
+static void rx_check_completion(void) {
+  memset(xfer_buf, 'R', EP_SIZE);
+  xfer_complete();
+  tu_edpt_stream_read_xfer_complete(&stream, EP_SIZE);
+
+  uint8_t buf[XFER_LEN];
+  TEST_ASSERT_EQUAL(EP_SIZE, tu_edpt_stream_read_available(&stream));
+  TEST_ASSERT_EQUAL(EP_SIZE, tu_edpt_stream_read(&stream, buf, sizeof(buf)));
+  TEST_ASSERT_EACH_EQUAL_HEX8('R', buf, EP_SIZE);
+}
+
+void test_read_zero_copy(void) {
+  rx_open_and_receive();
+  rx_check_completion();
+}
+
+void test_read_clear_while_in_flight(void) {
+  rx_open_and_receive();
+  tu_edpt_stream_clear(&stream);
+  rx_check_completion();
+}
+
+void test_read_reopen_while_in_flight(void) {
+  rx_open_and_receive();
+
+  tu_edpt_stream_close(&stream);
+  stream_open(EP_OUT);
+
+  rx_check_completion();
+}
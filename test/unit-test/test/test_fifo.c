@@ -625,3 +625,106 @@ void test_correct_read_pointer_cases(void) {
   tu_fifo_correct_read_pointer(ff);
   TEST_ASSERT_EQUAL(FIFO_SIZE + 10, ff->rd_idx);
 }
+
+void test_write_reserve_commit(void) {
+  // move indices so that reserved region wraps around
+  ff->wr_idx = FIFO_SIZE - 4;
+  ff->rd_idx = FIFO_SIZE - 4;
+
+  uint16_t n = tu_fifo_write_reserve(ff, &info, 10);
+  TEST_ASSERT_EQUAL(10, n);
+  TEST_ASSERT_EQUAL(4, info.linear.len);
+  TEST_ASSERT_EQUAL(6, info.wrapped.len);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer + FIFO_SIZE - 4, info.linear.ptr);
+  TEST_ASSERT_EQUAL_PTR(ff->buffer, info.wrapped.ptr);
+
+  memcpy(info.linear.ptr, test_data, info.linear.len);
+  memcpy(info.wrapped.ptr, test_data + info.linear.len, info.wrapped.len);
+
+  // nothing is visible until committed
+  TEST_ASSERT_EQUAL(0, tu_fifo_count(ff));
+  tu_fifo_write_commit(ff, 8);
+  TEST_ASSERT_EQUAL(8, tu_fifo_count(ff));
+
+  TEST_ASSERT_EQUAL(8, tu_fifo_read_n(ff, rd_buf, 10));
+  TEST_ASSERT_EQUAL_MEMORY(test_data, rd_buf, 8);
+}
+
+void test_write_reserve_limited_by_remaining(void) {
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE - 5);
+
+  uint16_t n = tu_fifo_write_reserve(ff, &info, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(5, n);
+  TEST_ASSERT_EQUAL(5, info.linear.len);
+  TEST_ASSERT_EQUAL(0, info.wrapped.len);
+  tu_fifo_write_commit(ff, n);
+  TEST_ASSERT_TRUE(tu_fifo_full(ff));
+
+  // full fifo: no span, even if overwritable
+  tu_fifo_set_overwritable(ff, true);
+  n = tu_fifo_write_reserve(ff, &info, 1);
+  TEST_ASSERT_EQUAL(0, n);
+  TEST_ASSERT_NULL(info.linear.ptr);
+  TEST_ASSERT_NULL(info.wrapped.ptr);
+  tu_fifo_write_commit(ff, 0);
+  tu_fifo_set_overwritable(ff, false);
+}
+
+void test_read_reserve_commit(void) {
+  ff->wr_idx = FIFO_SIZE - 2;
+  ff->rd_idx = FIFO_SIZE - 2;
+  tu_fifo_write_n(ff, test_data, 6);
+
+  uint16_t n = tu_fifo_read_reserve(ff, &info, 16);
+  TEST_ASSERT_EQUAL(6, n);
+  TEST_ASSERT_EQUAL(2, info.linear.len);
+  TEST_ASSERT_EQUAL(4, info.wrapped.len);
+  TEST_ASSERT_EQUAL_MEMORY(test_data, info.linear.ptr, 2);
+  TEST_ASSERT_EQUAL_MEMORY(test_data + 2, info.wrapped.ptr, 4);
+
+  // consume only part of the reserved items
+  tu_fifo_read_commit(ff, 3);
+  TEST_ASSERT_EQUAL(3, tu_fifo_count(ff));
+
+  n = tu_fifo_read_reserve(ff, &info, 16);
+  TEST_ASSERT_EQUAL(3, n);
+  TEST_ASSERT_EQUAL(0, info.wrapped.len);
+  TEST_ASSERT_EQUAL_MEMORY(test_data + 3, info.linear.ptr, 3);
+  tu_fifo_read_commit(ff, n);
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+}
+
+void test_read_reserve_overflowed(void) {
+  tu_fifo_set_overwritable(ff, true);
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE);
+  tu_fifo_write_n(ff, test_data + FIFO_SIZE, 4);
+
+  // read index is corrected to form a full fifo of the latest data
+  uint16_t n = tu_fifo_read_reserve(ff, &info, FIFO_SIZE);
+  TEST_ASSERT_EQUAL(FIFO_SIZE, n);
+  TEST_ASSERT_EQUAL(FIFO_SIZE - 4, info.linear.len);
+  TEST_ASSERT_EQUAL(4, info.wrapped.len);
+  TEST_ASSERT_EQUAL_MEMORY(test_data + 4, info.linear.ptr, FIFO_SIZE - 4);
+  TEST_ASSERT_EQUAL_MEMORY(test_data + FIFO_SIZE, info.wrapped.ptr, 4);
+  tu_fifo_read_commit(ff, n);
+
+  TEST_ASSERT_TRUE(tu_fifo_empty(ff));
+  tu_fifo_set_overwritable(ff, false);
+}
+
+void test_truncate_n(void) {
+  // wrapped: read index in the middle so that kept items cross the end of buffer
+  tu_fifo_write_n(ff, test_data, FIFO_SIZE - 8);
+  tu_fifo_discard_n(ff, FIFO_SIZE - 8);
+  tu_fifo_write_n(ff, test_data, 20);
+
+  TEST_ASSERT_EQUAL(0, tu_fifo_truncate_n(ff, 30)); // nothing beyond count
+  TEST_ASSERT_EQUAL(8, tu_fifo_truncate_n(ff, 12));
+  TEST_ASSERT_EQUAL(12, tu_fifo_count(ff));
+
+  // space after kept items is writable again
+  tu_fifo_write_n(ff, test_data + 100, 4);
+  TEST_ASSERT_EQUAL(16, tu_fifo_read_n(ff, rd_buf, FIFO_SIZE));
+  TEST_ASSERT_EQUAL_MEMORY(test_data, rd_buf, 12);
+  TEST_ASSERT_EQUAL_MEMORY(test_data + 100, rd_buf + 12, 4);
+}